@@ -90,7 +90,9 @@ int main(void)
    * generic type `ockam_vault_t` that will hold a handle to our vault.
    *
    * We also set the initialization attributes in a struct of
-   * type `ockam_vault_default_attributes_t`
+   * type `ockam_vault_default_attributes_t`. Attributes left unset keep
+   * their defaults, e.g. `aead_aes_gcm_backend` picks the fastest AES-GCM
+   * implementation the CPU supports.
    *
    * We then pass the address of both these variable to the default
    * implementation specific initialization function.
@@ -4,7 +4,9 @@
 #include "ockam/error.h"
 #include "ockam/io.h"
 #include "ockam/memory.h"
+#include "ockam/mutex.h"
 #include "ockam/vault.h"
+#include "ockam/key_agreement/xx.h"
 
 #define CHANNEL_ERROR_PARAMS          (OCKAM_ERROR_INTERFACE_CHANNEL | 0x0001u)
 #define CHANNEL_ERROR_NOT_IMPLEMENTED (OCKAM_ERROR_INTERFACE_CHANNEL | 0x0002u)
@@ -13,16 +15,105 @@
 
 typedef struct ockam_channel_t ockam_channel_t;
 
+/**
+ * A channel sends messages of up to 32KiB unless both ends set max_packet_size higher. After the handshake each end
+ * that does advertises its packet size in a PING, and from then on each side sends packets up to the smaller of the
+ * two sizes. The transport must carry frames of that size.
+ *
+ * Writes larger than a packet are encrypted and sent as a sequence of packets. Reads return at most one packet, and
+ * a packet larger than the read buffer is returned over several reads, so large messages should be read as a stream.
+ */
+#define CHANNEL_LARGE_PACKET_SIZE (1024u * 1024u)
+
+/**
+ * Once the channel is secure its reader and writer also take ockam_buffer_t messages. A buffer written with
+ * ockam_write_buffer() is sent without copying the payload when the channel holds the only reference, the buffer
+ * fits one packet, and it was allocated with CHANNEL_BUFFER_HEADROOM in front and CHANNEL_BUFFER_TAILROOM behind
+ * the payload, for the channel header and the AEAD tag plus the transport's framing. Other buffers are copied as with
+ * ockam_write(). ockam_read_buffer() returns one packet's payload per call, decrypted where the transport received it.
+ */
+#define CHANNEL_BUFFER_HEADROOM 16u
+#define CHANNEL_BUFFER_TAILROOM OCKAM_VAULT_AEAD_AES_GCM_TAG_LENGTH
+
+/**
+ * Session resumption. A client that kept the session of an earlier channel to the same server reconnects in one round
+ * trip without a key agreement: it sends the session's id and a nonce, the server answers with its own nonce and both
+ * derive the channel's keys from the session's secret and the two nonces (see ockam_xx_key_resume). A server that
+ * does not know the session declines and the channel falls back to the full handshake. Either way the channel then
+ * replaces the client's session with its own, and the server caches it.
+ *
+ * Sessions are single use, and a server resumes a session at most max_resumptions times in a row before requiring a
+ * full handshake again, as resumed channels have no forward secrecy of their own. Session secrets live in the vault, so
+ * a session is only usable by channels on the vault it was created with. The client's first message has no room for
+ * data: resumption saves the key agreement and a round trip, but is not 0-RTT, where early data could be replayed.
+ * Only servers with this support understand a resumption request, so clients should only keep sessions with them.
+ */
+#define CHANNEL_SESSION_ID_SIZE                 16u
+#define CHANNEL_SESSION_NONCE_SIZE              32u
+#define CHANNEL_SESSION_MAX_RESUMPTIONS_DEFAULT 16u
+
+typedef struct ockam_channel_session_t {
+  uint8_t              id[CHANNEL_SESSION_ID_SIZE];
+  ockam_vault_secret_t secret;      /*!< No context when there is no session */
+  uint32_t             resumptions; /*!< Resumptions since the session's full handshake */
+} ockam_channel_session_t;
+
+typedef struct ockam_channel_session_cache_t {
+  ockam_memory_t*          memory;
+  ockam_vault_t*           vault;
+  ockam_channel_session_t* sessions;
+  size_t                   capacity;
+  size_t                   next;     /*!< Slot the next session goes to, replacing the oldest */
+  uint32_t                 max_resumptions;
+  uint64_t                 resumed;  /*!< Resumption requests accepted */
+  uint64_t                 declined; /*!< Resumption requests for sessions the cache did not have */
+} ockam_channel_session_cache_t;
+
+/**
+ * @brief   Initialize the server's cache of sessions clients may resume. Like its vault, a cache is not thread safe.
+ * @param   capacity        [in] - Sessions kept, the oldest is dropped first.
+ * @param   max_resumptions [in] - Resumptions in a row allowed per session, 0 for the default.
+ */
+ockam_error_t ockam_channel_session_cache_init(ockam_channel_session_cache_t* cache,
+                                               ockam_memory_t*                memory,
+                                               ockam_vault_t*                 vault,
+                                               size_t                         capacity,
+                                               uint32_t                       max_resumptions);
+ockam_error_t ockam_channel_session_cache_deinit(ockam_channel_session_cache_t* cache);
+
+/**
+ * @brief   Forget a client's session, destroying its secret.
+ */
+ockam_error_t ockam_channel_session_deinit(ockam_vault_t* vault, ockam_channel_session_t* session);
+
 typedef struct ockam_channel_attributes_t {
-  ockam_reader_t* reader;
-  ockam_writer_t* writer;
-  ockam_memory_t* memory;
-  ockam_vault_t*  vault;
+  ockam_reader_t*                reader;
+  ockam_writer_t*                writer;
+  ockam_memory_t*                memory;
+  ockam_vault_t*                 vault;
+  size_t                         max_packet_size; /*!< 0 for 32KiB, else at least that and at most UINT32_MAX */
+  uint64_t                       rekey_interval;  /*!< Packets per key and direction, 0 never; must match the peer */
+  ockam_xx_key_pool_t*           key_pool;        /*!< Optional source of handshake keypairs, may be shared */
+  ockam_xx_static_key_t*         static_key;      /*!< Optional long-term identity on vault, else one per handshake */
+  ockam_channel_session_t*       session;         /*!< Connect: session to resume, replaced by this channel's */
+  ockam_channel_session_cache_t* session_cache;   /*!< Accept: sessions clients may resume, gets this channel's */
+  ockam_mutex_t*                 mutex;           /*!< Optional, needed to write while another thread reads */
 } ockam_channel_attributes_t;
 
 ockam_error_t ockam_channel_init(ockam_channel_t* channel, ockam_channel_attributes_t* p_attrs);
 ockam_error_t ockam_channel_connect(ockam_channel_t* p_channel, ockam_reader_t** p_reader, ockam_writer_t** p_writer);
 ockam_error_t ockam_channel_accept(ockam_channel_t* p_channel, ockam_reader_t** p_reader, ockam_writer_t** p_writer);
+
+/**
+ * @brief   Check that the peer is still there: send a PING and read until its PONG arrives.
+ *
+ * A secure channel answers a PING from its peer with a PONG from whichever call is reading it at the time, so the peer
+ * must be reading the channel and must not be writing to it from another thread meanwhile. Only peers with this
+ * support answer, older ones ignore the PING. Meant for idle channels: a payload arriving before the PONG fails the
+ * ping with CHANNEL_ERROR_STATE, as does a payload left over from a short read. The wait is only bounded by the
+ * transport, e.g. by a receive timeout on its socket.
+ */
+ockam_error_t ockam_channel_ping(ockam_channel_t* channel);
 ockam_error_t ockam_channel_deinit(ockam_channel_t* channel);
 
 #endif
@@ -12,13 +12,10 @@
 #include "ockam/channel/channel_impl.h"
 #include "ockam/codec.h"
 
-ockam_memory_t* gp_ockam_channel_memory = NULL;
-
 ockam_error_t channel_read(void*, uint8_t*, size_t, size_t*);
 ockam_error_t channel_write(void*, uint8_t*, size_t);
-
-uint8_t g_encoded_text[MAX_CHANNEL_PACKET_SIZE];
-uint8_t g_cipher_text[MAX_CHANNEL_PACKET_SIZE];
+ockam_error_t channel_read_buffer(void*, ockam_buffer_t**);
+ockam_error_t channel_write_buffer(void*, ockam_buffer_t*);
 
 uint8_t* channel_encode_header(ockam_channel_t* p_ch, uint8_t* p_encoded)
 {
@@ -50,21 +47,37 @@ exit:
   return p_encoded;
 }
 
-ockam_error_t channel_decrypt(ockam_channel_t* p_ch,
-                              uint8_t*         p_cipher_text,
-                              size_t           cipher_text_length,
-                              uint8_t*         p_encoded_text,
-                              size_t           encoded_text_size,
-                              size_t*          p_encoded_text_length)
+/*
+ * A channel given a mutex may be read on one thread and written on another. The key's nonces, send_buffer and the
+ * vault behind them are then shared, so sealing and writing a packet, and opening one, hold the channel's key lock.
+ */
+ockam_error_t channel_key_lock(ockam_channel_t* p_ch)
+{
+  if (NULL == p_ch->mutex) return OCKAM_ERROR_NONE;
+  return ockam_mutex_lock(p_ch->mutex, p_ch->key_lock);
+}
+
+ockam_error_t channel_key_unlock(ockam_channel_t* p_ch, ockam_error_t error)
+{
+  ockam_error_t unlock_error = OCKAM_ERROR_NONE;
+
+  if (NULL == p_ch->mutex) return error;
+  unlock_error = ockam_mutex_unlock(p_ch->mutex, p_ch->key_lock);
+  return error ? error : unlock_error;
+}
+
+ockam_error_t
+channel_decrypt(ockam_channel_t* p_ch, uint8_t* p_buffer, size_t cipher_text_length, size_t* p_encoded_text_length)
 {
   ockam_error_t error = OCKAM_ERROR_NONE;
 
   if (CHANNEL_STATE_SECURE == p_ch->state) {
-    error = ockam_key_decrypt(
-      &p_ch->key, p_encoded_text, encoded_text_size, p_cipher_text, cipher_text_length, p_encoded_text_length);
+    error = channel_key_lock(p_ch);
+    if (error) goto exit;
+    error = ockam_key_decrypt_in_place(&p_ch->key, p_buffer, cipher_text_length, p_encoded_text_length);
+    error = channel_key_unlock(p_ch, error);
     if (error) goto exit;
   } else {
-    ockam_memory_copy(gp_ockam_channel_memory, p_encoded_text, p_cipher_text, cipher_text_length);
     *p_encoded_text_length = cipher_text_length;
   }
 exit:
@@ -72,19 +85,172 @@ exit:
   return error;
 }
 
-ockam_error_t channel_process_message(uint8_t* p_encoded,
-                                      size_t   encoded_text_length,
-                                      uint8_t* p_clear_text,
-                                      size_t*  p_clear_text_length)
+/*
+ * Apply the options a PING carries. *pp_ping_id is left pointing at the value of a ping id option, NULL without one.
+ */
+ockam_error_t
+channel_process_options(ockam_channel_t* p_ch, uint8_t* p_options, size_t options_length, uint8_t** pp_ping_id)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+  size_t        value = 0;
+
+  *pp_ping_id = NULL;
+
+  // Options are (id, length, value) triplets; unknown ids are skipped
+  while (options_length >= 2) {
+    uint8_t id     = p_options[0];
+    uint8_t length = p_options[1];
+    p_options += 2;
+    options_length -= 2;
+    if (length > options_length) {
+      error = CHANNEL_ERROR_PARAMS;
+      goto exit;
+    }
+
+    if ((CHANNEL_OPTION_MAX_PACKET_SIZE == id) && (sizeof(uint32_t) == length)) {
+      value = ((size_t) p_options[0] << 24u) | ((size_t) p_options[1] << 16u) | ((size_t) p_options[2] << 8u) |
+              p_options[3];
+      if (value > p_ch->buffer_size) value = p_ch->buffer_size;
+      if (value > MAX_CHANNEL_PACKET_SIZE) p_ch->send_packet_size = value;
+    }
+    if ((CHANNEL_OPTION_PING_ID == id) && (sizeof(uint64_t) == length)) *pp_ping_id = p_options;
+
+    p_options += length;
+    options_length -= length;
+  }
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+uint64_t channel_decode_ping_id(const uint8_t* p_value)
+{
+  uint64_t id = 0;
+  size_t   i  = 0;
+
+  for (i = 0; i < sizeof(uint64_t); i++) id = (id << 8u) | p_value[i];
+  return id;
+}
+
+/*
+ * Send a PING or a PONG carrying the given options
+ */
+ockam_error_t channel_send_control(ockam_channel_t*     p_ch,
+                                   codec_message_type_t message_type,
+                                   const uint8_t*       p_options,
+                                   size_t               options_length)
 {
-  ockam_error_t        error        = OCKAM_ERROR_NONE;
-  codec_message_type_t message_type = *p_encoded++;
+  ockam_error_t error              = OCKAM_ERROR_NONE;
+  size_t        cipher_text_length = 0;
+  uint8_t*      p_encoded          = p_ch->send_buffer;
+
+  error = channel_key_lock(p_ch);
+  if (error) goto exit;
+
+  p_encoded = channel_encode_header(p_ch, p_encoded);
+  if (!p_encoded) {
+    error = CHANNEL_ERROR_NOT_IMPLEMENTED;
+    goto unlock;
+  }
+
+  *p_encoded++ = message_type;
+  ockam_memory_copy(p_ch->memory, p_encoded, p_options, options_length);
+  p_encoded += options_length;
+
+  error = ockam_key_encrypt_in_place(
+    &p_ch->key, p_ch->send_buffer, p_encoded - p_ch->send_buffer, p_ch->buffer_size, &cipher_text_length);
+  if (error) goto unlock;
+
+  error = ockam_write(p_ch->transport_writer, p_ch->send_buffer, cipher_text_length);
+
+unlock:
+  error = channel_key_unlock(p_ch, error);
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t channel_send_options(ockam_channel_t* p_ch)
+{
+  uint8_t options[2 + sizeof(uint32_t)];
+
+  options[0] = CHANNEL_OPTION_MAX_PACKET_SIZE;
+  options[1] = sizeof(uint32_t);
+  options[2] = (uint8_t)(p_ch->buffer_size >> 24u);
+  options[3] = (uint8_t)(p_ch->buffer_size >> 16u);
+  options[4] = (uint8_t)(p_ch->buffer_size >> 8u);
+  options[5] = (uint8_t) p_ch->buffer_size;
+
+  return channel_send_control(p_ch, PING, options, sizeof(options));
+}
+
+/*
+ * Decrypt a received packet in place and decode its header. On return p_encoded points at the message type, or is
+ * NULL for a PING or a PONG, which are not returned to the reader. A PING with a ping id is answered right away with a
+ * PONG echoing it, a PONG echoing the id of the last ockam_channel_ping() marks it answered.
+ */
+ockam_error_t channel_open_packet(ockam_channel_t* p_ch,
+                                  uint8_t*         p_packet,
+                                  size_t           cipher_text_length,
+                                  uint8_t**        pp_encoded,
+                                  size_t*          p_encoded_text_length)
+{
+  ockam_error_t error     = OCKAM_ERROR_NONE;
+  uint8_t*      p_encoded = NULL;
+  uint8_t*      p_ping_id = NULL;
+
+  *pp_encoded = NULL;
+
+  error = channel_decrypt(p_ch, p_packet, cipher_text_length, p_encoded_text_length);
+  if (error) goto exit;
+
+  p_encoded = channel_deocde_header(p_ch, p_packet);
+  if (NULL == p_encoded) {
+    error = CHANNEL_ERROR_NOT_IMPLEMENTED;
+    goto exit;
+  }
+
+  if ((CHANNEL_STATE_SECURE == p_ch->state) && ((PING == *p_encoded) || (PONG == *p_encoded))) {
+    error = channel_process_options(
+      p_ch, p_encoded + 1, *p_encoded_text_length - (p_encoded + 1 - p_packet), &p_ping_id);
+    if (error) goto exit;
+
+    // The PONG echoes the ping id option as it arrived, header included
+    if (p_ping_id && (PING == *p_encoded)) {
+      error = channel_send_control(p_ch, PONG, p_ping_id - 2, 2 + sizeof(uint64_t));
+      if (error) goto exit;
+    } else if (p_ping_id && (channel_decode_ping_id(p_ping_id) == p_ch->ping_id)) {
+      p_ch->pong_received = 1;
+    }
+    p_encoded = NULL;
+  }
+
+  *pp_encoded = p_encoded;
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t channel_process_message(ockam_channel_t* p_ch,
+                                      uint8_t*         p_encoded,
+                                      size_t           encoded_text_length,
+                                      uint8_t*         p_clear_text,
+                                      size_t           clear_text_size,
+                                      size_t*          p_clear_text_length)
+{
+  ockam_error_t        error          = OCKAM_ERROR_NONE;
+  codec_message_type_t message_type   = *p_encoded++;
+  size_t               payload_length = encoded_text_length - sizeof(uint8_t);
   switch (message_type) {
-  case PING:
-    break;
   case PAYLOAD:
-    *p_clear_text_length = encoded_text_length - sizeof(uint8_t);
-    ockam_memory_copy(gp_ockam_channel_memory, p_clear_text, p_encoded, *p_clear_text_length);
+    // Whatever does not fit is handed out by the next reads
+    *p_clear_text_length = payload_length < clear_text_size ? payload_length : clear_text_size;
+    ockam_memory_copy(p_ch->memory, p_clear_text, p_encoded, *p_clear_text_length);
+    p_ch->pending_offset = (p_encoded - p_ch->buffer) + *p_clear_text_length;
+    p_ch->pending_length = payload_length - *p_clear_text_length;
     break;
   default:
     error = CHANNEL_ERROR_NOT_IMPLEMENTED;
@@ -99,30 +265,75 @@ ockam_error_t ockam_channel_init(ockam_channel_t* p_ch, ockam_channel_attributes
 {
   ockam_error_t error = OCKAM_ERROR_NONE;
 
-  if ((NULL == p_ch) || (NULL == p_attrs) || (NULL == p_attrs->reader) || (NULL == p_attrs->writer) ||
-      (NULL == p_attrs->memory)) {
+  if (NULL == p_ch) {
+    error = CHANNEL_ERROR_PARAMS;
+    goto exit;
+  }
+
+  // Nothing below may fail with fields left over from a previous use, the cleanup at exit relies on them
+  memset(p_ch, 0, sizeof(*p_ch));
+
+  if ((NULL == p_attrs) || (NULL == p_attrs->reader) || (NULL == p_attrs->writer) || (NULL == p_attrs->memory)) {
+    error = CHANNEL_ERROR_PARAMS;
+    goto exit;
+  }
+
+  if ((p_attrs->max_packet_size && (p_attrs->max_packet_size < MAX_CHANNEL_PACKET_SIZE)) ||
+      (p_attrs->max_packet_size > UINT32_MAX)) {
     error = CHANNEL_ERROR_PARAMS;
     goto exit;
   }
 
-  gp_ockam_channel_memory = p_attrs->memory;
-  p_ch->vault             = p_attrs->vault;
+  p_ch->memory           = p_attrs->memory;
+  p_ch->vault            = p_attrs->vault;
+  p_ch->buffer_size      = p_attrs->max_packet_size ? p_attrs->max_packet_size : MAX_CHANNEL_PACKET_SIZE;
+  p_ch->send_packet_size = MAX_CHANNEL_PACKET_SIZE;
+  p_ch->pending_offset   = 0;
+  p_ch->pending_length   = 0;
+  p_ch->session          = p_attrs->session;
+  p_ch->session_cache    = p_attrs->session_cache;
+  p_ch->resumptions      = 0;
+  p_ch->ping_id          = 0;
+  p_ch->pong_received    = 0;
+  p_ch->mutex            = p_attrs->mutex;
+
+  if (p_ch->mutex) {
+    error = ockam_mutex_create(p_ch->mutex, &p_ch->key_lock);
+    if (error) goto exit;
+  }
+
+  error = ockam_memory_alloc_zeroed(p_ch->memory, (void**) &p_ch->buffer, p_ch->buffer_size);
+  if (error) goto exit;
+
+  error = ockam_memory_alloc_zeroed(p_ch->memory, (void**) &p_ch->send_buffer, p_ch->buffer_size);
+  if (error) goto exit;
 
-  error = ockam_memory_alloc_zeroed(gp_ockam_channel_memory, (void**) &p_ch->channel_reader, sizeof(ockam_reader_t));
+  error = ockam_memory_alloc_zeroed(p_ch->memory, (void**) &p_ch->channel_reader, sizeof(ockam_reader_t));
   if (error) goto exit;
-  p_ch->channel_reader->read = channel_read;
-  p_ch->channel_reader->ctx  = p_ch;
+  p_ch->channel_reader->read        = channel_read;
+  p_ch->channel_reader->ctx         = p_ch;
+  p_ch->channel_reader->read_buffer = channel_read_buffer;
 
-  error = ockam_memory_alloc_zeroed(gp_ockam_channel_memory, (void**) &p_ch->channel_writer, sizeof(ockam_writer_t));
+  error = ockam_memory_alloc_zeroed(p_ch->memory, (void**) &p_ch->channel_writer, sizeof(ockam_writer_t));
   if (error) goto exit;
-  p_ch->channel_writer->write = channel_write;
-  p_ch->channel_writer->ctx   = p_ch;
+  p_ch->channel_writer->write        = channel_write;
+  p_ch->channel_writer->ctx          = p_ch;
+  p_ch->channel_writer->write_buffer = channel_write_buffer;
 
   p_ch->transport_reader = p_attrs->reader;
   p_ch->transport_writer = p_attrs->writer;
 
-  error = ockam_xx_key_initialize(
-    &p_ch->key, gp_ockam_channel_memory, p_ch->vault, p_ch->channel_reader, p_ch->channel_writer);
+  error = ockam_xx_key_initialize(&p_ch->key, p_ch->memory, p_ch->vault, p_ch->channel_reader, p_ch->channel_writer);
+  if (error) goto exit;
+
+  error = ockam_xx_key_rekey_interval_set(&p_ch->key, p_attrs->rekey_interval);
+  if (error) goto exit;
+
+  error = ockam_xx_key_pool_set(&p_ch->key, p_attrs->key_pool);
+  if (error) goto exit;
+
+  error = ockam_xx_key_static_key_set(&p_ch->key, p_attrs->static_key);
+  if (error) goto exit;
 
   p_ch->state = CHANNEL_STATE_M1;
 
@@ -130,21 +341,259 @@ exit:
   if (error) {
     ockam_log_error("%x", error);
     if (p_ch) {
-      if (p_ch->channel_reader)
-        ockam_memory_free(gp_ockam_channel_memory, (void*) p_ch->channel_reader, sizeof(ockam_reader_t));
-      if (p_ch->channel_writer)
-        ockam_memory_free(gp_ockam_channel_memory, (void*) p_ch->channel_writer, sizeof(ockam_writer_t));
+      if (p_ch->key.context) ockam_key_deinit(&p_ch->key);
+      if (p_ch->buffer) ockam_memory_free(p_ch->memory, (void*) p_ch->buffer, p_ch->buffer_size);
+      if (p_ch->send_buffer) ockam_memory_free(p_ch->memory, (void*) p_ch->send_buffer, p_ch->buffer_size);
+      if (p_ch->channel_reader) ockam_memory_free(p_ch->memory, (void*) p_ch->channel_reader, sizeof(ockam_reader_t));
+      if (p_ch->channel_writer) ockam_memory_free(p_ch->memory, (void*) p_ch->channel_writer, sizeof(ockam_writer_t));
+      if (p_ch->key_lock) ockam_mutex_destroy(p_ch->mutex, p_ch->key_lock);
+      memset(p_ch, 0, sizeof(*p_ch));
     }
   }
-  return 0;
+  return error;
 }
 
-ockam_error_t ockam_channel_connect(ockam_channel_t* p_ch, ockam_reader_t** p_reader, ockam_writer_t** p_writer)
+/*
+ * Decode the header of a packet read straight from the transport during connect or accept, leaving p_encoded at the
+ * message type.
+ */
+ockam_error_t channel_open_handshake_packet(ockam_channel_t* p_ch,
+                                            size_t           packet_length,
+                                            uint8_t**        pp_encoded,
+                                            size_t*          p_remaining)
 {
-  ockam_error_t error = 0;
+  ockam_error_t error     = OCKAM_ERROR_NONE;
+  uint8_t*      p_encoded = channel_deocde_header(p_ch, p_ch->buffer);
+
+  if (!p_encoded || (p_encoded >= p_ch->buffer + packet_length)) {
+    error = CHANNEL_ERROR_KEY_AGREEMENT;
+    goto exit;
+  }
+
+  *pp_encoded  = p_encoded;
+  *p_remaining = packet_length - (p_encoded + 1 - p_ch->buffer);
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+/*
+ * Ask the server to resume the client's session: REQUEST_RESUME carries the session id and the client's nonce, the
+ * server answers RESUME_ACCEPT with its nonce and the client's sealed under the resumed key, or RESUME_REJECT.
+ * *p_resumed is 0 when the server rejected the session, which is then forgotten.
+ */
+ockam_error_t channel_resume_initiate(ockam_channel_t* p_ch, int* p_resumed)
+{
+  ockam_error_t            error          = OCKAM_ERROR_NONE;
+  ockam_channel_session_t* p_session      = p_ch->session;
+  uint8_t                  nonces[2 * CHANNEL_SESSION_NONCE_SIZE];
+  uint8_t*                 p_encoded      = NULL;
+  size_t                   packet_length  = 0;
+  size_t                   remaining      = 0;
+  size_t                   confirm_length = 0;
+  int                      result         = 0;
+  codec_message_type_t     message_type;
+
+  *p_resumed = 0;
+
+  error = ockam_vault_random_bytes_generate(p_ch->vault, nonces, CHANNEL_SESSION_NONCE_SIZE);
+  if (error) goto exit;
+
+  p_encoded = channel_encode_header(p_ch, p_ch->send_buffer);
+  if (!p_encoded) {
+    error = CHANNEL_ERROR_NOT_IMPLEMENTED;
+    goto exit;
+  }
+  *p_encoded++ = REQUEST_RESUME;
+  ockam_memory_copy(p_ch->memory, p_encoded, p_session->id, CHANNEL_SESSION_ID_SIZE);
+  p_encoded += CHANNEL_SESSION_ID_SIZE;
+  ockam_memory_copy(p_ch->memory, p_encoded, nonces, CHANNEL_SESSION_NONCE_SIZE);
+  p_encoded += CHANNEL_SESSION_NONCE_SIZE;
 
-  error = ockam_key_initiate(&p_ch->key);
+  error = ockam_write(p_ch->transport_writer, p_ch->send_buffer, p_encoded - p_ch->send_buffer);
   if (error) goto exit;
+
+  error = ockam_read(p_ch->transport_reader, p_ch->buffer, p_ch->buffer_size, &packet_length);
+  if (error) goto exit;
+
+  error = channel_open_handshake_packet(p_ch, packet_length, &p_encoded, &remaining);
+  if (error) goto exit;
+  message_type = *p_encoded++;
+
+  if ((RESUME_REJECT == message_type) && !remaining) {
+    error = ockam_channel_session_deinit(p_ch->vault, p_session);
+    goto exit;
+  }
+
+  if ((RESUME_ACCEPT != message_type) ||
+      (2 * CHANNEL_SESSION_NONCE_SIZE + OCKAM_VAULT_AEAD_AES_GCM_TAG_LENGTH != remaining)) {
+    error = CHANNEL_ERROR_KEY_AGREEMENT;
+    goto exit;
+  }
+  ockam_memory_copy(p_ch->memory, nonces + CHANNEL_SESSION_NONCE_SIZE, p_encoded, CHANNEL_SESSION_NONCE_SIZE);
+  p_encoded += CHANNEL_SESSION_NONCE_SIZE;
+
+  error = ockam_xx_key_resume(&p_ch->key, &p_session->secret, nonces, sizeof(nonces), 1);
+  if (error) goto exit;
+
+  // The server proves it holds the session and derived the same keys by sealing the client's nonce
+  error = ockam_key_decrypt_in_place(
+    &p_ch->key, p_encoded, CHANNEL_SESSION_NONCE_SIZE + OCKAM_VAULT_AEAD_AES_GCM_TAG_LENGTH, &confirm_length);
+  if (error) goto exit;
+
+  ockam_memory_compare(p_ch->memory, &result, p_encoded, nonces, CHANNEL_SESSION_NONCE_SIZE);
+  if ((CHANNEL_SESSION_NONCE_SIZE != confirm_length) || result) {
+    error = CHANNEL_ERROR_KEY_AGREEMENT;
+    goto exit;
+  }
+
+  p_ch->resumptions = p_session->resumptions + 1;
+  p_ch->state       = CHANNEL_STATE_SECURE;
+  *p_resumed        = 1;
+
+  error = ockam_channel_session_deinit(p_ch->vault, p_session);
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+/*
+ * Answer a REQUEST_RESUME. A session the cache does not have is rejected and *p_resumed left 0, the client then
+ * starts the full handshake.
+ */
+ockam_error_t channel_resume_respond(ockam_channel_t* p_ch, uint8_t* p_request, int* p_resumed)
+{
+  ockam_error_t           error          = OCKAM_ERROR_NONE;
+  ockam_channel_session_t session        = { 0 };
+  uint8_t                 nonces[2 * CHANNEL_SESSION_NONCE_SIZE];
+  uint8_t*                p_encoded      = NULL;
+  size_t                  confirm_length = 0;
+
+  *p_resumed = 0;
+
+  if (p_ch->session_cache) {
+    error = channel_session_cache_take(p_ch->session_cache, p_request, &session);
+    if (error) goto exit;
+  }
+
+  p_encoded = channel_encode_header(p_ch, p_ch->send_buffer);
+  if (!p_encoded) {
+    error = CHANNEL_ERROR_NOT_IMPLEMENTED;
+    goto exit;
+  }
+
+  if (!session.secret.context) {
+    if (p_ch->session_cache) p_ch->session_cache->declined++;
+    *p_encoded++ = RESUME_REJECT;
+    error        = ockam_write(p_ch->transport_writer, p_ch->send_buffer, p_encoded - p_ch->send_buffer);
+    goto exit;
+  }
+
+  ockam_memory_copy(p_ch->memory, nonces, p_request + CHANNEL_SESSION_ID_SIZE, CHANNEL_SESSION_NONCE_SIZE);
+  error =
+    ockam_vault_random_bytes_generate(p_ch->vault, nonces + CHANNEL_SESSION_NONCE_SIZE, CHANNEL_SESSION_NONCE_SIZE);
+  if (error) goto exit;
+
+  error = ockam_xx_key_resume(&p_ch->key, &session.secret, nonces, sizeof(nonces), 0);
+  if (error) goto exit;
+
+  *p_encoded++ = RESUME_ACCEPT;
+  ockam_memory_copy(p_ch->memory, p_encoded, nonces + CHANNEL_SESSION_NONCE_SIZE, CHANNEL_SESSION_NONCE_SIZE);
+  p_encoded += CHANNEL_SESSION_NONCE_SIZE;
+
+  ockam_memory_copy(p_ch->memory, p_encoded, nonces, CHANNEL_SESSION_NONCE_SIZE);
+  error = ockam_key_encrypt_in_place(&p_ch->key,
+                                     p_encoded,
+                                     CHANNEL_SESSION_NONCE_SIZE,
+                                     p_ch->buffer_size - (p_encoded - p_ch->send_buffer),
+                                     &confirm_length);
+  if (error) goto exit;
+
+  error = ockam_write(p_ch->transport_writer, p_ch->send_buffer, p_encoded + confirm_length - p_ch->send_buffer);
+  if (error) goto exit;
+
+  p_ch->session_cache->resumed++;
+  p_ch->resumptions = session.resumptions + 1;
+  p_ch->state       = CHANNEL_STATE_SECURE;
+  *p_resumed        = 1;
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  if (session.secret.context) ockam_channel_session_deinit(p_ch->vault, &session);
+  return error;
+}
+
+/*
+ * Run the responder's side of the handshake from an M1 that accept has already read.
+ */
+ockam_error_t channel_handshake_respond(ockam_channel_t* p_ch, uint8_t* p_m1, size_t m1_length)
+{
+  ockam_error_t               error = OCKAM_ERROR_NONE;
+  uint8_t                     input[OCKAM_XX_HANDSHAKE_MESSAGE_MAX_SIZE];
+  uint8_t                     output[OCKAM_XX_HANDSHAKE_MESSAGE_MAX_SIZE];
+  size_t                      input_length  = m1_length;
+  size_t                      output_length = 0;
+  ockam_xx_handshake_status_t status        = OCKAM_XX_HANDSHAKE_WANT_INPUT;
+
+  if (m1_length > sizeof(input)) {
+    error = CHANNEL_ERROR_KEY_AGREEMENT;
+    goto exit;
+  }
+  ockam_memory_copy(p_ch->memory, input, p_m1, m1_length);
+  p_ch->state = CHANNEL_STATE_M2;
+
+  error = ockam_xx_key_handshake_start(&p_ch->key, 0);
+  if (error) goto exit;
+
+  while (OCKAM_XX_HANDSHAKE_WANT_INPUT == status) {
+    error =
+      ockam_xx_key_handshake_step(&p_ch->key, input, input_length, output, sizeof(output), &output_length, &status);
+    if (error) goto exit;
+
+    if (output_length) {
+      error = channel_write(p_ch, output, output_length);
+      if (error) goto exit;
+    }
+
+    if (OCKAM_XX_HANDSHAKE_WANT_INPUT == status) {
+      error = channel_read(p_ch, input, sizeof(input), &input_length);
+      if (error) goto exit;
+    }
+  }
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t ockam_channel_connect(ockam_channel_t* p_ch, ockam_reader_t** p_reader, ockam_writer_t** p_writer)
+{
+  ockam_error_t error   = 0;
+  int           resumed = 0;
+
+  if (p_ch->session && p_ch->session->secret.context) {
+    error = channel_resume_initiate(p_ch, &resumed);
+    if (error) goto exit;
+  }
+
+  if (!resumed) {
+    error = ockam_key_initiate(&p_ch->key);
+    if (error) goto exit;
+  }
+
+  if (p_ch->session) {
+    error = channel_session_derive(p_ch, p_ch->session);
+    if (error) goto exit;
+    p_ch->session->resumptions = p_ch->resumptions;
+  }
+
+  if (p_ch->buffer_size > MAX_CHANNEL_PACKET_SIZE) {
+    error = channel_send_options(p_ch);
+    if (error) goto exit;
+  }
+
   *p_reader = p_ch->channel_reader;
   *p_writer = p_ch->channel_writer;
 
@@ -155,12 +604,112 @@ exit:
 
 ockam_error_t ockam_channel_accept(ockam_channel_t* p_ch, ockam_reader_t** p_reader, ockam_writer_t** p_writer)
 {
-  ockam_error_t error = 0;
-  error               = ockam_key_respond(&p_ch->key);
+  ockam_error_t           error         = 0;
+  ockam_channel_session_t session       = { 0 };
+  uint8_t*                p_encoded     = NULL;
+  size_t                  packet_length = 0;
+  size_t                  remaining     = 0;
+  int                     resumed       = 0;
+
+  // The first packet either requests a channel, carrying M1, or the resumption of a session
+  error = ockam_read(p_ch->transport_reader, p_ch->buffer, p_ch->buffer_size, &packet_length);
+  if (error) goto exit;
+
+  error = channel_open_handshake_packet(p_ch, packet_length, &p_encoded, &remaining);
   if (error) goto exit;
+
+  switch (*p_encoded++) {
+  case REQUEST_CHANNEL:
+    error = channel_handshake_respond(p_ch, p_encoded, remaining);
+    break;
+  case REQUEST_RESUME:
+    if (CHANNEL_SESSION_ID_SIZE + CHANNEL_SESSION_NONCE_SIZE != remaining) {
+      error = CHANNEL_ERROR_KEY_AGREEMENT;
+      goto exit;
+    }
+    error = channel_resume_respond(p_ch, p_encoded, &resumed);
+    if (error) goto exit;
+    if (!resumed) error = ockam_key_respond(&p_ch->key);
+    break;
+  default:
+    error = CHANNEL_ERROR_KEY_AGREEMENT;
+  }
+  if (error) goto exit;
+
+  if (p_ch->session_cache) {
+    error = channel_session_derive(p_ch, &session);
+    if (error) goto exit;
+    session.resumptions = p_ch->resumptions;
+
+    error = channel_session_cache_put(p_ch->session_cache, &session);
+    if (error) goto exit;
+  }
+
+  if (p_ch->buffer_size > MAX_CHANNEL_PACKET_SIZE) {
+    error = channel_send_options(p_ch);
+    if (error) goto exit;
+  }
+
   *p_reader = p_ch->channel_reader;
   *p_writer = p_ch->channel_writer;
 
+exit:
+  if (error) ockam_log_error("%x", error);
+  if (session.secret.context) ockam_channel_session_deinit(p_ch->vault, &session);
+  return error;
+}
+
+/*
+ * Send a PING with the next ping id, without waiting for its PONG
+ */
+ockam_error_t channel_send_ping(ockam_channel_t* p_ch)
+{
+  uint8_t options[2 + sizeof(uint64_t)];
+  size_t  i = 0;
+
+  p_ch->ping_id++;
+  p_ch->pong_received = 0;
+  options[0]          = CHANNEL_OPTION_PING_ID;
+  options[1]          = sizeof(uint64_t);
+  for (i = 0; i < sizeof(uint64_t); i++) options[2 + i] = (uint8_t)(p_ch->ping_id >> (8u * (sizeof(uint64_t) - 1 - i)));
+
+  return channel_send_control(p_ch, PING, options, sizeof(options));
+}
+
+ockam_error_t ockam_channel_ping(ockam_channel_t* p_ch)
+{
+  ockam_error_t error              = OCKAM_ERROR_NONE;
+  uint8_t*      p_encoded          = NULL;
+  size_t        cipher_text_length = 0;
+  size_t        encoded_length     = 0;
+
+  if (NULL == p_ch) {
+    error = CHANNEL_ERROR_PARAMS;
+    goto exit;
+  }
+
+  // Packets read while waiting are decrypted into the channel's buffer, where they would overwrite a pending payload
+  if ((CHANNEL_STATE_SECURE != p_ch->state) || p_ch->pending_length) {
+    error = CHANNEL_ERROR_STATE;
+    goto exit;
+  }
+
+  error = channel_send_ping(p_ch);
+  if (error) goto exit;
+
+  while (!p_ch->pong_received) {
+    error = ockam_read(p_ch->transport_reader, p_ch->buffer, p_ch->buffer_size, &cipher_text_length);
+    if (error) goto exit;
+
+    error = channel_open_packet(p_ch, p_ch->buffer, cipher_text_length, &p_encoded, &encoded_length);
+    if (error) goto exit;
+
+    if (p_encoded) {
+      error = CHANNEL_ERROR_STATE;
+      goto exit;
+    }
+  }
+
 exit:
   if (error) ockam_log_error("%x", error);
   return error;
@@ -171,29 +720,42 @@ ockam_error_t channel_read(void* ctx, uint8_t* p_clear_text, size_t clear_text_s
   ockam_error_t    error               = 0;
   size_t           cipher_text_length  = 0;
   size_t           encoded_text_length = 0;
-  uint8_t*         p_encoded           = g_encoded_text;
   ockam_channel_t* p_ch                = (ockam_channel_t*) ctx;
+  uint8_t*         p_encoded           = p_ch->buffer;
 
-  error = ockam_read(p_ch->transport_reader, g_cipher_text, sizeof(g_cipher_text), &cipher_text_length);
-  if (error) goto exit;
-
-  error = channel_decrypt(
-    p_ch, g_cipher_text, cipher_text_length, g_encoded_text, sizeof(g_encoded_text), &encoded_text_length);
-  if (error) goto exit;
-
-  p_encoded = channel_deocde_header(p_ch, p_encoded);
-  if (NULL == p_encoded) {
-    error = CHANNEL_ERROR_NOT_IMPLEMENTED;
+  // Finish a packet that did not fit in the previous read
+  if (p_ch->pending_length) {
+    *p_clear_text_length = p_ch->pending_length < clear_text_size ? p_ch->pending_length : clear_text_size;
+    ockam_memory_copy(p_ch->memory, p_clear_text, p_ch->buffer + p_ch->pending_offset, *p_clear_text_length);
+    p_ch->pending_offset += *p_clear_text_length;
+    p_ch->pending_length -= *p_clear_text_length;
     goto exit;
   }
 
+  do {
+    error = ockam_read(p_ch->transport_reader, p_ch->buffer, p_ch->buffer_size, &cipher_text_length);
+    if (error) goto exit;
+
+    error = channel_open_packet(p_ch, p_ch->buffer, cipher_text_length, &p_encoded, &encoded_text_length);
+    if (error) goto exit;
+  } while (NULL == p_encoded);
+
   if (CHANNEL_STATE_SECURE == p_ch->state) {
-    error = channel_process_message(p_encoded, encoded_text_length, p_clear_text, p_clear_text_length);
+    error = channel_process_message(p_ch,
+                                    p_encoded,
+                                    encoded_text_length - (p_encoded - p_ch->buffer),
+                                    p_clear_text,
+                                    clear_text_size,
+                                    p_clear_text_length);
     if (error) goto exit;
   } else {
     codec_message_type_t message_type = *p_encoded++;
-    *p_clear_text_length              = encoded_text_length - (p_encoded - g_encoded_text);
-    ockam_memory_copy(gp_ockam_channel_memory, p_clear_text, p_encoded, *p_clear_text_length);
+    *p_clear_text_length              = encoded_text_length - (p_encoded - p_ch->buffer);
+    if (*p_clear_text_length > clear_text_size) {
+      error = CHANNEL_ERROR_PARAMS;
+      goto exit;
+    }
+    ockam_memory_copy(p_ch->memory, p_clear_text, p_encoded, *p_clear_text_length);
     switch (p_ch->state) {
     case CHANNEL_STATE_M1:
       if (REQUEST_CHANNEL != message_type) {
@@ -227,13 +789,41 @@ exit:
   return error;
 }
 
-ockam_error_t channel_write(void* ctx, uint8_t* p_clear_text, size_t clear_text_length)
+ockam_error_t channel_write_packets(ockam_channel_t* p_ch, uint8_t* p_clear_text, size_t clear_text_length)
 {
   ockam_error_t    error               = 0;
   size_t           cipher_text_length  = 0;
   size_t           encoded_text_length = 0;
-  uint8_t*         p_encoded           = g_encoded_text;
-  ockam_channel_t* p_ch                = (ockam_channel_t*) ctx;
+  size_t           chunk_length        = 0;
+  uint8_t*         p_encoded           = p_ch->send_buffer;
+
+  if (CHANNEL_STATE_SECURE == p_ch->state) {
+    // Payloads larger than the peer's packet size go out as a sequence of independently sealed packets
+    do {
+      p_encoded = channel_encode_header(p_ch, p_ch->send_buffer);
+      if (!p_encoded) {
+        error = CHANNEL_ERROR_NOT_IMPLEMENTED;
+        goto exit;
+      }
+      *p_encoded++ = PAYLOAD;
+
+      chunk_length = p_ch->send_packet_size - (p_encoded - p_ch->send_buffer) - OCKAM_VAULT_AEAD_AES_GCM_TAG_LENGTH;
+      if (chunk_length > clear_text_length) chunk_length = clear_text_length;
+
+      encoded_text_length = p_encoded - p_ch->send_buffer + chunk_length;
+      ockam_memory_copy(p_ch->memory, p_encoded, p_clear_text, chunk_length);
+      error = ockam_key_encrypt_in_place(
+        &p_ch->key, p_ch->send_buffer, encoded_text_length, p_ch->buffer_size, &cipher_text_length);
+      if (error) goto exit;
+
+      error = ockam_write(p_ch->transport_writer, p_ch->send_buffer, cipher_text_length);
+      if (error) goto exit;
+
+      p_clear_text += chunk_length;
+      clear_text_length -= chunk_length;
+    } while (clear_text_length);
+    goto exit;
+  }
 
   p_encoded = channel_encode_header(p_ch, p_encoded);
   if (!p_encoded) {
@@ -241,44 +831,181 @@ ockam_error_t channel_write(void* ctx, uint8_t* p_clear_text, size_t clear_text_
     goto exit;
   }
 
-  if (CHANNEL_STATE_SECURE == p_ch->state) {
-    *p_encoded++        = PAYLOAD;
-    encoded_text_length = p_encoded - g_encoded_text + clear_text_length;
-    ockam_memory_copy(gp_ockam_channel_memory, p_encoded, p_clear_text, clear_text_length);
-    error = ockam_key_encrypt(
-      &p_ch->key, g_encoded_text, encoded_text_length, g_cipher_text, sizeof(g_cipher_text), &cipher_text_length);
+  /* Room for the message type and the clear text */
+  if ((p_encoded - p_ch->send_buffer) + 1 + clear_text_length > p_ch->buffer_size) {
+    error = CHANNEL_ERROR_PARAMS;
+    goto exit;
+  }
+
+  switch (p_ch->state) {
+  case CHANNEL_STATE_M1:
+    *p_encoded++ = REQUEST_CHANNEL;
+    p_ch->state  = CHANNEL_STATE_M2;
+    break;
+  case CHANNEL_STATE_M2:
+    *p_encoded++ = KEY_AGREEMENT_T1_M2;
+    p_ch->state  = CHANNEL_STATE_M3;
+    break;
+  case CHANNEL_STATE_M3:
+    *p_encoded++ = KEY_AGREEMENT_T1_M3;
+    p_ch->state  = CHANNEL_STATE_SECURE;
+    break;
+  default:
+    error = CHANNEL_ERROR_NOT_IMPLEMENTED;
+    goto exit;
+  }
+  encoded_text_length = p_encoded - p_ch->send_buffer + clear_text_length;
+  cipher_text_length  = encoded_text_length;
+  ockam_memory_copy(p_ch->memory, p_encoded, p_clear_text, clear_text_length);
+
+  error = ockam_write(p_ch->transport_writer, p_ch->send_buffer, cipher_text_length);
+  if (error) goto exit;
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t channel_write(void* ctx, uint8_t* p_clear_text, size_t clear_text_length)
+{
+  ockam_error_t    error = OCKAM_ERROR_NONE;
+  ockam_channel_t* p_ch  = (ockam_channel_t*) ctx;
+
+  error = channel_key_lock(p_ch);
+  if (error) goto exit;
+
+  error = channel_write_packets(p_ch, p_clear_text, clear_text_length);
+  error = channel_key_unlock(p_ch, error);
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+/*
+ * Return the next payload in a buffer of its own. When the transport reads into buffers as well, the packet is
+ * decrypted where it landed and the payload handed up without being copied.
+ */
+ockam_error_t channel_read_buffer(void* ctx, ockam_buffer_t** pp_buffer)
+{
+  ockam_error_t        error               = OCKAM_ERROR_NONE;
+  ockam_channel_t*     p_ch                = (ockam_channel_t*) ctx;
+  ockam_buffer_t*      p_buffer            = NULL;
+  uint8_t*             p_encoded           = NULL;
+  size_t               encoded_text_length = 0;
+  size_t               header_length       = 0;
+  codec_message_type_t message_type;
+
+  if (CHANNEL_STATE_SECURE != p_ch->state) {
+    error = CHANNEL_ERROR_STATE;
+    goto exit;
+  }
+
+  // Finish a packet that did not fit in a previous ockam_read()
+  if (p_ch->pending_length) {
+    error = ockam_buffer_alloc(p_ch->memory, 0, p_ch->pending_length, &p_buffer);
     if (error) goto exit;
-  } else {
-    switch (p_ch->state) {
-    case CHANNEL_STATE_M1:
-      *p_encoded++ = REQUEST_CHANNEL;
-      p_ch->state  = CHANNEL_STATE_M2;
-      break;
-    case CHANNEL_STATE_M2:
-      *p_encoded++ = KEY_AGREEMENT_T1_M2;
-      p_ch->state  = CHANNEL_STATE_M3;
-      break;
-    case CHANNEL_STATE_M3:
-      *p_encoded++ = KEY_AGREEMENT_T1_M3;
-      p_ch->state  = CHANNEL_STATE_SECURE;
-      break;
-    case CHANNEL_STATE_SECURE:
-      break;
-    default:
-      error = CHANNEL_ERROR_NOT_IMPLEMENTED;
-      goto exit;
+    ockam_memory_copy(
+      p_ch->memory, ockam_buffer_data(p_buffer), p_ch->buffer + p_ch->pending_offset, p_ch->pending_length);
+    p_buffer->length     = p_ch->pending_length;
+    p_ch->pending_offset = 0;
+    p_ch->pending_length = 0;
+    *pp_buffer           = p_buffer;
+    p_buffer             = NULL;
+    goto exit;
+  }
+
+  do {
+    ockam_buffer_release(p_buffer);
+    p_buffer = NULL;
+
+    error = ockam_read_buffer(p_ch->transport_reader, &p_buffer);
+    if (IO_ERROR_NOT_SUPPORTED == error) {
+      error = ockam_buffer_alloc(p_ch->memory, 0, p_ch->buffer_size, &p_buffer);
+      if (error) goto exit;
+      error = ockam_read(p_ch->transport_reader, ockam_buffer_data(p_buffer), p_ch->buffer_size, &p_buffer->length);
     }
-    encoded_text_length = p_encoded - g_encoded_text + clear_text_length;
-    cipher_text_length  = encoded_text_length;
-    ockam_memory_copy(gp_ockam_channel_memory, p_encoded, p_clear_text, clear_text_length);
-    ockam_memory_copy(gp_ockam_channel_memory, g_cipher_text, g_encoded_text, encoded_text_length);
+    if (error) goto exit;
+
+    error = channel_open_packet(p_ch, ockam_buffer_data(p_buffer), p_buffer->length, &p_encoded, &encoded_text_length);
+    if (error) goto exit;
+  } while (NULL == p_encoded);
+
+  message_type = *p_encoded++;
+  if (PAYLOAD != message_type) {
+    error = CHANNEL_ERROR_NOT_IMPLEMENTED;
+    goto exit;
   }
 
-  error = ockam_write(p_ch->transport_writer, g_cipher_text, cipher_text_length);
+  // Strip the header and the tag, leaving the payload
+  header_length = p_encoded - ockam_buffer_data(p_buffer);
+  ockam_buffer_trim(p_buffer, encoded_text_length);
+  ockam_buffer_pull(p_buffer, header_length);
+
+  *pp_buffer = p_buffer;
+  p_buffer   = NULL;
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  ockam_buffer_release(p_buffer);
+  return error;
+}
+
+/*
+ * Send the buffer as a single packet when it fits one and leaves room for the header and the tag: the header goes
+ * into the headroom, the payload is encrypted where it is and the transport adds its own framing the same way.
+ * Anything else takes the copying path of channel_write().
+ */
+ockam_error_t channel_write_buffer(void* ctx, ockam_buffer_t* p_buffer)
+{
+  ockam_error_t    error              = OCKAM_ERROR_NONE;
+  ockam_channel_t* p_ch               = (ockam_channel_t*) ctx;
+  uint8_t          header[CHANNEL_HEADER_MAX_SIZE];
+  uint8_t*         p_encoded          = NULL;
+  size_t           header_length      = 0;
+  size_t           cipher_text_length = 0;
+
+  error = channel_key_lock(p_ch);
   if (error) goto exit;
 
+  if (CHANNEL_STATE_SECURE == p_ch->state) {
+    p_encoded = channel_encode_header(p_ch, header);
+    if (!p_encoded) {
+      error = CHANNEL_ERROR_NOT_IMPLEMENTED;
+      goto unlock;
+    }
+    *p_encoded++  = PAYLOAD;
+    header_length = p_encoded - header;
+  }
+
+  if ((CHANNEL_STATE_SECURE != p_ch->state) || (1 != p_buffer->refcount) ||
+      (ockam_buffer_headroom(p_buffer) < header_length) ||
+      (ockam_buffer_tailroom(p_buffer) < OCKAM_VAULT_AEAD_AES_GCM_TAG_LENGTH) ||
+      (header_length + p_buffer->length + OCKAM_VAULT_AEAD_AES_GCM_TAG_LENGTH > p_ch->send_packet_size)) {
+    error = channel_write_packets(p_ch, ockam_buffer_data(p_buffer), p_buffer->length);
+    goto unlock;
+  }
+
+  ockam_buffer_push(p_buffer, header_length, &p_encoded);
+  ockam_memory_copy(p_ch->memory, p_encoded, header, header_length);
+
+  error = ockam_key_encrypt_in_place(&p_ch->key,
+                                     p_encoded,
+                                     p_buffer->length,
+                                     p_buffer->length + ockam_buffer_tailroom(p_buffer),
+                                     &cipher_text_length);
+  if (error) goto unlock;
+  ockam_buffer_put(p_buffer, cipher_text_length - p_buffer->length, NULL);
+
+  error    = ockam_write_buffer(p_ch->transport_writer, p_buffer);
+  p_buffer = NULL;
+
+unlock:
+  error = channel_key_unlock(p_ch, error);
+
 exit:
   if (error) ockam_log_error("%x", error);
+  ockam_buffer_release(p_buffer);
   return error;
 }
 
@@ -286,11 +1013,19 @@ ockam_error_t ockam_channel_deinit(ockam_channel_t* p_ch)
 {
   ockam_error_t error = OCKAM_ERROR_NONE;
 
-  error = ockam_memory_free(gp_ockam_channel_memory, p_ch->channel_reader, 0);
+  error = ockam_memory_free(p_ch->memory, p_ch->channel_reader, sizeof(ockam_reader_t));
+  if (error) goto exit;
+  error = ockam_memory_free(p_ch->memory, p_ch->channel_writer, sizeof(ockam_writer_t));
   if (error) goto exit;
-  error = ockam_memory_free(gp_ockam_channel_memory, p_ch->channel_writer, 0);
+  error = ockam_memory_free(p_ch->memory, p_ch->buffer, p_ch->buffer_size);
+  if (error) goto exit;
+  error = ockam_memory_free(p_ch->memory, p_ch->send_buffer, p_ch->buffer_size);
   if (error) goto exit;
   ockam_key_deinit(&p_ch->key);
+  if (p_ch->key_lock) {
+    error          = ockam_mutex_destroy(p_ch->mutex, p_ch->key_lock);
+    p_ch->key_lock = NULL;
+  }
 exit:
   if (error) ockam_log_error("%x", error);
   return error;
@@ -4,10 +4,18 @@
 #include "ockam/io.h"
 #include "ockam/vault.h"
 #include "ockam/memory.h"
+#include "ockam/mutex.h"
 #include "ockam/key_agreement/impl.h"
+#include "ockam/channel.h"
 
 #define MAX_CHANNEL_PACKET_SIZE 0x7fffu
 
+/* Wire version, onward and return routes and message type in front of every payload */
+#define CHANNEL_HEADER_MAX_SIZE 8u
+
+#define CHANNEL_OPTION_MAX_PACKET_SIZE 1u /* Value: 32-bit big-endian packet size the sender can receive */
+#define CHANNEL_OPTION_PING_ID         2u /* Value: 64-bit big-endian id a PING asks to be echoed in a PONG */
+
 typedef enum {
   CHANNEL_STATE_M1     = 1,
   CHANNEL_STATE_M2     = 2,
@@ -16,13 +24,35 @@ typedef enum {
 } channel_state_t;
 
 struct ockam_channel_t {
-  channel_state_t state;
-  ockam_reader_t* transport_reader;
-  ockam_writer_t* transport_writer;
-  ockam_reader_t* channel_reader;
-  ockam_writer_t* channel_writer;
-  ockam_vault_t*  vault;
-  ockam_key_t     key;
+  channel_state_t                state;
+  ockam_reader_t*                transport_reader;
+  ockam_writer_t*                transport_writer;
+  ockam_reader_t*                channel_reader;
+  ockam_writer_t*                channel_writer;
+  ockam_vault_t*                 vault;
+  ockam_memory_t*                memory;
+  uint8_t*                       buffer;           /* Received message, decrypted in place */
+  uint8_t*                       send_buffer;      /* Message being sent, encrypted in place */
+  size_t                         buffer_size;
+  size_t                         send_packet_size; /* Largest packet the peer has said it can receive */
+  size_t                         pending_offset;   /* Decrypted payload left in buffer by a short read */
+  size_t                         pending_length;
+  ockam_key_t                    key;
+  ockam_channel_session_t*       session;          /* Connect: session to resume and to replace */
+  ockam_channel_session_cache_t* session_cache;    /* Accept: where the channel's session goes */
+  uint32_t                       resumptions;      /* 0 after a full handshake, else the session's plus one */
+  uint64_t                       ping_id;          /* Id of the last PING sent by ockam_channel_ping() */
+  uint8_t                        pong_received;    /* The PONG for ping_id has arrived */
+  ockam_mutex_t*                 mutex;            /* Optional, see channel_key_lock() */
+  ockam_mutex_lock_t             key_lock;         /* Held while a packet is sealed and written, or opened */
 };
 
+ockam_error_t channel_send_ping(ockam_channel_t* p_ch);
+
+ockam_error_t channel_session_derive(ockam_channel_t* p_ch, ockam_channel_session_t* p_session);
+ockam_error_t channel_session_cache_take(ockam_channel_session_cache_t* p_cache,
+                                         const uint8_t*                 p_id,
+                                         ockam_channel_session_t*       p_session);
+ockam_error_t channel_session_cache_put(ockam_channel_session_cache_t* p_cache, ockam_channel_session_t* p_session);
+
 #endif
@@ -0,0 +1,315 @@
+#include <poll.h>
+#include <string.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include "ockam/error.h"
+#include "ockam/io.h"
+#include "ockam/log.h"
+#include "ockam/memory.h"
+#include "ockam/transport.h"
+#include "ockam/transport/socket_tcp.h"
+#include "ockam/channel.h"
+#include "ockam/channel/channel_impl.h"
+#include "ockam/channel/channel_pool.h"
+
+struct ockam_channel_pool_connection_t {
+  ockam_channel_pool_connection_t* next;
+  ockam_ip_address_t               address;
+  ockam_transport_t                transport;
+  ockam_channel_t                  channel;
+  ockam_reader_t*                  reader;
+  ockam_writer_t*                  writer;
+  uint64_t                         idle_since_ms; /* Given back at */
+  uint64_t                         checked_ms;    /* Last known alive: given back or answered a PING */
+};
+
+uint64_t channel_pool_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+int channel_pool_address_equal(ockam_ip_address_t* p_a, ockam_ip_address_t* p_b)
+{
+  return (p_a->port == p_b->port) &&
+         (0 == strncmp((char*) p_a->ip_address, (char*) p_b->ip_address, sizeof(p_a->ip_address))) &&
+         (0 == strncmp((char*) p_a->dns_name, (char*) p_b->dns_name, sizeof(p_a->dns_name)));
+}
+
+void channel_pool_close(ockam_channel_pool_t* p_pool, ockam_channel_pool_connection_t* p_connection)
+{
+  if (p_connection->channel.channel_writer) ockam_channel_deinit(&p_connection->channel);
+  if (p_connection->transport.ctx) ockam_transport_deinit(&p_connection->transport);
+  ockam_memory_free(p_pool->attributes.memory, p_connection, sizeof(*p_connection));
+}
+
+/*
+ * An idle connection is pinged when its socket has something to read, which is either a leftover packet, an end of
+ * stream or a reset, or when it has not shown signs of life for ping_interval_ms. The socket's receive timeout bounds
+ * the wait for the PONG.
+ */
+ockam_error_t
+channel_pool_check(ockam_channel_pool_t* p_pool, ockam_channel_pool_connection_t* p_connection, uint64_t now_ms)
+{
+  ockam_error_t  error     = OCKAM_ERROR_NONE;
+  tcp_socket_t*  p_socket  = ((socket_tcp_ctx_t*) p_connection->transport.ctx)->p_socket;
+  struct pollfd  poll_fd   = { p_socket->posix_socket.socket_fd, POLLIN, 0 };
+  struct timeval timeout   = { 0 };
+  int            ping      = 0;
+  uint32_t       ping_wait = p_pool->attributes.ping_timeout_ms;
+
+  ping = (p_socket->receive_start != p_socket->receive_length) || (0 != poll(&poll_fd, 1, 0));
+  if (p_pool->attributes.ping_interval_ms &&
+      (now_ms - p_connection->checked_ms >= p_pool->attributes.ping_interval_ms)) {
+    ping = 1;
+  }
+  if (!ping) goto exit;
+
+  p_pool->pings++;
+  timeout.tv_sec  = ping_wait / 1000u;
+  timeout.tv_usec = (ping_wait % 1000u) * 1000u;
+  if (0 != setsockopt(p_socket->posix_socket.socket_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout))) {
+    error = TRANSPORT_ERROR_SOCKET;
+    goto exit;
+  }
+
+  error = ockam_channel_ping(&p_connection->channel);
+  if (error) goto exit;
+  p_connection->checked_ms = now_ms;
+
+  timeout.tv_sec  = 0;
+  timeout.tv_usec = 0;
+  if (0 != setsockopt(p_socket->posix_socket.socket_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout))) {
+    error = TRANSPORT_ERROR_SOCKET;
+  }
+
+exit:
+  return error;
+}
+
+ockam_error_t channel_pool_open(ockam_channel_pool_t*             p_pool,
+                                ockam_ip_address_t*               p_address,
+                                ockam_channel_pool_connection_t** pp_connection)
+{
+  ockam_error_t                       error           = OCKAM_ERROR_NONE;
+  ockam_channel_pool_connection_t*    p_connection    = NULL;
+  ockam_transport_socket_attributes_t transport_attrs = p_pool->attributes.transport;
+  ockam_channel_attributes_t          channel_attrs   = p_pool->attributes.channel;
+  ockam_reader_t*                     p_transport_rd  = NULL;
+  ockam_writer_t*                     p_transport_wr  = NULL;
+
+  error = ockam_memory_alloc_zeroed(p_pool->attributes.memory, (void**) &p_connection, sizeof(*p_connection));
+  if (error) goto exit;
+  p_connection->address = *p_address;
+
+  memset(&transport_attrs.listen_address, 0, sizeof(transport_attrs.listen_address));
+  if (NULL == transport_attrs.p_memory) transport_attrs.p_memory = p_pool->attributes.memory;
+  error = ockam_transport_socket_tcp_init(&p_connection->transport, &transport_attrs);
+  if (error) goto exit;
+
+  error = ockam_transport_connect(&p_connection->transport,
+                                  &p_transport_rd,
+                                  &p_transport_wr,
+                                  p_address,
+                                  p_pool->attributes.retry_count,
+                                  p_pool->attributes.retry_interval);
+  if (error) goto exit;
+
+  channel_attrs.reader        = p_transport_rd;
+  channel_attrs.writer        = p_transport_wr;
+  channel_attrs.session       = NULL;
+  channel_attrs.session_cache = NULL;
+  if (NULL == channel_attrs.memory) channel_attrs.memory = p_pool->attributes.memory;
+  if (NULL == channel_attrs.vault) channel_attrs.vault = p_pool->attributes.vault;
+
+  error = ockam_channel_init(&p_connection->channel, &channel_attrs);
+  if (error) goto exit;
+
+  error = ockam_channel_connect(&p_connection->channel, &p_connection->reader, &p_connection->writer);
+  if (error) goto exit;
+
+  *pp_connection = p_connection;
+  p_connection   = NULL;
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  if (p_connection) channel_pool_close(p_pool, p_connection);
+  return error;
+}
+
+ockam_error_t ockam_channel_pool_init(ockam_channel_pool_t* p_pool, ockam_channel_pool_attributes_t* p_attributes)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if (!p_pool || !p_attributes || !p_attributes->memory || !p_attributes->vault) {
+    error = CHANNEL_ERROR_PARAMS;
+    goto exit;
+  }
+
+  memset(p_pool, 0, sizeof(*p_pool));
+  p_pool->attributes = *p_attributes;
+  if (!p_pool->attributes.max_idle) p_pool->attributes.max_idle = CHANNEL_POOL_MAX_IDLE_DEFAULT;
+  if (!p_pool->attributes.ping_timeout_ms) p_pool->attributes.ping_timeout_ms = CHANNEL_POOL_PING_TIMEOUT_DEFAULT;
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t ockam_channel_pool_get(ockam_channel_pool_t*             p_pool,
+                                     ockam_ip_address_t*               p_address,
+                                     ockam_channel_pool_connection_t** pp_connection,
+                                     ockam_reader_t**                  pp_reader,
+                                     ockam_writer_t**                  pp_writer)
+{
+  ockam_error_t                     error        = OCKAM_ERROR_NONE;
+  ockam_channel_pool_connection_t** pp_next      = NULL;
+  ockam_channel_pool_connection_t*  p_connection = NULL;
+  uint64_t                          start        = channel_pool_now_ns();
+  uint64_t                          now_ms       = start / 1000000u;
+
+  if (!p_pool || !p_address || !pp_connection) {
+    error = CHANNEL_ERROR_PARAMS;
+    goto exit;
+  }
+
+  // The most recently given back connection to the address that is still healthy
+  pp_next = &p_pool->idle;
+  while (*pp_next && !p_connection) {
+    if (!channel_pool_address_equal(&(*pp_next)->address, p_address)) {
+      pp_next = &(*pp_next)->next;
+      continue;
+    }
+
+    p_connection = *pp_next;
+    *pp_next     = p_connection->next;
+
+    if (p_pool->attributes.idle_timeout_ms &&
+        (now_ms - p_connection->idle_since_ms >= p_pool->attributes.idle_timeout_ms)) {
+      p_pool->evicted_idle++;
+      channel_pool_close(p_pool, p_connection);
+      p_connection = NULL;
+    } else if (channel_pool_check(p_pool, p_connection, now_ms)) {
+      p_pool->evicted_unhealthy++;
+      channel_pool_close(p_pool, p_connection);
+      p_connection = NULL;
+    }
+  }
+
+  if (p_connection) {
+    p_pool->hits++;
+  } else {
+    error = channel_pool_open(p_pool, p_address, &p_connection);
+    if (error) goto exit;
+    p_pool->misses++;
+    p_pool->connect_ns += channel_pool_now_ns() - start;
+  }
+
+  p_connection->next = NULL;
+  *pp_connection     = p_connection;
+  if (pp_reader) *pp_reader = p_connection->reader;
+  if (pp_writer) *pp_writer = p_connection->writer;
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t
+ockam_channel_pool_put(ockam_channel_pool_t* p_pool, ockam_channel_pool_connection_t* p_connection, uint8_t keep)
+{
+  ockam_error_t                     error    = OCKAM_ERROR_NONE;
+  ockam_channel_pool_connection_t** pp_next  = NULL;
+  ockam_channel_pool_connection_t*  p_oldest = NULL;
+  size_t                            count    = 0;
+  uint64_t                          now_ms   = channel_pool_now_ns() / 1000000u;
+
+  if (!p_pool || !p_connection) {
+    error = CHANNEL_ERROR_PARAMS;
+    goto exit;
+  }
+
+  if (!keep) {
+    channel_pool_close(p_pool, p_connection);
+    goto exit;
+  }
+
+  p_connection->idle_since_ms = now_ms;
+  p_connection->checked_ms    = now_ms;
+  p_connection->next          = p_pool->idle;
+  p_pool->idle                = p_connection;
+
+  // Past max_idle for the address, the connection given back longest ago goes
+  for (pp_next = &p_pool->idle; *pp_next; pp_next = &(*pp_next)->next) {
+    if (channel_pool_address_equal(&(*pp_next)->address, &p_connection->address) &&
+        (++count > p_pool->attributes.max_idle)) {
+      p_oldest = *pp_next;
+      *pp_next = p_oldest->next;
+      channel_pool_close(p_pool, p_oldest);
+      break;
+    }
+  }
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t ockam_channel_pool_evict(ockam_channel_pool_t* p_pool)
+{
+  ockam_error_t                     error        = OCKAM_ERROR_NONE;
+  ockam_channel_pool_connection_t** pp_next      = NULL;
+  ockam_channel_pool_connection_t*  p_connection = NULL;
+  uint64_t                          now_ms       = channel_pool_now_ns() / 1000000u;
+
+  if (!p_pool) {
+    error = CHANNEL_ERROR_PARAMS;
+    goto exit;
+  }
+
+  pp_next = &p_pool->idle;
+  while (*pp_next) {
+    p_connection = *pp_next;
+
+    if (p_pool->attributes.idle_timeout_ms &&
+        (now_ms - p_connection->idle_since_ms >= p_pool->attributes.idle_timeout_ms)) {
+      p_pool->evicted_idle++;
+    } else if (channel_pool_check(p_pool, p_connection, now_ms)) {
+      p_pool->evicted_unhealthy++;
+    } else {
+      pp_next = &p_connection->next;
+      continue;
+    }
+
+    *pp_next = p_connection->next;
+    channel_pool_close(p_pool, p_connection);
+  }
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t ockam_channel_pool_deinit(ockam_channel_pool_t* p_pool)
+{
+  ockam_error_t                    error        = OCKAM_ERROR_NONE;
+  ockam_channel_pool_connection_t* p_connection = NULL;
+
+  if (!p_pool) {
+    error = CHANNEL_ERROR_PARAMS;
+    goto exit;
+  }
+
+  while (p_pool->idle) {
+    p_connection = p_pool->idle;
+    p_pool->idle = p_connection->next;
+    channel_pool_close(p_pool, p_connection);
+  }
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
@@ -0,0 +1,90 @@
+#ifndef OCKAM_CHANNEL_POOL_H
+#define OCKAM_CHANNEL_POOL_H
+
+#include <stdint.h>
+#include "ockam/error.h"
+#include "ockam/io.h"
+#include "ockam/memory.h"
+#include "ockam/transport.h"
+#include "ockam/vault.h"
+#include "ockam/channel.h"
+
+/**
+ * Pool of secure channels over TCP, keyed by the address they connect to.
+ *
+ * A connection taken from the pool is either an idle one it kept for that address, a hit, or a new TCP transport
+ * connected with a channel on top, a miss that pays for the TCP handshake and the channel's key agreement. Connections
+ * given back are kept idle, most recently used first, up to max_idle per address.
+ *
+ * Idle connections are health checked before they are handed out. One whose socket has data or an end of stream
+ * waiting, or that has been idle for ping_interval_ms, must answer a channel PING within ping_timeout_ms (see
+ * ockam_channel_ping), so the server must be reading its channels. Connections idle for idle_timeout_ms are closed,
+ * on checkout or by ockam_channel_pool_evict(), which also pings the connections due for it.
+ *
+ * The pool counts its hits and misses and the time the misses spent connecting, so hits saved about
+ * hits * connect_ns / misses of connect latency. A pool is not thread safe, like the vault its channels use.
+ */
+
+#define CHANNEL_POOL_MAX_IDLE_DEFAULT     4u
+#define CHANNEL_POOL_PING_TIMEOUT_DEFAULT 1000u
+
+typedef struct ockam_channel_pool_connection_t ockam_channel_pool_connection_t;
+
+typedef struct ockam_channel_pool_attributes_t {
+  ockam_memory_t*                     memory;
+  ockam_vault_t*                      vault;
+  ockam_transport_socket_attributes_t transport;        /*!< For new TCP transports, p_memory defaults to memory */
+  ockam_channel_attributes_t          channel;          /*!< For new channels, without reader, writer or sessions */
+  int16_t                             retry_count;      /*!< Passed to ockam_transport_connect() */
+  uint16_t                            retry_interval;   /*!< Passed to ockam_transport_connect() */
+  size_t                              max_idle;         /*!< Idle connections kept per address, 0 means 4 */
+  uint32_t                            idle_timeout_ms;  /*!< Close connections idle for this long, 0 means never */
+  uint32_t                            ping_interval_ms; /*!< Ping connections idle for this long, 0 means never */
+  uint32_t                            ping_timeout_ms;  /*!< Longest wait for a PONG, 0 means 1000 */
+} ockam_channel_pool_attributes_t;
+
+typedef struct ockam_channel_pool_t {
+  ockam_channel_pool_attributes_t  attributes;
+  ockam_channel_pool_connection_t* idle;              /*!< Most recently given back first */
+  uint64_t                         hits;
+  uint64_t                         misses;
+  uint64_t                         pings;             /*!< Health checks that sent a PING */
+  uint64_t                         evicted_idle;      /*!< Closed after idle_timeout_ms */
+  uint64_t                         evicted_unhealthy; /*!< Closed after failing a health check */
+  uint64_t                         connect_ns;        /*!< Time spent connecting on misses */
+} ockam_channel_pool_t;
+
+ockam_error_t ockam_channel_pool_init(ockam_channel_pool_t* pool, ockam_channel_pool_attributes_t* attributes);
+
+/**
+ * @brief   Take a healthy idle connection to the address, or connect a new one.
+ * @param   pool        [in]  - Pool.
+ * @param   address     [in]  - Address to connect to.
+ * @param   connection  [out] - The connection, to be given back with ockam_channel_pool_put().
+ * @param   reader      [out] - Optional, the channel's reader.
+ * @param   writer      [out] - Optional, the channel's writer.
+ */
+ockam_error_t ockam_channel_pool_get(ockam_channel_pool_t*             pool,
+                                     ockam_ip_address_t*               address,
+                                     ockam_channel_pool_connection_t** connection,
+                                     ockam_reader_t**                  reader,
+                                     ockam_writer_t**                  writer);
+
+/**
+ * @brief   Give a connection back.
+ * @param   keep    [in] - 0 closes the connection, for one whose last exchange failed or left data unread.
+ */
+ockam_error_t
+ockam_channel_pool_put(ockam_channel_pool_t* pool, ockam_channel_pool_connection_t* connection, uint8_t keep);
+
+/**
+ * @brief   Close the idle connections past idle_timeout_ms and ping those idle for ping_interval_ms.
+ */
+ockam_error_t ockam_channel_pool_evict(ockam_channel_pool_t* pool);
+
+/**
+ * @brief   Close every idle connection. Connections not given back must be given back first.
+ */
+ockam_error_t ockam_channel_pool_deinit(ockam_channel_pool_t* pool);
+
+#endif
@@ -0,0 +1,163 @@
+#include "ockam/error.h"
+#include "ockam/key_agreement.h"
+#include "ockam/key_agreement/xx.h"
+#include "ockam/log.h"
+#include "ockam/memory.h"
+#include "ockam/vault.h"
+#include "ockam/channel.h"
+#include "ockam/channel/channel_impl.h"
+
+ockam_error_t ockam_channel_session_cache_init(ockam_channel_session_cache_t* p_cache,
+                                               ockam_memory_t*                p_memory,
+                                               ockam_vault_t*                 p_vault,
+                                               size_t                         capacity,
+                                               uint32_t                       max_resumptions)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if (!p_cache || !p_memory || !p_vault || !capacity) {
+    error = CHANNEL_ERROR_PARAMS;
+    goto exit;
+  }
+
+  ockam_memory_set(p_memory, p_cache, 0, sizeof(ockam_channel_session_cache_t));
+
+  error = ockam_memory_alloc_zeroed(p_memory, (void**) &p_cache->sessions, capacity * sizeof(ockam_channel_session_t));
+  if (error) goto exit;
+
+  p_cache->memory          = p_memory;
+  p_cache->vault           = p_vault;
+  p_cache->capacity        = capacity;
+  p_cache->max_resumptions = max_resumptions ? max_resumptions : CHANNEL_SESSION_MAX_RESUMPTIONS_DEFAULT;
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t ockam_channel_session_cache_deinit(ockam_channel_session_cache_t* p_cache)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+  size_t        i     = 0;
+
+  if (!p_cache || !p_cache->sessions) {
+    error = CHANNEL_ERROR_PARAMS;
+    goto exit;
+  }
+
+  for (i = 0; i < p_cache->capacity; i++) { ockam_channel_session_deinit(p_cache->vault, &p_cache->sessions[i]); }
+
+  ockam_memory_free(p_cache->memory, p_cache->sessions, p_cache->capacity * sizeof(ockam_channel_session_t));
+  p_cache->sessions = NULL;
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t ockam_channel_session_deinit(ockam_vault_t* p_vault, ockam_channel_session_t* p_session)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if (!p_vault || !p_session) {
+    error = CHANNEL_ERROR_PARAMS;
+    goto exit;
+  }
+
+  if (p_session->secret.context) error = ockam_vault_secret_destroy(p_vault, &p_session->secret);
+  p_session->secret.context = NULL;
+  p_session->resumptions    = 0;
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+/*
+ * Derive an established channel's session from its key's resumption secret: the first HKDF output names the session,
+ * the second is the secret a resumption starts from. Both ends of the channel derive the same session.
+ */
+ockam_error_t channel_session_derive(ockam_channel_t* p_ch, ockam_channel_session_t* p_session)
+{
+  ockam_error_t        error = OCKAM_ERROR_NONE;
+  ockam_vault_secret_t resumption_secret;
+  ockam_vault_secret_t secrets[2];
+  uint8_t              id[OCKAM_VAULT_HKDF_SHA256_OUTPUT_LENGTH];
+  size_t               id_length = 0;
+
+  ockam_memory_set(p_ch->memory, &resumption_secret, 0, sizeof(resumption_secret));
+  ockam_memory_set(p_ch->memory, secrets, 0, sizeof(secrets));
+
+  error = ockam_xx_key_resumption_secret_take(&p_ch->key, &resumption_secret);
+  if (error) goto exit;
+
+  error = ockam_vault_hkdf_sha256(p_ch->vault, &resumption_secret, NULL, 2, secrets);
+  if (error) goto exit;
+
+  error = ockam_vault_secret_export(p_ch->vault, &secrets[0], id, sizeof(id), &id_length);
+  if (error) goto exit;
+
+  ockam_memory_copy(p_ch->memory, p_session->id, id, CHANNEL_SESSION_ID_SIZE);
+  ockam_memory_copy(p_ch->memory, &p_session->secret, &secrets[1], sizeof(ockam_vault_secret_t));
+  secrets[1].context = NULL;
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  if (secrets[0].context) ockam_vault_secret_destroy(p_ch->vault, &secrets[0]);
+  if (secrets[1].context) ockam_vault_secret_destroy(p_ch->vault, &secrets[1]);
+  if (resumption_secret.context) ockam_vault_secret_destroy(p_ch->vault, &resumption_secret);
+  return error;
+}
+
+/*
+ * Remove the session with the given id from the cache and return it; a session resumes one channel only. Returns
+ * OCKAM_ERROR_NONE with no secret in *p_session when the cache does not have it.
+ */
+ockam_error_t channel_session_cache_take(ockam_channel_session_cache_t* p_cache,
+                                         const uint8_t*                 p_id,
+                                         ockam_channel_session_t*       p_session)
+{
+  size_t i      = 0;
+  int    result = 0;
+
+  ockam_memory_set(p_cache->memory, p_session, 0, sizeof(ockam_channel_session_t));
+
+  for (i = 0; i < p_cache->capacity; i++) {
+    if (!p_cache->sessions[i].secret.context) continue;
+    ockam_memory_compare(p_cache->memory, &result, p_cache->sessions[i].id, p_id, CHANNEL_SESSION_ID_SIZE);
+    if (result) continue;
+
+    ockam_memory_copy(p_cache->memory, p_session, &p_cache->sessions[i], sizeof(ockam_channel_session_t));
+    ockam_memory_set(p_cache->memory, &p_cache->sessions[i], 0, sizeof(ockam_channel_session_t));
+    break;
+  }
+
+  return OCKAM_ERROR_NONE;
+}
+
+/*
+ * Keep the session for a later resumption, unless it has been resumed as often as the cache allows. The cache owns
+ * the session's secret from then on.
+ */
+ockam_error_t channel_session_cache_put(ockam_channel_session_cache_t* p_cache, ockam_channel_session_t* p_session)
+{
+  ockam_error_t            error  = OCKAM_ERROR_NONE;
+  ockam_channel_session_t* p_slot = NULL;
+
+  if (p_session->resumptions >= p_cache->max_resumptions) {
+    error = ockam_channel_session_deinit(p_cache->vault, p_session);
+    goto exit;
+  }
+
+  p_slot = &p_cache->sessions[p_cache->next];
+  error  = ockam_channel_session_deinit(p_cache->vault, p_slot);
+  if (error) goto exit;
+
+  ockam_memory_copy(p_cache->memory, p_slot, p_session, sizeof(ockam_channel_session_t));
+  ockam_memory_set(p_cache->memory, p_session, 0, sizeof(ockam_channel_session_t));
+  p_cache->next = (p_cache->next + 1) % p_cache->capacity;
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
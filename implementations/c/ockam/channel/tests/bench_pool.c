@@ -0,0 +1,374 @@
+/**
+ * @file    bench_pool.c
+ * @brief   Request latency over a fresh secure channel per request and over channels taken from a pool
+ *
+ * Server threads each accept one TCP connection at a time on 127.0.0.1, accept a channel on it and echo every message
+ * until the client goes away. A message BENCH_QUIT is echoed too, then the server closes the connection. The client
+ * sends one short request after the other and waits for each reply:
+ *  - connect: every request connects a new TCP transport and channel, and closes them after the reply
+ *  - pool:    every request takes a channel from an ockam_channel_pool_t and gives it back after the reply
+ * Three more steps check the pool's health checks on the channel it kept:
+ *  - keep-alive: once idle for ping_interval_ms it answers a PING and stays
+ *  - dead peer:  after the server closed it, the next request gets a new channel instead
+ *  - idle:       once idle for idle_timeout_ms it is closed
+ *
+ * Usage: ockam_channel_pool_bench [requests]
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "ockam/error.h"
+#include "ockam/io.h"
+#include "ockam/log.h"
+#include "ockam/memory.h"
+#include "ockam/memory/stdlib.h"
+#include "ockam/random/urandom.h"
+#include "ockam/transport.h"
+#include "ockam/transport/socket_tcp.h"
+#include "ockam/vault.h"
+#include "ockam/vault/default.h"
+#include "ockam/channel.h"
+#include "ockam/channel/channel_impl.h"
+#include "ockam/channel/channel_pool.h"
+
+#define BENCH_PORT             8090
+#define BENCH_DEFAULT_REQUESTS 1000
+#define BENCH_SERVERS          3
+#define BENCH_MESSAGE          "ping"
+#define BENCH_QUIT             "quit"
+#define BENCH_MESSAGE_SIZE     4
+#define BENCH_PING_INTERVAL_MS 50
+#define BENCH_IDLE_TIMEOUT_MS  200
+
+#define BENCH_ERROR_MISMATCH (OCKAM_ERROR_INTERFACE_CHANNEL | 0x00F2u)
+#define BENCH_ERROR_POOL     (OCKAM_ERROR_INTERFACE_CHANNEL | 0x00F3u)
+
+typedef struct {
+  ockam_memory_t* p_memory;
+  volatile int    stop;
+  size_t          stopped;
+  pthread_mutex_t lock;
+} bench_server_t;
+
+uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+/*
+ * Serve one connection: accept a channel and echo until the client closes it or asks to quit
+ */
+void bench_serve(bench_server_t* p_server, ockam_vault_t* p_vault)
+{
+  ockam_error_t                       error           = OCKAM_ERROR_NONE;
+  ockam_transport_t                   transport       = { 0 };
+  ockam_transport_socket_attributes_t transport_attrs = { .listen_address = { "", "127.0.0.1", BENCH_PORT } };
+  ockam_reader_t*                     p_transport_rd  = NULL;
+  ockam_writer_t*                     p_transport_wr  = NULL;
+  ockam_channel_t                     channel         = { 0 };
+  ockam_channel_attributes_t          channel_attrs   = { 0 };
+  ockam_reader_t*                     p_reader        = NULL;
+  ockam_writer_t*                     p_writer        = NULL;
+  uint8_t                             message[BENCH_MESSAGE_SIZE];
+  size_t                              length = 0;
+
+  transport_attrs.p_memory    = p_server->p_memory;
+  transport_attrs.tcp_nodelay = 1;
+  error                       = ockam_transport_socket_tcp_init(&transport, &transport_attrs);
+  if (error) goto exit;
+  error = ockam_transport_accept(&transport, &p_transport_rd, &p_transport_wr, NULL);
+  if (error) goto exit;
+
+  channel_attrs.reader = p_transport_rd;
+  channel_attrs.writer = p_transport_wr;
+  channel_attrs.memory = p_server->p_memory;
+  channel_attrs.vault  = p_vault;
+  error                = ockam_channel_init(&channel, &channel_attrs);
+  if (error) goto exit;
+  error = ockam_channel_accept(&channel, &p_reader, &p_writer);
+  if (error) goto exit;
+
+  for (;;) {
+    error = ockam_read(p_reader, message, sizeof(message), &length);
+    if (error) goto exit;
+    error = ockam_write(p_writer, message, length);
+    if (error) goto exit;
+    if ((BENCH_MESSAGE_SIZE == length) && !memcmp(message, BENCH_QUIT, BENCH_MESSAGE_SIZE)) break;
+  }
+
+exit:
+  if (channel.channel_writer) ockam_channel_deinit(&channel);
+  if (transport.ctx) ockam_transport_deinit(&transport);
+}
+
+void* bench_server(void* arg)
+{
+  bench_server_t*                  p_server         = (bench_server_t*) arg;
+  ockam_random_t                   random           = { 0 };
+  ockam_vault_t                    vault            = { 0 };
+  ockam_vault_default_attributes_t vault_attributes = { .memory = p_server->p_memory, .random = &random };
+
+  if (ockam_random_urandom_init(&random)) goto exit;
+  if (ockam_vault_default_init(&vault, &vault_attributes)) goto exit;
+
+  while (!p_server->stop) bench_serve(p_server, &vault);
+
+exit:
+  if (vault.dispatch) ockam_vault_deinit(&vault);
+  ockam_random_deinit(&random);
+  pthread_mutex_lock(&p_server->lock);
+  p_server->stopped++;
+  pthread_mutex_unlock(&p_server->lock);
+  return NULL;
+}
+
+/*
+ * Wake the server threads waiting in accept with connections that close right away
+ */
+void bench_stop(bench_server_t* p_server, size_t threads)
+{
+  struct sockaddr_in address = { 0 };
+  int                socket_fd;
+  size_t             stopped = 0;
+
+  address.sin_family      = AF_INET;
+  address.sin_port        = htons(BENCH_PORT);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  p_server->stop = 1;
+  while (stopped < threads) {
+    socket_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (socket_fd >= 0) {
+      connect(socket_fd, (struct sockaddr*) &address, sizeof(address));
+      close(socket_fd);
+    }
+    usleep(10000);
+    pthread_mutex_lock(&p_server->lock);
+    stopped = p_server->stopped;
+    pthread_mutex_unlock(&p_server->lock);
+  }
+}
+
+ockam_error_t bench_request(ockam_reader_t* p_reader, ockam_writer_t* p_writer, const char* request)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+  uint8_t       reply[BENCH_MESSAGE_SIZE];
+  size_t        length = 0;
+
+  error = ockam_write(p_writer, (uint8_t*) request, BENCH_MESSAGE_SIZE);
+  if (error) goto exit;
+  error = ockam_read(p_reader, reply, sizeof(reply), &length);
+  if (error) goto exit;
+  if ((BENCH_MESSAGE_SIZE != length) || memcmp(reply, request, BENCH_MESSAGE_SIZE)) error = BENCH_ERROR_MISMATCH;
+
+exit:
+  return error;
+}
+
+/*
+ * One request over a channel and TCP connection of its own
+ */
+ockam_error_t bench_connect_request(ockam_memory_t* p_memory, ockam_vault_t* p_vault, ockam_ip_address_t* p_address)
+{
+  ockam_error_t                       error           = OCKAM_ERROR_NONE;
+  ockam_transport_t                   transport       = { 0 };
+  ockam_transport_socket_attributes_t transport_attrs = { 0 };
+  ockam_reader_t*                     p_transport_rd  = NULL;
+  ockam_writer_t*                     p_transport_wr  = NULL;
+  ockam_channel_t                     channel         = { 0 };
+  ockam_channel_attributes_t          channel_attrs   = { 0 };
+  ockam_reader_t*                     p_reader        = NULL;
+  ockam_writer_t*                     p_writer        = NULL;
+
+  transport_attrs.p_memory    = p_memory;
+  transport_attrs.tcp_nodelay = 1;
+  error                       = ockam_transport_socket_tcp_init(&transport, &transport_attrs);
+  if (error) goto exit;
+  error = ockam_transport_connect(&transport, &p_transport_rd, &p_transport_wr, p_address, 10, 1);
+  if (error) goto exit;
+
+  channel_attrs.reader = p_transport_rd;
+  channel_attrs.writer = p_transport_wr;
+  channel_attrs.memory = p_memory;
+  channel_attrs.vault  = p_vault;
+  error                = ockam_channel_init(&channel, &channel_attrs);
+  if (error) goto exit;
+  error = ockam_channel_connect(&channel, &p_reader, &p_writer);
+  if (error) goto exit;
+
+  error = bench_request(p_reader, p_writer, BENCH_MESSAGE);
+
+exit:
+  if (channel.channel_writer) ockam_channel_deinit(&channel);
+  if (transport.ctx) ockam_transport_deinit(&transport);
+  return error;
+}
+
+ockam_error_t bench_pool_request(ockam_channel_pool_t* p_pool, ockam_ip_address_t* p_address, const char* request)
+{
+  ockam_error_t                    error        = OCKAM_ERROR_NONE;
+  ockam_channel_pool_connection_t* p_connection = NULL;
+  ockam_reader_t*                  p_reader     = NULL;
+  ockam_writer_t*                  p_writer     = NULL;
+
+  error = ockam_channel_pool_get(p_pool, p_address, &p_connection, &p_reader, &p_writer);
+  if (error) goto exit;
+  error = bench_request(p_reader, p_writer, request);
+  ockam_channel_pool_put(p_pool, p_connection, !error);
+
+exit:
+  return error;
+}
+
+/*
+ * The channel kept by the pool is pinged once idle for long enough, replaced once the server closed it and closed
+ * once idle for too long
+ */
+ockam_error_t bench_health(ockam_channel_pool_t* p_pool, ockam_ip_address_t* p_address)
+{
+  ockam_error_t error  = OCKAM_ERROR_NONE;
+  uint64_t      pings  = p_pool->pings;
+  uint64_t      misses = p_pool->misses;
+
+  usleep((BENCH_PING_INTERVAL_MS + 10) * 1000);
+  error = ockam_channel_pool_evict(p_pool);
+  if (error) goto exit;
+  if ((p_pool->pings != pings + 1) || p_pool->evicted_unhealthy || !p_pool->idle) {
+    printf("keep-alive failed: %lu pings, %lu evicted\n",
+           (unsigned long) (p_pool->pings - pings),
+           (unsigned long) p_pool->evicted_unhealthy);
+    error = BENCH_ERROR_POOL;
+    goto exit;
+  }
+  printf("keep-alive: the idle channel answered its PING\n");
+
+  error = bench_pool_request(p_pool, p_address, BENCH_QUIT);
+  if (error) goto exit;
+  usleep(20000);
+  error = bench_pool_request(p_pool, p_address, BENCH_MESSAGE);
+  if (error) goto exit;
+  if ((1 != p_pool->evicted_unhealthy) || (p_pool->misses != misses + 1)) {
+    printf("dead peer failed: %lu evicted, %lu misses\n",
+           (unsigned long) p_pool->evicted_unhealthy,
+           (unsigned long) (p_pool->misses - misses));
+    error = BENCH_ERROR_POOL;
+    goto exit;
+  }
+  printf("dead peer:  the closed channel was replaced\n");
+
+  usleep((BENCH_IDLE_TIMEOUT_MS + 10) * 1000);
+  error = ockam_channel_pool_evict(p_pool);
+  if (error) goto exit;
+  if ((1 != p_pool->evicted_idle) || p_pool->idle) {
+    printf("idle failed: %lu evicted\n", (unsigned long) p_pool->evicted_idle);
+    error = BENCH_ERROR_POOL;
+    goto exit;
+  }
+  printf("idle:       the idle channel was closed\n");
+
+exit:
+  return error;
+}
+
+int main(int argc, char* argv[])
+{
+  ockam_error_t                    error            = OCKAM_ERROR_NONE;
+  ockam_memory_t                   memory           = { 0 };
+  ockam_random_t                   random           = { 0 };
+  ockam_vault_t                    vault            = { 0 };
+  ockam_vault_default_attributes_t vault_attributes = { .memory = &memory, .random = &random };
+  ockam_ip_address_t               address          = { "", "127.0.0.1", BENCH_PORT };
+  ockam_channel_pool_attributes_t  pool_attributes  = { 0 };
+  ockam_channel_pool_t             pool             = { 0 };
+  bench_server_t                   server           = { 0 };
+  pthread_t                        threads[BENCH_SERVERS];
+  size_t                           started  = 0;
+  size_t                           requests = BENCH_DEFAULT_REQUESTS;
+  size_t                           i        = 0;
+  uint64_t                         start    = 0;
+  uint64_t                         connect  = 0;
+  uint64_t                         pooled   = 0;
+  int                              rc       = 0;
+
+  if (argc > 1) requests = strtoul(argv[1], NULL, 10);
+  if (!requests) requests = BENCH_DEFAULT_REQUESTS;
+
+  ockam_memory_stdlib_init(&memory);
+  ockam_log_set_level(OCKAM_LOG_LEVEL_FATAL); /* Closed channels end the server's reads with an error */
+  server.p_memory = &memory;
+  pthread_mutex_init(&server.lock, NULL);
+
+  error = ockam_random_urandom_init(&random);
+  if (error) goto exit;
+  error = ockam_vault_default_init(&vault, &vault_attributes);
+  if (error) goto exit;
+
+  for (started = 0; started < BENCH_SERVERS; started++) {
+    if (pthread_create(&threads[started], NULL, bench_server, &server)) break;
+  }
+  usleep(100000);
+
+  start = bench_now_ns();
+  for (i = 0; i < requests; i++) {
+    error = bench_connect_request(&memory, &vault, &address);
+    if (error) goto exit;
+  }
+  connect = bench_now_ns() - start;
+
+  pool_attributes.memory                = &memory;
+  pool_attributes.vault                 = &vault;
+  pool_attributes.transport.tcp_nodelay = 1;
+  pool_attributes.retry_count           = 10;
+  pool_attributes.retry_interval        = 1;
+  pool_attributes.ping_interval_ms      = BENCH_PING_INTERVAL_MS;
+  pool_attributes.idle_timeout_ms       = BENCH_IDLE_TIMEOUT_MS;
+  error                                 = ockam_channel_pool_init(&pool, &pool_attributes);
+  if (error) goto exit;
+
+  start = bench_now_ns();
+  for (i = 0; i < requests; i++) {
+    error = bench_pool_request(&pool, &address, BENCH_MESSAGE);
+    if (error) goto exit;
+  }
+  pooled = bench_now_ns() - start;
+
+  printf("%zu requests over loopback\n", requests);
+  printf("%-8s %10s %8s\n", "mode", "us/request", "hit rate");
+  printf("%-8s %10.1f %8s\n", "connect", (double) connect / (double) requests / 1e3, "-");
+  printf("%-8s %10.1f %7.1f%%\n",
+         "pool",
+         (double) pooled / (double) requests / 1e3,
+         100.0 * (double) pool.hits / (double) (pool.hits + pool.misses));
+  printf("%lu hits saved about %.1f ms of connecting, %.1f us per miss\n",
+         (unsigned long) pool.hits,
+         (double) pool.hits * (double) pool.connect_ns / (double) pool.misses / 1e6,
+         (double) pool.connect_ns / (double) pool.misses / 1e3);
+
+  error = bench_health(&pool, &address);
+
+exit:
+  if (pool.attributes.memory) ockam_channel_pool_deinit(&pool);
+  if (started) {
+    bench_stop(&server, started);
+    for (i = 0; i < started; i++) pthread_join(threads[i], NULL);
+  }
+  if (vault.dispatch) ockam_vault_deinit(&vault);
+  ockam_random_deinit(&random);
+  pthread_mutex_destroy(&server.lock);
+
+  if (error) {
+    printf("FAIL: %x\n", error);
+    rc = -1;
+  }
+  return rc;
+}
@@ -0,0 +1,212 @@
+/**
+ * @file    bench_reconnect.c
+ * @brief   Measure secure channel reconnect latency with a full handshake and with session resumption
+ *
+ * A client and a server thread set up one channel after another over one loopback TCP connection, each on its own
+ * vault. Each reconnect initializes a channel, connects it and exchanges one short message each way, then tears the
+ * channel down again; the latency is the client's time from ockam_channel_init to receiving the server's reply. The
+ * TCP connection is kept so only the channel's cost is measured, a real reconnect adds the TCP handshake to both.
+ *
+ * Without sessions every reconnect runs the XX handshake. With a session on the client and a session cache on the
+ * server every reconnect after the first resumes the previous channel's session, up to the cache's limit of
+ * resumptions in a row, after which one full handshake starts a new session.
+ *
+ * Usage: ockam_channel_reconnect_bench [reconnects]
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ockam/error.h"
+#include "ockam/io.h"
+#include "ockam/log.h"
+#include "ockam/memory.h"
+#include "ockam/memory/stdlib.h"
+#include "ockam/random/urandom.h"
+#include "ockam/transport.h"
+#include "ockam/transport/socket_tcp.h"
+#include "ockam/vault.h"
+#include "ockam/vault/default.h"
+#include "ockam/channel.h"
+#include "ockam/channel/channel_impl.h"
+
+#define BENCH_PORT               8070
+#define BENCH_DEFAULT_RECONNECTS 1000
+#define BENCH_CACHE_CAPACITY     16
+#define BENCH_MESSAGE            "ping"
+#define BENCH_MESSAGE_SIZE       4
+
+#define BENCH_ERROR_MISMATCH (OCKAM_ERROR_INTERFACE_CHANNEL | 0x00F2u)
+
+typedef struct {
+  ockam_memory_t memory;
+  uint16_t       port;
+  size_t         reconnects;
+  int            use_sessions;
+  uint64_t       total_ns;
+  size_t         resumed;
+  ockam_error_t  error[2];
+} bench_run_t;
+
+uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+ockam_error_t bench_reconnect_run(bench_run_t* p_run, int client)
+{
+  ockam_error_t                       error            = OCKAM_ERROR_NONE;
+  ockam_random_t                      random           = { 0 };
+  ockam_vault_t                       vault            = { 0 };
+  ockam_vault_default_attributes_t    vault_attributes = { .memory = &p_run->memory, .random = &random };
+  ockam_transport_t                   transport        = { 0 };
+  ockam_transport_socket_attributes_t transport_attrs  = { 0 };
+  ockam_ip_address_t                  address          = { "", "127.0.0.1", p_run->port };
+  ockam_reader_t*                     p_transport_rd   = NULL;
+  ockam_writer_t*                     p_transport_wr   = NULL;
+  ockam_channel_session_t             session          = { 0 };
+  ockam_channel_session_cache_t       cache            = { 0 };
+  ockam_channel_t                     channel          = { 0 };
+  ockam_channel_attributes_t          channel_attrs    = { 0 };
+  ockam_reader_t*                     p_reader         = NULL;
+  ockam_writer_t*                     p_writer         = NULL;
+  uint8_t                             message[BENCH_MESSAGE_SIZE];
+  size_t                              length = 0;
+  size_t                              i      = 0;
+  uint64_t                            start  = 0;
+
+  error = ockam_random_urandom_init(&random);
+  if (error) goto exit;
+
+  error = ockam_vault_default_init(&vault, &vault_attributes);
+  if (error) goto exit;
+
+  if (p_run->use_sessions && !client) {
+    error = ockam_channel_session_cache_init(&cache, &p_run->memory, &vault, BENCH_CACHE_CAPACITY, 0);
+    if (error) goto exit;
+  }
+
+  transport_attrs.p_memory    = &p_run->memory;
+  transport_attrs.tcp_nodelay = 1;
+  if (!client) transport_attrs.listen_address = address;
+  error = ockam_transport_socket_tcp_init(&transport, &transport_attrs);
+  if (error) goto exit;
+
+  if (client) {
+    error = ockam_transport_connect(&transport, &p_transport_rd, &p_transport_wr, &address, 10, 1);
+  } else {
+    error = ockam_transport_accept(&transport, &p_transport_rd, &p_transport_wr, NULL);
+  }
+  if (error) goto exit;
+
+  channel_attrs.reader = p_transport_rd;
+  channel_attrs.writer = p_transport_wr;
+  channel_attrs.memory = &p_run->memory;
+  channel_attrs.vault  = &vault;
+  if (p_run->use_sessions) {
+    channel_attrs.session       = client ? &session : NULL;
+    channel_attrs.session_cache = client ? NULL : &cache;
+  }
+
+  for (i = 0; i < p_run->reconnects; i++) {
+    start = bench_now_ns();
+
+    error = ockam_channel_init(&channel, &channel_attrs);
+    if (error) goto exit;
+
+    if (client) {
+      error = ockam_channel_connect(&channel, &p_reader, &p_writer);
+      if (error) goto exit;
+      error = ockam_write(p_writer, (uint8_t*) BENCH_MESSAGE, BENCH_MESSAGE_SIZE);
+      if (error) goto exit;
+      error = ockam_read(p_reader, message, sizeof(message), &length);
+      if (error) goto exit;
+      p_run->total_ns += bench_now_ns() - start;
+      if (channel.resumptions) p_run->resumed++;
+    } else {
+      error = ockam_channel_accept(&channel, &p_reader, &p_writer);
+      if (error) goto exit;
+      error = ockam_read(p_reader, message, sizeof(message), &length);
+      if (error) goto exit;
+      error = ockam_write(p_writer, message, length);
+      if (error) goto exit;
+    }
+
+    if ((BENCH_MESSAGE_SIZE != length) || memcmp(message, BENCH_MESSAGE, BENCH_MESSAGE_SIZE)) {
+      error = BENCH_ERROR_MISMATCH;
+      goto exit;
+    }
+
+    ockam_channel_deinit(&channel);
+    memset(&channel, 0, sizeof(channel));
+  }
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  if (channel.channel_writer) ockam_channel_deinit(&channel);
+  if (transport.ctx) ockam_transport_deinit(&transport);
+  if (cache.sessions) ockam_channel_session_cache_deinit(&cache);
+  ockam_channel_session_deinit(&vault, &session);
+  if (vault.dispatch) ockam_vault_deinit(&vault);
+  ockam_random_deinit(&random);
+  return error;
+}
+
+void* bench_client(void* arg)
+{
+  bench_run_t* p_run = (bench_run_t*) arg;
+  p_run->error[1]    = bench_reconnect_run(p_run, 1);
+  return NULL;
+}
+
+void* bench_server(void* arg)
+{
+  bench_run_t* p_run = (bench_run_t*) arg;
+  p_run->error[0]    = bench_reconnect_run(p_run, 0);
+  return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+  bench_run_t run        = { 0 };
+  pthread_t   threads[2] = { 0 };
+  size_t      reconnects = BENCH_DEFAULT_RECONNECTS;
+  uint16_t    port       = BENCH_PORT;
+  int         mode       = 0;
+  int         rc         = 0;
+
+  if (argc > 1) reconnects = strtoul(argv[1], NULL, 10);
+  if (!reconnects) reconnects = 1;
+
+  for (mode = 0; mode < 2; mode++) {
+    memset(&run, 0, sizeof(run));
+    ockam_memory_stdlib_init(&run.memory);
+    run.port         = port++;
+    run.reconnects   = reconnects;
+    run.use_sessions = mode;
+
+    pthread_create(&threads[0], NULL, bench_server, &run);
+    pthread_create(&threads[1], NULL, bench_client, &run);
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+
+    if (run.error[0] || run.error[1]) {
+      printf("%-9s  failed (%x, %x)\n", mode ? "sessions" : "full", run.error[1], run.error[0]);
+      rc = -1;
+      continue;
+    }
+
+    printf("%-9s  %zu reconnects  %8.1f us per reconnect  %zu resumed\n",
+           mode ? "sessions" : "full",
+           run.reconnects,
+           (double) run.total_ns / (double) run.reconnects / 1e3,
+           run.resumed);
+  }
+
+  return rc;
+}
@@ -0,0 +1,265 @@
+/**
+ * @file    bench_throughput.c
+ * @brief   Measure secure channel throughput over loopback TCP
+ *
+ * For each transfer size the benchmark runs one channel with the default packet size and one with large packets
+ * negotiated, each once through ockam_read/ockam_write and once through the buffer API. The receiver checks every byte
+ * and reports MB/s from the first byte written to the last byte read, handshake excluded.
+ *
+ * With ockam_write the sender writes the whole transfer in application writes of BENCH_WRITE_SIZE bytes, which the
+ * channel splits into packets of the negotiated size. Each payload byte is copied twice beyond the kernel's own
+ * copies: into the channel's send buffer on the way out, and from the channel's receive buffer into the application's
+ * on the way in. The transport stages small frames through its receive buffer, a third copy on that side.
+ *
+ * With buffers the sender fills one packet-sized ockam_buffer_t per packet and the channel and transport prepend their
+ * headers into its headroom, so nothing is copied on the way out. The receiver gets each packet decrypted in the
+ * buffer the transport received it into; only the part of a frame that arrived in the transport's receive buffer
+ * together with the previous frame is copied.
+ *
+ * Usage: ockam_channel_throughput_bench [max_transfer_MiB]
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ockam/error.h"
+#include "ockam/io.h"
+#include "ockam/log.h"
+#include "ockam/memory.h"
+#include "ockam/memory/stdlib.h"
+#include "ockam/random/urandom.h"
+#include "ockam/transport.h"
+#include "ockam/transport/socket_tcp.h"
+#include "ockam/vault.h"
+#include "ockam/vault/default.h"
+#include "ockam/channel.h"
+#include "ockam/channel/channel_impl.h"
+
+#define BENCH_MIB           (1024u * 1024u)
+#define BENCH_WRITE_SIZE    BENCH_MIB
+#define BENCH_READ_SIZE     BENCH_MIB
+#define BENCH_PORT          8050
+#define BENCH_DEFAULT_LIMIT 100
+
+#define BENCH_ERROR_MISMATCH (OCKAM_ERROR_INTERFACE_CHANNEL | 0x00F2u)
+#define BENCH_ERROR_MEMORY   (OCKAM_ERROR_INTERFACE_CHANNEL | 0x00F3u)
+
+typedef struct {
+  ockam_memory_t memory;
+  uint16_t       port;
+  size_t         packet_size;
+  size_t         transfer;
+  int            use_buffers;
+  uint64_t       start_ns;
+  uint64_t       end_ns;
+  ockam_error_t  sender_error;
+  ockam_error_t  receiver_error;
+} bench_run_t;
+
+uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+uint8_t bench_byte(size_t offset)
+{
+  return (uint8_t)(offset * 7u + (offset >> 12u));
+}
+
+ockam_error_t bench_channel_run(bench_run_t* p_run, int sender)
+{
+  ockam_error_t                       error            = OCKAM_ERROR_NONE;
+  ockam_random_t                      random           = { 0 };
+  ockam_vault_t                       vault            = { 0 };
+  ockam_vault_default_attributes_t    vault_attributes = { .memory = &p_run->memory, .random = &random };
+  ockam_transport_t                   transport        = { 0 };
+  ockam_transport_socket_attributes_t transport_attrs  = { 0 };
+  ockam_ip_address_t                  address          = { "", "127.0.0.1", p_run->port };
+  ockam_reader_t*                     p_transport_rd   = NULL;
+  ockam_writer_t*                     p_transport_wr   = NULL;
+  ockam_channel_t                     channel          = { 0 };
+  ockam_channel_attributes_t          channel_attrs    = { 0 };
+  ockam_reader_t*                     p_reader         = NULL;
+  ockam_writer_t*                     p_writer         = NULL;
+  uint8_t*                            p_data           = NULL;
+  ockam_buffer_t*                     p_buffer         = NULL;
+  uint8_t*                            p_payload        = NULL;
+  size_t                              packet_payload   = 0;
+  size_t                              offset           = 0;
+  size_t                              length           = 0;
+  size_t                              i                = 0;
+
+  p_data = malloc(sender ? BENCH_WRITE_SIZE : BENCH_READ_SIZE);
+  if (NULL == p_data) {
+    error = BENCH_ERROR_MEMORY;
+    goto exit;
+  }
+
+  error = ockam_random_urandom_init(&random);
+  if (error) goto exit;
+
+  error = ockam_vault_default_init(&vault, &vault_attributes);
+  if (error) goto exit;
+
+  transport_attrs.p_memory    = &p_run->memory;
+  transport_attrs.tcp_nodelay = 1;
+  if (!sender) transport_attrs.listen_address = address;
+  error = ockam_transport_socket_tcp_init(&transport, &transport_attrs);
+  if (error) goto exit;
+
+  if (sender) {
+    error = ockam_transport_connect(&transport, &p_transport_rd, &p_transport_wr, &address, 10, 1);
+  } else {
+    error = ockam_transport_accept(&transport, &p_transport_rd, &p_transport_wr, NULL);
+  }
+  if (error) goto exit;
+
+  channel_attrs.reader          = p_transport_rd;
+  channel_attrs.writer          = p_transport_wr;
+  channel_attrs.memory          = &p_run->memory;
+  channel_attrs.vault           = &vault;
+  channel_attrs.max_packet_size = p_run->packet_size;
+
+  error = ockam_channel_init(&channel, &channel_attrs);
+  if (error) goto exit;
+
+  if (sender) {
+    error = ockam_channel_connect(&channel, &p_reader, &p_writer);
+  } else {
+    error = ockam_channel_accept(&channel, &p_reader, &p_writer);
+  }
+  if (error) goto exit;
+
+  if (sender) {
+    // Wait for the receiver's options so large packets are in use from the first write
+    error = ockam_read(p_reader, p_data, BENCH_WRITE_SIZE, &length);
+    if (error) goto exit;
+    packet_payload = channel.send_packet_size - CHANNEL_HEADER_MAX_SIZE - CHANNEL_BUFFER_TAILROOM;
+
+    p_run->start_ns = bench_now_ns();
+    while (offset < p_run->transfer) {
+      length = p_run->transfer - offset;
+      if (p_run->use_buffers) {
+        // One packet per buffer, so the channel can send it in place
+        if (length > packet_payload) length = packet_payload;
+        error = ockam_buffer_alloc(
+          &p_run->memory, CHANNEL_BUFFER_HEADROOM, length + CHANNEL_BUFFER_TAILROOM, &p_buffer);
+        if (error) goto exit;
+        ockam_buffer_put(p_buffer, length, &p_payload);
+        for (i = 0; i < length; i++) p_payload[i] = bench_byte(offset + i);
+        error    = ockam_write_buffer(p_writer, p_buffer);
+        p_buffer = NULL;
+      } else {
+        if (length > BENCH_WRITE_SIZE) length = BENCH_WRITE_SIZE;
+        for (i = 0; i < length; i++) p_data[i] = bench_byte(offset + i);
+        error = ockam_write(p_writer, p_data, length);
+      }
+      if (error) goto exit;
+      offset += length;
+    }
+  } else {
+    error = ockam_write(p_writer, p_data, 0);
+    if (error) goto exit;
+
+    while (offset < p_run->transfer) {
+      if (p_run->use_buffers) {
+        error = ockam_read_buffer(p_reader, &p_buffer);
+        if (error) goto exit;
+        p_payload = ockam_buffer_data(p_buffer);
+        length    = p_buffer->length;
+      } else {
+        error = ockam_read(p_reader, p_data, BENCH_READ_SIZE, &length);
+        if (error) goto exit;
+        p_payload = p_data;
+      }
+      for (i = 0; i < length; i++) {
+        if (p_payload[i] != bench_byte(offset + i)) {
+          error = BENCH_ERROR_MISMATCH;
+          goto exit;
+        }
+      }
+      ockam_buffer_release(p_buffer);
+      p_buffer = NULL;
+      offset += length;
+    }
+    p_run->end_ns = bench_now_ns();
+  }
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  ockam_buffer_release(p_buffer);
+  if (channel.channel_writer) ockam_channel_deinit(&channel);
+  if (transport.ctx) ockam_transport_deinit(&transport);
+  if (vault.dispatch) ockam_vault_deinit(&vault);
+  ockam_random_deinit(&random);
+  free(p_data);
+  return error;
+}
+
+void* bench_sender(void* arg)
+{
+  bench_run_t* p_run  = (bench_run_t*) arg;
+  p_run->sender_error = bench_channel_run(p_run, 1);
+  return NULL;
+}
+
+void* bench_receiver(void* arg)
+{
+  bench_run_t* p_run    = (bench_run_t*) arg;
+  p_run->receiver_error = bench_channel_run(p_run, 0);
+  return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+  bench_run_t run            = { 0 };
+  pthread_t   threads[2]     = { 0 };
+  size_t      packet_sizes[] = { 0, CHANNEL_LARGE_PACKET_SIZE };
+  size_t      limit          = BENCH_DEFAULT_LIMIT;
+  size_t      transfer       = 0;
+  size_t      i              = 0;
+  uint16_t    port           = BENCH_PORT;
+  int         rc             = 0;
+
+  if (argc > 1) limit = strtoul(argv[1], NULL, 10);
+
+  for (transfer = 1; transfer <= limit; transfer *= 10) {
+    for (i = 0; i < 2 * sizeof(packet_sizes) / sizeof(packet_sizes[0]); i++) {
+      memset(&run, 0, sizeof(run));
+      ockam_memory_stdlib_init(&run.memory);
+      run.port        = port++;
+      run.packet_size = packet_sizes[i / 2];
+      run.use_buffers = i % 2;
+      run.transfer    = transfer * BENCH_MIB;
+
+      pthread_create(&threads[0], NULL, bench_receiver, &run);
+      pthread_create(&threads[1], NULL, bench_sender, &run);
+      pthread_join(threads[0], NULL);
+      pthread_join(threads[1], NULL);
+
+      if (run.sender_error || run.receiver_error) {
+        printf("%4zu MiB  packet %7zu  %-6s  failed (%x, %x)\n",
+               transfer,
+               run.packet_size ? run.packet_size : (size_t) MAX_CHANNEL_PACKET_SIZE,
+               run.use_buffers ? "buffer" : "copy",
+               run.sender_error,
+               run.receiver_error);
+        rc = -1;
+        continue;
+      }
+
+      printf("%4zu MiB  packet %7zu  %-6s  %8.1f MB/s\n",
+             transfer,
+             run.packet_size ? run.packet_size : (size_t) MAX_CHANNEL_PACKET_SIZE,
+             run.use_buffers ? "buffer" : "copy",
+             (double) run.transfer / ((double) (run.end_ns - run.start_ns) / 1e3));
+    }
+  }
+
+  return rc;
+}
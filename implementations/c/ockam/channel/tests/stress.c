@@ -0,0 +1,395 @@
+/**
+ * @file    stress.c
+ * @brief   Drive many secure channels from parallel threads
+ *
+ * Each channel pair is an initiator thread and a responder thread connected by two in-memory pipes, so the test
+ * exercises the channel, key agreement and vault layers concurrently without depending on sockets. Every thread has
+ * its own vault because the default vault is not shared between threads. Odd-numbered pairs rekey every
+ * STRESS_REKEY_INTERVAL packets, and every other two pairs exchange ockam_buffer_t messages, with the responder
+ * echoing each buffer back in place. Every fourth pair is a ping pair instead, where the responder writes from a
+ * second thread while its reader answers the initiator's PINGs, both using the channel's key under its key lock.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ockam/error.h"
+#include "ockam/io.h"
+#include "ockam/io/impl.h"
+#include "ockam/log.h"
+#include "ockam/memory.h"
+#include "ockam/memory/stdlib.h"
+#include "ockam/mutex.h"
+#include "ockam/mutex/pthread.h"
+#include "ockam/random/urandom.h"
+#include "ockam/transport.h"
+#include "ockam/vault.h"
+#include "ockam/vault/default.h"
+#include "ockam/channel.h"
+#include "ockam/channel/channel_impl.h"
+#include "channel_test.h"
+
+#define STRESS_DEFAULT_PAIRS    32
+#define STRESS_DEFAULT_MESSAGES 256
+#define STRESS_MESSAGE_SIZE     256
+#define STRESS_PIPE_SLOTS       4
+#define STRESS_PIPE_SLOT_SIZE   MAX_XX_TRANSMIT_SIZE
+#define STRESS_REKEY_INTERVAL   16
+
+#define STRESS_ERROR_PIPE     (OCKAM_ERROR_INTERFACE_CHANNEL | 0x00F0u)
+#define STRESS_ERROR_MISMATCH (OCKAM_ERROR_INTERFACE_CHANNEL | 0x00F1u)
+
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t  changed;
+  size_t          head;
+  size_t          count;
+  size_t          length[STRESS_PIPE_SLOTS];
+  uint8_t         data[STRESS_PIPE_SLOTS][STRESS_PIPE_SLOT_SIZE];
+  ockam_reader_t  reader;
+  ockam_writer_t  writer;
+} stress_pipe_t;
+
+typedef struct {
+  ockam_writer_t* writer;
+  size_t          index;
+  size_t          messages;
+  ockam_error_t   error;
+} stress_ping_writer_t;
+
+typedef struct {
+  stress_pipe_t  to_responder;
+  stress_pipe_t  to_initiator;
+  ockam_memory_t memory;
+  size_t         index;
+  size_t         messages;
+  ockam_error_t  initiator_error;
+  ockam_error_t  responder_error;
+} stress_pair_t;
+
+ockam_error_t stress_pipe_read(void* ctx, uint8_t* buffer, size_t buffer_size, size_t* buffer_length)
+{
+  ockam_error_t  error = OCKAM_ERROR_NONE;
+  stress_pipe_t* pipe  = (stress_pipe_t*) ctx;
+
+  pthread_mutex_lock(&pipe->lock);
+  while (0 == pipe->count) pthread_cond_wait(&pipe->changed, &pipe->lock);
+
+  if (pipe->length[pipe->head] > buffer_size) {
+    error = STRESS_ERROR_PIPE;
+  } else {
+    memcpy(buffer, pipe->data[pipe->head], pipe->length[pipe->head]);
+    *buffer_length = pipe->length[pipe->head];
+  }
+
+  pipe->head = (pipe->head + 1) % STRESS_PIPE_SLOTS;
+  pipe->count -= 1;
+  pthread_cond_broadcast(&pipe->changed);
+  pthread_mutex_unlock(&pipe->lock);
+
+  return error;
+}
+
+ockam_error_t stress_pipe_write(void* ctx, uint8_t* buffer, size_t buffer_length)
+{
+  ockam_error_t  error = OCKAM_ERROR_NONE;
+  stress_pipe_t* pipe  = (stress_pipe_t*) ctx;
+  size_t         tail  = 0;
+
+  if (buffer_length > STRESS_PIPE_SLOT_SIZE) {
+    error = STRESS_ERROR_PIPE;
+    goto exit;
+  }
+
+  pthread_mutex_lock(&pipe->lock);
+  while (STRESS_PIPE_SLOTS == pipe->count) pthread_cond_wait(&pipe->changed, &pipe->lock);
+
+  tail = (pipe->head + pipe->count) % STRESS_PIPE_SLOTS;
+  memcpy(pipe->data[tail], buffer, buffer_length);
+  pipe->length[tail] = buffer_length;
+  pipe->count += 1;
+
+  pthread_cond_broadcast(&pipe->changed);
+  pthread_mutex_unlock(&pipe->lock);
+
+exit:
+  return error;
+}
+
+void stress_pipe_init(stress_pipe_t* pipe)
+{
+  pthread_mutex_init(&pipe->lock, NULL);
+  pthread_cond_init(&pipe->changed, NULL);
+  pipe->reader.read  = stress_pipe_read;
+  pipe->reader.ctx   = pipe;
+  pipe->writer.write = stress_pipe_write;
+  pipe->writer.ctx   = pipe;
+}
+
+void stress_pipe_deinit(stress_pipe_t* pipe)
+{
+  pthread_cond_destroy(&pipe->changed);
+  pthread_mutex_destroy(&pipe->lock);
+}
+
+void stress_message_fill(uint8_t* message, size_t pair, size_t sequence)
+{
+  size_t i;
+  for (i = 0; i < STRESS_MESSAGE_SIZE; i++) message[i] = (uint8_t)(pair * 31u + sequence * 7u + i);
+}
+
+void* stress_ping_write(void* arg)
+{
+  stress_ping_writer_t* ping_writer = (stress_ping_writer_t*) arg;
+  uint8_t               message[STRESS_MESSAGE_SIZE];
+  size_t                i;
+
+  for (i = 0; (i < ping_writer->messages) && !ping_writer->error; i++) {
+    stress_message_fill(message, ping_writer->index, i);
+    ping_writer->error = ockam_write(ping_writer->writer, message, STRESS_MESSAGE_SIZE);
+  }
+  return NULL;
+}
+
+/*
+ * The initiator sends a PING whenever the previous one has been answered and checks the payloads the responder's
+ * writer thread streams meanwhile, then sends one payload to stop the responder's reader.
+ */
+ockam_error_t stress_ping_initiate(stress_pair_t*   pair,
+                                   ockam_channel_t* p_channel,
+                                   ockam_reader_t*  p_reader,
+                                   ockam_writer_t*  p_writer)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+  uint8_t       expected[STRESS_MESSAGE_SIZE];
+  uint8_t       received[MAX_XX_TRANSMIT_SIZE];
+  size_t        received_length = 0;
+  size_t        i               = 0;
+
+  for (i = 0; i < pair->messages; i++) {
+    if ((0 == p_channel->ping_id) || p_channel->pong_received) {
+      error = channel_send_ping(p_channel);
+      if (error) goto exit;
+    }
+
+    error = ockam_read(p_reader, received, sizeof(received), &received_length);
+    if (error) goto exit;
+
+    stress_message_fill(expected, pair->index, i);
+    if ((STRESS_MESSAGE_SIZE != received_length) || (0 != memcmp(expected, received, STRESS_MESSAGE_SIZE))) {
+      error = STRESS_ERROR_MISMATCH;
+      goto exit;
+    }
+  }
+
+  error = ockam_write(p_writer, expected, STRESS_MESSAGE_SIZE);
+
+exit:
+  return error;
+}
+
+ockam_error_t stress_ping_respond(stress_pair_t* pair, ockam_reader_t* p_reader, ockam_writer_t* p_writer)
+{
+  ockam_error_t        error       = OCKAM_ERROR_NONE;
+  stress_ping_writer_t ping_writer = { .writer = p_writer, .index = pair->index, .messages = pair->messages };
+  pthread_t            thread;
+  uint8_t              received[MAX_XX_TRANSMIT_SIZE];
+  size_t               received_length = 0;
+
+  if (pthread_create(&thread, NULL, stress_ping_write, &ping_writer)) {
+    error = STRESS_ERROR_PIPE;
+    goto exit;
+  }
+
+  // PINGs are answered inside the read, which returns once the initiator's closing payload arrives
+  error = ockam_read(p_reader, received, sizeof(received), &received_length);
+
+  pthread_join(thread, NULL);
+  if (!error) error = ping_writer.error;
+
+exit:
+  return error;
+}
+
+ockam_error_t stress_channel_run(stress_pair_t* pair, int initiator)
+{
+  ockam_error_t                    error            = OCKAM_ERROR_NONE;
+  ockam_random_t                   random           = { 0 };
+  ockam_vault_t                    vault            = { 0 };
+  ockam_vault_default_attributes_t vault_attributes = { .memory = &pair->memory, .random = &random };
+  ockam_mutex_t                    mutex            = { 0 };
+  ockam_mutex_pthread_attributes_t mutex_attributes = { .memory = &pair->memory };
+  ockam_channel_t                  channel          = { 0 };
+  ockam_channel_attributes_t       channel_attrs    = { 0 };
+  ockam_reader_t*                  p_reader         = NULL;
+  ockam_writer_t*                  p_writer         = NULL;
+  uint8_t                          expected[STRESS_MESSAGE_SIZE];
+  uint8_t                          received[MAX_XX_TRANSMIT_SIZE];
+  size_t                           received_length = 0;
+  size_t                           i               = 0;
+  ockam_buffer_t*                  p_buffer        = NULL;
+  uint8_t*                         p_message       = NULL;
+  int                              use_buffers     = (pair->index / 2) % 2;
+  int                              ping_pair       = 3 == (pair->index % 4);
+
+  error = ockam_random_urandom_init(&random);
+  if (error) goto exit;
+
+  error = ockam_vault_default_init(&vault, &vault_attributes);
+  if (error) goto exit;
+
+  channel_attrs.reader = initiator ? &pair->to_initiator.reader : &pair->to_responder.reader;
+  channel_attrs.writer = initiator ? &pair->to_responder.writer : &pair->to_initiator.writer;
+  channel_attrs.memory = &pair->memory;
+  channel_attrs.vault  = &vault;
+
+  if (pair->index % 2) channel_attrs.rekey_interval = STRESS_REKEY_INTERVAL;
+
+  if (ping_pair) {
+    error = ockam_mutex_pthread_init(&mutex, &mutex_attributes);
+    if (error) goto exit;
+    channel_attrs.mutex = &mutex;
+  }
+
+  error = ockam_channel_init(&channel, &channel_attrs);
+  if (error) goto exit;
+
+  if (initiator) {
+    error = ockam_channel_connect(&channel, &p_reader, &p_writer);
+  } else {
+    error = ockam_channel_accept(&channel, &p_reader, &p_writer);
+  }
+  if (error) goto exit;
+
+  if (ping_pair) {
+    error = initiator ? stress_ping_initiate(pair, &channel, p_reader, p_writer)
+                      : stress_ping_respond(pair, p_reader, p_writer);
+    goto exit;
+  }
+
+  for (i = 0; i < pair->messages; i++) {
+    if (initiator) {
+      stress_message_fill(expected, pair->index, i);
+      if (use_buffers) {
+        error = ockam_buffer_alloc(
+          &pair->memory, CHANNEL_BUFFER_HEADROOM, STRESS_MESSAGE_SIZE + CHANNEL_BUFFER_TAILROOM, &p_buffer);
+        if (error) goto exit;
+        ockam_buffer_put(p_buffer, STRESS_MESSAGE_SIZE, &p_message);
+        memcpy(p_message, expected, STRESS_MESSAGE_SIZE);
+        error    = ockam_write_buffer(p_writer, p_buffer);
+        p_buffer = NULL;
+      } else {
+        error = ockam_write(p_writer, expected, STRESS_MESSAGE_SIZE);
+      }
+      if (error) goto exit;
+    }
+
+    if (use_buffers) {
+      error = ockam_read_buffer(p_reader, &p_buffer);
+      if (error) goto exit;
+      p_message       = ockam_buffer_data(p_buffer);
+      received_length = p_buffer->length;
+    } else {
+      error = ockam_read(p_reader, received, sizeof(received), &received_length);
+      if (error) goto exit;
+      p_message = received;
+    }
+
+    if (!initiator) {
+      if (use_buffers) {
+        // The header and tag stripped on receipt leave room to send the buffer straight back
+        error    = ockam_write_buffer(p_writer, p_buffer);
+        p_buffer = NULL;
+      } else {
+        error = ockam_write(p_writer, received, received_length);
+      }
+      if (error) goto exit;
+    } else if ((STRESS_MESSAGE_SIZE != received_length) || (0 != memcmp(expected, p_message, STRESS_MESSAGE_SIZE))) {
+      error = STRESS_ERROR_MISMATCH;
+      goto exit;
+    }
+    ockam_buffer_release(p_buffer);
+    p_buffer = NULL;
+  }
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  ockam_buffer_release(p_buffer);
+  if (channel.channel_writer) ockam_channel_deinit(&channel);
+  if (mutex.dispatch) ockam_mutex_deinit(&mutex);
+  if (vault.dispatch) ockam_vault_deinit(&vault);
+  ockam_random_deinit(&random);
+  return error;
+}
+
+void* stress_initiator(void* arg)
+{
+  stress_pair_t* pair   = (stress_pair_t*) arg;
+  pair->initiator_error = stress_channel_run(pair, 1);
+  return NULL;
+}
+
+void* stress_responder(void* arg)
+{
+  stress_pair_t* pair   = (stress_pair_t*) arg;
+  pair->responder_error = stress_channel_run(pair, 0);
+  return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+  int            rc         = 0;
+  ockam_error_t  error      = OCKAM_ERROR_NONE;
+  size_t         pair_count = STRESS_DEFAULT_PAIRS;
+  size_t         messages   = STRESS_DEFAULT_MESSAGES;
+  size_t         failures   = 0;
+  size_t         i          = 0;
+  stress_pair_t* pairs      = NULL;
+  pthread_t*     threads    = NULL;
+
+  if (argc > 1) pair_count = strtoul(argv[1], NULL, 10);
+  if (argc > 2) messages = strtoul(argv[2], NULL, 10);
+  if (0 == pair_count) pair_count = STRESS_DEFAULT_PAIRS;
+
+  pairs   = calloc(pair_count, sizeof(stress_pair_t));
+  threads = calloc(pair_count * 2, sizeof(pthread_t));
+  if (!pairs || !threads) {
+    rc = -1;
+    goto exit;
+  }
+
+  for (i = 0; i < pair_count; i++) {
+    error = ockam_memory_stdlib_init(&pairs[i].memory);
+    if (error) {
+      rc = -1;
+      goto exit;
+    }
+    stress_pipe_init(&pairs[i].to_responder);
+    stress_pipe_init(&pairs[i].to_initiator);
+    pairs[i].index    = i;
+    pairs[i].messages = messages;
+  }
+
+  for (i = 0; i < pair_count; i++) {
+    pthread_create(&threads[2 * i], NULL, stress_responder, &pairs[i]);
+    pthread_create(&threads[2 * i + 1], NULL, stress_initiator, &pairs[i]);
+  }
+
+  for (i = 0; i < pair_count * 2; i++) pthread_join(threads[i], NULL);
+
+  for (i = 0; i < pair_count; i++) {
+    if (pairs[i].initiator_error || pairs[i].responder_error) failures++;
+    stress_pipe_deinit(&pairs[i].to_responder);
+    stress_pipe_deinit(&pairs[i].to_initiator);
+  }
+
+  printf("%zu channels, %zu messages each, %zu failed\n", pair_count, messages, failures);
+  if (failures) rc = -1;
+
+exit:
+  free(threads);
+  free(pairs);
+  return rc;
+}
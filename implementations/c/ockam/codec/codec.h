@@ -1,3 +1,6 @@
+#ifndef OCKAM_CODEC_H
+#define OCKAM_CODEC_H
+
 #include <stdint.h>
 #include "ockam/error.h"
 
@@ -24,6 +27,10 @@
         4: key_agreement_t1_m2
         5: key_agreement_t1_m3
 
+       10: request_resume
+       11: resume_accept
+       12: resume_reject
+
  */
 
 typedef enum {
@@ -36,7 +43,10 @@ typedef enum {
   kPayloadAeadAesGcm  = 6,
   kKeyAgreementM1     = 7,
   kKeyAgreementM2     = 8,
-  kKeyAgreementM3     = 9
+  kKeyAgreementM3     = 9,
+  REQUEST_RESUME      = 10,
+  RESUME_ACCEPT       = 11,
+  RESUME_REJECT       = 12
 } codec_message_type_t;
 
 typedef struct {
@@ -159,3 +169,5 @@ uint8_t* encode_ockam_wire(uint8_t* p_encoded);
 uint8_t* decode_ockam_wire(uint8_t* p_encoded);
 uint8_t* encode_route(uint8_t* p_encoded, codec_route_t* p_route);
 uint8_t* decode_route(uint8_t* p_encoded, codec_route_t* p_route);
+
+#endif
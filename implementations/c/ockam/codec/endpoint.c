@@ -31,19 +31,19 @@ uint8_t* encode_endpoint(uint8_t* encoded, CodecEndpointType type, uint8_t* endp
   case kUdpIpv4: {
     KTUdpIpv4Endpoint* ucp_ipv_4_endpoint = (KTUdpIpv4Endpoint*) endpoint;
     memcpy(encoded, ucp_ipv_4_endpoint, sizeof(KTUdpIpv4Endpoint));
-    encoded += sizeof(kUdpIpv4);
+    encoded += sizeof(KTUdpIpv4Endpoint);
     break;
   }
   case kTcpIpv6: {
     KTTcpIpv6Endpoint* tcp_ipv_6_endpoint = (KTTcpIpv6Endpoint*) endpoint;
     memcpy(encoded, tcp_ipv_6_endpoint, sizeof(KTTcpIpv6Endpoint));
-    encoded += sizeof(kTcpIpv6);
+    encoded += sizeof(KTTcpIpv6Endpoint);
     break;
   }
   case kUdpIpv6: {
     KTUdpIpv6Endpoint* ucp_ipv_6_endpoint = (KTUdpIpv6Endpoint*) endpoint;
     memcpy(encoded, ucp_ipv_6_endpoint, sizeof(KTUdpIpv6Endpoint));
-    encoded += sizeof(kUdpIpv6);
+    encoded += sizeof(KTUdpIpv6Endpoint);
     break;
   }
   case kInvalid:
@@ -83,20 +83,20 @@ uint8_t* decode_endpoint(uint8_t* encoded, CodecEndpointType* type, uint8_t* end
   }
   case kUdpIpv4: {
     KTUdpIpv4Endpoint* ucp_ipv_4_endpoint = (KTUdpIpv4Endpoint*) endpoint;
-    memcpy(encoded, ucp_ipv_4_endpoint, sizeof(KTUdpIpv4Endpoint));
-    encoded += sizeof(kUdpIpv4);
+    memcpy(ucp_ipv_4_endpoint, encoded, sizeof(KTUdpIpv4Endpoint));
+    encoded += sizeof(KTUdpIpv4Endpoint);
     break;
   }
   case kTcpIpv6: {
     KTTcpIpv6Endpoint* tcp_ipv_6_endpoint = (KTTcpIpv6Endpoint*) endpoint;
     memcpy(tcp_ipv_6_endpoint, encoded, sizeof(KTTcpIpv6Endpoint));
-    encoded += sizeof(kTcpIpv6);
+    encoded += sizeof(KTTcpIpv6Endpoint);
     break;
   }
   case kUdpIpv6: {
     KTUdpIpv6Endpoint* ucp_ipv_6_endpoint = (KTUdpIpv6Endpoint*) endpoint;
     memcpy(ucp_ipv_6_endpoint, encoded, sizeof(KTUdpIpv6Endpoint));
-    encoded += sizeof(kUdpIpv6);
+    encoded += sizeof(KTUdpIpv6Endpoint);
     break;
   }
   case kInvalid:
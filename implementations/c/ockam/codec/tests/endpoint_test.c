@@ -29,6 +29,12 @@ void _test_endpoints(void** state)
 {
   KTTcpIpv4Endpoint ep_ipv4_in = { { 127, 0, 0, 1 }, 4000 };
   KTTcpIpv4Endpoint ep_ipv4_out;
+  KTUdpIpv4Endpoint ep_udp_ipv4_in = { { 10, 0, 0, 1 }, 4001 };
+  KTUdpIpv4Endpoint ep_udp_ipv4_out;
+  KTTcpIpv6Endpoint ep_ipv6_in = { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 }, 4002 };
+  KTTcpIpv6Endpoint ep_ipv6_out;
+  KTUdpIpv6Endpoint ep_udp_ipv6_in = { { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 }, 4003 };
+  KTUdpIpv6Endpoint ep_udp_ipv6_out;
 
   CodecEndpointType type;
 
@@ -42,6 +48,29 @@ void _test_endpoints(void** state)
   assert_ptr_not_equal(0, encoded);
   assert_int_equal(type, kTcpIpv4);
   assert_int_equal(0, memcmp(&ep_ipv4_in, &ep_ipv4_out, sizeof(KTTcpIpv4Endpoint)));
+
+  // UDP IPV4, TCP IPV6 and UDP IPV6 back to back, so each must consume exactly its own bytes
+  encoded = encoded_buffer;
+  encoded = encode_endpoint(encoded, kUdpIpv4, (uint8_t*) &ep_udp_ipv4_in);
+  assert_ptr_not_equal(0, encoded);
+  encoded = encode_endpoint(encoded, kTcpIpv6, (uint8_t*) &ep_ipv6_in);
+  assert_ptr_not_equal(0, encoded);
+  encoded = encode_endpoint(encoded, kUdpIpv6, (uint8_t*) &ep_udp_ipv6_in);
+  assert_ptr_not_equal(0, encoded);
+
+  encoded = encoded_buffer;
+  encoded = decode_endpoint(encoded, &type, (uint8_t*) &ep_udp_ipv4_out);
+  assert_ptr_not_equal(0, encoded);
+  assert_int_equal(type, kUdpIpv4);
+  assert_int_equal(0, memcmp(&ep_udp_ipv4_in, &ep_udp_ipv4_out, sizeof(KTUdpIpv4Endpoint)));
+  encoded = decode_endpoint(encoded, &type, (uint8_t*) &ep_ipv6_out);
+  assert_ptr_not_equal(0, encoded);
+  assert_int_equal(type, kTcpIpv6);
+  assert_int_equal(0, memcmp(&ep_ipv6_in, &ep_ipv6_out, sizeof(KTTcpIpv6Endpoint)));
+  encoded = decode_endpoint(encoded, &type, (uint8_t*) &ep_udp_ipv6_out);
+  assert_ptr_not_equal(0, encoded);
+  assert_int_equal(type, kUdpIpv6);
+  assert_int_equal(0, memcmp(&ep_udp_ipv6_in, &ep_udp_ipv6_out, sizeof(KTUdpIpv6Endpoint)));
 }
 
 int _test_endpoints_teardown(void** state)
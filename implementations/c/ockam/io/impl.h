@@ -3,14 +3,22 @@
 
 #include "ockam/io.h"
 
+/*
+ * The scatter-gather and buffer entry points are optional and may be left NULL, in which case io.c falls back to
+ * read/write where it can.
+ */
 struct ockam_reader_t {
   ockam_error_t (*read)(void*, uint8_t*, size_t, size_t*);
   void* ctx;
+  ockam_error_t (*readv)(void*, const ockam_iovec_t*, size_t, size_t*);
+  ockam_error_t (*read_buffer)(void*, ockam_buffer_t**);
 };
 
 struct ockam_writer_t {
   ockam_error_t (*write)(void*, uint8_t*, size_t);
   void* ctx;
+  ockam_error_t (*writev)(void*, const ockam_iovec_t*, size_t);
+  ockam_error_t (*write_buffer)(void*, ockam_buffer_t*);
 };
 
 #endif
@@ -33,4 +33,182 @@ exit:
   return error;
 }
 
+
+ockam_error_t ockam_readv(ockam_reader_t* p_reader, const ockam_iovec_t* iov, size_t iov_count, size_t* buffer_length)
+{
+  ockam_error_t error;
+
+  if (!p_reader) {
+    error = IO_ERROR_INVALID_READER;
+    goto exit;
+  }
+  if ((NULL == iov) || (0 == iov_count)) {
+    error = IO_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if (p_reader->readv) {
+    error = p_reader->readv(p_reader->ctx, iov, iov_count, buffer_length);
+  } else if (1 == iov_count) {
+    error = p_reader->read(p_reader->ctx, iov->base, iov->length, buffer_length);
+  } else {
+    error = IO_ERROR_NOT_SUPPORTED;
+  }
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t ockam_writev(ockam_writer_t* p_writer, const ockam_iovec_t* iov, size_t iov_count)
+{
+  ockam_error_t error;
+
+  if (!p_writer) {
+    error = IO_ERROR_INVALID_READER;
+    goto exit;
+  }
+  if ((NULL == iov) || (0 == iov_count)) {
+    error = IO_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if (p_writer->writev) {
+    error = p_writer->writev(p_writer->ctx, iov, iov_count);
+  } else if (1 == iov_count) {
+    error = p_writer->write(p_writer->ctx, iov->base, iov->length);
+  } else {
+    error = IO_ERROR_NOT_SUPPORTED;
+  }
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t ockam_read_buffer(ockam_reader_t* p_reader, ockam_buffer_t** pp_buffer)
+{
+  ockam_error_t error;
+
+  if (!p_reader) {
+    error = IO_ERROR_INVALID_READER;
+    goto exit;
+  }
+  if (NULL == pp_buffer) {
+    error = IO_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+  *pp_buffer = NULL;
+
+  if (NULL == p_reader->read_buffer) {
+    error = IO_ERROR_NOT_SUPPORTED;
+    goto exit;
+  }
+  error = p_reader->read_buffer(p_reader->ctx, pp_buffer);
+
+exit:
+  // Not logged when unsupported: callers are expected to fall back to ockam_read()
+  if (error && (IO_ERROR_NOT_SUPPORTED != error)) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t ockam_write_buffer(ockam_writer_t* p_writer, ockam_buffer_t* p_buffer)
+{
+  ockam_error_t error;
+
+  if (!p_writer) {
+    error = IO_ERROR_INVALID_READER;
+    goto exit;
+  }
+  if (NULL == p_buffer) {
+    error = IO_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if (p_writer->write_buffer) {
+    error    = p_writer->write_buffer(p_writer->ctx, p_buffer);
+    p_buffer = NULL;
+  } else {
+    error = p_writer->write(p_writer->ctx, ockam_buffer_data(p_buffer), p_buffer->length);
+  }
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  ockam_buffer_release(p_buffer);
+  return error;
+}
+
+ockam_error_t ockam_buffer_alloc(ockam_memory_t* memory, size_t headroom, size_t size, ockam_buffer_t** pp_buffer)
+{
+  ockam_error_t   error    = OCKAM_ERROR_NONE;
+  ockam_buffer_t* p_buffer = NULL;
+
+  if ((NULL == memory) || (NULL == pp_buffer) || (headroom + size < headroom)) {
+    error = IO_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  error = ockam_memory_alloc_zeroed(memory, (void**) &p_buffer, sizeof(ockam_buffer_t) + headroom + size);
+  if (error) goto exit;
+
+  p_buffer->memory   = memory;
+  p_buffer->refcount = 1;
+  p_buffer->capacity = headroom + size;
+  p_buffer->offset   = headroom;
+  p_buffer->length   = 0;
+  *pp_buffer         = p_buffer;
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+void ockam_buffer_ref(ockam_buffer_t* p_buffer)
+{
+  p_buffer->refcount++;
+}
+
+void ockam_buffer_release(ockam_buffer_t* p_buffer)
+{
+  if (NULL == p_buffer) return;
+  if (--p_buffer->refcount) return;
+  ockam_memory_free(p_buffer->memory, p_buffer, sizeof(ockam_buffer_t) + p_buffer->capacity);
+}
+
+ockam_error_t ockam_buffer_push(ockam_buffer_t* p_buffer, size_t length, uint8_t** pp_data)
+{
+  if (length > p_buffer->offset) return IO_ERROR_BUFFER_SPACE;
+
+  p_buffer->offset -= length;
+  p_buffer->length += length;
+  if (pp_data) *pp_data = ockam_buffer_data(p_buffer);
+  return OCKAM_ERROR_NONE;
+}
+
+ockam_error_t ockam_buffer_pull(ockam_buffer_t* p_buffer, size_t length)
+{
+  if (length > p_buffer->length) return IO_ERROR_BUFFER_SPACE;
+
+  p_buffer->offset += length;
+  p_buffer->length -= length;
+  return OCKAM_ERROR_NONE;
+}
+
+ockam_error_t ockam_buffer_put(ockam_buffer_t* p_buffer, size_t length, uint8_t** pp_tail)
+{
+  if (length > ockam_buffer_tailroom(p_buffer)) return IO_ERROR_BUFFER_SPACE;
+
+  if (pp_tail) *pp_tail = ockam_buffer_data(p_buffer) + p_buffer->length;
+  p_buffer->length += length;
+  return OCKAM_ERROR_NONE;
+}
+
+ockam_error_t ockam_buffer_trim(ockam_buffer_t* p_buffer, size_t length)
+{
+  if (length > p_buffer->length) return IO_ERROR_BUFFER_SPACE;
+
+  p_buffer->length = length;
+  return OCKAM_ERROR_NONE;
+}
+
 #endif
@@ -5,14 +5,136 @@
 #include <stdint.h>
 
 #include "ockam/error.h"
+#include "ockam/memory.h"
 
 #define IO_ERROR_INVALID_READER (OCKAM_ERROR_INTERFACE_IO | 1u)
+#define IO_ERROR_NOT_SUPPORTED  (OCKAM_ERROR_INTERFACE_IO | 2u)
+#define IO_ERROR_INVALID_PARAM  (OCKAM_ERROR_INTERFACE_IO | 3u)
+#define IO_ERROR_BUFFER_SPACE   (OCKAM_ERROR_INTERFACE_IO | 4u)
 
 typedef struct ockam_reader_t ockam_reader_t;
 
 typedef struct ockam_writer_t ockam_writer_t;
 
+/**
+ * One element of a scatter-gather list.
+ */
+typedef struct ockam_iovec_t {
+  uint8_t* base;
+  size_t   length;
+} ockam_iovec_t;
+
+/**
+ * Refcounted message buffer with room reserved in front of and behind the data.
+ *
+ * Each layer of a stack prepends its header into the headroom with ockam_buffer_push() and strips it on the way up
+ * with ockam_buffer_pull(), so a payload is written once and then passed down to the socket without being copied.
+ * Layers that transform the data in place (e.g. encryption) may only do so while they hold the only reference.
+ * References are not atomic: a buffer is owned by one thread at a time.
+ */
+typedef struct ockam_buffer_t {
+  ockam_memory_t* memory;   /*!< Allocator the buffer is returned to */
+  size_t          refcount; /*!< Number of owners, the buffer is freed when it drops to zero */
+  size_t          capacity; /*!< Size of data[] */
+  size_t          offset;   /*!< Start of the valid bytes, i.e. the headroom */
+  size_t          length;   /*!< Number of valid bytes */
+  uint8_t         data[];
+} ockam_buffer_t;
+
+/**
+ * @brief   Allocate a buffer holding no data, with headroom bytes in front and size bytes behind.
+ * @param   memory      [in]  - Allocator for the buffer.
+ * @param   headroom    [in]  - Bytes reserved for headers pushed later.
+ * @param   size        [in]  - Bytes available for the payload and any trailers.
+ * @param   pp_buffer   [out] - The new buffer, holding one reference.
+ */
+ockam_error_t ockam_buffer_alloc(ockam_memory_t* memory, size_t headroom, size_t size, ockam_buffer_t** pp_buffer);
+
+/**
+ * @brief   Add a reference to the buffer.
+ */
+void ockam_buffer_ref(ockam_buffer_t* p_buffer);
+
+/**
+ * @brief   Drop a reference, freeing the buffer with the last one. NULL is ignored.
+ */
+void ockam_buffer_release(ockam_buffer_t* p_buffer);
+
+static inline uint8_t* ockam_buffer_data(ockam_buffer_t* p_buffer)
+{
+  return p_buffer->data + p_buffer->offset;
+}
+
+static inline size_t ockam_buffer_headroom(ockam_buffer_t* p_buffer)
+{
+  return p_buffer->offset;
+}
+
+static inline size_t ockam_buffer_tailroom(ockam_buffer_t* p_buffer)
+{
+  return p_buffer->capacity - p_buffer->offset - p_buffer->length;
+}
+
+/**
+ * @brief   Grow the data by length bytes at the front, e.g. to prepend a header.
+ * @param   pp_data [out] - Optional, the new start of the data.
+ * @return  IO_ERROR_BUFFER_SPACE if the headroom is too small.
+ */
+ockam_error_t ockam_buffer_push(ockam_buffer_t* p_buffer, size_t length, uint8_t** pp_data);
+
+/**
+ * @brief   Remove length bytes from the front of the data, e.g. to strip a header.
+ * @return  IO_ERROR_BUFFER_SPACE if the buffer holds fewer bytes.
+ */
+ockam_error_t ockam_buffer_pull(ockam_buffer_t* p_buffer, size_t length);
+
+/**
+ * @brief   Grow the data by length bytes at the end.
+ * @param   pp_tail [out] - Optional, start of the added bytes.
+ * @return  IO_ERROR_BUFFER_SPACE if the tailroom is too small.
+ */
+ockam_error_t ockam_buffer_put(ockam_buffer_t* p_buffer, size_t length, uint8_t** pp_tail);
+
+/**
+ * @brief   Shorten the data to length bytes, e.g. to drop a trailer.
+ * @return  IO_ERROR_BUFFER_SPACE if the buffer holds fewer bytes.
+ */
+ockam_error_t ockam_buffer_trim(ockam_buffer_t* p_buffer, size_t length);
+
 ockam_error_t ockam_read(ockam_reader_t* reader, uint8_t* buffer, size_t buffer_size, size_t* buffer_length);
 ockam_error_t ockam_write(ockam_writer_t* writer, uint8_t* buffer, size_t buffer_length);
 
+/**
+ * @brief   Read one message, scattered over iov_count buffers in order.
+ *
+ * Readers without native support handle a single element through ockam_read() and return IO_ERROR_NOT_SUPPORTED
+ * for more.
+ */
+ockam_error_t
+ockam_readv(ockam_reader_t* reader, const ockam_iovec_t* iov, size_t iov_count, size_t* buffer_length);
+
+/**
+ * @brief   Write the concatenation of iov_count buffers as one message.
+ *
+ * Writers without native support handle a single element through ockam_write() and return IO_ERROR_NOT_SUPPORTED
+ * for more.
+ */
+ockam_error_t ockam_writev(ockam_writer_t* writer, const ockam_iovec_t* iov, size_t iov_count);
+
+/**
+ * @brief   Read one message into a buffer allocated by the reader.
+ * @param   pp_buffer [out] - The message, holding one reference that the caller must release.
+ * @return  IO_ERROR_NOT_SUPPORTED if the reader cannot size the buffer itself; use ockam_read() instead.
+ */
+ockam_error_t ockam_read_buffer(ockam_reader_t* reader, ockam_buffer_t** pp_buffer);
+
+/**
+ * @brief   Write the buffer's data as one message.
+ *
+ * Takes over the caller's reference, also on error; call ockam_buffer_ref() first to keep the buffer. A writer holding
+ * the only reference may push its header into the headroom and modify the data in place, so leave headroom for the
+ * layers below. Writers without native support fall back to ockam_write().
+ */
+ockam_error_t ockam_write_buffer(ockam_writer_t* writer, ockam_buffer_t* p_buffer);
+
 #endif
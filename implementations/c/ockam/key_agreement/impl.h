@@ -12,6 +12,8 @@ typedef struct ockam_key_dispatch_table_t {
   ockam_error_t (*encrypt)(void*, uint8_t*, size_t, uint8_t*, size_t, size_t*);
   ockam_error_t (*decrypt)(void*, uint8_t*, size_t, uint8_t*, size_t, size_t*);
   ockam_error_t (*deinit)(void*);
+  ockam_error_t (*encrypt_in_place)(void*, uint8_t*, size_t, size_t, size_t*);
+  ockam_error_t (*decrypt_in_place)(void*, uint8_t*, size_t, size_t*);
 } ockam_key_dispatch_table_t;
 
 struct ockam_key {
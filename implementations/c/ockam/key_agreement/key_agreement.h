@@ -9,6 +9,7 @@
 #define KEYAGREEMENT_ERROR_TEST      (OCKAM_ERROR_INTERFACE_KEYAGREEMENT | 1u)
 #define KEYAGREEMENT_ERROR_FAIL      (OCKAM_ERROR_INTERFACE_KEYAGREEMENT | 2U)
 #define KEYAGREEMENT_ERROR_PARAMETER (OCKAM_ERROR_INTERFACE_KEYAGREEMENT | 3u)
+#define KEYAGREEMENT_ERROR_NONCE     (OCKAM_ERROR_INTERFACE_KEYAGREEMENT | 4u)
 
 typedef struct ockam_key ockam_key_t;
 
@@ -22,6 +23,15 @@ ockam_error_t ockam_key_encrypt(
 ockam_error_t ockam_key_decrypt(
   ockam_key_t* p_key, uint8_t* payload, size_t payload_size, uint8_t* msg, size_t msg_length, size_t* payload_length);
 
+/*
+ * In-place variants: the buffer holds the payload (or message) on entry and the message (or payload) on return,
+ * so the caller does not need a second buffer. For encryption the buffer must have room for the tag after the payload.
+ */
+ockam_error_t ockam_key_encrypt_in_place(
+  ockam_key_t* p_key, uint8_t* buffer, size_t payload_length, size_t buffer_size, size_t* msg_length);
+
+ockam_error_t ockam_key_decrypt_in_place(ockam_key_t* p_key, uint8_t* buffer, size_t msg_length, size_t* payload_length);
+
 ockam_error_t ockam_key_deinit(ockam_key_t*);
 
 #endif
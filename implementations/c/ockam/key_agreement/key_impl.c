@@ -80,6 +80,47 @@ exit:
   return error;
 }
 
+ockam_error_t ockam_key_encrypt_in_place(
+  ockam_key_t* p_key, uint8_t* buffer, size_t payload_length, size_t buffer_size, size_t* msg_length)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if (!p_key || !buffer || !msg_length) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+  if (!payload_length || !buffer_size) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  error = p_key->dispatch->encrypt_in_place(p_key->context, buffer, payload_length, buffer_size, msg_length);
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t ockam_key_decrypt_in_place(ockam_key_t* p_key, uint8_t* buffer, size_t msg_length, size_t* payload_length)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if (!p_key) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+  if (!buffer || !msg_length || !payload_length) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  error = p_key->dispatch->decrypt_in_place(p_key->context, buffer, msg_length, payload_length);
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
 ockam_error_t ockam_key_deinit(ockam_key_t* p_key)
 {
   ockam_error_t error = OCKAM_ERROR_NONE;
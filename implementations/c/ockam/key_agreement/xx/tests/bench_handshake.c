@@ -0,0 +1,220 @@
+/**
+ * @file    bench_handshake.c
+ * @brief   Measure XX handshakes per second with and without a key pool and long-term static keys
+ *
+ * An initiator and a responder thread run back-to-back handshakes over one loopback TCP connection, each on its own
+ * vault. By default every handshake generates its static and ephemeral keypairs inline. With a long-term static key
+ * on each side only the ephemeral keypair is generated. With a pool on each side the keypairs still needed come from
+ * keypairs generated ahead of time on the pool's thread, so a handshake only does its DH operations.
+ * The pools start empty and refill whenever their threads get the CPU, so the miss count shows how many keypairs the
+ * handshakes still had to generate themselves. The pool moves key generation off the handshake's path rather than
+ * removing it, so the rate only improves when there are idle cores for the pool threads to run on.
+ *
+ * Usage: ockam_key_agreement_xx_handshake_bench [handshakes]
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ockam/error.h"
+#include "ockam/io.h"
+#include "ockam/key_agreement.h"
+#include "ockam/key_agreement/xx.h"
+#include "ockam/log.h"
+#include "ockam/memory.h"
+#include "ockam/memory/stdlib.h"
+#include "ockam/random/urandom.h"
+#include "ockam/transport.h"
+#include "ockam/transport/socket_tcp.h"
+#include "ockam/vault.h"
+#include "ockam/vault/default.h"
+
+#define BENCH_PORT               8060
+#define BENCH_DEFAULT_HANDSHAKES 1000
+
+typedef struct {
+  ockam_memory_t memory;
+  uint16_t       port;
+  size_t         handshakes;
+  int            use_pool;
+  int            use_static;
+  uint64_t       start_ns;
+  uint64_t       end_ns;
+  uint64_t       missed[2];
+  ockam_error_t  error[2];
+} bench_run_t;
+
+const char* bench_mode_names[] = { "inline", "pool", "static", "static + pool" };
+
+uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+ockam_error_t bench_handshake_run(bench_run_t* p_run, int initiator)
+{
+  ockam_error_t                       error            = OCKAM_ERROR_NONE;
+  ockam_random_t                      random           = { 0 };
+  ockam_vault_t                       vault            = { 0 };
+  ockam_vault_t                       pool_vault       = { 0 };
+  ockam_vault_default_attributes_t    vault_attributes = { .memory = &p_run->memory, .random = &random };
+  ockam_xx_key_pool_t*                p_pool           = NULL;
+  ockam_xx_key_pool_attributes_t      pool_attributes  = { 0 };
+  ockam_xx_key_pool_stats_t           pool_stats       = { 0 };
+  ockam_vault_secret_attributes_t     static_attrs     = { OCKAM_VAULT_CURVE25519_PUBLICKEY_LENGTH,
+                                                           OCKAM_VAULT_SECRET_TYPE_CURVE25519_PRIVATEKEY,
+                                                           OCKAM_VAULT_SECRET_PURPOSE_KEY_AGREEMENT,
+                                                           OCKAM_VAULT_SECRET_EPHEMERAL };
+  ockam_vault_secret_t                static_secret    = { 0 };
+  ockam_xx_static_key_t               static_key       = { 0 };
+  ockam_transport_t                   transport        = { 0 };
+  ockam_transport_socket_attributes_t transport_attrs  = { 0 };
+  ockam_ip_address_t                  address          = { "", "127.0.0.1", p_run->port };
+  ockam_reader_t*                     p_reader         = NULL;
+  ockam_writer_t*                     p_writer         = NULL;
+  ockam_key_t                         key              = { 0 };
+  size_t                              i                = 0;
+
+  error = ockam_random_urandom_init(&random);
+  if (error) goto exit;
+
+  error = ockam_vault_default_init(&vault, &vault_attributes);
+  if (error) goto exit;
+
+  if (p_run->use_static) {
+    error = ockam_vault_secret_generate(&vault, &static_secret, &static_attrs);
+    if (error) goto exit;
+
+    error = ockam_xx_static_key_init(&static_key, &vault, &static_secret);
+    if (error) goto exit;
+  }
+
+  if (p_run->use_pool) {
+    error = ockam_vault_default_init(&pool_vault, &vault_attributes);
+    if (error) goto exit;
+
+    pool_attributes.p_memory = &p_run->memory;
+    pool_attributes.p_vault  = &pool_vault;
+    error                    = ockam_xx_key_pool_init(&p_pool, &pool_attributes);
+    if (error) goto exit;
+  }
+
+  transport_attrs.p_memory    = &p_run->memory;
+  transport_attrs.tcp_nodelay = 1;
+  if (!initiator) transport_attrs.listen_address = address;
+  error = ockam_transport_socket_tcp_init(&transport, &transport_attrs);
+  if (error) goto exit;
+
+  if (initiator) {
+    error = ockam_transport_connect(&transport, &p_reader, &p_writer, &address, 10, 1);
+  } else {
+    error = ockam_transport_accept(&transport, &p_reader, &p_writer, NULL);
+  }
+  if (error) goto exit;
+
+  if (initiator) p_run->start_ns = bench_now_ns();
+  for (i = 0; i < p_run->handshakes; i++) {
+    error = ockam_xx_key_initialize(&key, &p_run->memory, &vault, p_reader, p_writer);
+    if (error) goto exit;
+
+    error = ockam_xx_key_pool_set(&key, p_pool);
+    if (error) goto exit;
+
+    error = ockam_xx_key_static_key_set(&key, p_run->use_static ? &static_key : NULL);
+    if (error) goto exit;
+
+    if (initiator) {
+      error = ockam_key_initiate(&key);
+    } else {
+      error = ockam_key_respond(&key);
+    }
+    if (error) goto exit;
+
+    ockam_key_deinit(&key);
+    key.context = NULL;
+  }
+  if (initiator) p_run->end_ns = bench_now_ns();
+
+  if (p_pool) {
+    error = ockam_xx_key_pool_stats(p_pool, &pool_stats);
+    if (error) goto exit;
+    p_run->missed[initiator] = pool_stats.missed;
+  }
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  if (key.context) ockam_key_deinit(&key);
+  if (transport.ctx) ockam_transport_deinit(&transport);
+  if (p_pool) ockam_xx_key_pool_deinit(p_pool);
+  if (static_secret.context) ockam_vault_secret_destroy(&vault, &static_secret);
+  if (pool_vault.dispatch) ockam_vault_deinit(&pool_vault);
+  if (vault.dispatch) ockam_vault_deinit(&vault);
+  ockam_random_deinit(&random);
+  return error;
+}
+
+void* bench_initiator(void* arg)
+{
+  bench_run_t* p_run = (bench_run_t*) arg;
+  p_run->error[1]    = bench_handshake_run(p_run, 1);
+  return NULL;
+}
+
+void* bench_responder(void* arg)
+{
+  bench_run_t* p_run = (bench_run_t*) arg;
+  p_run->error[0]    = bench_handshake_run(p_run, 0);
+  return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+  bench_run_t run        = { 0 };
+  pthread_t   threads[2] = { 0 };
+  size_t      handshakes = BENCH_DEFAULT_HANDSHAKES;
+  uint16_t    port       = BENCH_PORT;
+  int         mode       = 0;
+  int         rc         = 0;
+
+  if (argc > 1) handshakes = strtoul(argv[1], NULL, 10);
+
+  // Bit 0 selects a pool, bit 1 a long-term static key
+  for (mode = 0; mode < 4; mode++) {
+    memset(&run, 0, sizeof(run));
+    ockam_memory_stdlib_init(&run.memory);
+    run.port       = port++;
+    run.handshakes = handshakes;
+    run.use_pool   = mode & 1;
+    run.use_static = (mode >> 1) & 1;
+
+    pthread_create(&threads[0], NULL, bench_responder, &run);
+    pthread_create(&threads[1], NULL, bench_initiator, &run);
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+
+    if (run.error[0] || run.error[1]) {
+      printf("%-13s  failed (%x, %x)\n", bench_mode_names[mode], run.error[1], run.error[0]);
+      rc = -1;
+      continue;
+    }
+
+    printf("%-13s  %zu handshakes  %8.1f handshakes/s",
+           bench_mode_names[mode],
+           run.handshakes,
+           (double) run.handshakes / ((double) (run.end_ns - run.start_ns) / 1e9));
+    if (run.use_pool) {
+      printf("  missed %llu + %llu of %zu keypairs",
+             (unsigned long long) run.missed[1],
+             (unsigned long long) run.missed[0],
+             (run.use_static ? 2 : 4) * run.handshakes);
+    }
+    printf("\n");
+  }
+
+  return rc;
+}
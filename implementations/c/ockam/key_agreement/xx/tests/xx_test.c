@@ -114,6 +114,12 @@ int main(int argc, char* argv[])
   printf("Initiator   : %d\n", run_client);
   printf("Responder   : %d\n", run_server);
 
+  error = xx_test_step(&vault, &memory);
+  if (error) goto exit;
+
+  error = xx_test_static(&vault, &memory);
+  if (error) goto exit;
+
   //  error = xx_test_responder(&vault, &memory, &ockam_ip);
   //  error = xx_test_initiator(&vault, &ockam_ip);
   //  goto exit;
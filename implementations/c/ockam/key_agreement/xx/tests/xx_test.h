@@ -31,4 +31,6 @@
 #define MSG_5_CIPHERTEXT "217c5111fad7afde33bd28abaff3def88a57ab50515115d23a10f28621f842"
 
 ockam_error_t xx_test_initiator(ockam_vault_t* vault, ockam_memory_t* memory, ockam_ip_address_t* ip_address);
-ockam_error_t xx_test_responder(ockam_vault_t* vault, ockam_memory_t* memory, ockam_ip_address_t*);
\ No newline at end of file
+ockam_error_t xx_test_responder(ockam_vault_t* vault, ockam_memory_t* memory, ockam_ip_address_t*);
+ockam_error_t xx_test_step(ockam_vault_t* vault, ockam_memory_t* memory);
+ockam_error_t xx_test_static(ockam_vault_t* vault, ockam_memory_t* memory);
\ No newline at end of file
@@ -75,6 +75,12 @@ ockam_error_t xx_test_initiator_prologue(key_establishment_xx* xx)
   // prologue is empty
   mix_hash(xx, NULL, 0);
 
+  // The library starts every handshake from the precomputed result
+  if (0 != memcmp(xx->h, xx_initial_h, SHA256_SIZE)) {
+    error = KEYAGREEMENT_ERROR_FAIL;
+    goto exit;
+  }
+
 exit:
   if (error) ockam_log_error("%x", error);
   return error;
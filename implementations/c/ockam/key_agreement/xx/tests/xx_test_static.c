@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "ockam/error.h"
+#include "ockam/key_agreement.h"
+#include "ockam/key_agreement/xx.h"
+#include "ockam/log.h"
+#include "ockam/memory.h"
+#include "ockam/transport.h"
+#include "ockam/vault.h"
+#include "xx_test.h"
+
+#define STATIC_TEST_HANDSHAKES 2
+
+/*
+ * Run one step-wise handshake between two fresh keys, the responder presenting the static key, and check that the
+ * initiator saw the static key's public key.
+ */
+ockam_error_t xx_test_static_handshake(ockam_vault_t* vault, ockam_memory_t* memory, ockam_xx_static_key_t* p_static)
+{
+  ockam_error_t               error = OCKAM_ERROR_NONE;
+  ockam_key_t                 keys[2];
+  uint8_t                     messages[2][OCKAM_XX_HANDSHAKE_MESSAGE_MAX_SIZE];
+  size_t                      lengths[2] = { 0 };
+  ockam_xx_handshake_status_t status[2]  = { OCKAM_XX_HANDSHAKE_WANT_INPUT, OCKAM_XX_HANDSHAKE_WANT_INPUT };
+  uint8_t                     peer_static[OCKAM_VAULT_CURVE25519_PUBLICKEY_LENGTH];
+  size_t                      i = 0;
+
+  memset(keys, 0, sizeof(keys));
+
+  // keys[0] initiates, keys[1] responds with the static key
+  for (i = 0; i < 2; i++) {
+    error = ockam_xx_key_initialize(&keys[i], memory, vault, NULL, NULL);
+    if (error) goto exit;
+  }
+  error = ockam_xx_key_static_key_set(&keys[1], p_static);
+  if (error) goto exit;
+  for (i = 0; i < 2; i++) {
+    error = ockam_xx_key_handshake_start(&keys[i], 0 == i);
+    if (error) goto exit;
+  }
+
+  // M1, M2 then M3, each step taking the other end's last message
+  error = ockam_xx_key_handshake_step(&keys[0], NULL, 0, messages[0], sizeof(messages[0]), &lengths[0], &status[0]);
+  if (error) goto exit;
+  for (i = 1; lengths[1 - i % 2]; i++) {
+    error = ockam_xx_key_handshake_step(&keys[i % 2],
+                                        messages[1 - i % 2],
+                                        lengths[1 - i % 2],
+                                        messages[i % 2],
+                                        sizeof(messages[i % 2]),
+                                        &lengths[i % 2],
+                                        &status[i % 2]);
+    if (error) goto exit;
+    lengths[1 - i % 2] = 0;
+  }
+
+  if ((OCKAM_XX_HANDSHAKE_DONE != status[0]) || (OCKAM_XX_HANDSHAKE_DONE != status[1])) {
+    error = KEYAGREEMENT_ERROR_TEST;
+    goto exit;
+  }
+
+  error = ockam_xx_key_peer_static_key_get(&keys[0], peer_static, sizeof(peer_static));
+  if (error) goto exit;
+  if (memcmp(peer_static, p_static->public_key, sizeof(peer_static))) {
+    error = KEYAGREEMENT_ERROR_TEST;
+    goto exit;
+  }
+
+exit:
+  for (i = 0; i < 2; i++) {
+    if (keys[i].context) ockam_key_deinit(&keys[i]);
+  }
+  return error;
+}
+
+/*
+ * Run handshakes one after the other on keys sharing one static key. Each must present the same public key, and
+ * ending a handshake must leave the static key's secret in the vault for the next one and for its owner.
+ */
+ockam_error_t xx_test_static(ockam_vault_t* vault, ockam_memory_t* memory)
+{
+  ockam_error_t                   error             = OCKAM_ERROR_NONE;
+  ockam_vault_secret_t            secret            = { 0 };
+  ockam_vault_secret_attributes_t secret_attributes = { KEY_SIZE,
+                                                        OCKAM_VAULT_SECRET_TYPE_CURVE25519_PRIVATEKEY,
+                                                        OCKAM_VAULT_SECRET_PURPOSE_KEY_AGREEMENT,
+                                                        OCKAM_VAULT_SECRET_EPHEMERAL };
+  ockam_xx_static_key_t           static_key        = { 0 };
+  uint8_t                         public_key[OCKAM_VAULT_CURVE25519_PUBLICKEY_LENGTH];
+  size_t                          length = 0;
+  size_t                          i      = 0;
+
+  error = ockam_vault_secret_generate(vault, &secret, &secret_attributes);
+  if (error) goto exit;
+  error = ockam_xx_static_key_init(&static_key, vault, &secret);
+  if (error) goto exit;
+
+  for (i = 0; i < STATIC_TEST_HANDSHAKES; i++) {
+    error = xx_test_static_handshake(vault, memory, &static_key);
+    if (error) goto exit;
+  }
+
+  // Still usable by its owner
+  error = ockam_vault_secret_publickey_get(vault, &secret, public_key, sizeof(public_key), &length);
+  if (error) goto exit;
+  if ((sizeof(public_key) != length) || memcmp(public_key, static_key.public_key, length)) {
+    error = KEYAGREEMENT_ERROR_TEST;
+    goto exit;
+  }
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  if (secret.context) ockam_vault_secret_destroy(vault, &secret);
+  printf("Shared static key handshakes: %s\n", error ? "failed" : "passed");
+  return error;
+}
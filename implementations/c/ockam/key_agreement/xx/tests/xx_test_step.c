@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "ockam/error.h"
+#include "ockam/key_agreement.h"
+#include "ockam/key_agreement/xx.h"
+#include "ockam/log.h"
+#include "ockam/memory.h"
+#include "ockam/transport.h"
+#include "ockam/vault.h"
+#include "xx_test.h"
+
+#define STEP_TEST_PAIRS   16
+#define STEP_TEST_M2_BYTE 40 /* A byte of the responder's encrypted static key */
+
+typedef struct {
+  ockam_key_t                 key;
+  uint8_t                     message[OCKAM_XX_HANDSHAKE_MESSAGE_MAX_SIZE];
+  size_t                      message_length;
+  ockam_xx_handshake_status_t status;
+} xx_test_step_end_t;
+
+/*
+ * Run STEP_TEST_PAIRS handshakes at once from this thread, advancing each pair by one message per round, then check
+ * that each pair's keys talk to each other.
+ */
+ockam_error_t xx_test_step(ockam_vault_t* vault, ockam_memory_t* memory)
+{
+  ockam_error_t        error = OCKAM_ERROR_NONE;
+  xx_test_step_end_t   ends[2 * STEP_TEST_PAIRS];
+  xx_test_step_end_t*  p_from        = NULL;
+  xx_test_step_end_t*  p_to          = NULL;
+  uint8_t              plaintext[]   = TEST_MSG_INITIATOR;
+  uint8_t              ciphertext[sizeof(plaintext) + 16];
+  uint8_t              decrypted[sizeof(plaintext)];
+  size_t               length        = 0;
+  size_t               pending       = STEP_TEST_PAIRS;
+  size_t               round         = 0;
+  size_t               i             = 0;
+  int                  corrupt_first = 1;
+  ockam_vault_secret_t resumption_secret;
+
+  memset(ends, 0, sizeof(ends));
+  memset(&resumption_secret, 0, sizeof(resumption_secret));
+
+  // Even entries initiate, odd entries respond; keys used step-wise need no reader or writer
+  for (i = 0; i < 2 * STEP_TEST_PAIRS; i++) {
+    error = ockam_xx_key_initialize(&ends[i].key, memory, vault, NULL, NULL);
+    if (error) goto exit;
+    error = ockam_xx_key_handshake_start(&ends[i].key, 0 == i % 2);
+    if (error) goto exit;
+  }
+
+  // Initiators make M1
+  for (i = 0; i < 2 * STEP_TEST_PAIRS; i += 2) {
+    error = ockam_xx_key_handshake_step(
+      &ends[i].key, NULL, 0, ends[i].message, sizeof(ends[i].message), &ends[i].message_length, &ends[i].status);
+    if (error) goto exit;
+  }
+
+  // Each round delivers the pending message of every pair to the other end
+  for (round = 0; pending && (round < 3); round++) {
+    for (i = 0; i < 2 * STEP_TEST_PAIRS; i += 2) {
+      p_from = (round % 2) ? &ends[i + 1] : &ends[i];
+      p_to   = (round % 2) ? &ends[i] : &ends[i + 1];
+      if (!p_from->message_length) continue;
+
+      // A corrupted M2 must fail the handshake instead of establishing a key
+      if (corrupt_first && (1 == round)) {
+        corrupt_first = 0;
+        p_from->message[STEP_TEST_M2_BYTE] ^= 1u;
+        error = ockam_xx_key_handshake_step(&p_to->key,
+                                            p_from->message,
+                                            p_from->message_length,
+                                            p_to->message,
+                                            sizeof(p_to->message),
+                                            &length,
+                                            &p_to->status);
+        if (OCKAM_ERROR_NONE == error) {
+          error = KEYAGREEMENT_ERROR_TEST;
+          goto exit;
+        }
+        p_from->message_length = 0;
+        p_to->message_length   = 0;
+        pending--;
+        continue;
+      }
+
+      error = ockam_xx_key_handshake_step(&p_to->key,
+                                          p_from->message,
+                                          p_from->message_length,
+                                          p_to->message,
+                                          sizeof(p_to->message),
+                                          &p_to->message_length,
+                                          &p_to->status);
+      if (error) goto exit;
+      p_from->message_length = 0;
+
+      if ((OCKAM_XX_HANDSHAKE_DONE == p_to->status) && !p_to->message_length) pending--;
+    }
+  }
+
+  if (pending) {
+    error = KEYAGREEMENT_ERROR_TEST;
+    goto exit;
+  }
+
+  // Pair 0 failed; every other initiator's messages decrypt at its responder
+  for (i = 2; i < 2 * STEP_TEST_PAIRS; i += 2) {
+    error = ockam_key_encrypt(&ends[i].key, plaintext, sizeof(plaintext), ciphertext, sizeof(ciphertext), &length);
+    if (error) goto exit;
+    error = ockam_key_decrypt(&ends[i + 1].key, decrypted, sizeof(decrypted), ciphertext, length, &length);
+    if (error) goto exit;
+    if ((sizeof(plaintext) != length) || memcmp(plaintext, decrypted, length)) {
+      error = KEYAGREEMENT_ERROR_TEST;
+      goto exit;
+    }
+  }
+
+  // An established key refuses a new handshake or a resumption, either would overwrite its secrets
+  if (OCKAM_ERROR_NONE == ockam_xx_key_handshake_start(&ends[2].key, 1)) {
+    error = KEYAGREEMENT_ERROR_TEST;
+    goto exit;
+  }
+  error = ockam_xx_key_resumption_secret_take(&ends[4].key, &resumption_secret);
+  if (error) goto exit;
+  if (OCKAM_ERROR_NONE == ockam_xx_key_resume(&ends[2].key, &resumption_secret, plaintext, sizeof(plaintext), 1)) {
+    error = KEYAGREEMENT_ERROR_TEST;
+    goto exit;
+  }
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  if (resumption_secret.context) ockam_vault_secret_destroy(vault, &resumption_secret);
+  for (i = 0; i < 2 * STEP_TEST_PAIRS; i++) {
+    if (ends[i].key.context) ockam_key_deinit(&ends[i].key);
+  }
+  printf("Step-wise handshakes: %s\n", error ? "failed" : "passed");
+  return error;
+}
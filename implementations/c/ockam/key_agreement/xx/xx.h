@@ -8,7 +8,172 @@
 
 #include "ockam/key_agreement/impl.h"
 
+/**
+ * @brief   Initialize an XX key.
+ * @param   reader  [in] - Where ockam_key_initiate/ockam_key_respond read handshake messages, may be NULL for keys
+ *                         that only use ockam_xx_key_handshake_step().
+ * @param   writer  [in] - Where they write them, as for reader.
+ */
 ockam_error_t ockam_xx_key_initialize(
   ockam_key_t* key, ockam_memory_t* memory, ockam_vault_t* vault, ockam_reader_t* reader, ockam_writer_t* writer);
 
+/**
+ * Step-wise handshake, for driving many handshakes from one thread. Instead of ockam_key_initiate/ockam_key_respond,
+ * which block on the key's reader and writer, start the handshake and then pass each complete message received from
+ * the peer to ockam_xx_key_handshake_step(), sending whatever it outputs. The initiator's first step takes no input
+ * and outputs the first message. The handshake ends when a step reports OCKAM_XX_HANDSHAKE_DONE, after which the key
+ * encrypts and decrypts as usual, or when a step fails.
+ */
+#define OCKAM_XX_HANDSHAKE_MESSAGE_MAX_SIZE 96u
+
+typedef enum {
+  OCKAM_XX_HANDSHAKE_WANT_INPUT = 0, /*!< Send the output, then step again with the peer's next message */
+  OCKAM_XX_HANDSHAKE_DONE,           /*!< Send the output, if any; the key is established */
+} ockam_xx_handshake_status_t;
+
+/**
+ * @brief   Start a step-wise handshake, generating or taking the handshake's keys.
+ * @param   key       [in] - Key initialized with ockam_xx_key_initialize, neither in a handshake nor established.
+ * @param   initiator [in] - 1 to initiate the handshake, 0 to respond.
+ */
+ockam_error_t ockam_xx_key_handshake_start(ockam_key_t* key, int initiator);
+
+/**
+ * @brief   Advance a step-wise handshake by one message.
+ * @param   input         [in]  - One complete message from the peer, NULL for the initiator's first step.
+ * @param   output        [out] - Message to send to the peer, at least OCKAM_XX_HANDSHAKE_MESSAGE_MAX_SIZE bytes.
+ * @param   output_length [out] - Length of the message to send, 0 for none.
+ * @param   status        [out] - Whether the handshake needs more input.
+ * @return  An error ends the handshake; the key may start a new one.
+ */
+ockam_error_t ockam_xx_key_handshake_step(ockam_key_t*                 key,
+                                          const uint8_t*               input,
+                                          size_t                       input_length,
+                                          uint8_t*                     output,
+                                          size_t                       output_size,
+                                          size_t*                      output_length,
+                                          ockam_xx_handshake_status_t* status);
+
+/**
+ * @brief   Rekey each direction of an established key every message_count messages.
+ *
+ * Rekeying follows Noise: the new key is the first 32 bytes of encrypting 32 zero bytes under the old key with the
+ * reserved nonce 2^64-1. It needs no messages, so both ends must be configured with the same message_count.
+ * @param   key           [in] - Key initialized with ockam_xx_key_initialize.
+ * @param   message_count [in] - Messages per key in each direction, 0 to never rekey.
+ */
+ockam_error_t ockam_xx_key_rekey_interval_set(ockam_key_t* key, uint64_t message_count);
+
+/**
+ * Session resumption. An established key also holds a resumption secret, derived from the handshake's final chaining
+ * key or, for a resumed key, from the secret it was resumed from. Two ends that kept the secrets of one session can
+ * later establish a new pair of keys from them with ockam_xx_key_resume() and a context both ends agree on, such as
+ * fresh nonces from each, instead of running the handshake. A resumed key proves nothing new about the peer's identity
+ * and has no forward secrecy beyond that of the original handshake, so callers should bound how often a session is
+ * resumed.
+ */
+
+/**
+ * @brief   Move the key's resumption secret to the caller, who must destroy it.
+ * @return  KEYAGREEMENT_ERROR_PARAMETER if the key has none, e.g. it is not established or the secret was taken.
+ */
+ockam_error_t ockam_xx_key_resumption_secret_take(ockam_key_t* key, ockam_vault_secret_t* secret);
+
+/**
+ * @brief   Establish a key from a resumption secret instead of a handshake.
+ * @param   key               [in] - Key initialized with ockam_xx_key_initialize and not yet established.
+ * @param   resumption_secret [in] - Secret taken from a key of the earlier session, in the key's vault; not destroyed.
+ * @param   context           [in] - Bytes mixed into the new keys, the same at both ends and never reused.
+ * @param   initiator         [in] - 1 at the end that initiated the resumption, 0 at the other.
+ */
+ockam_error_t ockam_xx_key_resume(ockam_key_t*          key,
+                                  ockam_vault_secret_t* resumption_secret,
+                                  const uint8_t*        context,
+                                  size_t                context_length,
+                                  int                   initiator);
+
+/**
+ * A long-term static key, the identity a key presents in its handshakes instead of a static key generated for each.
+ *
+ * The private key stays in the vault and the public key is computed once, by ockam_xx_static_key_init(). Handshakes
+ * only read it, so one static key can serve any number of keys at once, provided they all use the vault holding it
+ * and that vault is safe to use from their threads. It must outlive the keys using it.
+ */
+typedef struct ockam_xx_static_key_t {
+  ockam_vault_secret_t* p_secret;                                            /*!< Curve25519 private key */
+  uint8_t               public_key[OCKAM_VAULT_CURVE25519_PUBLICKEY_LENGTH]; /*!< Set by ockam_xx_static_key_init */
+} ockam_xx_static_key_t;
+
+/**
+ * @brief   Load a static key for use by handshakes.
+ * @param   static_key  [out] - The static key.
+ * @param   vault       [in]  - Vault holding the secret.
+ * @param   secret      [in]  - Curve25519 private key, owned by the caller; handshakes do not destroy it.
+ */
+ockam_error_t
+ockam_xx_static_key_init(ockam_xx_static_key_t* static_key, ockam_vault_t* vault, ockam_vault_secret_t* secret);
+
+/**
+ * @brief   Use the static key in the key's handshakes, NULL to generate a static key for each.
+ * @param   key         [in] - Key initialized with ockam_xx_key_initialize, on the static key's vault.
+ * @param   static_key  [in] - Static key loaded with ockam_xx_static_key_init, or NULL.
+ */
+ockam_error_t ockam_xx_key_static_key_set(ockam_key_t* key, const ockam_xx_static_key_t* static_key);
+
+/**
+ * @brief   Get the static public key the peer presented in the key's last completed handshake, to check its identity.
+ * @param   public_key      [out] - The peer's Curve25519 public key.
+ * @param   public_key_size [in]  - Size of public_key, at least OCKAM_VAULT_CURVE25519_PUBLICKEY_LENGTH.
+ * @return  KEYAGREEMENT_ERROR_PARAMETER if the key has not completed a handshake; a resumed key has not.
+ */
+ockam_error_t ockam_xx_key_peer_static_key_get(ockam_key_t* key, uint8_t* public_key, size_t public_key_size);
+
+/**
+ * A key pool keeps a supply of Curve25519 keypairs generated ahead of time by a background thread, so the handshakes
+ * of keys attached to it skip key generation and only do their DH operations. A handshake that finds the pool empty
+ * generates its keys itself, as it does without a pool.
+ *
+ * The pool's thread uses its own vault, which nothing else may use while the pool exists, and the vault's memory
+ * must be safe to use from two threads. Keys attached to the pool may use any vault, on any thread.
+ */
+#define OCKAM_XX_KEY_POOL_DEFAULT_SIZE 64
+
+typedef struct ockam_xx_key_pool ockam_xx_key_pool_t;
+
+typedef struct ockam_xx_key_pool_attributes_t {
+  ockam_memory_t* p_memory; /*!< Allocator for the pool, must be thread-safe */
+  ockam_vault_t*  p_vault;  /*!< Vault used only by the pool's thread */
+  size_t          size;     /*!< Keypairs kept ready, 0 for OCKAM_XX_KEY_POOL_DEFAULT_SIZE */
+} ockam_xx_key_pool_attributes_t;
+
+typedef struct ockam_xx_key_pool_stats_t {
+  size_t   available; /*!< Keypairs ready now */
+  uint64_t taken;     /*!< Keypairs handed to handshakes */
+  uint64_t missed;    /*!< Keypairs handshakes had to generate because the pool was empty */
+} ockam_xx_key_pool_stats_t;
+
+/**
+ * @brief   Create a key pool and start its thread.
+ */
+ockam_error_t ockam_xx_key_pool_init(ockam_xx_key_pool_t** pp_pool, ockam_xx_key_pool_attributes_t* p_attributes);
+
+/**
+ * @brief   Stop the pool's thread and free the pool. No key may use the pool afterwards.
+ */
+ockam_error_t ockam_xx_key_pool_deinit(ockam_xx_key_pool_t* p_pool);
+
+/**
+ * @brief   Read the pool's counters.
+ * @return  The error that stopped the pool's thread, if any.
+ */
+ockam_error_t ockam_xx_key_pool_stats(ockam_xx_key_pool_t* p_pool, ockam_xx_key_pool_stats_t* p_stats);
+
+/**
+ * @brief   Take the ephemeral keypairs of the key's handshakes from the pool, and the static ones unless the key has a
+ *          static key set, NULL to stop.
+ * @param   key   [in] - Key initialized with ockam_xx_key_initialize.
+ * @param   pool  [in] - Pool to use, or NULL.
+ */
+ockam_error_t ockam_xx_key_pool_set(ockam_key_t* key, ockam_xx_key_pool_t* pool);
+
 #endif
@@ -11,9 +11,13 @@
 
 extern ockam_memory_t* gp_ockam_key_memory;
 
-ockam_key_dispatch_table_t xx_key_dispatch = {
-  ockam_key_establish_initiator_xx, ockam_key_establish_responder_xx, xx_encrypt, xx_decrypt, xx_key_deinit
-};
+ockam_key_dispatch_table_t xx_key_dispatch = { ockam_key_establish_initiator_xx,
+                                               ockam_key_establish_responder_xx,
+                                               xx_encrypt,
+                                               xx_decrypt,
+                                               xx_key_deinit,
+                                               xx_encrypt_in_place,
+                                               xx_decrypt_in_place };
 
 ockam_error_t ockam_xx_key_initialize(ockam_key_t*    p_key,
                                       ockam_memory_t* p_memory,
@@ -24,7 +28,7 @@ ockam_error_t ockam_xx_key_initialize(ockam_key_t*    p_key,
   ockam_error_t   error    = OCKAM_ERROR_NONE;
   ockam_xx_key_t* p_xx_key = NULL;
 
-  if (!p_key || !p_vault || !p_reader || !p_writer || !p_memory) {
+  if (!p_key || !p_vault || !p_memory) {
     error = KEYAGREEMENT_ERROR_PARAMETER;
     goto exit;
   }
@@ -43,26 +47,159 @@ exit:
   if (error) {
     ockam_log_error("%x", error);
     if (p_key) {
-      if (p_key->context) ockam_memory_free(p_memory, p_key->context, 0);
+      if (p_key->context) ockam_memory_free(p_memory, p_key->context, sizeof(ockam_xx_key_t));
     }
   }
   return error;
 }
 
+ockam_error_t ockam_xx_key_rekey_interval_set(ockam_key_t* p_key, uint64_t message_count)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if (!p_key || !p_key->context) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  ((ockam_xx_key_t*) p_key->context)->rekey_interval = message_count;
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t
+ockam_xx_static_key_init(ockam_xx_static_key_t* p_static_key, ockam_vault_t* p_vault, ockam_vault_secret_t* p_secret)
+{
+  ockam_error_t error    = OCKAM_ERROR_NONE;
+  size_t        key_size = 0;
+
+  if (!p_static_key || !p_vault || !p_secret) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  if (OCKAM_VAULT_SECRET_TYPE_CURVE25519_PRIVATEKEY != p_secret->attributes.type) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  error = ockam_vault_secret_publickey_get(
+    p_vault, p_secret, p_static_key->public_key, sizeof(p_static_key->public_key), &key_size);
+  if (error) goto exit;
+
+  p_static_key->p_secret = p_secret;
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t ockam_xx_key_static_key_set(ockam_key_t* p_key, const ockam_xx_static_key_t* p_static_key)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if (!p_key || !p_key->context || (p_static_key && !p_static_key->p_secret)) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  ((ockam_xx_key_t*) p_key->context)->p_static = p_static_key;
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t ockam_xx_key_peer_static_key_get(ockam_key_t* p_key, uint8_t* p_public_key, size_t public_key_size)
+{
+  ockam_error_t   error    = OCKAM_ERROR_NONE;
+  ockam_xx_key_t* p_xx_key = NULL;
+
+  if (!p_key || !p_key->context || !p_public_key || (public_key_size < KEY_SIZE)) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  p_xx_key = (ockam_xx_key_t*) p_key->context;
+  if (!p_xx_key->peer_static_known) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  ockam_memory_copy(gp_ockam_key_memory, p_public_key, p_xx_key->peer_static, KEY_SIZE);
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t xx_rekey(ockam_xx_key_t* p_xx_key, ockam_vault_secret_t* p_secret)
+{
+  ockam_error_t                   error             = OCKAM_ERROR_NONE;
+  ockam_vault_secret_attributes_t secret_attributes = { KEY_SIZE,
+                                                        OCKAM_VAULT_SECRET_TYPE_AES256_KEY,
+                                                        OCKAM_VAULT_SECRET_PURPOSE_KEY_AGREEMENT,
+                                                        OCKAM_VAULT_SECRET_EPHEMERAL };
+  ockam_vault_secret_t            new_secret;
+  uint8_t                         key[KEY_SIZE + TAG_SIZE];
+  size_t                          key_length = 0;
+
+  ockam_memory_set(gp_ockam_key_memory, &new_secret, 0, sizeof(new_secret));
+  ockam_memory_set(gp_ockam_key_memory, key, 0, sizeof(key));
+
+  // k = first 32 bytes of ENCRYPT(k, 2^64-1, empty, 32 zero bytes)
+  error = ockam_vault_aead_aes_gcm_encrypt_in_place(
+    p_xx_key->p_vault, p_secret, XX_NONCE_REKEY, NULL, 0, key, KEY_SIZE, sizeof(key), &key_length);
+  if (error) goto exit;
+
+  error = ockam_vault_secret_import(p_xx_key->p_vault, &new_secret, &secret_attributes, key, KEY_SIZE);
+  if (error) goto exit;
+
+  error = ockam_vault_secret_destroy(p_xx_key->p_vault, p_secret);
+  if (error) goto exit;
+
+  ockam_memory_copy(gp_ockam_key_memory, p_secret, &new_secret, sizeof(new_secret));
+
+exit:
+  ockam_memory_set(gp_ockam_key_memory, key, 0, sizeof(key));
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t xx_nonce_advance(ockam_xx_key_t* p_xx_key, ockam_vault_secret_t* p_secret, uint64_t* p_nonce)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  *p_nonce += 1;
+  if (p_xx_key->rekey_interval && (0 == *p_nonce % p_xx_key->rekey_interval)) {
+    error = xx_rekey(p_xx_key, p_secret);
+    if (error) goto exit;
+  }
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
 ockam_error_t
 xx_encrypt(void* p_context, uint8_t* payload, size_t payload_size, uint8_t* msg, size_t msg_length, size_t* msg_size)
 {
-  ockam_error_t   error = OCKAM_ERROR_NONE;
-  uint8_t         cipher_text_and_tag[MAX_XX_TRANSMIT_SIZE];
-  size_t          ciphertext_and_tag_length;
-  ockam_xx_key_t* p_xx_key = (ockam_xx_key_t*) p_context;
+  ockam_error_t   error                     = OCKAM_ERROR_NONE;
+  size_t          ciphertext_and_tag_length = 0;
+  ockam_xx_key_t* p_xx_key                  = (ockam_xx_key_t*) p_context;
 
   if (msg_length < (payload_size + TAG_SIZE)) {
     error = TRANSPORT_ERROR_BUFFER_TOO_SMALL;
     goto exit;
   }
 
-  ockam_memory_set(gp_ockam_key_memory, cipher_text_and_tag, 0, sizeof(cipher_text_and_tag));
+  if (XX_NONCE_REKEY == p_xx_key->encrypt_nonce) {
+    error = KEYAGREEMENT_ERROR_NONCE;
+    goto exit;
+  }
+
   error = ockam_vault_aead_aes_gcm_encrypt(p_xx_key->p_vault,
                                            &p_xx_key->encrypt_secret,
                                            p_xx_key->encrypt_nonce,
@@ -70,12 +207,12 @@ xx_encrypt(void* p_context, uint8_t* payload, size_t payload_size, uint8_t* msg,
                                            0,
                                            payload,
                                            payload_size,
-                                           cipher_text_and_tag,
-                                           sizeof(cipher_text_and_tag),
+                                           msg,
+                                           msg_length,
                                            &ciphertext_and_tag_length);
-  ;
-  ockam_memory_copy(gp_ockam_key_memory, msg, cipher_text_and_tag, ciphertext_and_tag_length);
-  p_xx_key->encrypt_nonce += 1;
+  if (error) goto exit;
+  error = xx_nonce_advance(p_xx_key, &p_xx_key->encrypt_secret, &p_xx_key->encrypt_nonce);
+  if (error) goto exit;
   *msg_size = ciphertext_and_tag_length;
 
 exit:
@@ -90,27 +227,90 @@ ockam_error_t xx_decrypt(void*    p_context,
                          size_t   cipher_text_length,
                          size_t*  payload_length)
 {
-  ockam_error_t   error = OCKAM_ERROR_NONE;
-  uint8_t         clear_text[MAX_XX_TRANSMIT_SIZE];
+  ockam_error_t   error             = OCKAM_ERROR_NONE;
   size_t          clear_text_length = 0;
   ockam_xx_key_t* p_xx_key          = (ockam_xx_key_t*) p_context;
 
-  ockam_memory_set(gp_ockam_key_memory, clear_text, 0, sizeof(clear_text));
+  if (XX_NONCE_REKEY == p_xx_key->decrypt_nonce) {
+    error = KEYAGREEMENT_ERROR_NONCE;
+    goto exit;
+  }
 
-  error           = ockam_vault_aead_aes_gcm_decrypt(p_xx_key->p_vault,
+  error = ockam_vault_aead_aes_gcm_decrypt(p_xx_key->p_vault,
                                            &p_xx_key->decrypt_secret,
                                            p_xx_key->decrypt_nonce,
                                            NULL,
                                            0,
                                            cipher_text,
                                            cipher_text_length,
-                                           clear_text,
-                                           sizeof(clear_text),
+                                           payload,
+                                           payload_size,
                                            &clear_text_length);
+  if (error) goto exit;
+  error = xx_nonce_advance(p_xx_key, &p_xx_key->decrypt_secret, &p_xx_key->decrypt_nonce);
+  if (error) goto exit;
   *payload_length = clear_text_length;
 
-  ockam_memory_copy(gp_ockam_key_memory, payload, clear_text, clear_text_length);
-  p_xx_key->decrypt_nonce += 1;
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t
+xx_encrypt_in_place(void* p_context, uint8_t* buffer, size_t payload_length, size_t buffer_size, size_t* msg_length)
+{
+  ockam_error_t   error    = OCKAM_ERROR_NONE;
+  ockam_xx_key_t* p_xx_key = (ockam_xx_key_t*) p_context;
+
+  if (buffer_size < (payload_length + TAG_SIZE)) {
+    error = TRANSPORT_ERROR_BUFFER_TOO_SMALL;
+    goto exit;
+  }
+
+  if (XX_NONCE_REKEY == p_xx_key->encrypt_nonce) {
+    error = KEYAGREEMENT_ERROR_NONCE;
+    goto exit;
+  }
+
+  error = ockam_vault_aead_aes_gcm_encrypt_in_place(p_xx_key->p_vault,
+                                                    &p_xx_key->encrypt_secret,
+                                                    p_xx_key->encrypt_nonce,
+                                                    NULL,
+                                                    0,
+                                                    buffer,
+                                                    payload_length,
+                                                    buffer_size,
+                                                    msg_length);
+  if (error) goto exit;
+  error = xx_nonce_advance(p_xx_key, &p_xx_key->encrypt_secret, &p_xx_key->encrypt_nonce);
+  if (error) goto exit;
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t xx_decrypt_in_place(void* p_context, uint8_t* buffer, size_t msg_length, size_t* payload_length)
+{
+  ockam_error_t   error    = OCKAM_ERROR_NONE;
+  ockam_xx_key_t* p_xx_key = (ockam_xx_key_t*) p_context;
+
+  if (XX_NONCE_REKEY == p_xx_key->decrypt_nonce) {
+    error = KEYAGREEMENT_ERROR_NONCE;
+    goto exit;
+  }
+
+  error = ockam_vault_aead_aes_gcm_decrypt_in_place(p_xx_key->p_vault,
+                                                    &p_xx_key->decrypt_secret,
+                                                    p_xx_key->decrypt_nonce,
+                                                    NULL,
+                                                    0,
+                                                    buffer,
+                                                    msg_length,
+                                                    payload_length);
+  if (error) goto exit;
+  error = xx_nonce_advance(p_xx_key, &p_xx_key->decrypt_secret, &p_xx_key->decrypt_nonce);
+  if (error) goto exit;
 
 exit:
   if (error) ockam_log_error("%x", error);
@@ -123,16 +323,34 @@ ockam_error_t xx_key_deinit(void* p_context)
   ockam_error_t   return_error = OCKAM_ERROR_NONE;
   ockam_xx_key_t* p_xx_key     = (ockam_xx_key_t*) p_context;
 
-  error = ockam_vault_secret_destroy(p_xx_key->p_vault, &p_xx_key->encrypt_secret);
+  error = xx_handshake_end(p_xx_key);
   if (error) return_error = error;
-  error = ockam_vault_secret_destroy(p_xx_key->p_vault, &p_xx_key->decrypt_secret);
-  if (error) return_error = error;
-  ockam_memory_free(gp_ockam_key_memory, p_xx_key, 0);
+  // A key whose handshake never completed has no secrets
+  if (p_xx_key->encrypt_secret.context) {
+    error = ockam_vault_secret_destroy(p_xx_key->p_vault, &p_xx_key->encrypt_secret);
+    if (error) return_error = error;
+  }
+  if (p_xx_key->decrypt_secret.context) {
+    error = ockam_vault_secret_destroy(p_xx_key->p_vault, &p_xx_key->decrypt_secret);
+    if (error) return_error = error;
+  }
+  if (p_xx_key->resumption_secret.context) {
+    error = ockam_vault_secret_destroy(p_xx_key->p_vault, &p_xx_key->resumption_secret);
+    if (error) return_error = error;
+  }
+  ockam_memory_free(gp_ockam_key_memory, p_xx_key, sizeof(ockam_xx_key_t));
 exit:
   return return_error;
 }
 
-ockam_error_t key_agreement_prologue_xx(key_establishment_xx* xx)
+const uint8_t xx_initial_h[SHA256_SIZE] = { 0x5d, 0xf7, 0x2b, 0x67, 0xb9, 0x65, 0xad, 0xd1, 0x16, 0x8f, 0x0a,
+                                             0x6c, 0x75, 0x6d, 0xf2, 0x1c, 0x20, 0x4f, 0x7e, 0x64, 0xfc, 0x68,
+                                             0x2b, 0xe6, 0xa3, 0xab, 0x4b, 0x68, 0x2c, 0x8d, 0xb6, 0x4b };
+
+/*
+ * Set up a Curve25519 keypair for the handshake, from the pool when it has one.
+ */
+ockam_error_t xx_keypair_make(key_establishment_xx* xx, ockam_vault_secret_t* p_secret, uint8_t* p_public_key)
 {
   ockam_error_t                   error             = OCKAM_ERROR_NONE;
   ockam_vault_secret_attributes_t secret_attributes = { KEY_SIZE,
@@ -140,23 +358,45 @@ ockam_error_t key_agreement_prologue_xx(key_establishment_xx* xx)
                                                         OCKAM_VAULT_SECRET_PURPOSE_KEY_AGREEMENT,
                                                         OCKAM_VAULT_SECRET_EPHEMERAL };
   size_t                          key_size          = 0;
-  uint8_t                         ck[KEY_SIZE];
+  int                             taken             = 0;
+
+  if (xx->p_pool) {
+    error = xx_key_pool_take(xx->p_pool, xx->vault, p_secret, p_public_key, &taken);
+    if (error || taken) goto exit;
+  }
 
-  // 1. Generate a static 25519 keypair for this handshake and set it to s
-  error = ockam_vault_secret_generate(xx->vault, &xx->s_secret, &secret_attributes);
+  error = ockam_vault_secret_generate(xx->vault, p_secret, &secret_attributes);
   if (error) goto exit;
 
-  error = ockam_vault_secret_publickey_get(xx->vault, &xx->s_secret, xx->s, sizeof(xx->s), &key_size);
-  if (error) {
-    ockam_log_error("key_agreement_prologue_xx: %x", error);
-    goto exit;
+  error = ockam_vault_secret_publickey_get(xx->vault, p_secret, p_public_key, KEY_SIZE, &key_size);
+  if (error) goto exit;
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t key_agreement_prologue_xx(key_establishment_xx* xx)
+{
+  ockam_error_t                   error             = OCKAM_ERROR_NONE;
+  ockam_vault_secret_attributes_t secret_attributes = { KEY_SIZE,
+                                                        OCKAM_VAULT_SECRET_TYPE_BUFFER,
+                                                        OCKAM_VAULT_SECRET_PURPOSE_KEY_AGREEMENT,
+                                                        OCKAM_VAULT_SECRET_EPHEMERAL };
+  uint8_t                         ck[KEY_SIZE];
+
+  // 1. Use the long-term static 25519 keypair, or generate one for this handshake, and set it to s
+  if (xx->p_static) {
+    // Shares the vault's secret; the handshake only reads it and does not destroy it
+    ockam_memory_copy(gp_ockam_key_memory, &xx->s_secret, xx->p_static->p_secret, sizeof(xx->s_secret));
+    ockam_memory_copy(gp_ockam_key_memory, xx->s, xx->p_static->public_key, KEY_SIZE);
+  } else {
+    error = xx_keypair_make(xx, &xx->s_secret, xx->s);
+    if (error) goto exit;
   }
 
   // 2. Generate an ephemeral 25519 keypair for this handshake and set it to e
-  error = ockam_vault_secret_generate(xx->vault, &xx->e_secret, &secret_attributes);
-  if (error) goto exit;
-
-  error = ockam_vault_secret_publickey_get(xx->vault, &xx->e_secret, xx->e, sizeof(xx->e), &key_size);
+  error = xx_keypair_make(xx, &xx->e_secret, xx->e);
   if (error) goto exit;
 
   // 3. Set k to empty, Set n to 0
@@ -164,17 +404,14 @@ ockam_error_t key_agreement_prologue_xx(key_establishment_xx* xx)
   ockam_memory_set(gp_ockam_key_memory, xx->k, 0, KEY_SIZE);
 
   // 4. Set h and ck to 'Noise_XX_25519_AESGCM_SHA256'
-  ockam_memory_set(gp_ockam_key_memory, xx->h, 0, SHA256_SIZE);
-  ockam_memory_copy(gp_ockam_key_memory, xx->h, PROTOCOL_NAME, PROTOCOL_NAME_SIZE);
   ockam_memory_set(gp_ockam_key_memory, ck, 0, KEY_SIZE);
   ockam_memory_copy(gp_ockam_key_memory, ck, PROTOCOL_NAME, PROTOCOL_NAME_SIZE);
-  secret_attributes.type = OCKAM_VAULT_SECRET_TYPE_BUFFER;
-  error                  = ockam_vault_secret_import(xx->vault, &xx->ck_secret, &secret_attributes, ck, KEY_SIZE);
+  error = ockam_vault_secret_import(xx->vault, &xx->ck_secret, &secret_attributes, ck, KEY_SIZE);
   if (error) goto exit;
 
   // 5. h = SHA256(h || prologue),
-  // prologue is empty
-  mix_hash(xx, NULL, 0);
+  // prologue is empty, so h is the same for every handshake
+  ockam_memory_copy(gp_ockam_key_memory, xx->h, xx_initial_h, SHA256_SIZE);
 
 exit:
   if (error) ockam_log_error("%x", error);
@@ -240,23 +477,45 @@ void string_to_hex(uint8_t* hexstring, uint8_t* val, size_t* p_bytes)
   if (NULL != p_bytes) *p_bytes = bytes;
 }
 
-void mix_hash(key_establishment_xx* xx, uint8_t* p_bytes, uint16_t b_length)
+/*
+ * h = SHA256(h || bytes), for vaults that can only hash one contiguous buffer.
+ */
+static ockam_error_t mix_hash_concatenated(key_establishment_xx* xx, uint8_t* p_bytes, uint16_t b_length)
 {
   ockam_error_t error;
-  uint8_t*      p_h = &xx->h[0];
   uint8_t       string[MAX_XX_TRANSMIT_SIZE];
-  uint8_t       hash[SHA256_SIZE];
   size_t        hash_length = 0;
 
-  ockam_memory_set(gp_ockam_key_memory, &hash[0], 0, sizeof(hash));
-  ockam_memory_set(gp_ockam_key_memory, &string[0], 0, sizeof(string));
-  ockam_memory_copy(gp_ockam_key_memory, &string[0], &p_h[0], SHA256_SIZE);
+  ockam_memory_copy(gp_ockam_key_memory, &string[0], &xx->h[0], SHA256_SIZE);
   ockam_memory_copy(gp_ockam_key_memory, &string[SHA256_SIZE], p_bytes, b_length);
-  error = ockam_vault_sha256(xx->vault, string, SHA256_SIZE + b_length, hash, SHA256_SIZE, &hash_length);
+  error = ockam_vault_sha256(xx->vault, string, SHA256_SIZE + b_length, xx->h, SHA256_SIZE, &hash_length);
+  return error;
+}
+
+void mix_hash(key_establishment_xx* xx, uint8_t* p_bytes, uint16_t b_length)
+{
+  ockam_error_t            error;
+  ockam_vault_sha256_ctx_t sha256 = { 0 };
+  uint8_t                  hash[SHA256_SIZE];
+  size_t                   hash_length = 0;
+
+  error = ockam_vault_sha256_init(xx->vault, &sha256);
+  if (error == OCKAM_VAULT_ERROR_NOT_SUPPORTED) {
+    error = mix_hash_concatenated(xx, p_bytes, b_length);
+    goto exit;
+  }
+  if (error) goto exit;
+
+  error = ockam_vault_sha256_update(xx->vault, &sha256, xx->h, SHA256_SIZE);
+  if (error) goto exit;
+  error = ockam_vault_sha256_update(xx->vault, &sha256, p_bytes, b_length);
+  if (error) goto exit;
+  error = ockam_vault_sha256_final(xx->vault, &sha256, hash, sizeof(hash), &hash_length);
   if (error) goto exit;
-  ockam_memory_copy(gp_ockam_key_memory, p_h, hash, hash_length);
+  ockam_memory_copy(gp_ockam_key_memory, xx->h, hash, hash_length);
 
 exit:
+  if (sha256.context) ockam_vault_sha256_final(xx->vault, &sha256, NULL, 0, NULL);
   if (error) ockam_log_error("%x", error);
   return;
 }
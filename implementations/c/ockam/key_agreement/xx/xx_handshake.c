@@ -0,0 +1,264 @@
+#include "ockam/error.h"
+#include "ockam/io.h"
+#include "ockam/key_agreement.h"
+#include "ockam/key_agreement/impl.h"
+#include "ockam/key_agreement/xx.h"
+#include "ockam/log.h"
+#include "ockam/memory.h"
+#include "ockam/vault.h"
+#include "xx_local.h"
+
+extern ockam_memory_t* gp_ockam_key_memory;
+
+ockam_error_t xx_handshake_start(ockam_xx_key_t* p_xx_key, int initiator)
+{
+  ockam_error_t         error = OCKAM_ERROR_NONE;
+  key_establishment_xx* xx    = NULL;
+
+  // The epilogue would overwrite the secrets of a key already established, by a handshake or by resuming a session
+  if (p_xx_key->p_handshake || p_xx_key->encrypt_secret.context || p_xx_key->decrypt_secret.context ||
+      p_xx_key->resumption_secret.context) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  error = ockam_memory_alloc_zeroed(gp_ockam_key_memory, (void**) &xx, sizeof(key_establishment_xx));
+  if (error) goto exit;
+
+  xx->state             = initiator ? XX_HANDSHAKE_INITIATOR_M1 : XX_HANDSHAKE_RESPONDER_M1;
+  xx->vault             = p_xx_key->p_vault;
+  xx->p_pool            = p_xx_key->p_pool;
+  xx->p_static          = p_xx_key->p_static;
+  p_xx_key->p_handshake = xx;
+
+  /* Initialize handshake struct and generate initial static & ephemeral keys */
+  error = key_agreement_prologue_xx(xx);
+  if (error) goto exit;
+
+exit:
+  if (error) {
+    ockam_log_error("%x", error);
+    if (xx) xx_handshake_end(p_xx_key);
+  }
+  return error;
+}
+
+ockam_error_t xx_handshake_step(ockam_xx_key_t*              p_xx_key,
+                                const uint8_t*               p_input,
+                                size_t                       input_length,
+                                uint8_t*                     p_output,
+                                size_t                       output_size,
+                                size_t*                      p_output_length,
+                                ockam_xx_handshake_status_t* p_status)
+{
+  ockam_error_t         error = OCKAM_ERROR_NONE;
+  key_establishment_xx* xx    = p_xx_key->p_handshake;
+
+  if (!xx || !p_output || (output_size < OCKAM_XX_HANDSHAKE_MESSAGE_MAX_SIZE) || !p_output_length || !p_status) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  *p_output_length = 0;
+  *p_status        = OCKAM_XX_HANDSHAKE_WANT_INPUT;
+
+  // Each message has a fixed size as the payloads are empty
+  switch (xx->state) {
+  case XX_HANDSHAKE_INITIATOR_M1:
+    if (input_length) {
+      error = KEYAGREEMENT_ERROR_FAIL;
+      goto exit;
+    }
+
+    error = xx_initiator_m1_make(xx, p_output, output_size, p_output_length);
+    if (error) goto exit;
+
+    xx->state = XX_HANDSHAKE_INITIATOR_M2;
+    break;
+
+  case XX_HANDSHAKE_INITIATOR_M2:
+    if (!p_input || (XX_M2_SIZE != input_length)) {
+      error = KEYAGREEMENT_ERROR_FAIL;
+      goto exit;
+    }
+
+    error = xx_initiator_m2_process(xx, (uint8_t*) p_input, input_length);
+    if (error) goto exit;
+
+    error = xx_initiator_m3_make(xx, p_output, p_output_length);
+    if (error) goto exit;
+
+    error = xx_initiator_epilogue(xx, p_xx_key);
+    if (error) goto exit;
+
+    *p_status = OCKAM_XX_HANDSHAKE_DONE;
+    break;
+
+  case XX_HANDSHAKE_RESPONDER_M1:
+    if (!p_input || (XX_M1_SIZE != input_length)) {
+      error = KEYAGREEMENT_ERROR_FAIL;
+      goto exit;
+    }
+
+    error = xx_responder_m1_process(xx, (uint8_t*) p_input, input_length);
+    if (error) goto exit;
+
+    error = xx_responder_m2_make(xx, p_output, output_size, p_output_length);
+    if (error) goto exit;
+
+    xx->state = XX_HANDSHAKE_RESPONDER_M3;
+    break;
+
+  case XX_HANDSHAKE_RESPONDER_M3:
+    if (!p_input || (XX_M3_SIZE != input_length)) {
+      error = KEYAGREEMENT_ERROR_FAIL;
+      goto exit;
+    }
+
+    error = xx_responder_m3_process(xx, (uint8_t*) p_input, input_length);
+    if (error) goto exit;
+
+    error = xx_responder_epilogue(xx, p_xx_key);
+    if (error) goto exit;
+
+    *p_status = OCKAM_XX_HANDSHAKE_DONE;
+    break;
+  }
+
+  if (OCKAM_XX_HANDSHAKE_DONE == *p_status) {
+    ockam_memory_copy(gp_ockam_key_memory, p_xx_key->peer_static, xx->rs, KEY_SIZE);
+    p_xx_key->peer_static_known = 1;
+    error                       = xx_handshake_end(p_xx_key);
+  }
+
+exit:
+  if (error) {
+    ockam_log_error("%x", error);
+    if (xx) xx_handshake_end(p_xx_key);
+  }
+  return error;
+}
+
+/*
+ * Release the handshake's secrets and state, whether it completed or not.
+ */
+ockam_error_t xx_handshake_end(ockam_xx_key_t* p_xx_key)
+{
+  ockam_error_t         error        = OCKAM_ERROR_NONE;
+  ockam_error_t         return_error = OCKAM_ERROR_NONE;
+  key_establishment_xx* xx           = p_xx_key->p_handshake;
+
+  if (!xx) goto exit;
+
+  if (!xx->p_static && xx->s_secret.context) {
+    error = ockam_vault_secret_destroy(xx->vault, &xx->s_secret);
+    if (error) return_error = error;
+  }
+  if (xx->e_secret.context) {
+    error = ockam_vault_secret_destroy(xx->vault, &xx->e_secret);
+    if (error) return_error = error;
+  }
+  if (xx->k_secret.context) {
+    error = ockam_vault_secret_destroy(xx->vault, &xx->k_secret);
+    if (error) return_error = error;
+  }
+  if (xx->ck_secret.context) {
+    error = ockam_vault_secret_destroy(xx->vault, &xx->ck_secret);
+    if (error) return_error = error;
+  }
+
+  ockam_memory_set(gp_ockam_key_memory, xx, 0, sizeof(key_establishment_xx));
+  ockam_memory_free(gp_ockam_key_memory, xx, sizeof(key_establishment_xx));
+  p_xx_key->p_handshake = NULL;
+
+exit:
+  if (return_error) ockam_log_error("%x", return_error);
+  return return_error;
+}
+
+/*
+ * The blocking handshake: step through the messages, exchanging them over the key's reader and writer.
+ */
+ockam_error_t xx_handshake_run(ockam_xx_key_t* p_xx_key, int initiator)
+{
+  ockam_error_t               error = OCKAM_ERROR_NONE;
+  uint8_t                     input[MAX_XX_TRANSMIT_SIZE];
+  uint8_t                     output[MAX_XX_TRANSMIT_SIZE];
+  size_t                      input_length  = 0;
+  size_t                      output_length = 0;
+  ockam_xx_handshake_status_t status        = OCKAM_XX_HANDSHAKE_WANT_INPUT;
+
+  if (!p_xx_key->p_reader || !p_xx_key->p_writer) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  error = xx_handshake_start(p_xx_key, initiator);
+  if (error) goto exit;
+
+  if (!initiator) {
+    error = ockam_read(p_xx_key->p_reader, input, sizeof(input), &input_length);
+    if (error) goto exit;
+  }
+
+  while (OCKAM_XX_HANDSHAKE_WANT_INPUT == status) {
+    error = xx_handshake_step(p_xx_key, input, input_length, output, sizeof(output), &output_length, &status);
+    if (error) goto exit;
+
+    if (output_length) {
+      error = ockam_write(p_xx_key->p_writer, output, output_length);
+      if (error) goto exit;
+    }
+
+    if (OCKAM_XX_HANDSHAKE_WANT_INPUT == status) {
+      error = ockam_read(p_xx_key->p_reader, input, sizeof(input), &input_length);
+      if (error) goto exit;
+    }
+  }
+
+exit:
+  if (error) {
+    ockam_log_error("%x", error);
+    xx_handshake_end(p_xx_key);
+  }
+  return error;
+}
+
+ockam_error_t ockam_xx_key_handshake_start(ockam_key_t* p_key, int initiator)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if (!p_key || !p_key->context) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  error = xx_handshake_start((ockam_xx_key_t*) p_key->context, initiator);
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t ockam_xx_key_handshake_step(ockam_key_t*                 p_key,
+                                          const uint8_t*               p_input,
+                                          size_t                       input_length,
+                                          uint8_t*                     p_output,
+                                          size_t                       output_size,
+                                          size_t*                      p_output_length,
+                                          ockam_xx_handshake_status_t* p_status)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if (!p_key || !p_key->context) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  error = xx_handshake_step(
+    (ockam_xx_key_t*) p_key->context, p_input, input_length, p_output, output_size, p_output_length, p_status);
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
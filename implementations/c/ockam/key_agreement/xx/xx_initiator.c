@@ -10,57 +10,10 @@
 #include "ockam/codec.h"
 
 extern ockam_memory_t* gp_ockam_key_memory;
-uint8_t                clear_text[MAX_XX_TRANSMIT_SIZE];
 
 ockam_error_t ockam_key_establish_initiator_xx(void* p_context)
 {
-  ockam_error_t        error        = OCKAM_ERROR_NONE;
-  ockam_error_t        return_error = OCKAM_ERROR_NONE;
-  uint8_t              message[MAX_XX_TRANSMIT_SIZE];
-  size_t               message_length = 0;
-  key_establishment_xx xx;
-  ockam_xx_key_t*      p_xx_key = (ockam_xx_key_t*) p_context;
-
-  ockam_memory_set(gp_ockam_key_memory, &xx, 0, sizeof(xx));
-  xx.vault = p_xx_key->p_vault;
-
-  /* Initialize handshake struct and generate initial static & ephemeral keys */
-  error = key_agreement_prologue_xx(&xx);
-  if (error) goto exit;
-
-  error = xx_initiator_m1_make(&xx, message, sizeof(message), &message_length);
-  if (error) goto exit;
-
-  error = ockam_write(p_xx_key->p_writer, message, message_length);
-  if (error) goto exit;
-
-  error = ockam_read(p_xx_key->p_reader, message, sizeof(message), &message_length);
-  if (error) goto exit;
-
-  error = xx_initiator_m2_process(&xx, message, message_length);
-  if (error) goto exit;
-
-  error = xx_initiator_m3_make(&xx, message, &message_length);
-  if (error) goto exit;
-
-  error = ockam_write(p_xx_key->p_writer, message, message_length);
-  if (error) goto exit;
-
-  error = xx_initiator_epilogue(&xx, p_xx_key);
-  if (error) goto exit;
-
-exit:
-  if (error) ockam_log_error("%x", error);
-  error = ockam_vault_secret_destroy(xx.vault, &xx.s_secret);
-  if (error) return_error = error;
-  error = ockam_vault_secret_destroy(xx.vault, &xx.e_secret);
-  if (error) return_error = error;
-  error = ockam_vault_secret_destroy(xx.vault, &xx.k_secret);
-  if (error) return_error = error;
-  error = ockam_vault_secret_destroy(xx.vault, &xx.ck_secret);
-  if (error) return_error = error;
-
-  return return_error;
+  return xx_handshake_run((ockam_xx_key_t*) p_context, 1);
 }
 
 /*------------------------------------------------------------------------------------------------------*
@@ -93,6 +46,7 @@ ockam_error_t xx_initiator_m2_process(key_establishment_xx* xx, uint8_t* p_recv,
 {
   ockam_error_t error             = OCKAM_ERROR_NONE;
   uint16_t      offset            = 0;
+  uint8_t       clear_text[MAX_XX_TRANSMIT_SIZE];
   size_t        clear_text_length = 0;
 
   // 1. Read 32 bytes from the incoming
@@ -235,14 +189,16 @@ exit:
 ockam_error_t xx_initiator_epilogue(key_establishment_xx* xx, ockam_xx_key_t* p_key)
 {
   ockam_error_t        error = OCKAM_ERROR_NONE;
-  ockam_vault_secret_t secrets[2];
+  ockam_vault_secret_t secrets[3];
 
+  // The third output is not part of Noise; it only seeds session resumption
   ockam_memory_set(gp_ockam_key_memory, secrets, 0, sizeof(secrets));
-  error = ockam_vault_hkdf_sha256(xx->vault, &xx->ck_secret, NULL, 2, secrets);
+  error = ockam_vault_hkdf_sha256(xx->vault, &xx->ck_secret, NULL, 3, secrets);
   if (error) goto exit;
 
   ockam_memory_copy(gp_ockam_key_memory, &p_key->decrypt_secret, &secrets[0], sizeof(secrets[0]));
   ockam_memory_copy(gp_ockam_key_memory, &p_key->encrypt_secret, &secrets[1], sizeof(secrets[1]));
+  ockam_memory_copy(gp_ockam_key_memory, &p_key->resumption_secret, &secrets[2], sizeof(secrets[2]));
 
   error = ockam_vault_secret_type_set(xx->vault, &p_key->decrypt_secret, OCKAM_VAULT_SECRET_TYPE_AES256_KEY);
   if (error) goto exit;
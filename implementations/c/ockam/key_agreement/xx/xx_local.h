@@ -8,43 +8,70 @@
 #include "ockam/vault.h"
 #include "ockam/key_agreement/impl.h"
 #include "ockam/key_agreement.h"
+#include "ockam/key_agreement/xx.h"
 
 #define PROTOCOL_NAME        "Noise_XX_25519_AESGCM_SHA256"
 #define PROTOCOL_NAME_SIZE   28
 #define MAX_XX_TRANSMIT_SIZE 1028
 #define TAG_SIZE             16
 #define VECTOR_SIZE          12
+#define XX_M1_SIZE           KEY_SIZE
+#define XX_M2_SIZE           (KEY_SIZE + KEY_SIZE + TAG_SIZE + TAG_SIZE)
+#define XX_M3_SIZE           (KEY_SIZE + TAG_SIZE + TAG_SIZE)
+#define XX_NONCE_REKEY       UINT64_MAX /* Reserved by Noise for REKEY, never used for a message */
 
 #define DEFAULT_IP_ADDRESS "127.0.0.1"
 #define DEFAULT_LISTEN_PORT 4000
 
+typedef struct key_establishment_xx key_establishment_xx;
+
 struct ockam_xx_key {
-  ockam_vault_secret_t encrypt_secret;
-  ockam_vault_secret_t decrypt_secret;
-  uint16_t             encrypt_nonce;
-  uint16_t             decrypt_nonce;
-  ockam_vault_t*       p_vault;
-  ockam_reader_t*      p_reader;
-  ockam_writer_t*      p_writer;
+  ockam_vault_secret_t         encrypt_secret;
+  ockam_vault_secret_t         decrypt_secret;
+  ockam_vault_secret_t         resumption_secret; /* Seed for ockam_xx_key_resume, no context once taken */
+  uint64_t                     encrypt_nonce;
+  uint64_t                     decrypt_nonce;
+  uint64_t                     rekey_interval;    /* Messages per key in each direction, 0 never rekeys */
+  ockam_xx_key_pool_t*         p_pool;            /* Source of handshake keypairs, NULL to generate them inline */
+  const ockam_xx_static_key_t* p_static;          /* Long-term static key, NULL for one per handshake */
+  uint8_t                      peer_static[KEY_SIZE];
+  int                          peer_static_known; /* peer_static is the peer's key from the last completed handshake */
+  ockam_vault_t*               p_vault;
+  ockam_reader_t*              p_reader;
+  ockam_writer_t*              p_writer;
+  key_establishment_xx*        p_handshake;       /* Step-wise handshake in progress, NULL when none */
 };
 
 typedef struct ockam_xx_key ockam_xx_key_t;
 
-typedef struct {
-  uint16_t             nonce;
-  uint8_t              s[KEY_SIZE];
-  ockam_vault_secret_t s_secret;
-  uint8_t              rs[KEY_SIZE];
-  uint8_t              e[KEY_SIZE];
-  ockam_vault_secret_t e_secret;
-  uint8_t              re[KEY_SIZE];
-  uint8_t              k[KEY_SIZE];
-  ockam_vault_secret_t k_secret;
-  uint8_t              ck[KEY_SIZE];
-  ockam_vault_secret_t ck_secret;
-  uint8_t              h[SHA256_SIZE];
-  ockam_vault_t*       vault;
-} key_establishment_xx;
+typedef enum {
+  XX_HANDSHAKE_INITIATOR_M1 = 1, /* Initiator, next step makes M1 */
+  XX_HANDSHAKE_INITIATOR_M2,     /* Initiator, next step processes M2 and makes M3 */
+  XX_HANDSHAKE_RESPONDER_M1,     /* Responder, next step processes M1 and makes M2 */
+  XX_HANDSHAKE_RESPONDER_M3,     /* Responder, next step processes M3 */
+} xx_handshake_state_t;
+
+struct key_establishment_xx {
+  xx_handshake_state_t         state;
+  uint64_t                     nonce;
+  uint8_t                      s[KEY_SIZE];
+  ockam_vault_secret_t         s_secret;
+  uint8_t                      rs[KEY_SIZE];
+  uint8_t                      e[KEY_SIZE];
+  ockam_vault_secret_t         e_secret;
+  uint8_t                      re[KEY_SIZE];
+  uint8_t                      k[KEY_SIZE];
+  ockam_vault_secret_t         k_secret;
+  uint8_t                      ck[KEY_SIZE];
+  ockam_vault_secret_t         ck_secret;
+  uint8_t                      h[SHA256_SIZE];
+  ockam_vault_t*               vault;
+  ockam_xx_key_pool_t*         p_pool;
+  const ockam_xx_static_key_t* p_static; /* When set, s_secret is the static key's and must not be destroyed */
+};
+
+/* h after the prologue: SHA256 of the protocol name padded to 32 bytes, as the prologue is empty */
+extern const uint8_t xx_initial_h[SHA256_SIZE];
 
 void print_uint8_str(uint8_t* p, uint16_t size, char* msg);
 void string_to_hex(uint8_t* hexstring, uint8_t* val, size_t* p_bytes);
@@ -54,6 +81,21 @@ ockam_error_t ockam_key_establish_initiator_xx(void* p_context);
 ockam_error_t ockam_key_establish_responder_xx(void* p_context);
 
 ockam_error_t key_agreement_prologue_xx(key_establishment_xx* xx);
+ockam_error_t xx_handshake_start(ockam_xx_key_t* p_xx_key, int initiator);
+ockam_error_t xx_handshake_step(ockam_xx_key_t*              p_xx_key,
+                                const uint8_t*               p_input,
+                                size_t                       input_length,
+                                uint8_t*                     p_output,
+                                size_t                       output_size,
+                                size_t*                      p_output_length,
+                                ockam_xx_handshake_status_t* p_status);
+ockam_error_t xx_handshake_end(ockam_xx_key_t* p_xx_key);
+ockam_error_t xx_handshake_run(ockam_xx_key_t* p_xx_key, int initiator);
+ockam_error_t xx_key_pool_take(ockam_xx_key_pool_t*  p_pool,
+                               ockam_vault_t*        p_vault,
+                               ockam_vault_secret_t* p_secret,
+                               uint8_t*              p_public_key,
+                               int*                  p_taken);
 
 ockam_error_t xx_responder_m1_process(key_establishment_xx* p_h, uint8_t* p_m1, size_t m1_size);
 ockam_error_t xx_responder_m2_make(key_establishment_xx* p_h, uint8_t* p_msg, size_t msg_size, size_t* p_bytesWritten);
@@ -68,7 +110,11 @@ ockam_error_t
               xx_encrypt(void* p_context, uint8_t* payload, size_t payload_size, uint8_t* msg, size_t msg_length, size_t* msg_size);
 ockam_error_t xx_decrypt(
   void* p_context, uint8_t* payload, size_t payload_size, uint8_t* msg, size_t msg_length, size_t* payload_bytes);
+ockam_error_t xx_encrypt_in_place(
+  void* p_context, uint8_t* buffer, size_t payload_length, size_t buffer_size, size_t* msg_length);
+ockam_error_t xx_decrypt_in_place(void* p_context, uint8_t* buffer, size_t msg_length, size_t* payload_length);
 ockam_error_t xx_key_deinit(void* p_context);
+ockam_error_t xx_nonce_advance(ockam_xx_key_t* p_xx_key, ockam_vault_secret_t* p_secret, uint64_t* p_nonce);
 ockam_error_t make_vector(uint64_t nonce, uint8_t* p_vector);
 ockam_error_t hkdf_dh(key_establishment_xx* xx,
                       ockam_vault_secret_t* salt,
@@ -0,0 +1,260 @@
+#include <pthread.h>
+#include <string.h>
+
+#include "ockam/error.h"
+#include "ockam/key_agreement.h"
+#include "ockam/key_agreement/impl.h"
+#include "ockam/key_agreement/xx.h"
+#include "ockam/log.h"
+#include "ockam/memory.h"
+#include "ockam/vault.h"
+#include "xx_local.h"
+
+/*
+ * Keypairs are kept as raw bytes so they can move from the pool's vault to the vault running the handshake: importing
+ * a private key does not compute its public key, so a handshake using a pooled keypair does no scalar
+ * multiplication of its own beyond the DH operations.
+ */
+typedef struct {
+  uint8_t private_key[KEY_SIZE];
+  uint8_t public_key[KEY_SIZE];
+} xx_keypair_t;
+
+struct ockam_xx_key_pool {
+  ockam_memory_t* p_memory;
+  ockam_vault_t*  p_vault;
+  pthread_mutex_t lock;
+  pthread_cond_t  changed;
+  pthread_t       thread;
+  size_t          size;
+  size_t          head;
+  size_t          count;
+  int             stop;
+  ockam_error_t   error;
+  uint64_t        taken;
+  uint64_t        missed;
+  xx_keypair_t*   keypairs;
+};
+
+ockam_error_t xx_key_pool_generate(ockam_xx_key_pool_t* p_pool, xx_keypair_t* p_keypair)
+{
+  ockam_error_t                   error             = OCKAM_ERROR_NONE;
+  ockam_vault_secret_attributes_t secret_attributes = { KEY_SIZE,
+                                                        OCKAM_VAULT_SECRET_TYPE_CURVE25519_PRIVATEKEY,
+                                                        OCKAM_VAULT_SECRET_PURPOSE_KEY_AGREEMENT,
+                                                        OCKAM_VAULT_SECRET_EPHEMERAL };
+  ockam_vault_secret_t            secret;
+  size_t                          key_size = 0;
+
+  ockam_memory_set(p_pool->p_memory, &secret, 0, sizeof(secret));
+
+  error = ockam_vault_random_bytes_generate(p_pool->p_vault, p_keypair->private_key, KEY_SIZE);
+  if (error) goto exit;
+
+  error = ockam_vault_secret_import(
+    p_pool->p_vault, &secret, &secret_attributes, p_keypair->private_key, sizeof(p_keypair->private_key));
+  if (error) goto exit;
+
+  error = ockam_vault_secret_publickey_get(
+    p_pool->p_vault, &secret, p_keypair->public_key, sizeof(p_keypair->public_key), &key_size);
+  if (error) goto exit;
+
+exit:
+  if (secret.context) ockam_vault_secret_destroy(p_pool->p_vault, &secret);
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+void* xx_key_pool_thread(void* arg)
+{
+  ockam_xx_key_pool_t* p_pool  = (ockam_xx_key_pool_t*) arg;
+  ockam_error_t        error   = OCKAM_ERROR_NONE;
+  xx_keypair_t         keypair = { 0 };
+
+  pthread_mutex_lock(&p_pool->lock);
+  while (!p_pool->stop) {
+    if (p_pool->count == p_pool->size) {
+      pthread_cond_wait(&p_pool->changed, &p_pool->lock);
+      continue;
+    }
+
+    // Generate outside the lock so handshakes can take keys meanwhile
+    pthread_mutex_unlock(&p_pool->lock);
+    error = xx_key_pool_generate(p_pool, &keypair);
+    pthread_mutex_lock(&p_pool->lock);
+    if (error) {
+      p_pool->error = error;
+      break;
+    }
+
+    ockam_memory_copy(p_pool->p_memory,
+                      &p_pool->keypairs[(p_pool->head + p_pool->count) % p_pool->size],
+                      &keypair,
+                      sizeof(keypair));
+    p_pool->count++;
+  }
+  pthread_mutex_unlock(&p_pool->lock);
+
+  ockam_memory_set(p_pool->p_memory, &keypair, 0, sizeof(keypair));
+  return NULL;
+}
+
+ockam_error_t ockam_xx_key_pool_init(ockam_xx_key_pool_t** pp_pool, ockam_xx_key_pool_attributes_t* p_attributes)
+{
+  ockam_error_t        error  = OCKAM_ERROR_NONE;
+  ockam_xx_key_pool_t* p_pool = NULL;
+  size_t               size   = 0;
+  int                  locks  = 0;
+
+  if (!pp_pool || !p_attributes || !p_attributes->p_memory || !p_attributes->p_vault) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  size = p_attributes->size ? p_attributes->size : OCKAM_XX_KEY_POOL_DEFAULT_SIZE;
+
+  error = ockam_memory_alloc_zeroed(p_attributes->p_memory, (void**) &p_pool, sizeof(ockam_xx_key_pool_t));
+  if (error) goto exit;
+
+  p_pool->p_memory = p_attributes->p_memory;
+  p_pool->p_vault  = p_attributes->p_vault;
+  p_pool->size     = size;
+
+  error = ockam_memory_alloc_zeroed(p_pool->p_memory, (void**) &p_pool->keypairs, size * sizeof(xx_keypair_t));
+  if (error) goto exit;
+
+  if (pthread_mutex_init(&p_pool->lock, NULL) || pthread_cond_init(&p_pool->changed, NULL)) {
+    error = KEYAGREEMENT_ERROR_FAIL;
+    goto exit;
+  }
+  locks = 1;
+
+  if (pthread_create(&p_pool->thread, NULL, xx_key_pool_thread, p_pool)) {
+    error = KEYAGREEMENT_ERROR_FAIL;
+    goto exit;
+  }
+
+  *pp_pool = p_pool;
+
+exit:
+  if (error) {
+    ockam_log_error("%x", error);
+    if (p_pool) {
+      if (locks) {
+        pthread_cond_destroy(&p_pool->changed);
+        pthread_mutex_destroy(&p_pool->lock);
+      }
+      if (p_pool->keypairs) ockam_memory_free(p_pool->p_memory, p_pool->keypairs, size * sizeof(xx_keypair_t));
+      ockam_memory_free(p_attributes->p_memory, p_pool, sizeof(ockam_xx_key_pool_t));
+    }
+  }
+  return error;
+}
+
+ockam_error_t ockam_xx_key_pool_deinit(ockam_xx_key_pool_t* p_pool)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if (!p_pool) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  pthread_mutex_lock(&p_pool->lock);
+  p_pool->stop = 1;
+  pthread_cond_signal(&p_pool->changed);
+  pthread_mutex_unlock(&p_pool->lock);
+  pthread_join(p_pool->thread, NULL);
+
+  pthread_cond_destroy(&p_pool->changed);
+  pthread_mutex_destroy(&p_pool->lock);
+
+  ockam_memory_set(p_pool->p_memory, p_pool->keypairs, 0, p_pool->size * sizeof(xx_keypair_t));
+  ockam_memory_free(p_pool->p_memory, p_pool->keypairs, p_pool->size * sizeof(xx_keypair_t));
+  ockam_memory_free(p_pool->p_memory, p_pool, sizeof(ockam_xx_key_pool_t));
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t ockam_xx_key_pool_stats(ockam_xx_key_pool_t* p_pool, ockam_xx_key_pool_stats_t* p_stats)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if (!p_pool || !p_stats) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  pthread_mutex_lock(&p_pool->lock);
+  p_stats->available = p_pool->count;
+  p_stats->taken     = p_pool->taken;
+  p_stats->missed    = p_pool->missed;
+  error              = p_pool->error;
+  pthread_mutex_unlock(&p_pool->lock);
+
+exit:
+  return error;
+}
+
+ockam_error_t ockam_xx_key_pool_set(ockam_key_t* p_key, ockam_xx_key_pool_t* p_pool)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if (!p_key || !p_key->context) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  ((ockam_xx_key_t*) p_key->context)->p_pool = p_pool;
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+/*
+ * Load a pooled keypair into the handshake's vault. Returns OCKAM_ERROR_NONE with *p_taken set to 0 when the pool is
+ * empty, in which case the caller generates the key itself.
+ */
+ockam_error_t xx_key_pool_take(ockam_xx_key_pool_t*  p_pool,
+                               ockam_vault_t*        p_vault,
+                               ockam_vault_secret_t* p_secret,
+                               uint8_t*              p_public_key,
+                               int*                  p_taken)
+{
+  ockam_error_t                   error             = OCKAM_ERROR_NONE;
+  ockam_vault_secret_attributes_t secret_attributes = { KEY_SIZE,
+                                                        OCKAM_VAULT_SECRET_TYPE_CURVE25519_PRIVATEKEY,
+                                                        OCKAM_VAULT_SECRET_PURPOSE_KEY_AGREEMENT,
+                                                        OCKAM_VAULT_SECRET_EPHEMERAL };
+  xx_keypair_t                    keypair;
+
+  *p_taken = 0;
+
+  pthread_mutex_lock(&p_pool->lock);
+  if (0 == p_pool->count) {
+    p_pool->missed++;
+    pthread_mutex_unlock(&p_pool->lock);
+    goto exit;
+  }
+  ockam_memory_copy(p_pool->p_memory, &keypair, &p_pool->keypairs[p_pool->head], sizeof(keypair));
+  ockam_memory_set(p_pool->p_memory, &p_pool->keypairs[p_pool->head], 0, sizeof(keypair));
+  p_pool->head = (p_pool->head + 1) % p_pool->size;
+  p_pool->count--;
+  p_pool->taken++;
+  pthread_cond_signal(&p_pool->changed);
+  pthread_mutex_unlock(&p_pool->lock);
+
+  error = ockam_vault_secret_import(p_vault, p_secret, &secret_attributes, keypair.private_key, KEY_SIZE);
+  if (error) goto exit;
+
+  ockam_memory_copy(p_pool->p_memory, p_public_key, keypair.public_key, KEY_SIZE);
+  *p_taken = 1;
+
+exit:
+  ockam_memory_set(p_pool->p_memory, &keypair, 0, sizeof(keypair));
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
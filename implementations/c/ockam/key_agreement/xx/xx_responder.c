@@ -15,71 +15,7 @@ extern ockam_memory_t* gp_ockam_key_memory;
 
 ockam_error_t ockam_key_establish_responder_xx(void* p_context)
 {
-  ockam_error_t        error        = OCKAM_ERROR_NONE;
-  ockam_error_t        return_error = OCKAM_ERROR_NONE;
-  uint8_t              message[MAX_XX_TRANSMIT_SIZE];
-  size_t               message_length = 0;
-  key_establishment_xx xx;
-  ockam_xx_key_t*      p_xx_key = (ockam_xx_key_t*) p_context;
-
-  ockam_memory_set(gp_ockam_key_memory, &xx, 0, sizeof(xx));
-  xx.vault = p_xx_key->p_vault;
-
-  /* Initialize handshake struct and generate initial static & ephemeral keys */
-  error = key_agreement_prologue_xx(&xx);
-  if (error) goto exit;
-
-  /* Msg 1 receive */
-  error = ockam_read(p_xx_key->p_reader, message, sizeof(message), &message_length);
-  if (error) goto exit;
-
-  /* Msg 1 process */
-  error = xx_responder_m1_process(&xx, message, message_length);
-  if (error) goto exit;
-
-  /* Msg 2 make */
-  error = xx_responder_m2_make(&xx, message, sizeof(message), &message_length);
-  if (error) goto exit;
-
-  /* Msg 2 send */
-  error = ockam_write(p_xx_key->p_writer, message, message_length);
-  if (error) goto exit;
-
-  /* Msg 3 receive */
-  error = ockam_read(p_xx_key->p_reader, message, sizeof(message), &message_length);
-  if (error) goto exit;
-
-  /* Msg 3 process */
-  error = xx_responder_m3_process(&xx, message, message_length);
-  if (error) goto exit;
-
-  /* Epilogue */
-  error = xx_responder_epilogue(&xx, p_xx_key);
-  if (error) goto exit;
-
-exit:
-  if (error) ockam_log_error("%x", error);
-  error = ockam_vault_secret_destroy(xx.vault, &xx.s_secret);
-  if (error) {
-    ockam_log_error("%x", error);
-    return_error = error;
-  }
-  error = ockam_vault_secret_destroy(xx.vault, &xx.e_secret);
-  if (error) {
-    ockam_log_error("%x", error);
-    return_error = error;
-  }
-  error = ockam_vault_secret_destroy(xx.vault, &xx.k_secret);
-  if (error) {
-    ockam_log_error("%x", error);
-    return_error = error;
-  }
-  error = ockam_vault_secret_destroy(xx.vault, &xx.ck_secret);
-  if (error) {
-    ockam_log_error("%x", error);
-    return_error = error;
-  }
-  return return_error;
+  return xx_handshake_run((ockam_xx_key_t*) p_context, 0);
 }
 
 /*
@@ -281,14 +217,16 @@ exit:
 ockam_error_t xx_responder_epilogue(key_establishment_xx* xx, ockam_xx_key_t* p_key)
 {
   ockam_error_t        error = TRANSPORT_ERROR_NONE;
-  ockam_vault_secret_t secrets[2];
+  ockam_vault_secret_t secrets[3];
 
+  // The third output is not part of Noise; it only seeds session resumption
   ockam_memory_set(gp_ockam_key_memory, secrets, 0, sizeof(secrets));
-  error = ockam_vault_hkdf_sha256(xx->vault, &xx->ck_secret, NULL, 2, &secrets[0]);
+  error = ockam_vault_hkdf_sha256(xx->vault, &xx->ck_secret, NULL, 3, &secrets[0]);
   if (error) goto exit;
 
   ockam_memory_copy(gp_ockam_key_memory, &p_key->encrypt_secret, &secrets[0], sizeof(secrets[0]));
   ockam_memory_copy(gp_ockam_key_memory, &p_key->decrypt_secret, &secrets[1], sizeof(secrets[1]));
+  ockam_memory_copy(gp_ockam_key_memory, &p_key->resumption_secret, &secrets[2], sizeof(secrets[2]));
   error = ockam_vault_secret_type_set(xx->vault, &p_key->encrypt_secret, OCKAM_VAULT_SECRET_TYPE_AES256_KEY);
   if (error) goto exit;
   error = ockam_vault_secret_type_set(xx->vault, &p_key->decrypt_secret, OCKAM_VAULT_SECRET_TYPE_AES256_KEY);
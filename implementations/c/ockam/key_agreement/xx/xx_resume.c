@@ -0,0 +1,102 @@
+#include "ockam/error.h"
+#include "ockam/key_agreement.h"
+#include "ockam/key_agreement/impl.h"
+#include "ockam/key_agreement/xx.h"
+#include "ockam/log.h"
+#include "ockam/memory.h"
+#include "ockam/vault.h"
+#include "xx_local.h"
+
+extern ockam_memory_t* gp_ockam_key_memory;
+
+ockam_error_t ockam_xx_key_resumption_secret_take(ockam_key_t* p_key, ockam_vault_secret_t* p_secret)
+{
+  ockam_error_t   error    = OCKAM_ERROR_NONE;
+  ockam_xx_key_t* p_xx_key = NULL;
+
+  if (!p_key || !p_key->context || !p_secret) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  p_xx_key = (ockam_xx_key_t*) p_key->context;
+  if (!p_xx_key->resumption_secret.context) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  ockam_memory_copy(gp_ockam_key_memory, p_secret, &p_xx_key->resumption_secret, sizeof(ockam_vault_secret_t));
+  ockam_memory_set(gp_ockam_key_memory, &p_xx_key->resumption_secret, 0, sizeof(ockam_vault_secret_t));
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+/*
+ * encrypt/decrypt keys and the next resumption secret = HKDF(resumption secret, context, 3), assigned to the two ends
+ * the way the handshake's epilogues assign theirs.
+ */
+ockam_error_t ockam_xx_key_resume(ockam_key_t*          p_key,
+                                  ockam_vault_secret_t* p_resumption_secret,
+                                  const uint8_t*        p_context,
+                                  size_t                context_length,
+                                  int                   initiator)
+{
+  ockam_error_t                   error             = OCKAM_ERROR_NONE;
+  ockam_xx_key_t*                 p_xx_key          = NULL;
+  ockam_vault_secret_attributes_t secret_attributes = { 0,
+                                                        OCKAM_VAULT_SECRET_TYPE_BUFFER,
+                                                        OCKAM_VAULT_SECRET_PURPOSE_KEY_AGREEMENT,
+                                                        OCKAM_VAULT_SECRET_EPHEMERAL };
+  ockam_vault_secret_t            context_secret;
+  ockam_vault_secret_t            secrets[3];
+
+  ockam_memory_set(gp_ockam_key_memory, &context_secret, 0, sizeof(context_secret));
+  ockam_memory_set(gp_ockam_key_memory, secrets, 0, sizeof(secrets));
+
+  if (!p_key || !p_key->context || !p_resumption_secret || !p_context || !context_length) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  p_xx_key = (ockam_xx_key_t*) p_key->context;
+  // As for a handshake: resuming would overwrite the secrets of a key that already holds any
+  if (p_xx_key->p_handshake || p_xx_key->encrypt_secret.context || p_xx_key->decrypt_secret.context ||
+      p_xx_key->resumption_secret.context) {
+    error = KEYAGREEMENT_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  secret_attributes.length = context_length;
+  error = ockam_vault_secret_import(p_xx_key->p_vault, &context_secret, &secret_attributes, p_context, context_length);
+  if (error) goto exit;
+
+  error = ockam_vault_hkdf_sha256(p_xx_key->p_vault, p_resumption_secret, &context_secret, 3, secrets);
+  if (error) goto exit;
+
+  error = ockam_vault_secret_type_set(p_xx_key->p_vault, &secrets[0], OCKAM_VAULT_SECRET_TYPE_AES256_KEY);
+  if (error) goto exit;
+  error = ockam_vault_secret_type_set(p_xx_key->p_vault, &secrets[1], OCKAM_VAULT_SECRET_TYPE_AES256_KEY);
+  if (error) goto exit;
+
+  ockam_memory_copy(
+    gp_ockam_key_memory, &p_xx_key->decrypt_secret, &secrets[initiator ? 0 : 1], sizeof(ockam_vault_secret_t));
+  ockam_memory_copy(
+    gp_ockam_key_memory, &p_xx_key->encrypt_secret, &secrets[initiator ? 1 : 0], sizeof(ockam_vault_secret_t));
+  ockam_memory_copy(gp_ockam_key_memory, &p_xx_key->resumption_secret, &secrets[2], sizeof(ockam_vault_secret_t));
+  ockam_memory_set(gp_ockam_key_memory, secrets, 0, sizeof(secrets));
+
+  p_xx_key->encrypt_nonce = 0;
+  p_xx_key->decrypt_nonce = 0;
+
+exit:
+  if (error) {
+    ockam_log_error("%x", error);
+    if (secrets[0].context) ockam_vault_secret_destroy(p_xx_key->p_vault, &secrets[0]);
+    if (secrets[1].context) ockam_vault_secret_destroy(p_xx_key->p_vault, &secrets[1]);
+    if (secrets[2].context) ockam_vault_secret_destroy(p_xx_key->p_vault, &secrets[2]);
+  }
+  if (context_secret.context) ockam_vault_secret_destroy(p_xx_key->p_vault, &context_secret);
+  return error;
+}
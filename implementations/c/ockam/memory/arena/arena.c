@@ -0,0 +1,339 @@
+/**
+ * @file    arena.c
+ * @brief   impl of Ockam's memory functions using a bump-pointer arena
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "ockam/error.h"
+#include "ockam/memory.h"
+
+#include "ockam/memory/arena.h"
+
+#define MEMORY_ARENA_ALIGN 16u
+
+#define MEMORY_ARENA_ROUND(size) (((size) + (MEMORY_ARENA_ALIGN - 1u)) & ~((size_t) MEMORY_ARENA_ALIGN - 1u))
+
+/* Blocks start with a pointer to the next block, large allocations with their list links */
+#define MEMORY_ARENA_BLOCK_HEADER_SIZE MEMORY_ARENA_ROUND(sizeof(void*))
+#define MEMORY_ARENA_LARGE_HEADER_SIZE MEMORY_ARENA_ROUND(sizeof(memory_arena_large_t))
+
+typedef struct memory_arena_large_t {
+  struct memory_arena_large_t* prev;
+  struct memory_arena_large_t* next;
+  size_t                       size;
+} memory_arena_large_t;
+
+typedef struct {
+  ockam_memory_t*      p_memory;
+  size_t               block_size;
+  uint8_t*             blocks;
+  uint8_t*             current;
+  size_t               offset;
+  memory_arena_large_t large;
+  size_t               bytes_allocated;
+  size_t               bytes_reserved;
+} memory_arena_t;
+
+ockam_error_t memory_arena_deinit(ockam_memory_t* memory);
+ockam_error_t memory_arena_alloc_zeroed(ockam_memory_t* memory, void** buffer, size_t buffer_size);
+ockam_error_t memory_arena_free(ockam_memory_t* memory, void* buffer, size_t buffer_size);
+ockam_error_t memory_arena_set(ockam_memory_t* memory, void* buffer, uint8_t value, size_t set_size);
+ockam_error_t memory_arena_copy(ockam_memory_t* memory, void* destination, const void* source, size_t copy_size);
+ockam_error_t memory_arena_move(ockam_memory_t* memory, void* destination, void* source, size_t move_size);
+ockam_error_t
+memory_arena_compare(ockam_memory_t* memory, int* res, const void* lhs, const void* rhs, size_t buffer_size);
+
+ockam_memory_dispatch_table_t memory_arena_dispatch_table = { &memory_arena_deinit, &memory_arena_alloc_zeroed,
+                                                              &memory_arena_free,   &memory_arena_set,
+                                                              &memory_arena_copy,   &memory_arena_move,
+                                                              &memory_arena_compare };
+
+static int memory_arena_is_large(memory_arena_t* p_arena, size_t buffer_size)
+{
+  return MEMORY_ARENA_ROUND(buffer_size) > (p_arena->block_size - MEMORY_ARENA_BLOCK_HEADER_SIZE);
+}
+
+static void memory_arena_release_large(memory_arena_t* p_arena)
+{
+  memory_arena_large_t* p_large = p_arena->large.next;
+  memory_arena_large_t* p_next  = 0;
+
+  while (p_large != &p_arena->large) {
+    p_next = p_large->next;
+    p_arena->bytes_reserved -= MEMORY_ARENA_LARGE_HEADER_SIZE + p_large->size;
+    ockam_memory_free(p_arena->p_memory, p_large, MEMORY_ARENA_LARGE_HEADER_SIZE + p_large->size);
+    p_large = p_next;
+  }
+
+  p_arena->large.prev = &p_arena->large;
+  p_arena->large.next = &p_arena->large;
+}
+
+ockam_error_t ockam_memory_arena_init(ockam_memory_t* memory, ockam_memory_arena_attributes_t* p_attributes)
+{
+  ockam_error_t   error   = OCKAM_ERROR_NONE;
+  memory_arena_t* p_arena = 0;
+
+  if ((memory == 0) || (p_attributes == 0) || (p_attributes->p_memory == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  error = ockam_memory_alloc_zeroed(p_attributes->p_memory, (void**) &p_arena, sizeof(memory_arena_t));
+  if (error) goto exit;
+
+  p_arena->p_memory   = p_attributes->p_memory;
+  p_arena->block_size = p_attributes->block_size ? p_attributes->block_size : OCKAM_MEMORY_ARENA_DEFAULT_BLOCK_SIZE;
+  if (p_arena->block_size < 2 * MEMORY_ARENA_BLOCK_HEADER_SIZE) {
+    p_arena->block_size = 2 * MEMORY_ARENA_BLOCK_HEADER_SIZE;
+  }
+
+  p_arena->large.prev     = &p_arena->large;
+  p_arena->large.next     = &p_arena->large;
+  p_arena->bytes_reserved = sizeof(memory_arena_t);
+
+  memory->dispatch = &memory_arena_dispatch_table;
+  memory->context  = p_arena;
+
+exit:
+  return error;
+}
+
+ockam_error_t ockam_memory_arena_reset(ockam_memory_t* memory)
+{
+  ockam_error_t   error   = OCKAM_ERROR_NONE;
+  memory_arena_t* p_arena = 0;
+
+  if ((memory == 0) || (memory->dispatch != &memory_arena_dispatch_table)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  p_arena = (memory_arena_t*) memory->context;
+
+  memory_arena_release_large(p_arena);
+
+  p_arena->current         = p_arena->blocks;
+  p_arena->offset          = MEMORY_ARENA_BLOCK_HEADER_SIZE;
+  p_arena->bytes_allocated = 0;
+
+exit:
+  return error;
+}
+
+ockam_error_t ockam_memory_arena_stats(ockam_memory_t* memory, ockam_memory_arena_stats_t* p_stats)
+{
+  ockam_error_t   error   = OCKAM_ERROR_NONE;
+  memory_arena_t* p_arena = 0;
+
+  if ((memory == 0) || (memory->dispatch != &memory_arena_dispatch_table) || (p_stats == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  p_arena                  = (memory_arena_t*) memory->context;
+  p_stats->bytes_allocated = p_arena->bytes_allocated;
+  p_stats->bytes_reserved  = p_arena->bytes_reserved;
+
+exit:
+  return error;
+}
+
+ockam_error_t memory_arena_deinit(ockam_memory_t* memory)
+{
+  ockam_error_t   error   = OCKAM_ERROR_NONE;
+  memory_arena_t* p_arena = 0;
+  uint8_t*        p_next  = 0;
+
+  if ((memory == 0) || (memory->context == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  p_arena = (memory_arena_t*) memory->context;
+
+  memory_arena_release_large(p_arena);
+
+  while (p_arena->blocks != 0) {
+    p_next = *(uint8_t**) p_arena->blocks;
+    ockam_memory_free(p_arena->p_memory, p_arena->blocks, p_arena->block_size);
+    p_arena->blocks = p_next;
+  }
+
+  ockam_memory_free(p_arena->p_memory, p_arena, sizeof(memory_arena_t));
+
+  memory->dispatch = 0;
+  memory->context  = 0;
+
+exit:
+  return error;
+}
+
+ockam_error_t memory_arena_alloc_zeroed(ockam_memory_t* memory, void** buffer, size_t buffer_size)
+{
+  ockam_error_t         error   = OCKAM_ERROR_NONE;
+  memory_arena_t*       p_arena = 0;
+  memory_arena_large_t* p_large = 0;
+  uint8_t*              p_next  = 0;
+  size_t                size    = MEMORY_ARENA_ROUND(buffer_size);
+
+  if ((memory == 0) || (memory->context == 0) || (buffer == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if ((buffer_size == 0) || (size < buffer_size)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_SIZE;
+    goto exit;
+  }
+
+  p_arena = (memory_arena_t*) memory->context;
+
+  if (memory_arena_is_large(p_arena, buffer_size)) {
+    error = ockam_memory_alloc_zeroed(p_arena->p_memory, (void**) &p_large, MEMORY_ARENA_LARGE_HEADER_SIZE + size);
+    if (error) goto exit;
+
+    p_large->size       = size;
+    p_large->prev       = &p_arena->large;
+    p_large->next       = p_arena->large.next;
+    p_large->next->prev = p_large;
+    p_arena->large.next = p_large;
+    p_arena->bytes_reserved += MEMORY_ARENA_LARGE_HEADER_SIZE + size;
+
+    *buffer = (uint8_t*) p_large + MEMORY_ARENA_LARGE_HEADER_SIZE;
+    p_arena->bytes_allocated += buffer_size;
+    goto exit;
+  }
+
+  if ((p_arena->current == 0) || (p_arena->offset + size > p_arena->block_size)) {
+    // Move on to the next block, reusing blocks kept by a reset before asking the backing memory for a new one
+    p_next = (p_arena->current != 0) ? *(uint8_t**) p_arena->current : p_arena->blocks;
+
+    if (p_next == 0) {
+      error = ockam_memory_alloc_zeroed(p_arena->p_memory, (void**) &p_next, p_arena->block_size);
+      if (error) goto exit;
+
+      if (p_arena->current != 0) {
+        *(uint8_t**) p_arena->current = p_next;
+      } else {
+        p_arena->blocks = p_next;
+      }
+      p_arena->bytes_reserved += p_arena->block_size;
+    }
+
+    p_arena->current = p_next;
+    p_arena->offset  = MEMORY_ARENA_BLOCK_HEADER_SIZE;
+  }
+
+  *buffer = p_arena->current + p_arena->offset;
+  p_arena->offset += size;
+
+  memset(*buffer, 0, buffer_size);
+  p_arena->bytes_allocated += buffer_size;
+
+exit:
+  return error;
+}
+
+ockam_error_t memory_arena_free(ockam_memory_t* memory, void* buffer, size_t buffer_size)
+{
+  ockam_error_t         error   = OCKAM_ERROR_NONE;
+  memory_arena_t*       p_arena = 0;
+  memory_arena_large_t* p_large = 0;
+  size_t                size    = MEMORY_ARENA_ROUND(buffer_size);
+
+  if ((memory == 0) || (memory->context == 0) || (buffer == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if (buffer_size == 0) {
+    error = OCKAM_MEMORY_ERROR_INVALID_SIZE;
+    goto exit;
+  }
+
+  p_arena = (memory_arena_t*) memory->context;
+
+  if (memory_arena_is_large(p_arena, buffer_size)) {
+    p_large             = (memory_arena_large_t*) ((uint8_t*) buffer - MEMORY_ARENA_LARGE_HEADER_SIZE);
+    p_large->prev->next = p_large->next;
+    p_large->next->prev = p_large->prev;
+    p_arena->bytes_reserved -= MEMORY_ARENA_LARGE_HEADER_SIZE + p_large->size;
+    p_arena->bytes_allocated -= buffer_size;
+
+    error = ockam_memory_free(p_arena->p_memory, p_large, MEMORY_ARENA_LARGE_HEADER_SIZE + p_large->size);
+    goto exit;
+  }
+
+  // Only the most recent allocation can be given back, anything else waits for a reset
+  if ((p_arena->current != 0) && ((uint8_t*) buffer + size == p_arena->current + p_arena->offset)) {
+    p_arena->offset -= size;
+    p_arena->bytes_allocated -= buffer_size;
+  }
+
+exit:
+  return error;
+}
+
+ockam_error_t memory_arena_set(ockam_memory_t* memory, void* buffer, uint8_t value, size_t set_size)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((memory == 0) || (memory->context == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  error = ockam_memory_set(((memory_arena_t*) memory->context)->p_memory, buffer, value, set_size);
+
+exit:
+  return error;
+}
+
+ockam_error_t memory_arena_copy(ockam_memory_t* memory, void* destination, const void* source, size_t copy_size)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((memory == 0) || (memory->context == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  error = ockam_memory_copy(((memory_arena_t*) memory->context)->p_memory, destination, source, copy_size);
+
+exit:
+  return error;
+}
+
+ockam_error_t memory_arena_move(ockam_memory_t* memory, void* destination, void* source, size_t move_size)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((memory == 0) || (memory->context == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  error = ockam_memory_move(((memory_arena_t*) memory->context)->p_memory, destination, source, move_size);
+
+exit:
+  return error;
+}
+
+ockam_error_t
+memory_arena_compare(ockam_memory_t* memory, int* res, const void* lhs, const void* rhs, size_t buffer_size)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((memory == 0) || (memory->context == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  error = ockam_memory_compare(((memory_arena_t*) memory->context)->p_memory, res, lhs, rhs, buffer_size);
+
+exit:
+  return error;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file  arena.h
+ * @brief Bump-pointer arena memory that is released all at once
+ */
+
+#ifndef OCKAM_MEMORY_ARENA_H_
+#define OCKAM_MEMORY_ARENA_H_
+
+#include "ockam/error.h"
+#include "ockam/memory.h"
+
+#include "ockam/memory/impl.h"
+
+/* Size of each block the arena allocates from when p_attributes->block_size is 0 */
+#define OCKAM_MEMORY_ARENA_DEFAULT_BLOCK_SIZE (16u * 1024u)
+
+typedef struct {
+  ockam_memory_t* p_memory;   /*!< Backing memory for blocks, large requests, and set/copy/move */
+  size_t          block_size; /*!< Bytes requested from p_memory per block, 0 means 16KiB */
+} ockam_memory_arena_attributes_t;
+
+typedef struct {
+  size_t bytes_allocated; /*!< Bytes handed out since the last reset and not yet reclaimed */
+  size_t bytes_reserved;  /*!< Bytes currently held from the backing memory */
+} ockam_memory_arena_stats_t;
+
+/**
+ * @brief   Initialize an arena memory object.
+ *
+ * Allocations are carved from the current block by advancing a pointer, and freeing one only reclaims its space when
+ * it is the most recent allocation. Everything else is reclaimed by ockam_memory_arena_reset, which keeps the blocks
+ * for reuse, or ockam_memory_deinit, which releases them. Requests too large for a block are passed to the backing
+ * memory individually and released when freed or at the next reset.
+ *
+ * An arena suits memory with one owner and one lifetime, such as the state of a single connection. It is not
+ * thread-safe.
+ * @param   memory[out]       The ockam memory object to initialize.
+ * @param   p_attributes[in]  Arena attributes.
+ * @return  OCKAM_ERROR_NONE on success.
+ * @return  OCKAM_MEMORY_ERROR_INVALID_PARAM if memory, p_attributes or p_attributes->p_memory is invalid.
+ */
+ockam_error_t ockam_memory_arena_init(ockam_memory_t* memory, ockam_memory_arena_attributes_t* p_attributes);
+
+/**
+ * @brief   Reclaim every allocation made from the arena. Buffers allocated before the reset must not be used after it.
+ * @param   memory[in]  An arena memory object.
+ * @return  OCKAM_ERROR_NONE on success.
+ * @return  OCKAM_MEMORY_ERROR_INVALID_PARAM if memory is not an arena memory object.
+ */
+ockam_error_t ockam_memory_arena_reset(ockam_memory_t* memory);
+
+/**
+ * @brief   Report how much memory an arena memory object is using.
+ * @param   memory[in]   An arena memory object.
+ * @param   p_stats[out] The current usage.
+ * @return  OCKAM_ERROR_NONE on success.
+ * @return  OCKAM_MEMORY_ERROR_INVALID_PARAM if memory is not an arena memory object or p_stats is NULL.
+ */
+ockam_error_t ockam_memory_arena_stats(ockam_memory_t* memory, ockam_memory_arena_stats_t* p_stats);
+
+#endif
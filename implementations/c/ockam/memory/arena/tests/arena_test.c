@@ -0,0 +1,143 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <string.h>
+#include "ockam/memory.h"
+#include "ockam/memory/arena.h"
+#include "ockam/memory/stdlib.h"
+
+#define TEST_BLOCK_SIZE 1024
+
+typedef struct {
+  ockam_memory_t backing;
+  ockam_memory_t arena;
+} test_state_t;
+
+static int test_setup(void** state)
+{
+  static test_state_t             test_state;
+  ockam_memory_arena_attributes_t attributes = { 0 };
+
+  ockam_error_t error = ockam_memory_stdlib_init(&test_state.backing);
+  assert_int_equal(error, OCKAM_ERROR_NONE);
+
+  attributes.p_memory   = &test_state.backing;
+  attributes.block_size = TEST_BLOCK_SIZE;
+  error                 = ockam_memory_arena_init(&test_state.arena, &attributes);
+  assert_int_equal(error, OCKAM_ERROR_NONE);
+
+  *state = &test_state;
+
+  return 0;
+}
+
+static int test_teardown(void** state)
+{
+  test_state_t* test_state = *state;
+
+  ockam_memory_deinit(&test_state->arena);
+  ockam_memory_deinit(&test_state->backing);
+
+  return 0;
+}
+
+static void memory_arena__allocations__should_be_contiguous_and_aligned(void** state)
+{
+  test_state_t* test_state = *state;
+  uint8_t*      p_first    = NULL;
+  uint8_t*      p_second   = NULL;
+
+  assert_int_equal(ockam_memory_alloc_zeroed(&test_state->arena, (void**) &p_first, 20), OCKAM_ERROR_NONE);
+  assert_int_equal(ockam_memory_alloc_zeroed(&test_state->arena, (void**) &p_second, 20), OCKAM_ERROR_NONE);
+  assert_int_equal((uintptr_t) p_first % 16, 0);
+  assert_ptr_equal(p_second, p_first + 32);
+}
+
+static void memory_arena__free_last__should_reclaim_space(void** state)
+{
+  test_state_t*              test_state = *state;
+  ockam_memory_arena_stats_t stats      = { 0 };
+  uint8_t*                   p_first    = NULL;
+  uint8_t*                   p_second   = NULL;
+  uint8_t                    zero[64]   = { 0 };
+
+  assert_int_equal(ockam_memory_alloc_zeroed(&test_state->arena, (void**) &p_first, 64), OCKAM_ERROR_NONE);
+  memset(p_first, 0xA5, 64);
+  assert_int_equal(ockam_memory_free(&test_state->arena, p_first, 64), OCKAM_ERROR_NONE);
+  assert_int_equal(ockam_memory_arena_stats(&test_state->arena, &stats), OCKAM_ERROR_NONE);
+  assert_int_equal(stats.bytes_allocated, 0);
+
+  assert_int_equal(ockam_memory_alloc_zeroed(&test_state->arena, (void**) &p_second, 64), OCKAM_ERROR_NONE);
+  assert_ptr_equal(p_first, p_second);
+  assert_memory_equal(p_second, zero, sizeof(zero));
+}
+
+static void memory_arena__reset__should_reuse_blocks(void** state)
+{
+  test_state_t*              test_state = *state;
+  ockam_memory_arena_stats_t before     = { 0 };
+  ockam_memory_arena_stats_t after      = { 0 };
+  uint8_t*                   p_first    = NULL;
+  uint8_t*                   p_buffer   = NULL;
+  int                        i          = 0;
+
+  // Fill several blocks, then start over
+  assert_int_equal(ockam_memory_alloc_zeroed(&test_state->arena, (void**) &p_first, 100), OCKAM_ERROR_NONE);
+  for (i = 0; i < 50; i++) {
+    assert_int_equal(ockam_memory_alloc_zeroed(&test_state->arena, (void**) &p_buffer, 100), OCKAM_ERROR_NONE);
+  }
+  assert_int_equal(ockam_memory_arena_stats(&test_state->arena, &before), OCKAM_ERROR_NONE);
+  assert_int_equal(before.bytes_allocated, 51 * 100);
+
+  assert_int_equal(ockam_memory_arena_reset(&test_state->arena), OCKAM_ERROR_NONE);
+  assert_int_equal(ockam_memory_alloc_zeroed(&test_state->arena, (void**) &p_buffer, 100), OCKAM_ERROR_NONE);
+  assert_ptr_equal(p_buffer, p_first);
+
+  for (i = 0; i < 50; i++) {
+    assert_int_equal(ockam_memory_alloc_zeroed(&test_state->arena, (void**) &p_buffer, 100), OCKAM_ERROR_NONE);
+  }
+  assert_int_equal(ockam_memory_arena_stats(&test_state->arena, &after), OCKAM_ERROR_NONE);
+  assert_int_equal(after.bytes_reserved, before.bytes_reserved);
+}
+
+static void memory_arena__large_request__should_be_released(void** state)
+{
+  test_state_t*              test_state = *state;
+  ockam_memory_arena_stats_t before     = { 0 };
+  ockam_memory_arena_stats_t after      = { 0 };
+  uint8_t*                   p_large    = NULL;
+
+  assert_int_equal(ockam_memory_arena_stats(&test_state->arena, &before), OCKAM_ERROR_NONE);
+
+  assert_int_equal(ockam_memory_alloc_zeroed(&test_state->arena, (void**) &p_large, 4000), OCKAM_ERROR_NONE);
+  assert_int_equal(ockam_memory_free(&test_state->arena, p_large, 4000), OCKAM_ERROR_NONE);
+  assert_int_equal(ockam_memory_arena_stats(&test_state->arena, &after), OCKAM_ERROR_NONE);
+  assert_int_equal(after.bytes_reserved, before.bytes_reserved);
+
+  assert_int_equal(ockam_memory_alloc_zeroed(&test_state->arena, (void**) &p_large, 4000), OCKAM_ERROR_NONE);
+  assert_int_equal(ockam_memory_arena_reset(&test_state->arena), OCKAM_ERROR_NONE);
+  assert_int_equal(ockam_memory_arena_stats(&test_state->arena, &after), OCKAM_ERROR_NONE);
+  assert_int_equal(after.bytes_reserved, before.bytes_reserved);
+}
+
+static void memory_arena__reset_other_memory__should_return_error(void** state)
+{
+  test_state_t* test_state = *state;
+
+  assert_int_equal(ockam_memory_arena_reset(&test_state->backing), OCKAM_MEMORY_ERROR_INVALID_PARAM);
+}
+
+int main(void)
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test_setup_teardown(memory_arena__allocations__should_be_contiguous_and_aligned, test_setup, test_teardown),
+    cmocka_unit_test_setup_teardown(memory_arena__free_last__should_reclaim_space, test_setup, test_teardown),
+    cmocka_unit_test_setup_teardown(memory_arena__reset__should_reuse_blocks, test_setup, test_teardown),
+    cmocka_unit_test_setup_teardown(memory_arena__large_request__should_be_released, test_setup, test_teardown),
+    cmocka_unit_test_setup_teardown(memory_arena__reset_other_memory__should_return_error, test_setup, test_teardown),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,318 @@
+/**
+ * @file    slab.c
+ * @brief   impl of Ockam's memory functions using slabs of fixed-size objects
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "ockam/error.h"
+#include "ockam/memory.h"
+
+#include "ockam/memory/slab.h"
+
+#define MEMORY_SLAB_ALIGN       16u
+#define MEMORY_SLAB_HEADER_SIZE MEMORY_SLAB_ALIGN
+#define MEMORY_SLAB_LOOKUP_SIZE ((OCKAM_MEMORY_SLAB_MAX_CLASS_SIZE / MEMORY_SLAB_ALIGN) + 1u)
+#define MEMORY_SLAB_NO_CLASS    0xFFu
+
+#define MEMORY_SLAB_ROUND(size) (((size) + (MEMORY_SLAB_ALIGN - 1u)) & ~((size_t) MEMORY_SLAB_ALIGN - 1u))
+
+typedef struct {
+  size_t   size;
+  void*    free_list;
+  uint8_t* next;
+  uint8_t* end;
+} memory_slab_class_t;
+
+typedef struct {
+  ockam_memory_t*     p_memory;
+  size_t              slab_size;
+  size_t              class_count;
+  memory_slab_class_t classes[OCKAM_MEMORY_SLAB_MAX_CLASSES];
+  uint8_t             lookup[MEMORY_SLAB_LOOKUP_SIZE];
+  void*               slabs;
+  size_t              bytes_allocated;
+  size_t              bytes_reserved;
+} memory_slab_t;
+
+ockam_error_t memory_slab_deinit(ockam_memory_t* memory);
+ockam_error_t memory_slab_alloc_zeroed(ockam_memory_t* memory, void** buffer, size_t buffer_size);
+ockam_error_t memory_slab_free(ockam_memory_t* memory, void* buffer, size_t buffer_size);
+ockam_error_t memory_slab_set(ockam_memory_t* memory, void* buffer, uint8_t value, size_t set_size);
+ockam_error_t memory_slab_copy(ockam_memory_t* memory, void* destination, const void* source, size_t copy_size);
+ockam_error_t memory_slab_move(ockam_memory_t* memory, void* destination, void* source, size_t move_size);
+ockam_error_t memory_slab_compare(ockam_memory_t* memory, int* res, const void* lhs, const void* rhs, size_t buffer_size);
+
+ockam_memory_dispatch_table_t memory_slab_dispatch_table = { &memory_slab_deinit, &memory_slab_alloc_zeroed,
+                                                             &memory_slab_free,   &memory_slab_set,
+                                                             &memory_slab_copy,   &memory_slab_move,
+                                                             &memory_slab_compare };
+
+static const size_t g_memory_slab_default_classes[] = { 16, 32, 64, 128, 256, 512, 1024, 2048 };
+
+ockam_error_t ockam_memory_slab_init(ockam_memory_t* memory, ockam_memory_slab_attributes_t* p_attributes)
+{
+  ockam_error_t  error       = OCKAM_ERROR_NONE;
+  memory_slab_t* p_slab      = 0;
+  const size_t*  class_sizes = g_memory_slab_default_classes;
+  size_t         class_count = sizeof(g_memory_slab_default_classes) / sizeof(g_memory_slab_default_classes[0]);
+  size_t         i           = 0;
+  size_t         lookup      = 0;
+
+  if ((memory == 0) || (p_attributes == 0) || (p_attributes->p_memory == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if (p_attributes->class_sizes != 0) {
+    class_sizes = p_attributes->class_sizes;
+    class_count = p_attributes->class_count;
+  }
+
+  if ((class_count == 0) || (class_count > OCKAM_MEMORY_SLAB_MAX_CLASSES) ||
+      (class_sizes[class_count - 1] > OCKAM_MEMORY_SLAB_MAX_CLASS_SIZE)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_SIZE;
+    goto exit;
+  }
+
+  for (i = 0; i < class_count; i++) {
+    if ((class_sizes[i] == 0) || ((i > 0) && (class_sizes[i] <= class_sizes[i - 1]))) {
+      error = OCKAM_MEMORY_ERROR_INVALID_SIZE;
+      goto exit;
+    }
+  }
+
+  error = ockam_memory_alloc_zeroed(p_attributes->p_memory, (void**) &p_slab, sizeof(memory_slab_t));
+  if (error) goto exit;
+
+  p_slab->p_memory    = p_attributes->p_memory;
+  p_slab->class_count = class_count;
+  p_slab->slab_size   = p_attributes->slab_size ? p_attributes->slab_size : OCKAM_MEMORY_SLAB_DEFAULT_SLAB_SIZE;
+
+  for (i = 0; i < class_count; i++) { p_slab->classes[i].size = MEMORY_SLAB_ROUND(class_sizes[i]); }
+
+  if (p_slab->slab_size < MEMORY_SLAB_HEADER_SIZE + p_slab->classes[class_count - 1].size) {
+    p_slab->slab_size = MEMORY_SLAB_HEADER_SIZE + p_slab->classes[class_count - 1].size;
+  }
+
+  // lookup[n] is the class for requests of up to n * 16 bytes
+  for (i = 0, lookup = 0; lookup < MEMORY_SLAB_LOOKUP_SIZE; lookup++) {
+    while ((i < class_count) && (p_slab->classes[i].size < lookup * MEMORY_SLAB_ALIGN)) i++;
+    p_slab->lookup[lookup] = (i < class_count) ? (uint8_t) i : MEMORY_SLAB_NO_CLASS;
+  }
+
+  p_slab->bytes_reserved = sizeof(memory_slab_t);
+
+  memory->dispatch = &memory_slab_dispatch_table;
+  memory->context  = p_slab;
+
+exit:
+  return error;
+}
+
+ockam_error_t ockam_memory_slab_stats(ockam_memory_t* memory, ockam_memory_slab_stats_t* p_stats)
+{
+  ockam_error_t  error  = OCKAM_ERROR_NONE;
+  memory_slab_t* p_slab = 0;
+
+  if ((memory == 0) || (memory->dispatch != &memory_slab_dispatch_table) || (p_stats == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  p_slab                   = (memory_slab_t*) memory->context;
+  p_stats->bytes_allocated = p_slab->bytes_allocated;
+  p_stats->bytes_reserved  = p_slab->bytes_reserved;
+
+exit:
+  return error;
+}
+
+ockam_error_t memory_slab_deinit(ockam_memory_t* memory)
+{
+  ockam_error_t  error  = OCKAM_ERROR_NONE;
+  memory_slab_t* p_slab = 0;
+  void*          p_next = 0;
+
+  if ((memory == 0) || (memory->context == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  p_slab = (memory_slab_t*) memory->context;
+
+  while (p_slab->slabs != 0) {
+    p_next = *(void**) p_slab->slabs;
+    ockam_memory_free(p_slab->p_memory, p_slab->slabs, p_slab->slab_size);
+    p_slab->slabs = p_next;
+  }
+
+  ockam_memory_free(p_slab->p_memory, p_slab, sizeof(memory_slab_t));
+
+  memory->dispatch = 0;
+  memory->context  = 0;
+
+exit:
+  return error;
+}
+
+ockam_error_t memory_slab_alloc_zeroed(ockam_memory_t* memory, void** buffer, size_t buffer_size)
+{
+  ockam_error_t        error   = OCKAM_ERROR_NONE;
+  memory_slab_t*       p_slab  = 0;
+  memory_slab_class_t* p_class = 0;
+  uint8_t*             p_new   = 0;
+  size_t               index   = MEMORY_SLAB_NO_CLASS;
+
+  if ((memory == 0) || (memory->context == 0) || (buffer == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if (buffer_size == 0) {
+    error = OCKAM_MEMORY_ERROR_INVALID_SIZE;
+    goto exit;
+  }
+
+  p_slab = (memory_slab_t*) memory->context;
+
+  if (buffer_size <= OCKAM_MEMORY_SLAB_MAX_CLASS_SIZE) {
+    index = p_slab->lookup[(buffer_size + MEMORY_SLAB_ALIGN - 1u) / MEMORY_SLAB_ALIGN];
+  }
+
+  if (index == MEMORY_SLAB_NO_CLASS) {
+    error = ockam_memory_alloc_zeroed(p_slab->p_memory, buffer, buffer_size);
+    if (error) goto exit;
+    p_slab->bytes_reserved += buffer_size;
+    p_slab->bytes_allocated += buffer_size;
+    goto exit;
+  }
+
+  p_class = &p_slab->classes[index];
+
+  if (p_class->free_list != 0) {
+    *buffer            = p_class->free_list;
+    p_class->free_list = *(void**) p_class->free_list;
+  } else {
+    if ((size_t)(p_class->end - p_class->next) < p_class->size) {
+      error = ockam_memory_alloc_zeroed(p_slab->p_memory, (void**) &p_new, p_slab->slab_size);
+      if (error) goto exit;
+
+      *(void**) p_new = p_slab->slabs;
+      p_slab->slabs   = p_new;
+      p_slab->bytes_reserved += p_slab->slab_size;
+
+      p_class->next = p_new + MEMORY_SLAB_HEADER_SIZE;
+      p_class->end  = p_new + p_slab->slab_size;
+    }
+
+    *buffer = p_class->next;
+    p_class->next += p_class->size;
+  }
+
+  memset(*buffer, 0, buffer_size);
+  p_slab->bytes_allocated += buffer_size;
+
+exit:
+  return error;
+}
+
+ockam_error_t memory_slab_free(ockam_memory_t* memory, void* buffer, size_t buffer_size)
+{
+  ockam_error_t        error   = OCKAM_ERROR_NONE;
+  memory_slab_t*       p_slab  = 0;
+  memory_slab_class_t* p_class = 0;
+  size_t               index   = MEMORY_SLAB_NO_CLASS;
+
+  if ((memory == 0) || (memory->context == 0) || (buffer == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if (buffer_size == 0) {
+    error = OCKAM_MEMORY_ERROR_INVALID_SIZE;
+    goto exit;
+  }
+
+  p_slab = (memory_slab_t*) memory->context;
+
+  if (buffer_size <= OCKAM_MEMORY_SLAB_MAX_CLASS_SIZE) {
+    index = p_slab->lookup[(buffer_size + MEMORY_SLAB_ALIGN - 1u) / MEMORY_SLAB_ALIGN];
+  }
+
+  if (index == MEMORY_SLAB_NO_CLASS) {
+    error = ockam_memory_free(p_slab->p_memory, buffer, buffer_size);
+    if (error) goto exit;
+    p_slab->bytes_reserved -= buffer_size;
+  } else {
+    p_class            = &p_slab->classes[index];
+    *(void**) buffer   = p_class->free_list;
+    p_class->free_list = buffer;
+  }
+
+  p_slab->bytes_allocated -= buffer_size;
+
+exit:
+  return error;
+}
+
+ockam_error_t memory_slab_set(ockam_memory_t* memory, void* buffer, uint8_t value, size_t set_size)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((memory == 0) || (memory->context == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  error = ockam_memory_set(((memory_slab_t*) memory->context)->p_memory, buffer, value, set_size);
+
+exit:
+  return error;
+}
+
+ockam_error_t memory_slab_copy(ockam_memory_t* memory, void* destination, const void* source, size_t copy_size)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((memory == 0) || (memory->context == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  error = ockam_memory_copy(((memory_slab_t*) memory->context)->p_memory, destination, source, copy_size);
+
+exit:
+  return error;
+}
+
+ockam_error_t memory_slab_move(ockam_memory_t* memory, void* destination, void* source, size_t move_size)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((memory == 0) || (memory->context == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  error = ockam_memory_move(((memory_slab_t*) memory->context)->p_memory, destination, source, move_size);
+
+exit:
+  return error;
+}
+
+ockam_error_t memory_slab_compare(ockam_memory_t* memory, int* res, const void* lhs, const void* rhs, size_t buffer_size)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((memory == 0) || (memory->context == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  error = ockam_memory_compare(((memory_slab_t*) memory->context)->p_memory, res, lhs, rhs, buffer_size);
+
+exit:
+  return error;
+}
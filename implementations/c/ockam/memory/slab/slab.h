@@ -0,0 +1,61 @@
+/**
+ * @file  slab.h
+ * @brief Slab memory with per-size free lists
+ */
+
+#ifndef OCKAM_MEMORY_SLAB_H_
+#define OCKAM_MEMORY_SLAB_H_
+
+#include "ockam/error.h"
+#include "ockam/memory.h"
+
+#include "ockam/memory/impl.h"
+
+/* Most size classes a slab memory object can have */
+#define OCKAM_MEMORY_SLAB_MAX_CLASSES 16u
+
+/* Largest size class, larger requests always go to the backing memory */
+#define OCKAM_MEMORY_SLAB_MAX_CLASS_SIZE 4096u
+
+/* Size of each slab carved into objects when p_attributes->slab_size is 0 */
+#define OCKAM_MEMORY_SLAB_DEFAULT_SLAB_SIZE (64u * 1024u)
+
+typedef struct {
+  ockam_memory_t* p_memory;    /*!< Backing memory for slabs, requests above the largest class, and set/copy/move */
+  size_t          slab_size;   /*!< Bytes requested from p_memory per slab, 0 means 64KiB */
+  const size_t*   class_sizes; /*!< Ascending object sizes, NULL means 16, 32, 64 ... 2048 bytes */
+  size_t          class_count; /*!< Entries in class_sizes, at most OCKAM_MEMORY_SLAB_MAX_CLASSES */
+} ockam_memory_slab_attributes_t;
+
+typedef struct {
+  size_t bytes_allocated; /*!< Bytes currently allocated, as requested by callers */
+  size_t bytes_reserved;  /*!< Bytes currently held from the backing memory */
+} ockam_memory_slab_stats_t;
+
+/**
+ * @brief   Initialize a slab memory object.
+ *
+ * Each request is rounded up to the smallest size class that fits it and served from that class's free list, or
+ * carved from a slab when the list is empty. Freed objects go back on their class's list and are never returned to
+ * the backing memory before ockam_memory_deinit, which releases every slab at once. The size passed to
+ * ockam_memory_free selects the class, so it must match the size passed to ockam_memory_alloc_zeroed.
+ *
+ * A slab memory object is not thread-safe, use one per thread or guard it externally.
+ * @param   memory[out]       The ockam memory object to initialize.
+ * @param   p_attributes[in]  Slab attributes. Class sizes are rounded up to multiples of 16 bytes.
+ * @return  OCKAM_ERROR_NONE on success.
+ * @return  OCKAM_MEMORY_ERROR_INVALID_PARAM if memory, p_attributes or p_attributes->p_memory is invalid.
+ * @return  OCKAM_MEMORY_ERROR_INVALID_SIZE if the class sizes are not ascending or exceed the limits above.
+ */
+ockam_error_t ockam_memory_slab_init(ockam_memory_t* memory, ockam_memory_slab_attributes_t* p_attributes);
+
+/**
+ * @brief   Report how much memory a slab memory object is using.
+ * @param   memory[in]   A slab memory object.
+ * @param   p_stats[out] The current usage.
+ * @return  OCKAM_ERROR_NONE on success.
+ * @return  OCKAM_MEMORY_ERROR_INVALID_PARAM if memory is not a slab memory object or p_stats is NULL.
+ */
+ockam_error_t ockam_memory_slab_stats(ockam_memory_t* memory, ockam_memory_slab_stats_t* p_stats);
+
+#endif
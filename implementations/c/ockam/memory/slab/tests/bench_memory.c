@@ -0,0 +1,223 @@
+/**
+ * @file    bench_memory.c
+ * @brief   Allocation rate and fragmentation of the memory backends
+ *
+ * The connection workload allocates the objects a secure channel connection holds (readers, writers, socket state,
+ * secret contexts and buffers), touches them, and releases them, over and over. stdlib and slab free each object,
+ * arena resets once per connection. The churn workload keeps a pool of live objects of random sizes and frees or
+ * allocates a random slot at each step, then reports how much memory each backend holds per byte still allocated.
+ *
+ * Usage: ockam_memory_bench [connections] [churn_steps]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "ockam/error.h"
+#include "ockam/memory.h"
+
+#include "ockam/memory/arena.h"
+#include "ockam/memory/slab.h"
+#include "ockam/memory/stdlib.h"
+
+#define BENCH_DEFAULT_CONNECTIONS 200000u
+#define BENCH_DEFAULT_STEPS       1000000u
+#define BENCH_CHURN_SLOTS         10000u
+#define BENCH_CHURN_MAX_SIZE      512u
+
+typedef enum { BENCH_STDLIB = 0, BENCH_SLAB, BENCH_ARENA, BENCH_BACKENDS } bench_backend_t;
+
+static const char*  g_bench_names[BENCH_BACKENDS] = { "stdlib", "slab", "arena" };
+static const size_t g_bench_connection[]          = { 24, 24, 48, 160, 96, 96, 256, 2048 };
+
+#define BENCH_CONNECTION_OBJECTS (sizeof(g_bench_connection) / sizeof(g_bench_connection[0]))
+
+typedef struct {
+  void*  buffer;
+  size_t size;
+} bench_slot_t;
+
+static uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec * 1000000000u) + (uint64_t) ts.tv_nsec;
+}
+
+static uint32_t bench_rand(uint32_t* p_state)
+{
+  *p_state ^= *p_state << 13u;
+  *p_state ^= *p_state >> 17u;
+  *p_state ^= *p_state << 5u;
+  return *p_state;
+}
+
+/**
+ * @brief   Bytes the backend holds from its backing memory, for stdlib what malloc holds from the system.
+ */
+static size_t bench_reserved(bench_backend_t backend, ockam_memory_t* p_memory)
+{
+  ockam_memory_slab_stats_t  slab_stats  = { 0 };
+  ockam_memory_arena_stats_t arena_stats = { 0 };
+
+  switch (backend) {
+  case BENCH_SLAB:
+    ockam_memory_slab_stats(p_memory, &slab_stats);
+    return slab_stats.bytes_reserved;
+  case BENCH_ARENA:
+    ockam_memory_arena_stats(p_memory, &arena_stats);
+    return arena_stats.bytes_reserved;
+  default:
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 33))
+  {
+    struct mallinfo2 info = mallinfo2();
+    return info.arena + info.hblkhd;
+  }
+#else
+    return 0;
+#endif
+  }
+}
+
+static ockam_error_t bench_init(bench_backend_t backend, ockam_memory_t* p_backing, ockam_memory_t* p_memory)
+{
+  ockam_memory_slab_attributes_t  slab_attributes  = { .p_memory = p_backing };
+  ockam_memory_arena_attributes_t arena_attributes = { .p_memory = p_backing };
+
+  switch (backend) {
+  case BENCH_SLAB:
+    return ockam_memory_slab_init(p_memory, &slab_attributes);
+  case BENCH_ARENA:
+    return ockam_memory_arena_init(p_memory, &arena_attributes);
+  default:
+    return ockam_memory_stdlib_init(p_memory);
+  }
+}
+
+static ockam_error_t bench_connections(bench_backend_t backend, ockam_memory_t* p_memory, size_t connections)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+  void*         objects[BENCH_CONNECTION_OBJECTS];
+  uint64_t      start = bench_now_ns();
+  size_t        c     = 0;
+  size_t        i     = 0;
+
+  for (c = 0; c < connections; c++) {
+    for (i = 0; i < BENCH_CONNECTION_OBJECTS; i++) {
+      error = ockam_memory_alloc_zeroed(p_memory, &objects[i], g_bench_connection[i]);
+      if (error) goto exit;
+      *(volatile uint8_t*) objects[i] = (uint8_t) c;
+    }
+
+    if (backend == BENCH_ARENA) {
+      error = ockam_memory_arena_reset(p_memory);
+      if (error) goto exit;
+    } else {
+      for (i = BENCH_CONNECTION_OBJECTS; i > 0; i--) {
+        error = ockam_memory_free(p_memory, objects[i - 1], g_bench_connection[i - 1]);
+        if (error) goto exit;
+      }
+    }
+  }
+
+  printf("%-8s connection  %7.2f M allocations/s\n",
+         g_bench_names[backend],
+         (double) (connections * BENCH_CONNECTION_OBJECTS) / ((double) (bench_now_ns() - start) / 1e3));
+
+exit:
+  return error;
+}
+
+static ockam_error_t bench_churn(bench_backend_t backend, ockam_memory_t* p_memory, size_t steps)
+{
+  ockam_error_t error    = OCKAM_ERROR_NONE;
+  bench_slot_t* slots    = calloc(BENCH_CHURN_SLOTS, sizeof(bench_slot_t));
+  uint32_t      seed     = 0x12345678u;
+  size_t        live     = 0;
+  size_t        reserved = 0;
+  size_t        base     = bench_reserved(backend, p_memory);
+  uint64_t      start    = 0;
+  size_t        i        = 0;
+
+  if (0 == slots) {
+    error = OCKAM_MEMORY_ERROR_ALLOC_FAIL;
+    goto exit;
+  }
+
+  start = bench_now_ns();
+  for (i = 0; i < steps; i++) {
+    bench_slot_t* p_slot = &slots[bench_rand(&seed) % BENCH_CHURN_SLOTS];
+
+    if (p_slot->buffer != 0) {
+      error = ockam_memory_free(p_memory, p_slot->buffer, p_slot->size);
+      if (error) goto exit;
+      live -= p_slot->size;
+      p_slot->buffer = 0;
+    } else {
+      p_slot->size = 1 + (bench_rand(&seed) % BENCH_CHURN_MAX_SIZE);
+      error        = ockam_memory_alloc_zeroed(p_memory, &p_slot->buffer, p_slot->size);
+      if (error) goto exit;
+      live += p_slot->size;
+    }
+  }
+
+  reserved = bench_reserved(backend, p_memory) - base;
+  printf("%-8s churn       %7.2f M operations/s, %zu KiB live, %zu KiB held, %.2f bytes held per live byte\n",
+         g_bench_names[backend],
+         (double) steps / ((double) (bench_now_ns() - start) / 1e3),
+         live / 1024,
+         reserved / 1024,
+         (double) reserved / (double) live);
+
+exit:
+  if (slots != 0) {
+    for (i = 0; i < BENCH_CHURN_SLOTS; i++) {
+      if (slots[i].buffer != 0) ockam_memory_free(p_memory, slots[i].buffer, slots[i].size);
+    }
+  }
+  free(slots);
+  return error;
+}
+
+int main(int argc, char* argv[])
+{
+  ockam_error_t  error       = OCKAM_ERROR_NONE;
+  ockam_memory_t backing     = { 0 };
+  ockam_memory_t memory      = { 0 };
+  size_t         connections = BENCH_DEFAULT_CONNECTIONS;
+  size_t         steps       = BENCH_DEFAULT_STEPS;
+  size_t         backend     = 0;
+  int            rc          = 0;
+
+  if (argc > 1) connections = strtoul(argv[1], 0, 10);
+  if (argc > 2) steps = strtoul(argv[2], 0, 10);
+
+  ockam_memory_stdlib_init(&backing);
+
+  for (backend = 0; backend < BENCH_BACKENDS; backend++) {
+    error = bench_init((bench_backend_t) backend, &backing, &memory);
+    if (error) goto exit;
+
+    error = bench_connections((bench_backend_t) backend, &memory, connections);
+    if (error) goto exit;
+
+    error = bench_churn((bench_backend_t) backend, &memory, steps);
+    if (error) goto exit;
+
+    ockam_memory_deinit(&memory);
+  }
+
+exit:
+  if (error) {
+    printf("%s failed: %x\n", g_bench_names[backend], error);
+    rc = -1;
+  }
+  return rc;
+}
@@ -0,0 +1,140 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <string.h>
+#include "ockam/memory.h"
+#include "ockam/memory/slab.h"
+#include "ockam/memory/stdlib.h"
+
+#define TEST_OBJECT_COUNT 1000
+
+typedef struct {
+  ockam_memory_t backing;
+  ockam_memory_t slab;
+} test_state_t;
+
+static int test_setup(void** state)
+{
+  static test_state_t            test_state;
+  ockam_memory_slab_attributes_t attributes = { 0 };
+
+  ockam_error_t error = ockam_memory_stdlib_init(&test_state.backing);
+  assert_int_equal(error, OCKAM_ERROR_NONE);
+
+  attributes.p_memory  = &test_state.backing;
+  attributes.slab_size = 4096;
+  error                = ockam_memory_slab_init(&test_state.slab, &attributes);
+  assert_int_equal(error, OCKAM_ERROR_NONE);
+
+  *state = &test_state;
+
+  return 0;
+}
+
+static int test_teardown(void** state)
+{
+  test_state_t* test_state = *state;
+
+  ockam_memory_deinit(&test_state->slab);
+  ockam_memory_deinit(&test_state->backing);
+
+  return 0;
+}
+
+static void memory_slab__invalid_classes__should_return_error(void** state)
+{
+  ockam_memory_t                 backing     = { 0 };
+  ockam_memory_t                 slab        = { 0 };
+  ockam_memory_slab_attributes_t attributes  = { 0 };
+  size_t                         unordered[] = { 64, 32 };
+  size_t                         too_large[] = { 64, OCKAM_MEMORY_SLAB_MAX_CLASS_SIZE + 1 };
+
+  (void) state;
+
+  assert_int_equal(ockam_memory_slab_init(&slab, &attributes), OCKAM_MEMORY_ERROR_INVALID_PARAM);
+
+  ockam_memory_stdlib_init(&backing);
+  attributes.p_memory    = &backing;
+  attributes.class_sizes = unordered;
+  attributes.class_count = 2;
+  assert_int_equal(ockam_memory_slab_init(&slab, &attributes), OCKAM_MEMORY_ERROR_INVALID_SIZE);
+
+  attributes.class_sizes = too_large;
+  assert_int_equal(ockam_memory_slab_init(&slab, &attributes), OCKAM_MEMORY_ERROR_INVALID_SIZE);
+}
+
+static void memory_slab__free_then_alloc__should_reuse_zeroed_object(void** state)
+{
+  test_state_t* test_state = *state;
+  uint8_t*      p_first    = NULL;
+  uint8_t*      p_second   = NULL;
+  uint8_t       zero[40]   = { 0 };
+
+  assert_int_equal(ockam_memory_alloc_zeroed(&test_state->slab, (void**) &p_first, 40), OCKAM_ERROR_NONE);
+  memset(p_first, 0xA5, 40);
+  assert_int_equal(ockam_memory_free(&test_state->slab, p_first, 40), OCKAM_ERROR_NONE);
+
+  // 33..48 bytes share the 64 byte class
+  assert_int_equal(ockam_memory_alloc_zeroed(&test_state->slab, (void**) &p_second, 40), OCKAM_ERROR_NONE);
+  assert_ptr_equal(p_first, p_second);
+  assert_memory_equal(p_second, zero, sizeof(zero));
+  assert_int_equal(ockam_memory_free(&test_state->slab, p_second, 40), OCKAM_ERROR_NONE);
+}
+
+static void memory_slab__many_objects__should_be_distinct_and_aligned(void** state)
+{
+  test_state_t*             test_state = *state;
+  uint8_t*                  objects[TEST_OBJECT_COUNT];
+  ockam_memory_slab_stats_t stats = { 0 };
+  size_t                    i     = 0;
+
+  for (i = 0; i < TEST_OBJECT_COUNT; i++) {
+    assert_int_equal(ockam_memory_alloc_zeroed(&test_state->slab, (void**) &objects[i], 100), OCKAM_ERROR_NONE);
+    assert_int_equal((uintptr_t) objects[i] % 16, 0);
+    memset(objects[i], (int) i, 100);
+  }
+
+  for (i = 0; i < TEST_OBJECT_COUNT; i++) { assert_int_equal(objects[i][99], (uint8_t) i); }
+
+  assert_int_equal(ockam_memory_slab_stats(&test_state->slab, &stats), OCKAM_ERROR_NONE);
+  assert_int_equal(stats.bytes_allocated, TEST_OBJECT_COUNT * 100);
+  assert_true(stats.bytes_reserved >= TEST_OBJECT_COUNT * 128);
+
+  for (i = 0; i < TEST_OBJECT_COUNT; i++) {
+    assert_int_equal(ockam_memory_free(&test_state->slab, objects[i], 100), OCKAM_ERROR_NONE);
+  }
+
+  assert_int_equal(ockam_memory_slab_stats(&test_state->slab, &stats), OCKAM_ERROR_NONE);
+  assert_int_equal(stats.bytes_allocated, 0);
+}
+
+static void memory_slab__large_request__should_use_backing_memory(void** state)
+{
+  test_state_t*             test_state = *state;
+  ockam_memory_slab_stats_t before     = { 0 };
+  ockam_memory_slab_stats_t after      = { 0 };
+  uint8_t*                  p_large    = NULL;
+
+  assert_int_equal(ockam_memory_slab_stats(&test_state->slab, &before), OCKAM_ERROR_NONE);
+  assert_int_equal(ockam_memory_alloc_zeroed(&test_state->slab, (void**) &p_large, 10000), OCKAM_ERROR_NONE);
+  assert_int_equal(ockam_memory_slab_stats(&test_state->slab, &after), OCKAM_ERROR_NONE);
+  assert_int_equal(after.bytes_reserved - before.bytes_reserved, 10000);
+
+  assert_int_equal(ockam_memory_free(&test_state->slab, p_large, 10000), OCKAM_ERROR_NONE);
+  assert_int_equal(ockam_memory_slab_stats(&test_state->slab, &after), OCKAM_ERROR_NONE);
+  assert_int_equal(after.bytes_reserved, before.bytes_reserved);
+}
+
+int main(void)
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(memory_slab__invalid_classes__should_return_error),
+    cmocka_unit_test_setup_teardown(memory_slab__free_then_alloc__should_reuse_zeroed_object, test_setup, test_teardown),
+    cmocka_unit_test_setup_teardown(memory_slab__many_objects__should_be_distinct_and_aligned, test_setup, test_teardown),
+    cmocka_unit_test_setup_teardown(memory_slab__large_request__should_use_backing_memory, test_setup, test_teardown),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,466 @@
+/**
+ * @file    tcache.c
+ * @brief   impl of Ockam's memory functions with per-thread caches over a shared pool
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ockam/error.h"
+#include "ockam/memory.h"
+
+#include "ockam/memory/tcache.h"
+
+#define MEMORY_TCACHE_MIN_SHIFT         4u
+#define MEMORY_TCACHE_CLASSES           9u
+#define MEMORY_TCACHE_CHUNK_HEADER_SIZE 16u
+
+#define MEMORY_TCACHE_CLASS_SIZE(index) ((size_t) 1u << ((index) + MEMORY_TCACHE_MIN_SHIFT))
+
+#define MEMORY_TCACHE_NEXT(block) (*(void**) (block))
+
+typedef struct {
+  void*  head;
+  size_t count;
+} memory_tcache_bin_t;
+
+typedef struct {
+  pthread_mutex_t lock;
+  void*           head;
+  size_t          count;
+} memory_tcache_pool_t;
+
+struct memory_tcache_t;
+
+typedef struct memory_tcache_thread_t {
+  struct memory_tcache_t*        p_tcache;
+  struct memory_tcache_thread_t* prev;
+  struct memory_tcache_thread_t* next;
+  memory_tcache_bin_t            bins[MEMORY_TCACHE_CLASSES];
+} memory_tcache_thread_t;
+
+typedef struct memory_tcache_t {
+  ockam_memory_t*        p_memory;
+  size_t                 cache_size;
+  size_t                 batch;
+  size_t                 chunk_size;
+  pthread_key_t          key;
+  pthread_mutex_t        lock;
+  memory_tcache_thread_t threads;
+  void*                  chunks;
+  memory_tcache_pool_t   pools[MEMORY_TCACHE_CLASSES];
+} memory_tcache_t;
+
+ockam_error_t memory_tcache_deinit(ockam_memory_t* memory);
+ockam_error_t memory_tcache_alloc_zeroed(ockam_memory_t* memory, void** buffer, size_t buffer_size);
+ockam_error_t memory_tcache_free(ockam_memory_t* memory, void* buffer, size_t buffer_size);
+ockam_error_t memory_tcache_set(ockam_memory_t* memory, void* buffer, uint8_t value, size_t set_size);
+ockam_error_t memory_tcache_copy(ockam_memory_t* memory, void* destination, const void* source, size_t copy_size);
+ockam_error_t memory_tcache_move(ockam_memory_t* memory, void* destination, void* source, size_t move_size);
+ockam_error_t
+memory_tcache_compare(ockam_memory_t* memory, int* res, const void* lhs, const void* rhs, size_t buffer_size);
+
+ockam_memory_dispatch_table_t memory_tcache_dispatch_table = { &memory_tcache_deinit, &memory_tcache_alloc_zeroed,
+                                                               &memory_tcache_free,   &memory_tcache_set,
+                                                               &memory_tcache_copy,   &memory_tcache_move,
+                                                               &memory_tcache_compare };
+
+/**
+ * @brief   Size class for a request, computed from the size alone: the smallest power of two of at least 16 bytes.
+ */
+static size_t memory_tcache_class(size_t buffer_size)
+{
+  size_t index = 0;
+
+  if (buffer_size <= MEMORY_TCACHE_CLASS_SIZE(0)) { return 0; }
+
+#if defined(__GNUC__)
+  index = (sizeof(unsigned long) * 8u) - (size_t) __builtin_clzl((unsigned long) (buffer_size - 1u));
+#else
+  while (((size_t) 1u << index) < buffer_size) index++;
+#endif
+
+  return index - MEMORY_TCACHE_MIN_SHIFT;
+}
+
+/**
+ * @brief   Move the first count blocks of a thread's bin to the shared pool.
+ */
+static void memory_tcache_release(memory_tcache_t* p_tcache, memory_tcache_bin_t* p_bin, size_t index, size_t count)
+{
+  memory_tcache_pool_t* p_pool = &p_tcache->pools[index];
+  void*                 p_head = p_bin->head;
+  void*                 p_tail = p_head;
+  size_t                i      = 0;
+
+  if (count == 0) return;
+
+  for (i = 1; i < count; i++) p_tail = MEMORY_TCACHE_NEXT(p_tail);
+
+  p_bin->head = MEMORY_TCACHE_NEXT(p_tail);
+  p_bin->count -= count;
+
+  pthread_mutex_lock(&p_pool->lock);
+  MEMORY_TCACHE_NEXT(p_tail) = p_pool->head;
+  p_pool->head               = p_head;
+  p_pool->count += count;
+  pthread_mutex_unlock(&p_pool->lock);
+}
+
+/**
+ * @brief   Fill an empty bin from the shared pool, or from a new chunk when the pool is empty too.
+ */
+static ockam_error_t memory_tcache_refill(memory_tcache_t* p_tcache, memory_tcache_bin_t* p_bin, size_t index)
+{
+  ockam_error_t         error   = OCKAM_ERROR_NONE;
+  memory_tcache_pool_t* p_pool  = &p_tcache->pools[index];
+  size_t                size    = MEMORY_TCACHE_CLASS_SIZE(index);
+  uint8_t*              p_chunk = 0;
+  uint8_t*              p_block = 0;
+  void*                 p_tail  = 0;
+  size_t                count   = 0;
+  size_t                i       = 0;
+
+  pthread_mutex_lock(&p_pool->lock);
+  if (p_pool->count > 0) {
+    count  = (p_pool->count < p_tcache->batch) ? p_pool->count : p_tcache->batch;
+    p_tail = p_pool->head;
+    for (i = 1; i < count; i++) p_tail = MEMORY_TCACHE_NEXT(p_tail);
+
+    p_bin->head  = p_pool->head;
+    p_bin->count = count;
+    p_pool->head = MEMORY_TCACHE_NEXT(p_tail);
+    p_pool->count -= count;
+    MEMORY_TCACHE_NEXT(p_tail) = 0;
+  }
+  pthread_mutex_unlock(&p_pool->lock);
+
+  if (count > 0) goto exit;
+
+  error = ockam_memory_alloc_zeroed(p_tcache->p_memory, (void**) &p_chunk, p_tcache->chunk_size);
+  if (error) goto exit;
+
+  pthread_mutex_lock(&p_tcache->lock);
+  MEMORY_TCACHE_NEXT(p_chunk) = p_tcache->chunks;
+  p_tcache->chunks            = p_chunk;
+  pthread_mutex_unlock(&p_tcache->lock);
+
+  // Thread the chunk's blocks into a list, the first batch goes to this thread and the rest to the pool
+  count   = (p_tcache->chunk_size - MEMORY_TCACHE_CHUNK_HEADER_SIZE) / size;
+  p_block = p_chunk + MEMORY_TCACHE_CHUNK_HEADER_SIZE;
+  for (i = 0; i + 1 < count; i++) MEMORY_TCACHE_NEXT(p_block + (i * size)) = p_block + ((i + 1) * size);
+  MEMORY_TCACHE_NEXT(p_block + ((count - 1) * size)) = 0;
+
+  p_bin->head  = p_block;
+  p_bin->count = count;
+
+  if (count > p_tcache->batch) memory_tcache_release(p_tcache, p_bin, index, count - p_tcache->batch);
+
+exit:
+  return error;
+}
+
+static void memory_tcache_thread_exit(void* arg)
+{
+  memory_tcache_thread_t* p_thread = (memory_tcache_thread_t*) arg;
+  memory_tcache_t*        p_tcache = p_thread->p_tcache;
+  size_t                  index    = 0;
+
+  for (index = 0; index < MEMORY_TCACHE_CLASSES; index++) {
+    memory_tcache_release(p_tcache, &p_thread->bins[index], index, p_thread->bins[index].count);
+  }
+
+  pthread_mutex_lock(&p_tcache->lock);
+  p_thread->prev->next = p_thread->next;
+  p_thread->next->prev = p_thread->prev;
+  pthread_mutex_unlock(&p_tcache->lock);
+
+  ockam_memory_free(p_tcache->p_memory, p_thread, sizeof(memory_tcache_thread_t));
+}
+
+static ockam_error_t memory_tcache_thread(memory_tcache_t* p_tcache, memory_tcache_thread_t** pp_thread)
+{
+  ockam_error_t           error    = OCKAM_ERROR_NONE;
+  memory_tcache_thread_t* p_thread = (memory_tcache_thread_t*) pthread_getspecific(p_tcache->key);
+
+  if (p_thread != 0) goto exit;
+
+  error = ockam_memory_alloc_zeroed(p_tcache->p_memory, (void**) &p_thread, sizeof(memory_tcache_thread_t));
+  if (error) goto exit;
+
+  p_thread->p_tcache = p_tcache;
+
+  pthread_mutex_lock(&p_tcache->lock);
+  p_thread->prev         = &p_tcache->threads;
+  p_thread->next         = p_tcache->threads.next;
+  p_thread->next->prev   = p_thread;
+  p_tcache->threads.next = p_thread;
+  pthread_mutex_unlock(&p_tcache->lock);
+
+  if (0 != pthread_setspecific(p_tcache->key, p_thread)) {
+    memory_tcache_thread_exit(p_thread);
+    p_thread = 0;
+    error    = OCKAM_MEMORY_ERROR_ALLOC_FAIL;
+  }
+
+exit:
+  *pp_thread = p_thread;
+  return error;
+}
+
+ockam_error_t ockam_memory_tcache_init(ockam_memory_t* memory, ockam_memory_tcache_attributes_t* p_attributes)
+{
+  ockam_error_t    error    = OCKAM_ERROR_NONE;
+  memory_tcache_t* p_tcache = 0;
+  size_t           index    = 0;
+
+  if ((memory == 0) || (p_attributes == 0) || (p_attributes->p_memory == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  error = ockam_memory_alloc_zeroed(p_attributes->p_memory, (void**) &p_tcache, sizeof(memory_tcache_t));
+  if (error) goto exit;
+
+  if (0 != pthread_key_create(&p_tcache->key, memory_tcache_thread_exit)) {
+    ockam_memory_free(p_attributes->p_memory, p_tcache, sizeof(memory_tcache_t));
+    error = OCKAM_MEMORY_ERROR_ALLOC_FAIL;
+    goto exit;
+  }
+
+  p_tcache->p_memory   = p_attributes->p_memory;
+  p_tcache->cache_size = p_attributes->cache_size ? p_attributes->cache_size : OCKAM_MEMORY_TCACHE_DEFAULT_CACHE_SIZE;
+  p_tcache->chunk_size = p_attributes->chunk_size ? p_attributes->chunk_size : OCKAM_MEMORY_TCACHE_DEFAULT_CHUNK_SIZE;
+  if (p_tcache->cache_size < 2) p_tcache->cache_size = 2;
+  if (p_tcache->chunk_size < MEMORY_TCACHE_CHUNK_HEADER_SIZE + OCKAM_MEMORY_TCACHE_MAX_CLASS_SIZE) {
+    p_tcache->chunk_size = MEMORY_TCACHE_CHUNK_HEADER_SIZE + OCKAM_MEMORY_TCACHE_MAX_CLASS_SIZE;
+  }
+  p_tcache->batch = p_tcache->cache_size / 2;
+
+  pthread_mutex_init(&p_tcache->lock, 0);
+  for (index = 0; index < MEMORY_TCACHE_CLASSES; index++) pthread_mutex_init(&p_tcache->pools[index].lock, 0);
+
+  p_tcache->threads.prev = &p_tcache->threads;
+  p_tcache->threads.next = &p_tcache->threads;
+
+  memory->dispatch = &memory_tcache_dispatch_table;
+  memory->context  = p_tcache;
+
+exit:
+  return error;
+}
+
+ockam_error_t ockam_memory_tcache_flush(ockam_memory_t* memory)
+{
+  ockam_error_t           error    = OCKAM_ERROR_NONE;
+  memory_tcache_t*        p_tcache = 0;
+  memory_tcache_thread_t* p_thread = 0;
+  size_t                  index    = 0;
+
+  if ((memory == 0) || (memory->dispatch != &memory_tcache_dispatch_table)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  p_tcache = (memory_tcache_t*) memory->context;
+  p_thread = (memory_tcache_thread_t*) pthread_getspecific(p_tcache->key);
+  if (p_thread == 0) goto exit;
+
+  for (index = 0; index < MEMORY_TCACHE_CLASSES; index++) {
+    memory_tcache_release(p_tcache, &p_thread->bins[index], index, p_thread->bins[index].count);
+  }
+
+exit:
+  return error;
+}
+
+ockam_error_t memory_tcache_deinit(ockam_memory_t* memory)
+{
+  ockam_error_t           error    = OCKAM_ERROR_NONE;
+  memory_tcache_t*        p_tcache = 0;
+  memory_tcache_thread_t* p_thread = 0;
+  void*                   p_next   = 0;
+  size_t                  index    = 0;
+
+  if ((memory == 0) || (memory->context == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  p_tcache = (memory_tcache_t*) memory->context;
+
+  // Deleting the key first keeps threads that exit later from touching the freed caches
+  pthread_key_delete(p_tcache->key);
+
+  while (p_tcache->threads.next != &p_tcache->threads) {
+    p_thread               = p_tcache->threads.next;
+    p_tcache->threads.next = p_thread->next;
+    ockam_memory_free(p_tcache->p_memory, p_thread, sizeof(memory_tcache_thread_t));
+  }
+
+  while (p_tcache->chunks != 0) {
+    p_next = MEMORY_TCACHE_NEXT(p_tcache->chunks);
+    ockam_memory_free(p_tcache->p_memory, p_tcache->chunks, p_tcache->chunk_size);
+    p_tcache->chunks = p_next;
+  }
+
+  for (index = 0; index < MEMORY_TCACHE_CLASSES; index++) pthread_mutex_destroy(&p_tcache->pools[index].lock);
+  pthread_mutex_destroy(&p_tcache->lock);
+
+  ockam_memory_free(p_tcache->p_memory, p_tcache, sizeof(memory_tcache_t));
+
+  memory->dispatch = 0;
+  memory->context  = 0;
+
+exit:
+  return error;
+}
+
+ockam_error_t memory_tcache_alloc_zeroed(ockam_memory_t* memory, void** buffer, size_t buffer_size)
+{
+  ockam_error_t           error    = OCKAM_ERROR_NONE;
+  memory_tcache_t*        p_tcache = 0;
+  memory_tcache_thread_t* p_thread = 0;
+  memory_tcache_bin_t*    p_bin    = 0;
+  size_t                  index    = 0;
+
+  if ((memory == 0) || (memory->context == 0) || (buffer == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if (buffer_size == 0) {
+    error = OCKAM_MEMORY_ERROR_INVALID_SIZE;
+    goto exit;
+  }
+
+  p_tcache = (memory_tcache_t*) memory->context;
+
+  if (buffer_size > OCKAM_MEMORY_TCACHE_MAX_CLASS_SIZE) {
+    error = ockam_memory_alloc_zeroed(p_tcache->p_memory, buffer, buffer_size);
+    goto exit;
+  }
+
+  error = memory_tcache_thread(p_tcache, &p_thread);
+  if (error) goto exit;
+
+  index = memory_tcache_class(buffer_size);
+  p_bin = &p_thread->bins[index];
+
+  if (p_bin->head == 0) {
+    error = memory_tcache_refill(p_tcache, p_bin, index);
+    if (error) goto exit;
+  }
+
+  *buffer     = p_bin->head;
+  p_bin->head = MEMORY_TCACHE_NEXT(p_bin->head);
+  p_bin->count--;
+
+  memset(*buffer, 0, buffer_size);
+
+exit:
+  return error;
+}
+
+ockam_error_t memory_tcache_free(ockam_memory_t* memory, void* buffer, size_t buffer_size)
+{
+  ockam_error_t           error    = OCKAM_ERROR_NONE;
+  memory_tcache_t*        p_tcache = 0;
+  memory_tcache_thread_t* p_thread = 0;
+  memory_tcache_bin_t*    p_bin    = 0;
+  size_t                  index    = 0;
+
+  if ((memory == 0) || (memory->context == 0) || (buffer == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if (buffer_size == 0) {
+    error = OCKAM_MEMORY_ERROR_INVALID_SIZE;
+    goto exit;
+  }
+
+  p_tcache = (memory_tcache_t*) memory->context;
+
+  if (buffer_size > OCKAM_MEMORY_TCACHE_MAX_CLASS_SIZE) {
+    error = ockam_memory_free(p_tcache->p_memory, buffer, buffer_size);
+    goto exit;
+  }
+
+  error = memory_tcache_thread(p_tcache, &p_thread);
+  if (error) goto exit;
+
+  index = memory_tcache_class(buffer_size);
+  p_bin = &p_thread->bins[index];
+
+  MEMORY_TCACHE_NEXT(buffer) = p_bin->head;
+  p_bin->head                = buffer;
+  p_bin->count++;
+
+  if (p_bin->count >= p_tcache->cache_size) memory_tcache_release(p_tcache, p_bin, index, p_tcache->batch);
+
+exit:
+  return error;
+}
+
+ockam_error_t memory_tcache_set(ockam_memory_t* memory, void* buffer, uint8_t value, size_t set_size)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((memory == 0) || (memory->context == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  error = ockam_memory_set(((memory_tcache_t*) memory->context)->p_memory, buffer, value, set_size);
+
+exit:
+  return error;
+}
+
+ockam_error_t memory_tcache_copy(ockam_memory_t* memory, void* destination, const void* source, size_t copy_size)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((memory == 0) || (memory->context == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  error = ockam_memory_copy(((memory_tcache_t*) memory->context)->p_memory, destination, source, copy_size);
+
+exit:
+  return error;
+}
+
+ockam_error_t memory_tcache_move(ockam_memory_t* memory, void* destination, void* source, size_t move_size)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((memory == 0) || (memory->context == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  error = ockam_memory_move(((memory_tcache_t*) memory->context)->p_memory, destination, source, move_size);
+
+exit:
+  return error;
+}
+
+ockam_error_t
+memory_tcache_compare(ockam_memory_t* memory, int* res, const void* lhs, const void* rhs, size_t buffer_size)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((memory == 0) || (memory->context == 0)) {
+    error = OCKAM_MEMORY_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  error = ockam_memory_compare(((memory_tcache_t*) memory->context)->p_memory, res, lhs, rhs, buffer_size);
+
+exit:
+  return error;
+}
@@ -0,0 +1,53 @@
+/**
+ * @file  tcache.h
+ * @brief Memory with per-thread caches of freed blocks
+ */
+
+#ifndef OCKAM_MEMORY_TCACHE_H_
+#define OCKAM_MEMORY_TCACHE_H_
+
+#include "ockam/error.h"
+#include "ockam/memory.h"
+
+#include "ockam/memory/impl.h"
+
+/* Size classes are the powers of two from 16 bytes to OCKAM_MEMORY_TCACHE_MAX_CLASS_SIZE */
+#define OCKAM_MEMORY_TCACHE_MAX_CLASS_SIZE 4096u
+
+#define OCKAM_MEMORY_TCACHE_DEFAULT_CACHE_SIZE 64u
+#define OCKAM_MEMORY_TCACHE_DEFAULT_CHUNK_SIZE (64u * 1024u)
+
+typedef struct {
+  ockam_memory_t* p_memory;   /*!< Thread-safe backing memory for chunks and requests above the largest class */
+  size_t          cache_size; /*!< Blocks a thread keeps per size class before returning half, 0 means 64 */
+  size_t          chunk_size; /*!< Bytes requested from p_memory when a size class runs dry, 0 means 64KiB */
+} ockam_memory_tcache_attributes_t;
+
+/**
+ * @brief   Initialize a thread-caching memory object.
+ *
+ * Each thread that uses the object gets its own cache of free blocks for every size class, so allocating and freeing
+ * on one thread takes no locks. When a thread's cache for a class holds cache_size blocks, half of them go back to a
+ * shared pool, and a thread with an empty cache takes half a cache's worth from the pool or, if the pool is empty too,
+ * carves a new chunk. A block may be freed on any thread. The size class comes from the buffer_size given to
+ * ockam_memory_free, which therefore must match the size given to ockam_memory_alloc_zeroed.
+ *
+ * A thread's cache is returned to the pool when the thread exits. ockam_memory_deinit releases every chunk, and must
+ * only be called once no thread is using the object.
+ * @param   memory[out]       The ockam memory object to initialize.
+ * @param   p_attributes[in]  Thread cache attributes.
+ * @return  OCKAM_ERROR_NONE on success.
+ * @return  OCKAM_MEMORY_ERROR_INVALID_PARAM if memory, p_attributes or p_attributes->p_memory is invalid.
+ * @return  OCKAM_MEMORY_ERROR_ALLOC_FAIL if the object's state could not be created.
+ */
+ockam_error_t ockam_memory_tcache_init(ockam_memory_t* memory, ockam_memory_tcache_attributes_t* p_attributes);
+
+/**
+ * @brief   Return every block cached by the calling thread to the shared pool.
+ * @param   memory[in]  A thread-caching memory object.
+ * @return  OCKAM_ERROR_NONE on success.
+ * @return  OCKAM_MEMORY_ERROR_INVALID_PARAM if memory is not a thread-caching memory object.
+ */
+ockam_error_t ockam_memory_tcache_flush(ockam_memory_t* memory);
+
+#endif
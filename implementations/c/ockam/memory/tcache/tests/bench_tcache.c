@@ -0,0 +1,210 @@
+/**
+ * @file    bench_tcache.c
+ * @brief   Allocator throughput from 1 to 32 threads
+ *
+ * Every thread keeps a small set of live objects with sizes typical of channel and transport state, and at each step
+ * frees one at random and allocates a replacement. Three backends are compared: stdlib, a slab shared by all threads
+ * behind one mutex (the single shared backend a multi-threaded application would otherwise need), and the thread
+ * cache over stdlib.
+ *
+ * Usage: ockam_memory_tcache_bench [max_threads] [operations_per_thread]
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "ockam/error.h"
+#include "ockam/memory.h"
+
+#include "ockam/memory/slab.h"
+#include "ockam/memory/stdlib.h"
+#include "ockam/memory/tcache.h"
+
+#define BENCH_DEFAULT_MAX_THREADS 32u
+#define BENCH_DEFAULT_OPERATIONS  1000000u
+#define BENCH_MAX_THREADS         256u
+#define BENCH_SLOTS               64u
+
+typedef enum { BENCH_STDLIB = 0, BENCH_LOCKED_SLAB, BENCH_TCACHE, BENCH_BACKENDS } bench_backend_t;
+
+static const char*  g_bench_names[BENCH_BACKENDS] = { "stdlib", "locked slab", "tcache" };
+static const size_t g_bench_sizes[]              = { 24, 24, 48, 96, 96, 160, 256, 1024 };
+
+typedef struct {
+  ockam_memory_t* p_memory;
+  size_t          operations;
+  uint32_t        seed;
+  ockam_error_t   error;
+} bench_thread_t;
+
+/* A slab shared by every thread, each allocation and free under one lock */
+static ockam_memory_t  g_slab;
+static pthread_mutex_t g_slab_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static ockam_error_t bench_locked_deinit(ockam_memory_t* memory)
+{
+  return ockam_memory_deinit(&g_slab);
+}
+
+static ockam_error_t bench_locked_alloc_zeroed(ockam_memory_t* memory, void** buffer, size_t buffer_size)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  pthread_mutex_lock(&g_slab_lock);
+  error = ockam_memory_alloc_zeroed(&g_slab, buffer, buffer_size);
+  pthread_mutex_unlock(&g_slab_lock);
+
+  return error;
+}
+
+static ockam_error_t bench_locked_free(ockam_memory_t* memory, void* buffer, size_t buffer_size)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  pthread_mutex_lock(&g_slab_lock);
+  error = ockam_memory_free(&g_slab, buffer, buffer_size);
+  pthread_mutex_unlock(&g_slab_lock);
+
+  return error;
+}
+
+static ockam_memory_dispatch_table_t g_bench_locked_dispatch = { &bench_locked_deinit, &bench_locked_alloc_zeroed,
+                                                                 &bench_locked_free };
+
+static uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec * 1000000000u) + (uint64_t) ts.tv_nsec;
+}
+
+static uint32_t bench_rand(uint32_t* p_state)
+{
+  *p_state ^= *p_state << 13u;
+  *p_state ^= *p_state >> 17u;
+  *p_state ^= *p_state << 5u;
+  return *p_state;
+}
+
+static void* bench_thread(void* arg)
+{
+  bench_thread_t* p_thread = (bench_thread_t*) arg;
+  void*           objects[BENCH_SLOTS];
+  size_t          sizes[BENCH_SLOTS];
+  size_t          slot = 0;
+  size_t          i    = 0;
+
+  for (slot = 0; slot < BENCH_SLOTS; slot++) {
+    sizes[slot]     = g_bench_sizes[slot % (sizeof(g_bench_sizes) / sizeof(g_bench_sizes[0]))];
+    p_thread->error = ockam_memory_alloc_zeroed(p_thread->p_memory, &objects[slot], sizes[slot]);
+    if (p_thread->error) return NULL;
+  }
+
+  for (i = 0; i < p_thread->operations; i++) {
+    slot            = bench_rand(&p_thread->seed) % BENCH_SLOTS;
+    p_thread->error = ockam_memory_free(p_thread->p_memory, objects[slot], sizes[slot]);
+    if (p_thread->error) return NULL;
+
+    sizes[slot]     = g_bench_sizes[bench_rand(&p_thread->seed) % (sizeof(g_bench_sizes) / sizeof(g_bench_sizes[0]))];
+    p_thread->error = ockam_memory_alloc_zeroed(p_thread->p_memory, &objects[slot], sizes[slot]);
+    if (p_thread->error) return NULL;
+  }
+
+  for (slot = 0; slot < BENCH_SLOTS; slot++) ockam_memory_free(p_thread->p_memory, objects[slot], sizes[slot]);
+
+  return NULL;
+}
+
+static ockam_error_t bench_init(bench_backend_t backend, ockam_memory_t* p_backing, ockam_memory_t* p_memory)
+{
+  ockam_error_t                    error             = OCKAM_ERROR_NONE;
+  ockam_memory_slab_attributes_t   slab_attributes   = { .p_memory = p_backing };
+  ockam_memory_tcache_attributes_t tcache_attributes = { .p_memory = p_backing };
+
+  switch (backend) {
+  case BENCH_LOCKED_SLAB:
+    error = ockam_memory_slab_init(&g_slab, &slab_attributes);
+    if (error) break;
+    p_memory->dispatch = &g_bench_locked_dispatch;
+    p_memory->context  = &g_slab;
+    break;
+  case BENCH_TCACHE:
+    error = ockam_memory_tcache_init(p_memory, &tcache_attributes);
+    break;
+  default:
+    error = ockam_memory_stdlib_init(p_memory);
+    break;
+  }
+
+  return error;
+}
+
+int main(int argc, char* argv[])
+{
+  static bench_thread_t threads[BENCH_MAX_THREADS];
+  static pthread_t      ids[BENCH_MAX_THREADS];
+  ockam_memory_t        backing     = { 0 };
+  ockam_memory_t        memory      = { 0 };
+  size_t                max_threads = BENCH_DEFAULT_MAX_THREADS;
+  size_t                operations  = BENCH_DEFAULT_OPERATIONS;
+  size_t                count       = 0;
+  size_t                backend     = 0;
+  size_t                t           = 0;
+  uint64_t              start       = 0;
+  int                   rc          = 0;
+
+  if (argc > 1) max_threads = strtoul(argv[1], 0, 10);
+  if (argc > 2) operations = strtoul(argv[2], 0, 10);
+  if ((max_threads == 0) || (max_threads > BENCH_MAX_THREADS) || (operations == 0)) {
+    printf("Usage: %s [max_threads <= %u] [operations_per_thread]\n", argv[0], BENCH_MAX_THREADS);
+    return -1;
+  }
+
+  ockam_memory_stdlib_init(&backing);
+
+  printf("%zu free+alloc pairs per thread, M pairs/s across all threads\n", operations);
+  printf("%-8s", "threads");
+  for (backend = 0; backend < BENCH_BACKENDS; backend++) printf("%14s", g_bench_names[backend]);
+  printf("\n");
+
+  for (count = 1; count <= max_threads; count *= 2) {
+    printf("%-8zu", count);
+    for (backend = 0; backend < BENCH_BACKENDS; backend++) {
+      int failed = 0;
+
+      if (bench_init((bench_backend_t) backend, &backing, &memory)) {
+        printf("%14s", "failed");
+        rc = -1;
+        continue;
+      }
+
+      start = bench_now_ns();
+      for (t = 0; t < count; t++) {
+        threads[t].p_memory   = &memory;
+        threads[t].operations = operations;
+        threads[t].seed       = 0x9E3779B9u * (uint32_t)(t + 1);
+        threads[t].error      = OCKAM_ERROR_NONE;
+        pthread_create(&ids[t], NULL, bench_thread, &threads[t]);
+      }
+      for (t = 0; t < count; t++) {
+        pthread_join(ids[t], NULL);
+        if (threads[t].error) failed = 1;
+      }
+
+      if (failed) {
+        printf("%14s", "failed");
+        rc = -1;
+      } else {
+        printf("%14.2f", (double) (count * operations) / ((double) (bench_now_ns() - start) / 1e3));
+      }
+
+      ockam_memory_deinit(&memory);
+    }
+    printf("\n");
+  }
+
+  return rc;
+}
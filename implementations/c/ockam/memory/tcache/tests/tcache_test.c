@@ -0,0 +1,170 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include "ockam/memory.h"
+#include "ockam/memory/stdlib.h"
+#include "ockam/memory/tcache.h"
+
+#define TEST_THREADS    4
+#define TEST_OBJECTS    2000
+#define TEST_ROUNDS     20
+#define TEST_CACHE_SIZE 8
+
+typedef struct {
+  ockam_memory_t backing;
+  ockam_memory_t tcache;
+} test_state_t;
+
+typedef struct {
+  ockam_memory_t* p_memory;
+  uint8_t**       objects;
+  size_t          first;
+  int             failed;
+} test_thread_t;
+
+static size_t test_size(size_t i)
+{
+  return 1 + ((i * 37u) % 600u);
+}
+
+static int test_setup(void** state)
+{
+  static test_state_t              test_state;
+  ockam_memory_tcache_attributes_t attributes = { 0 };
+
+  ockam_error_t error = ockam_memory_stdlib_init(&test_state.backing);
+  assert_int_equal(error, OCKAM_ERROR_NONE);
+
+  attributes.p_memory   = &test_state.backing;
+  attributes.cache_size = TEST_CACHE_SIZE;
+  error                 = ockam_memory_tcache_init(&test_state.tcache, &attributes);
+  assert_int_equal(error, OCKAM_ERROR_NONE);
+
+  *state = &test_state;
+
+  return 0;
+}
+
+static int test_teardown(void** state)
+{
+  test_state_t* test_state = *state;
+
+  ockam_memory_deinit(&test_state->tcache);
+  ockam_memory_deinit(&test_state->backing);
+
+  return 0;
+}
+
+static void memory_tcache__free_then_alloc__should_reuse_zeroed_block(void** state)
+{
+  test_state_t* test_state = *state;
+  uint8_t*      p_first    = NULL;
+  uint8_t*      p_second   = NULL;
+  uint8_t       zero[100]  = { 0 };
+
+  assert_int_equal(ockam_memory_alloc_zeroed(&test_state->tcache, (void**) &p_first, 100), OCKAM_ERROR_NONE);
+  assert_int_equal((uintptr_t) p_first % 16, 0);
+  memset(p_first, 0xA5, 100);
+  assert_int_equal(ockam_memory_free(&test_state->tcache, p_first, 100), OCKAM_ERROR_NONE);
+
+  // 65..128 bytes share a size class
+  assert_int_equal(ockam_memory_alloc_zeroed(&test_state->tcache, (void**) &p_second, 120), OCKAM_ERROR_NONE);
+  assert_ptr_equal(p_first, p_second);
+  assert_memory_equal(p_second, zero, sizeof(zero));
+  assert_int_equal(ockam_memory_free(&test_state->tcache, p_second, 120), OCKAM_ERROR_NONE);
+
+  assert_int_equal(ockam_memory_tcache_flush(&test_state->tcache), OCKAM_ERROR_NONE);
+  assert_int_equal(ockam_memory_tcache_flush(&test_state->backing), OCKAM_MEMORY_ERROR_INVALID_PARAM);
+}
+
+static void memory_tcache__large_request__should_use_backing_memory(void** state)
+{
+  test_state_t* test_state = *state;
+  uint8_t*      p_large    = NULL;
+
+  assert_int_equal(ockam_memory_alloc_zeroed(&test_state->tcache, (void**) &p_large, 10000), OCKAM_ERROR_NONE);
+  p_large[9999] = 1;
+  assert_int_equal(ockam_memory_free(&test_state->tcache, p_large, 10000), OCKAM_ERROR_NONE);
+}
+
+static void* test_allocate_thread(void* arg)
+{
+  test_thread_t* p_thread = (test_thread_t*) arg;
+  size_t         i        = 0;
+
+  for (i = p_thread->first; i < TEST_OBJECTS; i += TEST_THREADS) {
+    if (ockam_memory_alloc_zeroed(p_thread->p_memory, (void**) &p_thread->objects[i], test_size(i))) {
+      p_thread->failed = 1;
+      break;
+    }
+    memset(p_thread->objects[i], (int) (i & 0xFFu), test_size(i));
+  }
+
+  return NULL;
+}
+
+static void* test_free_thread(void* arg)
+{
+  test_thread_t* p_thread = (test_thread_t*) arg;
+  size_t         i        = 0;
+  size_t         j        = 0;
+
+  // Free what another thread allocated, checking nothing was handed out twice
+  for (i = p_thread->first; i < TEST_OBJECTS; i += TEST_THREADS) {
+    for (j = 0; j < test_size(i); j++) {
+      if (p_thread->objects[i][j] != (uint8_t)(i & 0xFFu)) p_thread->failed = 1;
+    }
+    if (ockam_memory_free(p_thread->p_memory, p_thread->objects[i], test_size(i))) p_thread->failed = 1;
+  }
+
+  return NULL;
+}
+
+static uint8_t* g_objects[TEST_OBJECTS];
+
+static void memory_tcache__cross_thread_free__should_recycle_blocks(void** state)
+{
+  test_state_t* test_state = *state;
+  test_thread_t threads[TEST_THREADS];
+  pthread_t     ids[TEST_THREADS];
+  size_t        round = 0;
+  size_t        t     = 0;
+
+  for (round = 0; round < TEST_ROUNDS; round++) {
+    for (t = 0; t < TEST_THREADS; t++) {
+      threads[t].p_memory = &test_state->tcache;
+      threads[t].objects  = g_objects;
+      threads[t].first    = t;
+      threads[t].failed   = 0;
+      pthread_create(&ids[t], NULL, test_allocate_thread, &threads[t]);
+    }
+    for (t = 0; t < TEST_THREADS; t++) {
+      pthread_join(ids[t], NULL);
+      assert_int_equal(threads[t].failed, 0);
+    }
+
+    for (t = 0; t < TEST_THREADS; t++) {
+      threads[t].first = (t + 1) % TEST_THREADS;
+      pthread_create(&ids[t], NULL, test_free_thread, &threads[t]);
+    }
+    for (t = 0; t < TEST_THREADS; t++) {
+      pthread_join(ids[t], NULL);
+      assert_int_equal(threads[t].failed, 0);
+    }
+  }
+}
+
+int main(void)
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test_setup_teardown(memory_tcache__free_then_alloc__should_reuse_zeroed_block, test_setup, test_teardown),
+    cmocka_unit_test_setup_teardown(memory_tcache__large_request__should_use_backing_memory, test_setup, test_teardown),
+    cmocka_unit_test_setup_teardown(memory_tcache__cross_thread_free__should_recycle_blocks, test_setup, test_teardown),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,102 @@
+/**
+ * @file  impl.h
+ * @brief The interface for a queue implementation
+ */
+
+#ifndef OCKAM_QUEUE_IMPL_H_
+#define OCKAM_QUEUE_IMPL_H_
+
+#include "ockam/error.h"
+#include "ockam/queue.h"
+
+/**
+ * @struct  ockam_queue_dispatch_table_t
+ * @brief   The Ockam Queue implementation functions
+ */
+typedef struct {
+  /**
+   * @brief   Free the queue and everything the implementation allocated for it.
+   * @param   p_q[in]  The queue to free.
+   * @return  OCKAM_ERROR_NONE on success.
+   */
+  ockam_error_t (*uninit)(ockam_queue_t* p_q);
+
+  /**
+   * @brief   Add a node at the tail of the queue.
+   * @param   p_q[in]   The queue to add to.
+   * @param   node[in]  Node to add, must not be NULL.
+   * @return  OCKAM_ERROR_NONE on success, QUEUE_ERROR_FULL when there is no room.
+   */
+  ockam_error_t (*enqueue)(ockam_queue_t* p_q, void* node);
+
+  /**
+   * @brief   Remove the node at the head of the queue.
+   * @param   p_q[in]       The queue to remove from.
+   * @param   pp_node[out]  Removed node.
+   * @return  OCKAM_ERROR_NONE on success, QUEUE_ERROR_EMPTY when there is nothing to remove.
+   */
+  ockam_error_t (*dequeue)(ockam_queue_t* p_q, void** pp_node);
+
+  /**
+   * @brief   Add up to count nodes at the tail of the queue. Optional, the queue falls back to calling enqueue for
+   *          each node when this is not set.
+   * @param   p_q[in]          The queue to add to.
+   * @param   nodes[in]        Nodes to add, in order.
+   * @param   count[in]        Number of nodes to add.
+   * @param   p_enqueued[out]  Number of nodes added.
+   * @return  OCKAM_ERROR_NONE if at least one node was added, QUEUE_ERROR_FULL otherwise.
+   */
+  ockam_error_t (*enqueue_batch)(ockam_queue_t* p_q, void** nodes, size_t count, size_t* p_enqueued);
+
+  /**
+   * @brief   Remove up to count nodes from the head of the queue. Optional, the queue falls back to calling dequeue
+   *          for each node when this is not set.
+   * @param   p_q[in]          The queue to remove from.
+   * @param   nodes[out]       Removed nodes, in order.
+   * @param   count[in]        Maximum number of nodes to remove.
+   * @param   p_dequeued[out]  Number of nodes removed.
+   * @return  OCKAM_ERROR_NONE if at least one node was removed, QUEUE_ERROR_EMPTY otherwise.
+   */
+  ockam_error_t (*dequeue_batch)(ockam_queue_t* p_q, void** nodes, size_t count, size_t* p_dequeued);
+
+  /**
+   * @brief   Get the number of nodes in the queue. Lock-free implementations may return a momentary snapshot.
+   * @param   p_q[in]      The queue.
+   * @param   p_size[out]  Number of nodes.
+   * @return  OCKAM_ERROR_NONE on success.
+   */
+  ockam_error_t (*size)(ockam_queue_t* p_q, uint16_t* p_size);
+
+  /**
+   * @brief   Get the number of nodes the queue can hold.
+   * @param   p_q[in]      The queue.
+   * @param   p_size[out]  Capacity.
+   * @return  OCKAM_ERROR_NONE on success.
+   */
+  ockam_error_t (*max_size)(ockam_queue_t* p_q, uint16_t* p_size);
+
+  /**
+   * @brief   Grow the queue capacity. Optional, QUEUE_ERROR_UNSUPPORTED is returned when this is not set.
+   * @param   p_q[in]           The queue.
+   * @param   new_max_size[in]  New capacity, must be larger than the current one.
+   * @return  OCKAM_ERROR_NONE on success.
+   */
+  ockam_error_t (*grow)(ockam_queue_t* p_q, uint16_t new_max_size);
+
+  /**
+   * @brief   Add a node at the tail of the queue, waiting for room when it is full. Optional, the queue falls back
+   *          to retrying enqueue with short sleeps when this is not set.
+   * @param   p_q[in]         The queue to add to.
+   * @param   node[in]        Node to add, must not be NULL.
+   * @param   timeout_ms[in]  Longest time to wait for room, QUEUE_WAIT_FOREVER to wait without limit.
+   * @return  OCKAM_ERROR_NONE on success, QUEUE_ERROR_FULL when there was still no room after timeout_ms.
+   */
+  ockam_error_t (*enqueue_wait)(ockam_queue_t* p_q, void* node, uint32_t timeout_ms);
+} ockam_queue_dispatch_table_t;
+
+struct ockam_queue_t {
+  ockam_queue_dispatch_table_t* dispatch;
+  void*                         context;
+};
+
+#endif
@@ -0,0 +1,459 @@
+/**
+ * @file  lockfree.c
+ * @brief Lock-free single-producer/single-consumer and bounded multi-producer/multi-consumer queues
+ */
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "ockam/error.h"
+#include "ockam/log.h"
+#include "ockam/memory.h"
+#include "ockam/queue.h"
+
+#include "ockam/queue/impl.h"
+#include "ockam/queue/lockfree.h"
+
+#define QUEUE_LOCKFREE_CACHE_LINE_SIZE 64u
+
+/*
+ * The SPSC queue keeps the producer and consumer indices on separate cache lines. Each side also keeps a private
+ * copy of the other side's index and only reloads it when the copy says the queue is full (or empty), so in steady
+ * state neither side touches the other's cache line.
+ */
+typedef struct {
+  ockam_memory_t* p_memory;
+  pthread_cond_t* p_alert;
+  size_t          mask;
+  void**          nodes;
+  uint8_t         pad0[QUEUE_LOCKFREE_CACHE_LINE_SIZE];
+  atomic_size_t   tail;
+  size_t          cached_head;
+  uint8_t         pad1[QUEUE_LOCKFREE_CACHE_LINE_SIZE];
+  atomic_size_t   head;
+  size_t          cached_tail;
+  uint8_t         pad2[QUEUE_LOCKFREE_CACHE_LINE_SIZE];
+} queue_spsc_ctx_t;
+
+/*
+ * The MPMC queue is a bounded array of cells, each with a sequence number telling producers and consumers whose turn
+ * it is. A position is claimed with one compare-and-swap on the shared index; batches claim a run of ready cells with
+ * a single compare-and-swap.
+ */
+typedef struct {
+  atomic_size_t sequence;
+  void*         node;
+} queue_mpmc_cell_t;
+
+typedef struct {
+  ockam_memory_t*    p_memory;
+  pthread_cond_t*    p_alert;
+  size_t             mask;
+  queue_mpmc_cell_t* cells;
+  uint8_t            pad0[QUEUE_LOCKFREE_CACHE_LINE_SIZE];
+  atomic_size_t      enqueue_pos;
+  uint8_t            pad1[QUEUE_LOCKFREE_CACHE_LINE_SIZE];
+  atomic_size_t      dequeue_pos;
+  uint8_t            pad2[QUEUE_LOCKFREE_CACHE_LINE_SIZE];
+} queue_mpmc_ctx_t;
+
+ockam_error_t queue_lockfree_capacity(ockam_queue_attributes_t* p_attributes, size_t* p_capacity);
+
+ockam_error_t queue_spsc_uninit(ockam_queue_t* p_q);
+ockam_error_t queue_spsc_enqueue(ockam_queue_t* p_q, void* node);
+ockam_error_t queue_spsc_dequeue(ockam_queue_t* p_q, void** pp_node);
+ockam_error_t queue_spsc_enqueue_batch(ockam_queue_t* p_q, void** nodes, size_t count, size_t* p_enqueued);
+ockam_error_t queue_spsc_dequeue_batch(ockam_queue_t* p_q, void** nodes, size_t count, size_t* p_dequeued);
+ockam_error_t queue_spsc_size(ockam_queue_t* p_q, uint16_t* p_size);
+ockam_error_t queue_spsc_max_size(ockam_queue_t* p_q, uint16_t* p_size);
+
+ockam_error_t queue_mpmc_uninit(ockam_queue_t* p_q);
+ockam_error_t queue_mpmc_enqueue(ockam_queue_t* p_q, void* node);
+ockam_error_t queue_mpmc_dequeue(ockam_queue_t* p_q, void** pp_node);
+ockam_error_t queue_mpmc_enqueue_batch(ockam_queue_t* p_q, void** nodes, size_t count, size_t* p_enqueued);
+ockam_error_t queue_mpmc_dequeue_batch(ockam_queue_t* p_q, void** nodes, size_t count, size_t* p_dequeued);
+ockam_error_t queue_mpmc_size(ockam_queue_t* p_q, uint16_t* p_size);
+ockam_error_t queue_mpmc_max_size(ockam_queue_t* p_q, uint16_t* p_size);
+
+ockam_queue_dispatch_table_t queue_spsc_dispatch_table = { &queue_spsc_uninit,        &queue_spsc_enqueue,
+                                                           &queue_spsc_dequeue,       &queue_spsc_enqueue_batch,
+                                                           &queue_spsc_dequeue_batch, &queue_spsc_size,
+                                                           &queue_spsc_max_size,      0,
+                                                           0 };
+
+ockam_queue_dispatch_table_t queue_mpmc_dispatch_table = { &queue_mpmc_uninit,        &queue_mpmc_enqueue,
+                                                           &queue_mpmc_dequeue,       &queue_mpmc_enqueue_batch,
+                                                           &queue_mpmc_dequeue_batch, &queue_mpmc_size,
+                                                           &queue_mpmc_max_size,      0,
+                                                           0 };
+
+ockam_error_t queue_lockfree_capacity(ockam_queue_attributes_t* p_attributes, size_t* p_capacity)
+{
+  ockam_error_t error    = OCKAM_ERROR_NONE;
+  size_t        capacity = 2;
+
+  if ((NULL == p_attributes) || (NULL == p_attributes->p_memory) || (p_attributes->queue_size < 1) ||
+      (p_attributes->queue_size > OCKAM_QUEUE_LOCKFREE_MAX_SIZE)) {
+    error = QUEUE_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  while (capacity < p_attributes->queue_size) capacity <<= 1;
+
+  *p_capacity = capacity;
+
+exit:
+  return error;
+}
+
+ockam_error_t ockam_queue_spsc_init(ockam_queue_t** pp_queue, ockam_queue_attributes_t* p_attributes)
+{
+  ockam_error_t     error    = OCKAM_ERROR_NONE;
+  ockam_queue_t*    p_queue  = NULL;
+  queue_spsc_ctx_t* p_ctx    = NULL;
+  size_t            capacity = 0;
+
+  if (NULL == pp_queue) {
+    error = QUEUE_ERROR_PARAMETER;
+    goto exit;
+  }
+  *pp_queue = NULL;
+
+  error = queue_lockfree_capacity(p_attributes, &capacity);
+  if (error) goto exit;
+
+  error = ockam_memory_alloc_zeroed(p_attributes->p_memory, (void**) &p_queue, sizeof(ockam_queue_t));
+  if (error) goto exit;
+
+  error = ockam_memory_alloc_zeroed(p_attributes->p_memory, (void**) &p_ctx, sizeof(queue_spsc_ctx_t));
+  if (error) goto exit;
+
+  error = ockam_memory_alloc_zeroed(p_attributes->p_memory, (void**) &p_ctx->nodes, capacity * sizeof(void*));
+  if (error) goto exit;
+
+  p_ctx->p_memory = p_attributes->p_memory;
+  p_ctx->p_alert  = p_attributes->p_alert;
+  p_ctx->mask     = capacity - 1;
+  atomic_init(&p_ctx->head, 0);
+  atomic_init(&p_ctx->tail, 0);
+
+  p_queue->dispatch = &queue_spsc_dispatch_table;
+  p_queue->context  = p_ctx;
+  *pp_queue         = p_queue;
+
+exit:
+  if (error) {
+    ockam_log_error("%x", error);
+    if (p_ctx) {
+      if (p_ctx->nodes) ockam_memory_free(p_attributes->p_memory, p_ctx->nodes, capacity * sizeof(void*));
+      ockam_memory_free(p_attributes->p_memory, p_ctx, sizeof(queue_spsc_ctx_t));
+    }
+    if (p_queue) ockam_memory_free(p_attributes->p_memory, p_queue, sizeof(ockam_queue_t));
+  }
+  return error;
+}
+
+ockam_error_t queue_spsc_uninit(ockam_queue_t* p_q)
+{
+  ockam_error_t     error  = OCKAM_ERROR_NONE;
+  queue_spsc_ctx_t* p_ctx  = (queue_spsc_ctx_t*) p_q->context;
+  ockam_memory_t*   memory = p_ctx->p_memory;
+
+  error = ockam_memory_free(memory, p_ctx->nodes, (p_ctx->mask + 1) * sizeof(void*));
+  if (error) goto exit;
+
+  error = ockam_memory_free(memory, p_ctx, sizeof(queue_spsc_ctx_t));
+  if (error) goto exit;
+
+  error = ockam_memory_free(memory, p_q, sizeof(ockam_queue_t));
+
+exit:
+  return error;
+}
+
+ockam_error_t queue_spsc_enqueue_batch(ockam_queue_t* p_q, void** nodes, size_t count, size_t* p_enqueued)
+{
+  ockam_error_t     error    = OCKAM_ERROR_NONE;
+  queue_spsc_ctx_t* p_ctx    = (queue_spsc_ctx_t*) p_q->context;
+  size_t            tail     = atomic_load_explicit(&p_ctx->tail, memory_order_relaxed);
+  size_t            capacity = p_ctx->mask + 1;
+  size_t            free     = capacity - (tail - p_ctx->cached_head);
+  size_t            i        = 0;
+
+  if (free < count) {
+    p_ctx->cached_head = atomic_load_explicit(&p_ctx->head, memory_order_acquire);
+    free               = capacity - (tail - p_ctx->cached_head);
+  }
+
+  if (count > free) count = free;
+
+  if (0 == count) {
+    error = QUEUE_ERROR_FULL;
+    goto exit;
+  }
+
+  for (i = 0; i < count; i++) p_ctx->nodes[(tail + i) & p_ctx->mask] = nodes[i];
+
+  atomic_store_explicit(&p_ctx->tail, tail + count, memory_order_release);
+
+  if (NULL != p_ctx->p_alert) pthread_cond_signal(p_ctx->p_alert);
+
+exit:
+  *p_enqueued = count;
+  return error;
+}
+
+ockam_error_t queue_spsc_dequeue_batch(ockam_queue_t* p_q, void** nodes, size_t count, size_t* p_dequeued)
+{
+  ockam_error_t     error     = OCKAM_ERROR_NONE;
+  queue_spsc_ctx_t* p_ctx     = (queue_spsc_ctx_t*) p_q->context;
+  size_t            head      = atomic_load_explicit(&p_ctx->head, memory_order_relaxed);
+  size_t            available = p_ctx->cached_tail - head;
+  size_t            i         = 0;
+
+  if (available < count) {
+    p_ctx->cached_tail = atomic_load_explicit(&p_ctx->tail, memory_order_acquire);
+    available          = p_ctx->cached_tail - head;
+  }
+
+  if (count > available) count = available;
+
+  if (0 == count) {
+    error = QUEUE_ERROR_EMPTY;
+    goto exit;
+  }
+
+  for (i = 0; i < count; i++) nodes[i] = p_ctx->nodes[(head + i) & p_ctx->mask];
+
+  atomic_store_explicit(&p_ctx->head, head + count, memory_order_release);
+
+exit:
+  *p_dequeued = count;
+  return error;
+}
+
+ockam_error_t queue_spsc_enqueue(ockam_queue_t* p_q, void* node)
+{
+  size_t enqueued = 0;
+
+  return queue_spsc_enqueue_batch(p_q, &node, 1, &enqueued);
+}
+
+ockam_error_t queue_spsc_dequeue(ockam_queue_t* p_q, void** pp_node)
+{
+  size_t dequeued = 0;
+
+  return queue_spsc_dequeue_batch(p_q, pp_node, 1, &dequeued);
+}
+
+ockam_error_t queue_spsc_size(ockam_queue_t* p_q, uint16_t* p_size)
+{
+  queue_spsc_ctx_t* p_ctx = (queue_spsc_ctx_t*) p_q->context;
+  size_t            head  = atomic_load_explicit(&p_ctx->head, memory_order_acquire);
+  size_t            tail  = atomic_load_explicit(&p_ctx->tail, memory_order_acquire);
+
+  *p_size = (uint16_t)(tail - head);
+
+  return OCKAM_ERROR_NONE;
+}
+
+ockam_error_t queue_spsc_max_size(ockam_queue_t* p_q, uint16_t* p_size)
+{
+  queue_spsc_ctx_t* p_ctx = (queue_spsc_ctx_t*) p_q->context;
+
+  *p_size = (uint16_t)(p_ctx->mask + 1);
+
+  return OCKAM_ERROR_NONE;
+}
+
+ockam_error_t ockam_queue_mpmc_init(ockam_queue_t** pp_queue, ockam_queue_attributes_t* p_attributes)
+{
+  ockam_error_t     error    = OCKAM_ERROR_NONE;
+  ockam_queue_t*    p_queue  = NULL;
+  queue_mpmc_ctx_t* p_ctx    = NULL;
+  size_t            capacity = 0;
+  size_t            i        = 0;
+
+  if (NULL == pp_queue) {
+    error = QUEUE_ERROR_PARAMETER;
+    goto exit;
+  }
+  *pp_queue = NULL;
+
+  error = queue_lockfree_capacity(p_attributes, &capacity);
+  if (error) goto exit;
+
+  error = ockam_memory_alloc_zeroed(p_attributes->p_memory, (void**) &p_queue, sizeof(ockam_queue_t));
+  if (error) goto exit;
+
+  error = ockam_memory_alloc_zeroed(p_attributes->p_memory, (void**) &p_ctx, sizeof(queue_mpmc_ctx_t));
+  if (error) goto exit;
+
+  error =
+    ockam_memory_alloc_zeroed(p_attributes->p_memory, (void**) &p_ctx->cells, capacity * sizeof(queue_mpmc_cell_t));
+  if (error) goto exit;
+
+  for (i = 0; i < capacity; i++) atomic_init(&p_ctx->cells[i].sequence, i);
+
+  p_ctx->p_memory = p_attributes->p_memory;
+  p_ctx->p_alert  = p_attributes->p_alert;
+  p_ctx->mask     = capacity - 1;
+  atomic_init(&p_ctx->enqueue_pos, 0);
+  atomic_init(&p_ctx->dequeue_pos, 0);
+
+  p_queue->dispatch = &queue_mpmc_dispatch_table;
+  p_queue->context  = p_ctx;
+  *pp_queue         = p_queue;
+
+exit:
+  if (error) {
+    ockam_log_error("%x", error);
+    if (p_ctx) {
+      if (p_ctx->cells) ockam_memory_free(p_attributes->p_memory, p_ctx->cells, capacity * sizeof(queue_mpmc_cell_t));
+      ockam_memory_free(p_attributes->p_memory, p_ctx, sizeof(queue_mpmc_ctx_t));
+    }
+    if (p_queue) ockam_memory_free(p_attributes->p_memory, p_queue, sizeof(ockam_queue_t));
+  }
+  return error;
+}
+
+ockam_error_t queue_mpmc_uninit(ockam_queue_t* p_q)
+{
+  ockam_error_t     error  = OCKAM_ERROR_NONE;
+  queue_mpmc_ctx_t* p_ctx  = (queue_mpmc_ctx_t*) p_q->context;
+  ockam_memory_t*   memory = p_ctx->p_memory;
+
+  error = ockam_memory_free(memory, p_ctx->cells, (p_ctx->mask + 1) * sizeof(queue_mpmc_cell_t));
+  if (error) goto exit;
+
+  error = ockam_memory_free(memory, p_ctx, sizeof(queue_mpmc_ctx_t));
+  if (error) goto exit;
+
+  error = ockam_memory_free(memory, p_q, sizeof(ockam_queue_t));
+
+exit:
+  return error;
+}
+
+ockam_error_t queue_mpmc_enqueue_batch(ockam_queue_t* p_q, void** nodes, size_t count, size_t* p_enqueued)
+{
+  ockam_error_t     error = OCKAM_ERROR_NONE;
+  queue_mpmc_ctx_t* p_ctx = (queue_mpmc_ctx_t*) p_q->context;
+  size_t            pos   = atomic_load_explicit(&p_ctx->enqueue_pos, memory_order_relaxed);
+  size_t            ready = 0;
+  size_t            i     = 0;
+
+  for (;;) {
+    /* Count the run of cells, starting at pos, that are free for this round of the ring */
+    for (ready = 0; ready < count; ready++) {
+      queue_mpmc_cell_t* cell     = &p_ctx->cells[(pos + ready) & p_ctx->mask];
+      size_t             sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+      if (sequence != pos + ready) break;
+    }
+
+    if (0 == ready) {
+      size_t sequence = atomic_load_explicit(&p_ctx->cells[pos & p_ctx->mask].sequence, memory_order_acquire);
+      if ((intptr_t)(sequence - pos) < 0) {
+        error = QUEUE_ERROR_FULL;
+        goto exit;
+      }
+      pos = atomic_load_explicit(&p_ctx->enqueue_pos, memory_order_relaxed);
+      continue;
+    }
+
+    if (atomic_compare_exchange_weak_explicit(
+          &p_ctx->enqueue_pos, &pos, pos + ready, memory_order_relaxed, memory_order_relaxed)) {
+      break;
+    }
+  }
+
+  for (i = 0; i < ready; i++) {
+    queue_mpmc_cell_t* cell = &p_ctx->cells[(pos + i) & p_ctx->mask];
+    cell->node              = nodes[i];
+    atomic_store_explicit(&cell->sequence, pos + i + 1, memory_order_release);
+  }
+
+  if (NULL != p_ctx->p_alert) pthread_cond_signal(p_ctx->p_alert);
+
+exit:
+  *p_enqueued = ready;
+  return error;
+}
+
+ockam_error_t queue_mpmc_dequeue_batch(ockam_queue_t* p_q, void** nodes, size_t count, size_t* p_dequeued)
+{
+  ockam_error_t     error = OCKAM_ERROR_NONE;
+  queue_mpmc_ctx_t* p_ctx = (queue_mpmc_ctx_t*) p_q->context;
+  size_t            pos   = atomic_load_explicit(&p_ctx->dequeue_pos, memory_order_relaxed);
+  size_t            ready = 0;
+  size_t            i     = 0;
+
+  for (;;) {
+    /* Count the run of cells, starting at pos, that producers have finished filling */
+    for (ready = 0; ready < count; ready++) {
+      queue_mpmc_cell_t* cell     = &p_ctx->cells[(pos + ready) & p_ctx->mask];
+      size_t             sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+      if (sequence != pos + ready + 1) break;
+    }
+
+    if (0 == ready) {
+      size_t sequence = atomic_load_explicit(&p_ctx->cells[pos & p_ctx->mask].sequence, memory_order_acquire);
+      if ((intptr_t)(sequence - (pos + 1)) < 0) {
+        error = QUEUE_ERROR_EMPTY;
+        goto exit;
+      }
+      pos = atomic_load_explicit(&p_ctx->dequeue_pos, memory_order_relaxed);
+      continue;
+    }
+
+    if (atomic_compare_exchange_weak_explicit(
+          &p_ctx->dequeue_pos, &pos, pos + ready, memory_order_relaxed, memory_order_relaxed)) {
+      break;
+    }
+  }
+
+  for (i = 0; i < ready; i++) {
+    queue_mpmc_cell_t* cell = &p_ctx->cells[(pos + i) & p_ctx->mask];
+    nodes[i]                = cell->node;
+    atomic_store_explicit(&cell->sequence, pos + i + p_ctx->mask + 1, memory_order_release);
+  }
+
+exit:
+  *p_dequeued = ready;
+  return error;
+}
+
+ockam_error_t queue_mpmc_enqueue(ockam_queue_t* p_q, void* node)
+{
+  size_t enqueued = 0;
+
+  return queue_mpmc_enqueue_batch(p_q, &node, 1, &enqueued);
+}
+
+ockam_error_t queue_mpmc_dequeue(ockam_queue_t* p_q, void** pp_node)
+{
+  size_t dequeued = 0;
+
+  return queue_mpmc_dequeue_batch(p_q, pp_node, 1, &dequeued);
+}
+
+ockam_error_t queue_mpmc_size(ockam_queue_t* p_q, uint16_t* p_size)
+{
+  queue_mpmc_ctx_t* p_ctx   = (queue_mpmc_ctx_t*) p_q->context;
+  size_t            dequeue = atomic_load_explicit(&p_ctx->dequeue_pos, memory_order_acquire);
+  size_t            enqueue = atomic_load_explicit(&p_ctx->enqueue_pos, memory_order_acquire);
+
+  *p_size = (enqueue > dequeue) ? (uint16_t)(enqueue - dequeue) : 0;
+
+  return OCKAM_ERROR_NONE;
+}
+
+ockam_error_t queue_mpmc_max_size(ockam_queue_t* p_q, uint16_t* p_size)
+{
+  queue_mpmc_ctx_t* p_ctx = (queue_mpmc_ctx_t*) p_q->context;
+
+  *p_size = (uint16_t)(p_ctx->mask + 1);
+
+  return OCKAM_ERROR_NONE;
+}
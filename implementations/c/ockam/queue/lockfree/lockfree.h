@@ -0,0 +1,35 @@
+/**
+ * @file  lockfree.h
+ * @brief Lock-free bounded queues
+ */
+
+#ifndef OCKAM_QUEUE_LOCKFREE_H_
+#define OCKAM_QUEUE_LOCKFREE_H_
+
+#include "ockam/error.h"
+#include "ockam/queue.h"
+
+#include "ockam/queue/impl.h"
+
+/* Largest capacity a lock-free queue can have, queue_max_size() reports capacity as a uint16_t */
+#define OCKAM_QUEUE_LOCKFREE_MAX_SIZE 32768u
+
+/**
+ * @brief   Initialize a lock-free queue for exactly one producer thread and one consumer thread.
+ * @param   pp_queue[out]     The created queue, use the functions in ockam/queue.h with it.
+ * @param   p_attributes[in]  Queue attributes. queue_size is rounded up to a power of two and must not exceed
+ *                            OCKAM_QUEUE_LOCKFREE_MAX_SIZE. p_alert, if set, is signalled after each enqueue.
+ * @return  OCKAM_ERROR_NONE on success.
+ */
+ockam_error_t ockam_queue_spsc_init(ockam_queue_t** pp_queue, ockam_queue_attributes_t* p_attributes);
+
+/**
+ * @brief   Initialize a bounded lock-free queue safe for any number of producer and consumer threads.
+ * @param   pp_queue[out]     The created queue, use the functions in ockam/queue.h with it.
+ * @param   p_attributes[in]  Queue attributes. queue_size is rounded up to a power of two and must not exceed
+ *                            OCKAM_QUEUE_LOCKFREE_MAX_SIZE. p_alert, if set, is signalled after each enqueue.
+ * @return  OCKAM_ERROR_NONE on success.
+ */
+ockam_error_t ockam_queue_mpmc_init(ockam_queue_t** pp_queue, ockam_queue_attributes_t* p_attributes);
+
+#endif
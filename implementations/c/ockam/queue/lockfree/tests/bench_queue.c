@@ -0,0 +1,213 @@
+/**
+ * @file    bench_queue.c
+ * @brief   Compare the mutex queue with the lock-free SPSC and MPMC queues
+ *
+ * Runs producer/consumer thread pairs against each queue and reports operations per second together with p50, p99
+ * and p99.9 latency of single enqueue/dequeue calls. Producers retry when the queue reports full, so a slow consumer
+ * shows up as backpressure rather than lost nodes. The SPSC queue only runs with one producer and one consumer.
+ *
+ * Usage: ockam_queue_bench [nodes_per_producer] [batch_size]
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "ockam/error.h"
+#include "ockam/memory.h"
+#include "ockam/memory/stdlib.h"
+#include "ockam/queue.h"
+#include "ockam/queue/lockfree.h"
+
+#define BENCH_DEFAULT_NODES 1000000
+#define BENCH_QUEUE_SIZE    4096
+#define BENCH_MAX_THREADS   16
+#define BENCH_MAX_BATCH     64
+#define BENCH_BUCKETS       64
+
+typedef ockam_error_t (*bench_init_fn)(ockam_queue_t**, ockam_queue_attributes_t*);
+
+typedef struct {
+  const char*   name;
+  bench_init_fn init;
+  int           single_producer;
+} bench_queue_t;
+
+/* Latency is recorded in log2 nanosecond buckets so threads never share or allocate while measuring */
+typedef struct {
+  ockam_queue_t* p_q;
+  size_t         count;
+  size_t         batch;
+  uint64_t       histogram[BENCH_BUCKETS];
+} bench_thread_t;
+
+bench_queue_t bench_queues[] = {
+  { "mutex", init_queue, 0 },
+  { "spsc", ockam_queue_spsc_init, 1 },
+  { "mpmc", ockam_queue_mpmc_init, 0 },
+};
+
+uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+void bench_record(bench_thread_t* p_thread, uint64_t ns)
+{
+  size_t bucket = 0;
+  while ((ns >>= 1) && (bucket < BENCH_BUCKETS - 1)) bucket++;
+  p_thread->histogram[bucket]++;
+}
+
+void* bench_producer(void* arg)
+{
+  bench_thread_t* p_thread = (bench_thread_t*) arg;
+  void*           batch[BENCH_MAX_BATCH];
+  size_t          sent  = 0;
+  size_t          n     = 0;
+  size_t          i     = 0;
+  uint64_t        start = 0;
+
+  for (i = 0; i < p_thread->batch; i++) batch[i] = (void*) (uintptr_t)(i + 1);
+
+  while (sent < p_thread->count) {
+    n = p_thread->count - sent;
+    if (n > p_thread->batch) n = p_thread->batch;
+    start = bench_now_ns();
+    if (1 == p_thread->batch) {
+      if (OCKAM_ERROR_NONE != enqueue(p_thread->p_q, batch[0])) continue;
+    } else if (OCKAM_ERROR_NONE != enqueue_batch(p_thread->p_q, batch, n, &n)) {
+      continue;
+    }
+    bench_record(p_thread, bench_now_ns() - start);
+    sent += n;
+  }
+
+  return NULL;
+}
+
+void* bench_consumer(void* arg)
+{
+  bench_thread_t* p_thread = (bench_thread_t*) arg;
+  void*           batch[BENCH_MAX_BATCH];
+  size_t          received = 0;
+  size_t          n        = 0;
+  uint64_t        start    = 0;
+
+  while (received < p_thread->count) {
+    n = p_thread->count - received;
+    if (n > p_thread->batch) n = p_thread->batch;
+    start = bench_now_ns();
+    if (1 == p_thread->batch) {
+      if (OCKAM_ERROR_NONE != dequeue(p_thread->p_q, &batch[0])) continue;
+    } else if (OCKAM_ERROR_NONE != dequeue_batch(p_thread->p_q, batch, n, &n)) {
+      continue;
+    }
+    bench_record(p_thread, bench_now_ns() - start);
+    received += n;
+  }
+
+  return NULL;
+}
+
+uint64_t bench_percentile(uint64_t* histogram, uint64_t total, double percentile)
+{
+  uint64_t target = (uint64_t)(total * percentile);
+  uint64_t seen   = 0;
+  size_t   bucket = 0;
+
+  for (bucket = 0; bucket < BENCH_BUCKETS; bucket++) {
+    seen += histogram[bucket];
+    if (seen > target) break;
+  }
+
+  return (uint64_t) 1 << (bucket + 1);
+}
+
+ockam_error_t bench_run(ockam_memory_t* p_memory, bench_queue_t* p_bench, size_t threads, size_t nodes, size_t batch)
+{
+  ockam_error_t            error      = OCKAM_ERROR_NONE;
+  ockam_queue_t*           p_q        = NULL;
+  ockam_queue_attributes_t attributes = { 0 };
+  pthread_t                ids[BENCH_MAX_THREADS];
+  bench_thread_t           contexts[BENCH_MAX_THREADS] = { 0 };
+  uint64_t                 histogram[BENCH_BUCKETS]    = { 0 };
+  size_t                   producers                   = threads / 2;
+  uint64_t                 total                       = 0;
+  uint64_t                 start                       = 0;
+  double                   seconds                     = 0;
+  size_t                   i                           = 0;
+  size_t                   j                           = 0;
+
+  attributes.p_memory   = p_memory;
+  attributes.queue_size = BENCH_QUEUE_SIZE;
+
+  error = p_bench->init(&p_q, &attributes);
+  if (error) goto exit;
+
+  start = bench_now_ns();
+  for (i = 0; i < threads; i++) {
+    contexts[i].p_q   = p_q;
+    contexts[i].batch = batch;
+    contexts[i].count = nodes;
+    pthread_create(&ids[i], NULL, (i < producers) ? bench_producer : bench_consumer, &contexts[i]);
+  }
+  for (i = 0; i < threads; i++) pthread_join(ids[i], NULL);
+  seconds = (double) (bench_now_ns() - start) / 1e9;
+
+  for (i = 0; i < threads; i++) {
+    for (j = 0; j < BENCH_BUCKETS; j++) {
+      histogram[j] += contexts[i].histogram[j];
+      total += contexts[i].histogram[j];
+    }
+  }
+
+  printf("%-6s %2zu threads  %12.0f ops/s  p50 %8llu ns  p99 %8llu ns  p99.9 %8llu ns\n",
+         p_bench->name,
+         threads,
+         (double) (producers * nodes * 2) / seconds,
+         (unsigned long long) bench_percentile(histogram, total, 0.5),
+         (unsigned long long) bench_percentile(histogram, total, 0.99),
+         (unsigned long long) bench_percentile(histogram, total, 0.999));
+
+exit:
+  if (p_q) uninit_queue(p_q);
+  return error;
+}
+
+int main(int argc, char* argv[])
+{
+  ockam_error_t  error     = OCKAM_ERROR_NONE;
+  ockam_memory_t memory    = { 0 };
+  size_t         nodes     = BENCH_DEFAULT_NODES;
+  size_t         batch     = 1;
+  size_t         threads   = 0;
+  size_t         i         = 0;
+  int            ret_error = -1;
+
+  if (argc > 1) nodes = strtoul(argv[1], NULL, 10);
+  if (argc > 2) batch = strtoul(argv[2], NULL, 10);
+  if ((0 == batch) || (batch > BENCH_MAX_BATCH)) batch = 1;
+
+  error = ockam_memory_stdlib_init(&memory);
+  if (error) goto exit;
+
+  printf("%zu nodes per producer, batch size %zu, queue size %u\n", nodes, batch, BENCH_QUEUE_SIZE);
+
+  for (threads = 2; threads <= BENCH_MAX_THREADS; threads *= 2) {
+    for (i = 0; i < sizeof(bench_queues) / sizeof(bench_queues[0]); i++) {
+      if (bench_queues[i].single_producer && (threads > 2)) continue;
+      error = bench_run(&memory, &bench_queues[i], threads, nodes, batch);
+      if (error) goto exit;
+    }
+  }
+
+  ret_error = 0;
+
+exit:
+  return ret_error;
+}
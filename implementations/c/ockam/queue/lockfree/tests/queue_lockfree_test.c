@@ -0,0 +1,244 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "ockam/queue.h"
+#include "ockam/queue/lockfree.h"
+#include "ockam/log.h"
+#include "ockam/memory.h"
+#include "ockam/memory/stdlib.h"
+
+#define TEST_THREADS       4
+#define TEST_THREAD_NODES  20000
+#define TEST_BATCH_SIZE    8
+#define TEST_QUEUE_SIZE    5
+#define TEST_QUEUE_ROUNDED 8
+
+typedef ockam_error_t (*queue_init_fn)(ockam_queue_t**, ockam_queue_attributes_t*);
+
+typedef struct {
+  ockam_queue_t* p_q;
+  uintptr_t      first;
+  size_t         count;
+  uint64_t       sum;
+} test_thread_t;
+
+ockam_error_t test_queue_single(queue_init_fn init, ockam_memory_t* p_memory)
+{
+  char                     nodes[8][2] = { "1", "2", "3", "4", "5", "6", "7", "8" };
+  void*                    batch[8]    = { 0 };
+  ockam_queue_t*           p_q         = NULL;
+  ockam_error_t            error       = OCKAM_ERROR_NONE;
+  ockam_queue_attributes_t attributes  = { 0 };
+  void*                    p_node      = NULL;
+  uint16_t                 size        = 0;
+  size_t                   moved       = 0;
+  int                      i           = 0;
+
+  attributes.p_memory   = p_memory;
+  attributes.p_alert    = NULL;
+  attributes.queue_size = TEST_QUEUE_SIZE;
+
+  error = init(&p_q, &attributes);
+  if (error) goto exit;
+
+  // Capacity is rounded up to a power of two
+  error = queue_max_size(p_q, &size);
+  if (error) goto exit;
+  if (TEST_QUEUE_ROUNDED != size) {
+    ockam_log_error("%s", "unexpected queue capacity");
+    error = QUEUE_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  // Try to dequeue from an empty queue
+  error = dequeue(p_q, &p_node);
+  if (QUEUE_ERROR_EMPTY != error) goto exit;
+
+  // Fill up queue, then try to add when queue full
+  for (i = 0; i < TEST_QUEUE_ROUNDED; ++i) {
+    error = enqueue(p_q, &nodes[i][0]);
+    if (error) goto exit;
+  }
+  error = enqueue(p_q, (void*) "another ");
+  if (QUEUE_ERROR_FULL != error) {
+    ockam_log_error("%s", "enqueue didn't return queue full");
+    goto exit;
+  }
+
+  // Empty half-way, then refill with a batch that only partly fits (wrap condition)
+  for (i = 0; i < 3; ++i) {
+    error = dequeue(p_q, &p_node);
+    if (error) goto exit;
+    if (p_node != &nodes[i][0]) {
+      ockam_log_error("%s", "dequeue returned wrong node");
+      error = QUEUE_ERROR_EMPTY;
+      goto exit;
+    }
+  }
+
+  for (i = 0; i < 8; ++i) batch[i] = &nodes[i][0];
+  error = enqueue_batch(p_q, batch, 8, &moved);
+  if (error) goto exit;
+  if (3 != moved) {
+    ockam_log_error("%s", "partial enqueue_batch moved wrong count");
+    error = QUEUE_ERROR_FULL;
+    goto exit;
+  }
+
+  error = queue_size(p_q, &size);
+  if (error) goto exit;
+  if (TEST_QUEUE_ROUNDED != size) {
+    ockam_log_error("%s", "queue_size wrong after batch");
+    error = QUEUE_ERROR_FULL;
+    goto exit;
+  }
+
+  // Drain in one batch and verify order
+  error = dequeue_batch(p_q, batch, 8, &moved);
+  if (error) goto exit;
+  if (TEST_QUEUE_ROUNDED != moved) {
+    ockam_log_error("%s", "dequeue_batch moved wrong count");
+    error = QUEUE_ERROR_EMPTY;
+    goto exit;
+  }
+  for (i = 0; i < 5; ++i) {
+    if (batch[i] != &nodes[i + 3][0]) break;
+  }
+  if ((i < 5) || (batch[5] != &nodes[0][0]) || (batch[6] != &nodes[1][0]) || (batch[7] != &nodes[2][0])) {
+    ockam_log_error("%s", "dequeue_batch returned nodes out of order");
+    error = QUEUE_ERROR_EMPTY;
+    goto exit;
+  }
+
+  error = dequeue_batch(p_q, batch, 8, &moved);
+  if ((QUEUE_ERROR_EMPTY != error) || (0 != moved)) {
+    ockam_log_error("%s", "dequeue_batch on empty queue failed");
+    goto exit;
+  }
+
+  // Lock-free queues are fixed size
+  error = grow_queue(p_q, 16);
+  if (QUEUE_ERROR_UNSUPPORTED != error) {
+    ockam_log_error("%s", "grow_queue didn't return unsupported");
+    goto exit;
+  }
+
+  error = OCKAM_ERROR_NONE;
+
+exit:
+  if (p_q) uninit_queue(p_q);
+  return error;
+}
+
+void* test_producer(void* arg)
+{
+  test_thread_t* p_thread = (test_thread_t*) arg;
+  void*          batch[TEST_BATCH_SIZE];
+  size_t         sent = 0;
+  size_t         n    = 0;
+  size_t         i    = 0;
+
+  while (sent < p_thread->count) {
+    n = p_thread->count - sent;
+    if (n > TEST_BATCH_SIZE) n = TEST_BATCH_SIZE;
+    for (i = 0; i < n; i++) batch[i] = (void*) (p_thread->first + sent + i);
+    if (OCKAM_ERROR_NONE == enqueue_batch(p_thread->p_q, batch, n, &n)) sent += n;
+  }
+
+  return NULL;
+}
+
+void* test_consumer(void* arg)
+{
+  test_thread_t* p_thread = (test_thread_t*) arg;
+  void*          batch[TEST_BATCH_SIZE];
+  size_t         received = 0;
+  size_t         n        = 0;
+  size_t         i        = 0;
+
+  while (received < p_thread->count) {
+    n = p_thread->count - received;
+    if (n > TEST_BATCH_SIZE) n = TEST_BATCH_SIZE;
+    if (OCKAM_ERROR_NONE != dequeue_batch(p_thread->p_q, batch, n, &n)) continue;
+    for (i = 0; i < n; i++) p_thread->sum += (uintptr_t) batch[i];
+    received += n;
+  }
+
+  return NULL;
+}
+
+ockam_error_t test_queue_mpmc_threads(ockam_memory_t* p_memory)
+{
+  ockam_error_t            error      = OCKAM_ERROR_NONE;
+  ockam_queue_t*           p_q        = NULL;
+  ockam_queue_attributes_t attributes = { 0 };
+  pthread_t                threads[TEST_THREADS * 2];
+  test_thread_t            producers[TEST_THREADS];
+  test_thread_t            consumers[TEST_THREADS];
+  uint64_t                 expected = 0;
+  uint64_t                 sum      = 0;
+  size_t                   total    = TEST_THREADS * TEST_THREAD_NODES;
+  size_t                   i        = 0;
+
+  attributes.p_memory   = p_memory;
+  attributes.queue_size = 64;
+
+  error = ockam_queue_mpmc_init(&p_q, &attributes);
+  if (error) goto exit;
+
+  for (i = 0; i < TEST_THREADS; i++) {
+    producers[i] = (test_thread_t) { p_q, 1 + i * TEST_THREAD_NODES, TEST_THREAD_NODES, 0 };
+    consumers[i] = (test_thread_t) { p_q, 0, TEST_THREAD_NODES, 0 };
+    pthread_create(&threads[i], NULL, test_consumer, &consumers[i]);
+    pthread_create(&threads[TEST_THREADS + i], NULL, test_producer, &producers[i]);
+  }
+  for (i = 0; i < TEST_THREADS * 2; i++) pthread_join(threads[i], NULL);
+
+  // Every node 1..total must come out exactly once
+  expected = (uint64_t) total * (total + 1) / 2;
+  for (i = 0; i < TEST_THREADS; i++) sum += consumers[i].sum;
+  if (sum != expected) {
+    ockam_log_error("%s", "mpmc threads lost or duplicated nodes");
+    error = QUEUE_ERROR_EMPTY;
+  }
+
+exit:
+  if (p_q) uninit_queue(p_q);
+  return error;
+}
+
+int main()
+{
+  ockam_error_t            error      = OCKAM_ERROR_NONE;
+  ockam_memory_t           memory     = { 0 };
+  ockam_queue_t*           p_q        = NULL;
+  ockam_queue_attributes_t attributes = { 0 };
+  int                      ret_error  = -1;
+
+  error = ockam_memory_stdlib_init(&memory);
+  if (error) goto exit;
+
+  // Reject sizes outside the supported range
+  attributes.p_memory   = &memory;
+  attributes.queue_size = OCKAM_QUEUE_LOCKFREE_MAX_SIZE + 1;
+  if (QUEUE_ERROR_PARAMETER != ockam_queue_spsc_init(&p_q, &attributes)) goto exit;
+  attributes.queue_size = 0;
+  if (QUEUE_ERROR_PARAMETER != ockam_queue_mpmc_init(&p_q, &attributes)) goto exit;
+
+  error = test_queue_single(ockam_queue_spsc_init, &memory);
+  if (error) goto exit;
+
+  error = test_queue_single(ockam_queue_mpmc_init, &memory);
+  if (error) goto exit;
+
+  error = test_queue_mpmc_threads(&memory);
+  if (error) goto exit;
+
+  ret_error = 0;
+
+exit:
+  printf("Queue lockfree test ended with error %d\n", ret_error);
+  return ret_error;
+}
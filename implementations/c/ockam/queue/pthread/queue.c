@@ -1,25 +1,49 @@
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
+#include <time.h>
 #include "ockam/queue.h"
+#include "ockam/queue/impl.h"
 #include "ockam/error.h"
 #include "ockam/log.h"
 
-struct ockam_queue_t {
+typedef struct {
   ockam_memory_t* p_memory;
   uint16_t        max_size;
   uint16_t        size;
   uint16_t        head;
   uint16_t        tail;
   pthread_mutex_t modify_lock;
+  pthread_cond_t  not_full;
   pthread_cond_t* p_alert;
   void**          nodes;
-};
+} queue_pthread_ctx_t;
+
+ockam_error_t queue_pthread_uninit(ockam_queue_t* p_q);
+ockam_error_t queue_pthread_enqueue(ockam_queue_t* p_q, void* node);
+ockam_error_t queue_pthread_dequeue(ockam_queue_t* p_q, void** pp_node);
+ockam_error_t queue_pthread_enqueue_batch(ockam_queue_t* p_q, void** nodes, size_t count, size_t* p_enqueued);
+ockam_error_t queue_pthread_dequeue_batch(ockam_queue_t* p_q, void** nodes, size_t count, size_t* p_dequeued);
+ockam_error_t queue_pthread_size(ockam_queue_t* p_q, uint16_t* p_size);
+ockam_error_t queue_pthread_max_size(ockam_queue_t* p_q, uint16_t* p_size);
+ockam_error_t queue_pthread_grow(ockam_queue_t* p_q, uint16_t new_max_size);
+ockam_error_t queue_pthread_enqueue_wait(ockam_queue_t* p_q, void* node, uint32_t timeout_ms);
+
+ockam_queue_dispatch_table_t queue_pthread_dispatch_table = { &queue_pthread_uninit,        &queue_pthread_enqueue,
+                                                              &queue_pthread_dequeue,       &queue_pthread_enqueue_batch,
+                                                              &queue_pthread_dequeue_batch, &queue_pthread_size,
+                                                              &queue_pthread_max_size,      &queue_pthread_grow,
+                                                              &queue_pthread_enqueue_wait };
 
 ockam_error_t init_queue(ockam_queue_t** pp_queue, ockam_queue_attributes_t* p_attributes)
 {
-  ockam_error_t  error      = OCKAM_ERROR_NONE;
-  ockam_queue_t* p_queue    = NULL;
+  ockam_error_t        error      = OCKAM_ERROR_NONE;
+  ockam_queue_t*       p_queue    = NULL;
+  queue_pthread_ctx_t* p_ctx      = NULL;
+  size_t               nodes_size = 0;
+  int16_t              lock_made  = 0;
+  int16_t              cond_made  = 0;
+  pthread_condattr_t   cond_attr;
 
   if ((NULL == p_attributes) || (NULL == pp_queue)) {
     error = QUEUE_ERROR_PARAMETER;
@@ -31,231 +55,343 @@ ockam_error_t init_queue(ockam_queue_t** pp_queue, ockam_queue_attributes_t* p_a
   }
   *pp_queue = NULL;
 
-  // Allocate memory for queue struct
-  error             = ockam_memory_alloc_zeroed(p_attributes->p_memory, (void**) &p_queue, sizeof(ockam_queue_t));
+  // Allocate memory for queue struct and its context
+  error = ockam_memory_alloc_zeroed(p_attributes->p_memory, (void**) &p_queue, sizeof(ockam_queue_t));
+  if (error) goto exit;
+  error = ockam_memory_alloc_zeroed(p_attributes->p_memory, (void**) &p_ctx, sizeof(queue_pthread_ctx_t));
   if (error) goto exit;
-  p_queue->max_size = p_attributes->queue_size;
-  p_queue->p_memory = p_attributes->p_memory;
+  p_ctx->max_size = p_attributes->queue_size;
+  p_ctx->p_memory = p_attributes->p_memory;
 
   // Allocate memory for nodes
-  size_t nodes_size = p_attributes->queue_size * sizeof(void*);
-  error             = ockam_memory_alloc_zeroed(p_attributes->p_memory, (void**)&(p_queue->nodes), nodes_size);
+  nodes_size = p_attributes->queue_size * sizeof(void*);
+  error      = ockam_memory_alloc_zeroed(p_attributes->p_memory, (void**) &(p_ctx->nodes), nodes_size);
   if (error) goto exit;
 
   // Create the queue lock
-  if (0 != pthread_mutex_init(&p_queue->modify_lock, NULL)) {
+  if (0 != pthread_mutex_init(&p_ctx->modify_lock, NULL)) {
+    error = QUEUE_ERROR_MUTEX;
+    goto exit;
+  }
+  lock_made = 1;
+
+  // Create the condition producers wait on in enqueue_wait, timed against the monotonic clock
+  if (0 != pthread_condattr_init(&cond_attr)) {
+    error = QUEUE_ERROR_MUTEX;
+    goto exit;
+  }
+  if ((0 == pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC)) &&
+      (0 == pthread_cond_init(&p_ctx->not_full, &cond_attr))) {
+    cond_made = 1;
+  }
+  pthread_condattr_destroy(&cond_attr);
+  if (!cond_made) {
     error = QUEUE_ERROR_MUTEX;
     goto exit;
   }
 
   // Save the alert condition, if one was given
-  if (NULL != p_attributes->p_alert) p_queue->p_alert = p_attributes->p_alert;
+  if (NULL != p_attributes->p_alert) p_ctx->p_alert = p_attributes->p_alert;
 
   // Success
-  *pp_queue = p_queue;
+  p_queue->dispatch = &queue_pthread_dispatch_table;
+  p_queue->context  = p_ctx;
+  *pp_queue         = p_queue;
 
 exit:
-  if (error && (NULL != p_queue)) {
-    pthread_mutex_destroy(&p_queue->modify_lock);
-    ockam_memory_free(p_attributes->p_memory, p_queue->nodes, nodes_size);
-    ockam_memory_free(p_attributes->p_memory, p_queue, sizeof(ockam_queue_t));
+  if (error && (NULL != p_ctx)) {
+    if (cond_made) pthread_cond_destroy(&p_ctx->not_full);
+    if (lock_made) pthread_mutex_destroy(&p_ctx->modify_lock);
+    if (p_ctx->nodes) ockam_memory_free(p_attributes->p_memory, p_ctx->nodes, nodes_size);
+    ockam_memory_free(p_attributes->p_memory, p_ctx, sizeof(queue_pthread_ctx_t));
   }
+  if (error && (NULL != p_queue)) ockam_memory_free(p_attributes->p_memory, p_queue, sizeof(ockam_queue_t));
   if (error) ockam_log_error("%x", error);
   return error;
 };
 
-ockam_error_t enqueue(ockam_queue_t* p_q, void* node)
+ockam_error_t queue_pthread_enqueue(ockam_queue_t* p_q, void* node)
 {
-  ockam_error_t error       = OCKAM_ERROR_NONE;
-  int16_t       q_is_locked = 0;
-
-  // Validate parameters
-  if ((NULL == p_q) || (NULL == node)) {
-    ockam_log_error("%s", "Invalid parameter in enqueue");
-    error = QUEUE_ERROR_PARAMETER;
-    goto exit;
-  }
+  ockam_error_t        error       = OCKAM_ERROR_NONE;
+  queue_pthread_ctx_t* p_ctx       = (queue_pthread_ctx_t*) p_q->context;
+  int16_t              q_is_locked = 0;
 
   // Lock the queue
-  if (0 != pthread_mutex_lock(&p_q->modify_lock)) {
+  if (0 != pthread_mutex_lock(&p_ctx->modify_lock)) {
     error = QUEUE_ERROR_MUTEX_LOCK;
     goto exit;
   }
   q_is_locked = 1;
 
   // Check for queue full
-  if (p_q->size == p_q->max_size) {
+  if (p_ctx->size == p_ctx->max_size) {
     // TODO: Would it be better to instead grow queue?
     error = QUEUE_ERROR_FULL;
     goto exit;
   }
 
   // Add node to queue tail and bump queue size
-  p_q->nodes[p_q->tail] = node;
-  p_q->tail             = (p_q->tail + 1) % p_q->max_size;
-  p_q->size += 1;
+  p_ctx->nodes[p_ctx->tail] = node;
+  p_ctx->tail               = (p_ctx->tail + 1) % p_ctx->max_size;
+  p_ctx->size += 1;
 
   // Trigger the alert condition, if we have one
-  if (NULL != p_q->p_alert) { pthread_cond_signal(p_q->p_alert); }
+  if (NULL != p_ctx->p_alert) { pthread_cond_signal(p_ctx->p_alert); }
 
 exit:
-  if (error) ockam_log_error("%x", error);
-  if (q_is_locked) pthread_mutex_unlock(&p_q->modify_lock);
+  if (error && (QUEUE_ERROR_FULL != error)) ockam_log_error("%x", error);
+  if (q_is_locked) pthread_mutex_unlock(&p_ctx->modify_lock);
   return error;
 }
 
-ockam_error_t dequeue(ockam_queue_t* p_q, void** pp_node)
+ockam_error_t queue_pthread_enqueue_wait(ockam_queue_t* p_q, void* node, uint32_t timeout_ms)
 {
-  ockam_error_t error       = OCKAM_ERROR_NONE;
-  int16_t       q_is_locked = 0;
+  ockam_error_t        error       = OCKAM_ERROR_NONE;
+  queue_pthread_ctx_t* p_ctx       = (queue_pthread_ctx_t*) p_q->context;
+  int16_t              q_is_locked = 0;
+  int                  wait_error  = 0;
+  struct timespec      deadline;
+
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+  deadline.tv_sec += timeout_ms / 1000u;
+  deadline.tv_nsec += (long) (timeout_ms % 1000u) * 1000000L;
+  if (deadline.tv_nsec >= 1000000000L) {
+    deadline.tv_sec += 1;
+    deadline.tv_nsec -= 1000000000L;
+  }
 
-  // Validate parameters
-  if ((NULL == p_q) || (NULL == pp_node)) {
-    ockam_log_error("%s", "invalid parameter in dequeue");
-    error = QUEUE_ERROR_PARAMETER;
+  // Lock the queue
+  if (0 != pthread_mutex_lock(&p_ctx->modify_lock)) {
+    error = QUEUE_ERROR_MUTEX_LOCK;
     goto exit;
   }
+  q_is_locked = 1;
+
+  // Wait for a consumer to make room, dequeue and grow signal not_full
+  while ((p_ctx->size == p_ctx->max_size) && (0 == wait_error)) {
+    if (QUEUE_WAIT_FOREVER == timeout_ms) {
+      wait_error = pthread_cond_wait(&p_ctx->not_full, &p_ctx->modify_lock);
+    } else {
+      wait_error = pthread_cond_timedwait(&p_ctx->not_full, &p_ctx->modify_lock, &deadline);
+    }
+  }
+
+  if (p_ctx->size == p_ctx->max_size) {
+    error = QUEUE_ERROR_FULL;
+    goto exit;
+  }
+
+  // Add node to queue tail and bump queue size
+  p_ctx->nodes[p_ctx->tail] = node;
+  p_ctx->tail               = (p_ctx->tail + 1) % p_ctx->max_size;
+  p_ctx->size += 1;
+
+  // Trigger the alert condition, if we have one
+  if (NULL != p_ctx->p_alert) { pthread_cond_signal(p_ctx->p_alert); }
+
+exit:
+  if (error && (QUEUE_ERROR_FULL != error)) ockam_log_error("%x", error);
+  if (q_is_locked) pthread_mutex_unlock(&p_ctx->modify_lock);
+  return error;
+}
+
+ockam_error_t queue_pthread_dequeue(ockam_queue_t* p_q, void** pp_node)
+{
+  ockam_error_t        error       = OCKAM_ERROR_NONE;
+  queue_pthread_ctx_t* p_ctx       = (queue_pthread_ctx_t*) p_q->context;
+  int16_t              q_is_locked = 0;
 
   // Lock the queue
-  if (0 != pthread_mutex_lock(&p_q->modify_lock)) {
+  if (0 != pthread_mutex_lock(&p_ctx->modify_lock)) {
     error = QUEUE_ERROR_MUTEX_LOCK;
     goto exit;
   }
   q_is_locked = 1;
 
   // Check for queue empty
-  if (0 == p_q->size) {
+  if (0 == p_ctx->size) {
     error = QUEUE_ERROR_EMPTY;
     goto exit;
   }
 
   // Dequeue node and decrease size
-  *pp_node              = p_q->nodes[p_q->head];
-  p_q->nodes[p_q->head] = NULL;
-  p_q->head             = (p_q->head + 1) % p_q->max_size;
-  p_q->size -= 1;
+  *pp_node                  = p_ctx->nodes[p_ctx->head];
+  p_ctx->nodes[p_ctx->head] = NULL;
+  p_ctx->head               = (p_ctx->head + 1) % p_ctx->max_size;
+  p_ctx->size -= 1;
+
+  // Wake a producer waiting for room
+  pthread_cond_signal(&p_ctx->not_full);
 
 exit:
-  if (error) ockam_log_error("%x", error);
-  if (q_is_locked) pthread_mutex_unlock(&p_q->modify_lock);
+  if (error && (QUEUE_ERROR_EMPTY != error)) ockam_log_error("%x", error);
+  if (q_is_locked) pthread_mutex_unlock(&p_ctx->modify_lock);
   return error;
 }
 
-ockam_error_t uninit_queue(ockam_queue_t* p_q)
+ockam_error_t queue_pthread_enqueue_batch(ockam_queue_t* p_q, void** nodes, size_t count, size_t* p_enqueued)
 {
-  ockam_error_t   error       = OCKAM_ERROR_NONE;
-  int16_t         q_is_locked = 0;
-  pthread_mutex_t lock;
-
-  // Validate parameters
-  if (NULL == p_q) {
-    error = QUEUE_ERROR_PARAMETER;
-    goto exit;
-  }
+  ockam_error_t        error = OCKAM_ERROR_NONE;
+  queue_pthread_ctx_t* p_ctx = (queue_pthread_ctx_t*) p_q->context;
+  size_t               i     = 0;
 
-  // Lock the queue
-  if (0 != pthread_mutex_lock(&p_q->modify_lock)) {
+  if (0 != pthread_mutex_lock(&p_ctx->modify_lock)) {
     error = QUEUE_ERROR_MUTEX_LOCK;
     goto exit;
   }
-  q_is_locked = 1;
-  lock        = p_q->modify_lock;
 
-  // Free up the memory
-  error = ockam_memory_free(p_q->p_memory, p_q->nodes, 0);
-  if (OCKAM_ERROR_NONE != error) {
-    goto exit;
+  // Take the lock once for as many nodes as fit
+  for (i = 0; (i < count) && (p_ctx->size < p_ctx->max_size); i++) {
+    p_ctx->nodes[p_ctx->tail] = nodes[i];
+    p_ctx->tail               = (p_ctx->tail + 1) % p_ctx->max_size;
+    p_ctx->size += 1;
   }
 
-  // TODO: passing 0 as len may not work properly with all implementations
-  error = ockam_memory_free(p_q->p_memory, p_q, 0);
+  if ((i > 0) && (NULL != p_ctx->p_alert)) { pthread_cond_signal(p_ctx->p_alert); }
+
+  pthread_mutex_unlock(&p_ctx->modify_lock);
+
+  *p_enqueued = i;
+  if (0 == i) error = QUEUE_ERROR_FULL;
 
 exit:
-  if (q_is_locked) pthread_mutex_unlock(&lock);
   return error;
 }
 
-ockam_error_t queue_max_size(ockam_queue_t* p_q, uint16_t* p_size)
+ockam_error_t queue_pthread_dequeue_batch(ockam_queue_t* p_q, void** nodes, size_t count, size_t* p_dequeued)
 {
-  ockam_error_t error = OCKAM_ERROR_NONE;
+  ockam_error_t        error = OCKAM_ERROR_NONE;
+  queue_pthread_ctx_t* p_ctx = (queue_pthread_ctx_t*) p_q->context;
+  size_t               i     = 0;
 
-  if (NULL == p_q || NULL == p_size) {
-    error = QUEUE_ERROR_PARAMETER;
+  if (0 != pthread_mutex_lock(&p_ctx->modify_lock)) {
+    error = QUEUE_ERROR_MUTEX_LOCK;
     goto exit;
   }
 
-  *p_size = p_q->max_size;
+  for (i = 0; (i < count) && (p_ctx->size > 0); i++) {
+    nodes[i]                  = p_ctx->nodes[p_ctx->head];
+    p_ctx->nodes[p_ctx->head] = NULL;
+    p_ctx->head               = (p_ctx->head + 1) % p_ctx->max_size;
+    p_ctx->size -= 1;
+  }
+
+  if (i > 0) { pthread_cond_broadcast(&p_ctx->not_full); }
+
+  pthread_mutex_unlock(&p_ctx->modify_lock);
+
+  *p_dequeued = i;
+  if (0 == i) error = QUEUE_ERROR_EMPTY;
 
 exit:
   return error;
 }
 
-ockam_error_t queue_size(ockam_queue_t* p_q, uint16_t* p_size)
+ockam_error_t queue_pthread_uninit(ockam_queue_t* p_q)
 {
-  ockam_error_t error = OCKAM_ERROR_NONE;
+  ockam_error_t        error  = OCKAM_ERROR_NONE;
+  queue_pthread_ctx_t* p_ctx  = (queue_pthread_ctx_t*) p_q->context;
+  ockam_memory_t*      memory = p_ctx->p_memory;
 
-  if (NULL == p_q || NULL == p_size) {
-    error = QUEUE_ERROR_PARAMETER;
+  // Make sure no one is still holding the lock, then tear it down
+  if (0 != pthread_mutex_lock(&p_ctx->modify_lock)) {
+    error = QUEUE_ERROR_MUTEX_LOCK;
     goto exit;
   }
+  pthread_mutex_unlock(&p_ctx->modify_lock);
+  pthread_mutex_destroy(&p_ctx->modify_lock);
+  pthread_cond_destroy(&p_ctx->not_full);
+
+  // Free up the memory
+  error = ockam_memory_free(memory, p_ctx->nodes, p_ctx->max_size * sizeof(void*));
+  if (OCKAM_ERROR_NONE != error) { goto exit; }
+
+  error = ockam_memory_free(memory, p_ctx, sizeof(queue_pthread_ctx_t));
+  if (OCKAM_ERROR_NONE != error) { goto exit; }
 
-  *p_size = p_q->size;
+  error = ockam_memory_free(memory, p_q, sizeof(ockam_queue_t));
 
 exit:
   return error;
 }
 
-ockam_error_t grow_queue(ockam_queue_t* p_q, uint16_t new_max_size)
+ockam_error_t queue_pthread_max_size(ockam_queue_t* p_q, uint16_t* p_size)
 {
-  ockam_error_t error       = OCKAM_ERROR_NONE;
-  int16_t       q_is_locked = 0;
+  queue_pthread_ctx_t* p_ctx = (queue_pthread_ctx_t*) p_q->context;
+
+  *p_size = p_ctx->max_size;
+
+  return OCKAM_ERROR_NONE;
+}
+
+ockam_error_t queue_pthread_size(ockam_queue_t* p_q, uint16_t* p_size)
+{
+  queue_pthread_ctx_t* p_ctx = (queue_pthread_ctx_t*) p_q->context;
+
+  *p_size = p_ctx->size;
+
+  return OCKAM_ERROR_NONE;
+}
+
+ockam_error_t queue_pthread_grow(ockam_queue_t* p_q, uint16_t new_max_size)
+{
+  ockam_error_t        error       = OCKAM_ERROR_NONE;
+  queue_pthread_ctx_t* p_ctx       = (queue_pthread_ctx_t*) p_q->context;
+  int16_t              q_is_locked = 0;
+  size_t               nodes_size  = 0;
+  void**               new_nodes   = NULL;
 
   // Validate parameters
-  if ((NULL == p_q) || (new_max_size <= p_q->max_size)) {
+  if (new_max_size <= p_ctx->max_size) {
     ockam_log_error("%s", "Invalid parameter in grow_queue");
     error = QUEUE_ERROR_PARAMETER;
     goto exit;
   }
 
   // Lock the queue
-  if (0 != pthread_mutex_lock(&p_q->modify_lock)) {
+  if (0 != pthread_mutex_lock(&p_ctx->modify_lock)) {
     error = QUEUE_ERROR_MUTEX_LOCK;
     goto exit;
   }
   q_is_locked = 1;
 
   // Allocate memory for new nodes
-  size_t nodes_size = new_max_size * sizeof(void*);
-  void** new_nodes  = NULL;
-  error             = ockam_memory_alloc_zeroed(p_q->p_memory, (void**)&new_nodes, nodes_size);
+  nodes_size = new_max_size * sizeof(void*);
+  error      = ockam_memory_alloc_zeroed(p_ctx->p_memory, (void**) &new_nodes, nodes_size);
   if (error) goto exit;
 
   // Copy old nodes
-  if (p_q->size != 0) {
-    if (p_q->tail > p_q->head) {
-      error = ockam_memory_copy(p_q->p_memory, &new_nodes[0], &p_q->nodes[p_q->head], p_q->size * sizeof(void*));
+  if (p_ctx->size != 0) {
+    if (p_ctx->tail > p_ctx->head) {
+      error =
+        ockam_memory_copy(p_ctx->p_memory, &new_nodes[0], &p_ctx->nodes[p_ctx->head], p_ctx->size * sizeof(void*));
     } else {
-      size_t size1 = p_q->max_size - p_q->head;
-      error = ockam_memory_copy(p_q->p_memory, &new_nodes[0], &p_q->nodes[p_q->head], size1 * sizeof(void*));
+      size_t size1 = p_ctx->max_size - p_ctx->head;
+      error        = ockam_memory_copy(p_ctx->p_memory, &new_nodes[0], &p_ctx->nodes[p_ctx->head], size1 * sizeof(void*));
       if (error) goto exit;
-      ockam_memory_copy(p_q->p_memory, &new_nodes[size1], &p_q->nodes[0], (p_q->size - size1) * sizeof(void*));
+      ockam_memory_copy(
+        p_ctx->p_memory, &new_nodes[size1], &p_ctx->nodes[0], (p_ctx->size - size1) * sizeof(void*));
     }
   }
 
   if (error) goto exit;
 
-  p_q->max_size = new_max_size;
-  error = ockam_memory_free(p_q->p_memory, p_q->nodes, 0);
+  error = ockam_memory_free(p_ctx->p_memory, p_ctx->nodes, p_ctx->max_size * sizeof(void*));
   if (error) goto exit;
-  p_q->nodes = new_nodes;
-  p_q->head = 0;
-  p_q->tail = (p_q->head + p_q->size) % new_max_size;
+  p_ctx->max_size = new_max_size;
+  p_ctx->nodes    = new_nodes;
+  new_nodes       = NULL;
+  p_ctx->head     = 0;
+  p_ctx->tail     = (p_ctx->head + p_ctx->size) % new_max_size;
+
+  // The new room is free for producers waiting in enqueue_wait
+  pthread_cond_broadcast(&p_ctx->not_full);
 
 exit:
-  if (q_is_locked) pthread_mutex_unlock(&p_q->modify_lock);
+  if (q_is_locked) pthread_mutex_unlock(&p_ctx->modify_lock);
   if (error) {
-    ockam_memory_free(p_q->p_memory, new_nodes, 0);
+    if (new_nodes) ockam_memory_free(p_ctx->p_memory, new_nodes, nodes_size);
     ockam_log_error("%x", error);
   }
   return error;
-}
\ No newline at end of file
+}
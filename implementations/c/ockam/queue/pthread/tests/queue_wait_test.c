@@ -0,0 +1,122 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+#include "ockam/queue.h"
+#include "ockam/log.h"
+#include "ockam/memory.h"
+#include "ockam/memory/stdlib.h"
+
+#define TEST_QUEUE_SIZE 2
+#define TEST_TIMEOUT_MS 50
+
+uint64_t now_ms(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000u + (uint64_t) ts.tv_nsec / 1000000u;
+}
+
+void* consumer(void* arg)
+{
+  ockam_queue_t*  p_q    = (ockam_queue_t*) arg;
+  void*           p_node = NULL;
+  struct timespec pause  = { 0, TEST_TIMEOUT_MS * 1000000L };
+
+  // Give the producer time to block before making room
+  nanosleep(&pause, NULL);
+  dequeue(p_q, &p_node);
+  return p_node;
+}
+
+int main()
+{
+  char                     nodes[4][2] = { "1", "2", "3", "4" };
+  ockam_queue_t*           p_q         = NULL;
+  ockam_error_t            error       = OCKAM_ERROR_NONE;
+  ockam_queue_attributes_t attributes  = { 0 };
+  ockam_memory_t           memory      = { 0 };
+  void*                    p_node      = NULL;
+  pthread_t                thread;
+  uint64_t                 start     = 0;
+  int                      ret_error = -1;
+
+  error = ockam_memory_stdlib_init(&memory);
+  if (error) goto exit;
+
+  attributes.p_memory   = &memory;
+  attributes.queue_size = TEST_QUEUE_SIZE;
+
+  error = init_queue(&p_q, &attributes);
+  if (error) goto exit;
+
+  // Room in the queue, enqueue_wait returns at once
+  for (int i = 0; i < TEST_QUEUE_SIZE; ++i) {
+    error = enqueue_wait(p_q, nodes[i], QUEUE_WAIT_FOREVER);
+    if (error) {
+      ockam_log_error("%s", "enqueue_wait failed while populating queue");
+      goto exit;
+    }
+  }
+
+  // A zero timeout behaves like enqueue
+  error = enqueue_wait(p_q, nodes[2], 0);
+  if (QUEUE_ERROR_FULL != error) {
+    ockam_log_error("%s", "enqueue_wait with no timeout didn't return queue full");
+    goto exit;
+  }
+
+  // Nobody makes room, so the wait times out
+  start = now_ms();
+  error = enqueue_wait(p_q, nodes[2], TEST_TIMEOUT_MS);
+  if (QUEUE_ERROR_FULL != error) {
+    ockam_log_error("%s", "enqueue_wait didn't time out");
+    goto exit;
+  }
+  if (now_ms() - start < TEST_TIMEOUT_MS - 1) {
+    ockam_log_error("%s", "enqueue_wait returned before its timeout");
+    goto exit;
+  }
+
+  // A consumer makes room while the producer waits
+  if (0 != pthread_create(&thread, NULL, consumer, p_q)) goto exit;
+  error = enqueue_wait(p_q, nodes[2], QUEUE_WAIT_FOREVER);
+  pthread_join(thread, &p_node);
+  if (error) {
+    ockam_log_error("%s", "enqueue_wait failed after a dequeue");
+    goto exit;
+  }
+  if (p_node != nodes[0]) {
+    ockam_log_error("%s", "consumer dequeued the wrong node");
+    goto exit;
+  }
+
+  // Growing the queue makes room too
+  error = grow_queue(p_q, TEST_QUEUE_SIZE + 1);
+  if (error) goto exit;
+  error = enqueue_wait(p_q, nodes[3], 0);
+  if (error) {
+    ockam_log_error("%s", "enqueue_wait failed after growing the queue");
+    goto exit;
+  }
+
+  // Nodes come out in the order they went in
+  for (int i = 1; i < 4; ++i) {
+    error = dequeue(p_q, &p_node);
+    if (error) goto exit;
+    if (p_node != nodes[i]) {
+      ockam_log_error("%s", "wrong node returned");
+      goto exit;
+    }
+  }
+
+  error = uninit_queue(p_q);
+  if (error) goto exit;
+
+  ret_error = 0;
+  printf("Queue wait test successful!\n");
+
+exit:
+  if (error) ockam_log_error("%s", __func__);
+  return ret_error;
+}
@@ -0,0 +1,200 @@
+/**
+ * @file  queue.c
+ * @brief
+ */
+
+#include <time.h>
+
+#include "ockam/error.h"
+#include "ockam/queue.h"
+
+#include "ockam/queue/impl.h"
+
+ockam_error_t uninit_queue(ockam_queue_t* p_q)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((p_q == 0) || (p_q->dispatch == 0)) {
+    error = QUEUE_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  error = p_q->dispatch->uninit(p_q);
+
+exit:
+  return error;
+}
+
+ockam_error_t enqueue(ockam_queue_t* p_q, void* node)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((p_q == 0) || (p_q->dispatch == 0) || (node == 0)) {
+    error = QUEUE_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  error = p_q->dispatch->enqueue(p_q, node);
+
+exit:
+  return error;
+}
+
+uint64_t queue_now_ms(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000u + (uint64_t) ts.tv_nsec / 1000000u;
+}
+
+ockam_error_t enqueue_wait(ockam_queue_t* p_q, void* node, uint32_t timeout_ms)
+{
+  ockam_error_t   error    = OCKAM_ERROR_NONE;
+  uint64_t        deadline = 0;
+  struct timespec pause    = { 0, 1000000 };
+
+  if ((p_q == 0) || (p_q->dispatch == 0) || (node == 0)) {
+    error = QUEUE_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  if (p_q->dispatch->enqueue_wait != 0) {
+    error = p_q->dispatch->enqueue_wait(p_q, node, timeout_ms);
+    goto exit;
+  }
+
+  // No way to be told when a consumer makes room, so check again every millisecond
+  deadline = queue_now_ms() + timeout_ms;
+  while (QUEUE_ERROR_FULL == (error = p_q->dispatch->enqueue(p_q, node))) {
+    if ((QUEUE_WAIT_FOREVER != timeout_ms) && (queue_now_ms() >= deadline)) break;
+    nanosleep(&pause, NULL);
+  }
+
+exit:
+  return error;
+}
+
+ockam_error_t dequeue(ockam_queue_t* p_q, void** pp_node)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((p_q == 0) || (p_q->dispatch == 0) || (pp_node == 0)) {
+    error = QUEUE_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  error = p_q->dispatch->dequeue(p_q, pp_node);
+
+exit:
+  return error;
+}
+
+ockam_error_t enqueue_batch(ockam_queue_t* p_q, void** nodes, size_t count, size_t* p_enqueued)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+  size_t        i     = 0;
+
+  if ((p_q == 0) || (p_q->dispatch == 0) || (p_enqueued == 0) || ((nodes == 0) && (count != 0))) {
+    error = QUEUE_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  *p_enqueued = 0;
+  if (count == 0) { goto exit; }
+
+  if (p_q->dispatch->enqueue_batch != 0) {
+    error = p_q->dispatch->enqueue_batch(p_q, nodes, count, p_enqueued);
+    goto exit;
+  }
+
+  for (i = 0; i < count; i++) {
+    error = p_q->dispatch->enqueue(p_q, nodes[i]);
+    if (error != OCKAM_ERROR_NONE) { break; }
+  }
+
+  *p_enqueued = i;
+  if (i > 0) { error = OCKAM_ERROR_NONE; }
+
+exit:
+  return error;
+}
+
+ockam_error_t dequeue_batch(ockam_queue_t* p_q, void** nodes, size_t count, size_t* p_dequeued)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+  size_t        i     = 0;
+
+  if ((p_q == 0) || (p_q->dispatch == 0) || (p_dequeued == 0) || ((nodes == 0) && (count != 0))) {
+    error = QUEUE_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  *p_dequeued = 0;
+  if (count == 0) { goto exit; }
+
+  if (p_q->dispatch->dequeue_batch != 0) {
+    error = p_q->dispatch->dequeue_batch(p_q, nodes, count, p_dequeued);
+    goto exit;
+  }
+
+  for (i = 0; i < count; i++) {
+    error = p_q->dispatch->dequeue(p_q, &nodes[i]);
+    if (error != OCKAM_ERROR_NONE) { break; }
+  }
+
+  *p_dequeued = i;
+  if (i > 0) { error = OCKAM_ERROR_NONE; }
+
+exit:
+  return error;
+}
+
+ockam_error_t queue_size(ockam_queue_t* p_q, uint16_t* p_size)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((p_q == 0) || (p_q->dispatch == 0) || (p_size == 0)) {
+    error = QUEUE_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  error = p_q->dispatch->size(p_q, p_size);
+
+exit:
+  return error;
+}
+
+ockam_error_t queue_max_size(ockam_queue_t* p_q, uint16_t* p_size)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((p_q == 0) || (p_q->dispatch == 0) || (p_size == 0)) {
+    error = QUEUE_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  error = p_q->dispatch->max_size(p_q, p_size);
+
+exit:
+  return error;
+}
+
+ockam_error_t grow_queue(ockam_queue_t* p_q, uint16_t new_max_size)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((p_q == 0) || (p_q->dispatch == 0)) {
+    error = QUEUE_ERROR_PARAMETER;
+    goto exit;
+  }
+
+  if (p_q->dispatch->grow == 0) {
+    error = QUEUE_ERROR_UNSUPPORTED;
+    goto exit;
+  }
+
+  error = p_q->dispatch->grow(p_q, new_max_size);
+
+exit:
+  return error;
+}
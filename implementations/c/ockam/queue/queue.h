@@ -6,11 +6,15 @@
 #include "ockam/memory.h"
 #include "ockam/memory/stdlib.h"
 
-#define QUEUE_ERROR_PARAMETER  (OCKAM_ERROR_INTERFACE_QUEUE | 0x0001u)
-#define QUEUE_ERROR_MUTEX      (OCKAM_ERROR_INTERFACE_QUEUE | 0x0002u)
-#define QUEUE_ERROR_MUTEX_LOCK (OCKAM_ERROR_INTERFACE_QUEUE | 0x0003u)
-#define QUEUE_ERROR_FULL       (OCKAM_ERROR_INTERFACE_QUEUE | 0x0004u)
-#define QUEUE_ERROR_EMPTY      (OCKAM_ERROR_INTERFACE_QUEUE | 0x0005u)
+#define QUEUE_ERROR_PARAMETER   (OCKAM_ERROR_INTERFACE_QUEUE | 0x0001u)
+#define QUEUE_ERROR_MUTEX       (OCKAM_ERROR_INTERFACE_QUEUE | 0x0002u)
+#define QUEUE_ERROR_MUTEX_LOCK  (OCKAM_ERROR_INTERFACE_QUEUE | 0x0003u)
+#define QUEUE_ERROR_FULL        (OCKAM_ERROR_INTERFACE_QUEUE | 0x0004u)
+#define QUEUE_ERROR_EMPTY       (OCKAM_ERROR_INTERFACE_QUEUE | 0x0005u)
+#define QUEUE_ERROR_UNSUPPORTED (OCKAM_ERROR_INTERFACE_QUEUE | 0x0006u)
+
+/* Timeout for enqueue_wait() that never gives up */
+#define QUEUE_WAIT_FOREVER UINT32_MAX
 
 typedef struct ockam_queue_t ockam_queue_t;
 
@@ -20,6 +24,7 @@ typedef struct ockam_queue_attributes_t {
   pthread_cond_t* p_alert;
 } ockam_queue_attributes_t;
 
+/* Creates the mutex based queue from ockam::queue_pthread, see ockam/queue/lockfree.h for the lock-free queues */
 ockam_error_t init_queue(ockam_queue_t** pp_queue, ockam_queue_attributes_t* p_attributes);
 ockam_error_t enqueue(ockam_queue_t* p_q, void* node);
 ockam_error_t dequeue(ockam_queue_t* p_q, void** node);
@@ -28,4 +33,19 @@ ockam_error_t queue_size(ockam_queue_t* p_q, uint16_t* p_size);
 ockam_error_t queue_max_size(ockam_queue_t* p_q, uint16_t* p_size);
 ockam_error_t grow_queue(ockam_queue_t* p_q, uint16_t new_max_size);
 
+/*
+ * enqueue() returns QUEUE_ERROR_FULL at once when there is no room. enqueue_wait() instead blocks until a consumer
+ * makes room or timeout_ms passes, then returns QUEUE_ERROR_FULL. A timeout of 0 behaves like enqueue(), and
+ * QUEUE_WAIT_FOREVER waits as long as it takes.
+ */
+ockam_error_t enqueue_wait(ockam_queue_t* p_q, void* node, uint32_t timeout_ms);
+
+/*
+ * Batch variants move as many nodes as possible in one operation, in order. The number moved is returned in
+ * p_enqueued/p_dequeued; QUEUE_ERROR_FULL or QUEUE_ERROR_EMPTY is returned only when no node could be moved, so a
+ * producer can apply backpressure by retrying with the nodes that are left.
+ */
+ockam_error_t enqueue_batch(ockam_queue_t* p_q, void** nodes, size_t count, size_t* p_enqueued);
+ockam_error_t dequeue_batch(ockam_queue_t* p_q, void** nodes, size_t count, size_t* p_dequeued);
+
 #endif
@@ -0,0 +1,231 @@
+/**
+ * @file    drbg.c
+ * @brief   impl of Ockam's random functions using a per-thread ChaCha20 generator
+ *
+ * Each refill runs ChaCha20 under the current key for OCKAM_RANDOM_DRBG_BUFFER_SIZE bytes. The first 32 bytes become
+ * the next key and are wiped from the buffer, the rest are handed out and wiped as they are consumed. Reseeding XORs
+ * 32 fresh bytes from the kernel into the key and discards whatever was left in the buffer.
+ */
+
+#include <pthread.h>
+#include <string.h>
+
+#include "ockam/error.h"
+#include "ockam/random.h"
+
+#include "ockam/random/impl.h"
+#include "ockam/random/drbg.h"
+#include "ockam/random/urandom.h"
+
+#define RANDOM_DRBG_KEY_SIZE   32u
+#define RANDOM_DRBG_BLOCK_SIZE 64u
+
+#define RANDOM_DRBG_ROTL(v, n) (((v) << (n)) | ((v) >> (32u - (n))))
+
+#define RANDOM_DRBG_QUARTER_ROUND(a, b, c, d)                                                                           \
+  a += b;                                                                                                              \
+  d ^= a;                                                                                                              \
+  d = RANDOM_DRBG_ROTL(d, 16u);                                                                                        \
+  c += d;                                                                                                              \
+  b ^= c;                                                                                                              \
+  b = RANDOM_DRBG_ROTL(b, 12u);                                                                                        \
+  a += b;                                                                                                              \
+  d ^= a;                                                                                                              \
+  d = RANDOM_DRBG_ROTL(d, 8u);                                                                                         \
+  c += d;                                                                                                              \
+  b ^= c;                                                                                                              \
+  b = RANDOM_DRBG_ROTL(b, 7u);
+
+typedef struct {
+  uint32_t key[RANDOM_DRBG_KEY_SIZE / 4];
+  uint8_t  buffer[OCKAM_RANDOM_DRBG_BUFFER_SIZE];
+  size_t   available;
+  size_t   until_reseed;
+  unsigned generation;
+} random_drbg_state_t;
+
+ockam_error_t random_drbg_deinit(ockam_random_t* random);
+ockam_error_t random_drbg_get_bytes(ockam_random_t* random, uint8_t* buffer, size_t buffer_size);
+
+ockam_random_dispatch_table_t random_drbg_dispatch_table = { &random_drbg_deinit, &random_drbg_get_bytes };
+
+static _Thread_local random_drbg_state_t g_drbg_state;
+
+/* Bumped in every child after fork(). Starts at 1 so a thread's zeroed state is stale and seeds on first use. */
+static unsigned       g_drbg_generation = 1;
+static pthread_once_t g_drbg_once       = PTHREAD_ONCE_INIT;
+
+static void random_drbg_fork_child(void)
+{
+  g_drbg_generation++;
+}
+
+static void random_drbg_register_fork(void)
+{
+  pthread_atfork(0, 0, random_drbg_fork_child);
+}
+
+static uint32_t random_drbg_load32(const uint8_t* p)
+{
+  return (uint32_t) p[0] | ((uint32_t) p[1] << 8u) | ((uint32_t) p[2] << 16u) | ((uint32_t) p[3] << 24u);
+}
+
+static void random_drbg_store32(uint8_t* p, uint32_t v)
+{
+  p[0] = (uint8_t) v;
+  p[1] = (uint8_t)(v >> 8u);
+  p[2] = (uint8_t)(v >> 16u);
+  p[3] = (uint8_t)(v >> 24u);
+}
+
+/**
+ * @brief   Produce one ChaCha20 block for the given key and block counter, with an all-zero nonce.
+ */
+static void random_drbg_chacha20_block(const uint32_t* key, uint64_t counter, uint8_t* out)
+{
+  uint32_t in[16];
+  uint32_t x[16];
+  size_t   i;
+
+  in[0]  = 0x61707865u;
+  in[1]  = 0x3320646eu;
+  in[2]  = 0x79622d32u;
+  in[3]  = 0x6b206574u;
+  in[12] = (uint32_t) counter;
+  in[13] = (uint32_t)(counter >> 32u);
+  in[14] = 0;
+  in[15] = 0;
+  for (i = 0; i < 8; i++) { in[4 + i] = key[i]; }
+
+  memcpy(x, in, sizeof(x));
+
+  for (i = 0; i < 10; i++) {
+    RANDOM_DRBG_QUARTER_ROUND(x[0], x[4], x[8], x[12]);
+    RANDOM_DRBG_QUARTER_ROUND(x[1], x[5], x[9], x[13]);
+    RANDOM_DRBG_QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+    RANDOM_DRBG_QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+    RANDOM_DRBG_QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+    RANDOM_DRBG_QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+    RANDOM_DRBG_QUARTER_ROUND(x[2], x[7], x[8], x[13]);
+    RANDOM_DRBG_QUARTER_ROUND(x[3], x[4], x[9], x[14]);
+  }
+
+  for (i = 0; i < 16; i++) { random_drbg_store32(out + (4 * i), x[i] + in[i]); }
+}
+
+static void random_drbg_refill(random_drbg_state_t* state)
+{
+  size_t i;
+
+  for (i = 0; i < OCKAM_RANDOM_DRBG_BUFFER_SIZE / RANDOM_DRBG_BLOCK_SIZE; i++) {
+    random_drbg_chacha20_block(state->key, i, state->buffer + (i * RANDOM_DRBG_BLOCK_SIZE));
+  }
+
+  for (i = 0; i < RANDOM_DRBG_KEY_SIZE / 4; i++) { state->key[i] = random_drbg_load32(state->buffer + (4 * i)); }
+  memset(state->buffer, 0, RANDOM_DRBG_KEY_SIZE);
+
+  state->available = OCKAM_RANDOM_DRBG_BUFFER_SIZE - RANDOM_DRBG_KEY_SIZE;
+}
+
+static ockam_error_t random_drbg_reseed(random_drbg_state_t* state)
+{
+  ockam_error_t  error   = OCKAM_ERROR_NONE;
+  ockam_random_t urandom = { 0 };
+  uint8_t        seed[RANDOM_DRBG_KEY_SIZE];
+  size_t         i;
+
+  error = ockam_random_urandom_init(&urandom);
+  if (error) goto exit;
+
+  error = ockam_random_get_bytes(&urandom, seed, sizeof(seed));
+  if (error) goto exit;
+
+  for (i = 0; i < RANDOM_DRBG_KEY_SIZE / 4; i++) { state->key[i] ^= random_drbg_load32(seed + (4 * i)); }
+
+  random_drbg_refill(state);
+  state->until_reseed = OCKAM_RANDOM_DRBG_RESEED_BYTES;
+  state->generation   = g_drbg_generation;
+
+exit:
+  memset(seed, 0, sizeof(seed));
+  return error;
+}
+
+ockam_error_t ockam_random_drbg_init(ockam_random_t* random)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if (random == 0) {
+    error = OCKAM_RANDOM_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  pthread_once(&g_drbg_once, random_drbg_register_fork);
+
+  random->dispatch = &random_drbg_dispatch_table;
+  random->context  = 0;
+
+exit:
+  return error;
+}
+
+ockam_error_t random_drbg_deinit(ockam_random_t* random)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if (random == 0) {
+    error = OCKAM_RANDOM_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+exit:
+  return error;
+}
+
+ockam_error_t random_drbg_get_bytes(ockam_random_t* random, uint8_t* buffer, size_t buffer_size)
+{
+  ockam_error_t        error         = OCKAM_ERROR_NONE;
+  random_drbg_state_t* state         = &g_drbg_state;
+  size_t               bytes_written = 0;
+
+  if ((random == 0) || (buffer == 0)) {
+    error = OCKAM_RANDOM_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if (buffer_size == 0) {
+    error = OCKAM_RANDOM_ERROR_INVALID_SIZE;
+    goto exit;
+  }
+
+  while (bytes_written < buffer_size) {
+    uint8_t* p_out = 0;
+    size_t   len   = 0;
+
+    if ((state->generation != g_drbg_generation) || (state->until_reseed == 0)) {
+      error = random_drbg_reseed(state);
+      if (error) {
+        error = OCKAM_RANDOM_ERROR_GET_BYTES_FAIL;
+        goto exit;
+      }
+    }
+
+    if (state->available == 0) { random_drbg_refill(state); }
+
+    len = buffer_size - bytes_written;
+    if (len > state->available) { len = state->available; }
+    if (len > state->until_reseed) { len = state->until_reseed; }
+
+    p_out = state->buffer + (OCKAM_RANDOM_DRBG_BUFFER_SIZE - state->available);
+    memcpy(buffer + bytes_written, p_out, len);
+    memset(p_out, 0, len);
+
+    state->available -= len;
+    state->until_reseed -= len;
+    bytes_written += len;
+  }
+
+exit:
+  if (error && buffer) { memset(buffer, 0, bytes_written); }
+  return error;
+}
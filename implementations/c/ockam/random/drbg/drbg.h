@@ -0,0 +1,34 @@
+/**
+ * @file  drbg.h
+ * @brief Buffered ChaCha20 random generator seeded from the kernel
+ */
+
+#ifndef OCKAM_RANDOM_DRBG_H_
+#define OCKAM_RANDOM_DRBG_H_
+
+#include "ockam/error.h"
+#include "ockam/random.h"
+
+#include "ockam/random/impl.h"
+
+/* Output bytes produced by one ChaCha20 refill, of which the first 32 become the next key */
+#define OCKAM_RANDOM_DRBG_BUFFER_SIZE 1024u
+
+/* Output bytes after which a thread's generator mixes in a fresh kernel seed */
+#define OCKAM_RANDOM_DRBG_RESEED_BYTES (1024u * 1024u)
+
+/**
+ * @brief   Initialize a random object backed by a per-thread ChaCha20 generator.
+ *
+ * Every thread keeps its own generator, shared by all drbg random objects used on that thread, so requests take no
+ * locks and make no system calls except when the generator is seeded. Seeds come from the urandom module. Each refill
+ * replaces the key before any output is handed out, so earlier output cannot be recovered from the generator's state.
+ * A generator reseeds after OCKAM_RANDOM_DRBG_RESEED_BYTES of output and the first time it is used in a child process
+ * after fork().
+ * @param   random[in]  The ockam random object to initialize.
+ * @return  OCKAM_ERROR_NONE on success.
+ * @return  OCKAM_RANDOM_ERROR_INVALID_PARAM if invalid random pointer is received.
+ */
+ockam_error_t ockam_random_drbg_init(ockam_random_t* random);
+
+#endif
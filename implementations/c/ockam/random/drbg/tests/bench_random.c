@@ -0,0 +1,161 @@
+/**
+ * @file    bench_random.c
+ * @brief   Throughput of the random backends
+ *
+ * Each thread asks for random bytes in fixed-size requests for a fixed time. The baseline row opens, reads and closes
+ * /dev/urandom for every request, which is what the urandom module did before it kept its source open. The urandom
+ * row goes to the kernel for every request, the drbg row serves requests from the per-thread ChaCha20 generator.
+ *
+ * Usage: ockam_random_bench [threads] [milliseconds_per_run]
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ockam/error.h"
+#include "ockam/random.h"
+
+#include "ockam/random/drbg.h"
+#include "ockam/random/urandom.h"
+
+#define BENCH_DEFAULT_THREADS 1
+#define BENCH_DEFAULT_MS      300
+#define BENCH_MAX_THREADS     64
+#define BENCH_MAX_SIZE        65536u
+
+typedef enum { BENCH_BASELINE = 0, BENCH_URANDOM, BENCH_DRBG, BENCH_BACKENDS } bench_backend_t;
+
+static const char*  g_bench_names[BENCH_BACKENDS] = { "open/read/close", "urandom", "drbg" };
+static const size_t g_bench_sizes[]              = { 16, 32, 64, 256, 4096, BENCH_MAX_SIZE };
+
+typedef struct {
+  bench_backend_t backend;
+  size_t          size;
+  uint64_t        duration_ns;
+  uint64_t        requests;
+  ockam_error_t   error;
+} bench_thread_t;
+
+static uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec * 1000000000u) + (uint64_t) ts.tv_nsec;
+}
+
+static ockam_error_t bench_open_read_close(uint8_t* buffer, size_t size)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+  int           f     = open("/dev/urandom", O_RDONLY);
+
+  if ((f < 0) || (read(f, buffer, size) != (ssize_t) size)) { error = OCKAM_RANDOM_ERROR_GET_BYTES_FAIL; }
+  if (f >= 0) { close(f); }
+
+  return error;
+}
+
+static void* bench_thread(void* arg)
+{
+  bench_thread_t* p_run  = (bench_thread_t*) arg;
+  ockam_random_t  random = { 0 };
+  uint8_t*        buffer = malloc(BENCH_MAX_SIZE);
+  uint64_t        end    = 0;
+  size_t          i      = 0;
+
+  if (0 == buffer) {
+    p_run->error = OCKAM_RANDOM_ERROR_GET_BYTES_FAIL;
+    goto exit;
+  }
+
+  if (p_run->backend == BENCH_DRBG) {
+    p_run->error = ockam_random_drbg_init(&random);
+  } else {
+    p_run->error = ockam_random_urandom_init(&random);
+  }
+  if (p_run->error) goto exit;
+
+  end = bench_now_ns() + p_run->duration_ns;
+  while (bench_now_ns() < end) {
+    // Check the clock every 64 requests so it does not dominate small requests
+    for (i = 0; i < 64; i++) {
+      if (p_run->backend == BENCH_BASELINE) {
+        p_run->error = bench_open_read_close(buffer, p_run->size);
+      } else {
+        p_run->error = ockam_random_get_bytes(&random, buffer, p_run->size);
+      }
+      if (p_run->error) goto exit;
+    }
+    p_run->requests += 64;
+  }
+
+exit:
+  ockam_random_deinit(&random);
+  free(buffer);
+  return 0;
+}
+
+int main(int argc, char* argv[])
+{
+  bench_thread_t runs[BENCH_MAX_THREADS];
+  pthread_t      threads[BENCH_MAX_THREADS];
+  size_t         thread_count = BENCH_DEFAULT_THREADS;
+  uint64_t       duration_ms  = BENCH_DEFAULT_MS;
+  size_t         backend      = 0;
+  size_t         s            = 0;
+  size_t         t            = 0;
+  int            rc           = 0;
+
+  if (argc > 1) thread_count = strtoul(argv[1], 0, 10);
+  if (argc > 2) duration_ms = strtoull(argv[2], 0, 10);
+  if ((thread_count == 0) || (thread_count > BENCH_MAX_THREADS) || (duration_ms == 0)) {
+    printf("Usage: %s [threads <= %u] [milliseconds_per_run]\n", argv[0], BENCH_MAX_THREADS);
+    return -1;
+  }
+
+  printf("%zu thread(s), %llu ms per run, MB/s (million requests/s)\n",
+         thread_count,
+         (unsigned long long) duration_ms);
+  printf("%-16s", "request bytes");
+  for (s = 0; s < sizeof(g_bench_sizes) / sizeof(g_bench_sizes[0]); s++) { printf("%18zu", g_bench_sizes[s]); }
+  printf("\n");
+
+  for (backend = 0; backend < BENCH_BACKENDS; backend++) {
+    printf("%-16s", g_bench_names[backend]);
+    for (s = 0; s < sizeof(g_bench_sizes) / sizeof(g_bench_sizes[0]); s++) {
+      uint64_t requests = 0;
+      int      failed   = 0;
+
+      for (t = 0; t < thread_count; t++) {
+        runs[t].backend     = (bench_backend_t) backend;
+        runs[t].size        = g_bench_sizes[s];
+        runs[t].duration_ns = duration_ms * 1000000u;
+        runs[t].requests    = 0;
+        runs[t].error       = OCKAM_ERROR_NONE;
+        pthread_create(&threads[t], 0, bench_thread, &runs[t]);
+      }
+      for (t = 0; t < thread_count; t++) {
+        pthread_join(threads[t], 0);
+        requests += runs[t].requests;
+        if (runs[t].error) failed = 1;
+      }
+
+      if (failed) {
+        printf("%18s", "failed");
+        rc = -1;
+        continue;
+      }
+
+      printf("%9.1f (%6.3f)",
+             (double) (requests * g_bench_sizes[s]) / ((double) duration_ms * 1e3),
+             (double) requests / ((double) duration_ms * 1e3));
+    }
+    printf("\n");
+  }
+
+  return rc;
+}
@@ -1,12 +1,17 @@
 /**
  * @file    urandom.c
- * @brief   impl of Ockam's random functions using urandom calls
+ * @brief   impl of Ockam's random functions using the kernel's random source
+ *
+ * Bytes come from getrandom(2) where the kernel provides it. Otherwise /dev/urandom is opened once per process and the
+ * descriptor is kept for the life of the process, so a request costs a single read() and no descriptors.
  */
 
 #include <sys/types.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <pthread.h>
 
 #include "ockam/error.h"
 #include "ockam/random.h"
@@ -14,11 +19,51 @@
 #include "ockam/random/impl.h"
 #include "ockam/random/urandom.h"
 
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
 ockam_error_t random_urandom_deinit(ockam_random_t* random);
 ockam_error_t random_urandom_get_bytes(ockam_random_t* random, uint8_t* buffer, size_t buffer_size);
 
 ockam_random_dispatch_table_t random_urandom_dispatch_table = { &random_urandom_deinit, &random_urandom_get_bytes };
 
+static pthread_once_t g_urandom_once = PTHREAD_ONCE_INIT;
+static int            g_urandom_fd   = -1;
+
+static void random_urandom_open(void)
+{
+  int f = -1;
+
+  do {
+    f = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+  } while ((f < 0) && (errno == EINTR));
+
+  g_urandom_fd = f;
+}
+
+/**
+ * @brief   Read from the kernel with getrandom(2), falling back to the shared /dev/urandom descriptor.
+ * @return  Number of bytes read, or -1 with errno set.
+ */
+static ssize_t random_urandom_read(uint8_t* buffer, size_t length)
+{
+#ifdef SYS_getrandom
+  ssize_t len = syscall(SYS_getrandom, buffer, length, 0);
+
+  if ((len >= 0) || (errno != ENOSYS)) { return len; }
+#endif
+
+  pthread_once(&g_urandom_once, random_urandom_open);
+
+  if (g_urandom_fd < 0) {
+    errno = EBADF;
+    return -1;
+  }
+
+  return read(g_urandom_fd, buffer, length);
+}
+
 ockam_error_t ockam_random_urandom_init(ockam_random_t* random)
 {
   ockam_error_t error = OCKAM_ERROR_NONE;
@@ -46,7 +91,6 @@ exit:
 ockam_error_t random_urandom_get_bytes(ockam_random_t* random, uint8_t* buffer, size_t buffer_size)
 {
   ockam_error_t error         = OCKAM_ERROR_NONE;
-  int           f             = 0;
   size_t        bytes_written = 0;
 
   if ((random == 0) || (buffer == 0)) {
@@ -59,20 +103,13 @@ ockam_error_t random_urandom_get_bytes(ockam_random_t* random, uint8_t* buffer,
     goto exit;
   }
 
-  f = open("/dev/urandom", O_RDONLY);
-
-  if (f < 0) {
-    error = OCKAM_RANDOM_ERROR_GET_BYTES_FAIL;
-    goto exit;
-  }
-
   while (bytes_written < buffer_size) {
     ssize_t len = 0;
 
-    len = read(f, (buffer + bytes_written), (buffer_size - bytes_written));
+    len = random_urandom_read((buffer + bytes_written), (buffer_size - bytes_written));
 
-    if (len < 0) {
-      if (errno == EINTR) {
+    if (len <= 0) {
+      if ((len < 0) && (errno == EINTR)) {
         continue;
       } else {
         error = OCKAM_RANDOM_ERROR_GET_BYTES_FAIL;
@@ -84,8 +121,5 @@ ockam_error_t random_urandom_get_bytes(ockam_random_t* random, uint8_t* buffer,
   }
 
 exit:
-
-  if (f != -1) { close(f); }
-
   return error;
 }
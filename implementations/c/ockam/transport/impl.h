@@ -2,7 +2,7 @@
 
 #define OCKAM_TRANSPORT_IMPL_H
 #define MAX_DNS_NAME_LENGTH   254 // Maximum DNS name length, including terminating NULL
-#define MAX_IP_ADDRESS_LENGTH 48  // Maximum length of text DNS address in "xxx.xxx.xxx" format
+#define MAX_IP_ADDRESS_LENGTH 48  // Maximum length of text IPv4 or IPv6 address, INET6_ADDRSTRLEN is 46
 
 /**
  * OckamInternetAddress - User-friendly internet addresses, includes
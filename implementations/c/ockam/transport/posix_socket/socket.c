@@ -3,7 +3,9 @@
 #include "ockam/io/impl.h"
 #include "ockam/transport.h"
 #include "socket.h"
+#include <net/if.h>
 #include <stdio.h>
+#include <unistd.h>
 
 extern ockam_memory_t* gp_ockam_transport_memory;
 
@@ -38,52 +40,231 @@ exit:
 /**
  * make_socket_address - construct network-friendly address from user-friendly
  * address
- * @param p_ip_address - (in) IP address in "nnn.nnn.nnn.nnn" format
+ * @param p_ip_address - (in) IP address in "nnn.nnn.nnn.nnn" or IPv6 format, optionally in brackets and with a
+ *                       "%scope" suffix. NULL or empty for the dual-stack wildcard "::"
  * @param port - port number, must be non-zero
  * @param p_socket_address - (out) address converted
  * @return - OCKAM_NO_ERR on success
  */
-ockam_error_t make_socket_address(const uint8_t* p_ip_address, in_port_t port, struct sockaddr_in* p_socket_address)
+ockam_error_t
+make_socket_address(const uint8_t* p_ip_address, in_port_t port, struct sockaddr_storage* p_socket_address)
 {
-  ockam_error_t error     = OCKAM_ERROR_NONE;
-  int           in_status = 0;
-
-  // Get the host IP address and port
-  p_socket_address->sin_family = AF_INET;
-  p_socket_address->sin_port   = htons(port);
-  if (NULL != p_ip_address) {
-    in_status = inet_pton(AF_INET, (char*) p_ip_address, &p_socket_address->sin_addr.s_addr);
-    if (1 != in_status) {
+  ockam_error_t        error          = OCKAM_ERROR_NONE;
+  struct sockaddr_in*  p_ipv4_address = (struct sockaddr_in*) p_socket_address;
+  struct sockaddr_in6* p_ipv6_address = (struct sockaddr_in6*) p_socket_address;
+  char                 text[MAX_IP_ADDRESS_LENGTH];
+  char*                p_text  = text;
+  char*                p_scope = NULL;
+  size_t               length  = 0;
+
+  memset(p_socket_address, 0, sizeof(*p_socket_address));
+
+  if ((NULL == p_ip_address) || (0 == p_ip_address[0])) {
+    p_ipv6_address->sin6_family = AF_INET6;
+    p_ipv6_address->sin6_port   = htons(port);
+    p_ipv6_address->sin6_addr   = in6addr_any;
+    goto exit;
+  }
+
+  length = strnlen((char*) p_ip_address, MAX_IP_ADDRESS_LENGTH);
+  if (MAX_IP_ADDRESS_LENGTH == length) {
+    error = TRANSPORT_ERROR_BAD_ADDRESS;
+    goto exit;
+  }
+  memcpy(text, p_ip_address, length + 1);
+
+  p_ipv4_address->sin_family = AF_INET;
+  p_ipv4_address->sin_port   = htons(port);
+  if (1 == inet_pton(AF_INET, text, &p_ipv4_address->sin_addr)) goto exit;
+
+  if (('[' == text[0]) && (']' == text[length - 1])) {
+    text[length - 1] = 0;
+    p_text++;
+  }
+  p_scope = strchr(p_text, '%');
+  if (NULL != p_scope) *p_scope++ = 0;
+
+  memset(p_socket_address, 0, sizeof(*p_socket_address));
+  p_ipv6_address->sin6_family = AF_INET6;
+  p_ipv6_address->sin6_port   = htons(port);
+  if (1 != inet_pton(AF_INET6, p_text, &p_ipv6_address->sin6_addr)) {
+    error = TRANSPORT_ERROR_BAD_ADDRESS;
+    goto exit;
+  }
+  if (NULL != p_scope) {
+    p_ipv6_address->sin6_scope_id = if_nametoindex(p_scope);
+    if (0 == p_ipv6_address->sin6_scope_id) p_ipv6_address->sin6_scope_id = strtoul(p_scope, NULL, 10);
+    if (0 == p_ipv6_address->sin6_scope_id) {
       error = TRANSPORT_ERROR_BAD_ADDRESS;
-      ockam_log_error("inet_pton failed in make_socket_address: %x", error);
       goto exit;
     }
+  }
+
+exit:
+  if (error) ockam_log_error("bad address in make_socket_address: %x", error);
+  return error;
+}
+
+ockam_error_t make_socket(struct sockaddr_storage* p_socket_address, int type, int* p_socket_fd)
+{
+  ockam_error_t        error          = OCKAM_ERROR_NONE;
+  struct sockaddr_in6* p_ipv6_address = (struct sockaddr_in6*) p_socket_address;
+
+  *p_socket_fd = socket(p_socket_address->ss_family, type, 0);
+
+  // Hosts without IPv6 still get a wildcard socket, just an IPv4 one
+  if ((-1 == *p_socket_fd) && (EAFNOSUPPORT == errno) && (AF_INET6 == p_socket_address->ss_family) &&
+      IN6_IS_ADDR_UNSPECIFIED(&p_ipv6_address->sin6_addr)) {
+    error = make_socket_address((uint8_t*) "0.0.0.0", ntohs(p_ipv6_address->sin6_port), p_socket_address);
+    if (error) goto exit;
+    *p_socket_fd = socket(AF_INET, type, 0);
+  }
+
+  if (-1 == *p_socket_fd) {
+    error = TRANSPORT_ERROR_SOCKET_CREATE;
+    goto exit;
+  }
+
+  // Dual-stack: an AF_INET6 socket also serves IPv4 peers, as IPv4-mapped addresses
+  if (AF_INET6 == p_socket_address->ss_family) {
+    if (0 != setsockopt(*p_socket_fd, IPPROTO_IPV6, IPV6_V6ONLY, &(int) { 0 }, sizeof(int))) {
+      close(*p_socket_fd);
+      *p_socket_fd = -1;
+      error        = TRANSPORT_ERROR_SOCKET_CREATE;
+      goto exit;
+    }
+  }
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+socklen_t socket_address_length(const struct sockaddr_storage* p_socket_address)
+{
+  if (AF_INET6 == p_socket_address->ss_family) return sizeof(struct sockaddr_in6);
+  return sizeof(struct sockaddr_in);
+}
+
+ockam_error_t socket_address_for_family(struct sockaddr_storage* p_socket_address, sa_family_t family)
+{
+  ockam_error_t        error          = OCKAM_ERROR_NONE;
+  struct sockaddr_in*  p_ipv4_address = (struct sockaddr_in*) p_socket_address;
+  struct sockaddr_in6* p_ipv6_address = (struct sockaddr_in6*) p_socket_address;
+  struct in_addr       ipv4           = { 0 };
+  in_port_t            port           = 0;
+
+  if (family == p_socket_address->ss_family) goto exit;
+
+  if (AF_INET6 == family) {
+    ipv4 = p_ipv4_address->sin_addr;
+    port = p_ipv4_address->sin_port;
+    memset(p_socket_address, 0, sizeof(*p_socket_address));
+    p_ipv6_address->sin6_family = AF_INET6;
+    p_ipv6_address->sin6_port   = port;
+    memset(&p_ipv6_address->sin6_addr.s6_addr[10], 0xFF, 2);
+    memcpy(&p_ipv6_address->sin6_addr.s6_addr[12], &ipv4, sizeof(ipv4));
+  } else if (IN6_IS_ADDR_V4MAPPED(&p_ipv6_address->sin6_addr)) {
+    memcpy(&ipv4, &p_ipv6_address->sin6_addr.s6_addr[12], sizeof(ipv4));
+    port = p_ipv6_address->sin6_port;
+    memset(p_socket_address, 0, sizeof(*p_socket_address));
+    p_ipv4_address->sin_family = AF_INET;
+    p_ipv4_address->sin_port   = port;
+    p_ipv4_address->sin_addr   = ipv4;
   } else {
-    p_socket_address->sin_addr.s_addr = htonl(INADDR_ANY);
+    error = TRANSPORT_ERROR_BAD_ADDRESS;
   }
 
 exit:
   return error;
 }
 
+void socket_address_to_ip_address(const struct sockaddr_storage* p_socket_address, ockam_ip_address_t* p_ip_address)
+{
+  struct sockaddr_storage address = *p_socket_address;
+
+  p_ip_address->ip_address[0] = 0;
+  p_ip_address->port          = 0;
+
+  if ((AF_INET6 == address.ss_family) && (OCKAM_ERROR_NONE != socket_address_for_family(&address, AF_INET))) {
+    inet_ntop(AF_INET6,
+              &((struct sockaddr_in6*) &address)->sin6_addr,
+              (char*) p_ip_address->ip_address,
+              sizeof(p_ip_address->ip_address));
+    p_ip_address->port = ntohs(((struct sockaddr_in6*) &address)->sin6_port);
+  } else if (AF_INET == address.ss_family) {
+    inet_ntop(AF_INET,
+              &((struct sockaddr_in*) &address)->sin_addr,
+              (char*) p_ip_address->ip_address,
+              sizeof(p_ip_address->ip_address));
+    p_ip_address->port = ntohs(((struct sockaddr_in*) &address)->sin_port);
+  }
+}
+
+ockam_error_t
+make_ip_address_from_endpoint(CodecEndpointType type, const uint8_t* p_endpoint, ockam_ip_address_t* p_ip_address)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  memset(p_ip_address, 0, sizeof(*p_ip_address));
+
+  switch (type) {
+  case kTcpIpv4:
+  case kUdpIpv4: {
+    KTTcpIpv4Endpoint* p_ipv4_endpoint = (KTTcpIpv4Endpoint*) p_endpoint;
+    inet_ntop(AF_INET, p_ipv4_endpoint->ip4, (char*) p_ip_address->ip_address, sizeof(p_ip_address->ip_address));
+    p_ip_address->port = p_ipv4_endpoint->port;
+    break;
+  }
+  case kTcpIpv6:
+  case kUdpIpv6: {
+    KTTcpIpv6Endpoint* p_ipv6_endpoint = (KTTcpIpv6Endpoint*) p_endpoint;
+    inet_ntop(AF_INET6, p_ipv6_endpoint->ip6, (char*) p_ip_address->ip_address, sizeof(p_ip_address->ip_address));
+    p_ip_address->port = p_ipv6_endpoint->port;
+    break;
+  }
+  default:
+    error = TRANSPORT_ERROR_BAD_ADDRESS;
+  }
+
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+size_t tcp_frame_encode_header(size_t length, uint8_t* p_header)
+{
+  size_t header_length = TCP_FRAME_HEADER_SIZE;
+
+  if (length < TCP_FRAME_LENGTH_EXTENDED) {
+    p_header[0] = (uint8_t)(length >> 8u);
+    p_header[1] = (uint8_t) length;
+  } else {
+    p_header[0]   = (uint8_t)(TCP_FRAME_LENGTH_EXTENDED >> 8u);
+    p_header[1]   = (uint8_t) TCP_FRAME_LENGTH_EXTENDED;
+    p_header[2]   = (uint8_t)(length >> 24u);
+    p_header[3]   = (uint8_t)(length >> 16u);
+    p_header[4]   = (uint8_t)(length >> 8u);
+    p_header[5]   = (uint8_t) length;
+    header_length = TCP_FRAME_HEADER_MAX_SIZE;
+  }
+
+  return header_length;
+}
+
 void dump_socket(posix_socket_t* ps)
 {
-  char     local_address[128];
-  char     remote_address[128];
-  uint16_t local_port;
-  uint16_t remote_port;
+  ockam_ip_address_t local_address;
+  ockam_ip_address_t remote_address;
 
-  inet_ntop(AF_INET, &ps->local_sockaddr.sin_addr, local_address, 128);
-  local_port = ntohs(ps->local_sockaddr.sin_port);
+  socket_address_to_ip_address(&ps->local_sockaddr, &local_address);
   //  printf("local address       : %s\n", ps->local_address.ip_address);
   //  printf("local port          : %d\n", ps->local_address.port);
-  printf("local sockaddr:     : %s\n", local_address);
-  printf("local port          : %d\n", local_port);
+  printf("local sockaddr:     : %s\n", local_address.ip_address);
+  printf("local port          : %d\n", local_address.port);
 
-  inet_ntop(AF_INET, &ps->remote_sockaddr.sin_addr, remote_address, 128);
-  remote_port = ntohs(ps->remote_sockaddr.sin_port);
+  socket_address_to_ip_address(&ps->remote_sockaddr, &remote_address);
   //  printf("remote address       : %s\n", ps->remote_address.ip_address);
   //  printf("remote port          : %d\n", ps->remote_address.port);
-  printf("remote sockaddr:     : %s\n", remote_address);
-  printf("remote port          : %d\n", remote_port);
-}
\ No newline at end of file
+  printf("remote sockaddr:     : %s\n", remote_address.ip_address);
+  printf("remote port          : %d\n", remote_address.port);
+}
@@ -10,6 +10,7 @@
 #include <string.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include "ockam/codec.h"
 #include "ockam/transport.h"
 #include "ockam/transport/impl.h"
 #include "socket.h"
@@ -22,13 +23,13 @@
  * POSIX_TCP_SOCKET type.
  */
 typedef struct posix_socket {
-  ockam_reader_t*    p_reader;
-  ockam_writer_t*    p_writer;
-  ockam_ip_address_t local_address;
-  ockam_ip_address_t remote_address;
-  int                socket_fd;
-  struct sockaddr_in remote_sockaddr;
-  struct sockaddr_in local_sockaddr;
+  ockam_reader_t*         p_reader;
+  ockam_writer_t*         p_writer;
+  ockam_ip_address_t      local_address;
+  ockam_ip_address_t      remote_address;
+  int                     socket_fd;
+  struct sockaddr_storage remote_sockaddr;
+  struct sockaddr_storage local_sockaddr;
 } posix_socket_t;
 
 ockam_error_t make_socket_reader_writer(posix_socket_t* p_ctx,
@@ -37,7 +38,66 @@ ockam_error_t make_socket_reader_writer(posix_socket_t* p_ctx,
                                         ockam_reader_t** pp_reader,
                                         ockam_writer_t** pp_writer);
 
-ockam_error_t make_socket_address(const uint8_t* p_ip_address, in_port_t port, struct sockaddr_in* p_socket_address);
+/*
+ * Largest iovec count accepted by the writev entry points
+ */
+#define SOCKET_WRITEV_MAX 16
+
+/*
+ * Socket addresses are kept in a sockaddr_storage and are either AF_INET or AF_INET6. An empty IP address stands for
+ * the dual-stack wildcard "::", which make_socket() turns into 0.0.0.0 on hosts without IPv6.
+ */
+ockam_error_t
+make_socket_address(const uint8_t* p_ip_address, in_port_t port, struct sockaddr_storage* p_socket_address);
+
+/**
+ * make_socket - create a socket of the address family, dual-stack for AF_INET6
+ * @param p_socket_address - (in/out) address the socket is for, the wildcard "::" may become 0.0.0.0
+ * @param type - socket type and flags, as passed to socket()
+ * @param p_socket_fd - (out) the new socket
+ */
+ockam_error_t make_socket(struct sockaddr_storage* p_socket_address, int type, int* p_socket_fd);
+
+/*
+ * Length of the AF_INET or AF_INET6 address, as passed to bind(), connect() and sendto()
+ */
+socklen_t socket_address_length(const struct sockaddr_storage* p_socket_address);
+
+/**
+ * socket_address_for_family - convert an address for use on a socket of the given family: an AF_INET address becomes
+ * IPv4-mapped for an AF_INET6 socket, an IPv4-mapped address becomes AF_INET for an AF_INET socket
+ * @return - TRANSPORT_ERROR_BAD_ADDRESS for an IPv6 address and an AF_INET socket
+ */
+ockam_error_t socket_address_for_family(struct sockaddr_storage* p_socket_address, sa_family_t family);
+
+/**
+ * socket_address_to_ip_address - format an address, IPv4-mapped addresses as plain IPv4
+ */
+void socket_address_to_ip_address(const struct sockaddr_storage* p_socket_address, ockam_ip_address_t* p_ip_address);
+
+/**
+ * make_ip_address_from_endpoint - the transport address of a decoded kTcpIpv4, kTcpIpv6, kUdpIpv4 or kUdpIpv6
+ * endpoint, to be passed to the TCP or UDP transport that the endpoint type names
+ * @return - TRANSPORT_ERROR_BAD_ADDRESS for other endpoint types
+ */
+ockam_error_t
+make_ip_address_from_endpoint(CodecEndpointType type, const uint8_t* p_endpoint, ockam_ip_address_t* p_ip_address);
+
+/*
+ * TCP frames start with a 16-bit big-endian length. The value TCP_FRAME_LENGTH_EXTENDED means a 32-bit big-endian
+ * length follows, so frames of 64KiB and more cost four extra bytes while smaller frames keep the original encoding.
+ */
+#define TCP_FRAME_LENGTH_EXTENDED 0xFFFFu
+#define TCP_FRAME_HEADER_SIZE     sizeof(uint16_t)
+#define TCP_FRAME_HEADER_MAX_SIZE (sizeof(uint16_t) + sizeof(uint32_t))
+
+/**
+ * tcp_frame_encode_header - write the length prefix for a frame
+ * @param length - frame length, at most UINT32_MAX
+ * @param p_header - (out) at least TCP_FRAME_HEADER_MAX_SIZE bytes
+ * @return - number of header bytes written
+ */
+size_t tcp_frame_encode_header(size_t length, uint8_t* p_header);
 
 void dump_socket(posix_socket_t* ps);
 #endif
@@ -2,7 +2,11 @@
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
 #include <unistd.h>
+#include <sys/uio.h>
 
 #include "ockam/log.h"
 #include "ockam/io.h"
@@ -13,12 +17,21 @@
 #include "socket_tcp.h"
 #include "ockam/memory.h"
 
+#define TCP_CONNECT_BACKOFF_MS         100u
+#define TCP_CONNECT_BACKOFF_MAX_MS     10000u
+#define TCP_CONNECTOR_INITIAL_CAPACITY 16u
+
 extern ockam_memory_t* gp_ockam_transport_memory;
 
 ockam_transport_vtable_t socket_tcp_vtable = { socket_tcp_connect, socket_tcp_accept, socket_tcp_deinit };
 
 ockam_error_t socket_tcp_read(void*, uint8_t*, size_t, size_t*);
 ockam_error_t socket_tcp_write(void*, uint8_t*, size_t);
+ockam_error_t socket_tcp_read_buffer(void*, ockam_buffer_t**);
+ockam_error_t socket_tcp_writev(void*, const ockam_iovec_t*, size_t);
+ockam_error_t socket_tcp_write_buffer(void*, ockam_buffer_t*);
+ockam_error_t socket_tcp_set_options(socket_tcp_ctx_t* p_ctx, tcp_socket_t* p_tcp_socket, int socket_fd);
+void          socket_tcp_set_buffer_io(posix_socket_t* p_socket);
 
 ockam_error_t ockam_transport_socket_tcp_init(ockam_transport_t* p_transport, ockam_transport_socket_attributes_t* cfg)
 {
@@ -45,94 +58,452 @@ ockam_error_t ockam_transport_socket_tcp_init(ockam_transport_t* p_transport, oc
   p_transport->ctx = p_ctx;
   ockam_memory_copy(
     gp_ockam_transport_memory, &p_ctx->listen_address, &cfg->listen_address, sizeof(ockam_ip_address_t));
+  p_ctx->tcp_nodelay        = cfg->tcp_nodelay;
+  p_ctx->tcp_cork           = cfg->tcp_cork;
+  p_ctx->connect_timeout_ms = cfg->tcp_connect_timeout_ms;
+  p_ctx->retry_backoff_ms   = cfg->tcp_retry_backoff_ms;
+
+#ifndef TCP_CORK
+  if (p_ctx->tcp_cork) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
+    goto exit;
+  }
+#endif
 
 exit:
   if (error) {
     ockam_log_error("%x", error);
-    if (p_ctx) ockam_memory_free(gp_ockam_transport_memory, p_ctx, 0);
+    if (p_ctx) {
+      ockam_memory_free(gp_ockam_transport_memory, p_ctx, sizeof(socket_tcp_ctx_t));
+      p_transport->ctx = NULL;
+    }
   }
   return error;
 }
 
-ockam_error_t socket_tcp_connect(void*               ctx,
-                                 ockam_reader_t**    pp_reader,
-                                 ockam_writer_t**    pp_writer,
-                                 ockam_ip_address_t* remote_address,
-                                 int16_t             retry_count,
-                                 uint16_t            retry_interval)
+/*
+ * One connect in progress. socket_fd is -1 while the connect waits out a backoff, deadline_ms is then when the next
+ * attempt starts. While an attempt is in flight deadline_ms is when it times out, or 0 without a timeout.
+ */
+typedef struct tcp_connect_attempt {
+  ockam_transport_t*                       p_transport;
+  socket_tcp_ctx_t*                        p_ctx;
+  tcp_socket_t*                            p_tcp_socket;
+  struct sockaddr_storage                  remote_sockaddr;
+  ockam_transport_tcp_connect_attributes_t attributes;
+  ockam_transport_tcp_connect_cb           callback;
+  void*                                    user_ctx;
+  uint32_t                                 backoff_ms;
+  uint64_t                                 deadline_ms;
+  int                                      retries;
+  int                                      socket_fd;
+} tcp_connect_attempt_t;
+
+/*
+ * poll_fds[i] belongs to attempts[i], attempts waiting out a backoff have a negative fd that poll() skips
+ */
+struct ockam_transport_tcp_connector {
+  ockam_memory_t*         p_memory;
+  tcp_connect_attempt_t** attempts;
+  struct pollfd*          poll_fds;
+  size_t                  count;
+  size_t                  capacity;
+  uint64_t                random;
+};
+
+typedef struct tcp_connect_result {
+  ockam_error_t   error;
+  ockam_reader_t* p_reader;
+  ockam_writer_t* p_writer;
+} tcp_connect_result_t;
+
+uint64_t socket_tcp_now_ms(void)
 {
-  ockam_error_t      error = OCKAM_ERROR_NONE;
-  struct sockaddr_in socket_address;
-  socket_tcp_ctx_t*  p_transport_ctx = (socket_tcp_ctx_t*) ctx;
-  tcp_socket_t*      p_tcp_socket    = NULL;
-  posix_socket_t*    p_posix_socket  = NULL;
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000u + (uint64_t) ts.tv_nsec / 1000000u;
+}
 
-  if (NULL == p_transport_ctx) {
+/*
+ * A wait between half the backoff and the full backoff, from an xorshift generator: the jitter only needs to differ
+ * between connectors, not to be unpredictable
+ */
+uint64_t tcp_connector_jitter(ockam_transport_tcp_connector_t* p_connector, uint32_t backoff_ms)
+{
+  p_connector->random ^= p_connector->random << 13u;
+  p_connector->random ^= p_connector->random >> 7u;
+  p_connector->random ^= p_connector->random << 17u;
+  return backoff_ms - (p_connector->random % ((uint64_t) backoff_ms / 2u + 1u));
+}
+
+void tcp_connect_attempt_free(tcp_connect_attempt_t* p_attempt, ockam_memory_t* p_memory)
+{
+  posix_socket_t* p_posix_socket = NULL;
+
+  if (-1 != p_attempt->socket_fd) close(p_attempt->socket_fd);
+  if (p_attempt->p_tcp_socket) {
+    p_posix_socket = &p_attempt->p_tcp_socket->posix_socket;
+    if (p_posix_socket->p_reader) {
+      ockam_memory_free(gp_ockam_transport_memory, p_posix_socket->p_reader, sizeof(ockam_reader_t));
+    }
+    if (p_posix_socket->p_writer) {
+      ockam_memory_free(gp_ockam_transport_memory, p_posix_socket->p_writer, sizeof(ockam_writer_t));
+    }
+    ockam_memory_free(gp_ockam_transport_memory, p_attempt->p_tcp_socket, sizeof(tcp_socket_t));
+  }
+  ockam_memory_free(p_memory, p_attempt, sizeof(*p_attempt));
+}
+
+/*
+ * Take the attempt out of the connector, hand a connected socket over to its transport and run the callback
+ */
+void tcp_connector_finish(ockam_transport_tcp_connector_t* p_connector, size_t index, ockam_error_t error)
+{
+  tcp_connect_attempt_t* p_attempt      = p_connector->attempts[index];
+  posix_socket_t*        p_posix_socket = &p_attempt->p_tcp_socket->posix_socket;
+  ockam_reader_t*        p_reader       = NULL;
+  ockam_writer_t*        p_writer       = NULL;
+
+  p_connector->count--;
+  p_connector->attempts[index] = p_connector->attempts[p_connector->count];
+  p_connector->poll_fds[index] = p_connector->poll_fds[p_connector->count];
+
+  // The transport's reads and writes block, like after a blocking connect
+  if (!error && (0 != fcntl(p_attempt->socket_fd, F_SETFL, fcntl(p_attempt->socket_fd, F_GETFL) & ~O_NONBLOCK))) {
+    error = TRANSPORT_ERROR_SOCKET;
+  }
+  if (!error) error = socket_tcp_set_options(p_attempt->p_ctx, p_attempt->p_tcp_socket, p_attempt->socket_fd);
+
+  if (!error) {
+    p_posix_socket->socket_fd       = p_attempt->socket_fd;
+    p_posix_socket->remote_sockaddr = p_attempt->remote_sockaddr;
+    p_attempt->p_ctx->p_socket      = p_attempt->p_tcp_socket;
+    p_reader                        = p_posix_socket->p_reader;
+    p_writer                        = p_posix_socket->p_writer;
+    p_attempt->p_tcp_socket         = NULL;
+    p_attempt->socket_fd            = -1;
+  }
+
+  p_attempt->callback(p_attempt->user_ctx, p_attempt->p_transport, p_reader, p_writer, error);
+  tcp_connect_attempt_free(p_attempt, p_connector->p_memory);
+}
+
+void tcp_connector_fail(ockam_transport_tcp_connector_t* p_connector, size_t index, uint64_t now)
+{
+  tcp_connect_attempt_t* p_attempt = p_connector->attempts[index];
+
+  if (-1 != p_attempt->socket_fd) close(p_attempt->socket_fd);
+  p_attempt->socket_fd = -1;
+
+  if ((p_attempt->attributes.retry_count >= 0) && (p_attempt->retries >= p_attempt->attributes.retry_count)) {
+    tcp_connector_finish(p_connector, index, TRANSPORT_ERROR_CONNECT);
+    return;
+  }
+
+  p_attempt->retries++;
+  p_attempt->deadline_ms = now + tcp_connector_jitter(p_connector, p_attempt->backoff_ms);
+  if (p_attempt->backoff_ms < p_attempt->attributes.backoff_max_ms / 2u) {
+    p_attempt->backoff_ms *= 2u;
+  } else {
+    p_attempt->backoff_ms = p_attempt->attributes.backoff_max_ms;
+  }
+}
+
+void tcp_connector_start(ockam_transport_tcp_connector_t* p_connector, size_t index, uint64_t now)
+{
+  tcp_connect_attempt_t* p_attempt = p_connector->attempts[index];
+
+  if (make_socket(&p_attempt->remote_sockaddr, SOCK_STREAM, &p_attempt->socket_fd)) goto fail;
+
+  if ((0 != fcntl(p_attempt->socket_fd, F_SETFL, fcntl(p_attempt->socket_fd, F_GETFL) | O_NONBLOCK)) ||
+      (setsockopt(p_attempt->socket_fd, SOL_SOCKET, SO_KEEPALIVE, &(int) { 1 }, sizeof(int)) < 0) ||
+      (setsockopt(p_attempt->socket_fd, SOL_SOCKET, SO_REUSEADDR, &(int) { 1 }, sizeof(int)) < 0) ||
+      (setsockopt(p_attempt->socket_fd, SOL_SOCKET, SO_REUSEPORT, &(int) { 1 }, sizeof(int)) < 0)) {
+    goto fail;
+  }
+
+  if (0 == connect(p_attempt->socket_fd,
+                   (struct sockaddr*) &p_attempt->remote_sockaddr,
+                   socket_address_length(&p_attempt->remote_sockaddr))) {
+    tcp_connector_finish(p_connector, index, OCKAM_ERROR_NONE);
+    return;
+  }
+  if (EINPROGRESS != errno) goto fail;
+
+  p_attempt->deadline_ms = p_attempt->attributes.timeout_ms ? now + p_attempt->attributes.timeout_ms : 0;
+  return;
+
+fail:
+  tcp_connector_fail(p_connector, index, now);
+}
+
+/*
+ * The socket of an attempt in flight became writable: the connect completed, one way or the other
+ */
+void tcp_connector_check(ockam_transport_tcp_connector_t* p_connector, size_t index, uint64_t now)
+{
+  tcp_connect_attempt_t* p_attempt    = p_connector->attempts[index];
+  int                    socket_error = 0;
+  socklen_t              length       = sizeof(socket_error);
+
+  if ((0 != getsockopt(p_attempt->socket_fd, SOL_SOCKET, SO_ERROR, &socket_error, &length)) || socket_error) {
+    tcp_connector_fail(p_connector, index, now);
+  } else {
+    tcp_connector_finish(p_connector, index, OCKAM_ERROR_NONE);
+  }
+}
+
+ockam_error_t
+ockam_transport_tcp_connector_init(ockam_transport_tcp_connector_t** pp_connector, ockam_memory_t* p_memory)
+{
+  ockam_error_t                    error       = OCKAM_ERROR_NONE;
+  ockam_transport_tcp_connector_t* p_connector = NULL;
+
+  if ((NULL == pp_connector) || (NULL == p_memory)) {
     error = TRANSPORT_ERROR_BAD_PARAMETER;
     goto exit;
   }
 
-  error = ockam_memory_alloc_zeroed(gp_ockam_transport_memory, (void**) &p_tcp_socket, sizeof(*p_tcp_socket));
+  error = ockam_memory_alloc_zeroed(p_memory, (void**) &p_connector, sizeof(*p_connector));
   if (error) goto exit;
 
-  p_posix_socket            = &p_tcp_socket->posix_socket;
-  p_posix_socket->socket_fd = -1;
-  p_transport_ctx->p_socket = p_tcp_socket;
+  p_connector->p_memory = p_memory;
+  p_connector->random   = (socket_tcp_now_ms() << 20u) ^ (uint64_t)(uintptr_t) p_connector ^ (uint64_t) getpid();
+  if (0 == p_connector->random) p_connector->random = 1;
+  *pp_connector = p_connector;
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t ockam_transport_tcp_connector_add(ockam_transport_tcp_connector_t*          p_connector,
+                                                ockam_transport_t*                        p_transport,
+                                                ockam_ip_address_t*                       remote_address,
+                                                ockam_transport_tcp_connect_attributes_t* p_attributes,
+                                                ockam_transport_tcp_connect_cb            callback,
+                                                void*                                     user_ctx)
+{
+  ockam_error_t           error     = OCKAM_ERROR_NONE;
+  tcp_connect_attempt_t*  p_attempt = NULL;
+  tcp_connect_attempt_t** attempts  = NULL;
+  struct pollfd*          poll_fds  = NULL;
+  posix_socket_t*         p_posix_socket;
+  size_t                  capacity = 0;
+
+  if ((NULL == p_connector) || (NULL == p_transport) || (&socket_tcp_vtable != p_transport->vtable) ||
+      (NULL == p_transport->ctx) || (NULL == remote_address) || (NULL == callback)) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
+    goto exit;
+  }
+
+  if (p_connector->count == p_connector->capacity) {
+    capacity = p_connector->capacity ? 2 * p_connector->capacity : TCP_CONNECTOR_INITIAL_CAPACITY;
+    error    = ockam_memory_alloc_zeroed(p_connector->p_memory, (void**) &attempts, capacity * sizeof(*attempts));
+    if (error) goto exit;
+    error = ockam_memory_alloc_zeroed(p_connector->p_memory, (void**) &poll_fds, capacity * sizeof(*poll_fds));
+    if (error) goto exit;
+    if (p_connector->count) {
+      ockam_memory_copy(
+        p_connector->p_memory, attempts, p_connector->attempts, p_connector->count * sizeof(*attempts));
+      ockam_memory_copy(
+        p_connector->p_memory, poll_fds, p_connector->poll_fds, p_connector->count * sizeof(*poll_fds));
+      ockam_memory_free(p_connector->p_memory, p_connector->attempts, p_connector->capacity * sizeof(*attempts));
+      ockam_memory_free(p_connector->p_memory, p_connector->poll_fds, p_connector->capacity * sizeof(*poll_fds));
+    }
+    p_connector->attempts = attempts;
+    p_connector->poll_fds = poll_fds;
+    p_connector->capacity = capacity;
+    attempts              = NULL;
+    poll_fds              = NULL;
+  }
 
-  error = make_socket_reader_writer(p_posix_socket, socket_tcp_read, socket_tcp_write, pp_reader, pp_writer);
+  error = ockam_memory_alloc_zeroed(p_connector->p_memory, (void**) &p_attempt, sizeof(*p_attempt));
   if (error) goto exit;
+  p_attempt->socket_fd = -1;
 
-  p_transport_ctx->p_socket = p_tcp_socket;
+  error = make_socket_address(remote_address->ip_address, remote_address->port, &p_attempt->remote_sockaddr);
+  if (error) goto exit;
+
+  error = ockam_memory_alloc_zeroed(
+    gp_ockam_transport_memory, (void**) &p_attempt->p_tcp_socket, sizeof(*p_attempt->p_tcp_socket));
+  if (error) goto exit;
 
+  p_posix_socket            = &p_attempt->p_tcp_socket->posix_socket;
+  p_posix_socket->socket_fd = -1;
+  error = make_socket_reader_writer(p_posix_socket, socket_tcp_read, socket_tcp_write, &(ockam_reader_t*) { NULL },
+                                    &(ockam_writer_t*) { NULL });
+  if (error) goto exit;
+  socket_tcp_set_buffer_io(p_posix_socket);
   ockam_memory_copy(
     gp_ockam_transport_memory, &p_posix_socket->remote_address, remote_address, sizeof(*remote_address));
 
-  error = make_socket_address(remote_address->ip_address, remote_address->port, &socket_address);
-  if (error) goto exit;
+  if (p_attributes) p_attempt->attributes = *p_attributes;
+  if (0 == p_attempt->attributes.backoff_initial_ms) {
+    p_attempt->attributes.backoff_initial_ms = TCP_CONNECT_BACKOFF_MS;
+  }
+  if (0 == p_attempt->attributes.backoff_max_ms) p_attempt->attributes.backoff_max_ms = TCP_CONNECT_BACKOFF_MAX_MS;
+  if (p_attempt->attributes.backoff_initial_ms > p_attempt->attributes.backoff_max_ms) {
+    p_attempt->attributes.backoff_initial_ms = p_attempt->attributes.backoff_max_ms;
+  }
 
-  int attempts       = 0;
-  int connect_status = 0;
-  do {
-    p_posix_socket->socket_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (-1 == p_posix_socket->socket_fd) {
-      error = TRANSPORT_ERROR_SOCKET_CREATE;
-      goto exit;
-    }
+  p_attempt->p_transport = p_transport;
+  p_attempt->p_ctx       = (socket_tcp_ctx_t*) p_transport->ctx;
+  p_attempt->callback    = callback;
+  p_attempt->user_ctx    = user_ctx;
+  p_attempt->backoff_ms  = p_attempt->attributes.backoff_initial_ms;
 
-    if (setsockopt(p_posix_socket->socket_fd, SOL_SOCKET, SO_KEEPALIVE, &(int) { 1 }, sizeof(int)) < 0) {
-      error = TRANSPORT_ERROR_CONNECT;
-      goto exit;
+  p_connector->poll_fds[p_connector->count].fd = -1;
+  p_connector->attempts[p_connector->count++]  = p_attempt;
+  p_attempt                                    = NULL;
+
+exit:
+  if (attempts) ockam_memory_free(p_connector->p_memory, attempts, capacity * sizeof(*attempts));
+  if (poll_fds) ockam_memory_free(p_connector->p_memory, poll_fds, capacity * sizeof(*poll_fds));
+  if (p_attempt) tcp_connect_attempt_free(p_attempt, p_connector->p_memory);
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t
+ockam_transport_tcp_connector_run(ockam_transport_tcp_connector_t* p_connector, int32_t wait_ms, size_t* p_pending)
+{
+  ockam_error_t          error = OCKAM_ERROR_NONE;
+  tcp_connect_attempt_t* p_attempt;
+  uint64_t               start = socket_tcp_now_ms();
+  uint64_t               now   = start;
+  uint64_t               next  = 0;
+  int                    timeout;
+  size_t                 i;
+
+  if (NULL == p_connector) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
+    goto exit;
+  }
+
+  for (;;) {
+    // Start the attempts whose backoff is over and give up on those past their timeout. Finishing an attempt moves
+    // the last one into its slot, so walk backwards.
+    now  = socket_tcp_now_ms();
+    next = UINT64_MAX;
+    for (i = p_connector->count; i-- > 0;) {
+      p_attempt = p_connector->attempts[i];
+      if ((-1 == p_attempt->socket_fd) && (now >= p_attempt->deadline_ms)) {
+        tcp_connector_start(p_connector, i, now);
+      } else if ((-1 != p_attempt->socket_fd) && p_attempt->deadline_ms && (now >= p_attempt->deadline_ms)) {
+        tcp_connector_fail(p_connector, i, now);
+      }
     }
-    if (setsockopt(p_posix_socket->socket_fd, SOL_SOCKET, SO_REUSEADDR, &(int) { 1 }, sizeof(int)) < 0) {
-      error = TRANSPORT_ERROR_CONNECT;
-      goto exit;
+    if (0 == p_connector->count) break;
+
+    for (i = 0; i < p_connector->count; i++) {
+      p_attempt                        = p_connector->attempts[i];
+      p_connector->poll_fds[i].fd      = p_attempt->socket_fd;
+      p_connector->poll_fds[i].events  = POLLOUT;
+      p_connector->poll_fds[i].revents = 0;
+      if (p_attempt->deadline_ms && (p_attempt->deadline_ms < next)) next = p_attempt->deadline_ms;
     }
-    if (setsockopt(p_posix_socket->socket_fd, SOL_SOCKET, SO_REUSEPORT, &(int) { 1 }, sizeof(int)) < 0) {
-      error = TRANSPORT_ERROR_CONNECT;
+
+    if ((wait_ms >= 0) && (start + (uint64_t) wait_ms < next)) next = start + (uint64_t) wait_ms;
+    timeout = -1;
+    if (UINT64_MAX != next) timeout = (next > now) ? (int) (next - now < INT32_MAX ? next - now : INT32_MAX) : 0;
+
+    if ((poll(p_connector->poll_fds, p_connector->count, timeout) < 0) && (EINTR != errno)) {
+      error = TRANSPORT_ERROR_SOCKET;
       goto exit;
     }
-    connect_status = connect(p_posix_socket->socket_fd, (struct sockaddr*) &socket_address, sizeof(socket_address));
-    if (connect_status) {
-      close(p_posix_socket->socket_fd);
-      attempts++;
-      if (attempts <= retry_count) {
-        sleep(retry_interval);
-      }
+
+    now = socket_tcp_now_ms();
+    for (i = p_connector->count; i-- > 0;) {
+      if (p_connector->poll_fds[i].revents) tcp_connector_check(p_connector, i, now);
     }
-  } while (connect_status && (attempts <= retry_count));
-  if (connect_status) {
-    error = TRANSPORT_ERROR_CONNECT;
-    goto exit;
+
+    // Only now, so that even a run with no time left polls once and picks up the connects that completed
+    if ((wait_ms >= 0) && (now >= start + (uint64_t) wait_ms)) break;
   }
 
 exit:
-  if (error) {
-    ockam_log_error("%x", error);
-    if (p_tcp_socket) {
-      ockam_memory_free(gp_ockam_transport_memory, p_tcp_socket, 0);
-      if (p_transport_ctx) p_transport_ctx->p_socket = NULL;
-    }
+  if (p_pending) *p_pending = p_connector ? p_connector->count : 0;
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t ockam_transport_tcp_connector_deinit(ockam_transport_tcp_connector_t* p_connector)
+{
+  ockam_memory_t* p_memory;
+  size_t          i;
+
+  if (NULL == p_connector) return TRANSPORT_ERROR_BAD_PARAMETER;
+  p_memory = p_connector->p_memory;
+
+  for (i = 0; i < p_connector->count; i++) tcp_connect_attempt_free(p_connector->attempts[i], p_memory);
+  if (p_connector->attempts) {
+    ockam_memory_free(p_memory, p_connector->attempts, p_connector->capacity * sizeof(*p_connector->attempts));
+  }
+  if (p_connector->poll_fds) {
+    ockam_memory_free(p_memory, p_connector->poll_fds, p_connector->capacity * sizeof(*p_connector->poll_fds));
+  }
+  ockam_memory_free(p_memory, p_connector, sizeof(*p_connector));
+  return OCKAM_ERROR_NONE;
+}
+
+void socket_tcp_connect_done(void*              user_ctx,
+                             ockam_transport_t* p_transport,
+                             ockam_reader_t*    p_reader,
+                             ockam_writer_t*    p_writer,
+                             ockam_error_t      error)
+{
+  tcp_connect_result_t* p_result = (tcp_connect_result_t*) user_ctx;
+
+  (void) p_transport;
+  p_result->error    = error;
+  p_result->p_reader = p_reader;
+  p_result->p_writer = p_writer;
+}
+
+/*
+ * The blocking connect is a connector with a single connect. retry_interval, in seconds, caps the backoff.
+ */
+ockam_error_t socket_tcp_connect(void*               ctx,
+                                 ockam_reader_t**    pp_reader,
+                                 ockam_writer_t**    pp_writer,
+                                 ockam_ip_address_t* remote_address,
+                                 int16_t             retry_count,
+                                 uint16_t            retry_interval)
+{
+  ockam_error_t                            error           = OCKAM_ERROR_NONE;
+  socket_tcp_ctx_t*                        p_transport_ctx = (socket_tcp_ctx_t*) ctx;
+  ockam_transport_t                        transport       = { &socket_tcp_vtable, ctx };
+  ockam_transport_tcp_connector_t*         p_connector     = NULL;
+  ockam_transport_tcp_connect_attributes_t attributes      = { 0 };
+  tcp_connect_result_t                     result          = { TRANSPORT_ERROR_CONNECT, NULL, NULL };
+
+  if (NULL == p_transport_ctx) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
+    goto exit;
   }
+
+  attributes.timeout_ms         = p_transport_ctx->connect_timeout_ms;
+  attributes.backoff_initial_ms = p_transport_ctx->retry_backoff_ms;
+  attributes.backoff_max_ms     = retry_interval ? (uint32_t) retry_interval * 1000u : 1u;
+  attributes.retry_count        = retry_count;
+
+  error = ockam_transport_tcp_connector_init(&p_connector, gp_ockam_transport_memory);
+  if (error) goto exit;
+  error = ockam_transport_tcp_connector_add(
+    p_connector, &transport, remote_address, &attributes, socket_tcp_connect_done, &result);
+  if (error) goto exit;
+  error = ockam_transport_tcp_connector_run(p_connector, -1, NULL);
+  if (error) goto exit;
+
+  error = result.error;
+  if (error) goto exit;
+  if (pp_reader) *pp_reader = result.p_reader;
+  if (pp_writer) *pp_writer = result.p_writer;
+
+exit:
+  if (p_connector) ockam_transport_tcp_connector_deinit(p_connector);
+  if (error) ockam_log_error("%x", error);
   return error;
 }
 
@@ -143,6 +514,7 @@ socket_tcp_accept(void* ctx, ockam_reader_t** pp_reader, ockam_writer_t** pp_wri
   socket_tcp_ctx_t* p_tcp_ctx        = (socket_tcp_ctx_t*) ctx;
   tcp_socket_t*     p_listen_socket  = NULL;
   tcp_socket_t*     p_connect_socket = NULL;
+  socklen_t         remote_length    = 0;
 
   if (NULL == p_tcp_ctx) {
     error = TRANSPORT_ERROR_ACCEPT;
@@ -154,15 +526,32 @@ socket_tcp_accept(void* ctx, ockam_reader_t** pp_reader, ockam_writer_t** pp_wri
   error = ockam_memory_alloc_zeroed(gp_ockam_transport_memory, (void**) &p_connect_socket, sizeof(tcp_socket_t));
   if (error) goto exit;
 
-  p_tcp_ctx->p_listen_socket = p_listen_socket;
-  p_tcp_ctx->p_socket        = p_connect_socket;
+  p_listen_socket->posix_socket.socket_fd  = -1;
+  p_connect_socket->posix_socket.socket_fd = -1;
+  p_tcp_ctx->p_listen_socket               = p_listen_socket;
+  p_tcp_ctx->p_socket                      = p_connect_socket;
 
   error =
     make_socket_reader_writer(&p_connect_socket->posix_socket, socket_tcp_read, socket_tcp_write, pp_reader, pp_writer);
   if (error) goto exit;
+  socket_tcp_set_buffer_io(&p_connect_socket->posix_socket);
 
-  p_listen_socket->posix_socket.socket_fd = socket(AF_INET, SOCK_STREAM, 0);
-  if (-1 == p_listen_socket->posix_socket.socket_fd) {
+  if (strlen((char*) p_tcp_ctx->listen_address.ip_address)) {
+    ockam_memory_copy(gp_ockam_transport_memory,
+                      &p_listen_socket->posix_socket.local_address.ip_address,
+                      p_tcp_ctx->listen_address.ip_address,
+                      MAX_IP_ADDRESS_LENGTH);
+  }
+  p_listen_socket->posix_socket.local_address.port = p_tcp_ctx->listen_address.port;
+
+  error = make_socket_address(p_tcp_ctx->listen_address.ip_address,
+                              p_tcp_ctx->listen_address.port,
+                              &p_listen_socket->posix_socket.remote_sockaddr);
+  if (error) goto exit;
+
+  error = make_socket(
+    &p_listen_socket->posix_socket.remote_sockaddr, SOCK_STREAM, &p_listen_socket->posix_socket.socket_fd);
+  if (error) {
     error = TRANSPORT_ERROR_SERVER_INIT;
     goto exit;
   }
@@ -180,22 +569,9 @@ socket_tcp_accept(void* ctx, ockam_reader_t** pp_reader, ockam_writer_t** pp_wri
     goto exit;
   }
 
-  if (strlen((char*) p_tcp_ctx->listen_address.ip_address)) {
-    ockam_memory_copy(gp_ockam_transport_memory,
-                      &p_listen_socket->posix_socket.local_address.ip_address,
-                      p_tcp_ctx->listen_address.ip_address,
-                      MAX_IP_ADDRESS_LENGTH);
-  }
-  p_listen_socket->posix_socket.local_address.port = p_tcp_ctx->listen_address.port;
-
-  error = make_socket_address(p_tcp_ctx->listen_address.ip_address,
-                              p_tcp_ctx->listen_address.port,
-                              &p_listen_socket->posix_socket.remote_sockaddr);
-  if (error) goto exit;
-
   if (0 != bind(p_listen_socket->posix_socket.socket_fd,
                 (struct sockaddr*) &p_listen_socket->posix_socket.remote_sockaddr,
-                sizeof(p_listen_socket->posix_socket.remote_sockaddr))) {
+                socket_address_length(&p_listen_socket->posix_socket.remote_sockaddr))) {
     error = TRANSPORT_ERROR_BAD_PARAMETER;
     ockam_log_error("bind failed in PosixTcpListenBlocking: %x", error);
     goto exit;
@@ -207,12 +583,31 @@ socket_tcp_accept(void* ctx, ockam_reader_t** pp_reader, ockam_writer_t** pp_wri
   }
 
   // Wait for the connection
-  p_connect_socket->posix_socket.socket_fd = accept(p_listen_socket->posix_socket.socket_fd, NULL, 0);
-  if (-1 == p_listen_socket->posix_socket.socket_fd) {
+  remote_length                            = sizeof(p_connect_socket->posix_socket.remote_sockaddr);
+  p_connect_socket->posix_socket.socket_fd = accept(p_listen_socket->posix_socket.socket_fd,
+                                                    (struct sockaddr*) &p_connect_socket->posix_socket.remote_sockaddr,
+                                                    &remote_length);
+  if (-1 == p_connect_socket->posix_socket.socket_fd) {
     error = TRANSPORT_ERROR_ACCEPT;
     goto exit;
   }
 
+  // The transport serves this one connection, a listener left open would complete handshakes nobody accepts
+  close(p_listen_socket->posix_socket.socket_fd);
+  p_listen_socket->posix_socket.socket_fd = -1;
+
+  socket_address_to_ip_address(&p_connect_socket->posix_socket.remote_sockaddr,
+                               &p_connect_socket->posix_socket.remote_address);
+  if (NULL != remote_address) {
+    ockam_memory_copy(gp_ockam_transport_memory,
+                      remote_address,
+                      &p_connect_socket->posix_socket.remote_address,
+                      sizeof(*remote_address));
+  }
+
+  error = socket_tcp_set_options(p_tcp_ctx, p_connect_socket, p_connect_socket->posix_socket.socket_fd);
+  if (error) goto exit;
+
   if (p_connect_socket->posix_socket.p_reader) p_connect_socket->posix_socket.p_reader->ctx = p_connect_socket;
   if (p_connect_socket->posix_socket.p_writer) p_connect_socket->posix_socket.p_writer->ctx = p_connect_socket;
   if (pp_reader) *pp_reader = p_connect_socket->posix_socket.p_reader;
@@ -221,12 +616,129 @@ socket_tcp_accept(void* ctx, ockam_reader_t** pp_reader, ockam_writer_t** pp_wri
 exit:
   if (error) {
     ockam_log_error("%x", error);
-    if (p_listen_socket) ockam_memory_free(gp_ockam_transport_memory, p_listen_socket, 0);
-    if (p_connect_socket) ockam_memory_free(gp_ockam_transport_memory, p_connect_socket, 0);
+    if (p_listen_socket) {
+      if (-1 != p_listen_socket->posix_socket.socket_fd) close(p_listen_socket->posix_socket.socket_fd);
+      ockam_memory_free(gp_ockam_transport_memory, p_listen_socket, sizeof(tcp_socket_t));
+    }
+    if (p_connect_socket) {
+      if (-1 != p_connect_socket->posix_socket.socket_fd) close(p_connect_socket->posix_socket.socket_fd);
+      if (p_connect_socket->posix_socket.p_reader) {
+        ockam_memory_free(gp_ockam_transport_memory, p_connect_socket->posix_socket.p_reader, sizeof(ockam_reader_t));
+      }
+      if (p_connect_socket->posix_socket.p_writer) {
+        ockam_memory_free(gp_ockam_transport_memory, p_connect_socket->posix_socket.p_writer, sizeof(ockam_writer_t));
+      }
+      ockam_memory_free(gp_ockam_transport_memory, p_connect_socket, sizeof(tcp_socket_t));
+    }
+    if (p_tcp_ctx) {
+      p_tcp_ctx->p_listen_socket = NULL;
+      p_tcp_ctx->p_socket        = NULL;
+    }
   }
   return error;
 }
 
+void socket_tcp_set_buffer_io(posix_socket_t* p_socket)
+{
+  if (p_socket->p_reader) p_socket->p_reader->read_buffer = socket_tcp_read_buffer;
+  if (p_socket->p_writer) {
+    p_socket->p_writer->writev       = socket_tcp_writev;
+    p_socket->p_writer->write_buffer = socket_tcp_write_buffer;
+  }
+}
+
+ockam_error_t socket_tcp_set_options(socket_tcp_ctx_t* p_ctx, tcp_socket_t* p_tcp_socket, int socket_fd)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if (p_ctx->tcp_nodelay && (setsockopt(socket_fd, IPPROTO_TCP, TCP_NODELAY, &(int) { 1 }, sizeof(int)) < 0)) {
+    error = TRANSPORT_ERROR_SOCKET;
+    goto exit;
+  }
+
+#ifdef TCP_CORK
+  if (p_ctx->tcp_cork && (setsockopt(socket_fd, IPPROTO_TCP, TCP_CORK, &(int) { 1 }, sizeof(int)) < 0)) {
+    error = TRANSPORT_ERROR_SOCKET;
+    goto exit;
+  }
+  p_tcp_socket->corked = p_ctx->tcp_cork;
+#endif
+
+exit:
+  return error;
+}
+
+/*
+ * Top up the receive buffer with whatever the socket has, blocking only if the buffer is empty.
+ */
+ockam_error_t socket_tcp_fill(tcp_socket_t* p_tcp_ctx)
+{
+  ockam_error_t error       = OCKAM_ERROR_NONE;
+  ssize_t       recv_status = 0;
+
+  if (p_tcp_ctx->receive_start == p_tcp_ctx->receive_length) {
+    p_tcp_ctx->receive_start  = 0;
+    p_tcp_ctx->receive_length = 0;
+  } else if (p_tcp_ctx->receive_start) {
+    memmove(p_tcp_ctx->receive_buffer,
+            p_tcp_ctx->receive_buffer + p_tcp_ctx->receive_start,
+            p_tcp_ctx->receive_length - p_tcp_ctx->receive_start);
+    p_tcp_ctx->receive_length -= p_tcp_ctx->receive_start;
+    p_tcp_ctx->receive_start = 0;
+  }
+
+  do {
+    recv_status = recv(p_tcp_ctx->posix_socket.socket_fd,
+                       p_tcp_ctx->receive_buffer + p_tcp_ctx->receive_length,
+                       TCP_RECEIVE_BUFFER_SIZE - p_tcp_ctx->receive_length,
+                       0);
+  } while ((recv_status < 0) && (EINTR == errno));
+
+  if (recv_status <= 0) {
+    error = TRANSPORT_ERROR_RECEIVE;
+    goto exit;
+  }
+  p_tcp_ctx->receive_length += recv_status;
+
+exit:
+  return error;
+}
+
+/*
+ * Wait for a complete length prefix and decode it, leaving it in the receive buffer.
+ */
+ockam_error_t socket_tcp_peek_header(tcp_socket_t* p_tcp_ctx, size_t* p_frame_length, size_t* p_header_length)
+{
+  ockam_error_t error         = OCKAM_ERROR_NONE;
+  uint8_t*      p_length      = NULL;
+  size_t        header_length = TCP_FRAME_HEADER_SIZE;
+  size_t        buffered      = 0;
+
+  for (;;) {
+    buffered = p_tcp_ctx->receive_length - p_tcp_ctx->receive_start;
+    p_length = p_tcp_ctx->receive_buffer + p_tcp_ctx->receive_start;
+    if ((buffered >= TCP_FRAME_HEADER_SIZE) &&
+        (TCP_FRAME_LENGTH_EXTENDED == (((size_t) p_length[0] << 8u) | p_length[1]))) {
+      header_length = TCP_FRAME_HEADER_MAX_SIZE;
+    }
+    if (buffered >= header_length) break;
+    error = socket_tcp_fill(p_tcp_ctx);
+    if (error) goto exit;
+  }
+
+  // Length prefix is in network order
+  p_length        = p_tcp_ctx->receive_buffer + p_tcp_ctx->receive_start;
+  *p_frame_length = ((size_t) p_length[0] << 8u) | p_length[1];
+  if (TCP_FRAME_LENGTH_EXTENDED == *p_frame_length) {
+    *p_frame_length = ((size_t) p_length[2] << 24u) | ((size_t) p_length[3] << 16u) | ((size_t) p_length[4] << 8u) |
+                      p_length[5];
+  }
+  *p_header_length = header_length;
+
+exit:
+  return error;
+}
+
 ockam_error_t socket_tcp_read(void* ctx, uint8_t* buffer, size_t buffer_size, size_t* buffer_length)
 {
   ockam_error_t   error     = OCKAM_ERROR_NONE;
@@ -234,7 +746,7 @@ ockam_error_t socket_tcp_read(void* ctx, uint8_t* buffer, size_t buffer_size, si
   posix_socket_t* p_socket  = &p_tcp_ctx->posix_socket;
 
   tcp_transmission_t* p_transmission = NULL;
-  ssize_t             bytes_read     = 0;
+  size_t              bytes_read     = 0;
 
   if (-1 == p_socket->socket_fd) {
     error = TRANSPORT_ERROR_SOCKET;
@@ -251,31 +763,43 @@ ockam_error_t socket_tcp_read(void* ctx, uint8_t* buffer, size_t buffer_size, si
   p_transmission->buffer_remaining = buffer_size;
 
   if (TRANSPORT_ERROR_MORE_DATA != p_transmission->status) {
-    uint16_t recv_len = 0;
-    bytes_read        = recv(p_socket->socket_fd, &recv_len, sizeof(uint16_t), 0);
-    // Must convert from network order to native endianness
-    p_transmission->transmit_length = ntohs(recv_len);
-    if (sizeof(uint16_t) != bytes_read) {
-      error = TRANSPORT_ERROR_RECEIVE;
-      goto exit;
-    }
+    size_t header_length = 0;
+    error                = socket_tcp_peek_header(p_tcp_ctx, &p_transmission->transmit_length, &header_length);
+    if (error) goto exit;
+    p_tcp_ctx->receive_start += header_length;
     if (p_transmission->transmit_length > 0) p_transmission->status = TRANSPORT_ERROR_MORE_DATA;
   }
 
-  bytes_read = 0;
   while ((TRANSPORT_ERROR_MORE_DATA == p_transmission->status) && (p_transmission->buffer_remaining > 0)) {
-    ssize_t recv_status   = 0;
-    size_t  bytes_to_read = p_transmission->transmit_length - p_transmission->bytes_transmitted;
+    size_t bytes_to_read = p_transmission->transmit_length - p_transmission->bytes_transmitted;
+    size_t buffered      = p_tcp_ctx->receive_length - p_tcp_ctx->receive_start;
     if (bytes_to_read > p_transmission->buffer_remaining) bytes_to_read = p_transmission->buffer_remaining;
-    recv_status = recv(p_socket->socket_fd, p_transmission->buffer + bytes_read, bytes_to_read, 0);
-    if (0 > recv_status) {
-      ockam_log_error("receive failed: %ll", recv_status);
-      goto exit;
+
+    if (buffered) {
+      if (bytes_to_read > buffered) bytes_to_read = buffered;
+      ockam_memory_copy(gp_ockam_transport_memory,
+                        p_transmission->buffer + bytes_read,
+                        p_tcp_ctx->receive_buffer + p_tcp_ctx->receive_start,
+                        bytes_to_read);
+      p_tcp_ctx->receive_start += bytes_to_read;
+    } else if (bytes_to_read >= TCP_RECEIVE_BUFFER_SIZE) {
+      // Large remainder: skip the intermediate copy
+      ssize_t recv_status = recv(p_socket->socket_fd, p_transmission->buffer + bytes_read, bytes_to_read, 0);
+      if (recv_status < 0 && EINTR == errno) continue;
+      if (recv_status <= 0) {
+        error = TRANSPORT_ERROR_RECEIVE;
+        goto exit;
+      }
+      bytes_to_read = recv_status;
+    } else {
+      error = socket_tcp_fill(p_tcp_ctx);
+      if (error) goto exit;
+      continue;
     }
-    bytes_read += recv_status;
+    bytes_read += bytes_to_read;
 
-    p_transmission->bytes_transmitted += recv_status;
-    p_transmission->buffer_remaining -= recv_status;
+    p_transmission->bytes_transmitted += bytes_to_read;
+    p_transmission->buffer_remaining -= bytes_to_read;
     if (p_transmission->bytes_transmitted < p_transmission->transmit_length) {
       p_transmission->status = TRANSPORT_ERROR_MORE_DATA;
     } else {
@@ -289,39 +813,207 @@ ockam_error_t socket_tcp_read(void* ctx, uint8_t* buffer, size_t buffer_size, si
   }
 
 exit:
-  if (error) ockam_log_error("%x", error);
+  if (error && (TRANSPORT_ERROR_MORE_DATA != error)) ockam_log_error("%x", error);
   return error;
 }
 
-ockam_error_t socket_tcp_write(void* ctx, uint8_t* buffer, size_t buffer_length)
+/*
+ * Receive one frame into a buffer sized to fit it. Only the bytes that arrived together with earlier frames are
+ * copied out of the receive buffer; the rest of a large frame goes straight from the socket into the new buffer.
+ */
+ockam_error_t socket_tcp_read_buffer(void* ctx, ockam_buffer_t** pp_buffer)
 {
-  ockam_error_t   error       = OCKAM_ERROR_NONE;
+  ockam_error_t   error         = OCKAM_ERROR_NONE;
+  tcp_socket_t*   p_tcp_ctx     = (tcp_socket_t*) ctx;
+  posix_socket_t* p_socket      = &p_tcp_ctx->posix_socket;
+  ockam_buffer_t* p_buffer      = NULL;
+  size_t          frame_length  = 0;
+  size_t          header_length = 0;
+  size_t          buffered      = 0;
+  size_t          bytes_to_read = 0;
+  ssize_t         recv_status   = 0;
 
-  if (buffer_length > (SIZE_MAX >> 1u)) {
-      error = TRANSPORT_ERROR_BAD_PARAMETER;
-      goto exit;
+  if (-1 == p_socket->socket_fd) {
+    error = TRANSPORT_ERROR_SOCKET;
+    goto exit;
   }
 
-  tcp_socket_t*   p_tcp_ctx   = (tcp_socket_t*) ctx;
-  posix_socket_t* p_socket    = &p_tcp_ctx->posix_socket;
-  uint16_t        send_length = 0;
+  // Frames already half-delivered through socket_tcp_read() have to be finished there
+  if (TRANSPORT_ERROR_MORE_DATA == p_tcp_ctx->read_transmission.status) {
+    error = TRANSPORT_ERROR_INVALID_OP;
+    goto exit;
+  }
 
-  // Convert from native endianness to network order
-  send_length = htons(buffer_length);
-  ssize_t bytes_sent = send(p_socket->socket_fd, (void*) &send_length, sizeof(uint16_t), 0);
-  if (sizeof(uint16_t) != bytes_sent) {
-    error = TRANSPORT_ERROR_SEND;
+  error = socket_tcp_peek_header(p_tcp_ctx, &frame_length, &header_length);
+  if (error) goto exit;
+
+  // The prefix stays queued, so the caller may still take an oversized frame with socket_tcp_read()
+  if (frame_length > TCP_READ_BUFFER_MAX_SIZE) {
+    error = TRANSPORT_ERROR_BUFFER_TOO_SMALL;
     goto exit;
   }
 
-  bytes_sent = send(p_socket->socket_fd, buffer, buffer_length, 0);
-  if (bytes_sent < 0 || bytes_sent != buffer_length) {
+  error = ockam_buffer_alloc(gp_ockam_transport_memory, 0, frame_length, &p_buffer);
+  if (error) goto exit;
+  p_tcp_ctx->receive_start += header_length;
+
+  while (p_buffer->length < frame_length) {
+    bytes_to_read = frame_length - p_buffer->length;
+    buffered      = p_tcp_ctx->receive_length - p_tcp_ctx->receive_start;
+
+    if (buffered) {
+      if (bytes_to_read > buffered) bytes_to_read = buffered;
+      ockam_memory_copy(gp_ockam_transport_memory,
+                        ockam_buffer_data(p_buffer) + p_buffer->length,
+                        p_tcp_ctx->receive_buffer + p_tcp_ctx->receive_start,
+                        bytes_to_read);
+      p_tcp_ctx->receive_start += bytes_to_read;
+    } else if (bytes_to_read >= TCP_RECEIVE_BUFFER_SIZE) {
+      recv_status = recv(p_socket->socket_fd, ockam_buffer_data(p_buffer) + p_buffer->length, bytes_to_read, 0);
+      if (recv_status < 0 && EINTR == errno) continue;
+      if (recv_status <= 0) {
+        error = TRANSPORT_ERROR_RECEIVE;
+        goto exit;
+      }
+      bytes_to_read = recv_status;
+    } else {
+      error = socket_tcp_fill(p_tcp_ctx);
+      if (error) goto exit;
+      continue;
+    }
+    p_buffer->length += bytes_to_read;
+  }
+
+  *pp_buffer = p_buffer;
+  p_buffer   = NULL;
+
+exit:
+  if (error && (TRANSPORT_ERROR_BUFFER_TOO_SMALL != error)) ockam_log_error("%x", error);
+  ockam_buffer_release(p_buffer);
+  return error;
+}
+
+/*
+ * Send the iovecs completely, resuming after short writes. A corked socket is then flushed, so the frame's last
+ * partial segment goes out now instead of when the kernel's cork timer expires.
+ */
+ockam_error_t socket_tcp_send(tcp_socket_t* p_tcp_socket, struct iovec* iov, size_t iov_count)
+{
+  posix_socket_t* p_socket = &p_tcp_socket->posix_socket;
+
+  ockam_error_t error   = OCKAM_ERROR_NONE;
+  struct msghdr message = { 0 };
+  ssize_t       sent    = 0;
+
+  message.msg_iov    = iov;
+  message.msg_iovlen = iov_count;
+
+  // A blocking socket may still return short, e.g. when interrupted; resume where it stopped
+  while (message.msg_iovlen) {
+    sent = sendmsg(p_socket->socket_fd, &message, MSG_NOSIGNAL);
+    if (sent < 0) {
+      if (EINTR == errno) continue;
+      error = TRANSPORT_ERROR_SEND;
+      goto exit;
+    }
+    while (message.msg_iovlen && ((size_t) sent >= message.msg_iov->iov_len)) {
+      sent -= message.msg_iov->iov_len;
+      message.msg_iov++;
+      message.msg_iovlen--;
+    }
+    if (message.msg_iovlen) {
+      message.msg_iov->iov_base = (uint8_t*) message.msg_iov->iov_base + sent;
+      message.msg_iov->iov_len -= sent;
+    }
+  }
+
+#ifdef TCP_CORK
+  if (p_tcp_socket->corked &&
+      ((setsockopt(p_socket->socket_fd, IPPROTO_TCP, TCP_CORK, &(int) { 0 }, sizeof(int)) < 0) ||
+       (setsockopt(p_socket->socket_fd, IPPROTO_TCP, TCP_CORK, &(int) { 1 }, sizeof(int)) < 0))) {
     error = TRANSPORT_ERROR_SEND;
+  }
+#endif
+
+exit:
+  return error;
+}
+
+ockam_error_t socket_tcp_writev(void* ctx, const ockam_iovec_t* iov, size_t iov_count)
+{
+  ockam_error_t error     = OCKAM_ERROR_NONE;
+  tcp_socket_t* p_tcp_ctx = (tcp_socket_t*) ctx;
+  uint8_t       header[TCP_FRAME_HEADER_MAX_SIZE];
+  struct iovec  socket_iov[SOCKET_WRITEV_MAX + 1];
+  size_t        length = 0;
+  size_t        i      = 0;
+
+  if (iov_count > SOCKET_WRITEV_MAX) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
+    goto exit;
+  }
+
+  for (i = 0; i < iov_count; i++) {
+    socket_iov[i + 1].iov_base = iov[i].base;
+    socket_iov[i + 1].iov_len  = iov[i].length;
+    length += iov[i].length;
+  }
+  if (length > UINT32_MAX) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
+    goto exit;
+  }
+
+  // Length prefix and body go out in a single sendmsg(), so they share a segment
+  socket_iov[0].iov_base = header;
+  socket_iov[0].iov_len  = tcp_frame_encode_header(length, header);
+
+  error = socket_tcp_send(p_tcp_ctx, socket_iov, iov_count + 1);
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t socket_tcp_write(void* ctx, uint8_t* buffer, size_t buffer_length)
+{
+  ockam_iovec_t iov = { buffer, buffer_length };
+
+  return socket_tcp_writev(ctx, &iov, 1);
+}
+
+/*
+ * With enough headroom the length prefix goes in front of the data and the frame leaves as one contiguous block.
+ */
+ockam_error_t socket_tcp_write_buffer(void* ctx, ockam_buffer_t* p_buffer)
+{
+  ockam_error_t error     = OCKAM_ERROR_NONE;
+  tcp_socket_t* p_tcp_ctx = (tcp_socket_t*) ctx;
+  uint8_t       header[TCP_FRAME_HEADER_MAX_SIZE];
+  size_t        header_length = 0;
+  uint8_t*      p_frame       = NULL;
+  struct iovec  iov;
+  ockam_iovec_t data;
+
+  if (p_buffer->length > UINT32_MAX) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
     goto exit;
   }
 
+  header_length = tcp_frame_encode_header(p_buffer->length, header);
+  if ((1 == p_buffer->refcount) && (OCKAM_ERROR_NONE == ockam_buffer_push(p_buffer, header_length, &p_frame))) {
+    ockam_memory_copy(gp_ockam_transport_memory, p_frame, header, header_length);
+    iov.iov_base = p_frame;
+    iov.iov_len  = p_buffer->length;
+    error        = socket_tcp_send(p_tcp_ctx, &iov, 1);
+  } else {
+    data.base   = ockam_buffer_data(p_buffer);
+    data.length = p_buffer->length;
+    error       = socket_tcp_writev(ctx, &data, 1);
+  }
+
 exit:
   if (error) ockam_log_error("%x", error);
+  ockam_buffer_release(p_buffer);
   return error;
 }
 
@@ -329,13 +1021,26 @@ ockam_error_t socket_tcp_deinit(ockam_transport_t* p_transport)
 {
   socket_tcp_ctx_t* p_tcp_ctx = (socket_tcp_ctx_t*) p_transport->ctx;
 
-  if (p_tcp_ctx->p_socket != NULL) {
+  if (p_tcp_ctx != NULL) {
     // Close the connection
-    if (NULL != p_tcp_ctx->p_socket->posix_socket.p_reader)
-      ockam_memory_free(gp_ockam_transport_memory, p_tcp_ctx->p_socket->posix_socket.p_reader, 0);
-    if (NULL != p_tcp_ctx->p_socket->posix_socket.p_writer)
-      ockam_memory_free(gp_ockam_transport_memory, p_tcp_ctx->p_socket->posix_socket.p_writer, 0);
-    if (NULL != p_tcp_ctx->p_socket) ockam_memory_free(gp_ockam_transport_memory, p_tcp_ctx->p_socket, 0);
+    if (p_tcp_ctx->p_socket != NULL) {
+      if (NULL != p_tcp_ctx->p_socket->posix_socket.p_reader)
+        ockam_memory_free(
+          gp_ockam_transport_memory, p_tcp_ctx->p_socket->posix_socket.p_reader, sizeof(ockam_reader_t));
+      if (NULL != p_tcp_ctx->p_socket->posix_socket.p_writer)
+        ockam_memory_free(
+          gp_ockam_transport_memory, p_tcp_ctx->p_socket->posix_socket.p_writer, sizeof(ockam_writer_t));
+      if (-1 != p_tcp_ctx->p_socket->posix_socket.socket_fd) close(p_tcp_ctx->p_socket->posix_socket.socket_fd);
+      ockam_memory_free(gp_ockam_transport_memory, p_tcp_ctx->p_socket, sizeof(tcp_socket_t));
+    }
+    if (p_tcp_ctx->p_listen_socket != NULL) {
+      if (-1 != p_tcp_ctx->p_listen_socket->posix_socket.socket_fd) {
+        close(p_tcp_ctx->p_listen_socket->posix_socket.socket_fd);
+      }
+      ockam_memory_free(gp_ockam_transport_memory, p_tcp_ctx->p_listen_socket, sizeof(tcp_socket_t));
+    }
+    ockam_memory_free(gp_ockam_transport_memory, p_tcp_ctx, sizeof(socket_tcp_ctx_t));
+    p_transport->ctx = NULL;
   }
 
   return 0;
@@ -8,6 +8,74 @@
 
 ockam_error_t ockam_transport_socket_tcp_init(ockam_transport_t* transport, ockam_transport_socket_attributes_t* attrs);
 
+/**
+ * Asynchronous connects for TCP transports.
+ *
+ * A connector drives the connects of any number of TCP transports, each initialized with
+ * ockam_transport_socket_tcp_init(), from one thread. Every attempt is a non-blocking connect() whose completion is
+ * picked up with poll(), so a slow or unreachable peer holds up no other connect. A failed or timed out attempt is
+ * retried after a backoff that starts at backoff_initial_ms and doubles after each failure up to backoff_max_ms. Each
+ * wait is drawn at random between half the backoff and the full backoff, so peers that failed together spread out
+ * their retries. A connected transport is left as ockam_transport_connect() leaves it: reads and writes block.
+ */
+
+typedef struct ockam_transport_tcp_connector ockam_transport_tcp_connector_t;
+
+typedef struct ockam_transport_tcp_connect_attributes {
+  uint32_t timeout_ms;         /*!< Give up on an attempt after this, 0 leaves it to the OS */
+  uint32_t backoff_initial_ms; /*!< Backoff after the first failure, 0 means 100 */
+  uint32_t backoff_max_ms;     /*!< Longest backoff, 0 means 10000 */
+  int16_t  retry_count;        /*!< -1: forever, 0: no retries, >0: number of retries */
+} ockam_transport_tcp_connect_attributes_t;
+
+/**
+ * @brief   Called on the thread running the connector once a connect succeeded or ran out of retries.
+ * @param   user_ctx    [in] - user_ctx given to ockam_transport_tcp_connector_add.
+ * @param   p_transport [in] - The transport that connected, or failed to.
+ * @param   p_reader    [in] - Reader of the connection, NULL on error.
+ * @param   p_writer    [in] - Writer of the connection, NULL on error.
+ * @param   error       [in] - OCKAM_ERROR_NONE, or TRANSPORT_ERROR_CONNECT once no retry is left.
+ */
+typedef void (*ockam_transport_tcp_connect_cb)(void*              user_ctx,
+                                               ockam_transport_t* p_transport,
+                                               ockam_reader_t*    p_reader,
+                                               ockam_writer_t*    p_writer,
+                                               ockam_error_t      error);
+
+ockam_error_t
+ockam_transport_tcp_connector_init(ockam_transport_tcp_connector_t** pp_connector, ockam_memory_t* p_memory);
+
+/**
+ * @brief   Start connecting a TCP transport. The first attempt is made by the next ockam_transport_tcp_connector_run.
+ * @param   p_connector     [in] - Connector.
+ * @param   p_transport     [in] - TCP transport, must stay valid until the callback has run.
+ * @param   remote_address  [in] - Address to connect to.
+ * @param   p_attributes    [in] - Optional, NULL for the defaults.
+ * @param   callback        [in] - Called once with the outcome.
+ * @param   user_ctx        [in] - Passed to the callback.
+ */
+ockam_error_t ockam_transport_tcp_connector_add(ockam_transport_tcp_connector_t*          p_connector,
+                                                ockam_transport_t*                        p_transport,
+                                                ockam_ip_address_t*                       remote_address,
+                                                ockam_transport_tcp_connect_attributes_t* p_attributes,
+                                                ockam_transport_tcp_connect_cb            callback,
+                                                void*                                     user_ctx);
+
+/**
+ * @brief   Make progress on every pending connect, running callbacks as connects complete. Callbacks may add connects.
+ * @param   p_connector [in]  - Connector.
+ * @param   wait_ms     [in]  - Return after this long even with connects pending, -1 waits until none is left.
+ *                                0 checks the pending connects once without waiting, for callers with their own loop.
+ * @param   p_pending   [out] - Optional, number of connects still pending.
+ */
+ockam_error_t
+ockam_transport_tcp_connector_run(ockam_transport_tcp_connector_t* p_connector, int32_t wait_ms, size_t* p_pending);
+
+/**
+ * @brief   Free the connector. Pending connects are abandoned without running their callbacks.
+ */
+ockam_error_t ockam_transport_tcp_connector_deinit(ockam_transport_tcp_connector_t* p_connector);
+
 // TODO: add ockam_ prefix to types declared here. Review which of them indeed need to be public.
 
 /**
@@ -23,14 +91,33 @@ typedef struct tcp_transmission_t {
   ockam_error_t error; // transmission completion status
 } tcp_transmission_t;
 
+#define TCP_RECEIVE_BUFFER_SIZE 16384
+
+/*
+ * Largest frame socket_tcp_read_buffer() allocates for; bigger frames are left for ockam_read()
+ */
+#define TCP_READ_BUFFER_MAX_SIZE (16u * 1024u * 1024u)
+
+/**
+ * Reads go through receive_buffer so that one recv() can pick up several small frames, including their length
+ * prefixes. Frames larger than the buffer are received straight into the caller's buffer.
+ */
 typedef struct tcp_socket {
   posix_socket_t     posix_socket;
   tcp_transmission_t read_transmission;
   tcp_transmission_t write_transmission;
+  uint8_t            corked; // TCP_CORK is set, uncork after each frame to flush it
+  size_t             receive_start;
+  size_t             receive_length;
+  uint8_t            receive_buffer[TCP_RECEIVE_BUFFER_SIZE];
 } tcp_socket_t;
 
 typedef struct socket_tcp_ctx {
   ockam_ip_address_t listen_address;
+  uint8_t            tcp_nodelay;
+  uint8_t            tcp_cork;
+  uint32_t           connect_timeout_ms;
+  uint32_t           retry_backoff_ms;
   tcp_socket_t*      p_listen_socket;
   tcp_socket_t*      p_socket; // ToDo: make this a linked list
 } socket_tcp_ctx_t;
@@ -0,0 +1,868 @@
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+
+#include "ockam/log.h"
+#include "ockam/io.h"
+#include "ockam/io/impl.h"
+#include "ockam/memory.h"
+#include "ockam/transport.h"
+#include "ockam/transport/impl.h"
+#include "socket.h"
+#include "socket_tcp_epoll.h"
+
+#define TCP_EPOLL_MIN_PENDING         (TCP_FRAME_HEADER_SIZE + UINT16_MAX)
+#define TCP_EPOLL_DEFAULT_MAX_FRAME   (1024u * 1024u)
+#define TCP_EPOLL_RX_INITIAL_SIZE     2048u
+#define TCP_EPOLL_TX_INITIAL_SIZE     4096u
+#define TCP_EPOLL_DEFAULT_MAX_PENDING (256u * 1024u)
+#define TCP_EPOLL_EVENTS_PER_WAIT     64
+#define TCP_EPOLL_READS_PER_EVENT     16
+
+typedef struct tcp_epoll_loop tcp_epoll_loop_t;
+typedef struct tcp_epoll_ctx  tcp_epoll_ctx_t;
+
+struct ockam_transport_tcp_connection {
+  ockam_transport_tcp_connection_t* p_next;
+  ockam_transport_tcp_connection_t* p_prev;
+  tcp_epoll_loop_t*                 p_loop;
+  ockam_writer_t                    writer;
+  ockam_ip_address_t                remote_address;
+  void*                             context;
+  int                               socket_fd;
+  int                               incoming;
+  int                               connecting;
+  int                               registered;
+  int                               closed;
+  pthread_mutex_t                   write_lock;
+  uint8_t*                          rx;
+  size_t                            rx_size;
+  size_t                            rx_length;
+  uint8_t*                          tx;
+  size_t                            tx_size;
+  size_t                            tx_length;
+};
+
+/*
+ * Connections are only touched by their loop's thread, except for the output buffer, which writers on other threads
+ * reach through write_lock. Closed connections stay on p_closed until the current batch of events is done, so a later
+ * event in the same batch never refers to freed memory.
+ */
+struct tcp_epoll_loop {
+  tcp_epoll_ctx_t*                  p_ctx;
+  pthread_t                         thread;
+  int                               thread_started;
+  int                               epoll_fd;
+  int                               wake_fd;
+  pthread_mutex_t                   lock;
+  int                               stop;
+  ockam_transport_tcp_connection_t* p_pending;
+  ockam_transport_tcp_connection_t* p_connections;
+  ockam_transport_tcp_connection_t* p_closed;
+};
+
+struct tcp_epoll_ctx {
+  ockam_transport_socket_tcp_epoll_attributes_t attributes;
+  ockam_memory_t*                               p_memory;
+  int                                           listen_fd;
+  pthread_mutex_t                               lock;
+  size_t                                        next_loop;
+  uint16_t                                      loop_count;
+  tcp_epoll_loop_t                              loops[OCKAM_TRANSPORT_TCP_EPOLL_MAX_THREADS];
+};
+
+ockam_error_t tcp_epoll_vtable_connect(void*               ctx,
+                                       ockam_reader_t**    pp_reader,
+                                       ockam_writer_t**    pp_writer,
+                                       ockam_ip_address_t* remote_address,
+                                       int16_t             retry_count,
+                                       uint16_t            retry_interval);
+ockam_error_t tcp_epoll_vtable_accept(void*               ctx,
+                                      ockam_reader_t**    pp_reader,
+                                      ockam_writer_t**    pp_writer,
+                                      ockam_ip_address_t* remote_address);
+ockam_error_t tcp_epoll_vtable_deinit(ockam_transport_t* p_transport);
+
+ockam_transport_vtable_t socket_tcp_epoll_vtable = { tcp_epoll_vtable_connect,
+                                                     tcp_epoll_vtable_accept,
+                                                     tcp_epoll_vtable_deinit };
+
+ockam_error_t tcp_epoll_writer_write(void* ctx, uint8_t* buffer, size_t length)
+{
+  return ockam_transport_tcp_connection_write((ockam_transport_tcp_connection_t*) ctx, buffer, length);
+}
+
+ockam_error_t tcp_epoll_resize(ockam_memory_t* p_memory, uint8_t** pp_buffer, size_t* p_size, size_t used, size_t size)
+{
+  ockam_error_t error    = OCKAM_ERROR_NONE;
+  uint8_t*      p_buffer = NULL;
+
+  error = ockam_memory_alloc_zeroed(p_memory, (void**) &p_buffer, size);
+  if (error) goto exit;
+
+  if (*pp_buffer) {
+    if (used) ockam_memory_copy(p_memory, p_buffer, *pp_buffer, used);
+    ockam_memory_free(p_memory, *pp_buffer, *p_size);
+  }
+
+  *pp_buffer = p_buffer;
+  *p_size    = size;
+
+exit:
+  return error;
+}
+
+ockam_error_t tcp_epoll_connection_alloc(tcp_epoll_ctx_t* p_ctx, int socket_fd, ockam_transport_tcp_connection_t** pp)
+{
+  ockam_error_t                     error        = OCKAM_ERROR_NONE;
+  ockam_transport_tcp_connection_t* p_connection = NULL;
+
+  error = ockam_memory_alloc_zeroed(p_ctx->p_memory, (void**) &p_connection, sizeof(*p_connection));
+  if (error) goto exit;
+
+  error = tcp_epoll_resize(p_ctx->p_memory, &p_connection->rx, &p_connection->rx_size, 0, TCP_EPOLL_RX_INITIAL_SIZE);
+  if (error) goto exit;
+
+  pthread_mutex_init(&p_connection->write_lock, NULL);
+  p_connection->socket_fd    = socket_fd;
+  p_connection->writer.write = tcp_epoll_writer_write;
+  p_connection->writer.ctx   = p_connection;
+  *pp                        = p_connection;
+
+exit:
+  if (error) {
+    ockam_log_error("%x", error);
+    if (p_connection) ockam_memory_free(p_ctx->p_memory, p_connection, sizeof(*p_connection));
+  }
+  return error;
+}
+
+void tcp_epoll_connection_free(tcp_epoll_ctx_t* p_ctx, ockam_transport_tcp_connection_t* p_connection)
+{
+  pthread_mutex_destroy(&p_connection->write_lock);
+  if (p_connection->rx) ockam_memory_free(p_ctx->p_memory, p_connection->rx, p_connection->rx_size);
+  if (p_connection->tx) ockam_memory_free(p_ctx->p_memory, p_connection->tx, p_connection->tx_size);
+  ockam_memory_free(p_ctx->p_memory, p_connection, sizeof(*p_connection));
+}
+
+/*
+ * Hand a new connection to a loop. The loop registers it with epoll and runs the accept callback on its own thread.
+ */
+void tcp_epoll_hand_off(tcp_epoll_ctx_t* p_ctx, ockam_transport_tcp_connection_t* p_connection)
+{
+  tcp_epoll_loop_t* p_loop = NULL;
+
+  pthread_mutex_lock(&p_ctx->lock);
+  p_loop = &p_ctx->loops[p_ctx->next_loop++ % p_ctx->loop_count];
+  pthread_mutex_unlock(&p_ctx->lock);
+
+  p_connection->p_loop = p_loop;
+
+  pthread_mutex_lock(&p_loop->lock);
+  p_connection->p_next = p_loop->p_pending;
+  p_loop->p_pending    = p_connection;
+  pthread_mutex_unlock(&p_loop->lock);
+
+  eventfd_write(p_loop->wake_fd, 1);
+}
+
+ockam_error_t tcp_epoll_arm(ockam_transport_tcp_connection_t* p_connection, int op)
+{
+  ockam_error_t      error = OCKAM_ERROR_NONE;
+  struct epoll_event event = { 0 };
+
+  event.events   = EPOLLIN | EPOLLRDHUP;
+  event.data.ptr = p_connection;
+  if (p_connection->tx_length || p_connection->connecting) event.events |= EPOLLOUT;
+
+  if (0 != epoll_ctl(p_connection->p_loop->epoll_fd, op, p_connection->socket_fd, &event)) {
+    error = TRANSPORT_ERROR_SOCKET;
+  }
+
+  return error;
+}
+
+void tcp_epoll_connection_close(tcp_epoll_loop_t* p_loop, ockam_transport_tcp_connection_t* p_connection)
+{
+  tcp_epoll_ctx_t* p_ctx = p_loop->p_ctx;
+
+  if (p_connection->closed) return;
+
+  pthread_mutex_lock(&p_connection->write_lock);
+  p_connection->closed = 1;
+  if (p_connection->registered) epoll_ctl(p_loop->epoll_fd, EPOLL_CTL_DEL, p_connection->socket_fd, NULL);
+  close(p_connection->socket_fd);
+  p_connection->socket_fd = -1;
+  pthread_mutex_unlock(&p_connection->write_lock);
+
+  if (p_connection->p_prev) {
+    p_connection->p_prev->p_next = p_connection->p_next;
+  } else if (p_loop->p_connections == p_connection) {
+    p_loop->p_connections = p_connection->p_next;
+  }
+  if (p_connection->p_next) p_connection->p_next->p_prev = p_connection->p_prev;
+
+  if (p_connection->registered && p_ctx->attributes.close) {
+    p_ctx->attributes.close(p_ctx->attributes.user_ctx, p_connection);
+  }
+
+  p_connection->p_prev = NULL;
+  p_connection->p_next = p_loop->p_closed;
+  p_loop->p_closed     = p_connection;
+}
+
+int tcp_epoll_register_pending(tcp_epoll_loop_t* p_loop)
+{
+  ockam_error_t                     error        = OCKAM_ERROR_NONE;
+  tcp_epoll_ctx_t*                  p_ctx        = p_loop->p_ctx;
+  ockam_transport_tcp_connection_t* p_connection = NULL;
+  ockam_transport_tcp_connection_t* p_next       = NULL;
+  eventfd_t                         count        = 0;
+  int                               stop         = 0;
+
+  eventfd_read(p_loop->wake_fd, &count);
+
+  pthread_mutex_lock(&p_loop->lock);
+  stop              = p_loop->stop;
+  p_connection      = p_loop->p_pending;
+  p_loop->p_pending = NULL;
+  pthread_mutex_unlock(&p_loop->lock);
+
+  for (; p_connection; p_connection = p_next) {
+    p_next = p_connection->p_next;
+
+    p_connection->p_prev = NULL;
+    p_connection->p_next = p_loop->p_connections;
+    if (p_loop->p_connections) p_loop->p_connections->p_prev = p_connection;
+    p_loop->p_connections = p_connection;
+
+    pthread_mutex_lock(&p_connection->write_lock);
+    error = tcp_epoll_arm(p_connection, EPOLL_CTL_ADD);
+    if (!error) p_connection->registered = 1;
+    pthread_mutex_unlock(&p_connection->write_lock);
+
+    if (!error && p_connection->incoming && p_ctx->attributes.accept) {
+      error = p_ctx->attributes.accept(p_ctx->attributes.user_ctx, p_connection, &p_connection->remote_address);
+    }
+    if (error) tcp_epoll_connection_close(p_loop, p_connection);
+  }
+
+  return stop;
+}
+
+void tcp_epoll_accept(tcp_epoll_ctx_t* p_ctx)
+{
+  ockam_error_t                     error        = OCKAM_ERROR_NONE;
+  ockam_transport_tcp_connection_t* p_connection = NULL;
+  struct sockaddr_storage           remote_sockaddr;
+  socklen_t                         remote_length;
+  int                               socket_fd;
+
+  for (;;) {
+    remote_length = sizeof(remote_sockaddr);
+    socket_fd =
+      accept4(p_ctx->listen_fd, (struct sockaddr*) &remote_sockaddr, &remote_length, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (-1 == socket_fd) {
+      if (EINTR == errno) continue;
+      if ((EAGAIN != errno) && (EWOULDBLOCK != errno)) ockam_log_error("accept failed: %d", errno);
+      break;
+    }
+
+    error = tcp_epoll_connection_alloc(p_ctx, socket_fd, &p_connection);
+    if (error) {
+      close(socket_fd);
+      continue;
+    }
+
+    p_connection->incoming = 1;
+    socket_address_to_ip_address(&remote_sockaddr, &p_connection->remote_address);
+
+    tcp_epoll_hand_off(p_ctx, p_connection);
+  }
+}
+
+/*
+ * Deliver every complete frame in the receive buffer, then move any partial frame to the front. The buffer grows
+ * when the next frame header announces a frame larger than the buffer.
+ */
+ockam_error_t tcp_epoll_deliver(tcp_epoll_ctx_t* p_ctx, ockam_transport_tcp_connection_t* p_connection)
+{
+  ockam_error_t error         = OCKAM_ERROR_NONE;
+  size_t        offset        = 0;
+  size_t        frame         = 0;
+  size_t        header_length = 0;
+  uint8_t*      p_header      = NULL;
+
+  while (p_connection->rx_length - offset >= TCP_FRAME_HEADER_SIZE) {
+    p_header      = p_connection->rx + offset;
+    header_length = TCP_FRAME_HEADER_SIZE;
+    frame         = ((size_t) p_header[0] << 8u) | p_header[1];
+    if (TCP_FRAME_LENGTH_EXTENDED == frame) {
+      frame = 0;
+      if (p_connection->rx_length - offset < TCP_FRAME_HEADER_MAX_SIZE) break;
+      header_length = TCP_FRAME_HEADER_MAX_SIZE;
+      frame         = ((size_t) p_header[2] << 24u) | ((size_t) p_header[3] << 16u) | ((size_t) p_header[4] << 8u) |
+              p_header[5];
+    }
+
+    if (frame > p_ctx->attributes.max_frame_size) {
+      error = TRANSPORT_ERROR_BUFFER_TOO_SMALL;
+      goto exit;
+    }
+    if (p_connection->rx_length - offset - header_length < frame) break;
+
+    error = p_ctx->attributes.frame(p_ctx->attributes.user_ctx, p_connection, p_header + header_length, frame);
+    if (error) goto exit;
+
+    offset += header_length + frame;
+    header_length = 0;
+    frame         = 0;
+  }
+
+  if (offset) {
+    memmove(p_connection->rx, p_connection->rx + offset, p_connection->rx_length - offset);
+    p_connection->rx_length -= offset;
+  }
+
+  if (header_length + frame > p_connection->rx_size) {
+    error = tcp_epoll_resize(
+      p_ctx->p_memory, &p_connection->rx, &p_connection->rx_size, p_connection->rx_length, header_length + frame);
+  }
+
+exit:
+  return error;
+}
+
+ockam_error_t tcp_epoll_read(tcp_epoll_ctx_t* p_ctx, ockam_transport_tcp_connection_t* p_connection)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+  ssize_t       bytes = 0;
+  int           reads = 0;
+
+  // Level-triggered: stop after a few reads so one busy peer cannot starve the rest of the loop
+  for (reads = 0; reads < TCP_EPOLL_READS_PER_EVENT; reads++) {
+    bytes = recv(p_connection->socket_fd,
+                 p_connection->rx + p_connection->rx_length,
+                 p_connection->rx_size - p_connection->rx_length,
+                 0);
+    if (0 == bytes) {
+      error = TRANSPORT_ERROR_NOT_CONNECTED;
+      goto exit;
+    }
+    if (bytes < 0) {
+      if (EINTR == errno) continue;
+      if ((EAGAIN != errno) && (EWOULDBLOCK != errno)) error = TRANSPORT_ERROR_RECEIVE;
+      goto exit;
+    }
+
+    p_connection->rx_length += bytes;
+    error = tcp_epoll_deliver(p_ctx, p_connection);
+    if (error) goto exit;
+  }
+
+exit:
+  return error;
+}
+
+ockam_error_t tcp_epoll_flush(ockam_transport_tcp_connection_t* p_connection)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+  ssize_t       sent  = 0;
+  size_t        total = 0;
+
+  pthread_mutex_lock(&p_connection->write_lock);
+
+  while (total < p_connection->tx_length) {
+    sent = send(p_connection->socket_fd, p_connection->tx + total, p_connection->tx_length - total, MSG_NOSIGNAL);
+    if (sent < 0) {
+      if (EINTR == errno) continue;
+      if ((EAGAIN != errno) && (EWOULDBLOCK != errno)) error = TRANSPORT_ERROR_SEND;
+      break;
+    }
+    total += sent;
+  }
+
+  if (total) {
+    memmove(p_connection->tx, p_connection->tx + total, p_connection->tx_length - total);
+    p_connection->tx_length -= total;
+  }
+
+  if (!error && (0 == p_connection->tx_length)) error = tcp_epoll_arm(p_connection, EPOLL_CTL_MOD);
+
+  pthread_mutex_unlock(&p_connection->write_lock);
+  return error;
+}
+
+/*
+ * An outgoing connection became writable or failed: find out which, then send whatever was written meanwhile.
+ */
+ockam_error_t tcp_epoll_connected(ockam_transport_tcp_connection_t* p_connection)
+{
+  ockam_error_t error        = OCKAM_ERROR_NONE;
+  int           socket_error = 0;
+  socklen_t     length       = sizeof(socket_error);
+
+  if ((0 != getsockopt(p_connection->socket_fd, SOL_SOCKET, SO_ERROR, &socket_error, &length)) || socket_error) {
+    error = TRANSPORT_ERROR_CONNECT;
+    goto exit;
+  }
+
+  pthread_mutex_lock(&p_connection->write_lock);
+  p_connection->connecting = 0;
+  pthread_mutex_unlock(&p_connection->write_lock);
+
+  error = tcp_epoll_flush(p_connection);
+
+exit:
+  return error;
+}
+
+void* tcp_epoll_loop_run(void* arg)
+{
+  ockam_error_t                     error        = OCKAM_ERROR_NONE;
+  tcp_epoll_loop_t*                 p_loop       = (tcp_epoll_loop_t*) arg;
+  tcp_epoll_ctx_t*                  p_ctx        = p_loop->p_ctx;
+  ockam_transport_tcp_connection_t* p_connection = NULL;
+  struct epoll_event                events[TCP_EPOLL_EVENTS_PER_WAIT];
+  int                               count = 0;
+  int                               stop  = 0;
+  int                               i     = 0;
+
+  while (!stop) {
+    count = epoll_wait(p_loop->epoll_fd, events, TCP_EPOLL_EVENTS_PER_WAIT, -1);
+    if (count < 0) {
+      if (EINTR == errno) continue;
+      ockam_log_error("epoll_wait failed: %d", errno);
+      break;
+    }
+
+    for (i = 0; i < count; i++) {
+      if (events[i].data.ptr == &p_loop->wake_fd) {
+        stop = tcp_epoll_register_pending(p_loop);
+        continue;
+      }
+      if (events[i].data.ptr == &p_ctx->listen_fd) {
+        tcp_epoll_accept(p_ctx);
+        continue;
+      }
+
+      p_connection = (ockam_transport_tcp_connection_t*) events[i].data.ptr;
+      if (p_connection->closed) continue;
+
+      error = OCKAM_ERROR_NONE;
+      if (p_connection->connecting) {
+        error = tcp_epoll_connected(p_connection);
+      } else if (events[i].events & EPOLLOUT) {
+        error = tcp_epoll_flush(p_connection);
+      }
+      if (!error && (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) {
+        error = tcp_epoll_read(p_ctx, p_connection);
+      }
+      if (error) tcp_epoll_connection_close(p_loop, p_connection);
+    }
+
+    while (p_loop->p_closed) {
+      p_connection     = p_loop->p_closed;
+      p_loop->p_closed = p_connection->p_next;
+      tcp_epoll_connection_free(p_ctx, p_connection);
+    }
+  }
+
+  return NULL;
+}
+
+ockam_error_t tcp_epoll_listen(tcp_epoll_ctx_t* p_ctx)
+{
+  ockam_error_t           error = OCKAM_ERROR_NONE;
+  struct sockaddr_storage listen_sockaddr;
+  struct epoll_event      event   = { 0 };
+  int                     backlog = p_ctx->attributes.backlog ? p_ctx->attributes.backlog : SOMAXCONN;
+  uint8_t*                address = NULL;
+
+  if (strlen((char*) p_ctx->attributes.listen_address.ip_address)) {
+    address = p_ctx->attributes.listen_address.ip_address;
+  }
+
+  error = make_socket_address(address, p_ctx->attributes.listen_address.port, &listen_sockaddr);
+  if (error) goto exit;
+
+  if (make_socket(&listen_sockaddr, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, &p_ctx->listen_fd)) {
+    error = TRANSPORT_ERROR_SERVER_INIT;
+    goto exit;
+  }
+
+  if (setsockopt(p_ctx->listen_fd, SOL_SOCKET, SO_REUSEADDR, &(int) { 1 }, sizeof(int)) < 0) {
+    error = TRANSPORT_ERROR_SERVER_INIT;
+    goto exit;
+  }
+
+  if (0 != bind(p_ctx->listen_fd, (struct sockaddr*) &listen_sockaddr, socket_address_length(&listen_sockaddr))) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
+    goto exit;
+  }
+
+  if (0 != listen(p_ctx->listen_fd, backlog)) {
+    error = TRANSPORT_ERROR_LISTEN;
+    goto exit;
+  }
+
+  event.events   = EPOLLIN;
+  event.data.ptr = &p_ctx->listen_fd;
+  if (0 != epoll_ctl(p_ctx->loops[0].epoll_fd, EPOLL_CTL_ADD, p_ctx->listen_fd, &event)) {
+    error = TRANSPORT_ERROR_SERVER_INIT;
+    goto exit;
+  }
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_error_t ockam_transport_socket_tcp_epoll_init(ockam_transport_t*                             p_transport,
+                                                    ockam_transport_socket_tcp_epoll_attributes_t* p_attributes)
+{
+  ockam_error_t      error  = OCKAM_ERROR_NONE;
+  tcp_epoll_ctx_t*   p_ctx  = NULL;
+  tcp_epoll_loop_t*  p_loop = NULL;
+  struct epoll_event event  = { 0 };
+  uint16_t           i      = 0;
+
+  if ((NULL == p_transport) || (NULL == p_attributes) || (NULL == p_attributes->p_memory) ||
+      (NULL == p_attributes->frame) || (p_attributes->thread_count > OCKAM_TRANSPORT_TCP_EPOLL_MAX_THREADS)) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
+    goto exit;
+  }
+
+  error = ockam_memory_alloc_zeroed(p_attributes->p_memory, (void**) &p_ctx, sizeof(tcp_epoll_ctx_t));
+  if (error) goto exit;
+
+  ockam_memory_copy(p_attributes->p_memory, &p_ctx->attributes, p_attributes, sizeof(*p_attributes));
+  p_ctx->p_memory   = p_attributes->p_memory;
+  p_ctx->listen_fd  = -1;
+  p_ctx->loop_count = p_attributes->thread_count ? p_attributes->thread_count : 1;
+  if (0 == p_ctx->attributes.max_pending_write) p_ctx->attributes.max_pending_write = TCP_EPOLL_DEFAULT_MAX_PENDING;
+  if (p_ctx->attributes.max_pending_write < TCP_EPOLL_MIN_PENDING) {
+    p_ctx->attributes.max_pending_write = TCP_EPOLL_MIN_PENDING;
+  }
+  if (0 == p_ctx->attributes.max_frame_size) p_ctx->attributes.max_frame_size = TCP_EPOLL_DEFAULT_MAX_FRAME;
+  pthread_mutex_init(&p_ctx->lock, NULL);
+
+  p_transport->vtable = &socket_tcp_epoll_vtable;
+  p_transport->ctx    = p_ctx;
+
+  for (i = 0; i < p_ctx->loop_count; i++) {
+    p_loop           = &p_ctx->loops[i];
+    p_loop->p_ctx    = p_ctx;
+    p_loop->wake_fd  = -1;
+    p_loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    pthread_mutex_init(&p_loop->lock, NULL);
+    if (-1 == p_loop->epoll_fd) {
+      error = TRANSPORT_ERROR_SOCKET_CREATE;
+      goto exit;
+    }
+
+    p_loop->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (-1 == p_loop->wake_fd) {
+      error = TRANSPORT_ERROR_SOCKET_CREATE;
+      goto exit;
+    }
+
+    event.events   = EPOLLIN;
+    event.data.ptr = &p_loop->wake_fd;
+    if (0 != epoll_ctl(p_loop->epoll_fd, EPOLL_CTL_ADD, p_loop->wake_fd, &event)) {
+      error = TRANSPORT_ERROR_SOCKET_CREATE;
+      goto exit;
+    }
+  }
+
+  if (p_attributes->listen_address.port) {
+    error = tcp_epoll_listen(p_ctx);
+    if (error) goto exit;
+  }
+
+  for (i = 0; i < p_ctx->loop_count; i++) {
+    if (0 != pthread_create(&p_ctx->loops[i].thread, NULL, tcp_epoll_loop_run, &p_ctx->loops[i])) {
+      error = TRANSPORT_ERROR_SERVER_INIT;
+      goto exit;
+    }
+    p_ctx->loops[i].thread_started = 1;
+  }
+
+exit:
+  if (error) {
+    ockam_log_error("%x", error);
+    if (p_ctx) tcp_epoll_vtable_deinit(p_transport);
+  }
+  return error;
+}
+
+ockam_error_t ockam_transport_socket_tcp_epoll_connect(ockam_transport_t*                 p_transport,
+                                                       ockam_ip_address_t*                remote_address,
+                                                       ockam_transport_tcp_connection_t** pp_connection)
+{
+  ockam_error_t                     error        = OCKAM_ERROR_NONE;
+  tcp_epoll_ctx_t*                  p_ctx        = NULL;
+  ockam_transport_tcp_connection_t* p_connection = NULL;
+  struct sockaddr_storage           remote_sockaddr;
+  int                               socket_fd  = -1;
+  int                               connecting = 0;
+
+  if ((NULL == p_transport) || (NULL == p_transport->ctx) || (NULL == remote_address) || (NULL == pp_connection)) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
+    goto exit;
+  }
+  p_ctx = (tcp_epoll_ctx_t*) p_transport->ctx;
+
+  error = make_socket_address(remote_address->ip_address, remote_address->port, &remote_sockaddr);
+  if (error) goto exit;
+
+  error = make_socket(&remote_sockaddr, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, &socket_fd);
+  if (error) goto exit;
+
+  // The loop learns the outcome from EPOLLOUT, only failures known right away are returned here
+  if (0 != connect(socket_fd, (struct sockaddr*) &remote_sockaddr, socket_address_length(&remote_sockaddr))) {
+    if (EINPROGRESS != errno) {
+      error = TRANSPORT_ERROR_CONNECT;
+      goto exit;
+    }
+    connecting = 1;
+  }
+
+  error = tcp_epoll_connection_alloc(p_ctx, socket_fd, &p_connection);
+  if (error) goto exit;
+
+  p_connection->connecting = connecting;
+
+  ockam_memory_copy(p_ctx->p_memory, &p_connection->remote_address, remote_address, sizeof(*remote_address));
+
+  tcp_epoll_hand_off(p_ctx, p_connection);
+  *pp_connection = p_connection;
+
+exit:
+  if (error) {
+    ockam_log_error("%x", error);
+    if (-1 != socket_fd) close(socket_fd);
+  }
+  return error;
+}
+
+ockam_error_t
+ockam_transport_tcp_connection_write(ockam_transport_tcp_connection_t* p_connection, uint8_t* buffer, size_t length)
+{
+  ockam_error_t    error   = OCKAM_ERROR_NONE;
+  tcp_epoll_ctx_t* p_ctx   = NULL;
+  uint8_t          header[TCP_FRAME_HEADER_MAX_SIZE];
+  size_t           header_length = 0;
+  struct iovec     iov[2];
+  struct msghdr    message = { 0 };
+  ssize_t          sent    = 0;
+  size_t           total   = 0;
+  size_t           needed  = 0;
+  int              queued  = 0;
+  int              locked  = 0;
+
+  if ((NULL == p_connection) || ((NULL == buffer) && length) || (length > UINT32_MAX)) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
+    goto exit;
+  }
+  p_ctx = p_connection->p_loop->p_ctx;
+
+  header_length = tcp_frame_encode_header(length, header);
+  total         = header_length + length;
+
+  pthread_mutex_lock(&p_connection->write_lock);
+  locked = 1;
+
+  if (p_connection->closed) {
+    error = TRANSPORT_ERROR_NOT_CONNECTED;
+    goto exit;
+  }
+
+  // Checked before anything is sent: once part of the frame is on the wire, the rest has to be queued
+  if (p_connection->tx_length + total > p_ctx->attributes.max_pending_write) {
+    error = TRANSPORT_ERROR_WOULD_BLOCK;
+    goto exit;
+  }
+
+  // Try the socket directly when it is connected and nothing is queued ahead of this frame
+  if (!p_connection->connecting && (0 == p_connection->tx_length)) {
+    iov[0].iov_base    = header;
+    iov[0].iov_len     = header_length;
+    iov[1].iov_base    = buffer;
+    iov[1].iov_len     = length;
+    message.msg_iov    = iov;
+    message.msg_iovlen = 2;
+
+    do {
+      sent = sendmsg(p_connection->socket_fd, &message, MSG_NOSIGNAL);
+    } while ((sent < 0) && (EINTR == errno));
+
+    if (sent < 0) {
+      if ((EAGAIN != errno) && (EWOULDBLOCK != errno)) {
+        error = TRANSPORT_ERROR_SEND;
+        goto exit;
+      }
+      sent = 0;
+    }
+    if ((size_t) sent == total) goto exit;
+  }
+
+  queued = (0 != p_connection->tx_length);
+  needed = p_connection->tx_length + total - (size_t) sent;
+  if (needed > p_connection->tx_size) {
+    size_t size = p_connection->tx_size ? p_connection->tx_size : TCP_EPOLL_TX_INITIAL_SIZE;
+    while (size < needed) size <<= 1u;
+    error = tcp_epoll_resize(p_ctx->p_memory, &p_connection->tx, &p_connection->tx_size, p_connection->tx_length, size);
+    if (error) goto exit;
+  }
+
+  if ((size_t) sent < header_length) {
+    memcpy(p_connection->tx + p_connection->tx_length, header + sent, header_length - sent);
+    p_connection->tx_length += header_length - sent;
+    sent = 0;
+  } else {
+    sent -= header_length;
+  }
+  memcpy(p_connection->tx + p_connection->tx_length, buffer + sent, length - sent);
+  p_connection->tx_length += length - sent;
+
+  // First queued bytes: ask the loop to tell us when the socket drains, a connecting socket is already watched
+  if (!queued && !p_connection->connecting && p_connection->registered) {
+    error = tcp_epoll_arm(p_connection, EPOLL_CTL_MOD);
+  }
+
+exit:
+  if (locked) pthread_mutex_unlock(&p_connection->write_lock);
+  if (error && (TRANSPORT_ERROR_WOULD_BLOCK != error)) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_writer_t* ockam_transport_tcp_connection_writer(ockam_transport_tcp_connection_t* p_connection)
+{
+  return p_connection ? &p_connection->writer : NULL;
+}
+
+ockam_error_t ockam_transport_tcp_connection_close(ockam_transport_tcp_connection_t* p_connection)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if (NULL == p_connection) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
+    goto exit;
+  }
+
+  // The owning loop sees the hang-up and closes the connection on its own thread
+  pthread_mutex_lock(&p_connection->write_lock);
+  if (!p_connection->closed) shutdown(p_connection->socket_fd, SHUT_RDWR);
+  pthread_mutex_unlock(&p_connection->write_lock);
+
+exit:
+  return error;
+}
+
+void ockam_transport_tcp_connection_set_context(ockam_transport_tcp_connection_t* p_connection, void* context)
+{
+  p_connection->context = context;
+}
+
+void* ockam_transport_tcp_connection_get_context(ockam_transport_tcp_connection_t* p_connection)
+{
+  return p_connection->context;
+}
+
+ockam_error_t tcp_epoll_vtable_connect(void*               ctx,
+                                       ockam_reader_t**    pp_reader,
+                                       ockam_writer_t**    pp_writer,
+                                       ockam_ip_address_t* remote_address,
+                                       int16_t             retry_count,
+                                       uint16_t            retry_interval)
+{
+  ockam_error_t                     error        = OCKAM_ERROR_NONE;
+  ockam_transport_t                 transport    = { &socket_tcp_epoll_vtable, ctx };
+  ockam_transport_tcp_connection_t* p_connection = NULL;
+
+  // Frames arrive through the frame callback, there is no blocking reader
+  if (NULL != pp_reader) {
+    error = TRANSPORT_ERROR_INVALID_OP;
+    goto exit;
+  }
+
+  // The connect completes on the loop thread, so there is nothing to retry here: a failure closes the connection
+  error = ockam_transport_socket_tcp_epoll_connect(&transport, remote_address, &p_connection);
+  if (error) goto exit;
+
+  if (pp_writer) *pp_writer = &p_connection->writer;
+
+exit:
+  return error;
+}
+
+ockam_error_t tcp_epoll_vtable_accept(void*               ctx,
+                                      ockam_reader_t**    pp_reader,
+                                      ockam_writer_t**    pp_writer,
+                                      ockam_ip_address_t* remote_address)
+{
+  // Incoming connections are delivered through the accept callback
+  return TRANSPORT_ERROR_INVALID_OP;
+}
+
+ockam_error_t tcp_epoll_vtable_deinit(ockam_transport_t* p_transport)
+{
+  tcp_epoll_ctx_t*                  p_ctx        = (tcp_epoll_ctx_t*) p_transport->ctx;
+  tcp_epoll_loop_t*                 p_loop       = NULL;
+  ockam_transport_tcp_connection_t* p_connection = NULL;
+  uint16_t                          i            = 0;
+
+  if (NULL == p_ctx) return TRANSPORT_ERROR_BAD_PARAMETER;
+
+  for (i = 0; i < p_ctx->loop_count; i++) {
+    p_loop = &p_ctx->loops[i];
+    if ((NULL == p_loop->p_ctx) || (-1 == p_loop->wake_fd)) continue;
+    pthread_mutex_lock(&p_loop->lock);
+    p_loop->stop = 1;
+    pthread_mutex_unlock(&p_loop->lock);
+    eventfd_write(p_loop->wake_fd, 1);
+  }
+  for (i = 0; i < p_ctx->loop_count; i++) {
+    if (p_ctx->loops[i].thread_started) pthread_join(p_ctx->loops[i].thread, NULL);
+  }
+
+  // The loops have stopped, so remaining connections are closed on this thread
+  for (i = 0; i < p_ctx->loop_count; i++) {
+    p_loop = &p_ctx->loops[i];
+    if (NULL == p_loop->p_ctx) continue;
+
+    while (p_loop->p_pending) {
+      p_connection      = p_loop->p_pending;
+      p_loop->p_pending = p_connection->p_next;
+      close(p_connection->socket_fd);
+      tcp_epoll_connection_free(p_ctx, p_connection);
+    }
+    while (p_loop->p_connections) tcp_epoll_connection_close(p_loop, p_loop->p_connections);
+    while (p_loop->p_closed) {
+      p_connection     = p_loop->p_closed;
+      p_loop->p_closed = p_connection->p_next;
+      tcp_epoll_connection_free(p_ctx, p_connection);
+    }
+
+    if (-1 != p_loop->wake_fd) close(p_loop->wake_fd);
+    if (-1 != p_loop->epoll_fd) close(p_loop->epoll_fd);
+    pthread_mutex_destroy(&p_loop->lock);
+  }
+
+  if (-1 != p_ctx->listen_fd) close(p_ctx->listen_fd);
+  pthread_mutex_destroy(&p_ctx->lock);
+
+  ockam_memory_free(p_ctx->p_memory, p_ctx, sizeof(tcp_epoll_ctx_t));
+  p_transport->ctx = NULL;
+
+  return OCKAM_ERROR_NONE;
+}
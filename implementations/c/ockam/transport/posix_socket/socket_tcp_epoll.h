@@ -0,0 +1,117 @@
+#ifndef socket_tcp_epoll_h
+#define socket_tcp_epoll_h
+
+#include <stdint.h>
+#include "ockam/io.h"
+#include "ockam/memory.h"
+#include "ockam/transport.h"
+
+/**
+ * Event-driven TCP transport for Linux.
+ *
+ * The transport runs a small, fixed number of event loop threads, each owning an epoll instance. Every connection
+ * belongs to exactly one loop, and all of its callbacks run on that loop's thread. Incoming connections are spread
+ * across the loops round-robin. Frames use the same 2-byte length prefix as the blocking TCP transport, so either end
+ * of a connection may use either transport. Frames of 64KiB and more use the extended 32-bit length; a peer sending a
+ * frame larger than max_frame_size is disconnected.
+ *
+ * Writes never block: bytes the kernel does not take immediately are buffered on the connection and flushed when the
+ * socket becomes writable. A write that, with the connection's pending output, could exceed max_pending_write fails
+ * with TRANSPORT_ERROR_WOULD_BLOCK before any of it is sent, so a frame larger than max_pending_write always does.
+ */
+
+#define OCKAM_TRANSPORT_TCP_EPOLL_MAX_THREADS 64
+
+typedef struct ockam_transport_tcp_connection ockam_transport_tcp_connection_t;
+
+/**
+ * @brief   Called on the owning loop thread when a new incoming connection is accepted.
+ * @param   user_ctx        [in] - user_ctx from the transport attributes.
+ * @param   connection      [in] - The new connection.
+ * @param   remote_address  [in] - Address of the peer.
+ * @return  OCKAM_ERROR_NONE to keep the connection, any other value closes it.
+ */
+typedef ockam_error_t (*ockam_transport_tcp_accept_cb)(void*                             user_ctx,
+                                                       ockam_transport_tcp_connection_t* connection,
+                                                       ockam_ip_address_t*               remote_address);
+
+/**
+ * @brief   Called on the owning loop thread for every complete frame received on a connection.
+ * @param   user_ctx    [in] - user_ctx from the transport attributes.
+ * @param   connection  [in] - Connection the frame arrived on.
+ * @param   frame       [in] - Frame payload, valid only for the duration of the call.
+ * @param   length      [in] - Length of the frame payload.
+ * @return  OCKAM_ERROR_NONE to keep the connection, any other value closes it.
+ */
+typedef ockam_error_t (*ockam_transport_tcp_frame_cb)(void*                             user_ctx,
+                                                      ockam_transport_tcp_connection_t* connection,
+                                                      uint8_t*                          frame,
+                                                      size_t                            length);
+
+/**
+ * @brief   Called once a connection is closed, just before it is freed.
+ *
+ * Runs on the owning loop thread, or on the thread calling ockam_transport_deinit for connections still open then.
+ * @param   user_ctx    [in] - user_ctx from the transport attributes.
+ * @param   connection  [in] - Connection being closed.
+ */
+typedef void (*ockam_transport_tcp_close_cb)(void* user_ctx, ockam_transport_tcp_connection_t* connection);
+
+typedef struct ockam_transport_socket_tcp_epoll_attributes {
+  ockam_ip_address_t            listen_address;    /*!< Address to listen on, port 0 disables listening */
+  ockam_memory_t*               p_memory;          /*!< Allocator for transport and connection state */
+  uint16_t                      thread_count;      /*!< Number of event loop threads, 0 means 1 */
+  int                           backlog;           /*!< listen() backlog, 0 means SOMAXCONN */
+  size_t                        max_pending_write; /*!< Per-connection output limit in bytes, 0 means 256KiB */
+  size_t                        max_frame_size;    /*!< Largest frame accepted from a peer, 0 means 1MiB */
+  ockam_transport_tcp_accept_cb accept;            /*!< Optional */
+  ockam_transport_tcp_frame_cb  frame;             /*!< Required */
+  ockam_transport_tcp_close_cb  close;             /*!< Optional */
+  void*                         user_ctx;
+} ockam_transport_socket_tcp_epoll_attributes_t;
+
+/**
+ * @brief   Create the event loops and, if a listen port is given, start accepting connections.
+ *
+ * The transport's connect() returns only a writer; received frames are delivered through the frame callback, so
+ * pp_reader must be NULL. It does not wait for the connection, so retry_count and retry_interval are ignored. accept()
+ * is not supported, incoming connections arrive through the accept callback.
+ */
+ockam_error_t ockam_transport_socket_tcp_epoll_init(ockam_transport_t*                             p_transport,
+                                                    ockam_transport_socket_tcp_epoll_attributes_t* p_attributes);
+
+/**
+ * @brief   Connect to a remote peer and hand the connection to one of the event loops.
+ *
+ * Does not block: the connect completes on the loop thread. Frames written before then are queued and sent once the
+ * connection is up. If the peer cannot be reached, the connection is closed and the close callback runs.
+ * @param   p_transport     [in]  - Transport initialized with ockam_transport_socket_tcp_epoll_init.
+ * @param   remote_address  [in]  - Address to connect to.
+ * @param   pp_connection   [out] - The new connection.
+ */
+ockam_error_t ockam_transport_socket_tcp_epoll_connect(ockam_transport_t*                 p_transport,
+                                                       ockam_ip_address_t*                remote_address,
+                                                       ockam_transport_tcp_connection_t** pp_connection);
+
+/**
+ * @brief   Queue a frame on a connection without blocking.
+ *
+ * Safe to call from any thread until the connection's close callback has run.
+ */
+ockam_error_t
+ockam_transport_tcp_connection_write(ockam_transport_tcp_connection_t* connection, uint8_t* buffer, size_t length);
+
+/**
+ * @brief   Writer for the connection that calls ockam_transport_tcp_connection_write.
+ */
+ockam_writer_t* ockam_transport_tcp_connection_writer(ockam_transport_tcp_connection_t* connection);
+
+/**
+ * @brief   Ask the owning loop to close the connection once pending callbacks return.
+ */
+ockam_error_t ockam_transport_tcp_connection_close(ockam_transport_tcp_connection_t* connection);
+
+void  ockam_transport_tcp_connection_set_context(ockam_transport_tcp_connection_t* connection, void* context);
+void* ockam_transport_tcp_connection_get_context(ockam_transport_tcp_connection_t* connection);
+
+#endif
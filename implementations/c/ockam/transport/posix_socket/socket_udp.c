@@ -1,8 +1,14 @@
+#define _GNU_SOURCE
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
 #include <unistd.h>
+#include <sys/uio.h>
+#if defined(__linux__)
+#include <netinet/udp.h>
+#endif
 
 #include "ockam/log.h"
 #include "ockam/io.h"
@@ -13,6 +19,19 @@
 #include "ockam/memory.h"
 #include "socket_udp.h"
 
+#if defined(__linux__)
+#define UDP_BATCH_MMSG
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#endif
+
+#define UDP_DATAGRAM_MAX     65507u /* Largest IPv4 UDP payload, also the most one GSO send may carry */
+#define UDP_GSO_SEGMENTS_MAX 64u    /* Kernel limit on datagrams per GSO send */
+
 extern ockam_memory_t* gp_ockam_transport_memory;
 ockam_error_t          socket_udp_connect(void*               ctx,
                                           ockam_reader_t**    pp_reader,
@@ -30,6 +49,8 @@ ockam_transport_vtable_t socket_udp_vtable = { socket_udp_connect, socket_udp_ac
 
 ockam_error_t socket_udp_read(void*, uint8_t*, size_t, size_t*);
 ockam_error_t socket_udp_write(void*, uint8_t*, size_t);
+ockam_error_t socket_udp_writev(void*, const ockam_iovec_t*, size_t);
+ockam_error_t socket_udp_read_gro(socket_udp_ctx_t*, ockam_transport_udp_message_t*, size_t, size_t*);
 
 ockam_error_t ockam_transport_socket_udp_init(ockam_transport_t*                   p_transport,
                                               ockam_transport_socket_attributes_t* p_cfg)
@@ -58,11 +79,17 @@ ockam_error_t ockam_transport_socket_udp_init(ockam_transport_t*
   p_socket = &p_ctx->posix_socket;
 
   int* p_socket_fd = &p_socket->socket_fd;
-  *p_socket_fd = socket(AF_INET, SOCK_DGRAM, 0);
-  if (-1 == *p_socket_fd) {
-    error = TRANSPORT_ERROR_SOCKET_CREATE;
-    goto exit;
-  }
+  *p_socket_fd     = -1;
+
+  ockam_memory_copy(
+    gp_ockam_transport_memory, &p_socket->local_address, &p_cfg->listen_address, sizeof(p_socket->local_address));
+
+  error =
+    make_socket_address(p_socket->local_address.ip_address, p_socket->local_address.port, &p_socket->local_sockaddr);
+  if (error) goto exit;
+
+  error = make_socket(&p_socket->local_sockaddr, SOCK_DGRAM, p_socket_fd);
+  if (error) goto exit;
   if (setsockopt(*p_socket_fd, SOL_SOCKET, SO_KEEPALIVE, &(int) { 1 }, sizeof(int)) < 0) {
     error = TRANSPORT_ERROR_CONNECT;
     goto exit;
@@ -76,21 +103,34 @@ ockam_error_t ockam_transport_socket_udp_init(ockam_transport_t*
     goto exit;
   }
 
-  ockam_memory_copy(
-    gp_ockam_transport_memory, &p_socket->local_address, &p_cfg->listen_address, sizeof(p_socket->local_address));
-
-  make_socket_address(p_socket->local_address.ip_address, p_socket->local_address.port, &p_socket->local_sockaddr);
-  if (0 != bind(*p_socket_fd, (struct sockaddr*) &p_socket->local_sockaddr, sizeof(struct sockaddr_in))) {
+  if (0 != bind(*p_socket_fd,
+                (struct sockaddr*) &p_socket->local_sockaddr,
+                socket_address_length(&p_socket->local_sockaddr))) {
     error = TRANSPORT_ERROR_SERVER_INIT;
     goto exit;
   }
 
+#if defined(UDP_BATCH_MMSG)
+  /*
+   * Both offloads are best effort: kernels without them leave the socket on plain batched reads and writes
+   */
+  if (p_cfg->udp_gso) {
+    p_ctx->gso = (0 == setsockopt(*p_socket_fd, SOL_UDP, UDP_SEGMENT, &(int) { 0 }, sizeof(int)));
+  }
+  if (p_cfg->udp_gro && (0 == setsockopt(*p_socket_fd, SOL_UDP, UDP_GRO, &(int) { 1 }, sizeof(int)))) {
+    error = ockam_memory_alloc_zeroed(gp_ockam_transport_memory, (void**) &p_ctx->gro_buffer, UINT16_MAX);
+    if (error) goto exit;
+    p_ctx->gro = 1;
+  }
+#endif
+
   p_transport->ctx = p_ctx;
 
 exit:
   if (error) {
     ockam_log_error("%x", error);
-    if (p_ctx) ockam_memory_free(gp_ockam_transport_memory, p_ctx, 0);
+    if (p_ctx && (-1 != p_ctx->posix_socket.socket_fd)) close(p_ctx->posix_socket.socket_fd);
+    if (p_ctx) ockam_memory_free(gp_ockam_transport_memory, p_ctx, sizeof(socket_udp_ctx_t));
   }
   return error;
 }
@@ -116,11 +156,15 @@ ockam_error_t socket_udp_connect(void*               ctx,
 
   error = make_socket_reader_writer(p_socket, socket_udp_read, socket_udp_write, pp_reader, pp_writer);
   if (error) goto exit;
+  if (p_socket->p_writer) p_socket->p_writer->writev = socket_udp_writev;
 
   ockam_memory_copy(gp_ockam_transport_memory, &p_socket->remote_address, remote_address, sizeof(*remote_address));
 
-  error = make_socket_address(
-    remote_address->ip_address, remote_address->port, (struct sockaddr_in*) &p_socket->remote_sockaddr);
+  error = make_socket_address(remote_address->ip_address, remote_address->port, &p_socket->remote_sockaddr);
+  if (error) goto exit;
+
+  // A dual-stack socket reaches IPv4 peers through their IPv4-mapped address
+  error = socket_address_for_family(&p_socket->remote_sockaddr, p_socket->local_sockaddr.ss_family);
   if (error) goto exit;
 
 exit:
@@ -144,6 +188,7 @@ socket_udp_accept(void* ctx, ockam_reader_t** pp_reader, ockam_writer_t** pp_wri
 
   error = make_socket_reader_writer(p_socket, socket_udp_read, socket_udp_write, pp_reader, pp_writer);
   if (error) goto exit;
+  if (p_socket->p_writer) p_socket->p_writer->writev = socket_udp_writev;
 
 exit:
   if (error) ockam_log_error("%x", error);
@@ -161,6 +206,20 @@ ockam_error_t socket_udp_read(void* ctx, uint8_t* buffer, size_t buffer_size, si
     goto exit;
   }
 
+  if (p_udp_ctx->gro) {
+    ockam_transport_udp_message_t message = { .buffer = buffer, .size = buffer_size };
+    size_t                        count   = 0;
+
+    error = socket_udp_read_gro(p_udp_ctx, &message, 1, &count);
+    if (error) goto exit;
+    if (message.error) {
+      error = message.error;
+      goto exit;
+    }
+    *buffer_length = message.length;
+    goto exit;
+  }
+
   socklen_t socklen    = sizeof(p_socket->remote_sockaddr);
   ssize_t   bytes_read = recvfrom(p_socket->socket_fd,
                                   buffer,
@@ -196,7 +255,7 @@ ockam_error_t socket_udp_write(void* ctx, uint8_t* buffer, size_t buffer_length)
                               buffer_length,
                               0,
                               (struct sockaddr*) &p_socket->remote_sockaddr,
-                              sizeof(p_udp_ctx->posix_socket.remote_sockaddr));
+                              socket_address_length(&p_socket->remote_sockaddr));
   if (bytes_sent < 0 || bytes_sent != buffer_length) {
     error = TRANSPORT_ERROR_SEND;
     goto exit;
@@ -207,6 +266,389 @@ exit:
   return error;
 }
 
+/*
+ * Gather the iovecs into one datagram, so callers can add a header without copying the payload
+ */
+ockam_error_t socket_udp_writev(void* ctx, const ockam_iovec_t* iov, size_t iov_count)
+{
+  ockam_error_t     error     = OCKAM_ERROR_NONE;
+  socket_udp_ctx_t* p_udp_ctx = (socket_udp_ctx_t*) ctx;
+  posix_socket_t*   p_socket  = &p_udp_ctx->posix_socket;
+  struct iovec      socket_iov[SOCKET_WRITEV_MAX];
+  struct msghdr     message = { 0 };
+  size_t            length  = 0;
+  size_t            i       = 0;
+  ssize_t           bytes_sent;
+
+  if (iov_count > SOCKET_WRITEV_MAX) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
+    goto exit;
+  }
+
+  for (i = 0; i < iov_count; i++) {
+    socket_iov[i].iov_base = iov[i].base;
+    socket_iov[i].iov_len  = iov[i].length;
+    length += iov[i].length;
+  }
+  if (length > (SIZE_MAX >> 1u)) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
+    goto exit;
+  }
+
+  message.msg_name    = &p_socket->remote_sockaddr;
+  message.msg_namelen = socket_address_length(&p_socket->remote_sockaddr);
+  message.msg_iov     = socket_iov;
+  message.msg_iovlen  = iov_count;
+
+  do {
+    bytes_sent = sendmsg(p_socket->socket_fd, &message, 0);
+  } while ((bytes_sent < 0) && (EINTR == errno));
+  if (bytes_sent < 0 || (size_t) bytes_sent != length) {
+    error = TRANSPORT_ERROR_SEND;
+    goto exit;
+  }
+
+exit:
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+/*
+ * Hand out the datagrams of coalesced receives. A receive the messages cannot take in full is kept for the next call.
+ */
+ockam_error_t socket_udp_read_gro(socket_udp_ctx_t*              p_udp_ctx,
+                                  ockam_transport_udp_message_t* messages,
+                                  size_t                         count,
+                                  size_t*                        p_received)
+{
+  ockam_error_t   error    = OCKAM_ERROR_NONE;
+  posix_socket_t* p_socket = &p_udp_ctx->posix_socket;
+  size_t          received = 0;
+  size_t          length   = 0;
+
+#if defined(UDP_BATCH_MMSG)
+  union {
+    char           buffer[CMSG_SPACE(sizeof(int))];
+    struct cmsghdr align;
+  } control;
+  struct iovec    iov     = { p_udp_ctx->gro_buffer, UINT16_MAX };
+  struct msghdr   message = { 0 };
+  struct cmsghdr* p_cmsg  = NULL;
+  ssize_t         bytes_read;
+
+  while (received < count) {
+    if (p_udp_ctx->gro_offset >= p_udp_ctx->gro_length) {
+      message.msg_name       = &p_udp_ctx->gro_address;
+      message.msg_namelen    = sizeof(p_udp_ctx->gro_address);
+      message.msg_iov        = &iov;
+      message.msg_iovlen     = 1;
+      message.msg_control    = control.buffer;
+      message.msg_controllen = sizeof(control.buffer);
+
+      bytes_read = recvmsg(p_socket->socket_fd, &message, received ? MSG_DONTWAIT : 0);
+      if (bytes_read < 0) {
+        if (EINTR == errno) continue;
+        if (received && ((EAGAIN == errno) || (EWOULDBLOCK == errno))) break;
+        error = TRANSPORT_ERROR_RECEIVE;
+        goto exit;
+      }
+
+      p_udp_ctx->gro_length  = bytes_read;
+      p_udp_ctx->gro_offset  = 0;
+      p_udp_ctx->gro_segment = bytes_read;
+      for (p_cmsg = CMSG_FIRSTHDR(&message); p_cmsg; p_cmsg = CMSG_NXTHDR(&message, p_cmsg)) {
+        if ((SOL_UDP == p_cmsg->cmsg_level) && (UDP_GRO == p_cmsg->cmsg_type)) {
+          int segment = 0;
+          memcpy(&segment, CMSG_DATA(p_cmsg), sizeof(segment));
+          if (segment > 0) p_udp_ctx->gro_segment = segment;
+        }
+      }
+      ockam_memory_copy(gp_ockam_transport_memory,
+                        &p_socket->remote_sockaddr,
+                        &p_udp_ctx->gro_address,
+                        sizeof(p_socket->remote_sockaddr));
+    }
+
+    length = p_udp_ctx->gro_length - p_udp_ctx->gro_offset;
+    if (length > p_udp_ctx->gro_segment) length = p_udp_ctx->gro_segment;
+
+    messages[received].error  = OCKAM_ERROR_NONE;
+    messages[received].length = length;
+    if (length > messages[received].size) {
+      messages[received].error  = TRANSPORT_ERROR_BUFFER_TOO_SMALL;
+      messages[received].length = messages[received].size;
+    }
+    ockam_memory_copy(gp_ockam_transport_memory,
+                      messages[received].buffer,
+                      p_udp_ctx->gro_buffer + p_udp_ctx->gro_offset,
+                      messages[received].length);
+    ockam_memory_copy(gp_ockam_transport_memory,
+                      &messages[received].address,
+                      &p_udp_ctx->gro_address,
+                      sizeof(messages[received].address));
+    received++;
+
+    /* An empty datagram still counts as one */
+    p_udp_ctx->gro_offset += length ? length : 1;
+  }
+#else
+  (void) p_socket;
+  (void) length;
+  (void) messages;
+  (void) count;
+  error = TRANSPORT_ERROR_INVALID_OP;
+  goto exit;
+#endif
+
+exit:
+  *p_received = received;
+  return error;
+}
+
+ockam_error_t ockam_transport_socket_udp_read_batch(ockam_reader_t*                p_reader,
+                                                    ockam_transport_udp_message_t* messages,
+                                                    size_t                         count,
+                                                    size_t*                        p_received)
+{
+  ockam_error_t     error     = OCKAM_ERROR_NONE;
+  socket_udp_ctx_t* p_udp_ctx = NULL;
+  posix_socket_t*   p_socket  = NULL;
+  size_t            received  = 0;
+  size_t            i         = 0;
+
+  if ((NULL == p_reader) || (socket_udp_read != p_reader->read) || (NULL == messages) || (NULL == p_received)) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
+    goto exit;
+  }
+  p_udp_ctx = (socket_udp_ctx_t*) p_reader->ctx;
+  p_socket  = &p_udp_ctx->posix_socket;
+
+  if (-1 == p_socket->socket_fd) {
+    error = TRANSPORT_ERROR_SOCKET;
+    goto exit;
+  }
+  if (count > OCKAM_TRANSPORT_UDP_BATCH_MAX) count = OCKAM_TRANSPORT_UDP_BATCH_MAX;
+
+  if (p_udp_ctx->gro) {
+    error = socket_udp_read_gro(p_udp_ctx, messages, count, &received);
+    goto exit;
+  }
+
+#if defined(UDP_BATCH_MMSG)
+  struct mmsghdr headers[OCKAM_TRANSPORT_UDP_BATCH_MAX];
+  struct iovec   iov[OCKAM_TRANSPORT_UDP_BATCH_MAX];
+  int            result;
+
+  ockam_memory_set(gp_ockam_transport_memory, headers, 0, count * sizeof(struct mmsghdr));
+  for (i = 0; i < count; i++) {
+    iov[i].iov_base                = messages[i].buffer;
+    iov[i].iov_len                 = messages[i].size;
+    headers[i].msg_hdr.msg_name    = &messages[i].address;
+    headers[i].msg_hdr.msg_namelen = sizeof(messages[i].address);
+    headers[i].msg_hdr.msg_iov     = &iov[i];
+    headers[i].msg_hdr.msg_iovlen  = 1;
+  }
+
+  /* MSG_WAITFORONE: block for the first datagram, then take only what is already queued */
+  do {
+    result = recvmmsg(p_socket->socket_fd, headers, count, MSG_WAITFORONE, NULL);
+  } while ((result < 0) && (EINTR == errno));
+  if (result <= 0) {
+    error = TRANSPORT_ERROR_RECEIVE;
+    goto exit;
+  }
+  received = result;
+
+  for (i = 0; i < received; i++) {
+    messages[i].length = headers[i].msg_len;
+    messages[i].error  = (headers[i].msg_hdr.msg_flags & MSG_TRUNC) ? TRANSPORT_ERROR_BUFFER_TOO_SMALL : 0;
+  }
+#else
+  for (i = 0; i < count; i++) {
+    struct iovec  iov     = { messages[i].buffer, messages[i].size };
+    struct msghdr message = { &messages[i].address, sizeof(messages[i].address), &iov, 1 };
+    ssize_t       bytes_read;
+
+    do {
+      bytes_read = recvmsg(p_socket->socket_fd, &message, i ? MSG_DONTWAIT : 0);
+    } while ((bytes_read < 0) && (EINTR == errno));
+    if (bytes_read < 0) {
+      if (i) break;
+      error = TRANSPORT_ERROR_RECEIVE;
+      goto exit;
+    }
+    messages[i].length = bytes_read;
+    messages[i].error  = (message.msg_flags & MSG_TRUNC) ? TRANSPORT_ERROR_BUFFER_TOO_SMALL : 0;
+  }
+  received = i;
+#endif
+
+  /* Like a single read, a following plain write answers the last sender */
+  ockam_memory_copy(gp_ockam_transport_memory,
+                    &p_socket->remote_sockaddr,
+                    &messages[received - 1].address,
+                    sizeof(p_socket->remote_sockaddr));
+
+exit:
+  if (p_received) *p_received = received;
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
+#if defined(UDP_BATCH_MMSG)
+/*
+ * Number of messages from the first on that one GSO send can carry: same destination, all as long as the first except
+ * a shorter last one, within the kernel's segment and size limits.
+ */
+static size_t socket_udp_gso_run(ockam_transport_udp_message_t* messages, size_t count)
+{
+  size_t segment = messages[0].length;
+  size_t total   = segment;
+  size_t run     = 1;
+
+  if (0 == segment) return 1;
+
+  while ((run < count) && (run < UDP_GSO_SEGMENTS_MAX)) {
+    if (messages[run].length > segment || 0 == messages[run].length) break;
+    if (total + messages[run].length > UDP_DATAGRAM_MAX) break;
+    if (memcmp(&messages[run].address, &messages[0].address, socket_address_length(&messages[0].address))) break;
+    total += messages[run].length;
+    run++;
+    if (messages[run - 1].length < segment) break;
+  }
+
+  return run;
+}
+#endif
+
+ockam_error_t ockam_transport_socket_udp_write_batch(ockam_writer_t*                p_writer,
+                                                     ockam_transport_udp_message_t* messages,
+                                                     size_t                         count,
+                                                     size_t*                        p_sent)
+{
+  ockam_error_t     error     = OCKAM_ERROR_NONE;
+  socket_udp_ctx_t* p_udp_ctx = NULL;
+  posix_socket_t*   p_socket  = NULL;
+  size_t            sent      = 0;
+  size_t            i         = 0;
+
+  if ((NULL == p_writer) || (socket_udp_write != p_writer->write) || (NULL == messages && count)) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
+    goto exit;
+  }
+  p_udp_ctx = (socket_udp_ctx_t*) p_writer->ctx;
+  p_socket  = &p_udp_ctx->posix_socket;
+
+  for (i = 0; i < count; i++) {
+    if (messages[i].length > UDP_DATAGRAM_MAX) {
+      error = TRANSPORT_ERROR_BAD_PARAMETER;
+      goto exit;
+    }
+  }
+
+#if defined(UDP_BATCH_MMSG)
+  union {
+    char           buffer[CMSG_SPACE(sizeof(uint16_t))];
+    struct cmsghdr align;
+  } control[OCKAM_TRANSPORT_UDP_BATCH_MAX];
+  struct mmsghdr          headers[OCKAM_TRANSPORT_UDP_BATCH_MAX];
+  struct sockaddr_storage addresses[OCKAM_TRANSPORT_UDP_BATCH_MAX];
+  size_t                  runs[OCKAM_TRANSPORT_UDP_BATCH_MAX];
+  struct iovec            iov[OCKAM_TRANSPORT_UDP_BATCH_MAX];
+  struct cmsghdr*         p_cmsg = NULL;
+  size_t                  header_count;
+  size_t                  iov_count;
+  size_t                  next;
+  int                     result;
+
+  while (sent < count) {
+    ockam_memory_set(gp_ockam_transport_memory, headers, 0, sizeof(headers));
+    header_count = 0;
+    iov_count    = 0;
+
+    for (next = sent; (next < count) && (iov_count < OCKAM_TRANSPORT_UDP_BATCH_MAX); next += runs[header_count++]) {
+      struct msghdr* p_header = &headers[header_count].msg_hdr;
+
+      runs[header_count] = p_udp_ctx->gso ? socket_udp_gso_run(&messages[next], count - next) : 1;
+      if (runs[header_count] > OCKAM_TRANSPORT_UDP_BATCH_MAX - iov_count) {
+        runs[header_count] = OCKAM_TRANSPORT_UDP_BATCH_MAX - iov_count;
+      }
+
+      /* Destinations are given in either family, the socket only takes its own, dual-stack ones IPv4-mapped */
+      addresses[header_count] = messages[next].address.ss_family ? messages[next].address : p_socket->remote_sockaddr;
+      error = socket_address_for_family(&addresses[header_count], p_socket->local_sockaddr.ss_family);
+      if (error) goto exit;
+
+      p_header->msg_name    = &addresses[header_count];
+      p_header->msg_namelen = socket_address_length(&addresses[header_count]);
+      p_header->msg_iov     = &iov[iov_count];
+      p_header->msg_iovlen  = runs[header_count];
+      for (i = 0; i < runs[header_count]; i++) {
+        iov[iov_count].iov_base = messages[next + i].buffer;
+        iov[iov_count].iov_len  = messages[next + i].length;
+        iov_count++;
+      }
+
+      if (runs[header_count] > 1) {
+        uint16_t segment = (uint16_t) messages[next].length;
+
+        p_header->msg_control    = control[header_count].buffer;
+        p_header->msg_controllen = sizeof(control[header_count].buffer);
+        p_cmsg                   = CMSG_FIRSTHDR(p_header);
+        p_cmsg->cmsg_level       = SOL_UDP;
+        p_cmsg->cmsg_type        = UDP_SEGMENT;
+        p_cmsg->cmsg_len         = CMSG_LEN(sizeof(segment));
+        memcpy(CMSG_DATA(p_cmsg), &segment, sizeof(segment));
+      }
+    }
+
+    result = sendmmsg(p_socket->socket_fd, headers, header_count, 0);
+    if (result < 0) {
+      if (EINTR == errno) continue;
+      if (p_udp_ctx->gso && ((EIO == errno) || (EINVAL == errno))) {
+        /*
+         * EIO: no segmentation offload on the outgoing device after all. EINVAL: a segment does not fit the path MTU.
+         * Either way, send the datagrams one by one from now on.
+         */
+        p_udp_ctx->gso = 0;
+        continue;
+      }
+      error = TRANSPORT_ERROR_SEND;
+      goto exit;
+    }
+
+    for (i = 0; i < (size_t) result; i++) { sent += runs[i]; }
+  }
+#else
+  while (sent < count) {
+    struct sockaddr_storage address = messages[sent].address.ss_family ? messages[sent].address
+                                                                       : p_socket->remote_sockaddr;
+    ssize_t                 bytes_sent;
+
+    error = socket_address_for_family(&address, p_socket->local_sockaddr.ss_family);
+    if (error) goto exit;
+
+    bytes_sent = sendto(p_socket->socket_fd,
+                        messages[sent].buffer,
+                        messages[sent].length,
+                        0,
+                        (struct sockaddr*) &address,
+                        socket_address_length(&address));
+    if (bytes_sent < 0) {
+      if (EINTR == errno) continue;
+      error = TRANSPORT_ERROR_SEND;
+      goto exit;
+    }
+    sent++;
+  }
+#endif
+
+exit:
+  if (p_sent) *p_sent = sent;
+  if (error) ockam_log_error("%x", error);
+  return error;
+}
+
 ockam_error_t socket_udp_deinit(ockam_transport_t* p_transport)
 {
   socket_udp_ctx_t* p_udp_ctx = (socket_udp_ctx_t*) p_transport->ctx;
@@ -214,10 +656,12 @@ ockam_error_t socket_udp_deinit(ockam_transport_t* p_transport)
   if (p_udp_ctx != NULL) {
     // Close the connection
     if (NULL != p_udp_ctx->posix_socket.p_reader)
-      ockam_memory_free(gp_ockam_transport_memory, p_udp_ctx->posix_socket.p_reader, 0);
+      ockam_memory_free(gp_ockam_transport_memory, p_udp_ctx->posix_socket.p_reader, sizeof(ockam_reader_t));
     if (NULL != p_udp_ctx->posix_socket.p_writer)
-      ockam_memory_free(gp_ockam_transport_memory, p_udp_ctx->posix_socket.p_writer, 0);
-    ockam_memory_free(gp_ockam_transport_memory, p_udp_ctx, 0);
+      ockam_memory_free(gp_ockam_transport_memory, p_udp_ctx->posix_socket.p_writer, sizeof(ockam_writer_t));
+    if (-1 != p_udp_ctx->posix_socket.socket_fd) close(p_udp_ctx->posix_socket.socket_fd);
+    if (NULL != p_udp_ctx->gro_buffer) ockam_memory_free(gp_ockam_transport_memory, p_udp_ctx->gro_buffer, UINT16_MAX);
+    ockam_memory_free(gp_ockam_transport_memory, p_udp_ctx, sizeof(socket_udp_ctx_t));
   }
 
   return 0;
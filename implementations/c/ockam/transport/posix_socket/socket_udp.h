@@ -1,16 +1,64 @@
 #ifndef socket_udp_h
 #define socket_udp_h
 
+#include "ockam/io.h"
 #include "ockam/transport.h"
 #include "ockam/transport/socket.h"
 
 ockam_error_t ockam_transport_socket_udp_init(ockam_transport_t*                   p_transport,
                                               ockam_transport_socket_attributes_t* p_cfg);
 
+/*
+ * Most datagrams moved by one batched read or write call, and so by one recvmmsg/sendmmsg
+ */
+#define OCKAM_TRANSPORT_UDP_BATCH_MAX 64
+
+/**
+ * One datagram of a batched read or write.
+ */
+typedef struct ockam_transport_udp_message {
+  uint8_t*                buffer;  /*!< Datagram to send, or room for one received */
+  size_t                  size;    /*!< Read only: size of buffer */
+  size_t                  length;  /*!< Write: bytes to send. Read: set to the bytes received */
+  struct sockaddr_storage address; /*!< Write: destination, zero for the connected peer. Read: set to the sender */
+  ockam_error_t           error;   /*!< Read: set to TRANSPORT_ERROR_BUFFER_TOO_SMALL if the datagram was cut short */
+} ockam_transport_udp_message_t;
+
+/**
+ * @brief   Receive up to count datagrams, waiting for the first only.
+ * @param   p_reader    [in]  - Reader of a UDP transport.
+ * @param   messages    [in]  - Buffers to receive into, filled in order.
+ * @param   count       [in]  - Number of messages, at most OCKAM_TRANSPORT_UDP_BATCH_MAX are filled per call.
+ * @param   p_received  [out] - Number of messages filled.
+ */
+ockam_error_t ockam_transport_socket_udp_read_batch(ockam_reader_t*                p_reader,
+                                                    ockam_transport_udp_message_t* messages,
+                                                    size_t                         count,
+                                                    size_t*                        p_received);
+
+/**
+ * @brief   Send count datagrams, in order.
+ * @param   p_writer    [in]  - Writer of a UDP transport.
+ * @param   messages    [in]  - Datagrams to send.
+ * @param   count       [in]  - Number of messages.
+ * @param   p_sent      [out] - Optional, number of messages sent, also on error.
+ */
+ockam_error_t ockam_transport_socket_udp_write_batch(ockam_writer_t*                p_writer,
+                                                     ockam_transport_udp_message_t* messages,
+                                                     size_t                         count,
+                                                     size_t*                        p_sent);
+
 // TODO: add ockam_ prefix to types declared here. Review which of them indeed need to be public.
 
 typedef struct socket_udp_ctx {
-  posix_socket_t posix_socket;
+  posix_socket_t          posix_socket;
+  uint8_t                 gso;         /* Socket takes UDP_SEGMENT */
+  uint8_t                 gro;         /* UDP_GRO is on, reads go through gro_buffer */
+  uint8_t*                gro_buffer;  /* Last coalesced receive */
+  size_t                  gro_length;  /* Bytes in gro_buffer */
+  size_t                  gro_offset;  /* Start of the next datagram not yet handed out */
+  size_t                  gro_segment; /* Size of each datagram in gro_buffer, the last one may be shorter */
+  struct sockaddr_storage gro_address; /* Sender of the datagrams in gro_buffer */
 } socket_udp_ctx_t;
 
 #endif
@@ -0,0 +1,1001 @@
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+
+#include "ockam/log.h"
+#include "ockam/io.h"
+#include "ockam/io/impl.h"
+#include "ockam/memory.h"
+#include "ockam/transport.h"
+#include "ockam/transport/impl.h"
+#include "socket.h"
+#include "socket_udp_server.h"
+
+#define UDP_SERVER_DEFAULT_MAX_PEERS   65536u
+#define UDP_SERVER_DEFAULT_DATAGRAM    2048u
+#define UDP_SERVER_DEFAULT_QUEUE_DEPTH 64u
+#define UDP_SERVER_DATAGRAM_MAX        65507u
+#define UDP_SERVER_BATCH               64
+#define UDP_SERVER_BATCHES_PER_WAKE    16
+#define UDP_SERVER_INITIAL_BUCKET_BITS 8u
+
+typedef struct udp_server_shard udp_server_shard_t;
+typedef struct udp_server_ctx   udp_server_ctx_t;
+
+typedef struct udp_server_datagram {
+  size_t  length;
+  uint8_t data[];
+} udp_server_datagram_t;
+
+/*
+ * A peer holds one reference for the shard's table, one while it waits on a close request and, in reader mode, one
+ * for the application from the moment it is queued for accept. A peer leaves the table when it is closed; if
+ * references remain it moves to the shard's detached list, so deinit can free peers the application never released.
+ */
+struct ockam_transport_udp_peer {
+  ockam_transport_udp_peer_t*  p_hash_next;
+  ockam_transport_udp_peer_t*  p_prev; /* Activity list, least recently active first, or detached list */
+  ockam_transport_udp_peer_t*  p_next;
+  ockam_transport_udp_peer_t*  p_accept_next;
+  ockam_transport_udp_peer_t*  p_close_next;
+  udp_server_shard_t*          p_shard;
+  uint64_t                     key;
+  uint64_t                     last_ms;
+  struct sockaddr_storage      address;
+  ockam_ip_address_t           remote_address;
+  struct sockaddr_storage*     p_source; /* During the datagram callback: its source, if not address */
+  ockam_reader_t               reader;
+  ockam_writer_t               writer;
+  void*                        context;
+  int                          refs;
+  int                          closed;
+  int                          close_requested;
+  int                          accepted;
+  pthread_cond_t               readable;
+  udp_server_datagram_t**      queue;
+  size_t                       queue_head;
+  size_t                       queue_count;
+};
+
+/*
+ * The table, the activity list and the receive buffers belong to the shard thread. The lock covers what other threads
+ * reach: peer addresses, references and closed flags, reader queues, close requests and stop.
+ */
+struct udp_server_shard {
+  udp_server_ctx_t*            p_ctx;
+  pthread_t                    thread;
+  int                          thread_started;
+  int                          socket_fd;
+  int                          wake_fd;
+  pthread_mutex_t              lock;
+  int                          stop;
+  ockam_transport_udp_peer_t** buckets;
+  size_t                       bucket_bits;
+  size_t                       peer_count;
+  ockam_transport_udp_peer_t*  p_oldest;
+  ockam_transport_udp_peer_t*  p_newest;
+  ockam_transport_udp_peer_t*  p_detached;
+  ockam_transport_udp_peer_t*  p_close_requests;
+  uint8_t*                     buffers;
+};
+
+struct udp_server_ctx {
+  ockam_transport_socket_udp_server_attributes_t attributes;
+  ockam_memory_t*                                p_memory;
+  uint16_t                                       port;
+  pthread_mutex_t                                lock; /* Accept queue and stop */
+  pthread_cond_t                                 acceptable;
+  int                                            stop;
+  ockam_transport_udp_peer_t*                    p_accept_head;
+  ockam_transport_udp_peer_t*                    p_accept_tail;
+  uint16_t                                       shard_count;
+  udp_server_shard_t                             shards[OCKAM_TRANSPORT_UDP_SERVER_MAX_THREADS];
+};
+
+ockam_error_t udp_server_vtable_connect(void*               ctx,
+                                        ockam_reader_t**    pp_reader,
+                                        ockam_writer_t**    pp_writer,
+                                        ockam_ip_address_t* remote_address,
+                                        int16_t             retry_count,
+                                        uint16_t            retry_interval);
+ockam_error_t udp_server_vtable_accept(void*               ctx,
+                                       ockam_reader_t**    pp_reader,
+                                       ockam_writer_t**    pp_writer,
+                                       ockam_ip_address_t* remote_address);
+ockam_error_t udp_server_vtable_deinit(ockam_transport_t* p_transport);
+
+ockam_transport_vtable_t socket_udp_server_vtable = { udp_server_vtable_connect,
+                                                      udp_server_vtable_accept,
+                                                      udp_server_vtable_deinit };
+
+uint64_t udp_server_now_ms(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000u + (uint64_t) ts.tv_nsec / 1000000u;
+}
+
+/*
+ * IPv4 and IPv4-mapped addresses fit the key whole. IPv6 addresses are folded into it, so without connection IDs a
+ * peer found by key is also compared by address.
+ */
+uint64_t udp_server_address_key(struct sockaddr_storage* p_address)
+{
+  struct sockaddr_in*  p_ipv4_address = (struct sockaddr_in*) p_address;
+  struct sockaddr_in6* p_ipv6_address = (struct sockaddr_in6*) p_address;
+  uint32_t             ipv4           = 0;
+  uint64_t             high           = 0;
+  uint64_t             low            = 0;
+
+  if (AF_INET == p_address->ss_family) {
+    return ((uint64_t) ntohl(p_ipv4_address->sin_addr.s_addr) << 16u) | ntohs(p_ipv4_address->sin_port);
+  }
+
+  if (IN6_IS_ADDR_V4MAPPED(&p_ipv6_address->sin6_addr)) {
+    memcpy(&ipv4, &p_ipv6_address->sin6_addr.s6_addr[12], sizeof(ipv4));
+    return ((uint64_t) ntohl(ipv4) << 16u) | ntohs(p_ipv6_address->sin6_port);
+  }
+
+  memcpy(&high, &p_ipv6_address->sin6_addr.s6_addr[0], sizeof(high));
+  memcpy(&low, &p_ipv6_address->sin6_addr.s6_addr[8], sizeof(low));
+  return (high * 0x9E3779B97F4A7C15ull) ^ low ^ ((uint64_t) ntohs(p_ipv6_address->sin6_port) << 48u);
+}
+
+int udp_server_address_equal(struct sockaddr_storage* p_a, struct sockaddr_storage* p_b)
+{
+  struct sockaddr_in6* p_ipv6_a = (struct sockaddr_in6*) p_a;
+  struct sockaddr_in6* p_ipv6_b = (struct sockaddr_in6*) p_b;
+
+  if (p_a->ss_family != p_b->ss_family) return 0;
+  if (AF_INET == p_a->ss_family) {
+    return (((struct sockaddr_in*) p_a)->sin_addr.s_addr == ((struct sockaddr_in*) p_b)->sin_addr.s_addr) &&
+           (((struct sockaddr_in*) p_a)->sin_port == ((struct sockaddr_in*) p_b)->sin_port);
+  }
+  return (p_ipv6_a->sin6_port == p_ipv6_b->sin6_port) && (p_ipv6_a->sin6_scope_id == p_ipv6_b->sin6_scope_id) &&
+         IN6_ARE_ADDR_EQUAL(&p_ipv6_a->sin6_addr, &p_ipv6_b->sin6_addr);
+}
+
+size_t udp_server_bucket(uint64_t key, size_t bits)
+{
+  return (size_t)((key * 0x9E3779B97F4A7C15ull) >> (64u - bits));
+}
+
+ockam_error_t udp_server_peer_read(void* ctx, uint8_t* buffer, size_t buffer_size, size_t* buffer_length)
+{
+  ockam_error_t               error       = OCKAM_ERROR_NONE;
+  ockam_transport_udp_peer_t* p_peer      = (ockam_transport_udp_peer_t*) ctx;
+  udp_server_shard_t*         p_shard     = p_peer->p_shard;
+  udp_server_ctx_t*           p_ctx       = p_shard->p_ctx;
+  udp_server_datagram_t*      p_datagram  = NULL;
+  size_t                      queue_depth = p_ctx->attributes.queue_depth;
+
+  pthread_mutex_lock(&p_shard->lock);
+  while (!p_peer->closed && (0 == p_peer->queue_count)) pthread_cond_wait(&p_peer->readable, &p_shard->lock);
+  if (p_peer->queue_count) {
+    p_datagram                        = p_peer->queue[p_peer->queue_head];
+    p_peer->queue[p_peer->queue_head] = NULL;
+    p_peer->queue_head                = (p_peer->queue_head + 1) % queue_depth;
+    p_peer->queue_count--;
+  }
+  pthread_mutex_unlock(&p_shard->lock);
+
+  if (NULL == p_datagram) {
+    error = TRANSPORT_ERROR_NOT_CONNECTED;
+    goto exit;
+  }
+  if (p_datagram->length > buffer_size) {
+    error = TRANSPORT_ERROR_BUFFER_TOO_SMALL;
+    goto exit;
+  }
+
+  ockam_memory_copy(p_ctx->p_memory, buffer, p_datagram->data, p_datagram->length);
+  *buffer_length = p_datagram->length;
+
+exit:
+  if (p_datagram) ockam_memory_free(p_ctx->p_memory, p_datagram, sizeof(*p_datagram) + p_datagram->length);
+  return error;
+}
+
+ockam_error_t udp_server_peer_writer_write(void* ctx, uint8_t* buffer, size_t length)
+{
+  return ockam_transport_udp_peer_write((ockam_transport_udp_peer_t*) ctx, buffer, length);
+}
+
+void udp_server_peer_free(udp_server_ctx_t* p_ctx, ockam_transport_udp_peer_t* p_peer)
+{
+  size_t i = 0;
+
+  if (p_peer->queue) {
+    for (i = 0; i < p_ctx->attributes.queue_depth; i++) {
+      if (p_peer->queue[i]) {
+        ockam_memory_free(p_ctx->p_memory, p_peer->queue[i], sizeof(udp_server_datagram_t) + p_peer->queue[i]->length);
+      }
+    }
+    ockam_memory_free(p_ctx->p_memory, p_peer->queue, p_ctx->attributes.queue_depth * sizeof(*p_peer->queue));
+    pthread_cond_destroy(&p_peer->readable);
+  }
+  ockam_memory_free(p_ctx->p_memory, p_peer, sizeof(*p_peer));
+}
+
+/*
+ * Drop one reference, with the shard lock held. A closed peer that is still referenced waits on the detached list.
+ */
+void udp_server_peer_release(udp_server_shard_t* p_shard, ockam_transport_udp_peer_t* p_peer)
+{
+  if (--p_peer->refs) {
+    if (p_peer->closed && (NULL == p_peer->p_prev) && (p_shard->p_detached != p_peer)) {
+      p_peer->p_next = p_shard->p_detached;
+      if (p_shard->p_detached) p_shard->p_detached->p_prev = p_peer;
+      p_shard->p_detached = p_peer;
+    }
+    return;
+  }
+
+  if (p_peer->closed) {
+    if (p_peer->p_prev) {
+      p_peer->p_prev->p_next = p_peer->p_next;
+    } else if (p_shard->p_detached == p_peer) {
+      p_shard->p_detached = p_peer->p_next;
+    }
+    if (p_peer->p_next) p_peer->p_next->p_prev = p_peer->p_prev;
+  }
+  udp_server_peer_free(p_shard->p_ctx, p_peer);
+}
+
+void udp_server_activity_unlink(udp_server_shard_t* p_shard, ockam_transport_udp_peer_t* p_peer)
+{
+  if (p_peer->p_prev) {
+    p_peer->p_prev->p_next = p_peer->p_next;
+  } else {
+    p_shard->p_oldest = p_peer->p_next;
+  }
+  if (p_peer->p_next) {
+    p_peer->p_next->p_prev = p_peer->p_prev;
+  } else {
+    p_shard->p_newest = p_peer->p_prev;
+  }
+  p_peer->p_prev = NULL;
+  p_peer->p_next = NULL;
+}
+
+void udp_server_activity_append(udp_server_shard_t* p_shard, ockam_transport_udp_peer_t* p_peer)
+{
+  p_peer->p_prev = p_shard->p_newest;
+  p_peer->p_next = NULL;
+  if (p_shard->p_newest) {
+    p_shard->p_newest->p_next = p_peer;
+  } else {
+    p_shard->p_oldest = p_peer;
+  }
+  p_shard->p_newest = p_peer;
+}
+
+/*
+ * Take an open peer out of the table, run the close callback and drop the table's reference. Shard thread only, or
+ * the deinit thread once the shard thread has stopped.
+ */
+void udp_server_peer_close(udp_server_shard_t* p_shard, ockam_transport_udp_peer_t* p_peer)
+{
+  udp_server_ctx_t*            p_ctx = p_shard->p_ctx;
+  ockam_transport_udp_peer_t** pp    = &p_shard->buckets[udp_server_bucket(p_peer->key, p_shard->bucket_bits)];
+
+  while (*pp != p_peer) pp = &(*pp)->p_hash_next;
+  *pp = p_peer->p_hash_next;
+  udp_server_activity_unlink(p_shard, p_peer);
+  p_shard->peer_count--;
+
+  pthread_mutex_lock(&p_shard->lock);
+  p_peer->closed = 1;
+  if (p_peer->queue) pthread_cond_broadcast(&p_peer->readable);
+  pthread_mutex_unlock(&p_shard->lock);
+
+  if (p_ctx->attributes.close) p_ctx->attributes.close(p_ctx->attributes.user_ctx, p_peer);
+
+  pthread_mutex_lock(&p_shard->lock);
+  udp_server_peer_release(p_shard, p_peer);
+  pthread_mutex_unlock(&p_shard->lock);
+}
+
+/*
+ * Find the peer by key and, if p_address is given, by address too
+ */
+ockam_transport_udp_peer_t*
+udp_server_peer_find(udp_server_shard_t* p_shard, uint64_t key, struct sockaddr_storage* p_address)
+{
+  ockam_transport_udp_peer_t* p_peer = p_shard->buckets[udp_server_bucket(key, p_shard->bucket_bits)];
+
+  while (p_peer && ((p_peer->key != key) || (p_address && !udp_server_address_equal(&p_peer->address, p_address)))) {
+    p_peer = p_peer->p_hash_next;
+  }
+  return p_peer;
+}
+
+/*
+ * Double the table once it holds more peers than buckets. On allocation failure the table keeps its size and chains
+ * grow longer instead.
+ */
+void udp_server_table_grow(udp_server_shard_t* p_shard)
+{
+  udp_server_ctx_t*            p_ctx   = p_shard->p_ctx;
+  ockam_transport_udp_peer_t** buckets = NULL;
+  ockam_transport_udp_peer_t*  p_peer  = NULL;
+  size_t                       bits    = p_shard->bucket_bits + 1;
+  size_t                       bucket  = 0;
+  size_t                       i       = 0;
+
+  if (bits >= 32u) return;
+  if (ockam_memory_alloc_zeroed(p_ctx->p_memory, (void**) &buckets, ((size_t) 1 << bits) * sizeof(*buckets))) return;
+
+  for (i = 0; i < ((size_t) 1 << p_shard->bucket_bits); i++) {
+    while (p_shard->buckets[i]) {
+      p_peer               = p_shard->buckets[i];
+      p_shard->buckets[i]  = p_peer->p_hash_next;
+      bucket               = udp_server_bucket(p_peer->key, bits);
+      p_peer->p_hash_next  = buckets[bucket];
+      buckets[bucket]      = p_peer;
+    }
+  }
+
+  ockam_memory_free(p_ctx->p_memory, p_shard->buckets, ((size_t) 1 << p_shard->bucket_bits) * sizeof(*buckets));
+  p_shard->buckets     = buckets;
+  p_shard->bucket_bits = bits;
+}
+
+ockam_error_t udp_server_peer_new(udp_server_shard_t*          p_shard,
+                                  uint64_t                     key,
+                                  struct sockaddr_storage*     p_address,
+                                  uint64_t                     now,
+                                  ockam_transport_udp_peer_t** pp_peer)
+{
+  ockam_error_t               error  = OCKAM_ERROR_NONE;
+  udp_server_ctx_t*           p_ctx  = p_shard->p_ctx;
+  ockam_transport_udp_peer_t* p_peer = NULL;
+  size_t                      bucket = 0;
+
+  // Full: make room by closing the peer that has been quiet the longest
+  if ((p_shard->peer_count >= p_ctx->attributes.max_peers) && p_shard->p_oldest) {
+    udp_server_peer_close(p_shard, p_shard->p_oldest);
+  }
+
+  error = ockam_memory_alloc_zeroed(p_ctx->p_memory, (void**) &p_peer, sizeof(*p_peer));
+  if (error) goto exit;
+
+  if (NULL == p_ctx->attributes.datagram) {
+    error = ockam_memory_alloc_zeroed(
+      p_ctx->p_memory, (void**) &p_peer->queue, p_ctx->attributes.queue_depth * sizeof(*p_peer->queue));
+    if (error) goto exit;
+    pthread_cond_init(&p_peer->readable, NULL);
+    p_peer->reader.read = udp_server_peer_read;
+    p_peer->reader.ctx  = p_peer;
+  }
+
+  p_peer->p_shard      = p_shard;
+  p_peer->key          = key;
+  p_peer->last_ms      = now;
+  p_peer->address      = *p_address;
+  p_peer->refs         = 1;
+  p_peer->writer.write = udp_server_peer_writer_write;
+  p_peer->writer.ctx   = p_peer;
+  socket_address_to_ip_address(p_address, &p_peer->remote_address);
+
+  if (p_shard->peer_count >= ((size_t) 1 << p_shard->bucket_bits)) udp_server_table_grow(p_shard);
+  bucket                   = udp_server_bucket(key, p_shard->bucket_bits);
+  p_peer->p_hash_next      = p_shard->buckets[bucket];
+  p_shard->buckets[bucket] = p_peer;
+  udp_server_activity_append(p_shard, p_peer);
+  p_shard->peer_count++;
+
+  if (p_ctx->attributes.accept) {
+    error = p_ctx->attributes.accept(p_ctx->attributes.user_ctx, p_peer, &p_peer->remote_address);
+    if (error) {
+      udp_server_peer_close(p_shard, p_peer);
+      p_peer = NULL;
+      goto exit;
+    }
+  }
+
+  if (p_peer->queue) {
+    pthread_mutex_lock(&p_shard->lock);
+    p_peer->refs++;
+    pthread_mutex_unlock(&p_shard->lock);
+
+    pthread_mutex_lock(&p_ctx->lock);
+    if (p_ctx->p_accept_tail) {
+      p_ctx->p_accept_tail->p_accept_next = p_peer;
+    } else {
+      p_ctx->p_accept_head = p_peer;
+    }
+    p_ctx->p_accept_tail = p_peer;
+    pthread_cond_signal(&p_ctx->acceptable);
+    pthread_mutex_unlock(&p_ctx->lock);
+  }
+
+  *pp_peer = p_peer;
+
+exit:
+  if (error && p_peer) udp_server_peer_free(p_ctx, p_peer);
+  return error;
+}
+
+void udp_server_enqueue(udp_server_shard_t* p_shard, ockam_transport_udp_peer_t* p_peer, uint8_t* data, size_t length)
+{
+  udp_server_ctx_t*      p_ctx       = p_shard->p_ctx;
+  udp_server_datagram_t* p_datagram  = NULL;
+  size_t                 queue_depth = p_ctx->attributes.queue_depth;
+
+  if (ockam_memory_alloc_zeroed(p_ctx->p_memory, (void**) &p_datagram, sizeof(*p_datagram) + length)) return;
+  p_datagram->length = length;
+  ockam_memory_copy(p_ctx->p_memory, p_datagram->data, data, length);
+
+  pthread_mutex_lock(&p_shard->lock);
+  if (p_peer->queue_count < queue_depth) {
+    p_peer->queue[(p_peer->queue_head + p_peer->queue_count) % queue_depth] = p_datagram;
+    p_peer->queue_count++;
+    p_datagram = NULL;
+    pthread_cond_signal(&p_peer->readable);
+  }
+  pthread_mutex_unlock(&p_shard->lock);
+
+  // Queue full: drop the datagram, as the socket would have
+  if (p_datagram) ockam_memory_free(p_ctx->p_memory, p_datagram, sizeof(*p_datagram) + length);
+}
+
+/*
+ * Find or create the datagram's peer and deliver the datagram to it.
+ */
+void udp_server_dispatch(udp_server_shard_t*      p_shard,
+                         struct sockaddr_storage* p_address,
+                         uint8_t*                 data,
+                         size_t                   length,
+                         uint64_t                 now)
+{
+  ockam_error_t               error  = OCKAM_ERROR_NONE;
+  udp_server_ctx_t*           p_ctx  = p_shard->p_ctx;
+  ockam_transport_udp_peer_t* p_peer = NULL;
+  uint64_t                    key    = 0;
+
+  if (p_ctx->attributes.connection_id) {
+    error = p_ctx->attributes.connection_id(p_ctx->attributes.user_ctx, data, length, &key);
+    if (error) return;
+  } else {
+    key = udp_server_address_key(p_address);
+  }
+
+  p_peer = udp_server_peer_find(p_shard, key, p_ctx->attributes.connection_id ? NULL : p_address);
+  if (NULL == p_peer) {
+    error = udp_server_peer_new(p_shard, key, p_address, now, &p_peer);
+    if (error) return;
+  }
+
+  p_peer->last_ms = now;
+  if (p_shard->p_newest != p_peer) {
+    udp_server_activity_unlink(p_shard, p_peer);
+    udp_server_activity_append(p_shard, p_peer);
+  }
+
+  if (p_ctx->attributes.datagram) {
+    // Same connection ID from a new address: anyone can send that, only the application can tell if the peer moved
+    if (!udp_server_address_equal(&p_peer->address, p_address)) p_peer->p_source = p_address;
+    error            = p_ctx->attributes.datagram(p_ctx->attributes.user_ctx, p_peer, data, length);
+    p_peer->p_source = NULL;
+    if (error) udp_server_peer_close(p_shard, p_peer);
+  } else {
+    udp_server_enqueue(p_shard, p_peer, data, length);
+  }
+}
+
+void udp_server_receive(udp_server_shard_t* p_shard)
+{
+  udp_server_ctx_t*       p_ctx = p_shard->p_ctx;
+  size_t                  size  = p_ctx->attributes.max_datagram_size;
+  struct mmsghdr          headers[UDP_SERVER_BATCH];
+  struct iovec            iov[UDP_SERVER_BATCH];
+  struct sockaddr_storage addresses[UDP_SERVER_BATCH];
+  uint64_t                now     = 0;
+  int                     batches = 0;
+  int                     count   = 0;
+  int                     i       = 0;
+
+  // Level-triggered: stop after a few batches so close requests and idle peers are looked at in time
+  for (batches = 0; batches < UDP_SERVER_BATCHES_PER_WAKE; batches++) {
+    ockam_memory_set(p_ctx->p_memory, headers, 0, sizeof(headers));
+    for (i = 0; i < UDP_SERVER_BATCH; i++) {
+      iov[i].iov_base                = p_shard->buffers + (size_t) i * size;
+      iov[i].iov_len                 = size;
+      headers[i].msg_hdr.msg_name    = &addresses[i];
+      headers[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+      headers[i].msg_hdr.msg_iov     = &iov[i];
+      headers[i].msg_hdr.msg_iovlen  = 1;
+    }
+
+    count = recvmmsg(p_shard->socket_fd, headers, UDP_SERVER_BATCH, MSG_DONTWAIT, NULL);
+    if (count < 0) {
+      if (EINTR == errno) continue;
+      if ((EAGAIN != errno) && (EWOULDBLOCK != errno)) ockam_log_error("recvmmsg failed: %d", errno);
+      break;
+    }
+
+    now = udp_server_now_ms();
+    for (i = 0; i < count; i++) {
+      if (headers[i].msg_hdr.msg_flags & MSG_TRUNC) continue;
+      if ((AF_INET != addresses[i].ss_family) && (AF_INET6 != addresses[i].ss_family)) continue;
+      udp_server_dispatch(p_shard, &addresses[i], iov[i].iov_base, headers[i].msg_len, now);
+    }
+
+    if (count < UDP_SERVER_BATCH) break;
+  }
+}
+
+/*
+ * Close the peers that have been quiet for too long and return how long to wait for the next one to expire
+ */
+int udp_server_sweep(udp_server_shard_t* p_shard)
+{
+  uint32_t idle = p_shard->p_ctx->attributes.idle_timeout_ms;
+  uint64_t now  = 0;
+  uint64_t wait = idle;
+
+  if (0 == idle) return -1;
+
+  now = udp_server_now_ms();
+  while (p_shard->p_oldest && (now - p_shard->p_oldest->last_ms >= idle)) {
+    udp_server_peer_close(p_shard, p_shard->p_oldest);
+  }
+
+  if (p_shard->p_oldest) wait = p_shard->p_oldest->last_ms + idle - now;
+  return (wait > INT32_MAX) ? INT32_MAX : (int) wait;
+}
+
+void* udp_server_shard_run(void* arg)
+{
+  udp_server_shard_t*         p_shard = (udp_server_shard_t*) arg;
+  ockam_transport_udp_peer_t* p_peer  = NULL;
+  ockam_transport_udp_peer_t* p_next  = NULL;
+  struct pollfd               fds[2];
+  eventfd_t                   count   = 0;
+  int                         timeout = -1;
+  int                         stop    = 0;
+
+  fds[0].fd     = p_shard->socket_fd;
+  fds[0].events = POLLIN;
+  fds[1].fd     = p_shard->wake_fd;
+  fds[1].events = POLLIN;
+
+  while (!stop) {
+    timeout = udp_server_sweep(p_shard);
+    if (poll(fds, 2, timeout) < 0) {
+      if (EINTR == errno) continue;
+      ockam_log_error("poll failed: %d", errno);
+      break;
+    }
+
+    if (fds[1].revents & POLLIN) {
+      eventfd_read(p_shard->wake_fd, &count);
+
+      pthread_mutex_lock(&p_shard->lock);
+      stop                      = p_shard->stop;
+      p_peer                    = p_shard->p_close_requests;
+      p_shard->p_close_requests = NULL;
+      pthread_mutex_unlock(&p_shard->lock);
+
+      for (; p_peer; p_peer = p_next) {
+        p_next = p_peer->p_close_next;
+        if (!p_peer->closed) udp_server_peer_close(p_shard, p_peer);
+
+        pthread_mutex_lock(&p_shard->lock);
+        p_peer->close_requested = 0;
+        udp_server_peer_release(p_shard, p_peer);
+        pthread_mutex_unlock(&p_shard->lock);
+      }
+    }
+
+    if (!stop && (fds[0].revents & POLLIN)) udp_server_receive(p_shard);
+  }
+
+  return NULL;
+}
+
+/*
+ * p_address may come back changed: the first shard settles the port, and the family on hosts without IPv6, for the
+ * others
+ */
+ockam_error_t
+udp_server_shard_init(udp_server_ctx_t* p_ctx, udp_server_shard_t* p_shard, struct sockaddr_storage* p_address)
+{
+  ockam_error_t           error  = OCKAM_ERROR_NONE;
+  struct sockaddr_storage bound  = { 0 };
+  socklen_t               length = sizeof(bound);
+
+  error = make_socket(p_address, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, &p_shard->socket_fd);
+  if (error) goto exit;
+
+  // Every shard binds the same address, the kernel spreads peers across the sockets by source address
+  if (setsockopt(p_shard->socket_fd, SOL_SOCKET, SO_REUSEPORT, &(int) { 1 }, sizeof(int)) < 0) {
+    error = TRANSPORT_ERROR_SERVER_INIT;
+    goto exit;
+  }
+  if (p_ctx->attributes.receive_buffer &&
+      (setsockopt(p_shard->socket_fd, SOL_SOCKET, SO_RCVBUF, &p_ctx->attributes.receive_buffer, sizeof(int)) < 0)) {
+    error = TRANSPORT_ERROR_SERVER_INIT;
+    goto exit;
+  }
+  if (0 != bind(p_shard->socket_fd, (struct sockaddr*) p_address, socket_address_length(p_address))) {
+    error = TRANSPORT_ERROR_SERVER_INIT;
+    goto exit;
+  }
+
+  // The first shard may have been given any port, the others must join it there
+  if (0 != getsockname(p_shard->socket_fd, (struct sockaddr*) &bound, &length)) {
+    error = TRANSPORT_ERROR_SERVER_INIT;
+    goto exit;
+  }
+  *p_address = bound;
+
+  p_shard->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (-1 == p_shard->wake_fd) {
+    error = TRANSPORT_ERROR_SOCKET_CREATE;
+    goto exit;
+  }
+
+  p_shard->bucket_bits = UDP_SERVER_INITIAL_BUCKET_BITS;
+  error                = ockam_memory_alloc_zeroed(
+    p_ctx->p_memory, (void**) &p_shard->buckets, ((size_t) 1 << p_shard->bucket_bits) * sizeof(*p_shard->buckets));
+  if (error) goto exit;
+
+  error = ockam_memory_alloc_zeroed(
+    p_ctx->p_memory, (void**) &p_shard->buffers, UDP_SERVER_BATCH * p_ctx->attributes.max_datagram_size);
+  if (error) goto exit;
+
+exit:
+  return error;
+}
+
+ockam_error_t ockam_transport_socket_udp_server_init(ockam_transport_t*                              p_transport,
+                                                     ockam_transport_socket_udp_server_attributes_t* p_attributes)
+{
+  ockam_error_t           error   = OCKAM_ERROR_NONE;
+  udp_server_ctx_t*       p_ctx   = NULL;
+  udp_server_shard_t*     p_shard = NULL;
+  struct sockaddr_storage address;
+  ockam_ip_address_t      bound_address;
+  uint8_t*                p_ip = NULL;
+  long                    cpus = 0;
+  uint16_t                i    = 0;
+
+  if ((NULL == p_transport) || (NULL == p_attributes) || (NULL == p_attributes->p_memory) ||
+      (p_attributes->thread_count > OCKAM_TRANSPORT_UDP_SERVER_MAX_THREADS) ||
+      (p_attributes->max_datagram_size > UDP_SERVER_DATAGRAM_MAX)) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
+    goto exit;
+  }
+
+  if (strlen((char*) p_attributes->listen_address.ip_address)) p_ip = p_attributes->listen_address.ip_address;
+  error = make_socket_address(p_ip, p_attributes->listen_address.port, &address);
+  if (error) goto exit;
+
+  error = ockam_memory_alloc_zeroed(p_attributes->p_memory, (void**) &p_ctx, sizeof(udp_server_ctx_t));
+  if (error) goto exit;
+
+  ockam_memory_copy(p_attributes->p_memory, &p_ctx->attributes, p_attributes, sizeof(*p_attributes));
+  p_ctx->p_memory = p_attributes->p_memory;
+  if (0 == p_ctx->attributes.max_peers) p_ctx->attributes.max_peers = UDP_SERVER_DEFAULT_MAX_PEERS;
+  if (0 == p_ctx->attributes.max_datagram_size) p_ctx->attributes.max_datagram_size = UDP_SERVER_DEFAULT_DATAGRAM;
+  if (0 == p_ctx->attributes.queue_depth) p_ctx->attributes.queue_depth = UDP_SERVER_DEFAULT_QUEUE_DEPTH;
+
+  p_ctx->shard_count = p_attributes->thread_count;
+  if (0 == p_ctx->shard_count) {
+    cpus               = sysconf(_SC_NPROCESSORS_ONLN);
+    p_ctx->shard_count = (cpus < 1) ? 1 : (cpus > OCKAM_TRANSPORT_UDP_SERVER_MAX_THREADS)
+                                            ? OCKAM_TRANSPORT_UDP_SERVER_MAX_THREADS
+                                            : (uint16_t) cpus;
+  }
+  pthread_mutex_init(&p_ctx->lock, NULL);
+  pthread_cond_init(&p_ctx->acceptable, NULL);
+
+  p_transport->vtable = &socket_udp_server_vtable;
+  p_transport->ctx    = p_ctx;
+
+  for (i = 0; i < p_ctx->shard_count; i++) {
+    p_shard            = &p_ctx->shards[i];
+    p_shard->p_ctx     = p_ctx;
+    p_shard->socket_fd = -1;
+    p_shard->wake_fd   = -1;
+    pthread_mutex_init(&p_shard->lock, NULL);
+  }
+
+  for (i = 0; i < p_ctx->shard_count; i++) {
+    error = udp_server_shard_init(p_ctx, &p_ctx->shards[i], &address);
+    if (error) goto exit;
+  }
+  socket_address_to_ip_address(&address, &bound_address);
+  p_ctx->port = bound_address.port;
+
+  for (i = 0; i < p_ctx->shard_count; i++) {
+    if (0 != pthread_create(&p_ctx->shards[i].thread, NULL, udp_server_shard_run, &p_ctx->shards[i])) {
+      error = TRANSPORT_ERROR_SERVER_INIT;
+      goto exit;
+    }
+    p_ctx->shards[i].thread_started = 1;
+  }
+
+exit:
+  if (error) {
+    ockam_log_error("%x", error);
+    if (p_ctx) udp_server_vtable_deinit(p_transport);
+  }
+  return error;
+}
+
+uint16_t ockam_transport_socket_udp_server_port(ockam_transport_t* p_transport)
+{
+  return (p_transport && p_transport->ctx) ? ((udp_server_ctx_t*) p_transport->ctx)->port : 0;
+}
+
+ockam_error_t ockam_transport_socket_udp_server_accept(ockam_transport_t*           p_transport,
+                                                       ockam_transport_udp_peer_t** pp_peer,
+                                                       ockam_ip_address_t*          remote_address)
+{
+  ockam_error_t               error  = OCKAM_ERROR_NONE;
+  udp_server_ctx_t*           p_ctx  = NULL;
+  ockam_transport_udp_peer_t* p_peer = NULL;
+
+  if ((NULL == p_transport) || (NULL == p_transport->ctx) || (NULL == pp_peer)) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
+    goto exit;
+  }
+  p_ctx = (udp_server_ctx_t*) p_transport->ctx;
+
+  // With a datagram callback, new peers arrive through the accept callback
+  if (p_ctx->attributes.datagram) {
+    error = TRANSPORT_ERROR_INVALID_OP;
+    goto exit;
+  }
+
+  pthread_mutex_lock(&p_ctx->lock);
+  while (!p_ctx->stop && (NULL == p_ctx->p_accept_head)) pthread_cond_wait(&p_ctx->acceptable, &p_ctx->lock);
+  p_peer = p_ctx->p_accept_head;
+  if (p_peer) {
+    p_ctx->p_accept_head = p_peer->p_accept_next;
+    if (NULL == p_ctx->p_accept_head) p_ctx->p_accept_tail = NULL;
+    p_peer->p_accept_next = NULL;
+  }
+  pthread_mutex_unlock(&p_ctx->lock);
+
+  if (NULL == p_peer) {
+    error = TRANSPORT_ERROR_ACCEPT;
+    goto exit;
+  }
+
+  pthread_mutex_lock(&p_peer->p_shard->lock);
+  p_peer->accepted = 1;
+  if (remote_address) *remote_address = p_peer->remote_address;
+  pthread_mutex_unlock(&p_peer->p_shard->lock);
+
+  *pp_peer = p_peer;
+
+exit:
+  return error;
+}
+
+ockam_error_t ockam_transport_udp_peer_write(ockam_transport_udp_peer_t* p_peer, uint8_t* buffer, size_t length)
+{
+  ockam_error_t           error   = OCKAM_ERROR_NONE;
+  udp_server_shard_t*     p_shard = NULL;
+  struct sockaddr_storage address;
+  ssize_t                 sent = 0;
+  int                     closed;
+
+  if ((NULL == p_peer) || ((NULL == buffer) && length) || (length > UDP_SERVER_DATAGRAM_MAX)) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
+    goto exit;
+  }
+  p_shard = p_peer->p_shard;
+
+  pthread_mutex_lock(&p_shard->lock);
+  closed  = p_peer->closed;
+  address = p_peer->address;
+  pthread_mutex_unlock(&p_shard->lock);
+
+  if (closed) {
+    error = TRANSPORT_ERROR_NOT_CONNECTED;
+    goto exit;
+  }
+
+  do {
+    sent = sendto(p_shard->socket_fd, buffer, length, 0, (struct sockaddr*) &address, socket_address_length(&address));
+  } while ((sent < 0) && (EINTR == errno));
+
+  // The socket is non-blocking for the shard thread: a full send buffer drops the datagram like the network would
+  if ((sent < 0) && (EAGAIN != errno) && (EWOULDBLOCK != errno)) error = TRANSPORT_ERROR_SEND;
+
+exit:
+  if (error && (TRANSPORT_ERROR_NOT_CONNECTED != error)) ockam_log_error("%x", error);
+  return error;
+}
+
+ockam_writer_t* ockam_transport_udp_peer_writer(ockam_transport_udp_peer_t* p_peer)
+{
+  return p_peer ? &p_peer->writer : NULL;
+}
+
+ockam_reader_t* ockam_transport_udp_peer_reader(ockam_transport_udp_peer_t* p_peer)
+{
+  return (p_peer && p_peer->queue) ? &p_peer->reader : NULL;
+}
+
+ockam_error_t ockam_transport_udp_peer_close(ockam_transport_udp_peer_t* p_peer)
+{
+  ockam_error_t       error   = OCKAM_ERROR_NONE;
+  udp_server_shard_t* p_shard = NULL;
+  int                 wake    = 0;
+
+  if (NULL == p_peer) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
+    goto exit;
+  }
+  p_shard = p_peer->p_shard;
+
+  // The shard thread closes the peer, the request holds a reference until it has
+  pthread_mutex_lock(&p_shard->lock);
+  if (!p_peer->closed && !p_peer->close_requested) {
+    p_peer->close_requested   = 1;
+    p_peer->refs++;
+    p_peer->p_close_next      = p_shard->p_close_requests;
+    p_shard->p_close_requests = p_peer;
+    wake                      = 1;
+  }
+  if (p_peer->accepted) {
+    p_peer->accepted = 0;
+    udp_server_peer_release(p_shard, p_peer);
+  }
+  pthread_mutex_unlock(&p_shard->lock);
+
+  if (wake) eventfd_write(p_shard->wake_fd, 1);
+
+exit:
+  return error;
+}
+
+ockam_error_t ockam_transport_udp_peer_address_confirm(ockam_transport_udp_peer_t* p_peer)
+{
+  ockam_error_t       error   = OCKAM_ERROR_NONE;
+  udp_server_shard_t* p_shard = NULL;
+
+  if (NULL == p_peer) {
+    error = TRANSPORT_ERROR_BAD_PARAMETER;
+    goto exit;
+  }
+  p_shard = p_peer->p_shard;
+
+  // p_source is only set on the shard thread while it runs the datagram callback, which is where this is called from
+  if (p_peer->p_source) {
+    pthread_mutex_lock(&p_shard->lock);
+    p_peer->address = *p_peer->p_source;
+    socket_address_to_ip_address(p_peer->p_source, &p_peer->remote_address);
+    pthread_mutex_unlock(&p_shard->lock);
+    p_peer->p_source = NULL;
+  }
+
+exit:
+  return error;
+}
+
+void ockam_transport_udp_peer_set_context(ockam_transport_udp_peer_t* p_peer, void* context)
+{
+  p_peer->context = context;
+}
+
+void* ockam_transport_udp_peer_get_context(ockam_transport_udp_peer_t* p_peer)
+{
+  return p_peer->context;
+}
+
+ockam_error_t udp_server_vtable_connect(void*               ctx,
+                                        ockam_reader_t**    pp_reader,
+                                        ockam_writer_t**    pp_writer,
+                                        ockam_ip_address_t* remote_address,
+                                        int16_t             retry_count,
+                                        uint16_t            retry_interval)
+{
+  // Replies from a peer reach whichever shard the kernel picks, so the server cannot start a peer itself
+  return TRANSPORT_ERROR_INVALID_OP;
+}
+
+ockam_error_t udp_server_vtable_accept(void*               ctx,
+                                       ockam_reader_t**    pp_reader,
+                                       ockam_writer_t**    pp_writer,
+                                       ockam_ip_address_t* remote_address)
+{
+  ockam_error_t               error     = OCKAM_ERROR_NONE;
+  ockam_transport_t           transport = { &socket_udp_server_vtable, ctx };
+  ockam_transport_udp_peer_t* p_peer    = NULL;
+
+  error = ockam_transport_socket_udp_server_accept(&transport, &p_peer, remote_address);
+  if (error) goto exit;
+
+  if (pp_reader) *pp_reader = &p_peer->reader;
+  if (pp_writer) *pp_writer = &p_peer->writer;
+
+exit:
+  return error;
+}
+
+ockam_error_t udp_server_vtable_deinit(ockam_transport_t* p_transport)
+{
+  udp_server_ctx_t*           p_ctx   = (udp_server_ctx_t*) p_transport->ctx;
+  udp_server_shard_t*         p_shard = NULL;
+  ockam_transport_udp_peer_t* p_peer  = NULL;
+  uint16_t                    i       = 0;
+
+  if (NULL == p_ctx) return TRANSPORT_ERROR_BAD_PARAMETER;
+
+  pthread_mutex_lock(&p_ctx->lock);
+  p_ctx->stop = 1;
+  pthread_cond_broadcast(&p_ctx->acceptable);
+  pthread_mutex_unlock(&p_ctx->lock);
+
+  for (i = 0; i < p_ctx->shard_count; i++) {
+    p_shard = &p_ctx->shards[i];
+    if (-1 == p_shard->wake_fd) continue;
+    pthread_mutex_lock(&p_shard->lock);
+    p_shard->stop = 1;
+    pthread_mutex_unlock(&p_shard->lock);
+    eventfd_write(p_shard->wake_fd, 1);
+  }
+  for (i = 0; i < p_ctx->shard_count; i++) {
+    if (p_ctx->shards[i].thread_started) pthread_join(p_ctx->shards[i].thread, NULL);
+  }
+
+  // The shards have stopped: drop the references of peers never accepted, then close and free the rest here
+  while (p_ctx->p_accept_head) {
+    p_peer               = p_ctx->p_accept_head;
+    p_ctx->p_accept_head = p_peer->p_accept_next;
+    pthread_mutex_lock(&p_peer->p_shard->lock);
+    udp_server_peer_release(p_peer->p_shard, p_peer);
+    pthread_mutex_unlock(&p_peer->p_shard->lock);
+  }
+
+  for (i = 0; i < p_ctx->shard_count; i++) {
+    p_shard = &p_ctx->shards[i];
+
+    while (p_shard->p_oldest) udp_server_peer_close(p_shard, p_shard->p_oldest);
+    while (p_shard->p_close_requests) {
+      p_peer                    = p_shard->p_close_requests;
+      p_shard->p_close_requests = p_peer->p_close_next;
+      udp_server_peer_release(p_shard, p_peer);
+    }
+    while (p_shard->p_detached) {
+      p_peer              = p_shard->p_detached;
+      p_shard->p_detached = p_peer->p_next;
+      udp_server_peer_free(p_ctx, p_peer);
+    }
+
+    if (-1 != p_shard->socket_fd) close(p_shard->socket_fd);
+    if (-1 != p_shard->wake_fd) close(p_shard->wake_fd);
+    if (p_shard->buckets) {
+      ockam_memory_free(
+        p_ctx->p_memory, p_shard->buckets, ((size_t) 1 << p_shard->bucket_bits) * sizeof(*p_shard->buckets));
+    }
+    if (p_shard->buffers) {
+      ockam_memory_free(p_ctx->p_memory, p_shard->buffers, UDP_SERVER_BATCH * p_ctx->attributes.max_datagram_size);
+    }
+    pthread_mutex_destroy(&p_shard->lock);
+  }
+
+  pthread_cond_destroy(&p_ctx->acceptable);
+  pthread_mutex_destroy(&p_ctx->lock);
+
+  ockam_memory_free(p_ctx->p_memory, p_ctx, sizeof(udp_server_ctx_t));
+  p_transport->ctx = NULL;
+
+  return OCKAM_ERROR_NONE;
+}
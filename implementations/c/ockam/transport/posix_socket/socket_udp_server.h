@@ -0,0 +1,152 @@
+#ifndef socket_udp_server_h
+#define socket_udp_server_h
+
+#include <stdint.h>
+#include "ockam/io.h"
+#include "ockam/memory.h"
+#include "ockam/transport.h"
+
+/**
+ * Multi-peer UDP server transport for Linux.
+ *
+ * The transport binds one SO_REUSEPORT socket per shard to the same address and runs one thread per shard. The kernel
+ * picks the socket for each datagram from a hash of its source address, so every peer is always served by the same
+ * shard and shards share no state. Each shard demultiplexes its datagrams into peers through a hash table keyed by
+ * source address, or by a connection ID the application extracts from the datagram, which lets a peer keep its state
+ * when its address changes. A peer that moves may reach another shard though, where it starts out as a new peer.
+ * Connection IDs are not secret, so a datagram from a new address does not move the peer by itself: its datagram
+ * callback calls ockam_transport_udp_peer_address_confirm() once it has authenticated the datagram. In reader mode a
+ * peer is always answered at the address it first sent from.
+ *
+ * Datagrams are delivered in one of two ways:
+ *  - With a datagram callback, on the shard thread. This is the way to serve many peers.
+ *  - Without one, in reader mode, each new peer is handed out by ockam_transport_socket_udp_server_accept() with its
+ *    own reader and writer, like a connection. Up to queue_depth datagrams are queued per peer for its reader, newer
+ *    ones are dropped while the queue is full.
+ *
+ * A peer is closed when it sends nothing for idle_timeout_ms, when the shard needs room for a new peer beyond
+ * max_peers, on ockam_transport_udp_peer_close() or on ockam_transport_deinit(). A closed peer's writer fails and its
+ * reader returns TRANSPORT_ERROR_NOT_CONNECTED once the queue is empty.
+ */
+
+#define OCKAM_TRANSPORT_UDP_SERVER_MAX_THREADS 64
+
+typedef struct ockam_transport_udp_peer ockam_transport_udp_peer_t;
+
+/**
+ * @brief   Called on the shard thread when the first datagram from a new peer arrives, before it is delivered.
+ * @param   user_ctx        [in] - user_ctx from the transport attributes.
+ * @param   peer            [in] - The new peer.
+ * @param   remote_address  [in] - Address of the peer.
+ * @return  OCKAM_ERROR_NONE to keep the peer, any other value drops the datagram and closes the peer.
+ */
+typedef ockam_error_t (*ockam_transport_udp_accept_cb)(void*                       user_ctx,
+                                                       ockam_transport_udp_peer_t* peer,
+                                                       ockam_ip_address_t*         remote_address);
+
+/**
+ * @brief   Called on the shard thread for every datagram received from a peer.
+ * @param   user_ctx    [in] - user_ctx from the transport attributes.
+ * @param   peer        [in] - Peer the datagram came from.
+ * @param   datagram    [in] - Datagram, valid only for the duration of the call.
+ * @param   length      [in] - Length of the datagram.
+ * @return  OCKAM_ERROR_NONE to keep the peer, any other value closes it.
+ */
+typedef ockam_error_t (*ockam_transport_udp_datagram_cb)(void*                       user_ctx,
+                                                         ockam_transport_udp_peer_t* peer,
+                                                         uint8_t*                    datagram,
+                                                         size_t                      length);
+
+/**
+ * @brief   Called once a peer is closed, on the shard thread or, for peers still open then, on the thread calling
+ *          ockam_transport_deinit.
+ */
+typedef void (*ockam_transport_udp_close_cb)(void* user_ctx, ockam_transport_udp_peer_t* peer);
+
+/**
+ * @brief   Extract the connection ID a datagram belongs to.
+ * @return  OCKAM_ERROR_NONE with p_connection_id set, any other value drops the datagram.
+ */
+typedef ockam_error_t (*ockam_transport_udp_connection_id_cb)(void*          user_ctx,
+                                                              const uint8_t* datagram,
+                                                              size_t         length,
+                                                              uint64_t*      p_connection_id);
+
+typedef struct ockam_transport_socket_udp_server_attributes {
+  ockam_ip_address_t                   listen_address;    /*!< Empty for dual-stack, port 0 picks one for all shards */
+  ockam_memory_t*                      p_memory;          /*!< Allocator for transport and peer state */
+  uint16_t                             thread_count;      /*!< Number of shards, 0 means one per online CPU */
+  size_t                               max_peers;         /*!< Peers per shard, 0 means 65536 */
+  uint32_t                             idle_timeout_ms;   /*!< Close peers silent for this long, 0 means never */
+  size_t                               max_datagram_size; /*!< Larger datagrams are dropped, 0 means 2048 */
+  size_t                               queue_depth;       /*!< Reader mode: datagrams queued per peer, 0 means 64 */
+  int                                  receive_buffer;    /*!< SO_RCVBUF of each shard socket, 0 keeps the default */
+  ockam_transport_udp_accept_cb        accept;            /*!< Optional */
+  ockam_transport_udp_datagram_cb      datagram;          /*!< Optional, NULL selects reader mode */
+  ockam_transport_udp_close_cb         close;             /*!< Optional */
+  ockam_transport_udp_connection_id_cb connection_id;     /*!< Optional, NULL demultiplexes by source address */
+  void*                                user_ctx;
+} ockam_transport_socket_udp_server_attributes_t;
+
+/**
+ * @brief   Bind the shard sockets and start the shard threads.
+ *
+ * In reader mode the transport's accept() returns the next new peer's reader and writer. Such a peer is only released
+ * by ockam_transport_deinit(), servers that run for long should use ockam_transport_socket_udp_server_accept() and
+ * release each peer when done. connect() is not supported: the kernel, not the transport, picks the shard that a
+ * peer's replies reach.
+ */
+ockam_error_t ockam_transport_socket_udp_server_init(ockam_transport_t*                              p_transport,
+                                                     ockam_transport_socket_udp_server_attributes_t* p_attributes);
+
+/**
+ * @brief   Reader mode: wait for the next new peer.
+ * @param   p_transport     [in]  - Transport initialized with ockam_transport_socket_udp_server_init.
+ * @param   pp_peer         [out] - The new peer, to be released with ockam_transport_udp_peer_close().
+ * @param   remote_address  [out] - Optional, address of the peer.
+ */
+ockam_error_t ockam_transport_socket_udp_server_accept(ockam_transport_t*           p_transport,
+                                                       ockam_transport_udp_peer_t** pp_peer,
+                                                       ockam_ip_address_t*          remote_address);
+
+/**
+ * @brief   Port the shard sockets are bound to, useful with a listen port of 0.
+ */
+uint16_t ockam_transport_socket_udp_server_port(ockam_transport_t* p_transport);
+
+/**
+ * @brief   Send one datagram to a peer.
+ *
+ * Safe to call from any thread until the peer's close callback has run, or for a peer returned by
+ * ockam_transport_socket_udp_server_accept() until it is released.
+ */
+ockam_error_t ockam_transport_udp_peer_write(ockam_transport_udp_peer_t* peer, uint8_t* buffer, size_t length);
+
+/**
+ * @brief   Writer for the peer that calls ockam_transport_udp_peer_write.
+ */
+ockam_writer_t* ockam_transport_udp_peer_writer(ockam_transport_udp_peer_t* peer);
+
+/**
+ * @brief   Reader mode: reader that returns the peer's queued datagrams one per read, waiting while none is queued.
+ */
+ockam_reader_t* ockam_transport_udp_peer_reader(ockam_transport_udp_peer_t* peer);
+
+/**
+ * @brief   Close the peer from any thread. This also releases a peer returned by
+ *          ockam_transport_socket_udp_server_accept(), which must not be used afterwards.
+ */
+ockam_error_t ockam_transport_udp_peer_close(ockam_transport_udp_peer_t* peer);
+
+/**
+ * @brief   Connection ID mode: answer the peer from now on at the address the current datagram came from.
+ *
+ * Only valid from the datagram callback, and only once the datagram is authenticated: anyone who sees a connection
+ * ID can send a datagram with it. Does nothing if the datagram came from the peer's current address.
+ */
+ockam_error_t ockam_transport_udp_peer_address_confirm(ockam_transport_udp_peer_t* peer);
+
+void  ockam_transport_udp_peer_set_context(ockam_transport_udp_peer_t* peer, void* context);
+void* ockam_transport_udp_peer_get_context(ockam_transport_udp_peer_t* peer);
+
+#endif
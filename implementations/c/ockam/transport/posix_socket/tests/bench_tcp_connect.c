@@ -0,0 +1,328 @@
+/**
+ * @file    bench_tcp_connect.c
+ * @brief   Outbound connect rate of the TCP transport, one blocking connect at a time and all at once from a connector
+ *
+ * A listener thread accepts on 127.0.0.1 and closes every connection it accepts. Each mode connects a fresh set of
+ * transports to it:
+ *  - blocking:  ockam_transport_connect, one transport after the other
+ *  - connector: every transport added to one ockam_transport_tcp_connector_t and driven from this thread
+ *  - polling:   the same, driven by runs that do not wait, as from the caller's own event loop
+ * Two more runs check the failure paths of the connector:
+ *  - backoff:   a closed port with BENCH_RETRIES retries must fail, no sooner than the shortest jittered backoffs
+ *  - timeout:   a listener that never accepts and whose queue is full must fail once BENCH_TIMEOUT_MS is up
+ *
+ * Usage: ockam_transport_posix_tcp_connect_bench [connections]
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "ockam/error.h"
+#include "ockam/io.h"
+#include "ockam/log.h"
+#include "ockam/memory.h"
+#include "ockam/memory/stdlib.h"
+#include "ockam/transport.h"
+#include "ockam/transport/socket_tcp.h"
+
+#define BENCH_DEFAULT_CONNECTIONS 256
+#define BENCH_PORT                8080
+#define BENCH_CLOSED_PORT         8081
+#define BENCH_FULL_PORT           8082
+#define BENCH_RETRIES             4
+#define BENCH_BACKOFF_MS          10
+#define BENCH_BACKOFF_MAX_MS      80
+#define BENCH_TIMEOUT_MS          100
+#define BENCH_QUEUE_FILL          8
+#define BENCH_POLL_LIMIT_NS       2000000000u
+
+typedef struct {
+  int          socket_fd;
+  volatile int stop;
+} bench_listener_t;
+
+typedef struct {
+  size_t        connected;
+  size_t        failed;
+  ockam_error_t error;
+} bench_result_t;
+
+uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+int bench_listen(uint16_t port, int backlog)
+{
+  struct sockaddr_in address = { 0 };
+  int                socket_fd;
+
+  address.sin_family      = AF_INET;
+  address.sin_port        = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  socket_fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (socket_fd < 0) return -1;
+  setsockopt(socket_fd, SOL_SOCKET, SO_REUSEADDR, &(int) { 1 }, sizeof(int));
+  if ((0 != bind(socket_fd, (struct sockaddr*) &address, sizeof(address))) || (0 != listen(socket_fd, backlog))) {
+    close(socket_fd);
+    return -1;
+  }
+  return socket_fd;
+}
+
+void* bench_accept(void* arg)
+{
+  bench_listener_t* p_listener = (bench_listener_t*) arg;
+  int               socket_fd;
+
+  while (!p_listener->stop) {
+    socket_fd = accept(p_listener->socket_fd, NULL, NULL);
+    if (socket_fd >= 0) close(socket_fd);
+  }
+  return NULL;
+}
+
+void bench_connected(void*              user_ctx,
+                     ockam_transport_t* p_transport,
+                     ockam_reader_t*    p_reader,
+                     ockam_writer_t*    p_writer,
+                     ockam_error_t      error)
+{
+  bench_result_t* p_result = (bench_result_t*) user_ctx;
+
+  (void) p_transport;
+  (void) p_reader;
+  (void) p_writer;
+  if (error) {
+    p_result->failed++;
+    p_result->error = error;
+  } else {
+    p_result->connected++;
+  }
+}
+
+ockam_error_t bench_transports(ockam_memory_t* p_memory, ockam_transport_t* transports, size_t count)
+{
+  ockam_error_t                       error      = OCKAM_ERROR_NONE;
+  ockam_transport_socket_attributes_t attributes = { 0 };
+  size_t                              i          = 0;
+
+  attributes.p_memory = p_memory;
+  for (i = 0; i < count; i++) {
+    error = ockam_transport_socket_tcp_init(&transports[i], &attributes);
+    if (error) break;
+  }
+  return error;
+}
+
+void bench_deinit(ockam_transport_t* transports, size_t count)
+{
+  size_t i = 0;
+
+  for (i = 0; i < count; i++) {
+    if (transports[i].ctx) ockam_transport_deinit(&transports[i]);
+  }
+  memset(transports, 0, count * sizeof(*transports));
+}
+
+/**
+ * @brief   Connect count transports through one connector and time it. With a wait_ms of 0 the connector is run
+ *          without waiting, a millisecond apart, until no connect is pending or BENCH_POLL_LIMIT_NS is up.
+ */
+ockam_error_t bench_connector(ockam_memory_t*                           p_memory,
+                              ockam_transport_t*                        transports,
+                              size_t                                    count,
+                              uint16_t                                  port,
+                              int32_t                                   wait_ms,
+                              ockam_transport_tcp_connect_attributes_t* p_attributes,
+                              bench_result_t*                           p_result,
+                              uint64_t*                                 p_elapsed_ns)
+{
+  ockam_error_t                    error       = OCKAM_ERROR_NONE;
+  ockam_transport_tcp_connector_t* p_connector = NULL;
+  ockam_ip_address_t               address     = { "", "127.0.0.1", port };
+  size_t                           pending     = 0;
+  size_t                           i           = 0;
+  uint64_t                         start       = 0;
+
+  memset(p_result, 0, sizeof(*p_result));
+  error = bench_transports(p_memory, transports, count);
+  if (error) goto exit;
+
+  start = bench_now_ns();
+  error = ockam_transport_tcp_connector_init(&p_connector, p_memory);
+  if (error) goto exit;
+  for (i = 0; i < count; i++) {
+    error = ockam_transport_tcp_connector_add(
+      p_connector, &transports[i], &address, p_attributes, bench_connected, p_result);
+    if (error) goto exit;
+  }
+  error = ockam_transport_tcp_connector_run(p_connector, wait_ms, &pending);
+  while (!error && pending && (bench_now_ns() - start < BENCH_POLL_LIMIT_NS)) {
+    usleep(1000);
+    error = ockam_transport_tcp_connector_run(p_connector, wait_ms, &pending);
+  }
+  if (error) goto exit;
+  *p_elapsed_ns = bench_now_ns() - start;
+
+  if (pending || (p_result->connected + p_result->failed != count)) error = TRANSPORT_ERROR_TEST;
+
+exit:
+  if (p_connector) ockam_transport_tcp_connector_deinit(p_connector);
+  bench_deinit(transports, count);
+  return error;
+}
+
+ockam_error_t
+bench_blocking(ockam_memory_t* p_memory, ockam_transport_t* transports, size_t count, uint64_t* p_elapsed_ns)
+{
+  ockam_error_t      error    = OCKAM_ERROR_NONE;
+  ockam_ip_address_t address  = { "", "127.0.0.1", BENCH_PORT };
+  ockam_reader_t*    p_reader = NULL;
+  ockam_writer_t*    p_writer = NULL;
+  size_t             i        = 0;
+  uint64_t           start    = 0;
+
+  error = bench_transports(p_memory, transports, count);
+  if (error) goto exit;
+
+  start = bench_now_ns();
+  for (i = 0; i < count; i++) {
+    error = ockam_transport_connect(&transports[i], &p_reader, &p_writer, &address, 0, 0);
+    if (error) goto exit;
+  }
+  *p_elapsed_ns = bench_now_ns() - start;
+
+exit:
+  bench_deinit(transports, count);
+  return error;
+}
+
+int main(int argc, char* argv[])
+{
+  ockam_memory_t                           memory         = { 0 };
+  ockam_transport_t*                       transports     = NULL;
+  ockam_transport_tcp_connect_attributes_t attributes     = { 0 };
+  bench_listener_t                         listener       = { -1, 0 };
+  bench_result_t                           result         = { 0 };
+  pthread_t                                thread;
+  int                                      thread_started = 0;
+  int                                      full_fd        = -1;
+  int                                      fill_fds[BENCH_QUEUE_FILL];
+  struct sockaddr_in                       full_address   = { 0 };
+  size_t                                   connections    = BENCH_DEFAULT_CONNECTIONS;
+  size_t                                   i              = 0;
+  uint64_t                                 elapsed        = 0;
+  int                                      rc             = 0;
+  ockam_error_t                            error          = OCKAM_ERROR_NONE;
+
+  if (argc > 1) connections = strtoul(argv[1], NULL, 10);
+  if (!connections) connections = BENCH_DEFAULT_CONNECTIONS;
+  for (i = 0; i < BENCH_QUEUE_FILL; i++) fill_fds[i] = -1;
+
+  ockam_memory_stdlib_init(&memory);
+  ockam_log_set_level(OCKAM_LOG_LEVEL_FATAL); /* The failure paths log every failed connect */
+
+  transports         = calloc(connections, sizeof(*transports));
+  listener.socket_fd = bench_listen(BENCH_PORT, SOMAXCONN);
+  if ((NULL == transports) || (listener.socket_fd < 0)) {
+    printf("setup failed\n");
+    rc = -1;
+    goto exit;
+  }
+  if (pthread_create(&thread, NULL, bench_accept, &listener)) {
+    printf("setup failed\n");
+    rc = -1;
+    goto exit;
+  }
+  thread_started = 1;
+
+  printf("%zu connections over loopback\n", connections);
+  printf("%-10s %14s %12s\n", "mode", "connects/s", "ms");
+
+  error = bench_blocking(&memory, transports, connections, &elapsed);
+  if (error) {
+    printf("%-10s failed (%x)\n", "blocking", error);
+    rc = -1;
+  } else {
+    printf("%-10s %14.0f %12.1f\n", "blocking", (double) connections / ((double) elapsed / 1e9), elapsed / 1e6);
+  }
+
+  error = bench_connector(&memory, transports, connections, BENCH_PORT, -1, NULL, &result, &elapsed);
+  if (error || result.failed) {
+    printf("%-10s failed (%x), %zu of %zu connected\n", "connector", error, result.connected, connections);
+    rc = -1;
+  } else {
+    printf("%-10s %14.0f %12.1f\n", "connector", (double) connections / ((double) elapsed / 1e9), elapsed / 1e6);
+  }
+
+  error = bench_connector(&memory, transports, connections, BENCH_PORT, 0, NULL, &result, &elapsed);
+  if (error || result.failed) {
+    printf("%-10s failed (%x), %zu of %zu connected\n", "polling", error, result.connected, connections);
+    rc = -1;
+  } else {
+    printf("%-10s %14.0f %12.1f\n", "polling", (double) connections / ((double) elapsed / 1e9), elapsed / 1e6);
+  }
+
+  /* Each backoff waits at least half its length: 5 + 10 + 20 + 40 ms before the last attempt */
+  attributes.backoff_initial_ms = BENCH_BACKOFF_MS;
+  attributes.backoff_max_ms     = BENCH_BACKOFF_MAX_MS;
+  attributes.retry_count        = BENCH_RETRIES;
+  error = bench_connector(&memory, transports, 1, BENCH_CLOSED_PORT, -1, &attributes, &result, &elapsed);
+  if (error || (TRANSPORT_ERROR_CONNECT != result.error) || (elapsed < 75000000u) || (elapsed > 1000000000u)) {
+    printf("%-10s failed (%x), %.1f ms\n", "backoff", error ? error : result.error, (double) elapsed / 1e6);
+    rc = -1;
+  } else {
+    printf("%-10s %14s %12.1f\n", "backoff", "-", (double) elapsed / 1e6);
+  }
+
+  /* Connects that fill the accept queue of a listener that never accepts, the next SYN is dropped */
+  full_fd                      = bench_listen(BENCH_FULL_PORT, 0);
+  full_address.sin_family      = AF_INET;
+  full_address.sin_port        = htons(BENCH_FULL_PORT);
+  full_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  for (i = 0; (full_fd >= 0) && (i < BENCH_QUEUE_FILL); i++) {
+    fill_fds[i] = socket(AF_INET, SOCK_STREAM, 0);
+    if (fill_fds[i] < 0) break;
+    fcntl(fill_fds[i], F_SETFL, O_NONBLOCK);
+    connect(fill_fds[i], (struct sockaddr*) &full_address, sizeof(full_address));
+  }
+  usleep(100000);
+
+  memset(&attributes, 0, sizeof(attributes));
+  attributes.timeout_ms = BENCH_TIMEOUT_MS;
+  error = bench_connector(&memory, transports, 1, BENCH_FULL_PORT, -1, &attributes, &result, &elapsed);
+  if ((full_fd < 0) || error || (TRANSPORT_ERROR_CONNECT != result.error) ||
+      (elapsed < BENCH_TIMEOUT_MS * 1000000u) || (elapsed > 2000000000u)) {
+    printf("%-10s failed (%x), %.1f ms\n", "timeout", error ? error : result.error, (double) elapsed / 1e6);
+    rc = -1;
+  } else {
+    printf("%-10s %14s %12.1f\n", "timeout", "-", (double) elapsed / 1e6);
+  }
+
+exit:
+  for (i = 0; i < BENCH_QUEUE_FILL; i++) {
+    if (fill_fds[i] >= 0) close(fill_fds[i]);
+  }
+  if (full_fd >= 0) close(full_fd);
+  if (thread_started) {
+    listener.stop = 1;
+    shutdown(listener.socket_fd, SHUT_RDWR);
+    pthread_join(thread, NULL);
+  }
+  if (listener.socket_fd >= 0) close(listener.socket_fd);
+  free(transports);
+  return rc;
+}
@@ -0,0 +1,279 @@
+/**
+ * @file    bench_tcp_epoll.c
+ * @brief   Loopback benchmark for the epoll TCP transport
+ *
+ * Opens many concurrent client connections to an echo server. Both ends use the epoll transport with a small number
+ * of loop threads. Each client keeps one message in flight: it sends a frame, waits for the echo, checks it, and sends
+ * the next. The benchmark reports connection setup rate, round trips per second and round-trip latency percentiles.
+ * It then checks that a frame larger than the clients' max_pending_write is refused rather than partly sent.
+ *
+ * Usage: ockam_transport_posix_tcp_epoll_bench [clients] [messages_per_client] [threads] [message_size]
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include "ockam/error.h"
+#include "ockam/log.h"
+#include "ockam/memory.h"
+#include "ockam/memory/stdlib.h"
+#include "ockam/transport.h"
+#include "ockam/transport/socket_tcp_epoll.h"
+
+#define BENCH_DEFAULT_CLIENTS  1000
+#define BENCH_DEFAULT_MESSAGES 100
+#define BENCH_DEFAULT_THREADS  2
+#define BENCH_DEFAULT_SIZE     64
+#define BENCH_MAX_SIZE         1024
+#define BENCH_BUCKETS          40
+#define BENCH_SERVER_PORT      8043
+#define BENCH_TIMEOUT_SECONDS  120
+#define BENCH_MAX_PENDING      (128u * 1024u)
+
+typedef struct {
+  size_t                            index;
+  size_t                            sent;
+  size_t                            received;
+  uint64_t                          sent_ns;
+  ockam_transport_tcp_connection_t* connection;
+} bench_client_t;
+
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t  done;
+  size_t          finished;
+  size_t          failed;
+  size_t          accepted;
+  size_t          messages;
+  size_t          message_size;
+  uint64_t        histogram[BENCH_BUCKETS];
+} bench_state_t;
+
+bench_state_t g_bench = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+void bench_fill(uint8_t* message, size_t size, size_t client, size_t sequence)
+{
+  size_t i;
+  for (i = 0; i < size; i++) message[i] = (uint8_t)(client * 131u + sequence * 17u + i);
+}
+
+ockam_error_t bench_send(bench_client_t* p_client)
+{
+  uint8_t message[BENCH_MAX_SIZE];
+
+  bench_fill(message, g_bench.message_size, p_client->index, p_client->sent);
+  p_client->sent_ns = bench_now_ns();
+  p_client->sent++;
+  return ockam_transport_tcp_connection_write(p_client->connection, message, g_bench.message_size);
+}
+
+void bench_finish(int failed)
+{
+  pthread_mutex_lock(&g_bench.lock);
+  g_bench.finished++;
+  if (failed) g_bench.failed++;
+  pthread_cond_signal(&g_bench.done);
+  pthread_mutex_unlock(&g_bench.lock);
+}
+
+ockam_error_t bench_server_accept(void* user_ctx, ockam_transport_tcp_connection_t* connection, ockam_ip_address_t* a)
+{
+  pthread_mutex_lock(&g_bench.lock);
+  g_bench.accepted++;
+  pthread_mutex_unlock(&g_bench.lock);
+  return OCKAM_ERROR_NONE;
+}
+
+ockam_error_t
+bench_server_frame(void* user_ctx, ockam_transport_tcp_connection_t* connection, uint8_t* frame, size_t length)
+{
+  return ockam_transport_tcp_connection_write(connection, frame, length);
+}
+
+ockam_error_t
+bench_client_frame(void* user_ctx, ockam_transport_tcp_connection_t* connection, uint8_t* frame, size_t length)
+{
+  ockam_error_t   error    = OCKAM_ERROR_NONE;
+  bench_client_t* p_client = (bench_client_t*) ockam_transport_tcp_connection_get_context(connection);
+  uint8_t         expected[BENCH_MAX_SIZE];
+  uint64_t        elapsed = bench_now_ns() - p_client->sent_ns;
+  size_t          bucket  = 0;
+
+  while ((elapsed >>= 1) && (bucket < BENCH_BUCKETS - 1)) bucket++;
+
+  bench_fill(expected, g_bench.message_size, p_client->index, p_client->received);
+  p_client->received++;
+
+  if ((length != g_bench.message_size) || (0 != memcmp(frame, expected, length))) {
+    ockam_log_error("client %zu received a corrupt echo", p_client->index);
+    bench_finish(1);
+    error = TRANSPORT_ERROR_TEST;
+    goto exit;
+  }
+
+  pthread_mutex_lock(&g_bench.lock);
+  g_bench.histogram[bucket]++;
+  pthread_mutex_unlock(&g_bench.lock);
+
+  if (p_client->sent < g_bench.messages) {
+    error = bench_send(p_client);
+    if (error) bench_finish(1);
+  } else {
+    bench_finish(0);
+  }
+
+exit:
+  return error;
+}
+
+uint64_t bench_percentile(uint64_t total, double percentile)
+{
+  uint64_t target = (uint64_t)(total * percentile);
+  uint64_t seen   = 0;
+  size_t   bucket = 0;
+
+  for (bucket = 0; bucket < BENCH_BUCKETS; bucket++) {
+    seen += g_bench.histogram[bucket];
+    if (seen > target) break;
+  }
+
+  return ((uint64_t) 1 << (bucket + 1)) / 1000u;
+}
+
+int main(int argc, char* argv[])
+{
+  ockam_error_t                                 error            = OCKAM_ERROR_NONE;
+  ockam_memory_t                                memory           = { 0 };
+  ockam_transport_t                             server           = { 0 };
+  ockam_transport_t                             client           = { 0 };
+  ockam_transport_socket_tcp_epoll_attributes_t server_attributes = { 0 };
+  ockam_transport_socket_tcp_epoll_attributes_t client_attributes = { 0 };
+  ockam_ip_address_t                            server_address   = { "", "127.0.0.1", BENCH_SERVER_PORT };
+  bench_client_t*                               clients          = NULL;
+  uint8_t*                                      oversized        = NULL;
+  struct rlimit                                 limit            = { 0 };
+  struct timespec                               deadline         = { 0 };
+  size_t                                        client_count     = BENCH_DEFAULT_CLIENTS;
+  size_t                                        threads          = BENCH_DEFAULT_THREADS;
+  size_t                                        i                = 0;
+  uint64_t                                      start            = 0;
+  uint64_t                                      connected        = 0;
+  uint64_t                                      finished         = 0;
+  uint64_t                                      total            = 0;
+  ockam_error_t                                 oversized_error  = OCKAM_ERROR_NONE;
+  int                                           ret_error        = -1;
+
+  g_bench.messages     = BENCH_DEFAULT_MESSAGES;
+  g_bench.message_size = BENCH_DEFAULT_SIZE;
+  if (argc > 1) client_count = strtoul(argv[1], NULL, 10);
+  if (argc > 2) g_bench.messages = strtoul(argv[2], NULL, 10);
+  if (argc > 3) threads = strtoul(argv[3], NULL, 10);
+  if (argc > 4) g_bench.message_size = strtoul(argv[4], NULL, 10);
+  if ((0 == client_count) || (0 == g_bench.messages) || (0 == threads) || (0 == g_bench.message_size) ||
+      (g_bench.message_size > BENCH_MAX_SIZE)) {
+    printf("Usage: %s [clients] [messages_per_client] [threads] [message_size <= %u]\n", argv[0], BENCH_MAX_SIZE);
+    goto exit;
+  }
+
+  // Each client needs two descriptors, one per end of the loopback connection
+  if (0 == getrlimit(RLIMIT_NOFILE, &limit)) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+    if (limit.rlim_cur < 2 * client_count + 64) {
+      printf("Descriptor limit %llu is too low for %zu clients\n", (unsigned long long) limit.rlim_cur, client_count);
+      goto exit;
+    }
+  }
+
+  error = ockam_memory_stdlib_init(&memory);
+  if (error) goto exit;
+
+  clients = calloc(client_count, sizeof(bench_client_t));
+  if (NULL == clients) goto exit;
+
+  server_attributes.listen_address = server_address;
+  server_attributes.p_memory       = &memory;
+  server_attributes.thread_count   = threads;
+  server_attributes.accept         = bench_server_accept;
+  server_attributes.frame          = bench_server_frame;
+  error                            = ockam_transport_socket_tcp_epoll_init(&server, &server_attributes);
+  if (error) goto exit;
+
+  client_attributes.p_memory          = &memory;
+  client_attributes.thread_count      = threads;
+  client_attributes.max_pending_write = BENCH_MAX_PENDING;
+  client_attributes.frame             = bench_client_frame;
+  error                               = ockam_transport_socket_tcp_epoll_init(&client, &client_attributes);
+  if (error) goto exit;
+
+  start = bench_now_ns();
+  for (i = 0; i < client_count; i++) {
+    clients[i].index = i;
+    error            = ockam_transport_socket_tcp_epoll_connect(&client, &server_address, &clients[i].connection);
+    if (error) goto exit;
+    ockam_transport_tcp_connection_set_context(clients[i].connection, &clients[i]);
+  }
+  connected = bench_now_ns();
+
+  // The loops may already be running callbacks for earlier clients, so only the first send happens from here
+  for (i = 0; i < client_count; i++) {
+    error = bench_send(&clients[i]);
+    if (error) goto exit;
+  }
+
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_sec += BENCH_TIMEOUT_SECONDS;
+  pthread_mutex_lock(&g_bench.lock);
+  while (g_bench.finished < client_count) {
+    if (0 != pthread_cond_timedwait(&g_bench.done, &g_bench.lock, &deadline)) break;
+  }
+  pthread_mutex_unlock(&g_bench.lock);
+  finished = bench_now_ns();
+
+  for (i = 0; i < BENCH_BUCKETS; i++) total += g_bench.histogram[i];
+
+  printf("%zu clients, %zu loop threads, %zu messages of %zu bytes each\n",
+         client_count,
+         threads,
+         g_bench.messages,
+         g_bench.message_size);
+  printf("connect:    %.0f connections/s (%zu accepted)\n",
+         (double) client_count / ((double) (connected - start) / 1e9),
+         g_bench.accepted);
+  printf("round trip: %.0f messages/s, p50 %llu us, p99 %llu us, p99.9 %llu us\n",
+         (double) total / ((double) (finished - connected) / 1e9),
+         (unsigned long long) bench_percentile(total, 0.5),
+         (unsigned long long) bench_percentile(total, 0.99),
+         (unsigned long long) bench_percentile(total, 0.999));
+  printf("%zu clients finished, %zu failed\n", g_bench.finished, g_bench.failed);
+
+  // Nothing is queued on a finished client, a direct send would take part of the frame before the limit applied
+  oversized = calloc(1, BENCH_MAX_PENDING);
+  if (NULL == oversized) goto exit;
+  oversized_error = ockam_transport_tcp_connection_write(clients[0].connection, oversized, BENCH_MAX_PENDING);
+  printf("pending limit: a frame over max_pending_write was %s\n",
+         TRANSPORT_ERROR_WOULD_BLOCK == oversized_error ? "refused" : "accepted");
+
+  if ((g_bench.finished == client_count) && (0 == g_bench.failed) && (TRANSPORT_ERROR_WOULD_BLOCK == oversized_error)) {
+    ret_error = 0;
+  }
+
+exit:
+  if (client.ctx) ockam_transport_deinit(&client);
+  if (server.ctx) ockam_transport_deinit(&server);
+  free(oversized);
+  free(clients);
+  return ret_error;
+}
@@ -0,0 +1,237 @@
+/**
+ * @file    bench_udp_batch.c
+ * @brief   Loopback packets-per-second benchmark for the UDP transport, one datagram per call and batched
+ *
+ * A sender pushes a fixed number of equal-sized datagrams to a receiver on another thread over 127.0.0.1. Each mode
+ * sets up a fresh pair of transports:
+ *  - single:  ockam_write / ockam_read, one sendto / recvfrom per datagram
+ *  - batch:   the batch API, up to OCKAM_TRANSPORT_UDP_BATCH_MAX datagrams per sendmmsg / recvmmsg
+ *  - offload: the batch API with UDP GSO on the sender and GRO on the receiver, where the kernel has them
+ * The sender binds the dual-stack wildcard and the batch modes address every datagram to the receiver's IPv4 address,
+ * which the transport maps to the sender's family. UDP may drop datagrams when the receiver falls behind, so the
+ * receiver stops once the sender is done and nothing has arrived for BENCH_IDLE_MS; the loss is reported next to the
+ * rates.
+ *
+ * Usage: ockam_transport_posix_udp_batch_bench [datagrams] [datagram_size]
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include "ockam/error.h"
+#include "ockam/io.h"
+#include "ockam/log.h"
+#include "ockam/memory.h"
+#include "ockam/memory/stdlib.h"
+#include "ockam/transport.h"
+#include "ockam/transport/socket_udp.h"
+
+#define BENCH_DEFAULT_DATAGRAMS 1000000
+#define BENCH_DEFAULT_SIZE      64
+#define BENCH_MAX_SIZE          1472
+#define BENCH_PORT              8050
+#define BENCH_IDLE_MS           200
+#define BENCH_RCVBUF            (8 * 1024 * 1024)
+
+typedef enum { BENCH_SINGLE = 0, BENCH_BATCH, BENCH_OFFLOAD, BENCH_MODES } bench_mode_t;
+
+static const char* g_mode_names[BENCH_MODES] = { "single", "batch", "offload" };
+
+typedef struct {
+  bench_mode_t    mode;
+  ockam_reader_t* p_reader;
+  int             socket_fd;
+  size_t          datagrams;
+  size_t          size;
+  volatile int    sender_done;
+  size_t          received;
+  size_t          bad;
+  uint64_t        first_ns;
+  uint64_t        last_ns;
+} bench_receiver_t;
+
+uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+void* bench_receive(void* arg)
+{
+  bench_receiver_t*             p_rx = (bench_receiver_t*) arg;
+  ockam_transport_udp_message_t messages[OCKAM_TRANSPORT_UDP_BATCH_MAX];
+  uint8_t                       buffers[OCKAM_TRANSPORT_UDP_BATCH_MAX][BENCH_MAX_SIZE];
+  size_t                        count = 0;
+  size_t                        i     = 0;
+  ockam_error_t                 error = OCKAM_ERROR_NONE;
+
+  for (i = 0; i < OCKAM_TRANSPORT_UDP_BATCH_MAX; i++) {
+    messages[i].buffer = buffers[i];
+    messages[i].size   = sizeof(buffers[i]);
+  }
+
+  while (p_rx->received < p_rx->datagrams) {
+    if (BENCH_SINGLE == p_rx->mode) {
+      error = ockam_read(p_rx->p_reader, buffers[0], sizeof(buffers[0]), &messages[0].length);
+      count = 1;
+    } else {
+      error = ockam_transport_socket_udp_read_batch(p_rx->p_reader, messages, OCKAM_TRANSPORT_UDP_BATCH_MAX, &count);
+    }
+
+    if (error) {
+      /* The receive timeout ends the run once the sender is done, anything else is a failure */
+      if (p_rx->sender_done) break;
+      continue;
+    }
+
+    if (!p_rx->received) p_rx->first_ns = bench_now_ns();
+    p_rx->last_ns = bench_now_ns();
+    for (i = 0; i < count; i++) {
+      if (messages[i].length != p_rx->size) p_rx->bad++;
+    }
+    p_rx->received += count;
+  }
+
+  return NULL;
+}
+
+ockam_error_t
+bench_transport(ockam_memory_t* p_memory, ockam_transport_t* p_transport, const char* ip, uint16_t port, int offload)
+{
+  ockam_transport_socket_attributes_t attributes = { 0 };
+
+  snprintf((char*) attributes.listen_address.ip_address, sizeof(attributes.listen_address.ip_address), "%s", ip);
+  attributes.listen_address.port = port;
+
+  attributes.p_memory = p_memory;
+  attributes.udp_gso  = offload;
+  attributes.udp_gro  = offload;
+  return ockam_transport_socket_udp_init(p_transport, &attributes);
+}
+
+ockam_error_t bench_run(ockam_memory_t* p_memory, bench_mode_t mode, uint16_t port, size_t datagrams, size_t size)
+{
+  ockam_error_t                 error            = OCKAM_ERROR_NONE;
+  ockam_transport_t             rx_transport     = { 0 };
+  ockam_transport_t             tx_transport     = { 0 };
+  ockam_ip_address_t            receiver_address = { "", "127.0.0.1", port };
+  ockam_writer_t*               p_writer         = NULL;
+  bench_receiver_t              receiver         = { 0 };
+  pthread_t                     thread;
+  int                           thread_started = 0;
+  ockam_transport_udp_message_t messages[OCKAM_TRANSPORT_UDP_BATCH_MAX];
+  struct sockaddr_in            destination = { .sin_family = AF_INET, .sin_port = htons(port) };
+  uint8_t                       datagram[BENCH_MAX_SIZE];
+  struct timeval                timeout = { 0, BENCH_IDLE_MS * 1000 };
+  size_t                        sent    = 0;
+  size_t                        count   = 0;
+  size_t                        i       = 0;
+  uint64_t                      start   = 0;
+  uint64_t                      end     = 0;
+
+  error = bench_transport(p_memory, &rx_transport, "127.0.0.1", port, BENCH_OFFLOAD == mode);
+  if (error) goto exit;
+  error = bench_transport(p_memory, &tx_transport, "", port + 1, BENCH_OFFLOAD == mode);
+  if (error) goto exit;
+
+  error = ockam_transport_accept(&rx_transport, &receiver.p_reader, NULL, NULL);
+  if (error) goto exit;
+  error = ockam_transport_connect(&tx_transport, NULL, &p_writer, &receiver_address, 0, 0);
+  if (error) goto exit;
+
+  receiver.socket_fd = ((socket_udp_ctx_t*) rx_transport.ctx)->posix_socket.socket_fd;
+  setsockopt(receiver.socket_fd, SOL_SOCKET, SO_RCVBUF, &(int) { BENCH_RCVBUF }, sizeof(int));
+  setsockopt(receiver.socket_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  receiver.mode      = mode;
+  receiver.datagrams = datagrams;
+  receiver.size      = size;
+  if (pthread_create(&thread, NULL, bench_receive, &receiver)) {
+    error = TRANSPORT_ERROR_TEST;
+    goto exit;
+  }
+  thread_started = 1;
+
+  for (i = 0; i < size; i++) datagram[i] = (uint8_t) i;
+  inet_pton(AF_INET, "127.0.0.1", &destination.sin_addr);
+  for (i = 0; i < OCKAM_TRANSPORT_UDP_BATCH_MAX; i++) {
+    memset(&messages[i], 0, sizeof(messages[i]));
+    messages[i].buffer = datagram;
+    messages[i].length = size;
+    memcpy(&messages[i].address, &destination, sizeof(destination));
+  }
+
+  start = bench_now_ns();
+  while (sent < datagrams) {
+    if (BENCH_SINGLE == mode) {
+      error = ockam_write(p_writer, datagram, size);
+      count = 1;
+    } else {
+      count = datagrams - sent;
+      if (count > OCKAM_TRANSPORT_UDP_BATCH_MAX) count = OCKAM_TRANSPORT_UDP_BATCH_MAX;
+      error = ockam_transport_socket_udp_write_batch(p_writer, messages, count, &count);
+    }
+    if (error) goto exit;
+    sent += count;
+  }
+  end = bench_now_ns();
+
+exit:
+  receiver.sender_done = 1;
+  if (thread_started) pthread_join(thread, NULL);
+
+  if (!error) {
+    printf("%-8s %10.0f %10.0f %9.2f%% %s\n",
+           g_mode_names[mode],
+           (double) sent / ((double) (end - start) / 1e9),
+           receiver.received > 1 ? (double) receiver.received / ((double) (receiver.last_ns - receiver.first_ns) / 1e9)
+                                 : 0.0,
+           100.0 * (double) (datagrams - receiver.received) / (double) datagrams,
+           receiver.bad ? "(bad lengths)" : "");
+    if (receiver.bad || !receiver.received) error = TRANSPORT_ERROR_TEST;
+  }
+
+  if (tx_transport.ctx) ockam_transport_deinit(&tx_transport);
+  if (rx_transport.ctx) ockam_transport_deinit(&rx_transport);
+  return error;
+}
+
+int main(int argc, char* argv[])
+{
+  ockam_memory_t memory    = { 0 };
+  size_t         datagrams = BENCH_DEFAULT_DATAGRAMS;
+  size_t         size      = BENCH_DEFAULT_SIZE;
+  int            mode      = 0;
+  int            rc        = 0;
+  ockam_error_t  error     = OCKAM_ERROR_NONE;
+
+  if (argc > 1) datagrams = strtoul(argv[1], NULL, 10);
+  if (argc > 2) size = strtoul(argv[2], NULL, 10);
+  if (!datagrams) datagrams = BENCH_DEFAULT_DATAGRAMS;
+  if (!size || size > BENCH_MAX_SIZE) size = BENCH_DEFAULT_SIZE;
+
+  ockam_memory_stdlib_init(&memory);
+  ockam_log_set_level(OCKAM_LOG_LEVEL_FATAL); /* Each run ends on a receive timeout */
+
+  printf("%zu datagrams of %zu bytes over loopback, datagrams/second\n", datagrams, size);
+  printf("%-8s %10s %10s %10s\n", "mode", "sent", "received", "lost");
+
+  for (mode = 0; mode < BENCH_MODES; mode++) {
+    error = bench_run(&memory, (bench_mode_t) mode, BENCH_PORT + 2 * mode, datagrams, size);
+    if (error) {
+      printf("%-8s failed (%x)\n", g_mode_names[mode], error);
+      rc = -1;
+    }
+  }
+
+  return rc;
+}
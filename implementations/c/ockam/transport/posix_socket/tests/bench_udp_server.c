@@ -0,0 +1,504 @@
+/**
+ * @file    bench_udp_server.c
+ * @brief   Echo rate of the multi-peer UDP server over loopback, and checks of its reader and connection ID modes
+ *
+ * Every peer is a client socket of its own. Client threads send one datagram per peer in turn, BENCH_WINDOW at a time
+ * and waiting for their echoes, for a number of rounds; the server echoes each datagram from its datagram callback.
+ * The run checks that every client socket became exactly one peer and that every echo came back intact.
+ *
+ * Two short checks follow. In reader mode a few peers are accepted and echoed through their reader and writer until
+ * the idle timeout closes them. With connection IDs each client sends from two sockets in turn, which the server must
+ * see as one peer that keeps moving. A datagram forged with a client's ID from a third socket must not move it.
+ *
+ * Usage: ockam_transport_posix_udp_server_bench [peers] [rounds] [threads]
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "ockam/error.h"
+#include "ockam/io.h"
+#include "ockam/log.h"
+#include "ockam/memory.h"
+#include "ockam/memory/stdlib.h"
+#include "ockam/transport.h"
+#include "ockam/transport/socket_udp_server.h"
+
+#define BENCH_DEFAULT_PEERS  1000
+#define BENCH_DEFAULT_ROUNDS 100
+#define BENCH_CLIENT_THREADS 4
+#define BENCH_WINDOW         256 /* Datagrams in flight per client thread, more overflow the server's socket */
+#define BENCH_TIMEOUT_MS     500
+#define BENCH_READER_PEERS   4
+#define BENCH_READER_ROUNDS  16
+#define BENCH_IDLE_MS        100
+#define BENCH_ID_CLIENTS     8
+#define BENCH_RCVBUF         (8 * 1024 * 1024)
+#define BENCH_FORGED         UINT32_MAX /* Round of a datagram that fails authentication */
+
+typedef struct {
+  uint32_t peer;
+  uint32_t round;
+} bench_datagram_t;
+
+typedef struct {
+  uint16_t port;
+  int*     sockets;
+  size_t   first;
+  size_t   count;
+  size_t   rounds;
+  size_t   echoed;
+  size_t   bad;
+} bench_client_t;
+
+typedef struct {
+  ockam_transport_t* p_transport;
+  pthread_mutex_t    lock;
+  size_t             accepted;
+  size_t             closed;
+  size_t             echoed;
+} bench_server_t;
+
+uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+int bench_client_socket(void)
+{
+  struct sockaddr_in address = { 0 };
+  struct timeval     timeout = { 0, BENCH_TIMEOUT_MS * 1000 };
+  int                fd      = socket(AF_INET, SOCK_DGRAM, 0);
+
+  if (-1 == fd) return -1;
+  address.sin_family      = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &(int) { 1024 * 1024 }, sizeof(int));
+  if (0 != bind(fd, (struct sockaddr*) &address, sizeof(address))) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+ssize_t bench_send(int fd, uint16_t port, void* buffer, size_t length)
+{
+  struct sockaddr_in address = { 0 };
+
+  address.sin_family      = AF_INET;
+  address.sin_port        = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  return sendto(fd, buffer, length, 0, (struct sockaddr*) &address, sizeof(address));
+}
+
+void* bench_client_run(void* arg)
+{
+  bench_client_t*  p_client = (bench_client_t*) arg;
+  bench_datagram_t datagram;
+  bench_datagram_t echo;
+  size_t           round = 0;
+  size_t           first = 0;
+  size_t           end   = 0;
+  size_t           i     = 0;
+
+  for (round = 0; round < p_client->rounds; round++) {
+    for (first = 0; first < p_client->count; first = end) {
+      end = (p_client->count - first > BENCH_WINDOW) ? first + BENCH_WINDOW : p_client->count;
+      for (i = first; i < end; i++) {
+        datagram.peer  = (uint32_t)(p_client->first + i);
+        datagram.round = (uint32_t) round;
+        bench_send(p_client->sockets[i], p_client->port, &datagram, sizeof(datagram));
+      }
+      for (i = first; i < end; i++) {
+        if (sizeof(echo) != recv(p_client->sockets[i], &echo, sizeof(echo), 0)) continue;
+        if ((echo.peer != p_client->first + i) || (echo.round != round)) {
+          p_client->bad++;
+          continue;
+        }
+        p_client->echoed++;
+      }
+    }
+  }
+
+  return NULL;
+}
+
+ockam_error_t bench_accept(void* user_ctx, ockam_transport_udp_peer_t* peer, ockam_ip_address_t* remote_address)
+{
+  bench_server_t* p_server = (bench_server_t*) user_ctx;
+
+  pthread_mutex_lock(&p_server->lock);
+  p_server->accepted++;
+  pthread_mutex_unlock(&p_server->lock);
+  return OCKAM_ERROR_NONE;
+}
+
+ockam_error_t bench_echo(void* user_ctx, ockam_transport_udp_peer_t* peer, uint8_t* datagram, size_t length)
+{
+  return ockam_transport_udp_peer_write(peer, datagram, length);
+}
+
+/*
+ * Connection ID mode: only authentic datagrams move the peer, forged ones are answered where the peer already is
+ */
+ockam_error_t bench_moving_echo(void* user_ctx, ockam_transport_udp_peer_t* peer, uint8_t* datagram, size_t length)
+{
+  bench_datagram_t header;
+
+  memcpy(&header, datagram, sizeof(header));
+  if (BENCH_FORGED != header.round) ockam_transport_udp_peer_address_confirm(peer);
+  return ockam_transport_udp_peer_write(peer, datagram, length);
+}
+
+void bench_close(void* user_ctx, ockam_transport_udp_peer_t* peer)
+{
+  bench_server_t* p_server = (bench_server_t*) user_ctx;
+
+  pthread_mutex_lock(&p_server->lock);
+  p_server->closed++;
+  pthread_mutex_unlock(&p_server->lock);
+}
+
+/*
+ * Callback mode: echo from the shard threads to many peers
+ */
+ockam_error_t bench_callback(ockam_memory_t* p_memory, size_t peers, size_t rounds, uint16_t threads)
+{
+  ockam_error_t                                  error      = OCKAM_ERROR_NONE;
+  ockam_transport_t                              transport  = { 0 };
+  ockam_transport_socket_udp_server_attributes_t attributes = { 0 };
+  bench_server_t                                 server     = { 0 };
+  bench_client_t                                 clients[BENCH_CLIENT_THREADS];
+  pthread_t                                      client_threads[BENCH_CLIENT_THREADS];
+  int*                                           sockets    = NULL;
+  size_t                                         echoed     = 0;
+  size_t                                         bad        = 0;
+  size_t                                         i          = 0;
+  uint64_t                                       start      = 0;
+  uint64_t                                       elapsed    = 0;
+
+  memcpy(attributes.listen_address.ip_address, "127.0.0.1", sizeof("127.0.0.1"));
+  pthread_mutex_init(&server.lock, NULL);
+
+  sockets = calloc(peers, sizeof(int));
+  if (NULL == sockets) {
+    error = TRANSPORT_ERROR_ALLOC;
+    goto exit;
+  }
+  for (i = 0; i < peers; i++) sockets[i] = -1;
+  for (i = 0; i < peers; i++) {
+    sockets[i] = bench_client_socket();
+    if (-1 == sockets[i]) {
+      printf("only %zu client sockets, raise the open file limit\n", i);
+      error = TRANSPORT_ERROR_SOCKET_CREATE;
+      goto exit;
+    }
+  }
+
+  attributes.p_memory       = p_memory;
+  attributes.thread_count   = threads;
+  attributes.receive_buffer = BENCH_RCVBUF;
+  attributes.accept         = bench_accept;
+  attributes.datagram       = bench_echo;
+  attributes.close          = bench_close;
+  attributes.user_ctx       = &server;
+  error                     = ockam_transport_socket_udp_server_init(&transport, &attributes);
+  if (error) goto exit;
+
+  for (i = 0; i < BENCH_CLIENT_THREADS; i++) {
+    memset(&clients[i], 0, sizeof(clients[i]));
+    clients[i].port    = ockam_transport_socket_udp_server_port(&transport);
+    clients[i].first   = peers * i / BENCH_CLIENT_THREADS;
+    clients[i].count   = peers * (i + 1) / BENCH_CLIENT_THREADS - clients[i].first;
+    clients[i].sockets = sockets + clients[i].first;
+    clients[i].rounds  = rounds;
+  }
+
+  start = bench_now_ns();
+  for (i = 0; i < BENCH_CLIENT_THREADS; i++) pthread_create(&client_threads[i], NULL, bench_client_run, &clients[i]);
+  for (i = 0; i < BENCH_CLIENT_THREADS; i++) pthread_join(client_threads[i], NULL);
+  elapsed = bench_now_ns() - start;
+
+  for (i = 0; i < BENCH_CLIENT_THREADS; i++) {
+    echoed += clients[i].echoed;
+    bad += clients[i].bad;
+  }
+
+  ockam_transport_deinit(&transport);
+
+  printf("callback %6zu peers %8zu echoes %10.0f echoes/s  %zu lost  %zu accepted  %zu closed\n",
+         peers,
+         echoed,
+         (double) echoed / ((double) elapsed / 1e9),
+         peers * rounds - echoed,
+         server.accepted,
+         server.closed);
+
+  // Loopback may drop a few datagrams under load, but every socket is one peer and nothing comes back wrong
+  if (bad || (server.accepted != peers) || (server.closed != peers) || (echoed < peers * rounds / 2)) {
+    error = TRANSPORT_ERROR_TEST;
+  }
+
+exit:
+  if (sockets) {
+    for (i = 0; i < peers; i++) {
+      if (-1 != sockets[i]) close(sockets[i]);
+    }
+    free(sockets);
+  }
+  pthread_mutex_destroy(&server.lock);
+  return error;
+}
+
+void* bench_reader_peer(void* arg)
+{
+  ockam_transport_udp_peer_t* p_peer = (ockam_transport_udp_peer_t*) arg;
+  bench_server_t*             p_server = (bench_server_t*) ockam_transport_udp_peer_get_context(p_peer);
+  uint8_t                     buffer[64];
+  size_t                      length = 0;
+
+  // Echo until the idle timeout closes the peer, then release it
+  while (OCKAM_ERROR_NONE == ockam_read(ockam_transport_udp_peer_reader(p_peer), buffer, sizeof(buffer), &length)) {
+    if (ockam_write(ockam_transport_udp_peer_writer(p_peer), buffer, length)) break;
+    pthread_mutex_lock(&p_server->lock);
+    p_server->echoed++;
+    pthread_mutex_unlock(&p_server->lock);
+  }
+  ockam_transport_udp_peer_close(p_peer);
+
+  return NULL;
+}
+
+/*
+ * Reader mode: accept peers and echo through their readers and writers
+ */
+ockam_error_t bench_reader(ockam_memory_t* p_memory)
+{
+  ockam_error_t                                  error      = OCKAM_ERROR_NONE;
+  ockam_transport_t                              transport  = { 0 };
+  ockam_transport_socket_udp_server_attributes_t attributes = { 0 };
+  bench_server_t                                 server     = { 0 };
+  ockam_transport_udp_peer_t*                    p_peer     = NULL;
+  pthread_t                                      threads[BENCH_READER_PEERS];
+  int                                            sockets[BENCH_READER_PEERS];
+  bench_datagram_t                               datagram   = { 0 };
+  size_t                                         echoed     = 0;
+  size_t                                         started    = 0;
+  size_t                                         round      = 0;
+  size_t                                         i          = 0;
+
+  memcpy(attributes.listen_address.ip_address, "127.0.0.1", sizeof("127.0.0.1"));
+  pthread_mutex_init(&server.lock, NULL);
+  for (i = 0; i < BENCH_READER_PEERS; i++) sockets[i] = -1;
+
+  attributes.p_memory        = p_memory;
+  attributes.thread_count    = 2;
+  attributes.idle_timeout_ms = BENCH_IDLE_MS;
+  attributes.close           = bench_close;
+  attributes.user_ctx        = &server;
+  error                      = ockam_transport_socket_udp_server_init(&transport, &attributes);
+  if (error) goto exit;
+
+  for (i = 0; i < BENCH_READER_PEERS; i++) {
+    sockets[i] = bench_client_socket();
+    if (-1 == sockets[i]) {
+      error = TRANSPORT_ERROR_SOCKET_CREATE;
+      goto exit;
+    }
+    bench_send(sockets[i], ockam_transport_socket_udp_server_port(&transport), &datagram, sizeof(datagram));
+
+    error = ockam_transport_socket_udp_server_accept(&transport, &p_peer, NULL);
+    if (error) goto exit;
+    ockam_transport_udp_peer_set_context(p_peer, &server);
+    pthread_create(&threads[started++], NULL, bench_reader_peer, p_peer);
+  }
+
+  for (round = 0; round < BENCH_READER_ROUNDS; round++) {
+    for (i = 0; i < BENCH_READER_PEERS; i++) {
+      bench_send(sockets[i], ockam_transport_socket_udp_server_port(&transport), &datagram, sizeof(datagram));
+    }
+    for (i = 0; i < BENCH_READER_PEERS; i++) {
+      if (sizeof(datagram) == recv(sockets[i], &datagram, sizeof(datagram), 0)) echoed++;
+    }
+  }
+
+exit:
+  // Once the clients go quiet the idle timeout closes every peer and its echo thread returns
+  for (i = 0; i < started; i++) pthread_join(threads[i], NULL);
+  if (transport.ctx) ockam_transport_deinit(&transport);
+  for (i = 0; i < BENCH_READER_PEERS; i++) {
+    if (-1 != sockets[i]) close(sockets[i]);
+  }
+
+  if (!error) {
+    printf(
+      "reader   %6d peers %8zu echoes  %zu closed by the idle timeout\n", BENCH_READER_PEERS, echoed, server.closed);
+    if ((server.closed != BENCH_READER_PEERS) || (echoed < BENCH_READER_PEERS * BENCH_READER_ROUNDS / 2)) {
+      error = TRANSPORT_ERROR_TEST;
+    }
+  }
+  pthread_mutex_destroy(&server.lock);
+  return error;
+}
+
+ockam_error_t bench_connection_id(void* user_ctx, const uint8_t* datagram, size_t length, uint64_t* p_connection_id)
+{
+  bench_datagram_t header;
+
+  if (length < sizeof(header)) return TRANSPORT_ERROR_BAD_PARAMETER;
+  memcpy(&header, datagram, sizeof(header));
+  *p_connection_id = header.peer;
+  return OCKAM_ERROR_NONE;
+}
+
+/*
+ * Connection IDs: each client alternates between two sockets and must stay one peer, answered where it last sent from
+ */
+ockam_error_t bench_moving(ockam_memory_t* p_memory)
+{
+  ockam_error_t                                  error      = OCKAM_ERROR_NONE;
+  ockam_transport_t                              transport  = { 0 };
+  ockam_transport_socket_udp_server_attributes_t attributes = { 0 };
+  bench_server_t                                 server     = { 0 };
+  int                                            sockets[BENCH_ID_CLIENTS][2];
+  int                                            socket_fd = -1;
+  int                                            forger_fd = -1;
+  bench_datagram_t                               datagram  = { 0 };
+  bench_datagram_t                               echo      = { 0 };
+  size_t                                         echoed    = 0;
+  size_t                                         hijacked  = 0;
+  size_t                                         round    = 0;
+  size_t                                         i        = 0;
+
+  memcpy(attributes.listen_address.ip_address, "127.0.0.1", sizeof("127.0.0.1"));
+  pthread_mutex_init(&server.lock, NULL);
+  memset(sockets, -1, sizeof(sockets));
+
+  // One shard: a moving peer could otherwise land on another shard's socket
+  attributes.p_memory      = p_memory;
+  attributes.thread_count  = 1;
+  attributes.accept        = bench_accept;
+  attributes.datagram      = bench_moving_echo;
+  attributes.connection_id = bench_connection_id;
+  attributes.user_ctx      = &server;
+  error                    = ockam_transport_socket_udp_server_init(&transport, &attributes);
+  if (error) goto exit;
+
+  for (i = 0; i < BENCH_ID_CLIENTS; i++) {
+    sockets[i][0] = bench_client_socket();
+    sockets[i][1] = bench_client_socket();
+    if ((-1 == sockets[i][0]) || (-1 == sockets[i][1])) {
+      error = TRANSPORT_ERROR_SOCKET_CREATE;
+      goto exit;
+    }
+  }
+  forger_fd = bench_client_socket();
+  if (-1 == forger_fd) {
+    error = TRANSPORT_ERROR_SOCKET_CREATE;
+    goto exit;
+  }
+
+  for (round = 0; round < BENCH_READER_ROUNDS; round++) {
+    for (i = 0; i < BENCH_ID_CLIENTS; i++) {
+      datagram.peer  = (uint32_t) i;
+      datagram.round = (uint32_t) round;
+      socket_fd      = sockets[i][round & 1u];
+      bench_send(socket_fd, ockam_transport_socket_udp_server_port(&transport), &datagram, sizeof(datagram));
+      if ((sizeof(echo) == recv(socket_fd, &echo, sizeof(echo), 0)) && (echo.peer == i) &&
+          (echo.round == round)) {
+        echoed++;
+      }
+    }
+  }
+
+  // The answer to a forged datagram goes to the socket each client last sent from, never to the forger
+  for (i = 0; i < BENCH_ID_CLIENTS; i++) {
+    datagram.peer  = (uint32_t) i;
+    datagram.round = BENCH_FORGED;
+    bench_send(forger_fd, ockam_transport_socket_udp_server_port(&transport), &datagram, sizeof(datagram));
+    if ((sizeof(echo) != recv(sockets[i][(round - 1) & 1u], &echo, sizeof(echo), 0)) || (echo.round != BENCH_FORGED)) {
+      hijacked++;
+    }
+  }
+  while (sizeof(echo) == recv(forger_fd, &echo, sizeof(echo), MSG_DONTWAIT)) hijacked++;
+
+exit:
+  if (transport.ctx) ockam_transport_deinit(&transport);
+  if (-1 != forger_fd) close(forger_fd);
+  for (i = 0; i < BENCH_ID_CLIENTS; i++) {
+    if (-1 != sockets[i][0]) close(sockets[i][0]);
+    if (-1 != sockets[i][1]) close(sockets[i][1]);
+  }
+
+  if (!error) {
+    printf("moving   %6d peers %8zu echoes  %zu accepted  %zu hijacked\n",
+           BENCH_ID_CLIENTS,
+           echoed,
+           server.accepted,
+           hijacked);
+    if ((server.accepted != BENCH_ID_CLIENTS) || (echoed != BENCH_ID_CLIENTS * BENCH_READER_ROUNDS) || hijacked) {
+      error = TRANSPORT_ERROR_TEST;
+    }
+  }
+  pthread_mutex_destroy(&server.lock);
+  return error;
+}
+
+int main(int argc, char* argv[])
+{
+  ockam_memory_t memory  = { 0 };
+  struct rlimit  files   = { 0 };
+  size_t         peers   = BENCH_DEFAULT_PEERS;
+  size_t         rounds  = BENCH_DEFAULT_ROUNDS;
+  uint16_t       threads = 0;
+  int            rc      = 0;
+  ockam_error_t  error   = OCKAM_ERROR_NONE;
+
+  if (argc > 1) peers = strtoul(argv[1], NULL, 10);
+  if (argc > 2) rounds = strtoul(argv[2], NULL, 10);
+  if (argc > 3) threads = (uint16_t) strtoul(argv[3], NULL, 10);
+  if (!peers) peers = BENCH_DEFAULT_PEERS;
+  if (!rounds) rounds = BENCH_DEFAULT_ROUNDS;
+
+  // One socket per peer
+  if (0 == getrlimit(RLIMIT_NOFILE, &files)) {
+    files.rlim_cur = files.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &files);
+  }
+
+  ockam_memory_stdlib_init(&memory);
+  ockam_log_set_level(OCKAM_LOG_LEVEL_FATAL); /* Reader mode peers end on TRANSPORT_ERROR_NOT_CONNECTED */
+
+  error = bench_callback(&memory, peers, rounds, threads);
+  if (error) {
+    printf("callback failed (%x)\n", error);
+    rc = -1;
+  }
+
+  error = bench_reader(&memory);
+  if (error) {
+    printf("reader   failed (%x)\n", error);
+    rc = -1;
+  }
+
+  error = bench_moving(&memory);
+  if (error) {
+    printf("moving   failed (%x)\n", error);
+    rc = -1;
+  }
+
+  return rc;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file    tcp_options_test.c
+ * @brief   Round trips through the TCP transport with tcp_cork and tcp_nodelay set
+ *
+ * An echo thread on 127.0.0.1 sends every byte it receives straight back. The transport connects to it with each
+ * combination of options and times TEST_ROUNDS small frames there and back. A corked socket that is not flushed after
+ * each frame holds the frame until the kernel's 200ms cork timer fires, so every round trip must beat TEST_LIMIT_MS.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "ockam/error.h"
+#include "ockam/io.h"
+#include "ockam/log.h"
+#include "ockam/memory.h"
+#include "ockam/memory/stdlib.h"
+#include "ockam/transport.h"
+#include "ockam/transport/socket_tcp.h"
+
+#define TEST_PORT     8084
+#define TEST_ROUNDS   20
+#define TEST_LIMIT_MS 100
+
+typedef struct {
+  uint8_t tcp_cork;
+  uint8_t tcp_nodelay;
+} test_options_t;
+
+uint64_t test_now_ms(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000u + (uint64_t) ts.tv_nsec / 1000000u;
+}
+
+void* test_echo(void* arg)
+{
+  int     listen_fd = *(int*) arg;
+  int     socket_fd = -1;
+  uint8_t buffer[256];
+  ssize_t length = 0;
+
+  // One connection per set of options, each echoed until the client closes it
+  for (;;) {
+    socket_fd = accept(listen_fd, NULL, NULL);
+    if (socket_fd < 0) break;
+    while ((length = recv(socket_fd, buffer, sizeof(buffer), 0)) > 0) send(socket_fd, buffer, length, MSG_NOSIGNAL);
+    close(socket_fd);
+  }
+  return NULL;
+}
+
+ockam_error_t test_round_trips(ockam_memory_t* p_memory, test_options_t* p_options, uint64_t* p_slowest_ms)
+{
+  ockam_error_t                       error      = OCKAM_ERROR_NONE;
+  ockam_transport_t                   transport  = { 0 };
+  ockam_transport_socket_attributes_t attributes = { 0 };
+  ockam_ip_address_t                  address    = { "", "127.0.0.1", TEST_PORT };
+  ockam_reader_t*                     p_reader   = NULL;
+  ockam_writer_t*                     p_writer   = NULL;
+  uint8_t                             frame[]    = "corked frame";
+  uint8_t                             echo[sizeof(frame)];
+  size_t                              length = 0;
+  uint64_t                            start  = 0;
+  int                                 i      = 0;
+
+  attributes.p_memory    = p_memory;
+  attributes.tcp_cork    = p_options->tcp_cork;
+  attributes.tcp_nodelay = p_options->tcp_nodelay;
+
+  error = ockam_transport_socket_tcp_init(&transport, &attributes);
+  if (error) goto exit;
+
+  error = ockam_transport_connect(&transport, &p_reader, &p_writer, &address, 0, 0);
+  if (error) goto exit;
+
+  *p_slowest_ms = 0;
+  for (i = 0; i < TEST_ROUNDS; i++) {
+    start = test_now_ms();
+    error = ockam_write(p_writer, frame, sizeof(frame));
+    if (error) goto exit;
+    error = ockam_read(p_reader, echo, sizeof(echo), &length);
+    if (error) goto exit;
+    if ((length != sizeof(frame)) || (0 != memcmp(echo, frame, length))) {
+      error = TRANSPORT_ERROR_RECEIVE;
+      goto exit;
+    }
+    if (test_now_ms() - start > *p_slowest_ms) *p_slowest_ms = test_now_ms() - start;
+  }
+
+exit:
+  if (transport.ctx) ockam_transport_deinit(&transport);
+  return error;
+}
+
+int main(void)
+{
+  ockam_memory_t     memory    = { 0 };
+  test_options_t     options[] = { { 1, 0 }, { 1, 1 }, { 0, 1 } };
+  struct sockaddr_in address   = { 0 };
+  pthread_t          thread;
+  int                listen_fd = -1;
+  uint64_t           slowest   = 0;
+  size_t             i         = 0;
+  int                failed    = 0;
+
+  if (ockam_memory_stdlib_init(&memory)) return -1;
+
+  address.sin_family      = AF_INET;
+  address.sin_port        = htons(TEST_PORT);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+  setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &(int) { 1 }, sizeof(int));
+  if ((0 != bind(listen_fd, (struct sockaddr*) &address, sizeof(address))) || (0 != listen(listen_fd, 4))) {
+    printf("cannot listen on port %d\n", TEST_PORT);
+    return -1;
+  }
+  if (0 != pthread_create(&thread, NULL, test_echo, &listen_fd)) return -1;
+  pthread_detach(thread);
+
+  for (i = 0; i < sizeof(options) / sizeof(options[0]); i++) {
+    if (test_round_trips(&memory, &options[i], &slowest)) {
+      printf("tcp_cork %u tcp_nodelay %u: round trips failed\n", options[i].tcp_cork, options[i].tcp_nodelay);
+      failed = 1;
+      continue;
+    }
+    printf("tcp_cork %u tcp_nodelay %u: slowest of %d round trips %lu ms\n",
+           options[i].tcp_cork,
+           options[i].tcp_nodelay,
+           TEST_ROUNDS,
+           (unsigned long) slowest);
+    if (slowest >= TEST_LIMIT_MS) failed = 1;
+  }
+
+  close(listen_fd);
+  return failed ? -1 : 0;
+}
@@ -24,6 +24,7 @@
 #define TRANSPORT_ERROR_LISTEN           (OCKAM_ERROR_INTERFACE_TRANSPORT | 0x000Du)
 #define TRANSPORT_ERROR_SOCKET           (OCKAM_ERROR_INTERFACE_TRANSPORT | 0x000Eu)
 #define TRANSPORT_ERROR_INVALID_OP       (OCKAM_ERROR_INTERFACE_TRANSPORT | 0x000Fu)
+#define TRANSPORT_ERROR_WOULD_BLOCK      (OCKAM_ERROR_INTERFACE_TRANSPORT | 0x0010u) /*!< Output limit reached */
 /*
  * Transport
  */
@@ -35,7 +36,7 @@ ockam_error_t ockam_transport_connect(ockam_transport_t*  transport,
                                       ockam_writer_t**    writer,
                                       ockam_ip_address_t* remote_address,
                                       int16_t  retry_count,   // -1 : forever, 0 : no retries, >0 : number of retries
-                                      uint16_t retry_interval // in seconds
+                                      uint16_t retry_interval // in seconds, TCP: upper bound of the retry backoff
 );
 ockam_error_t ockam_transport_accept(ockam_transport_t*  transport,
                                      ockam_reader_t**    reader,
@@ -46,8 +47,17 @@ ockam_error_t ockam_transport_deinit(ockam_transport_t* transport);
  * tcp socket specific transport
  */
 typedef struct ockam_transport_socket_attributes {
-  ockam_ip_address_t listen_address;
+  ockam_ip_address_t listen_address; /*!< IPv4 or IPv6, an empty address binds the dual-stack wildcard */
   ockam_memory_t*    p_memory;
+  uint8_t            tcp_nodelay; /*!< TCP only: send each frame immediately instead of waiting on Nagle */
+  uint8_t            tcp_cork;    /*!< TCP only, Linux: send each frame in full segments, flushed once written */
+  uint8_t            udp_gso;     /*!< UDP only, Linux: batched writes pass runs of equal-sized datagrams as one */
+  uint8_t            udp_gro;     /*!< UDP only, Linux: the kernel coalesces received datagrams, batched reads split them */
+
+  /** TCP only: give up on a connect attempt after this many milliseconds, 0 leaves it to the OS */
+  uint32_t tcp_connect_timeout_ms;
+  /** TCP only: delay before the first connect retry in milliseconds, doubling up to retry_interval, 0 means 100 */
+  uint32_t tcp_retry_backoff_ms;
 } ockam_transport_socket_attributes_t;
 
 #endif
@@ -29,7 +29,9 @@
 #define VAULT_ATECC608A_AEAD_AES_GCM_DECRYPT        0u             /* Signal common AES GCM function to decrypt          */
 #define VAULT_ATECC608A_AEAD_AES_GCM_ENCRYPT        1u             /* Signal common AES GCM function to encrypt          */
 #define VAULT_ATECC608A_AEAD_AES_GCM_IV_SIZE       12u
-#define VAULT_ATECC608A_AEAD_AES_GCM_IV_OFFSET     10u
+#define VAULT_ATECC608A_AEAD_AES_GCM_IV_OFFSET     4u
+#define VAULT_ATECC608A_SHA256_BLOCK_SIZE          64u             /* SHA command hashes one block per update            */
+#define VAULT_ATECC608A_SHA256_CONTEXT_SIZE       130u             /* Largest SHA engine context read from the device    */
 
 #define VAULT_ATECC608A_SLOT_GENKEY_MASK           0x2000
 #define VAULT_ATECC608A_SLOT_PRIVWRITE_MASK        0x4000
@@ -113,6 +115,17 @@ typedef struct {
   size_t buffer_size;
 } vault_atecc608a_secret_context_t;
 
+/**
+ * @brief Context data for a SHA-256 hash over several calls. The device has one SHA engine, so the engine state is
+ *        saved here between calls and written back before the next block is hashed.
+ */
+typedef struct {
+  uint8_t  block[VAULT_ATECC608A_SHA256_BLOCK_SIZE];
+  size_t   block_length;
+  uint8_t  engine[VAULT_ATECC608A_SHA256_CONTEXT_SIZE];
+  uint16_t engine_size;
+} vault_atecc608a_sha256_context_t;
+
 uint16_t g_vault_atecc608a_slot_size[VAULT_ATECC608A_NUM_SLOTS] = {
   36, 36, 36, 36, 36, 36, 36, 36, 416, 72, 72, 72, 72, 72, 72, 72
 };
@@ -129,6 +142,19 @@ ockam_error_t vault_atecc608a_sha256(ockam_vault_t* vault,
                                      size_t         digest_size,
                                      size_t*        digest_length);
 
+ockam_error_t vault_atecc608a_sha256_init(ockam_vault_t* vault, ockam_vault_sha256_ctx_t* sha256);
+
+ockam_error_t vault_atecc608a_sha256_update(ockam_vault_t*            vault,
+                                            ockam_vault_sha256_ctx_t* sha256,
+                                            const uint8_t*            input,
+                                            size_t                    input_length);
+
+ockam_error_t vault_atecc608a_sha256_final(ockam_vault_t*            vault,
+                                           ockam_vault_sha256_ctx_t* sha256,
+                                           uint8_t*                  digest,
+                                           size_t                    digest_size,
+                                           size_t*                   digest_length);
+
 ockam_error_t vault_atecc608a_secret_generate(ockam_vault_t*                         vault,
                                               ockam_vault_secret_t*                  secret,
                                               const ockam_vault_secret_attributes_t* attributes);
@@ -175,7 +201,7 @@ ockam_error_t vault_atecc608a_hkdf_sha256(ockam_vault_t*        vault,
 
 ockam_error_t vault_atecc608a_aead_aes_gcm_encrypt(ockam_vault_t*        vault,
                                                    ockam_vault_secret_t* key,
-                                                   uint16_t              nonce,
+                                                   uint64_t              nonce,
                                                    const uint8_t*        additional_data,
                                                    size_t                additional_data_length,
                                                    const uint8_t*        plaintext,
@@ -186,7 +212,7 @@ ockam_error_t vault_atecc608a_aead_aes_gcm_encrypt(ockam_vault_t*        vault,
 
 ockam_error_t vault_atecc608a_aead_aes_gcm_decrypt(ockam_vault_t*        vault,
                                                    ockam_vault_secret_t* key,
-                                                   uint16_t              nonce,
+                                                   uint64_t              nonce,
                                                    const uint8_t*        additional_data,
                                                    size_t                additional_data_length,
                                                    const uint8_t*        ciphertext_and_tag,
@@ -210,7 +236,7 @@ ockam_error_t atecc608a_hkdf_expand(vault_atecc608a_context_t* context,
 ockam_error_t atecc608a_aead_aes_gcm(ockam_vault_t*        vault,
                                      int                   encrypt,
                                      ockam_vault_secret_t* key,
-                                     uint16_t              nonce,
+                                     uint64_t              nonce,
                                      const uint8_t*        additional_data,
                                      size_t                additional_data_length,
                                      const uint8_t*        ciphertext_and_tag,
@@ -234,6 +260,15 @@ ockam_vault_dispatch_table_t vault_atecc608a_dispatch_table = {
   &vault_atecc608a_hkdf_sha256,
   &vault_atecc608a_aead_aes_gcm_encrypt,
   &vault_atecc608a_aead_aes_gcm_decrypt,
+  0,                                      /* aead_aes_gcm_encrypt_batch    */
+  0,                                      /* aead_aes_gcm_decrypt_batch    */
+  0,                                      /* aead_aes_gcm_encrypt_in_place */
+  0,                                      /* aead_aes_gcm_decrypt_in_place */
+  0,                                      /* secret_generate_batch         */
+  0,                                      /* ecdh_batch                    */
+  &vault_atecc608a_sha256_init,
+  &vault_atecc608a_sha256_update,
+  &vault_atecc608a_sha256_final,
 };
 
 ockam_error_t ockam_vault_atecc608a_init(ockam_vault_t* vault, ockam_vault_atecc608a_attributes_t* attributes)
@@ -514,6 +549,247 @@ exit:
   return error;
 }
 
+/**
+ ********************************************************************************************************
+ *                                     vault_atecc608a_sha256_init()
+ ********************************************************************************************************
+ */
+
+ockam_error_t vault_atecc608a_sha256_init(ockam_vault_t* vault, ockam_vault_sha256_ctx_t* sha256)
+{
+  ockam_error_t                     error      = OCKAM_ERROR_NONE;
+  ATCA_STATUS                       status     = ATCA_SUCCESS;
+  vault_atecc608a_context_t*        context    = 0;
+  vault_atecc608a_sha256_context_t* sha256_ctx = 0;
+
+  if ((vault == 0) || (vault->impl_context == 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
+  }
+
+  context = (vault_atecc608a_context_t*) vault->impl_context;
+
+  if((sha256 == 0) || (sha256->context != 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  error = ockam_memory_alloc_zeroed(context->memory, (void**) &sha256_ctx, sizeof(vault_atecc608a_sha256_context_t));
+  if(error != OCKAM_ERROR_NONE) {
+    goto exit;
+  }
+
+  if(context->mutex) {
+    error = ockam_mutex_lock(context->mutex, context->lock);
+    if(error != OCKAM_ERROR_NONE) {
+      goto exit;
+    }
+  }
+
+  status = atcab_sha_start();
+  if (status == ATCA_SUCCESS) {
+    sha256_ctx->engine_size = sizeof(sha256_ctx->engine);
+    status                  = atcab_sha_read_context(&sha256_ctx->engine[0], &sha256_ctx->engine_size);
+  }
+
+  if(context->mutex) {
+    error = ockam_mutex_unlock(context->mutex, context->lock);
+  }
+
+  if (status != ATCA_SUCCESS) {
+    error = OCKAM_VAULT_ERROR_SHA256_FAIL;
+  }
+
+  if(error != OCKAM_ERROR_NONE) {
+    goto exit;
+  }
+
+  sha256->context = sha256_ctx;
+
+exit:
+  if((error != OCKAM_ERROR_NONE) && (sha256_ctx != 0)) {
+    ockam_memory_free(context->memory, sha256_ctx, sizeof(vault_atecc608a_sha256_context_t));
+  }
+
+  return error;
+}
+
+/**
+ ********************************************************************************************************
+ *                                    vault_atecc608a_sha256_update()
+ ********************************************************************************************************
+ */
+
+ockam_error_t vault_atecc608a_sha256_update(ockam_vault_t*            vault,
+                                            ockam_vault_sha256_ctx_t* sha256,
+                                            const uint8_t*            input,
+                                            size_t                    input_length)
+{
+  ockam_error_t                     error      = OCKAM_ERROR_NONE;
+  ockam_error_t                     exit_error = OCKAM_ERROR_NONE;
+  ATCA_STATUS                       status     = ATCA_SUCCESS;
+  vault_atecc608a_context_t*        context    = 0;
+  vault_atecc608a_sha256_context_t* sha256_ctx = 0;
+  size_t                            length     = 0;
+  uint8_t                           locked     = 0;
+
+  if ((vault == 0) || (vault->impl_context == 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
+  }
+
+  context = (vault_atecc608a_context_t*) vault->impl_context;
+
+  if((sha256 == 0) || (sha256->context == 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  sha256_ctx = (vault_atecc608a_sha256_context_t*) sha256->context;
+
+  while(input_length > 0) {
+    length = VAULT_ATECC608A_SHA256_BLOCK_SIZE - sha256_ctx->block_length;
+    if(length > input_length) {
+      length = input_length;
+    }
+
+    ockam_memory_copy(context->memory, &sha256_ctx->block[sha256_ctx->block_length], input, length);
+    sha256_ctx->block_length += length;
+    input                    += length;
+    input_length             -= length;
+
+    if(sha256_ctx->block_length < VAULT_ATECC608A_SHA256_BLOCK_SIZE) {
+      break;
+    }
+
+    if(!locked) {                                           /* Only touch the device once a full block is ready.  */
+      if(context->mutex) {
+        error = ockam_mutex_lock(context->mutex, context->lock);
+        if(error != OCKAM_ERROR_NONE) {
+          goto exit;
+        }
+      }
+      locked = 1;
+
+      status = atcab_sha_write_context(&sha256_ctx->engine[0], sha256_ctx->engine_size);
+      if (status != ATCA_SUCCESS) {
+        error = OCKAM_VAULT_ERROR_SHA256_FAIL;
+        goto exit;
+      }
+    }
+
+    status = atcab_sha_update(&sha256_ctx->block[0]);
+    if (status != ATCA_SUCCESS) {
+      error = OCKAM_VAULT_ERROR_SHA256_FAIL;
+      goto exit;
+    }
+
+    sha256_ctx->block_length = 0;
+  }
+
+  if(locked) {
+    sha256_ctx->engine_size = sizeof(sha256_ctx->engine);
+    status                  = atcab_sha_read_context(&sha256_ctx->engine[0], &sha256_ctx->engine_size);
+    if (status != ATCA_SUCCESS) {
+      error = OCKAM_VAULT_ERROR_SHA256_FAIL;
+      goto exit;
+    }
+  }
+
+exit:
+  if(locked && context->mutex) {
+    exit_error = ockam_mutex_unlock(context->mutex, context->lock);
+    if(error == OCKAM_ERROR_NONE) {
+      error = exit_error;
+    }
+  }
+
+  return error;
+}
+
+/**
+ ********************************************************************************************************
+ *                                    vault_atecc608a_sha256_final()
+ ********************************************************************************************************
+ */
+
+ockam_error_t vault_atecc608a_sha256_final(ockam_vault_t*            vault,
+                                           ockam_vault_sha256_ctx_t* sha256,
+                                           uint8_t*                  digest,
+                                           size_t                    digest_size,
+                                           size_t*                   digest_length)
+{
+  ockam_error_t                     error      = OCKAM_ERROR_NONE;
+  ockam_error_t                     exit_error = OCKAM_ERROR_NONE;
+  ATCA_STATUS                       status     = ATCA_SUCCESS;
+  vault_atecc608a_context_t*        context    = 0;
+  vault_atecc608a_sha256_context_t* sha256_ctx = 0;
+
+  if ((vault == 0) || (vault->impl_context == 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
+  }
+
+  context = (vault_atecc608a_context_t*) vault->impl_context;
+
+  if((sha256 == 0) || (sha256->context == 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  sha256_ctx = (vault_atecc608a_sha256_context_t*) sha256->context;
+
+  if(digest == 0) {                                         /* Abandoned hash, nothing to ask the device for      */
+    goto exit;
+  }
+
+  if(digest_length == 0) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if(digest_size != OCKAM_VAULT_SHA256_DIGEST_LENGTH) {
+    error = OCKAM_VAULT_ERROR_INVALID_SIZE;
+    goto exit;
+  }
+
+  if(context->mutex) {
+    error = ockam_mutex_lock(context->mutex, context->lock);
+    if(error != OCKAM_ERROR_NONE) {
+      goto exit;
+    }
+  }
+
+  status = atcab_sha_write_context(&sha256_ctx->engine[0], sha256_ctx->engine_size);
+  if (status == ATCA_SUCCESS) {
+    status = atcab_sha_end(digest, (uint16_t) sha256_ctx->block_length, &sha256_ctx->block[0]);
+  }
+
+  if(context->mutex) {
+    error = ockam_mutex_unlock(context->mutex, context->lock);
+  }
+
+  if (status != ATCA_SUCCESS) {
+    error = OCKAM_VAULT_ERROR_SHA256_FAIL;
+    goto exit;
+  }
+
+  if(error == OCKAM_ERROR_NONE) {
+    *digest_length = digest_size;
+  }
+
+exit:
+  if(sha256_ctx != 0) {
+    exit_error = ockam_memory_free(context->memory, sha256_ctx, sizeof(vault_atecc608a_sha256_context_t));
+    if(error == OCKAM_ERROR_NONE) {
+      error = exit_error;
+    }
+    sha256->context = 0;
+  }
+
+  return error;
+}
+
 /**
  ********************************************************************************************************
  *                                    vault_atecc608a_secret_generate()
@@ -1206,7 +1482,7 @@ exit:
 
 ockam_error_t vault_atecc608a_aead_aes_gcm_encrypt(ockam_vault_t*        vault,
                                                    ockam_vault_secret_t* key,
-                                                   uint16_t              nonce,
+                                                   uint64_t              nonce,
                                                    const uint8_t*        additional_data,
                                                    size_t                additional_data_length,
                                                    const uint8_t*        plaintext,
@@ -1228,7 +1504,7 @@ ockam_error_t vault_atecc608a_aead_aes_gcm_encrypt(ockam_vault_t*        vault,
 
 ockam_error_t vault_atecc608a_aead_aes_gcm_decrypt(ockam_vault_t*        vault,
                                                    ockam_vault_secret_t* key,
-                                                   uint16_t              nonce,
+                                                   uint64_t              nonce,
                                                    const uint8_t*        additional_data,
                                                    size_t                additional_data_length,
                                                    const uint8_t*        ciphertext_and_tag,
@@ -1436,7 +1712,7 @@ exit:
 ockam_error_t atecc608a_aead_aes_gcm(ockam_vault_t*        vault,
                                      int                   encrypt,
                                      ockam_vault_secret_t* key,
-                                     uint16_t              nonce,
+                                     uint64_t              nonce,
                                      const uint8_t*        additional_data,
                                      size_t                additional_data_length,
                                      const uint8_t*        input,
@@ -1510,14 +1786,11 @@ ockam_error_t atecc608a_aead_aes_gcm(ockam_vault_t*        vault,
   }
 
   {
-    int n = 1;
-
-    if (*(char*) &n == 1) { /* Check the endianness and copy appropriately */
-      iv[VAULT_ATECC608A_AEAD_AES_GCM_IV_OFFSET]     = ((nonce >> 8) & 0xFF);
-      iv[VAULT_ATECC608A_AEAD_AES_GCM_IV_OFFSET + 1] = ((nonce) &0xFF);
-    } else {
-      iv[VAULT_ATECC608A_AEAD_AES_GCM_IV_OFFSET]     = ((nonce) &0xFF);
-      iv[VAULT_ATECC608A_AEAD_AES_GCM_IV_OFFSET + 1] = ((nonce >> 8) & 0xFF);
+    size_t i = 0;
+
+    /* 32 zero bits followed by the 64-bit big-endian nonce */
+    for (i = 0; i < sizeof(nonce); i++) {
+      iv[VAULT_ATECC608A_AEAD_AES_GCM_IV_OFFSET + i] = (uint8_t)(nonce >> (8 * (sizeof(nonce) - 1 - i)));
     }
   }
 
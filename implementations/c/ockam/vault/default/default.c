@@ -16,7 +16,7 @@
 #define VAULT_DEFAULT_AEAD_AES_GCM_DECRYPT   0u
 #define VAULT_DEFAULT_AEAD_AES_GCM_ENCRYPT   1u
 #define VAULT_DEFAULT_AEAD_AES_GCM_IV_SIZE   12u
-#define VAULT_DEFAULT_AEAD_AES_GCM_IV_OFFSET 10u
+#define VAULT_DEFAULT_AEAD_AES_GCM_IV_OFFSET 4u
 
 typedef struct {
   const br_prng_class* br_random;
@@ -28,23 +28,39 @@ typedef struct {
   void*                br_sha256_ctx;
 } vault_default_sha256_ctx_t;
 
+typedef struct {
+  const br_ec_impl*                c25519;
+  const br_ec_impl*                p256;
+  ockam_vault_default_ec_backend_t backend;
+} vault_default_ecdh_ctx_t;
+
 typedef struct {
   const br_ec_impl* ec;
   uint32_t          curve;
   uint8_t*          private_key;
   size_t            private_key_size;
   size_t            ockam_public_key_size;
+  uint8_t           public_key[BR_EC_KBUF_PUB_MAX_SIZE]; /* Computed on first use */
+  size_t            public_key_length;
 } vault_default_secret_ec_ctx_t;
 
 typedef struct {
-  uint8_t* key;
-  size_t   key_size;
-  size_t   buffer_size;
+  br_aes_gen_ctr_keys br_aes_key;
+  br_gcm_context      br_aes_gcm_ctx;
+} vault_default_aead_aes_gcm_key_t;
+
+typedef struct {
+  uint8_t*                          key;
+  size_t                            key_size;
+  size_t                            buffer_size;
+  vault_default_aead_aes_gcm_key_t* aead_aes_gcm_key;
 } vault_default_secret_key_ctx_t;
 
 typedef struct {
-  br_gcm_context*     br_aes_gcm_ctx;
-  br_aes_ct_ctr_keys* br_aes_key;
+  br_gcm_context*                            br_aes_gcm_ctx;
+  const br_block_ctr_class*                  br_aes_ctr;
+  br_ghash                                   br_ghash;
+  ockam_vault_default_aead_aes_gcm_backend_t backend;
 } vault_default_aead_aes_gcm_ctx_t;
 
 ockam_error_t vault_default_secret_ec_create(ockam_vault_t*                         vault,
@@ -70,15 +86,40 @@ ockam_error_t vault_default_random_deinit(ockam_vault_default_context_t* ctx);
 ockam_error_t vault_default_sha256_init(ockam_vault_default_context_t* ctx);
 ockam_error_t vault_default_sha256_deinit(ockam_vault_default_context_t* ctx);
 
+ockam_error_t vault_default_ecdh_init(ockam_vault_default_context_t* ctx);
+ockam_error_t vault_default_ecdh_deinit(ockam_vault_default_context_t* ctx);
+ockam_error_t vault_default_ec_backend_select(vault_default_ecdh_ctx_t*        ecdh_ctx,
+                                              ockam_vault_default_ec_backend_t backend);
+
 ockam_error_t vault_default_hkdf_sha256_init(ockam_vault_default_context_t* ctx);
 ockam_error_t vault_default_hkdf_sha256_deinit(ockam_vault_default_context_t* ctx);
 
 ockam_error_t vault_default_aead_aes_gcm_init(ockam_vault_default_context_t* ctx);
 ockam_error_t vault_default_aead_aes_gcm_deinit(ockam_vault_default_context_t* ctx);
+ockam_error_t vault_default_aead_aes_gcm_backend_select(vault_default_aead_aes_gcm_ctx_t*          aead_aes_gcm_ctx,
+                                                        ockam_vault_default_aead_aes_gcm_backend_t backend);
+ockam_error_t vault_default_aead_aes_gcm_key_init(ockam_vault_default_context_t*  ctx,
+                                                  vault_default_secret_key_ctx_t* secret_ctx);
+ockam_error_t vault_default_aead_aes_gcm_key_deinit(ockam_vault_default_context_t*  ctx,
+                                                    vault_default_secret_key_ctx_t* secret_ctx);
+ockam_error_t vault_default_aead_aes_gcm_prepare(ockam_vault_t*                   vault,
+                                                 ockam_vault_secret_t*            key,
+                                                 vault_default_secret_key_ctx_t** secret_ctx);
+ockam_error_t vault_default_aead_aes_gcm_run(ockam_vault_default_context_t*  ctx,
+                                             vault_default_secret_key_ctx_t* secret_ctx,
+                                             uint8_t                         encrypt,
+                                             uint64_t                        nonce,
+                                             const uint8_t*                  additional_data,
+                                             size_t                          additional_data_length,
+                                             const uint8_t*                  input,
+                                             size_t                          input_length,
+                                             uint8_t*                        output,
+                                             size_t                          output_size,
+                                             size_t*                         output_length);
 ockam_error_t vault_default_aead_aes_gcm(ockam_vault_t*        vault,
                                          uint8_t               encrypt,
                                          ockam_vault_secret_t* key,
-                                         uint16_t              nonce,
+                                         uint64_t              nonce,
                                          const uint8_t*        additional_data,
                                          size_t                additional_data_length,
                                          const uint8_t*        input,
@@ -86,6 +127,11 @@ ockam_error_t vault_default_aead_aes_gcm(ockam_vault_t*        vault,
                                          uint8_t*              output,
                                          size_t                output_size,
                                          size_t*               output_length);
+ockam_error_t vault_default_aead_aes_gcm_batch(ockam_vault_t*                      vault,
+                                               uint8_t                             encrypt,
+                                               ockam_vault_secret_t*               key,
+                                               ockam_vault_aead_aes_gcm_message_t* messages,
+                                               size_t                              messages_count);
 
 ockam_vault_dispatch_table_t vault_default_dispatch_table = {
   &vault_default_deinit,
@@ -102,6 +148,15 @@ ockam_vault_dispatch_table_t vault_default_dispatch_table = {
   &vault_default_hkdf_sha256,
   &vault_default_aead_aes_gcm_encrypt,
   &vault_default_aead_aes_gcm_decrypt,
+  &vault_default_aead_aes_gcm_encrypt_batch,
+  &vault_default_aead_aes_gcm_decrypt_batch,
+  &vault_default_aead_aes_gcm_encrypt_in_place,
+  &vault_default_aead_aes_gcm_decrypt_in_place,
+  &vault_default_secret_generate_batch,
+  &vault_default_ecdh_batch,
+  &vault_default_sha256_stream_init,
+  &vault_default_sha256_stream_update,
+  &vault_default_sha256_stream_final,
 };
 
 ockam_error_t ockam_vault_default_init(ockam_vault_t* vault, ockam_vault_default_attributes_t* attributes)
@@ -125,9 +180,11 @@ ockam_error_t ockam_vault_default_init(ockam_vault_t* vault, ockam_vault_default
       ockam_memory_alloc_zeroed(attributes->memory, (void**) &(vault->default_context), sizeof(ockam_vault_default_context_t));
     if (error != OCKAM_ERROR_NONE) { goto exit; }
 
-    ctx         = (ockam_vault_default_context_t*) vault->default_context;
-    ctx->memory = attributes->memory;
-    ctx->random = attributes->random;
+    ctx                       = (ockam_vault_default_context_t*) vault->default_context;
+    ctx->memory               = attributes->memory;
+    ctx->random               = attributes->random;
+    ctx->aead_aes_gcm_backend = attributes->aead_aes_gcm_backend;
+    ctx->ec_backend           = attributes->ec_backend;
 
     vault->dispatch = &vault_default_dispatch_table;
 
@@ -149,6 +206,9 @@ ockam_error_t ockam_vault_default_init(ockam_vault_t* vault, ockam_vault_default
     if ((ctx->random == 0) && ((features & OCKAM_VAULT_FEAT_RANDOM) || (features & OCKAM_VAULT_FEAT_SECRET_ECDH))) {
       error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
     }
+
+    ctx->aead_aes_gcm_backend = attributes->aead_aes_gcm_backend;
+    ctx->ec_backend           = attributes->ec_backend;
   }
 
   if (features & OCKAM_VAULT_FEAT_RANDOM) {
@@ -161,7 +221,10 @@ ockam_error_t ockam_vault_default_init(ockam_vault_t* vault, ockam_vault_default
     if (error != OCKAM_ERROR_NONE) { goto exit; }
   }
 
-  if (features & OCKAM_VAULT_FEAT_SECRET_ECDH) { ctx->default_features |= OCKAM_VAULT_FEAT_SECRET_ECDH; }
+  if (features & OCKAM_VAULT_FEAT_SECRET_ECDH) {
+    error = vault_default_ecdh_init(ctx);
+    if (error != OCKAM_ERROR_NONE) { goto exit; }
+  }
 
   if (features & OCKAM_VAULT_FEAT_HKDF_SHA256) {
     error = vault_default_hkdf_sha256_init(ctx);
@@ -198,9 +261,7 @@ ockam_error_t vault_default_deinit(ockam_vault_t* vault)
 
   if (ctx->default_features & OCKAM_VAULT_FEAT_SHA256) { vault_default_sha256_deinit(ctx); }
 
-  if (ctx->default_features & OCKAM_VAULT_FEAT_SECRET_ECDH) {
-    ctx->default_features &= (!OCKAM_VAULT_FEAT_SECRET_ECDH);
-  }
+  if (ctx->default_features & OCKAM_VAULT_FEAT_SECRET_ECDH) { vault_default_ecdh_deinit(ctx); }
 
   if (ctx->default_features & OCKAM_VAULT_FEAT_HKDF_SHA256) { vault_default_hkdf_sha256_deinit(ctx); }
 
@@ -271,7 +332,7 @@ ockam_error_t vault_default_random_deinit(ockam_vault_default_context_t* ctx)
   if (error != OCKAM_ERROR_NONE) { goto exit; }
 
   ctx->random_ctx = 0;
-  ctx->default_features &= (!OCKAM_VAULT_FEAT_RANDOM);
+  ctx->default_features &= (~OCKAM_VAULT_FEAT_RANDOM);
 
 exit:
   return error;
@@ -361,7 +422,7 @@ ockam_error_t vault_default_sha256_deinit(ockam_vault_default_context_t* ctx)
   error = ockam_memory_free(ctx->memory, sha256_ctx, sizeof(vault_default_sha256_ctx_t));
   if (error != OCKAM_ERROR_NONE) { goto exit; }
 
-  ctx->default_features &= (!OCKAM_VAULT_FEAT_SHA256);
+  ctx->default_features &= (~OCKAM_VAULT_FEAT_SHA256);
   ctx->sha256_ctx = 0;
 
 exit:
@@ -418,6 +479,124 @@ exit:
   return error;
 }
 
+/*
+ * A streamed hash gets its own BearSSL SHA-256 context, so any number of streams can be open next to each other and
+ * next to one-shot hashes on the shared context.
+ */
+ockam_error_t vault_default_sha256_stream_init(ockam_vault_t* vault, ockam_vault_sha256_ctx_t* sha256)
+{
+  ockam_error_t                 error      = OCKAM_ERROR_NONE;
+  ockam_vault_default_context_t* ctx        = 0;
+  vault_default_sha256_ctx_t*   sha256_ctx = 0;
+
+  if ((vault == 0) || (vault->default_context == 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
+  }
+
+  ctx = (ockam_vault_default_context_t*) vault->default_context;
+
+  if ((ctx->sha256_ctx == 0) || (!(ctx->default_features & OCKAM_VAULT_FEAT_SHA256))) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
+  }
+
+  if ((sha256 == 0) || (sha256->context != 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  sha256_ctx = (vault_default_sha256_ctx_t*) ctx->sha256_ctx;
+
+  error = ockam_memory_alloc_zeroed(ctx->memory, &(sha256->context), sha256_ctx->br_sha256->context_size);
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  sha256_ctx->br_sha256->init(sha256->context);
+
+exit:
+  return error;
+}
+
+ockam_error_t vault_default_sha256_stream_update(ockam_vault_t*            vault,
+                                                 ockam_vault_sha256_ctx_t* sha256,
+                                                 const uint8_t*            input,
+                                                 size_t                    input_length)
+{
+  ockam_error_t                 error      = OCKAM_ERROR_NONE;
+  ockam_vault_default_context_t* ctx        = 0;
+  vault_default_sha256_ctx_t*   sha256_ctx = 0;
+
+  if ((vault == 0) || (vault->default_context == 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
+  }
+
+  ctx = (ockam_vault_default_context_t*) vault->default_context;
+
+  if ((ctx->sha256_ctx == 0) || (!(ctx->default_features & OCKAM_VAULT_FEAT_SHA256))) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
+  }
+
+  if ((sha256 == 0) || (sha256->context == 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  sha256_ctx = (vault_default_sha256_ctx_t*) ctx->sha256_ctx;
+  sha256_ctx->br_sha256->update(sha256->context, input, input_length);
+
+exit:
+  return error;
+}
+
+ockam_error_t vault_default_sha256_stream_final(ockam_vault_t*            vault,
+                                                ockam_vault_sha256_ctx_t* sha256,
+                                                uint8_t*                  digest,
+                                                size_t                    digest_size,
+                                                size_t*                   digest_length)
+{
+  ockam_error_t                 error      = OCKAM_ERROR_NONE;
+  ockam_vault_default_context_t* ctx        = 0;
+  vault_default_sha256_ctx_t*   sha256_ctx = 0;
+
+  if ((vault == 0) || (vault->default_context == 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
+  }
+
+  ctx = (ockam_vault_default_context_t*) vault->default_context;
+
+  if ((ctx->sha256_ctx == 0) || (!(ctx->default_features & OCKAM_VAULT_FEAT_SHA256))) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
+  }
+
+  if ((sha256 == 0) || (sha256->context == 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  sha256_ctx = (vault_default_sha256_ctx_t*) ctx->sha256_ctx;
+
+  if (digest != 0) {
+    if (digest_length == 0) {
+      error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    } else if (digest_size != VAULT_DEFAULT_SHA256_DIGEST_SIZE) {
+      error = OCKAM_VAULT_ERROR_INVALID_SIZE;
+    } else {
+      sha256_ctx->br_sha256->out(sha256->context, digest);
+      *digest_length = VAULT_DEFAULT_SHA256_DIGEST_SIZE;
+    }
+  }
+
+  ockam_memory_free(ctx->memory, sha256->context, sha256_ctx->br_sha256->context_size);
+  sha256->context = 0;
+
+exit:
+  return error;
+}
+
 ockam_error_t vault_default_secret_generate(ockam_vault_t*                         vault,
                                             ockam_vault_secret_t*                  secret,
                                             const ockam_vault_secret_attributes_t* attributes)
@@ -457,6 +636,58 @@ exit:
   return error;
 }
 
+ockam_error_t vault_default_secret_generate_batch(ockam_vault_t*                         vault,
+                                                  ockam_vault_secret_t*                  secrets,
+                                                  const ockam_vault_secret_attributes_t* attributes,
+                                                  size_t                                 secrets_count)
+{
+  ockam_error_t error     = OCKAM_ERROR_NONE;
+  size_t        i         = 0;
+  size_t        generated = 0;
+
+  if ((vault == 0) || (attributes == 0) || ((secrets == 0) && (secrets_count != 0))) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  for (i = 0; i < secrets_count; i++) { /* The caller's secrets are never regenerated, or destroyed on failure */
+    if (secrets[i].context != 0) {
+      error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+      goto exit;
+    }
+  }
+
+  for (i = 0; i < secrets_count; i++) {
+    switch (attributes->type) {
+    case OCKAM_VAULT_SECRET_TYPE_P256_PRIVATEKEY:
+    case OCKAM_VAULT_SECRET_TYPE_CURVE25519_PRIVATEKEY:
+      error = vault_default_secret_ec_create(vault, &(secrets[i]), attributes, 1, 0, 0);
+      break;
+
+    case OCKAM_VAULT_SECRET_TYPE_AES128_KEY:
+    case OCKAM_VAULT_SECRET_TYPE_AES256_KEY:
+    case OCKAM_VAULT_SECRET_TYPE_BUFFER:
+      error = vault_default_secret_key_create(vault, &(secrets[i]), attributes, 1, 0, 0);
+      break;
+
+    default:
+      error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+      break;
+    }
+
+    if (error != OCKAM_ERROR_NONE) { break; }
+
+    generated++;
+  }
+
+  if (error != OCKAM_ERROR_NONE) { /* All or nothing, release the secrets generated before the failure */
+    for (i = 0; i < generated; i++) { vault_default_secret_destroy(vault, &(secrets[i])); }
+  }
+
+exit:
+  return error;
+}
+
 ockam_error_t vault_default_secret_import(ockam_vault_t*                         vault,
                                           ockam_vault_secret_t*                  secret,
                                           const ockam_vault_secret_attributes_t* attributes,
@@ -509,6 +740,7 @@ ockam_error_t vault_default_secret_ec_create(ockam_vault_t*
   ockam_vault_default_context_t*  ctx           = 0;
   vault_default_random_ctx_t*    random_ctx    = 0;
   vault_default_secret_ec_ctx_t* secret_ctx    = 0;
+  vault_default_ecdh_ctx_t*      ecdh_ctx      = 0;
   br_hmac_drbg_context*          br_random_ctx = 0;
   size_t                         size          = 0;
 
@@ -563,13 +795,17 @@ ockam_error_t vault_default_secret_ec_create(ockam_vault_t*
 
   ockam_memory_set(ctx->memory, &(secret->attributes), 0, sizeof(ockam_vault_secret_attributes_t));
 
+  ecdh_ctx                      = (vault_default_ecdh_ctx_t*) ctx->ecdh_ctx;
+  secret_ctx->public_key_length = 0;
+
   switch (attributes->type) {
   case OCKAM_VAULT_SECRET_TYPE_P256_PRIVATEKEY:
-    secret_ctx->ec    = &br_ec_p256_m31;
+    secret_ctx->ec    = (ecdh_ctx != 0) ? ecdh_ctx->p256 : &br_ec_p256_m31;
     secret_ctx->curve = BR_EC_secp256r1;
+    break;
 
   case OCKAM_VAULT_SECRET_TYPE_CURVE25519_PRIVATEKEY:
-    secret_ctx->ec    = &br_ec_c25519_i31;
+    secret_ctx->ec    = (ecdh_ctx != 0) ? ecdh_ctx->c25519 : &br_ec_c25519_i31;
     secret_ctx->curve = BR_EC_curve25519;
     break;
 
@@ -707,6 +943,8 @@ ockam_error_t vault_default_secret_key_create(ockam_vault_t*
     secret_ctx = (vault_default_secret_key_ctx_t*) secret->context;
   }
 
+  vault_default_aead_aes_gcm_key_deinit(ctx, secret_ctx); /* Key material is about to change, drop the schedule */
+
   if ((secret_ctx->key != 0) && (attributes->length != secret_ctx->key_size)) {
     ockam_memory_free(ctx->memory, secret_ctx->key, secret_ctx->key_size);
     secret_ctx->key = 0;
@@ -743,6 +981,15 @@ ockam_error_t vault_default_secret_key_create(ockam_vault_t*
 
   secret->context = secret_ctx;
 
+  if ((attributes->type == OCKAM_VAULT_SECRET_TYPE_AES128_KEY) ||
+      (attributes->type == OCKAM_VAULT_SECRET_TYPE_AES256_KEY)) {
+    error = vault_default_aead_aes_gcm_key_init(ctx, secret_ctx);
+    if (error != OCKAM_ERROR_NONE) {
+      vault_default_secret_destroy(vault, secret);
+      goto exit;
+    }
+  }
+
 exit:
   return error;
 }
@@ -855,7 +1102,12 @@ ockam_error_t vault_default_secret_key_destroy(ockam_vault_t* vault, ockam_vault
 
   secret_ctx = (vault_default_secret_key_ctx_t*) secret->context;
 
-  if (secret_ctx->key != 0) { ockam_memory_free(ctx->memory, secret_ctx->key, secret_ctx->buffer_size); }
+  vault_default_aead_aes_gcm_key_deinit(ctx, secret_ctx);
+
+  if (secret_ctx->key != 0) {
+    ockam_memory_set(ctx->memory, secret_ctx->key, 0, secret_ctx->buffer_size);
+    ockam_memory_free(ctx->memory, secret_ctx->key, secret_ctx->buffer_size);
+  }
 
   ockam_memory_free(ctx->memory, secret_ctx, sizeof(vault_default_secret_key_ctx_t));
   ockam_memory_set(ctx->memory, &(secret->attributes), 0, sizeof(ockam_vault_secret_attributes_t));
@@ -923,6 +1175,7 @@ ockam_error_t vault_default_secret_publickey_get(ockam_vault_t*        vault,
                                                  size_t*               output_buffer_length)
 {
   ockam_error_t                  error      = OCKAM_ERROR_NONE;
+  ockam_vault_default_context_t* ctx        = 0;
   vault_default_secret_ec_ctx_t* secret_ctx = 0;
 
   if ((vault == 0) || (secret == 0) || (output_buffer == 0) || (output_buffer_length == 0)) {
@@ -930,6 +1183,13 @@ ockam_error_t vault_default_secret_publickey_get(ockam_vault_t*        vault,
     goto exit;
   }
 
+  if (vault->default_context == 0) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
+  }
+
+  ctx = (ockam_vault_default_context_t*) vault->default_context;
+
   if ((secret->attributes.type != OCKAM_VAULT_SECRET_TYPE_P256_PRIVATEKEY) &&
       (secret->attributes.type != OCKAM_VAULT_SECRET_TYPE_CURVE25519_PRIVATEKEY)) {
     error = OCKAM_VAULT_ERROR_INVALID_SECRET_TYPE;
@@ -948,20 +1208,24 @@ ockam_error_t vault_default_secret_publickey_get(ockam_vault_t*        vault,
     goto exit;
   }
 
-  {
+  if (secret_ctx->public_key_length == 0) {
     size_t                  size           = 0;
     const br_ec_private_key br_private_key = { .curve = secret_ctx->curve,
                                                .xlen  = secret_ctx->private_key_size,
                                                .x     = secret_ctx->private_key };
 
-    size = br_ec_compute_pub(secret_ctx->ec, 0, output_buffer, &br_private_key);
-    if (size == 0) {
+    size = br_ec_compute_pub(secret_ctx->ec, 0, secret_ctx->public_key, &br_private_key);
+    if ((size == 0) || (size != secret_ctx->ockam_public_key_size)) {
       error = OCKAM_VAULT_ERROR_PUBLIC_KEY_FAIL;
       goto exit;
     }
+
+    secret_ctx->public_key_length = size;
   }
 
-  *output_buffer_length = secret_ctx->ockam_public_key_size;
+  ockam_memory_copy(ctx->memory, output_buffer, secret_ctx->public_key, secret_ctx->public_key_length);
+
+  *output_buffer_length = secret_ctx->public_key_length;
 
 exit:
   return error;
@@ -1012,11 +1276,12 @@ vault_default_secret_type_set(ockam_vault_t* vault, ockam_vault_secret_t* secret
     goto exit;
   }
 
-  if (secret->context == 0) {
+  if ((vault->default_context == 0) || (secret->context == 0)) {
     error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
     goto exit;
   }
 
+  ctx        = (ockam_vault_default_context_t*) vault->default_context;
   secret_ctx = (vault_default_secret_key_ctx_t*) secret->context;
 
   if (type == OCKAM_VAULT_SECRET_TYPE_AES128_KEY) {
@@ -1039,10 +1304,15 @@ vault_default_secret_type_set(ockam_vault_t* vault, ockam_vault_secret_t* secret
     secret_ctx->key_size      = OCKAM_VAULT_AES256_KEY_LENGTH;
   } else if (type == OCKAM_VAULT_SECRET_TYPE_BUFFER) {
     secret->attributes.type = type;
+    error                   = vault_default_aead_aes_gcm_key_deinit(ctx, secret_ctx);
+    goto exit;
   } else {
     error = OCKAM_VAULT_ERROR_INVALID_SECRET_TYPE;
+    goto exit;
   }
 
+  error = vault_default_aead_aes_gcm_key_init(ctx, secret_ctx);
+
 exit:
   return error;
 }
@@ -1120,6 +1390,168 @@ exit:
   return error;
 }
 
+ockam_error_t
+vault_default_ecdh_batch(ockam_vault_t* vault, ockam_vault_ecdh_message_t* messages, size_t messages_count)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+  size_t        i     = 0;
+
+  if ((vault == 0) || ((messages == 0) && (messages_count != 0))) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  for (i = 0; i < messages_count; i++) {
+    messages[i].error = vault_default_ecdh(vault,
+                                           messages[i].privatekey,
+                                           messages[i].peer_publickey,
+                                           messages[i].peer_publickey_length,
+                                           messages[i].shared_secret);
+
+    if (messages[i].error != OCKAM_ERROR_NONE) {
+      if ((messages[i].shared_secret != 0) && (messages[i].shared_secret->context != 0)) {
+        vault_default_secret_destroy(vault, messages[i].shared_secret);
+      }
+      if (error == OCKAM_ERROR_NONE) { error = messages[i].error; }
+    }
+  }
+
+exit:
+  return error;
+}
+
+ockam_error_t vault_default_ecdh_init(ockam_vault_default_context_t* ctx)
+{
+  ockam_error_t             error    = OCKAM_ERROR_NONE;
+  vault_default_ecdh_ctx_t* ecdh_ctx = 0;
+
+  if ((ctx == 0) || (ctx->memory == 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
+  }
+
+  error = ockam_memory_alloc_zeroed(ctx->memory, (void**) &ecdh_ctx, sizeof(vault_default_ecdh_ctx_t));
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  error = vault_default_ec_backend_select(ecdh_ctx, ctx->ec_backend);
+  if (error != OCKAM_ERROR_NONE) {
+    ockam_memory_free(ctx->memory, ecdh_ctx, sizeof(vault_default_ecdh_ctx_t));
+    goto exit;
+  }
+
+  ctx->default_features |= OCKAM_VAULT_FEAT_SECRET_ECDH;
+  ctx->ecdh_ctx = ecdh_ctx;
+
+exit:
+  return error;
+}
+
+ockam_error_t vault_default_ecdh_deinit(ockam_vault_default_context_t* ctx)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((ctx == 0) || (ctx->memory == 0) || (ctx->ecdh_ctx == 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
+  }
+
+  error = ockam_memory_free(ctx->memory, ctx->ecdh_ctx, sizeof(vault_default_ecdh_ctx_t));
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  ctx->default_features &= (~OCKAM_VAULT_FEAT_SECRET_ECDH);
+  ctx->ecdh_ctx = 0;
+
+exit:
+  return error;
+}
+
+ockam_error_t vault_default_ec_backend_select(vault_default_ecdh_ctx_t*        ecdh_ctx,
+                                              ockam_vault_default_ec_backend_t backend)
+{
+  ockam_error_t                    error    = OCKAM_ERROR_NONE;
+  ockam_vault_default_ec_backend_t selected = OCKAM_VAULT_DEFAULT_EC_BACKEND_AUTO;
+  const br_ec_impl*                c25519   = 0;
+  const br_ec_impl*                p256     = 0;
+
+  if (ecdh_ctx == 0) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
+  }
+
+  /* The 64-bit getters return null when the compiler lacks 64x64->128 multiplications */
+
+  if ((backend == OCKAM_VAULT_DEFAULT_EC_BACKEND_AUTO) || (backend == OCKAM_VAULT_DEFAULT_EC_BACKEND_M64)) {
+    c25519 = br_ec_c25519_m64_get();
+    p256   = br_ec_p256_m64_get();
+
+    if ((c25519 != 0) && (p256 != 0)) { selected = OCKAM_VAULT_DEFAULT_EC_BACKEND_M64; }
+  }
+
+  if ((selected == OCKAM_VAULT_DEFAULT_EC_BACKEND_AUTO) &&
+      ((backend == OCKAM_VAULT_DEFAULT_EC_BACKEND_AUTO) || (backend == OCKAM_VAULT_DEFAULT_EC_BACKEND_M62))) {
+    c25519 = br_ec_c25519_m62_get();
+    p256   = br_ec_p256_m62_get();
+
+    if ((c25519 != 0) && (p256 != 0)) { selected = OCKAM_VAULT_DEFAULT_EC_BACKEND_M62; }
+  }
+
+  if ((selected == OCKAM_VAULT_DEFAULT_EC_BACKEND_AUTO) &&
+      ((backend == OCKAM_VAULT_DEFAULT_EC_BACKEND_AUTO) || (backend == OCKAM_VAULT_DEFAULT_EC_BACKEND_M31))) {
+    c25519   = &br_ec_c25519_m31;
+    p256     = &br_ec_p256_m31;
+    selected = OCKAM_VAULT_DEFAULT_EC_BACKEND_M31;
+  }
+
+  if ((selected == OCKAM_VAULT_DEFAULT_EC_BACKEND_AUTO) && (backend == OCKAM_VAULT_DEFAULT_EC_BACKEND_I31)) {
+    c25519   = &br_ec_c25519_i31;
+    p256     = &br_ec_prime_i31;
+    selected = OCKAM_VAULT_DEFAULT_EC_BACKEND_I31;
+  }
+
+  if (selected == OCKAM_VAULT_DEFAULT_EC_BACKEND_AUTO) {
+    error = OCKAM_VAULT_ERROR_BACKEND_UNAVAILABLE;
+    goto exit;
+  }
+
+  ecdh_ctx->c25519  = c25519;
+  ecdh_ctx->p256    = p256;
+  ecdh_ctx->backend = selected;
+
+exit:
+  return error;
+}
+
+ockam_error_t ockam_vault_default_ec_backend_get(ockam_vault_t* vault, ockam_vault_default_ec_backend_t* backend)
+{
+  ockam_error_t                  error    = OCKAM_ERROR_NONE;
+  ockam_vault_default_context_t* ctx      = 0;
+  vault_default_ecdh_ctx_t*      ecdh_ctx = 0;
+
+  if ((vault == 0) || (backend == 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if (vault->default_context == 0) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
+  }
+
+  ctx = (ockam_vault_default_context_t*) vault->default_context;
+
+  if ((ctx->ecdh_ctx == 0) || (!(ctx->default_features & OCKAM_VAULT_FEAT_SECRET_ECDH))) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
+  }
+
+  ecdh_ctx = (vault_default_ecdh_ctx_t*) ctx->ecdh_ctx;
+
+  *backend = ecdh_ctx->backend;
+
+exit:
+  return error;
+}
+
 ockam_error_t vault_default_hkdf_sha256_init(ockam_vault_default_context_t* ctx)
 {
   ockam_error_t               error      = OCKAM_ERROR_NONE;
@@ -1151,7 +1583,7 @@ ockam_error_t vault_default_hkdf_sha256_deinit(ockam_vault_default_context_t* ct
   error = ockam_memory_free(ctx->memory, ctx->hkdf_sha256_ctx, sizeof(br_hkdf_context));
 
   ctx->hkdf_sha256_ctx = 0;
-  ctx->default_features &= (!OCKAM_VAULT_FEAT_HKDF_SHA256);
+  ctx->default_features &= (~OCKAM_VAULT_FEAT_HKDF_SHA256);
 
 exit:
   return error;
@@ -1268,7 +1700,7 @@ ockam_error_t vault_default_aead_aes_gcm_init(ockam_vault_default_context_t* ctx
   error = ockam_memory_alloc_zeroed(ctx->memory, (void**) &aead_aes_gcm_ctx, sizeof(vault_default_aead_aes_gcm_ctx_t));
   if (error != OCKAM_ERROR_NONE) { goto exit; }
 
-  error = ockam_memory_alloc_zeroed(ctx->memory, (void**) &(aead_aes_gcm_ctx->br_aes_key), sizeof(br_aes_ct_ctr_keys));
+  error = vault_default_aead_aes_gcm_backend_select(aead_aes_gcm_ctx, ctx->aead_aes_gcm_backend);
   if (error != OCKAM_ERROR_NONE) {
     ockam_memory_free(ctx->memory, aead_aes_gcm_ctx, sizeof(vault_default_aead_aes_gcm_ctx_t));
     goto exit;
@@ -1276,7 +1708,6 @@ ockam_error_t vault_default_aead_aes_gcm_init(ockam_vault_default_context_t* ctx
 
   error = ockam_memory_alloc_zeroed(ctx->memory, (void**) &(aead_aes_gcm_ctx->br_aes_gcm_ctx), sizeof(br_gcm_context));
   if (error != OCKAM_ERROR_NONE) {
-    ockam_memory_free(ctx->memory, aead_aes_gcm_ctx->br_aes_key, sizeof(br_aes_ct_ctr_keys));
     ockam_memory_free(ctx->memory, aead_aes_gcm_ctx, sizeof(vault_default_aead_aes_gcm_ctx_t));
     goto exit;
   }
@@ -1301,43 +1732,86 @@ ockam_error_t vault_default_aead_aes_gcm_deinit(ockam_vault_default_context_t* c
   aead_aes_gcm_ctx = (vault_default_aead_aes_gcm_ctx_t*) ctx->aead_aes_gcm_ctx;
 
   if (aead_aes_gcm_ctx->br_aes_gcm_ctx != 0) {
+    ockam_memory_set(ctx->memory, aead_aes_gcm_ctx->br_aes_gcm_ctx, 0, sizeof(br_gcm_context));
     ockam_memory_free(ctx->memory, aead_aes_gcm_ctx->br_aes_gcm_ctx, sizeof(br_gcm_context));
   }
 
-  if (aead_aes_gcm_ctx->br_aes_key != 0) {
-    ockam_memory_free(ctx->memory, aead_aes_gcm_ctx->br_aes_key, sizeof(br_aes_ct_ctr_keys));
-  }
-
   error = ockam_memory_free(ctx->memory, aead_aes_gcm_ctx, sizeof(vault_default_aead_aes_gcm_ctx_t));
   if (error != OCKAM_ERROR_NONE) { goto exit; }
 
-  ctx->default_features &= (!OCKAM_VAULT_FEAT_AEAD_AES_GCM);
+  ctx->default_features &= (~OCKAM_VAULT_FEAT_AEAD_AES_GCM);
   ctx->aead_aes_gcm_ctx = 0;
 
 exit:
   return error;
 }
 
-ockam_error_t vault_default_aead_aes_gcm(ockam_vault_t*        vault,
-                                         uint8_t               encrypt,
-                                         ockam_vault_secret_t* key,
-                                         uint16_t              nonce,
-                                         const uint8_t*        additional_data,
-                                         size_t                additional_data_length,
-                                         const uint8_t*        input,
-                                         size_t                input_length,
-                                         uint8_t*              output,
-                                         size_t                output_size,
-                                         size_t*               output_length)
+ockam_error_t vault_default_aead_aes_gcm_backend_select(vault_default_aead_aes_gcm_ctx_t*          aead_aes_gcm_ctx,
+                                                        ockam_vault_default_aead_aes_gcm_backend_t backend)
 {
-  ockam_error_t                     error                                  = OCKAM_ERROR_NONE;
-  ockam_vault_default_context_t*    ctx                                    = 0;
-  vault_default_secret_key_ctx_t*   secret_ctx                             = 0;
-  vault_default_aead_aes_gcm_ctx_t* aead_aes_gcm_ctx                       = 0;
-  size_t                            run_length                             = 0;
-  uint8_t                           iv[VAULT_DEFAULT_AEAD_AES_GCM_IV_SIZE] = { 0 };
+  ockam_error_t                              error    = OCKAM_ERROR_NONE;
+  ockam_vault_default_aead_aes_gcm_backend_t selected = OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_AUTO;
+  const br_block_ctr_class*                  aes_ctr  = 0;
+  br_ghash                                   ghash    = 0;
 
-  if ((vault == 0) || (vault->default_context == 0)) {
+  if (aead_aes_gcm_ctx == 0) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
+  }
+
+  /* The hardware getters return null when the CPU or the compiler lacks support */
+
+  if ((backend == OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_AUTO) ||
+      (backend == OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_X86NI)) {
+    aes_ctr = br_aes_x86ni_ctr_get_vtable();
+    ghash   = br_ghash_pclmul_get();
+
+    if ((aes_ctr != 0) && (ghash != 0)) { selected = OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_X86NI; }
+  }
+
+  if ((selected == OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_AUTO) &&
+      ((backend == OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_AUTO) ||
+       (backend == OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_PWR8))) {
+    aes_ctr = br_aes_pwr8_ctr_get_vtable();
+    ghash   = br_ghash_pwr8_get();
+
+    if ((aes_ctr != 0) && (ghash != 0)) { selected = OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_PWR8; }
+  }
+
+  if ((selected == OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_AUTO) &&
+      ((backend == OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_AUTO) ||
+       (backend == OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_CT))) {
+    aes_ctr  = &br_aes_ct_ctr_vtable;
+    ghash    = br_ghash_ctmul32;
+    selected = OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_CT;
+  }
+
+  if (selected == OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_AUTO) {
+    error = OCKAM_VAULT_ERROR_BACKEND_UNAVAILABLE;
+    goto exit;
+  }
+
+  aead_aes_gcm_ctx->br_aes_ctr = aes_ctr;
+  aead_aes_gcm_ctx->br_ghash   = ghash;
+  aead_aes_gcm_ctx->backend    = selected;
+
+exit:
+  return error;
+}
+
+ockam_error_t ockam_vault_default_aead_aes_gcm_backend_get(ockam_vault_t*                              vault,
+                                                          ockam_vault_default_aead_aes_gcm_backend_t* backend)
+{
+  ockam_error_t                     error            = OCKAM_ERROR_NONE;
+  ockam_vault_default_context_t*    ctx              = 0;
+  vault_default_aead_aes_gcm_ctx_t* aead_aes_gcm_ctx = 0;
+
+  if ((vault == 0) || (backend == 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if (vault->default_context == 0) {
     error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
     goto exit;
   }
@@ -1351,16 +1825,106 @@ ockam_error_t vault_default_aead_aes_gcm(ockam_vault_t*        vault,
 
   aead_aes_gcm_ctx = (vault_default_aead_aes_gcm_ctx_t*) ctx->aead_aes_gcm_ctx;
 
-  if ((aead_aes_gcm_ctx->br_aes_key == 0) || (aead_aes_gcm_ctx->br_aes_gcm_ctx == 0)) {
+  *backend = aead_aes_gcm_ctx->backend;
+
+exit:
+  return error;
+}
+
+ockam_error_t vault_default_aead_aes_gcm_key_init(ockam_vault_default_context_t*  ctx,
+                                                  vault_default_secret_key_ctx_t* secret_ctx)
+{
+  ockam_error_t                     error            = OCKAM_ERROR_NONE;
+  vault_default_aead_aes_gcm_ctx_t* aead_aes_gcm_ctx = 0;
+  vault_default_aead_aes_gcm_key_t* aead_aes_gcm_key = 0;
+
+  if ((ctx == 0) || (ctx->memory == 0) || (secret_ctx == 0) || (secret_ctx->key == 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
+  }
+
+  if ((ctx->aead_aes_gcm_ctx == 0) || (!(ctx->default_features & OCKAM_VAULT_FEAT_AEAD_AES_GCM))) {
+    goto exit; /* No backend selected yet, the schedule is built on first use instead */
+  }
+
+  aead_aes_gcm_ctx = (vault_default_aead_aes_gcm_ctx_t*) ctx->aead_aes_gcm_ctx;
+
+  if ((secret_ctx->key_size != OCKAM_VAULT_AES128_KEY_LENGTH) &&
+      (secret_ctx->key_size != OCKAM_VAULT_AES256_KEY_LENGTH)) {
+    error = OCKAM_VAULT_ERROR_INVALID_SIZE;
+    goto exit;
+  }
+
+  if (secret_ctx->aead_aes_gcm_key == 0) {
+    error = ockam_memory_alloc_zeroed(ctx->memory, (void**) &aead_aes_gcm_key, sizeof(vault_default_aead_aes_gcm_key_t));
+    if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+    secret_ctx->aead_aes_gcm_key = aead_aes_gcm_key;
+  } else {
+    aead_aes_gcm_key = secret_ctx->aead_aes_gcm_key;
+  }
+
+  aead_aes_gcm_ctx->br_aes_ctr->init(&(aead_aes_gcm_key->br_aes_key.vtable), secret_ctx->key, secret_ctx->key_size);
+
+  br_gcm_init(&(aead_aes_gcm_key->br_aes_gcm_ctx), &(aead_aes_gcm_key->br_aes_key.vtable), aead_aes_gcm_ctx->br_ghash);
+
+exit:
+  return error;
+}
+
+ockam_error_t vault_default_aead_aes_gcm_key_deinit(ockam_vault_default_context_t*  ctx,
+                                                    vault_default_secret_key_ctx_t* secret_ctx)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((ctx == 0) || (ctx->memory == 0) || (secret_ctx == 0)) {
     error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
     goto exit;
   }
 
-  if (encrypt) {
-    if (output_size < input_length + OCKAM_VAULT_AEAD_AES_GCM_TAG_LENGTH) {
-      error = OCKAM_VAULT_ERROR_INVALID_SIZE;
-      goto exit;
-    }
+  if (secret_ctx->aead_aes_gcm_key == 0) { goto exit; }
+
+  ockam_memory_set(ctx->memory, secret_ctx->aead_aes_gcm_key, 0, sizeof(vault_default_aead_aes_gcm_key_t));
+
+  error = ockam_memory_free(ctx->memory, secret_ctx->aead_aes_gcm_key, sizeof(vault_default_aead_aes_gcm_key_t));
+
+  secret_ctx->aead_aes_gcm_key = 0;
+
+exit:
+  return error;
+}
+
+ockam_error_t vault_default_aead_aes_gcm_prepare(ockam_vault_t*                   vault,
+                                                 ockam_vault_secret_t*            key,
+                                                 vault_default_secret_key_ctx_t** secret_ctx)
+{
+  ockam_error_t                     error            = OCKAM_ERROR_NONE;
+  ockam_vault_default_context_t*    ctx              = 0;
+  vault_default_aead_aes_gcm_ctx_t* aead_aes_gcm_ctx = 0;
+  vault_default_secret_key_ctx_t*   key_ctx          = 0;
+
+  if ((vault == 0) || (vault->default_context == 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
+  }
+
+  if ((key == 0) || (secret_ctx == 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  ctx = (ockam_vault_default_context_t*) vault->default_context;
+
+  if ((ctx->aead_aes_gcm_ctx == 0) || (!(ctx->default_features & OCKAM_VAULT_FEAT_AEAD_AES_GCM))) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
+  }
+
+  aead_aes_gcm_ctx = (vault_default_aead_aes_gcm_ctx_t*) ctx->aead_aes_gcm_ctx;
+
+  if (aead_aes_gcm_ctx->br_aes_gcm_ctx == 0) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
   }
 
   if ((key->attributes.type != OCKAM_VAULT_SECRET_TYPE_AES128_KEY) &&
@@ -1374,37 +1938,86 @@ ockam_error_t vault_default_aead_aes_gcm(ockam_vault_t*        vault,
     goto exit;
   }
 
-  secret_ctx = (vault_default_secret_key_ctx_t*) key->context;
+  key_ctx = (vault_default_secret_key_ctx_t*) key->context;
 
-  {
-    int n = 1;
-
-    if (*(char*) &n == 1) { /* Check the endianness and copy appropriately */
-      iv[VAULT_DEFAULT_AEAD_AES_GCM_IV_OFFSET]     = ((nonce >> 8) & 0xFF);
-      iv[VAULT_DEFAULT_AEAD_AES_GCM_IV_OFFSET + 1] = ((nonce) &0xFF);
-    } else {
-      iv[VAULT_DEFAULT_AEAD_AES_GCM_IV_OFFSET]     = ((nonce) &0xFF);
-      iv[VAULT_DEFAULT_AEAD_AES_GCM_IV_OFFSET + 1] = ((nonce >> 8) & 0xFF);
-    }
+  if (key_ctx->aead_aes_gcm_key == 0) { /* Secrets typed as AES keys are expanded up front, this is a fallback */
+    error = vault_default_aead_aes_gcm_key_init(ctx, key_ctx);
+    if (error != OCKAM_ERROR_NONE) { goto exit; }
   }
 
-  br_aes_ct_ctr_init(aead_aes_gcm_ctx->br_aes_key, secret_ctx->key, secret_ctx->key_size);
+  if (key_ctx->aead_aes_gcm_key == 0) {
+    error = OCKAM_VAULT_ERROR_INVALID_CONTEXT;
+    goto exit;
+  }
 
-  br_gcm_init(aead_aes_gcm_ctx->br_aes_gcm_ctx, &(aead_aes_gcm_ctx->br_aes_key->vtable), br_ghash_ctmul32);
+  *secret_ctx = key_ctx;
 
-  br_gcm_reset(aead_aes_gcm_ctx->br_aes_gcm_ctx, &iv[0], VAULT_DEFAULT_AEAD_AES_GCM_IV_SIZE);
+exit:
+  return error;
+}
 
-  br_gcm_aad_inject(aead_aes_gcm_ctx->br_aes_gcm_ctx, additional_data, additional_data_length);
+ockam_error_t vault_default_aead_aes_gcm_run(ockam_vault_default_context_t*  ctx,
+                                             vault_default_secret_key_ctx_t* secret_ctx,
+                                             uint8_t                         encrypt,
+                                             uint64_t                        nonce,
+                                             const uint8_t*                  additional_data,
+                                             size_t                          additional_data_length,
+                                             const uint8_t*                  input,
+                                             size_t                          input_length,
+                                             uint8_t*                        output,
+                                             size_t                          output_size,
+                                             size_t*                         output_length)
+{
+  ockam_error_t                     error                                  = OCKAM_ERROR_NONE;
+  vault_default_aead_aes_gcm_ctx_t* aead_aes_gcm_ctx                       = 0;
+  size_t                            run_length                             = 0;
+  uint8_t                           iv[VAULT_DEFAULT_AEAD_AES_GCM_IV_SIZE] = { 0 };
 
-  br_gcm_flip(aead_aes_gcm_ctx->br_aes_gcm_ctx);
+  if ((output == 0) || (output_length == 0) || ((input == 0) && (input_length != 0))) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
 
   if (encrypt == VAULT_DEFAULT_AEAD_AES_GCM_ENCRYPT) {
+    if (output_size < input_length + OCKAM_VAULT_AEAD_AES_GCM_TAG_LENGTH) {
+      error = OCKAM_VAULT_ERROR_INVALID_SIZE;
+      goto exit;
+    }
+
     run_length = input_length;
   } else {
+    if ((input_length < OCKAM_VAULT_AEAD_AES_GCM_TAG_LENGTH) ||
+        (output_size < input_length - OCKAM_VAULT_AEAD_AES_GCM_TAG_LENGTH)) {
+      error = OCKAM_VAULT_ERROR_INVALID_SIZE;
+      goto exit;
+    }
+
     run_length = input_length - OCKAM_VAULT_AEAD_AES_GCM_TAG_LENGTH;
   }
 
-  ockam_memory_copy(ctx->memory, output, input, run_length);
+  aead_aes_gcm_ctx = (vault_default_aead_aes_gcm_ctx_t*) ctx->aead_aes_gcm_ctx;
+
+  {
+    size_t i = 0;
+
+    /* 32 zero bits followed by the 64-bit big-endian nonce */
+    for (i = 0; i < sizeof(nonce); i++) {
+      iv[VAULT_DEFAULT_AEAD_AES_GCM_IV_OFFSET + i] = (uint8_t)(nonce >> (8 * (sizeof(nonce) - 1 - i)));
+    }
+  }
+
+  ockam_memory_copy(ctx->memory,
+                    aead_aes_gcm_ctx->br_aes_gcm_ctx,
+                    &(secret_ctx->aead_aes_gcm_key->br_aes_gcm_ctx),
+                    sizeof(br_gcm_context));
+
+  br_gcm_reset(aead_aes_gcm_ctx->br_aes_gcm_ctx, &iv[0], VAULT_DEFAULT_AEAD_AES_GCM_IV_SIZE);
+
+  br_gcm_aad_inject(aead_aes_gcm_ctx->br_aes_gcm_ctx, additional_data, additional_data_length);
+
+  br_gcm_flip(aead_aes_gcm_ctx->br_aes_gcm_ctx);
+
+  if (output != input) { ockam_memory_copy(ctx->memory, output, input, run_length); }
 
   br_gcm_run(aead_aes_gcm_ctx->br_aes_gcm_ctx, encrypt, output, run_length);
 
@@ -1425,9 +2038,84 @@ exit:
   return error;
 }
 
+ockam_error_t vault_default_aead_aes_gcm(ockam_vault_t*        vault,
+                                         uint8_t               encrypt,
+                                         ockam_vault_secret_t* key,
+                                         uint64_t              nonce,
+                                         const uint8_t*        additional_data,
+                                         size_t                additional_data_length,
+                                         const uint8_t*        input,
+                                         size_t                input_length,
+                                         uint8_t*              output,
+                                         size_t                output_size,
+                                         size_t*               output_length)
+{
+  ockam_error_t                   error      = OCKAM_ERROR_NONE;
+  vault_default_secret_key_ctx_t* secret_ctx = 0;
+
+  error = vault_default_aead_aes_gcm_prepare(vault, key, &secret_ctx);
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  error = vault_default_aead_aes_gcm_run((ockam_vault_default_context_t*) vault->default_context,
+                                         secret_ctx,
+                                         encrypt,
+                                         nonce,
+                                         additional_data,
+                                         additional_data_length,
+                                         input,
+                                         input_length,
+                                         output,
+                                         output_size,
+                                         output_length);
+
+exit:
+  return error;
+}
+
+ockam_error_t vault_default_aead_aes_gcm_batch(ockam_vault_t*                      vault,
+                                               uint8_t                             encrypt,
+                                               ockam_vault_secret_t*               key,
+                                               ockam_vault_aead_aes_gcm_message_t* messages,
+                                               size_t                              messages_count)
+{
+  ockam_error_t                   error      = OCKAM_ERROR_NONE;
+  vault_default_secret_key_ctx_t* secret_ctx = 0;
+  size_t                          i          = 0;
+
+  if ((messages == 0) && (messages_count != 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  error = vault_default_aead_aes_gcm_prepare(vault, key, &secret_ctx);
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  for (i = 0; i < messages_count; i++) {
+    ockam_vault_aead_aes_gcm_message_t* message = &messages[i];
+
+    message->output_length = 0;
+    message->error         = vault_default_aead_aes_gcm_run((ockam_vault_default_context_t*) vault->default_context,
+                                                    secret_ctx,
+                                                    encrypt,
+                                                    message->nonce,
+                                                    message->additional_data,
+                                                    message->additional_data_length,
+                                                    message->input,
+                                                    message->input_length,
+                                                    message->output,
+                                                    message->output_size,
+                                                    &(message->output_length));
+
+    if ((message->error != OCKAM_ERROR_NONE) && (error == OCKAM_ERROR_NONE)) { error = message->error; }
+  }
+
+exit:
+  return error;
+}
+
 ockam_error_t vault_default_aead_aes_gcm_encrypt(ockam_vault_t*        vault,
                                                  ockam_vault_secret_t* key,
-                                                 uint16_t              nonce,
+                                                 uint64_t              nonce,
                                                  const uint8_t*        additional_data,
                                                  size_t                additional_data_length,
                                                  const uint8_t*        plaintext,
@@ -1451,7 +2139,7 @@ ockam_error_t vault_default_aead_aes_gcm_encrypt(ockam_vault_t*        vault,
 
 ockam_error_t vault_default_aead_aes_gcm_decrypt(ockam_vault_t*        vault,
                                                  ockam_vault_secret_t* key,
-                                                 uint16_t              nonce,
+                                                 uint64_t              nonce,
                                                  const uint8_t*        additional_data,
                                                  size_t                additional_data_length,
                                                  const uint8_t*        ciphertext_and_tag,
@@ -1472,3 +2160,64 @@ ockam_error_t vault_default_aead_aes_gcm_decrypt(ockam_vault_t*        vault,
                                     plaintext_size,
                                     plaintext_length);
 }
+
+ockam_error_t vault_default_aead_aes_gcm_encrypt_batch(ockam_vault_t*                      vault,
+                                                       ockam_vault_secret_t*               key,
+                                                       ockam_vault_aead_aes_gcm_message_t* messages,
+                                                       size_t                              messages_count)
+{
+  return vault_default_aead_aes_gcm_batch(vault, VAULT_DEFAULT_AEAD_AES_GCM_ENCRYPT, key, messages, messages_count);
+}
+
+ockam_error_t vault_default_aead_aes_gcm_decrypt_batch(ockam_vault_t*                      vault,
+                                                       ockam_vault_secret_t*               key,
+                                                       ockam_vault_aead_aes_gcm_message_t* messages,
+                                                       size_t                              messages_count)
+{
+  return vault_default_aead_aes_gcm_batch(vault, VAULT_DEFAULT_AEAD_AES_GCM_DECRYPT, key, messages, messages_count);
+}
+
+ockam_error_t vault_default_aead_aes_gcm_encrypt_in_place(ockam_vault_t*        vault,
+                                                          ockam_vault_secret_t* key,
+                                                          uint64_t              nonce,
+                                                          const uint8_t*        additional_data,
+                                                          size_t                additional_data_length,
+                                                          uint8_t*              buffer,
+                                                          size_t                plaintext_length,
+                                                          size_t                buffer_size,
+                                                          size_t*               ciphertext_and_tag_length)
+{
+  return vault_default_aead_aes_gcm(vault,
+                                    VAULT_DEFAULT_AEAD_AES_GCM_ENCRYPT,
+                                    key,
+                                    nonce,
+                                    additional_data,
+                                    additional_data_length,
+                                    buffer,
+                                    plaintext_length,
+                                    buffer,
+                                    buffer_size,
+                                    ciphertext_and_tag_length);
+}
+
+ockam_error_t vault_default_aead_aes_gcm_decrypt_in_place(ockam_vault_t*        vault,
+                                                          ockam_vault_secret_t* key,
+                                                          uint64_t              nonce,
+                                                          const uint8_t*        additional_data,
+                                                          size_t                additional_data_length,
+                                                          uint8_t*              buffer,
+                                                          size_t                ciphertext_and_tag_length,
+                                                          size_t*               plaintext_length)
+{
+  return vault_default_aead_aes_gcm(vault,
+                                    VAULT_DEFAULT_AEAD_AES_GCM_DECRYPT,
+                                    key,
+                                    nonce,
+                                    additional_data,
+                                    additional_data_length,
+                                    buffer,
+                                    ciphertext_and_tag_length,
+                                    buffer,
+                                    ciphertext_and_tag_length,
+                                    plaintext_length);
+}
@@ -13,19 +13,45 @@
 
 #include "ockam/vault/impl.h"
 
+/**
+ * @enum    ockam_vault_default_aead_aes_gcm_backend_t
+ * @brief   AES and GHASH implementations the default vault can use for AES-GCM.
+ */
+typedef enum {
+  OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_AUTO = 0, /* Fastest backend supported by the CPU */
+  OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_CT,       /* Portable constant-time software AES and GHASH */
+  OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_X86NI,    /* AES-NI and PCLMULQDQ */
+  OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_PWR8,     /* POWER8 crypto extensions */
+} ockam_vault_default_aead_aes_gcm_backend_t;
+
+/**
+ * @enum    ockam_vault_default_ec_backend_t
+ * @brief   Elliptic curve implementations the default vault can use for key generation and ECDH.
+ */
+typedef enum {
+  OCKAM_VAULT_DEFAULT_EC_BACKEND_AUTO = 0, /* Fastest backend supported by the CPU and the compiler */
+  OCKAM_VAULT_DEFAULT_EC_BACKEND_I31,      /* Generic 31-bit integer code, the slowest */
+  OCKAM_VAULT_DEFAULT_EC_BACKEND_M31,      /* Curve specific code with 32-bit multiplications */
+  OCKAM_VAULT_DEFAULT_EC_BACKEND_M62,      /* Curve specific code with 64-bit multiplications, 62-bit limbs */
+  OCKAM_VAULT_DEFAULT_EC_BACKEND_M64,      /* Curve specific code with 64-bit multiplications, 64-bit limbs */
+} ockam_vault_default_ec_backend_t;
+
 /**
  * @struct  ockam_vault_default_common_ctx_t
  * @brief   TBD
  */
 typedef struct {
-  ockam_memory_t* memory;
-  ockam_random_t* random;
-  uint32_t        features;
-  uint32_t        default_features;
-  void*           random_ctx;
-  void*           sha256_ctx;
-  void*           hkdf_sha256_ctx;
-  void*           aead_aes_gcm_ctx;
+  ockam_memory_t*                            memory;
+  ockam_random_t*                            random;
+  uint32_t                                   features;
+  uint32_t                                   default_features;
+  ockam_vault_default_aead_aes_gcm_backend_t aead_aes_gcm_backend;
+  ockam_vault_default_ec_backend_t           ec_backend;
+  void*                                      random_ctx;
+  void*                                      sha256_ctx;
+  void*                                      ecdh_ctx;
+  void*                                      hkdf_sha256_ctx;
+  void*                                      aead_aes_gcm_ctx;
 } ockam_vault_default_context_t;
 
 /**
@@ -33,13 +59,32 @@ typedef struct {
  * @brief
  */
 typedef struct {
-  ockam_memory_t* memory;
-  ockam_random_t* random;
-  uint32_t        features;
+  ockam_memory_t*                            memory;
+  ockam_random_t*                            random;
+  uint32_t                                   features;
+  ockam_vault_default_aead_aes_gcm_backend_t aead_aes_gcm_backend;
+  ockam_vault_default_ec_backend_t           ec_backend;
 } ockam_vault_default_attributes_t;
 
 ockam_error_t ockam_vault_default_init(ockam_vault_t* vault, ockam_vault_default_attributes_t* vault_attributes);
 
+/**
+ * @brief   Get the AES-GCM backend the default vault selected at initialization
+ * @param   vault[in]     Default vault with the AEAD AES GCM feature initialized
+ * @param   backend[out]  Backend in use, never OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_AUTO
+ * @return  OCKAM_ERROR_NONE on success.
+ */
+ockam_error_t ockam_vault_default_aead_aes_gcm_backend_get(ockam_vault_t*                              vault,
+                                                          ockam_vault_default_aead_aes_gcm_backend_t* backend);
+
+/**
+ * @brief   Get the elliptic curve backend the default vault selected at initialization
+ * @param   vault[in]     Default vault with the ECDH feature initialized
+ * @param   backend[out]  Backend in use, never OCKAM_VAULT_DEFAULT_EC_BACKEND_AUTO
+ * @return  OCKAM_ERROR_NONE on success.
+ */
+ockam_error_t ockam_vault_default_ec_backend_get(ockam_vault_t* vault, ockam_vault_default_ec_backend_t* backend);
+
 ockam_error_t vault_default_deinit(ockam_vault_t* vault);
 
 ockam_error_t vault_default_random(ockam_vault_t* vault, uint8_t* buffer, size_t buffer_size);
@@ -51,10 +96,28 @@ ockam_error_t vault_default_sha256(ockam_vault_t* vault,
                                    size_t         digest_size,
                                    size_t*        digest_length);
 
+ockam_error_t vault_default_sha256_stream_init(ockam_vault_t* vault, ockam_vault_sha256_ctx_t* sha256);
+
+ockam_error_t vault_default_sha256_stream_update(ockam_vault_t*            vault,
+                                                 ockam_vault_sha256_ctx_t* sha256,
+                                                 const uint8_t*            input,
+                                                 size_t                    input_length);
+
+ockam_error_t vault_default_sha256_stream_final(ockam_vault_t*            vault,
+                                                ockam_vault_sha256_ctx_t* sha256,
+                                                uint8_t*                  digest,
+                                                size_t                    digest_size,
+                                                size_t*                   digest_length);
+
 ockam_error_t vault_default_secret_generate(ockam_vault_t*                         vault,
                                             ockam_vault_secret_t*                  secret,
                                             const ockam_vault_secret_attributes_t* attributes);
 
+ockam_error_t vault_default_secret_generate_batch(ockam_vault_t*                         vault,
+                                                  ockam_vault_secret_t*                  secrets,
+                                                  const ockam_vault_secret_attributes_t* attributes,
+                                                  size_t                                 secrets_count);
+
 ockam_error_t vault_default_secret_import(ockam_vault_t*                         vault,
                                           ockam_vault_secret_t*                  secret,
                                           const ockam_vault_secret_attributes_t* attributes,
@@ -88,6 +151,9 @@ ockam_error_t vault_default_ecdh(ockam_vault_t*        vault,
                                  size_t                peer_publickey_length,
                                  ockam_vault_secret_t* shared_secret);
 
+ockam_error_t
+vault_default_ecdh_batch(ockam_vault_t* vault, ockam_vault_ecdh_message_t* messages, size_t messages_count);
+
 ockam_error_t vault_default_hkdf_sha256(ockam_vault_t*        vault,
                                         ockam_vault_secret_t* salt,
                                         ockam_vault_secret_t* input_key_material,
@@ -96,7 +162,7 @@ ockam_error_t vault_default_hkdf_sha256(ockam_vault_t*        vault,
 
 ockam_error_t vault_default_aead_aes_gcm_encrypt(ockam_vault_t*        vault,
                                                  ockam_vault_secret_t* key,
-                                                 uint16_t              nonce,
+                                                 uint64_t              nonce,
                                                  const uint8_t*        additional_data,
                                                  size_t                additional_data_length,
                                                  const uint8_t*        plaintext,
@@ -107,7 +173,7 @@ ockam_error_t vault_default_aead_aes_gcm_encrypt(ockam_vault_t*        vault,
 
 ockam_error_t vault_default_aead_aes_gcm_decrypt(ockam_vault_t*        vault,
                                                  ockam_vault_secret_t* key,
-                                                 uint16_t              nonce,
+                                                 uint64_t              nonce,
                                                  const uint8_t*        additional_data,
                                                  size_t                additional_data_length,
                                                  const uint8_t*        ciphertext_and_tag,
@@ -116,4 +182,33 @@ ockam_error_t vault_default_aead_aes_gcm_decrypt(ockam_vault_t*        vault,
                                                  size_t                plaintext_size,
                                                  size_t*               plaintext_length);
 
+ockam_error_t vault_default_aead_aes_gcm_encrypt_batch(ockam_vault_t*                      vault,
+                                                       ockam_vault_secret_t*               key,
+                                                       ockam_vault_aead_aes_gcm_message_t* messages,
+                                                       size_t                              messages_count);
+
+ockam_error_t vault_default_aead_aes_gcm_decrypt_batch(ockam_vault_t*                      vault,
+                                                       ockam_vault_secret_t*               key,
+                                                       ockam_vault_aead_aes_gcm_message_t* messages,
+                                                       size_t                              messages_count);
+
+ockam_error_t vault_default_aead_aes_gcm_encrypt_in_place(ockam_vault_t*        vault,
+                                                          ockam_vault_secret_t* key,
+                                                          uint64_t              nonce,
+                                                          const uint8_t*        additional_data,
+                                                          size_t                additional_data_length,
+                                                          uint8_t*              buffer,
+                                                          size_t                plaintext_length,
+                                                          size_t                buffer_size,
+                                                          size_t*               ciphertext_and_tag_length);
+
+ockam_error_t vault_default_aead_aes_gcm_decrypt_in_place(ockam_vault_t*        vault,
+                                                          ockam_vault_secret_t* key,
+                                                          uint64_t              nonce,
+                                                          const uint8_t*        additional_data,
+                                                          size_t                additional_data_length,
+                                                          uint8_t*              buffer,
+                                                          size_t                ciphertext_and_tag_length,
+                                                          size_t*               plaintext_length);
+
 #endif
@@ -0,0 +1,200 @@
+/**
+ * @file        bench_aead_aes_gcm.c
+ * @brief       Per-message cost of AES-GCM in the default vault
+ *
+ * The baseline column re-expands the software AES key schedule and GHASH key for every message, which is what the
+ * default vault did before key schedules were cached per secret. The remaining columns go through the vault API with
+ * each AES-GCM backend forced in turn; backends the machine does not support are shown as '-'.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "ockam/error.h"
+#include "ockam/memory.h"
+#include "ockam/random.h"
+#include "ockam/vault.h"
+
+#include "ockam/memory/stdlib.h"
+#include "ockam/random/urandom.h"
+#include "ockam/vault/default.h"
+
+#include "bearssl.h"
+
+#define BENCH_AEAD_AES_GCM_ITERATIONS 100000u
+#define BENCH_AEAD_AES_GCM_MAX_SIZE   1024u
+#define BENCH_AEAD_AES_GCM_IV_SIZE    12u
+
+static const size_t g_bench_sizes[] = { 16, 64, 256, 1024 };
+
+static uint8_t g_key[OCKAM_VAULT_AES256_KEY_LENGTH] = { 0x31, 0xBD, 0xAD, 0xD9, 0x66, 0x98, 0xC2, 0x04,
+                                                        0xAA, 0x9C, 0xE1, 0x44, 0x8E, 0xA9, 0x4A, 0xE1,
+                                                        0xFB, 0x4A, 0x9A, 0x0B, 0x3C, 0x9D, 0x77, 0x3B,
+                                                        0x51, 0xBB, 0x18, 0x22, 0x66, 0x6B, 0x8F, 0x22 };
+
+static uint8_t g_aad[16]                                                                   = { 0 };
+static uint8_t g_input[BENCH_AEAD_AES_GCM_MAX_SIZE]                                        = { 0 };
+static uint8_t g_output[BENCH_AEAD_AES_GCM_MAX_SIZE + OCKAM_VAULT_AEAD_AES_GCM_TAG_LENGTH] = { 0 };
+
+/**
+ * @brief   Read a cycle counter where one is available, monotonic nanoseconds otherwise
+ */
+static uint64_t bench_ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec * 1000000000u) + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief   Encrypt with a full key expansion per message, as the vault did before caching
+ */
+static uint64_t bench_baseline(size_t size, uint32_t iterations)
+{
+  br_aes_ct_ctr_keys aes_key;
+  br_gcm_context     gcm_ctx;
+  uint8_t            iv[BENCH_AEAD_AES_GCM_IV_SIZE] = { 0 };
+  uint64_t           start                          = 0;
+  uint32_t           i                              = 0;
+
+  start = bench_ticks();
+
+  for (i = 0; i < iterations; i++) {
+    iv[10] = (uint8_t)(i >> 8);
+    iv[11] = (uint8_t) i;
+
+    br_aes_ct_ctr_init(&aes_key, g_key, sizeof(g_key));
+    br_gcm_init(&gcm_ctx, &aes_key.vtable, br_ghash_ctmul32);
+    br_gcm_reset(&gcm_ctx, iv, sizeof(iv));
+    br_gcm_aad_inject(&gcm_ctx, g_aad, sizeof(g_aad));
+    br_gcm_flip(&gcm_ctx);
+    memcpy(g_output, g_input, size);
+    br_gcm_run(&gcm_ctx, 1, g_output, size);
+    br_gcm_get_tag(&gcm_ctx, g_output + size);
+  }
+
+  return (bench_ticks() - start) / iterations;
+}
+
+/**
+ * @brief   Encrypt through the vault API using the schedule cached on the secret
+ */
+static ockam_error_t
+bench_vault(ockam_vault_t* vault, ockam_vault_secret_t* key, size_t size, uint32_t iterations, uint64_t* ticks)
+{
+  ockam_error_t error  = OCKAM_ERROR_NONE;
+  size_t        length = 0;
+  uint64_t      start  = 0;
+  uint32_t      i      = 0;
+
+  start = bench_ticks();
+
+  for (i = 0; i < iterations; i++) {
+    error = ockam_vault_aead_aes_gcm_encrypt(
+      vault, key, (uint16_t) i, g_aad, sizeof(g_aad), g_input, size, g_output, sizeof(g_output), &length);
+    if (error != OCKAM_ERROR_NONE) { goto exit; }
+  }
+
+  *ticks = (bench_ticks() - start) / iterations;
+
+exit:
+  return error;
+}
+
+int main(int argc, char* argv[])
+{
+  int                                        rc               = 0;
+  ockam_error_t                              error            = OCKAM_ERROR_NONE;
+  ockam_memory_t                             memory           = { 0 };
+  ockam_random_t                             random           = { 0 };
+  ockam_vault_default_attributes_t           vault_attributes = { .memory = &memory, .random = &random };
+  ockam_vault_t                              vaults[3]        = { { 0 } };
+  ockam_vault_secret_t                       keys[3]          = { { { 0 } } };
+  uint8_t                                    available[3]     = { 0 };
+  ockam_vault_default_aead_aes_gcm_backend_t backends[3]      = { OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_CT,
+                                                             OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_X86NI,
+                                                             OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_PWR8 };
+  ockam_vault_secret_attributes_t            key_attributes   = { .length      = OCKAM_VAULT_AES256_KEY_LENGTH,
+                                                               .type        = OCKAM_VAULT_SECRET_TYPE_AES256_KEY,
+                                                               .purpose     = OCKAM_VAULT_SECRET_PURPOSE_KEY_AGREEMENT,
+                                                               .persistence = OCKAM_VAULT_SECRET_EPHEMERAL };
+  uint32_t                                   iterations       = BENCH_AEAD_AES_GCM_ITERATIONS;
+  size_t                                     i                = 0;
+  size_t                                     j                = 0;
+
+  if (argc > 1) { iterations = (uint32_t) strtoul(argv[1], 0, 10); }
+  if (iterations == 0) { iterations = BENCH_AEAD_AES_GCM_ITERATIONS; }
+
+  error = ockam_memory_stdlib_init(&memory);
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  error = ockam_random_urandom_init(&random);
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  for (j = 0; j < sizeof(backends) / sizeof(backends[0]); j++) {
+    vault_attributes.aead_aes_gcm_backend = backends[j];
+
+    error = ockam_vault_default_init(&vaults[j], &vault_attributes);
+    if (error == OCKAM_VAULT_ERROR_BACKEND_UNAVAILABLE) {
+      error = OCKAM_ERROR_NONE;
+      continue;
+    }
+    if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+    error = ockam_vault_secret_import(&vaults[j], &keys[j], &key_attributes, g_key, sizeof(g_key));
+    if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+    available[j] = 1;
+  }
+
+#if defined(__x86_64__) || defined(__i386__)
+  printf("AES-256-GCM encrypt, %u iterations, cycles/message\n", iterations);
+#else
+  printf("AES-256-GCM encrypt, %u iterations, ns/message\n", iterations);
+#endif
+  printf("%8s %12s %12s %12s %12s\n", "size", "baseline", "ct", "x86ni", "pwr8");
+
+  for (i = 0; i < sizeof(g_bench_sizes) / sizeof(g_bench_sizes[0]); i++) {
+    printf("%8zu %12llu", g_bench_sizes[i], (unsigned long long) bench_baseline(g_bench_sizes[i], iterations));
+
+    for (j = 0; j < sizeof(backends) / sizeof(backends[0]); j++) {
+      uint64_t ticks = 0;
+
+      if (!available[j]) {
+        printf(" %12s", "-");
+        continue;
+      }
+
+      error = bench_vault(&vaults[j], &keys[j], g_bench_sizes[i], iterations, &ticks);
+      if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+      printf(" %12llu", (unsigned long long) ticks);
+    }
+
+    printf("\n");
+  }
+
+exit:
+  for (j = 0; j < sizeof(backends) / sizeof(backends[0]); j++) {
+    if (keys[j].context != 0) { ockam_vault_secret_destroy(&vaults[j], &keys[j]); }
+    if (vaults[j].default_context != 0) { ockam_vault_deinit(&vaults[j]); }
+  }
+
+  if (error != OCKAM_ERROR_NONE) {
+    printf("FAIL: %d\n", error);
+    rc = -1;
+  }
+
+  return rc;
+}
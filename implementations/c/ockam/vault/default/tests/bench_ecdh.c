@@ -0,0 +1,211 @@
+/**
+ * @file        bench_ecdh.c
+ * @brief       Curve25519 key generation and ECDH rates of the default vault per elliptic curve backend
+ *
+ * Each backend is forced in turn; backends the build does not support are shown as '-'. A keypair is a generated
+ * private key and its public key, as a handshake uses them. The batch columns run the same operations through
+ * ockam_vault_secret_generate_batch and ockam_vault_ecdh_batch, BENCH_ECDH_BATCH_SIZE at a time.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ockam/error.h"
+#include "ockam/memory.h"
+#include "ockam/random.h"
+#include "ockam/vault.h"
+
+#include "ockam/memory/stdlib.h"
+#include "ockam/random/urandom.h"
+#include "ockam/vault/default.h"
+
+#define BENCH_ECDH_ITERATIONS 2048u
+#define BENCH_ECDH_BATCH_SIZE 32u
+
+static const ockam_vault_secret_attributes_t g_attributes = {
+  .length      = 0,
+  .type        = OCKAM_VAULT_SECRET_TYPE_CURVE25519_PRIVATEKEY,
+  .purpose     = OCKAM_VAULT_SECRET_PURPOSE_KEY_AGREEMENT,
+  .persistence = OCKAM_VAULT_SECRET_EPHEMERAL,
+};
+
+static ockam_vault_secret_t       g_secrets[BENCH_ECDH_BATCH_SIZE];
+static ockam_vault_secret_t       g_shared_secrets[BENCH_ECDH_BATCH_SIZE];
+static ockam_vault_ecdh_message_t g_messages[BENCH_ECDH_BATCH_SIZE];
+static uint8_t                    g_publickey[OCKAM_VAULT_CURVE25519_PUBLICKEY_LENGTH];
+
+static uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec * 1000000000u) + (uint64_t) ts.tv_nsec;
+}
+
+/**
+ * @brief   Generate keypairs, one call or one batch at a time, and report them per second
+ */
+static ockam_error_t bench_keygen(ockam_vault_t* vault, uint8_t batch, uint32_t iterations, double* rate)
+{
+  ockam_error_t error  = OCKAM_ERROR_NONE;
+  size_t        count  = batch ? BENCH_ECDH_BATCH_SIZE : 1;
+  size_t        length = 0;
+  size_t        i      = 0;
+  uint32_t      done   = 0;
+  uint64_t      start  = 0;
+
+  start = bench_now_ns();
+
+  for (done = 0; done < iterations; done += count) {
+    if (batch) {
+      error = ockam_vault_secret_generate_batch(vault, g_secrets, &g_attributes, count);
+    } else {
+      error = ockam_vault_secret_generate(vault, &g_secrets[0], &g_attributes);
+    }
+    if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+    for (i = 0; i < count; i++) {
+      error = ockam_vault_secret_publickey_get(vault, &g_secrets[i], g_publickey, sizeof(g_publickey), &length);
+      if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+      ockam_vault_secret_destroy(vault, &g_secrets[i]);
+    }
+  }
+
+  *rate = (double) done / ((double) (bench_now_ns() - start) / 1e9);
+
+exit:
+  return error;
+}
+
+/**
+ * @brief   Run ECDH with one private key against one peer, one call or one batch at a time, and report it per second
+ */
+static ockam_error_t bench_ecdh(ockam_vault_t* vault, uint8_t batch, uint32_t iterations, double* rate)
+{
+  ockam_error_t        error      = OCKAM_ERROR_NONE;
+  ockam_vault_secret_t privatekey = { 0 };
+  size_t               count      = batch ? BENCH_ECDH_BATCH_SIZE : 1;
+  size_t               length     = 0;
+  size_t               i          = 0;
+  uint32_t             done       = 0;
+  uint64_t             start      = 0;
+
+  error = ockam_vault_secret_generate(vault, &privatekey, &g_attributes);
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  error = ockam_vault_secret_publickey_get(vault, &privatekey, g_publickey, sizeof(g_publickey), &length);
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  for (i = 0; i < BENCH_ECDH_BATCH_SIZE; i++) {
+    g_messages[i].privatekey            = &privatekey;
+    g_messages[i].peer_publickey        = g_publickey;
+    g_messages[i].peer_publickey_length = length;
+    g_messages[i].shared_secret         = &g_shared_secrets[i];
+  }
+
+  start = bench_now_ns();
+
+  for (done = 0; done < iterations; done += count) {
+    if (batch) {
+      error = ockam_vault_ecdh_batch(vault, g_messages, count);
+    } else {
+      error = ockam_vault_ecdh(vault, &privatekey, g_publickey, length, &g_shared_secrets[0]);
+    }
+    if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+    for (i = 0; i < count; i++) { ockam_vault_secret_destroy(vault, &g_shared_secrets[i]); }
+  }
+
+  *rate = (double) done / ((double) (bench_now_ns() - start) / 1e9);
+
+exit:
+  if (privatekey.context != 0) { ockam_vault_secret_destroy(vault, &privatekey); }
+  return error;
+}
+
+int main(int argc, char* argv[])
+{
+  int                              rc               = 0;
+  ockam_error_t                    error            = OCKAM_ERROR_NONE;
+  ockam_memory_t                   memory           = { 0 };
+  ockam_random_t                   random           = { 0 };
+  ockam_vault_default_attributes_t vault_attributes = { .memory = &memory, .random = &random };
+  ockam_vault_t                    vault            = { 0 };
+  ockam_vault_default_ec_backend_t backends[4]      = { OCKAM_VAULT_DEFAULT_EC_BACKEND_I31,
+                                                   OCKAM_VAULT_DEFAULT_EC_BACKEND_M31,
+                                                   OCKAM_VAULT_DEFAULT_EC_BACKEND_M62,
+                                                   OCKAM_VAULT_DEFAULT_EC_BACKEND_M64 };
+  const char*                      names[4]         = { "i31", "m31", "m62", "m64" };
+  ockam_vault_default_ec_backend_t selected         = OCKAM_VAULT_DEFAULT_EC_BACKEND_AUTO;
+  uint32_t                         iterations       = BENCH_ECDH_ITERATIONS;
+  double                           rates[4]         = { 0 };
+  size_t                           i                = 0;
+
+  if (argc > 1) { iterations = (uint32_t) strtoul(argv[1], 0, 10); }
+  if (iterations == 0) { iterations = BENCH_ECDH_ITERATIONS; }
+
+  error = ockam_memory_stdlib_init(&memory);
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  error = ockam_random_urandom_init(&random);
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  error = ockam_vault_default_init(&vault, &vault_attributes);
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  error = ockam_vault_default_ec_backend_get(&vault, &selected);
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  ockam_vault_deinit(&vault);
+
+  printf("Curve25519, %u operations, operations/second, batches of %u\n", iterations, BENCH_ECDH_BATCH_SIZE);
+  printf("%8s %14s %14s %14s %14s\n", "backend", "keypair", "keypair batch", "ecdh", "ecdh batch");
+
+  for (i = 0; i < sizeof(backends) / sizeof(backends[0]); i++) {
+    vault_attributes.ec_backend = backends[i];
+
+    error = ockam_vault_default_init(&vault, &vault_attributes);
+    if (error == OCKAM_VAULT_ERROR_BACKEND_UNAVAILABLE) {
+      printf("%8s %14s %14s %14s %14s\n", names[i], "-", "-", "-", "-");
+      error = OCKAM_ERROR_NONE;
+      continue;
+    }
+    if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+    error = bench_keygen(&vault, 0, iterations, &rates[0]);
+    if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+    error = bench_keygen(&vault, 1, iterations, &rates[1]);
+    if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+    error = bench_ecdh(&vault, 0, iterations, &rates[2]);
+    if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+    error = bench_ecdh(&vault, 1, iterations, &rates[3]);
+    if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+    printf("%8s %14.0f %14.0f %14.0f %14.0f%s\n",
+           names[i],
+           rates[0],
+           rates[1],
+           rates[2],
+           rates[3],
+           (backends[i] == selected) ? "  (auto)" : "");
+
+    ockam_vault_deinit(&vault);
+    memset(&vault, 0, sizeof(vault));
+  }
+
+exit:
+  if (vault.default_context != 0) { ockam_vault_deinit(&vault); }
+
+  if (error != OCKAM_ERROR_NONE) {
+    printf("FAIL: %d\n", error);
+    rc = -1;
+  }
+
+  return rc;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file        bench_sha256.c
+ * @brief       SHA-256 throughput of the default vault, one call over the whole input and streamed in chunks
+ *
+ * The input repeats a BENCH_SHA256_PATTERN_SIZE byte pattern. The one-call hash needs the whole input in memory, a
+ * streamed hash only ever passes one chunk of the pattern, so its memory stays the same for any input size. Every
+ * streamed digest is checked against the one-call digest.
+ *
+ * Usage: ockam_vault_default_bench_sha256 [megabytes]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ockam/error.h"
+#include "ockam/memory.h"
+#include "ockam/random.h"
+#include "ockam/vault.h"
+
+#include "ockam/memory/stdlib.h"
+#include "ockam/random/urandom.h"
+#include "ockam/vault/default.h"
+
+#define BENCH_SHA256_MEGABYTES    64u
+#define BENCH_SHA256_PATTERN_SIZE 65536u
+#define BENCH_SHA256_DIGEST_SIZE  32u
+#define BENCH_SHA256_MISMATCH     (OCKAM_ERROR_INTERFACE_VAULT | 0x00F3u)
+
+/* Each divides the pattern size, so a chunk never wraps around the end of the pattern */
+static const size_t g_chunk_sizes[] = { 64, 1024, 16384, BENCH_SHA256_PATTERN_SIZE };
+
+static uint8_t g_pattern[BENCH_SHA256_PATTERN_SIZE];
+
+static uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec * 1000000000u) + (uint64_t) ts.tv_nsec;
+}
+
+/**
+ * @brief   Hash the input in chunks of chunk_size bytes and report megabytes per second
+ */
+static ockam_error_t
+bench_stream(ockam_vault_t* vault, size_t input_length, size_t chunk_size, uint8_t* digest, double* rate)
+{
+  ockam_error_t            error  = OCKAM_ERROR_NONE;
+  ockam_vault_sha256_ctx_t sha256 = { 0 };
+  size_t                   offset = 0;
+  size_t                   length = 0;
+  uint64_t                 start  = 0;
+
+  start = bench_now_ns();
+
+  error = ockam_vault_sha256_init(vault, &sha256);
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  for (offset = 0; offset < input_length; offset += length) {
+    length = input_length - offset;
+    if (length > chunk_size) { length = chunk_size; }
+
+    error = ockam_vault_sha256_update(vault, &sha256, &g_pattern[offset % BENCH_SHA256_PATTERN_SIZE], length);
+    if (error != OCKAM_ERROR_NONE) { goto exit; }
+  }
+
+  error = ockam_vault_sha256_final(vault, &sha256, digest, BENCH_SHA256_DIGEST_SIZE, &length);
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  *rate = ((double) input_length / 1e6) / ((double) (bench_now_ns() - start) / 1e9);
+
+exit:
+  if (sha256.context != 0) { ockam_vault_sha256_final(vault, &sha256, 0, 0, 0); }
+  return error;
+}
+
+int main(int argc, char* argv[])
+{
+  int                              rc               = 0;
+  ockam_error_t                    error            = OCKAM_ERROR_NONE;
+  ockam_memory_t                   memory           = { 0 };
+  ockam_random_t                   random           = { 0 };
+  ockam_vault_default_attributes_t vault_attributes = { .memory = &memory, .random = &random };
+  ockam_vault_t                    vault            = { 0 };
+  size_t                           megabytes        = BENCH_SHA256_MEGABYTES;
+  size_t                           input_length     = 0;
+  uint8_t*                         input            = 0;
+  uint8_t                          expected[BENCH_SHA256_DIGEST_SIZE];
+  uint8_t                          digest[BENCH_SHA256_DIGEST_SIZE];
+  size_t                           length = 0;
+  size_t                           i      = 0;
+  uint64_t                         start  = 0;
+  double                           rate   = 0;
+
+  if (argc > 1) { megabytes = strtoul(argv[1], 0, 10); }
+  if (megabytes == 0) { megabytes = BENCH_SHA256_MEGABYTES; }
+  input_length = megabytes * 1024 * 1024;
+
+  error = ockam_memory_stdlib_init(&memory);
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  error = ockam_random_urandom_init(&random);
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  error = ockam_vault_default_init(&vault, &vault_attributes);
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  error = ockam_memory_alloc_zeroed(&memory, (void**) &input, input_length);
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  error = ockam_random_get_bytes(&random, g_pattern, sizeof(g_pattern));
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  for (i = 0; i < input_length; i += BENCH_SHA256_PATTERN_SIZE) { memcpy(&input[i], g_pattern, sizeof(g_pattern)); }
+
+  printf("SHA-256 over %zu MiB, megabytes/second\n", megabytes);
+  printf("%10s %12s %14s\n", "chunk", "MB/s", "input memory");
+
+  start = bench_now_ns();
+
+  error = ockam_vault_sha256(&vault, input, input_length, expected, sizeof(expected), &length);
+  if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+  rate = ((double) input_length / 1e6) / ((double) (bench_now_ns() - start) / 1e9);
+  printf("%10s %12.1f %14zu\n", "one call", rate, input_length);
+
+  ockam_memory_free(&memory, input, input_length);
+  input = 0;
+
+  for (i = 0; i < sizeof(g_chunk_sizes) / sizeof(g_chunk_sizes[0]); i++) {
+    error = bench_stream(&vault, input_length, g_chunk_sizes[i], digest, &rate);
+    if (error != OCKAM_ERROR_NONE) { goto exit; }
+
+    if (memcmp(digest, expected, sizeof(expected)) != 0) {
+      error = BENCH_SHA256_MISMATCH;
+      goto exit;
+    }
+
+    printf("%10zu %12.1f %14zu\n", g_chunk_sizes[i], rate, g_chunk_sizes[i]);
+  }
+
+exit:
+  if (input != 0) { ockam_memory_free(&memory, input, input_length); }
+  if (vault.default_context != 0) { ockam_vault_deinit(&vault); }
+
+  if (error != OCKAM_ERROR_NONE) {
+    printf("FAIL: %d\n", error);
+    rc = -1;
+  }
+
+  return rc;
+}
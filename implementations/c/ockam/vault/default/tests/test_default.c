@@ -60,6 +60,61 @@ int main(void)
   test_vault_run_hkdf(&vault, &memory);
   test_vault_run_aead_aes_gcm(&vault, &memory, TEST_VAULT_AEAD_AES_GCM_KEY_BOTH);
 
+  {
+    size_t                                     i          = 0;
+    ockam_vault_default_aead_aes_gcm_backend_t backends[] = { OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_CT,
+                                                              OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_X86NI,
+                                                              OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_PWR8 };
+
+    for (i = 0; i < sizeof(backends) / sizeof(backends[0]); i++) {
+      ockam_vault_t backend_vault = { 0 };
+
+      vault_attributes.aead_aes_gcm_backend = backends[i];
+
+      error = ockam_vault_default_init(&backend_vault, &vault_attributes);
+      if (error == OCKAM_VAULT_ERROR_BACKEND_UNAVAILABLE) { /* Hardware backend not supported on this machine */
+        error = OCKAM_ERROR_NONE;
+        continue;
+      } else if (error != OCKAM_ERROR_NONE) {
+        printf("FAIL: Vault backend %d\r\n", backends[i]);
+        goto exit;
+      }
+
+      test_vault_run_aead_aes_gcm(&backend_vault, &memory, TEST_VAULT_AEAD_AES_GCM_KEY_BOTH);
+
+      ockam_vault_deinit(&backend_vault);
+    }
+  }
+
+  vault_attributes.aead_aes_gcm_backend = OCKAM_VAULT_DEFAULT_AEAD_AES_GCM_BACKEND_AUTO;
+
+  {
+    size_t                           i          = 0;
+    ockam_vault_default_ec_backend_t backends[] = { OCKAM_VAULT_DEFAULT_EC_BACKEND_I31,
+                                                    OCKAM_VAULT_DEFAULT_EC_BACKEND_M31,
+                                                    OCKAM_VAULT_DEFAULT_EC_BACKEND_M62,
+                                                    OCKAM_VAULT_DEFAULT_EC_BACKEND_M64 };
+
+    for (i = 0; i < sizeof(backends) / sizeof(backends[0]); i++) {
+      ockam_vault_t backend_vault = { 0 };
+
+      vault_attributes.ec_backend = backends[i];
+
+      error = ockam_vault_default_init(&backend_vault, &vault_attributes);
+      if (error == OCKAM_VAULT_ERROR_BACKEND_UNAVAILABLE) { /* 64-bit backend not supported by this build */
+        error = OCKAM_ERROR_NONE;
+        continue;
+      } else if (error != OCKAM_ERROR_NONE) {
+        printf("FAIL: Vault EC backend %d\r\n", backends[i]);
+        goto exit;
+      }
+
+      test_vault_run_secret_ecdh(&backend_vault, &memory, OCKAM_VAULT_SECRET_TYPE_CURVE25519_PRIVATEKEY, 1);
+
+      ockam_vault_deinit(&backend_vault);
+    }
+  }
+
 exit:
   if (error != OCKAM_ERROR_NONE) { rc = -1; }
 
@@ -170,7 +170,7 @@ typedef struct {
    */
   ockam_error_t (*aead_aes_gcm_encrypt)(ockam_vault_t*        vault,
                                         ockam_vault_secret_t* key,
-                                        uint16_t              nonce,
+                                        uint64_t              nonce,
                                         const uint8_t*        additional_data,
                                         size_t                additional_data_length,
                                         const uint8_t*        plaintext,
@@ -195,7 +195,7 @@ typedef struct {
    */
   ockam_error_t (*aead_aes_gcm_decrypt)(ockam_vault_t*        vault,
                                         ockam_vault_secret_t* key,
-                                        uint16_t              nonce,
+                                        uint64_t              nonce,
                                         const uint8_t*        additional_data,
                                         size_t                additional_data_length,
                                         const uint8_t*        ciphertext_and_tag,
@@ -203,6 +203,141 @@ typedef struct {
                                         uint8_t*              plaintext,
                                         size_t                plaintext_size,
                                         size_t*               plaintext_length);
+
+  /**
+   * @brief   Encrypt several payloads with the same key using AES-GCM. Optional, the vault falls back to calling
+   *          aead_aes_gcm_encrypt for each message when this is not set.
+   * @param   vault[in]           Vault object to use for encryption.
+   * @param   key[in]             Ockam secret key to use for encryption.
+   * @param   messages[in,out]    Array of messages to encrypt.
+   * @param   messages_count[in]  Number of messages in the array.
+   * @return  OCKAM_ERROR_NONE if every message was encrypted, otherwise the error of the first failed message.
+   */
+  ockam_error_t (*aead_aes_gcm_encrypt_batch)(ockam_vault_t*                      vault,
+                                              ockam_vault_secret_t*               key,
+                                              ockam_vault_aead_aes_gcm_message_t* messages,
+                                              size_t                              messages_count);
+
+  /**
+   * @brief   Decrypt several payloads with the same key using AES-GCM. Optional, the vault falls back to calling
+   *          aead_aes_gcm_decrypt for each message when this is not set.
+   * @param   vault[in]           Vault object to use for decryption.
+   * @param   key[in]             Ockam secret key to use for decryption.
+   * @param   messages[in,out]    Array of messages to decrypt.
+   * @param   messages_count[in]  Number of messages in the array.
+   * @return  OCKAM_ERROR_NONE if every message was decrypted, otherwise the error of the first failed message.
+   */
+  ockam_error_t (*aead_aes_gcm_decrypt_batch)(ockam_vault_t*                      vault,
+                                              ockam_vault_secret_t*               key,
+                                              ockam_vault_aead_aes_gcm_message_t* messages,
+                                              size_t                              messages_count);
+
+  /**
+   * @brief   Encrypt a payload in place using AES-GCM. Optional, the vault falls back to calling aead_aes_gcm_encrypt
+   *          with the same buffer as input and output when this is not set.
+   * @param   vault[in]                       Vault object to use for encryption.
+   * @param   key[in]                         Ockam secret key to use for encryption.
+   * @param   nonce[in]                       Nonce value to use for encryption.
+   * @param   additional_data[in]             Additional data to use for encryption.
+   * @param   additional_data_length[in]      Length of the additional data.
+   * @param   buffer[in,out]                  Buffer holding the plaintext, replaced by the ciphertext and tag.
+   * @param   plaintext_length[in]            Length of plaintext data at the start of the buffer.
+   * @param   buffer_size[in]                 Size of the buffer. Must be at least plaintext_length + 16.
+   * @param   ciphertext_and_tag_length[out]  Amount of ciphertext + tag data now in the buffer.
+   * @return  OCKAM_ERROR_NONE on success.
+   */
+  ockam_error_t (*aead_aes_gcm_encrypt_in_place)(ockam_vault_t*        vault,
+                                                 ockam_vault_secret_t* key,
+                                                 uint64_t              nonce,
+                                                 const uint8_t*        additional_data,
+                                                 size_t                additional_data_length,
+                                                 uint8_t*              buffer,
+                                                 size_t                plaintext_length,
+                                                 size_t                buffer_size,
+                                                 size_t*               ciphertext_and_tag_length);
+
+  /**
+   * @brief   Decrypt a payload in place using AES-GCM. Optional, the vault falls back to calling aead_aes_gcm_decrypt
+   *          with the same buffer as input and output when this is not set.
+   * @param   vault[in]                       Vault object to use for decryption.
+   * @param   key[in]                         Ockam secret key to use for decryption.
+   * @param   nonce[in]                       Nonce value to use for decryption.
+   * @param   additional_data[in]             Additional data to use for decryption.
+   * @param   additional_data_length[in]      Length of the additional data.
+   * @param   buffer[in,out]                  Buffer holding the ciphertext + tag, replaced by the plaintext.
+   * @param   ciphertext_and_tag_length[in]   Length of the ciphertext + tag data in the buffer.
+   * @param   plaintext_length[out]           Amount of plaintext data now at the start of the buffer.
+   * @return  OCKAM_ERROR_NONE on success.
+   */
+  ockam_error_t (*aead_aes_gcm_decrypt_in_place)(ockam_vault_t*        vault,
+                                                 ockam_vault_secret_t* key,
+                                                 uint64_t              nonce,
+                                                 const uint8_t*        additional_data,
+                                                 size_t                additional_data_length,
+                                                 uint8_t*              buffer,
+                                                 size_t                ciphertext_and_tag_length,
+                                                 size_t*               plaintext_length);
+
+  /**
+   * @brief   Generate several secrets with the same attributes. Optional, the vault falls back to calling
+   *          secret_generate for each secret when this is not set.
+   * @param   vault[in]           Vault object to use for generating the secret keys.
+   * @param   secrets[out]        Array of empty ockam secret objects to be populated with the generated secrets.
+   * @param   attributes[in]      Desired attributes for every secret to be generated.
+   * @param   secrets_count[in]   Number of secrets in the array.
+   * @return  OCKAM_ERROR_NONE on success, in which case every secret was generated.
+   */
+  ockam_error_t (*secret_generate_batch)(ockam_vault_t*                         vault,
+                                         ockam_vault_secret_t*                  secrets,
+                                         const ockam_vault_secret_attributes_t* attributes,
+                                         size_t                                 secrets_count);
+
+  /**
+   * @brief   Perform several ECDH operations. Optional, the vault falls back to calling ecdh for each message when
+   *          this is not set.
+   * @param   vault[in]           Vault object to use for ECDH.
+   * @param   messages[in,out]    Array of key agreements to perform.
+   * @param   messages_count[in]  Number of messages in the array.
+   * @return  OCKAM_ERROR_NONE if every ECDH succeeded, otherwise the error of the first failed message.
+   */
+  ockam_error_t (*ecdh_batch)(ockam_vault_t* vault, ockam_vault_ecdh_message_t* messages, size_t messages_count);
+
+  /**
+   * @brief   Start a SHA-256 hash over several calls. Optional, together with sha256_update and sha256_final; the
+   *          vault returns OCKAM_VAULT_ERROR_NOT_SUPPORTED when it is not set.
+   * @param   vault[in]     Vault object to use for SHA-256.
+   * @param   sha256[out]   Empty hash context to start.
+   * @return  OCKAM_ERROR_NONE on success.
+   */
+  ockam_error_t (*sha256_init)(ockam_vault_t* vault, ockam_vault_sha256_ctx_t* sha256);
+
+  /**
+   * @brief   Add data to a started SHA-256 hash.
+   * @param   vault[in]         Vault object the hash was started on.
+   * @param   sha256[in,out]    Hash context to add the data to.
+   * @param   input[in]         Buffer containing data to run through SHA-256.
+   * @param   input_length[in]  Length of the data to run through SHA-256.
+   * @return  OCKAM_ERROR_NONE on success.
+   */
+  ockam_error_t (*sha256_update)(ockam_vault_t*            vault,
+                                 ockam_vault_sha256_ctx_t* sha256,
+                                 const uint8_t*            input,
+                                 size_t                    input_length);
+
+  /**
+   * @brief   Finish a SHA-256 hash and release its context. A digest of 0 abandons the hash.
+   * @param   vault[in]           Vault object the hash was started on.
+   * @param   sha256[in,out]      Hash context to finish.
+   * @param   digest[out]         Buffer to place the resulting SHA-256 hash in.
+   * @param   digest_size[in]     Size of the digest buffer. Must be 32 bytes.
+   * @param   digest_length[out]  Amount of data placed in the digest buffer.
+   * @return  OCKAM_ERROR_NONE on success.
+   */
+  ockam_error_t (*sha256_final)(ockam_vault_t*            vault,
+                                ockam_vault_sha256_ctx_t* sha256,
+                                uint8_t*                  digest,
+                                size_t                    digest_size,
+                                size_t*                   digest_length);
 } ockam_vault_dispatch_table_t;
 
 /**
@@ -14,9 +14,10 @@
 #include "ockam/vault.h"
 #include "test_vault.h"
 
-#define TEST_VAULT_AEAD_AES_GCM_TEST_CASES 4u
+#define TEST_VAULT_AEAD_AES_GCM_TEST_CASES 6u
 #define TEST_VAULT_AEAD_AES_GCM_NAME_SIZE  32u
 #define TEST_VAULT_AEAD_AES_GCM_TAG_SIZE   16u
+#define TEST_VAULT_AEAD_AES_GCM_BATCH_SIZE (TEST_VAULT_AEAD_AES_GCM_TEST_CASES + 1u)
 
 #define TEST_VAULT_AEAD_AES_GCM_128_KEY_SIZE 16u
 #define TEST_VAULT_AEAD_AES_GCM_256_KEY_SIZE 32u
@@ -49,6 +50,7 @@ typedef struct {
 } test_vault_aead_aes_gcm_shared_data_t;
 
 void test_vault_aead_aes_gcm(void** state);
+void test_vault_aead_aes_gcm_batch(void** state);
 int  test_vault_aead_aes_gcm_teardown(void** state);
 
 /* clang-format off */
@@ -136,6 +138,21 @@ uint8_t g_aead_aes_gcm_test_ciphertext_and_tag_256_short[] =
   0xb3, 0xf6, 0x27, 0x27, 0x4d, 0xfc, 0xa1, 0xc3
 };
 
+uint8_t g_aead_aes_gcm_test_ciphertext_and_tag_128_short_nonce64[] =
+{
+  0xE4, 0x90, 0xBB, 0x56, 0xE7, 0x5F, 0x1E, 0x20,
+  0xDD, 0x17, 0x22, 0x12, 0x28, 0xBC, 0xFB, 0x87,
+  0x35, 0xF3, 0xAC, 0xCC, 0xE3, 0xE8, 0x5A, 0x5D,
+  0xA7, 0x27, 0xAF, 0x75, 0x27, 0xA0, 0xF0, 0x95
+};
+
+uint8_t g_aead_aes_gcm_test_ciphertext_and_tag_256_short_nonce64[] =
+{
+  0x9C, 0x23, 0x05, 0x2C, 0xF6, 0x0E, 0x55, 0xD2,
+  0x70, 0x40, 0xEB, 0x47, 0x7A, 0xE3, 0xE3, 0xFC,
+  0x9A, 0x8C, 0x0B, 0xFC, 0xEE, 0x28, 0xF0, 0x14,
+  0x7F, 0x4E, 0x3E, 0xEC, 0x09, 0x92, 0x25, 0x38
+};
 
 test_vault_aead_aes_gcm_data_t g_aead_aes_gcm_data[TEST_VAULT_AEAD_AES_GCM_TEST_CASES] =
 {
@@ -179,6 +196,26 @@ test_vault_aead_aes_gcm_data_t g_aead_aes_gcm_data[TEST_VAULT_AEAD_AES_GCM_TEST_
     &g_aead_aes_gcm_test_ciphertext_and_tag_256_short[0],
     16,
   },
+  {
+    &g_aead_aes_gcm_test_key_128[0],
+    TEST_VAULT_AEAD_AES_GCM_128_KEY_SIZE,
+    &g_aead_aes_gcm_test_aad[0],
+    20,
+    0x0123456789ABCDEF,
+    &g_aead_aes_gcm_test_plaintext_short[0],
+    &g_aead_aes_gcm_test_ciphertext_and_tag_128_short_nonce64[0],
+    16,
+  },
+  {
+    &g_aead_aes_gcm_test_key_256[0],
+    TEST_VAULT_AEAD_AES_GCM_256_KEY_SIZE,
+    &g_aead_aes_gcm_test_aad[0],
+    20,
+    0x0123456789ABCDEF,
+    &g_aead_aes_gcm_test_plaintext_short[0],
+    &g_aead_aes_gcm_test_ciphertext_and_tag_256_short_nonce64[0],
+    16,
+  },
 };
 
 /* clang-format on */
@@ -305,6 +342,50 @@ void test_vault_aead_aes_gcm(void** state)
   assert_memory_equal(
     aead_aes_gcm_decrypt_data, g_aead_aes_gcm_data[test_data->test_count].plaintext, aead_aes_gcm_decrypt_data_size);
 
+  /* ------------------------ */
+  /* AES GCM Encrypt In Place */
+  /* ------------------------ */
+
+  ockam_memory_set(test_data->memory, aead_aes_gcm_encrypt_hash, 0, aead_aes_gcm_encrypt_hash_size);
+  ockam_memory_copy(test_data->memory,
+                    aead_aes_gcm_encrypt_hash,
+                    g_aead_aes_gcm_data[test_data->test_count].plaintext,
+                    g_aead_aes_gcm_data[test_data->test_count].text_size);
+
+  error = ockam_vault_aead_aes_gcm_encrypt_in_place(test_data->vault,
+                                                    &key_secret,
+                                                    g_aead_aes_gcm_data[test_data->test_count].nonce,
+                                                    g_aead_aes_gcm_data[test_data->test_count].aad,
+                                                    g_aead_aes_gcm_data[test_data->test_count].aad_size,
+                                                    aead_aes_gcm_encrypt_hash,
+                                                    g_aead_aes_gcm_data[test_data->test_count].text_size,
+                                                    aead_aes_gcm_encrypt_hash_size,
+                                                    &length);
+  assert_int_equal(error, OCKAM_ERROR_NONE);
+  assert_int_equal(length, aead_aes_gcm_encrypt_hash_size);
+
+  assert_memory_equal(aead_aes_gcm_encrypt_hash,
+                      g_aead_aes_gcm_data[test_data->test_count].ciphertext_and_tag,
+                      aead_aes_gcm_encrypt_hash_size);
+
+  /* ------------------------ */
+  /* AES GCM Decrypt In Place */
+  /* ------------------------ */
+
+  error = ockam_vault_aead_aes_gcm_decrypt_in_place(test_data->vault,
+                                                    &key_secret,
+                                                    g_aead_aes_gcm_data[test_data->test_count].nonce,
+                                                    g_aead_aes_gcm_data[test_data->test_count].aad,
+                                                    g_aead_aes_gcm_data[test_data->test_count].aad_size,
+                                                    aead_aes_gcm_encrypt_hash,
+                                                    aead_aes_gcm_encrypt_hash_size,
+                                                    &length);
+  assert_int_equal(error, OCKAM_ERROR_NONE);
+  assert_int_equal(length, aead_aes_gcm_decrypt_data_size);
+
+  assert_memory_equal(
+    aead_aes_gcm_encrypt_hash, g_aead_aes_gcm_data[test_data->test_count].plaintext, aead_aes_gcm_decrypt_data_size);
+
   /* ----------- */
   /* Memory Free */
   /* ----------- */
@@ -317,6 +398,125 @@ exit:
   return;
 }
 
+/**
+ * @brief   Encrypt and decrypt all test cases sharing a key in one batch, including one message with a corrupted tag
+ * @param   state   Contains a shared data pointer for common test data.
+ */
+void test_vault_aead_aes_gcm_batch(void** state)
+{
+  ockam_error_t                          error                                          = OCKAM_ERROR_NONE;
+  test_vault_aead_aes_gcm_shared_data_t* test_data                                      = 0;
+  uint8_t                                key_size                                       = 0;
+  size_t                                 count                                          = 0;
+  size_t                                 i                                              = 0;
+  uint8_t*                               ciphertext[TEST_VAULT_AEAD_AES_GCM_BATCH_SIZE] = { 0 };
+  uint8_t*                               plaintext[TEST_VAULT_AEAD_AES_GCM_BATCH_SIZE]  = { 0 };
+  size_t                                 cases[TEST_VAULT_AEAD_AES_GCM_BATCH_SIZE]      = { 0 };
+  ockam_vault_aead_aes_gcm_message_t     messages[TEST_VAULT_AEAD_AES_GCM_BATCH_SIZE]   = { { 0 } };
+  ockam_vault_secret_t                   key_secret                                     = { 0 };
+  ockam_vault_secret_attributes_t        attributes                                     = { 0 };
+
+  test_data = (test_vault_aead_aes_gcm_shared_data_t*) *state;
+
+  for (key_size = TEST_VAULT_AEAD_AES_GCM_128_KEY_SIZE; key_size <= TEST_VAULT_AEAD_AES_GCM_256_KEY_SIZE;
+       key_size += TEST_VAULT_AEAD_AES_GCM_128_KEY_SIZE) {
+    if ((test_data->test_key_type == TEST_VAULT_AEAD_AES_GCM_KEY_128_ONLY) &&
+        (key_size == TEST_VAULT_AEAD_AES_GCM_256_KEY_SIZE)) {
+      continue;
+    }
+
+    if ((test_data->test_key_type == TEST_VAULT_AEAD_AES_GCM_KEY_256_ONLY) &&
+        (key_size == TEST_VAULT_AEAD_AES_GCM_128_KEY_SIZE)) {
+      continue;
+    }
+
+    /* Every case using this key, followed by a copy of the first one with a corrupted tag */
+
+    count = 0;
+    for (i = 0; i < TEST_VAULT_AEAD_AES_GCM_TEST_CASES; i++) {
+      if (g_aead_aes_gcm_data[i].key_size == key_size) { cases[count++] = i; }
+    }
+    cases[count] = cases[0];
+
+    attributes.purpose     = OCKAM_VAULT_SECRET_PURPOSE_KEY_AGREEMENT;
+    attributes.persistence = OCKAM_VAULT_SECRET_EPHEMERAL;
+    attributes.type        = (key_size == TEST_VAULT_AEAD_AES_GCM_128_KEY_SIZE) ? OCKAM_VAULT_SECRET_TYPE_AES128_KEY
+                                                                                 : OCKAM_VAULT_SECRET_TYPE_AES256_KEY;
+    attributes.length      = key_size;
+
+    error = ockam_vault_secret_import(
+      test_data->vault, &key_secret, &attributes, g_aead_aes_gcm_data[cases[0]].key, key_size);
+    assert_int_equal(error, OCKAM_ERROR_NONE);
+
+    for (i = 0; i <= count; i++) {
+      size_t text_size = g_aead_aes_gcm_data[cases[i]].text_size;
+
+      error = ockam_memory_alloc_zeroed(
+        test_data->memory, (void**) &ciphertext[i], text_size + TEST_VAULT_AEAD_AES_GCM_TAG_SIZE);
+      assert_int_equal(error, OCKAM_ERROR_NONE);
+
+      error = ockam_memory_alloc_zeroed(test_data->memory, (void**) &plaintext[i], text_size);
+      assert_int_equal(error, OCKAM_ERROR_NONE);
+
+      messages[i].nonce                  = g_aead_aes_gcm_data[cases[i]].nonce;
+      messages[i].additional_data        = g_aead_aes_gcm_data[cases[i]].aad;
+      messages[i].additional_data_length = g_aead_aes_gcm_data[cases[i]].aad_size;
+      messages[i].input                  = g_aead_aes_gcm_data[cases[i]].plaintext;
+      messages[i].input_length           = text_size;
+      messages[i].output                 = ciphertext[i];
+      messages[i].output_size            = text_size + TEST_VAULT_AEAD_AES_GCM_TAG_SIZE;
+    }
+
+    /* --------------------- */
+    /* AES GCM Encrypt Batch */
+    /* --------------------- */
+
+    error = ockam_vault_aead_aes_gcm_encrypt_batch(test_data->vault, &key_secret, messages, count + 1);
+    assert_int_equal(error, OCKAM_ERROR_NONE);
+
+    for (i = 0; i <= count; i++) {
+      assert_int_equal(messages[i].error, OCKAM_ERROR_NONE);
+      assert_int_equal(messages[i].output_length, messages[i].output_size);
+      assert_memory_equal(
+        ciphertext[i], g_aead_aes_gcm_data[cases[i]].ciphertext_and_tag, messages[i].output_length);
+    }
+
+    ciphertext[count][messages[count].output_length - 1] ^= 0x01;
+
+    /* --------------------- */
+    /* AES GCM Decrypt Batch */
+    /* --------------------- */
+
+    for (i = 0; i <= count; i++) {
+      messages[i].input        = ciphertext[i];
+      messages[i].input_length = messages[i].output_length;
+      messages[i].output       = plaintext[i];
+      messages[i].output_size  = g_aead_aes_gcm_data[cases[i]].text_size;
+    }
+
+    error = ockam_vault_aead_aes_gcm_decrypt_batch(test_data->vault, &key_secret, messages, count + 1);
+    assert_int_equal(error, OCKAM_VAULT_ERROR_INVALID_TAG);
+
+    for (i = 0; i < count; i++) {
+      assert_int_equal(messages[i].error, OCKAM_ERROR_NONE);
+      assert_int_equal(messages[i].output_length, g_aead_aes_gcm_data[cases[i]].text_size);
+      assert_memory_equal(plaintext[i], g_aead_aes_gcm_data[cases[i]].plaintext, messages[i].output_length);
+    }
+
+    assert_int_equal(messages[count].error, OCKAM_VAULT_ERROR_INVALID_TAG);
+
+    for (i = 0; i <= count; i++) {
+      size_t text_size = g_aead_aes_gcm_data[cases[i]].text_size;
+
+      ockam_memory_free(test_data->memory, ciphertext[i], text_size + TEST_VAULT_AEAD_AES_GCM_TAG_SIZE);
+      ockam_memory_free(test_data->memory, plaintext[i], text_size);
+    }
+
+    error = ockam_vault_secret_destroy(test_data->vault, &key_secret);
+    assert_int_equal(error, OCKAM_ERROR_NONE);
+  }
+}
+
 /**
  * @brief   Common unit test teardown function for AES GCM using Ockam Vault
  * @param   state   Contains a pointer to shared data for all AES GCM test cases.
@@ -350,7 +550,7 @@ int test_vault_run_aead_aes_gcm(ockam_vault_t* vault, ockam_memory_t* memory, TE
   test_vault_aead_aes_gcm_shared_data_t shared_data;
 
   error = ockam_memory_alloc_zeroed(
-    memory, (void**) &cmocka_data, TEST_VAULT_AEAD_AES_GCM_TEST_CASES * sizeof(struct CMUnitTest));
+    memory, (void**) &cmocka_data, (TEST_VAULT_AEAD_AES_GCM_TEST_CASES + 1) * sizeof(struct CMUnitTest));
   if (error != OCKAM_ERROR_NONE) {
     rc = -1;
     goto exit_block;
@@ -382,9 +582,15 @@ int test_vault_run_aead_aes_gcm(ockam_vault_t* vault, ockam_memory_t* memory, TE
     cmocka_tests++;
   }
 
+  cmocka_tests->name          = "AES GCM Batch";
+  cmocka_tests->test_func     = test_vault_aead_aes_gcm_batch;
+  cmocka_tests->setup_func    = 0;
+  cmocka_tests->teardown_func = 0;
+  cmocka_tests->initial_state = &shared_data;
+
   cmocka_tests = (struct CMUnitTest*) cmocka_data;
 
-  rc = _cmocka_run_group_tests("AES-GCM", cmocka_tests, shared_data.test_count_max, 0, 0);
+  rc = _cmocka_run_group_tests("AES-GCM", cmocka_tests, shared_data.test_count_max + 1, 0, 0);
 
 exit_block:
   return rc;
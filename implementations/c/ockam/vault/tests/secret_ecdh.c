@@ -18,6 +18,7 @@
 #define TEST_VAULT_KEY_P256_TEST_CASES       1u
 #define TEST_VAULT_KEY_CURVE25519_TEST_CASES 2u
 #define TEST_VAULT_KEY_PRIV_SIZE             32u
+#define TEST_VAULT_KEY_BATCH_SIZE            (2u * TEST_VAULT_KEY_CURVE25519_TEST_CASES)
 
 /**
  * @struct  test_vault_keys_p256_t
@@ -58,6 +59,7 @@ typedef struct {
 } test_vault_key_shared_data_t;
 
 void test_vault_secret_ecdh(void** state);
+void test_vault_secret_ecdh_batch(void** state);
 int  test_vault_secret_ecdh_teardown(void** state);
 
 /* clang-format off */
@@ -342,6 +344,121 @@ void test_vault_secret_ecdh(void** state)
   ockam_memory_free(test_data->memory, generated_responder_pub, test_data->key_size);
 }
 
+/**
+ * @brief   Generate or load the keys of every test case in one batch, then run every case's ECDH in both directions in
+ *          one batch, followed by one message without a peer public key that must fail on its own.
+ *
+ * @param   state   Contains the shared test data used in all Key/ECDH unit tests.
+ */
+
+void test_vault_secret_ecdh_batch(void** state)
+{
+  ockam_error_t                 error     = OCKAM_ERROR_NONE;
+  test_vault_key_shared_data_t* test_data = 0;
+  size_t                        count     = 0;
+  size_t                        length    = 0;
+  size_t                        i         = 0;
+
+  ockam_vault_secret_t            keys[TEST_VAULT_KEY_BATCH_SIZE]               = { { { 0 } } };
+  ockam_vault_secret_t            shared_secrets[TEST_VAULT_KEY_BATCH_SIZE + 1] = { { { 0 } } };
+  ockam_vault_ecdh_message_t      messages[TEST_VAULT_KEY_BATCH_SIZE + 1]       = { { 0 } };
+  ockam_vault_secret_attributes_t attributes                                    = { 0 };
+
+  uint8_t publickeys[TEST_VAULT_KEY_BATCH_SIZE][OCKAM_VAULT_P256_PUBLICKEY_LENGTH] = { { 0 } };
+  uint8_t generated[TEST_VAULT_KEY_BATCH_SIZE][OCKAM_VAULT_SHARED_SECRET_LENGTH]   = { { 0 } };
+
+  test_data = (test_vault_key_shared_data_t*) *state;
+  count     = 2u * test_data->test_count_max;
+
+  attributes.length      = 0;
+  attributes.purpose     = OCKAM_VAULT_SECRET_PURPOSE_KEY_AGREEMENT;
+  attributes.persistence = OCKAM_VAULT_SECRET_EPHEMERAL;
+  attributes.type        = test_data->type;
+
+  /* ----------------------- */
+  /* Key Load/Generate Batch */
+  /* ----------------------- */
+
+  if (test_data->load_keys && (test_data->type == OCKAM_VAULT_SECRET_TYPE_CURVE25519_PRIVATEKEY)) {
+    for (i = 0; i < test_data->test_count_max; i++) {
+      error = ockam_vault_secret_import(test_data->vault,
+                                        &keys[2 * i],
+                                        &attributes,
+                                        g_test_vault_keys_curve25519[i].initiator_priv,
+                                        TEST_VAULT_KEY_PRIV_SIZE);
+      assert_int_equal(error, OCKAM_ERROR_NONE);
+
+      error = ockam_vault_secret_import(test_data->vault,
+                                        &keys[2 * i + 1],
+                                        &attributes,
+                                        g_test_vault_keys_curve25519[i].responder_priv,
+                                        TEST_VAULT_KEY_PRIV_SIZE);
+      assert_int_equal(error, OCKAM_ERROR_NONE);
+    }
+  } else {
+    error = ockam_vault_secret_generate_batch(test_data->vault, keys, &attributes, count);
+    assert_int_equal(error, OCKAM_ERROR_NONE);
+  }
+
+  for (i = 0; i < count; i++) {
+    error = ockam_vault_secret_publickey_get(
+      test_data->vault, &keys[i], &publickeys[i][0], test_data->key_size, &length);
+    assert_int_equal(error, OCKAM_ERROR_NONE);
+    assert_int_equal(length, test_data->key_size);
+  }
+
+  /* ---------------- */
+  /* ECDH Calculation */
+  /* ---------------- */
+
+  for (i = 0; i < count; i++) {
+    messages[i].privatekey            = &keys[i];
+    messages[i].peer_publickey        = &publickeys[i ^ 1u][0]; /* The other key of the same case */
+    messages[i].peer_publickey_length = test_data->key_size;
+    messages[i].shared_secret         = &shared_secrets[i];
+  }
+
+  messages[count].privatekey            = &keys[0];
+  messages[count].peer_publickey        = 0;
+  messages[count].peer_publickey_length = test_data->key_size;
+  messages[count].shared_secret         = &shared_secrets[count];
+
+  error = ockam_vault_ecdh_batch(test_data->vault, messages, count + 1);
+  assert_int_equal(error, OCKAM_VAULT_ERROR_INVALID_PARAM);
+  assert_int_equal(messages[count].error, OCKAM_VAULT_ERROR_INVALID_PARAM);
+  assert_null(shared_secrets[count].context);
+
+  for (i = 0; i < count; i++) {
+    assert_int_equal(messages[i].error, OCKAM_ERROR_NONE);
+
+    error = ockam_vault_secret_export(
+      test_data->vault, &shared_secrets[i], &generated[i][0], OCKAM_VAULT_SHARED_SECRET_LENGTH, &length);
+    assert_int_equal(error, OCKAM_ERROR_NONE);
+    assert_int_equal(length, OCKAM_VAULT_SHARED_SECRET_LENGTH);
+  }
+
+  for (i = 0; i < count; i += 2) {
+    assert_memory_equal(&generated[i][0], &generated[i + 1][0], OCKAM_VAULT_SHARED_SECRET_LENGTH);
+
+    if (test_data->load_keys && (test_data->type == OCKAM_VAULT_SECRET_TYPE_CURVE25519_PRIVATEKEY)) {
+      assert_memory_equal(
+        &generated[i][0], g_test_vault_keys_curve25519[i / 2].shared_secret, OCKAM_VAULT_SHARED_SECRET_LENGTH);
+    }
+  }
+
+  /* ----------- */
+  /* Memory free */
+  /* ----------- */
+
+  for (i = 0; i < count; i++) {
+    error = ockam_vault_secret_destroy(test_data->vault, &keys[i]);
+    assert_int_equal(error, OCKAM_ERROR_NONE);
+
+    error = ockam_vault_secret_destroy(test_data->vault, &shared_secrets[i]);
+    assert_int_equal(error, OCKAM_ERROR_NONE);
+  }
+}
+
 /**
  * @brief   Common unit test teardown function for Key/Ecdh using Ockam Vault
  *
@@ -409,8 +526,8 @@ int test_vault_run_secret_ecdh(ockam_vault_t*            vault,
     goto exit_block;
   }
 
-  error =
-    ockam_memory_alloc_zeroed(memory, (void**) &cmocka_data, test_data.test_count_max * sizeof(struct CMUnitTest));
+  error = ockam_memory_alloc_zeroed(
+    memory, (void**) &cmocka_data, (test_data.test_count_max + 1) * sizeof(struct CMUnitTest));
   if (error != OCKAM_ERROR_NONE) {
     rc = -1;
     goto exit_block;
@@ -438,9 +555,23 @@ int test_vault_run_secret_ecdh(ockam_vault_t*            vault,
     goto exit_block;
   }
 
+  error = ockam_memory_alloc_zeroed(memory, (void**) &test_name, TEST_VAULT_KEY_NAME_SIZE);
+  if (error != OCKAM_ERROR_NONE) {
+    rc = -1;
+    goto exit_block;
+  }
+
+  snprintf(test_name, TEST_VAULT_KEY_NAME_SIZE, "%s Batch", name);
+
+  cmocka_tests->name          = test_name;
+  cmocka_tests->test_func     = test_vault_secret_ecdh_batch;
+  cmocka_tests->setup_func    = 0;
+  cmocka_tests->teardown_func = 0;
+  cmocka_tests->initial_state = &test_data;
+
   cmocka_tests = (struct CMUnitTest*) cmocka_data;
 
-  rc = _cmocka_run_group_tests("KEY_ECDH", cmocka_tests, test_data.test_count_max, 0, 0);
+  rc = _cmocka_run_group_tests("KEY_ECDH", cmocka_tests, test_data.test_count_max + 1, 0, 0);
 
 exit_block:
   return rc;
@@ -1068,7 +1068,9 @@ void test_vault_sha256(void** state)
   ockam_error_t                    error                                        = OCKAM_ERROR_NONE;
   test_vault_sha256_shared_data_t* test_data                                    = 0;
   size_t                           length                                       = 0;
+  size_t                           i                                            = 0;
   uint8_t                          sha256_digest[TEST_VAULT_SHA256_DIGEST_SIZE] = { 0 };
+  ockam_vault_sha256_ctx_t         sha256                                       = { 0 };
 
   test_data = (test_vault_sha256_shared_data_t*) *state;
 
@@ -1085,6 +1087,28 @@ void test_vault_sha256(void** state)
   assert_int_equal(error, OCKAM_ERROR_NONE);
   assert_int_equal(length, TEST_VAULT_SHA256_DIGEST_SIZE);
 
+  assert_memory_equal(
+    &(g_sha256_data[test_data->test_count].digest[0]), &sha256_digest[0], TEST_VAULT_SHA256_DIGEST_SIZE);
+
+  /* The same message again, one byte per update, when the vault can hash over several calls */
+  error = ockam_vault_sha256_init(test_data->vault, &sha256);
+  if (error == OCKAM_VAULT_ERROR_NOT_SUPPORTED) { return; }
+  assert_int_equal(error, OCKAM_ERROR_NONE);
+
+  for (i = 0; i < (g_sha256_data[test_data->test_count].len / 8); i++) {
+    error = ockam_vault_sha256_update(test_data->vault, &sha256, &(g_sha256_data[test_data->test_count].msg[i]), 1);
+    assert_int_equal(error, OCKAM_ERROR_NONE);
+  }
+
+  ockam_memory_set(test_data->memory, &sha256_digest[0], 0, sizeof(sha256_digest));
+  length = 0;
+
+  error =
+    ockam_vault_sha256_final(test_data->vault, &sha256, &sha256_digest[0], TEST_VAULT_SHA256_DIGEST_SIZE, &length);
+  assert_int_equal(error, OCKAM_ERROR_NONE);
+  assert_int_equal(length, TEST_VAULT_SHA256_DIGEST_SIZE);
+  assert_null(sha256.context);
+
   assert_memory_equal(
     &(g_sha256_data[test_data->test_count].digest[0]), &sha256_digest[0], TEST_VAULT_SHA256_DIGEST_SIZE);
 }
@@ -53,6 +53,73 @@ exit:
   return error;
 }
 
+ockam_error_t ockam_vault_sha256_init(ockam_vault_t* vault, ockam_vault_sha256_ctx_t* sha256)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((vault == 0) || (vault->dispatch == 0) || (sha256 == 0) || (sha256->context != 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if (vault->dispatch->sha256_init == 0) {
+    error = OCKAM_VAULT_ERROR_NOT_SUPPORTED;
+    goto exit;
+  }
+
+  error = vault->dispatch->sha256_init(vault, sha256);
+
+exit:
+  return error;
+}
+
+ockam_error_t ockam_vault_sha256_update(ockam_vault_t*            vault,
+                                        ockam_vault_sha256_ctx_t* sha256,
+                                        const uint8_t*            input,
+                                        size_t                    input_length)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((vault == 0) || (vault->dispatch == 0) || (sha256 == 0) || ((input == 0) && (input_length != 0))) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if (vault->dispatch->sha256_update == 0) {
+    error = OCKAM_VAULT_ERROR_NOT_SUPPORTED;
+    goto exit;
+  }
+
+  error = vault->dispatch->sha256_update(vault, sha256, input, input_length);
+
+exit:
+  return error;
+}
+
+ockam_error_t ockam_vault_sha256_final(ockam_vault_t*            vault,
+                                       ockam_vault_sha256_ctx_t* sha256,
+                                       uint8_t*                  digest,
+                                       size_t                    digest_size,
+                                       size_t*                   digest_length)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((vault == 0) || (vault->dispatch == 0) || (sha256 == 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if (vault->dispatch->sha256_final == 0) {
+    error = OCKAM_VAULT_ERROR_NOT_SUPPORTED;
+    goto exit;
+  }
+
+  error = vault->dispatch->sha256_final(vault, sha256, digest, digest_size, digest_length);
+
+exit:
+  return error;
+}
+
 ockam_error_t ockam_vault_secret_generate(ockam_vault_t*                         vault,
                                           ockam_vault_secret_t*                  secret,
                                           const ockam_vault_secret_attributes_t* attributes)
@@ -70,6 +137,46 @@ exit:
   return error;
 }
 
+ockam_error_t ockam_vault_secret_generate_batch(ockam_vault_t*                         vault,
+                                                ockam_vault_secret_t*                  secrets,
+                                                const ockam_vault_secret_attributes_t* attributes,
+                                                size_t                                 secrets_count)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+  size_t        i     = 0;
+
+  if ((vault == 0) || (vault->dispatch == 0) || ((secrets == 0) && (secrets_count != 0))) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  for (i = 0; i < secrets_count; i++) {
+    if (secrets[i].context != 0) {
+      error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+      goto exit;
+    }
+  }
+
+  if (vault->dispatch->secret_generate_batch != 0) {
+    error = vault->dispatch->secret_generate_batch(vault, secrets, attributes, secrets_count);
+    goto exit;
+  }
+
+  for (i = 0; i < secrets_count; i++) {
+    error = vault->dispatch->secret_generate(vault, &(secrets[i]), attributes);
+    if (error != OCKAM_ERROR_NONE) { break; }
+  }
+
+  if (error != OCKAM_ERROR_NONE) {
+    for (i = 0; i < secrets_count; i++) {
+      if (secrets[i].context != 0) { vault->dispatch->secret_destroy(vault, &(secrets[i])); }
+    }
+  }
+
+exit:
+  return error;
+}
+
 ockam_error_t ockam_vault_secret_import(ockam_vault_t*                         vault,
                                         ockam_vault_secret_t*                  secret,
                                         const ockam_vault_secret_attributes_t* attributes,
@@ -194,6 +301,40 @@ exit:
   return error;
 }
 
+ockam_error_t ockam_vault_ecdh_batch(ockam_vault_t* vault, ockam_vault_ecdh_message_t* messages, size_t messages_count)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+  size_t        i     = 0;
+
+  if ((vault == 0) || (vault->dispatch == 0) || ((messages == 0) && (messages_count != 0))) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if (vault->dispatch->ecdh_batch != 0) {
+    error = vault->dispatch->ecdh_batch(vault, messages, messages_count);
+    goto exit;
+  }
+
+  for (i = 0; i < messages_count; i++) {
+    messages[i].error = vault->dispatch->ecdh(vault,
+                                              messages[i].privatekey,
+                                              messages[i].peer_publickey,
+                                              messages[i].peer_publickey_length,
+                                              messages[i].shared_secret);
+
+    if (messages[i].error != OCKAM_ERROR_NONE) {
+      if ((messages[i].shared_secret != 0) && (messages[i].shared_secret->context != 0)) {
+        vault->dispatch->secret_destroy(vault, messages[i].shared_secret);
+      }
+      if (error == OCKAM_ERROR_NONE) { error = messages[i].error; }
+    }
+  }
+
+exit:
+  return error;
+}
+
 ockam_error_t ockam_vault_hkdf_sha256(ockam_vault_t*        vault,
                                       ockam_vault_secret_t* salt,
                                       ockam_vault_secret_t* input_key_material,
@@ -215,7 +356,7 @@ exit:
 
 ockam_error_t ockam_vault_aead_aes_gcm_encrypt(ockam_vault_t*        vault,
                                                ockam_vault_secret_t* key,
-                                               uint16_t              nonce,
+                                               uint64_t              nonce,
                                                const uint8_t*        additional_data,
                                                size_t                additional_data_length,
                                                const uint8_t*        plaintext,
@@ -247,7 +388,7 @@ exit:
 
 ockam_error_t ockam_vault_aead_aes_gcm_decrypt(ockam_vault_t*        vault,
                                                ockam_vault_secret_t* key,
-                                               uint16_t              nonce,
+                                               uint64_t              nonce,
                                                const uint8_t*        additional_data,
                                                size_t                additional_data_length,
                                                const uint8_t*        ciphertext_and_tag,
@@ -277,3 +418,167 @@ ockam_error_t ockam_vault_aead_aes_gcm_decrypt(ockam_vault_t*        vault,
 exit:
   return error;
 }
+
+ockam_error_t ockam_vault_aead_aes_gcm_encrypt_batch(ockam_vault_t*                      vault,
+                                                     ockam_vault_secret_t*               key,
+                                                     ockam_vault_aead_aes_gcm_message_t* messages,
+                                                     size_t                              messages_count)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+  size_t        i     = 0;
+
+  if ((vault == 0) || (vault->dispatch == 0) || ((messages == 0) && (messages_count != 0))) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if (vault->dispatch->aead_aes_gcm_encrypt_batch != 0) {
+    error = vault->dispatch->aead_aes_gcm_encrypt_batch(vault, key, messages, messages_count);
+    goto exit;
+  }
+
+  for (i = 0; i < messages_count; i++) {
+    messages[i].output_length = 0;
+    messages[i].error         = vault->dispatch->aead_aes_gcm_encrypt(vault,
+                                                              key,
+                                                              messages[i].nonce,
+                                                              messages[i].additional_data,
+                                                              messages[i].additional_data_length,
+                                                              messages[i].input,
+                                                              messages[i].input_length,
+                                                              messages[i].output,
+                                                              messages[i].output_size,
+                                                              &(messages[i].output_length));
+
+    if ((messages[i].error != OCKAM_ERROR_NONE) && (error == OCKAM_ERROR_NONE)) { error = messages[i].error; }
+  }
+
+exit:
+  return error;
+}
+
+ockam_error_t ockam_vault_aead_aes_gcm_decrypt_batch(ockam_vault_t*                      vault,
+                                                     ockam_vault_secret_t*               key,
+                                                     ockam_vault_aead_aes_gcm_message_t* messages,
+                                                     size_t                              messages_count)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+  size_t        i     = 0;
+
+  if ((vault == 0) || (vault->dispatch == 0) || ((messages == 0) && (messages_count != 0))) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if (vault->dispatch->aead_aes_gcm_decrypt_batch != 0) {
+    error = vault->dispatch->aead_aes_gcm_decrypt_batch(vault, key, messages, messages_count);
+    goto exit;
+  }
+
+  for (i = 0; i < messages_count; i++) {
+    messages[i].output_length = 0;
+    messages[i].error         = vault->dispatch->aead_aes_gcm_decrypt(vault,
+                                                              key,
+                                                              messages[i].nonce,
+                                                              messages[i].additional_data,
+                                                              messages[i].additional_data_length,
+                                                              messages[i].input,
+                                                              messages[i].input_length,
+                                                              messages[i].output,
+                                                              messages[i].output_size,
+                                                              &(messages[i].output_length));
+
+    if ((messages[i].error != OCKAM_ERROR_NONE) && (error == OCKAM_ERROR_NONE)) { error = messages[i].error; }
+  }
+
+exit:
+  return error;
+}
+
+ockam_error_t ockam_vault_aead_aes_gcm_encrypt_in_place(ockam_vault_t*        vault,
+                                                        ockam_vault_secret_t* key,
+                                                        uint64_t              nonce,
+                                                        const uint8_t*        additional_data,
+                                                        size_t                additional_data_length,
+                                                        uint8_t*              buffer,
+                                                        size_t                plaintext_length,
+                                                        size_t                buffer_size,
+                                                        size_t*               ciphertext_and_tag_length)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((vault == 0) || (vault->dispatch == 0) || (buffer == 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if (vault->dispatch->aead_aes_gcm_encrypt_in_place != 0) {
+    error = vault->dispatch->aead_aes_gcm_encrypt_in_place(vault,
+                                                           key,
+                                                           nonce,
+                                                           additional_data,
+                                                           additional_data_length,
+                                                           buffer,
+                                                           plaintext_length,
+                                                           buffer_size,
+                                                           ciphertext_and_tag_length);
+    goto exit;
+  }
+
+  error = vault->dispatch->aead_aes_gcm_encrypt(vault,
+                                                key,
+                                                nonce,
+                                                additional_data,
+                                                additional_data_length,
+                                                buffer,
+                                                plaintext_length,
+                                                buffer,
+                                                buffer_size,
+                                                ciphertext_and_tag_length);
+
+exit:
+  return error;
+}
+
+ockam_error_t ockam_vault_aead_aes_gcm_decrypt_in_place(ockam_vault_t*        vault,
+                                                        ockam_vault_secret_t* key,
+                                                        uint64_t              nonce,
+                                                        const uint8_t*        additional_data,
+                                                        size_t                additional_data_length,
+                                                        uint8_t*              buffer,
+                                                        size_t                ciphertext_and_tag_length,
+                                                        size_t*               plaintext_length)
+{
+  ockam_error_t error = OCKAM_ERROR_NONE;
+
+  if ((vault == 0) || (vault->dispatch == 0) || (buffer == 0)) {
+    error = OCKAM_VAULT_ERROR_INVALID_PARAM;
+    goto exit;
+  }
+
+  if (vault->dispatch->aead_aes_gcm_decrypt_in_place != 0) {
+    error = vault->dispatch->aead_aes_gcm_decrypt_in_place(vault,
+                                                           key,
+                                                           nonce,
+                                                           additional_data,
+                                                           additional_data_length,
+                                                           buffer,
+                                                           ciphertext_and_tag_length,
+                                                           plaintext_length);
+    goto exit;
+  }
+
+  error = vault->dispatch->aead_aes_gcm_decrypt(vault,
+                                                key,
+                                                nonce,
+                                                additional_data,
+                                                additional_data_length,
+                                                buffer,
+                                                ciphertext_and_tag_length,
+                                                buffer,
+                                                ciphertext_and_tag_length,
+                                                plaintext_length);
+
+exit:
+  return error;
+}
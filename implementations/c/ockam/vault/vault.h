@@ -57,6 +57,8 @@
 #define OCKAM_VAULT_ERROR_DEFAULT_RANDOM_REQUIRED    (OCKAM_ERROR_INTERFACE_VAULT | 31u)
 #define OCKAM_VAULT_ERROR_MEMORY_REQUIRED            (OCKAM_ERROR_INTERFACE_VAULT | 32u)
 #define OCKAM_VAULT_ERROR_SECRET_SIZE_MISMATCH       (OCKAM_ERROR_INTERFACE_VAULT | 33u)
+#define OCKAM_VAULT_ERROR_BACKEND_UNAVAILABLE        (OCKAM_ERROR_INTERFACE_VAULT | 34u)
+#define OCKAM_VAULT_ERROR_NOT_SUPPORTED              (OCKAM_ERROR_INTERFACE_VAULT | 35u)
 
 struct ockam_vault;
 typedef struct ockam_vault ockam_vault_t;
@@ -110,6 +112,44 @@ typedef struct {
   void*                           context;
 } ockam_vault_secret_t;
 
+/**
+ * @struct  ockam_vault_aead_aes_gcm_message_t
+ * @brief   One message of a batched AES-GCM operation. For encryption the input is plaintext and the output is
+ *          ciphertext + tag, for decryption it is the other way around.
+ */
+typedef struct {
+  uint64_t       nonce;
+  const uint8_t* additional_data;
+  size_t         additional_data_length;
+  const uint8_t* input;
+  size_t         input_length;
+  uint8_t*       output;
+  size_t         output_size;
+  size_t         output_length; /* Set by the vault */
+  ockam_error_t  error;         /* Set by the vault */
+} ockam_vault_aead_aes_gcm_message_t;
+
+/**
+ * @struct  ockam_vault_ecdh_message_t
+ * @brief   One key agreement of a batched ECDH operation.
+ */
+typedef struct {
+  ockam_vault_secret_t* privatekey;
+  const uint8_t*        peer_publickey;
+  size_t                peer_publickey_length;
+  ockam_vault_secret_t* shared_secret; /* Set by the vault */
+  ockam_error_t         error;         /* Set by the vault */
+} ockam_vault_ecdh_message_t;
+
+/**
+ * @struct  ockam_vault_sha256_ctx_t
+ * @brief   State of a SHA-256 hash computed over several calls. Owned by the vault between
+ *          ockam_vault_sha256_init and ockam_vault_sha256_final.
+ */
+typedef struct {
+  void* context;
+} ockam_vault_sha256_ctx_t;
+
 /**
  * @brief   Deinitialize the specified ockam vault object
  * @param   vault[in] The ockam vault object to deinitialize.
@@ -143,6 +183,42 @@ ockam_error_t ockam_vault_sha256(ockam_vault_t* vault,
                                  size_t         digest_size,
                                  size_t*        digest_length);
 
+/**
+ * @brief   Start a SHA-256 hash whose input is supplied over any number of ockam_vault_sha256_update calls.
+ * @param   vault[in]     Vault object to use for SHA-256.
+ * @param   sha256[out]   Empty hash context to start. Must be passed to ockam_vault_sha256_final once started.
+ * @return  OCKAM_ERROR_NONE on success. OCKAM_VAULT_ERROR_NOT_SUPPORTED if the vault only hashes in one call.
+ */
+ockam_error_t ockam_vault_sha256_init(ockam_vault_t* vault, ockam_vault_sha256_ctx_t* sha256);
+
+/**
+ * @brief   Add data to a started SHA-256 hash.
+ * @param   vault[in]         Vault object the hash was started on.
+ * @param   sha256[in,out]    Hash context to add the data to.
+ * @param   input[in]         Buffer containing data to run through SHA-256.
+ * @param   input_length[in]  Length of the data to run through SHA-256.
+ * @return  OCKAM_ERROR_NONE on success.
+ */
+ockam_error_t ockam_vault_sha256_update(ockam_vault_t*            vault,
+                                        ockam_vault_sha256_ctx_t* sha256,
+                                        const uint8_t*            input,
+                                        size_t                    input_length);
+
+/**
+ * @brief   Finish a SHA-256 hash and release its context, whether or not the digest could be written.
+ * @param   vault[in]           Vault object the hash was started on.
+ * @param   sha256[in,out]      Hash context to finish. Empty again afterwards.
+ * @param   digest[out]         Buffer to place the resulting SHA-256 hash in. May be 0 to abandon the hash.
+ * @param   digest_size[in]     Size of the digest buffer. Must be 32 bytes.
+ * @param   digest_length[out]  Amount of data placed in the digest buffer.
+ * @return  OCKAM_ERROR_NONE on success.
+ */
+ockam_error_t ockam_vault_sha256_final(ockam_vault_t*            vault,
+                                       ockam_vault_sha256_ctx_t* sha256,
+                                       uint8_t*                  digest,
+                                       size_t                    digest_size,
+                                       size_t*                   digest_length);
+
 /**
  * @brief   Generate an ockam secret. Attributes struct must specify the configuration for the type of secret to
  *          generate. For EC keys and AES keys, length is ignored.
@@ -154,6 +230,21 @@ ockam_error_t ockam_vault_secret_generate(ockam_vault_t*
                                           ockam_vault_secret_t*                  secret,
                                           const ockam_vault_secret_attributes_t* attributes);
 
+/**
+ * @brief   Generate several ockam secrets with the same attributes. Either all of the secrets are generated or, on
+ *          failure, none of them is.
+ * @param   vault[in]           Vault object to use for generating the secret keys.
+ * @param   secrets[out]        Array of empty ockam secret objects to be populated with the generated secrets,
+ *                              any secret that is not empty fails the call.
+ * @param   attributes[in]      Desired attributes for every secret to be generated.
+ * @param   secrets_count[in]   Number of secrets in the array.
+ * @return  OCKAM_ERROR_NONE on success.
+ */
+ockam_error_t ockam_vault_secret_generate_batch(ockam_vault_t*                         vault,
+                                                ockam_vault_secret_t*                  secrets,
+                                                const ockam_vault_secret_attributes_t* attributes,
+                                                size_t                                 secrets_count);
+
 /**
  * @brief   Import the specified data into the supplied ockam vault secret.
  * @param   vault[in]         Vault object to use for generating a secret key.
@@ -242,6 +333,16 @@ ockam_error_t ockam_vault_ecdh(ockam_vault_t*        vault,
                                size_t                peer_publickey_length,
                                ockam_vault_secret_t* shared_secret);
 
+/**
+ * @brief   Perform several ECDH operations. Every message is processed and its result is stored in the message, so one
+ *          failure does not stop the rest of the batch. The shared secret of a failed message is left empty.
+ * @param   vault[in]           Vault object to use for ECDH.
+ * @param   messages[in,out]    Array of key agreements to perform.
+ * @param   messages_count[in]  Number of messages in the array.
+ * @return  OCKAM_ERROR_NONE if every ECDH succeeded, otherwise the error of the first failed message.
+ */
+ockam_error_t ockam_vault_ecdh_batch(ockam_vault_t* vault, ockam_vault_ecdh_message_t* messages, size_t messages_count);
+
 /**
  * @brief   Perform an HMAC-SHA256 based key derivation function on the supplied salt and input key material.
  * @param   vault[in]                 Vault object to use for encryption.
@@ -259,6 +360,8 @@ ockam_error_t ockam_vault_hkdf_sha256(ockam_vault_t*        vault,
 
 /**
  * @brief   Encrypt a payload using AES-GCM.
+ *
+ * The 96-bit IV is 32 zero bits followed by the nonce in big-endian order, as in the Noise AESGCM cipher functions.
  * @param   vault[in]                       Vault object to use for encryption.
  * @param   key[in]                         Ockam secret key to use for encryption.
  * @param   nonce[in]                       Nonce value to use for encryption.
@@ -273,7 +376,7 @@ ockam_error_t ockam_vault_hkdf_sha256(ockam_vault_t*        vault,
  */
 ockam_error_t ockam_vault_aead_aes_gcm_encrypt(ockam_vault_t*        vault,
                                                ockam_vault_secret_t* key,
-                                               uint16_t              nonce,
+                                               uint64_t              nonce,
                                                const uint8_t*        additional_data,
                                                size_t                additional_data_length,
                                                const uint8_t*        plaintext,
@@ -298,7 +401,7 @@ ockam_error_t ockam_vault_aead_aes_gcm_encrypt(ockam_vault_t*        vault,
  */
 ockam_error_t ockam_vault_aead_aes_gcm_decrypt(ockam_vault_t*        vault,
                                                ockam_vault_secret_t* key,
-                                               uint16_t              nonce,
+                                               uint64_t              nonce,
                                                const uint8_t*        additional_data,
                                                size_t                additional_data_length,
                                                const uint8_t*        ciphertext_and_tag,
@@ -307,6 +410,78 @@ ockam_error_t ockam_vault_aead_aes_gcm_decrypt(ockam_vault_t*        vault,
                                                size_t                plaintext_size,
                                                size_t*               plaintext_length);
 
+/**
+ * @brief   Encrypt several payloads with the same key using AES-GCM. Every message is processed and its result is
+ *          stored in the message, so one failure does not stop the rest of the batch.
+ * @param   vault[in]           Vault object to use for encryption.
+ * @param   key[in]             Ockam secret key to use for encryption.
+ * @param   messages[in,out]    Array of messages to encrypt.
+ * @param   messages_count[in]  Number of messages in the array.
+ * @return  OCKAM_ERROR_NONE if every message was encrypted, otherwise the error of the first failed message.
+ */
+ockam_error_t ockam_vault_aead_aes_gcm_encrypt_batch(ockam_vault_t*                      vault,
+                                                     ockam_vault_secret_t*               key,
+                                                     ockam_vault_aead_aes_gcm_message_t* messages,
+                                                     size_t                              messages_count);
+
+/**
+ * @brief   Decrypt several payloads with the same key using AES-GCM. Every message is processed and its result is
+ *          stored in the message, so one failure does not stop the rest of the batch.
+ * @param   vault[in]           Vault object to use for decryption.
+ * @param   key[in]             Ockam secret key to use for decryption.
+ * @param   messages[in,out]    Array of messages to decrypt.
+ * @param   messages_count[in]  Number of messages in the array.
+ * @return  OCKAM_ERROR_NONE if every message was decrypted, otherwise the error of the first failed message.
+ */
+ockam_error_t ockam_vault_aead_aes_gcm_decrypt_batch(ockam_vault_t*                      vault,
+                                                     ockam_vault_secret_t*               key,
+                                                     ockam_vault_aead_aes_gcm_message_t* messages,
+                                                     size_t                              messages_count);
+
+/**
+ * @brief   Encrypt a payload using AES-GCM, writing the ciphertext over the plaintext and the tag right after it.
+ * @param   vault[in]                       Vault object to use for encryption.
+ * @param   key[in]                         Ockam secret key to use for encryption.
+ * @param   nonce[in]                       Nonce value to use for encryption.
+ * @param   additional_data[in]             Additional data to use for encryption.
+ * @param   additional_data_length[in]      Length of the additional data.
+ * @param   buffer[in,out]                  Buffer holding the plaintext, replaced by the ciphertext and tag.
+ * @param   plaintext_length[in]            Length of plaintext data at the start of the buffer.
+ * @param   buffer_size[in]                 Size of the buffer. Must be at least plaintext_length + 16.
+ * @param   ciphertext_and_tag_length[out]  Amount of ciphertext + tag data now in the buffer.
+ * @return  OCKAM_ERROR_NONE on success.
+ */
+ockam_error_t ockam_vault_aead_aes_gcm_encrypt_in_place(ockam_vault_t*        vault,
+                                                        ockam_vault_secret_t* key,
+                                                        uint64_t              nonce,
+                                                        const uint8_t*        additional_data,
+                                                        size_t                additional_data_length,
+                                                        uint8_t*              buffer,
+                                                        size_t                plaintext_length,
+                                                        size_t                buffer_size,
+                                                        size_t*               ciphertext_and_tag_length);
+
+/**
+ * @brief   Decrypt a payload using AES-GCM, writing the plaintext over the ciphertext.
+ * @param   vault[in]                       Vault object to use for decryption.
+ * @param   key[in]                         Ockam secret key to use for decryption.
+ * @param   nonce[in]                       Nonce value to use for decryption.
+ * @param   additional_data[in]             Additional data to use for decryption.
+ * @param   additional_data_length[in]      Length of the additional data.
+ * @param   buffer[in,out]                  Buffer holding the ciphertext + tag, replaced by the plaintext.
+ * @param   ciphertext_and_tag_length[in]   Length of the ciphertext + tag data in the buffer.
+ * @param   plaintext_length[out]           Amount of plaintext data now at the start of the buffer.
+ * @return  OCKAM_ERROR_NONE on success. On OCKAM_VAULT_ERROR_INVALID_TAG the buffer contents must not be used.
+ */
+ockam_error_t ockam_vault_aead_aes_gcm_decrypt_in_place(ockam_vault_t*        vault,
+                                                        ockam_vault_secret_t* key,
+                                                        uint64_t              nonce,
+                                                        const uint8_t*        additional_data,
+                                                        size_t                additional_data_length,
+                                                        uint8_t*              buffer,
+                                                        size_t                ciphertext_and_tag_length,
+                                                        size_t*               plaintext_length);
+
 #ifdef __cplusplus
 }
 #endif
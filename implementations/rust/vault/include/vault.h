@@ -96,6 +96,33 @@ uint32_t ockam_vault_sha256(ockam_vault_t vault,
                             size_t input_length,
                             uint8_t* digest);
 
+/**
+ * @brief   Start a SHA-256 hash whose input is supplied over several calls to ockam_vault_sha256_update.
+ * @param   vault[in]   Vault object to use for SHA-256.
+ * @param   sha256[out] Handle of the started hash. Must be passed to ockam_vault_sha256_final.
+ * @return  OCKAM_ERROR_NONE on success.
+ */
+uint32_t ockam_vault_sha256_init(ockam_vault_t vault, uint64_t* sha256);
+
+/**
+ * @brief   Add data to a started SHA-256 hash.
+ * @param   vault[in]           Vault object the hash was started on.
+ * @param   sha256[in]          Handle of the hash.
+ * @param   input[in]           Buffer containing data to run through SHA-256.
+ * @param   input_length[in]    Length of the data to run through SHA-256.
+ * @return  OCKAM_ERROR_NONE on success.
+ */
+uint32_t ockam_vault_sha256_update(ockam_vault_t vault, uint64_t sha256, const uint8_t* const input, size_t input_length);
+
+/**
+ * @brief   Finish a SHA-256 hash and release its handle.
+ * @param   vault[in]   Vault object the hash was started on.
+ * @param   sha256[in]  Handle of the hash.
+ * @param   digest[out] Buffer to place the resulting SHA-256 hash in. Must be 32 bytes, or 0 to abandon the hash.
+ * @return  OCKAM_ERROR_NONE on success.
+ */
+uint32_t ockam_vault_sha256_final(ockam_vault_t vault, uint64_t sha256, uint8_t* digest);
+
 /**
  * @brief   Generate an ockam secret. Attributes struct must specify the configuration for the type of secret to
  *          generate. For EC keys and AES keys, length is ignored.
@@ -217,7 +244,7 @@ uint32_t ockam_vault_hkdf_sha256(ockam_vault_t        vault,
  */
 uint32_t ockam_vault_aead_aes_gcm_encrypt(ockam_vault_t        vault,
                                           ockam_vault_secret_t key,
-                                          uint16_t              nonce,
+                                          uint64_t              nonce,
                                           const uint8_t* const  additional_data,
                                           size_t                additional_data_length,
                                           const uint8_t* const  plaintext,
@@ -242,7 +269,7 @@ uint32_t ockam_vault_aead_aes_gcm_encrypt(ockam_vault_t        vault,
  */
 uint32_t ockam_vault_aead_aes_gcm_decrypt(ockam_vault_t        vault,
                                          ockam_vault_secret_t key,
-                                         uint16_t              nonce,
+                                         uint64_t              nonce,
                                          const uint8_t* const  additional_data,
                                          size_t                additional_data_length,
                                          const uint8_t* const  ciphertext_and_tag,
@@ -7,12 +7,14 @@ use crate::{
     Vault,
 };
 use ffi_support::{ByteBuffer, ConcurrentHandleMap, ExternError, IntoFfi};
+use sha2::{Digest, Sha256};
 use std::convert::TryInto;
 
 mod types;
 
 lazy_static! {
     static ref DEFAULT_VAULTS: ConcurrentHandleMap<DefaultVault> = ConcurrentHandleMap::new();
+    static ref SHA256_CONTEXTS: ConcurrentHandleMap<Sha256> = ConcurrentHandleMap::new();
 }
 
 /// The Default vault id across the FFI boundary
@@ -109,6 +111,79 @@ pub extern "C" fn ockam_vault_sha256(
     }
 }
 
+/// Start a SHA-256 hash whose input is supplied over several calls to `ockam_vault_sha256_update`.
+/// The handle placed in `sha256` must be passed to `ockam_vault_sha256_final`.
+#[no_mangle]
+pub extern "C" fn ockam_vault_sha256_init(
+    context: &OckamVaultContext,
+    sha256: &mut u64,
+) -> VaultError {
+    let mut err = ExternError::success();
+    match context.vault_id {
+        DEFAULT_VAULT_ID => {
+            let handle = SHA256_CONTEXTS.insert_with_output(&mut err, Sha256::new);
+            if err.get_code().is_success() {
+                *sha256 = handle;
+                ERROR_NONE
+            } else {
+                VaultFailErrorKind::Sha256.into()
+            }
+        }
+        _ => VaultFailErrorKind::InvalidContext.into(),
+    }
+}
+
+/// Add `input` to the SHA-256 hash `sha256`.
+#[no_mangle]
+pub extern "C" fn ockam_vault_sha256_update(
+    context: &OckamVaultContext,
+    sha256: u64,
+    input: *const u8,
+    input_length: u32,
+) -> VaultError {
+    check_buffer!(input);
+
+    let input = unsafe { std::slice::from_raw_parts(input, input_length as usize) };
+
+    let mut err = ExternError::success();
+    match context.vault_id {
+        DEFAULT_VAULT_ID => {
+            SHA256_CONTEXTS.call_with_output_mut(&mut err, sha256, |hash| hash.update(input));
+            if err.get_code().is_success() {
+                ERROR_NONE
+            } else {
+                VaultFailErrorKind::InvalidContext.into()
+            }
+        }
+        _ => VaultFailErrorKind::InvalidContext.into(),
+    }
+}
+
+/// Finish the SHA-256 hash `sha256`, put the result in `digest` and release the handle.
+/// `digest` must be 32 bytes in length, or null to abandon the hash.
+#[no_mangle]
+pub extern "C" fn ockam_vault_sha256_final(
+    context: &OckamVaultContext,
+    sha256: u64,
+    digest: *mut u8,
+) -> VaultError {
+    match context.vault_id {
+        DEFAULT_VAULT_ID => match SHA256_CONTEXTS.remove_u64(sha256) {
+            Ok(Some(hash)) => {
+                let output = hash.finalize();
+                if !digest.is_null() {
+                    unsafe {
+                        std::ptr::copy_nonoverlapping(output.as_ptr(), digest, 32);
+                    }
+                }
+                ERROR_NONE
+            }
+            _ => VaultFailErrorKind::InvalidContext.into(),
+        },
+        _ => VaultFailErrorKind::InvalidContext.into(),
+    }
+}
+
 /// Generate a secret key with the specific attributes.
 /// Returns a handle for the secret
 #[no_mangle]
@@ -450,7 +525,7 @@ pub extern "C" fn ockam_vault_hkdf_sha256(
 pub extern "C" fn ockam_vault_aead_aes_gcm_encrypt(
     context: &OckamVaultContext,
     secret: &OckamSecret,
-    nonce: u16,
+    nonce: u64,
     additional_data: *const u8,
     additional_data_length: u32,
     plaintext: *const u8,
@@ -476,7 +551,7 @@ pub extern "C" fn ockam_vault_aead_aes_gcm_encrypt(
                     let ciphertext = vault.aead_aes_gcm_encrypt(
                         ctx,
                         plaintext,
-                        nonce.to_be_bytes().as_ref(),
+                        aead_aes_gcm_nonce(nonce).as_ref(),
                         additional_data,
                     )?;
                     Ok(ByteBuffer::from_vec(ciphertext))
@@ -509,7 +584,7 @@ pub extern "C" fn ockam_vault_aead_aes_gcm_encrypt(
 pub extern "C" fn ockam_vault_aead_aes_gcm_decrypt(
     context: &OckamVaultContext,
     secret: &OckamSecret,
-    nonce: u16,
+    nonce: u64,
     additional_data: *const u8,
     additional_data_length: u32,
     ciphertext_and_tag: *const u8,
@@ -537,7 +612,7 @@ pub extern "C" fn ockam_vault_aead_aes_gcm_decrypt(
                     let plain = vault.aead_aes_gcm_decrypt(
                         ctx,
                         ciphertext_and_tag,
-                        nonce.to_be_bytes().as_ref(),
+                        aead_aes_gcm_nonce(nonce).as_ref(),
                         additional_data,
                     )?;
                     Ok(ByteBuffer::from_vec(plain))
@@ -583,3 +658,11 @@ define_string_destructor!(string_free);
 fn get_memory_id(secret: &OckamSecret) -> SecretKeyContext {
     SecretKeyContext::Memory(secret.handle as usize)
 }
+
+/// The 96-bit AES-GCM nonce: 32 zero bits followed by the big-endian counter, as the C vaults build it.
+#[inline]
+fn aead_aes_gcm_nonce(nonce: u64) -> [u8; 12] {
+    let mut n = [0u8; 12];
+    n[4..].copy_from_slice(&nonce.to_be_bytes());
+    n
+}